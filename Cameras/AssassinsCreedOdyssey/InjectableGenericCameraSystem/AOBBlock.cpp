@@ -31,6 +31,7 @@
 #include "Utils.h"
 #include "OverlayConsole.h"
 #include "ScanPattern.h"
+#include "ApproximateScanner.h"
 
 using namespace std;
 
@@ -38,12 +39,22 @@ namespace IGCS
 {
 	AOBBlock::AOBBlock(string blockName, string bytePatternAsString, int occurrence)
 		: _blockName{ blockName }, _customOffset{ 0 }, _locationInImage{ nullptr }, _found{ false },
-		_isNonCritical{ false }, _patternIndexThatMatched { 0 }
+		_isNonCritical{ false }, _isApproximateMatch{ false }, _maxNumberOfMismatches{ 0 }, _patternIndexThatMatched { 0 }, _targetSectionClass{ SectionClass::Code },
+		_approximateMatch{ nullptr, 0, 0, 0, {} }
 	{
 		addAlternative(bytePatternAsString, occurrence);
 	}
 
 
+	AOBBlock::AOBBlock(string blockName, const ScanPattern& pattern)
+		: _blockName{ blockName }, _customOffset{ 0 }, _locationInImage{ nullptr }, _found{ false },
+		_isNonCritical{ false }, _isApproximateMatch{ false }, _maxNumberOfMismatches{ 0 }, _patternIndexThatMatched { 0 }, _targetSectionClass{ SectionClass::Code },
+		_approximateMatch{ nullptr, 0, 0, 0, {} }
+	{
+		addAlternative(pattern);
+	}
+
+
 	AOBBlock::~AOBBlock()
 	{
 	}
@@ -52,33 +63,149 @@ namespace IGCS
 	// Adds an alternative AOB pattern + occurrence. Will be used if a previous pattern failed. 
 	void AOBBlock::addAlternative(std::string bytePatternAsString, int occurrence)
 	{
-		ScanPattern toAdd = ScanPattern(bytePatternAsString, occurrence);
-		_scanPatterns.push_back(toAdd);
+		addAlternative(ScanPattern(bytePatternAsString, occurrence));
+	}
+
+
+	// Adds an alternative pattern, e.g. a pattern literal parsed at compile time. Will be used if a previous pattern failed. 
+	void AOBBlock::addAlternative(const ScanPattern& pattern)
+	{
+		_scanPatterns.push_back(pattern);
 	}
 
 
 	bool AOBBlock::scan(LPBYTE imageAddress, DWORD imageSize)
 	{
-		_patternIndexThatMatched = -1;
-		bool toReturn = _isNonCritical;		// by default this is false, so we'll return false by default if something fails, otherwise we silently 'succeed'. 
 		LPBYTE aobPatternLocation = nullptr;
 		int patternIndex = -1;
 		for (auto& scanPattern : _scanPatterns)
 		{
 			patternIndex++;
 			aobPatternLocation = Utils::findAOBPattern(imageAddress, imageSize, scanPattern);
-			if (nullptr == aobPatternLocation)
+			if (nullptr != aobPatternLocation)
+			{
+				// found
+				break;
+			}
+		}
+		return storeScanResult(patternIndex, aobPatternLocation);
+	}
+
+
+	// Adds all patterns of this block to the scanner specified, so they can be scanned for in one pass together with the patterns of other blocks.
+	void AOBBlock::registerPatterns(MultiPatternScanner& scanner)
+	{
+		_patternIdsInScanner.clear();
+		for (auto& scanPattern : _scanPatterns)
+		{
+			_patternIdsInScanner.push_back(scanner.addPattern(scanPattern.view(), scanPattern.occurrence()));
+		}
+	}
+
+
+	// Picks the result of the first pattern of this block found by the scanner the patterns were registered with. Same result as scan()
+	bool AOBBlock::processScanResults(const MultiPatternScanner& scanner)
+	{
+		LPBYTE aobPatternLocation = nullptr;
+		int patternIndex = -1;
+		for (int patternId : _patternIdsInScanner)
+		{
+			patternIndex++;
+			aobPatternLocation = const_cast<LPBYTE>(scanner.location(patternId));
+			if (nullptr != aobPatternLocation)
+			{
+				// found
+				if (scanner.isAmbiguous(patternId))
+				{
+					OverlayConsole::instance().logLine("Pattern for block '%s' is ambiguous: %d%s matches, occurrence %d used. The game might have been updated.", 
+													   _blockName.c_str(), static_cast<int>(scanner.occurrences(patternId).size()), scanner.isIndexComplete(patternId) ? "" : "+", 
+													   _scanPatterns[patternIndex].occurrence());
+				}
+				break;
+			}
+		}
+		return storeScanResult(patternIndex, aobPatternLocation);
+	}
+
+
+	// Verifies whether the location found in a previous session is still the location of this block: the pattern with the index specified
+	// is the same pattern with the same occurrence and matches at the rva specified, inside the sections the block targets. If so, the block is
+	// marked as found at that location, without scanning.
+	bool AOBBlock::verifyLocation(const PEImage& image, const CachedLocation& location)
+	{
+		if (location.patternIndex < 0 || location.patternIndex >= static_cast<int>(_scanPatterns.size()))
+		{
+			return false;
+		}
+		ScanPattern& scanPattern = _scanPatterns[location.patternIndex];
+		LPBYTE verifiedLocation = const_cast<LPBYTE>(ScanResultCache::verifyLocation(image, _targetSectionClass, scanPattern.view(), scanPattern.occurrence(), location));
+		if (nullptr == verifiedLocation)
+		{
+			OverlayConsole::instance().logDebug("Cached location of block '%s' is stale, scanning for it.", _blockName.c_str());
+			return false;
+		}
+		OverlayConsole::instance().logDebug("Pattern for block '%s' verified at cached address: %p", _blockName.c_str(), (void*)verifiedLocation);
+		_found = true;
+		_patternIndexThatMatched = location.patternIndex;
+		_customOffset = scanPattern.customOffset();
+		_locationInImage = verifiedLocation;
+		return true;
+	}
+
+
+	CachedLocation AOBBlock::cachedLocation(LPBYTE imageAddress)
+	{
+		ScanPattern& scanPattern = _scanPatterns[_patternIndexThatMatched];
+		return CachedLocation{ _patternIndexThatMatched, scanPattern.occurrence(), ScanResultCache::calculatePatternHash(scanPattern.view()),
+							   static_cast<uint32_t>(_locationInImage - imageAddress) };
+	}
+
+
+	// Finds the location of the block with the pattern which has the fewest mismatches, if none of the patterns match exactly, e.g. after a 
+	// game update. The location is only used if it's the only one with that number of mismatches and matches well enough. The mismatches 
+	// are reported so the patterns can be updated.
+	bool AOBBlock::scanApproximately(const std::vector<ScanRange>& ranges, int numberOfThreads)
+	{
+		ApproximateMatch bestMatch{ nullptr, 0, 0, 0, {} };
+		int bestPatternIndex = -1;
+		for (int patternIndex = 0; patternIndex < static_cast<int>(_scanPatterns.size()); patternIndex++)
+		{
+			ScanPattern& scanPattern = _scanPatterns[patternIndex];
+			if (scanPattern.occurrence() != 1)
 			{
-				// not found, try next
+				// an nth occurrence can't be told apart from the other candidates.
 				continue;
 			}
-			// found
-			_patternIndexThatMatched = patternIndex;
-			_customOffset = scanPattern.customOffset();
-			break;
+			ApproximateMatch match = ApproximateScanner::findBestMatch(ranges, scanPattern.view(), _maxNumberOfMismatches, numberOfThreads);
+			if (match.isUsable(ApproximateScanner::MINIMUM_CONFIDENCE) && (bestPatternIndex < 0 || match.confidence() > bestMatch.confidence()))
+			{
+				bestMatch = match;
+				bestPatternIndex = patternIndex;
+			}
+		}
+		if (bestPatternIndex < 0)
+		{
+			OverlayConsole::instance().logError("Can't find pattern for block '%s', not even approximately! Hook not set.", _blockName.c_str());
+			return _isNonCritical;
 		}
+		_isApproximateMatch = true;
+		_approximateMatch = bestMatch;
+		return storeScanResult(bestPatternIndex, const_cast<LPBYTE>(bestMatch.location));
+	}
+
+
+	bool AOBBlock::storeScanResult(int patternIndex, LPBYTE aobPatternLocation)
+	{
+		_patternIndexThatMatched = -1;
+		bool toReturn = _isNonCritical;		// by default this is false, so we'll return false by default if something fails, otherwise we silently 'succeed'. 
 		if (nullptr == aobPatternLocation)
 		{
+			if (allowsFuzzyMatching())
+			{
+				// the approximate scan reports whether it's found or not.
+				OverlayConsole::instance().logDebug("Can't find pattern for block '%s', trying an approximate match.", _blockName.c_str());
+				return toReturn;
+			}
 			OverlayConsole::instance().logError("Can't find pattern for block '%s'! Hook not set.", _blockName.c_str());
 			return toReturn;
 		}
@@ -87,7 +214,9 @@ namespace IGCS
 			OverlayConsole::instance().logDebug("Pattern for block '%s' found at address: %p", _blockName.c_str(), (void*)aobPatternLocation);
 			_found = true;
 		}
+		_patternIndexThatMatched = patternIndex;
+		_customOffset = _scanPatterns[patternIndex].customOffset();
 		_locationInImage = aobPatternLocation;
 		return true;
 	}
-}
\ No newline at end of file
+}
@@ -29,6 +29,10 @@
 #include "AOBBlock.h"
 #include "Utils.h"
 #include "ScanPattern.h"
+#include "MultiPatternScanner.h"
+#include "PEImage.h"
+#include "ApproximateScanner.h"
+#include "ScanResultCache.h"
 
 namespace IGCS
 {
@@ -36,25 +40,55 @@ namespace IGCS
 	{
 	public:
 		AOBBlock(std::string blockName, std::string bytePatternAsString, int occurrence);
+		AOBBlock(std::string blockName, const ScanPattern& pattern);
 		~AOBBlock();
 
 		bool scan(LPBYTE imageAddress, DWORD imageSize);
+		void registerPatterns(MultiPatternScanner& scanner);
+		bool processScanResults(const MultiPatternScanner& scanner);
+		bool verifyLocation(const PEImage& image, const CachedLocation& location);
+		// The location the block was found at, to be stored in the scan result cache. Only valid if the block was found.
+		CachedLocation cachedLocation(LPBYTE imageAddress);
+		bool scanApproximately(const std::vector<ScanRange>& ranges, int numberOfThreads);
 		LPBYTE locationInImage() { return _locationInImage; }
 		int customOffset() { return _customOffset; }
 		LPBYTE absoluteAddress() { return (LPBYTE)(_locationInImage + (DWORD)customOffset()); }
 		void addAlternative(std::string bytePatternAsString, int occurrence);
+		void addAlternative(const ScanPattern& pattern);
 		bool found() { return _found; }
+		std::string blockName() { return _blockName; }
 		void markAsNonCritical() { _isNonCritical = true; }
 		bool isNonCritical() { return _isNonCritical; }
 		int patternIndexThatMatched() { return _patternIndexThatMatched; }
+		// Only valid if the block was found.
+		ScanPattern& patternThatMatched() { return _scanPatterns[_patternIndexThatMatched]; }
+		// Allows the block to be found by an approximate scan with at most maxNumberOfMismatches different bytes if none of its patterns
+		// match exactly. Never for blocks which are patched or written to: a near miss can be another function with a similar prologue. Only for
+		// blocks which are read from and of which what's read is validated before it's used.
+		void allowFuzzyMatching(int maxNumberOfMismatches) { _maxNumberOfMismatches = maxNumberOfMismatches; }
+		bool allowsFuzzyMatching() { return _maxNumberOfMismatches > 0; }
+		bool isApproximateMatch() { return _isApproximateMatch; }
+		// The match the block was found with if isApproximateMatch(): the number of bytes of patternThatMatched() which differ and which
+		// ones. Reporting it is up to the caller.
+		const ApproximateMatch& approximateMatch() { return _approximateMatch; }
+		// The class of the sections to scan for this block. By default code, as that's what interceptors hook into. 
+		SectionClass targetSectionClass() { return _targetSectionClass; }
+		void targetSectionClass(SectionClass value) { _targetSectionClass = value; }
 
 	private:
+		bool storeScanResult(int patternIndex, LPBYTE aobPatternLocation);
+
 		bool _found;
 		bool _isNonCritical;
+		bool _isApproximateMatch;
+		int _maxNumberOfMismatches;
 		std::string _blockName;
 		std::vector<ScanPattern> _scanPatterns;
+		std::vector<int> _patternIdsInScanner;
 		int _customOffset;
 		int _patternIndexThatMatched;
+		SectionClass _targetSectionClass;
+		ApproximateMatch _approximateMatch;
 		LPBYTE _locationInImage;	// the location to use after the scan has been completed.
 	};
 }
\ No newline at end of file
@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "AOBScanner.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define IGCS_SCANNER_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define IGCS_TARGET_AVX2
+	#else
+		#define IGCS_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+namespace IGCS::AOBScanner
+{
+	static bool matchesAtScalar(const uint8_t* location, const PatternView& pattern, int startIndex)
+	{
+		for (int i = startIndex; i < pattern.patternSize; i++)
+		{
+			if (((location[i] ^ pattern.bytePattern[i]) & ~pattern.compareMask[i]) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+#ifdef IGCS_SCANNER_X86
+	bool matchesAt(const uint8_t* location, const PatternView& pattern)
+	{
+		// compare 16 bytes at a time, the bits which differ are cleared where the compare mask has a wildcard bit. The tail is compared
+		// scalar so we never read past the pattern's last byte.
+		int index = 0;
+		for (; index + 16 <= pattern.patternSize; index += 16)
+		{
+			__m128i image = _mm_loadu_si128(reinterpret_cast<const __m128i*>(location + index));
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.bytePattern + index));
+			__m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.compareMask + index));
+			__m128i difference = _mm_andnot_si128(mask, _mm_xor_si128(image, bytes));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(difference, _mm_setzero_si128())) != 0xFFFF)
+			{
+				return false;
+			}
+		}
+		return matchesAtScalar(location, pattern, index);
+	}
+#else
+	bool matchesAt(const uint8_t* location, const PatternView& pattern)
+	{
+		return matchesAtScalar(location, pattern, 0);
+	}
+#endif
+
+
+	// Scans the candidate start positions [current, lastStart] one by one.
+	static const uint8_t* findFirstScalar(const uint8_t* current, const uint8_t* lastStart, const PatternView& pattern)
+	{
+		const uint8_t anchor = pattern.bytePattern[pattern.anchorIndex];
+		const uint8_t secondaryAnchor = pattern.bytePattern[pattern.secondaryAnchorIndex];
+		for (; current <= lastStart; current++)
+		{
+			if (current[pattern.anchorIndex] == anchor && current[pattern.secondaryAnchorIndex] == secondaryAnchor && matchesAt(current, pattern))
+			{
+				return current;
+			}
+		}
+		return nullptr;
+	}
+
+
+#ifdef IGCS_SCANNER_X86
+	// Tests 16 candidate start positions per iteration by comparing both anchor bytes against the image at once. Only positions where both
+	// anchors match are verified with a full masked compare.
+	static const uint8_t* findFirstSse2(const uint8_t* current, const uint8_t* lastStart, const PatternView& pattern)
+	{
+		const __m128i anchor = _mm_set1_epi8(static_cast<char>(pattern.bytePattern[pattern.anchorIndex]));
+		const __m128i secondaryAnchor = _mm_set1_epi8(static_cast<char>(pattern.bytePattern[pattern.secondaryAnchorIndex]));
+		for (; lastStart - current >= 15; current += 16)
+		{
+			__m128i anchorBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + pattern.anchorIndex));
+			__m128i secondaryAnchorBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + pattern.secondaryAnchorIndex));
+			unsigned int candidates = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(anchorBlock, anchor),
+																									_mm_cmpeq_epi8(secondaryAnchorBlock, secondaryAnchor))));
+			while (candidates != 0)
+			{
+				unsigned long bitIndex = 0;
+#ifdef _MSC_VER
+				_BitScanForward(&bitIndex, candidates);
+#else
+				bitIndex = static_cast<unsigned long>(__builtin_ctz(candidates));
+#endif
+				if (matchesAt(current + bitIndex, pattern))
+				{
+					return current + bitIndex;
+				}
+				candidates &= candidates - 1;
+			}
+		}
+		return findFirstScalar(current, lastStart, pattern);
+	}
+
+
+	// Same as findFirstSse2 but with 32 candidate positions per iteration.
+	IGCS_TARGET_AVX2 static const uint8_t* findFirstAvx2(const uint8_t* current, const uint8_t* lastStart, const PatternView& pattern)
+	{
+		const __m256i anchor = _mm256_set1_epi8(static_cast<char>(pattern.bytePattern[pattern.anchorIndex]));
+		const __m256i secondaryAnchor = _mm256_set1_epi8(static_cast<char>(pattern.bytePattern[pattern.secondaryAnchorIndex]));
+		for (; lastStart - current >= 31; current += 32)
+		{
+			__m256i anchorBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + pattern.anchorIndex));
+			__m256i secondaryAnchorBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + pattern.secondaryAnchorIndex));
+			unsigned int candidates = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(anchorBlock, anchor),
+																										_mm256_cmpeq_epi8(secondaryAnchorBlock, secondaryAnchor))));
+			while (candidates != 0)
+			{
+				unsigned long bitIndex = 0;
+#ifdef _MSC_VER
+				_BitScanForward(&bitIndex, candidates);
+#else
+				bitIndex = static_cast<unsigned long>(__builtin_ctz(candidates));
+#endif
+				if (matchesAt(current + bitIndex, pattern))
+				{
+					return current + bitIndex;
+				}
+				candidates &= candidates - 1;
+			}
+		}
+		return findFirstSse2(current, lastStart, pattern);
+	}
+
+
+	static bool cpuSupportsAvx2()
+	{
+#ifdef _MSC_VER
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 0);
+		if (cpuInfo[0] < 7)
+		{
+			return false;
+		}
+		__cpuid(cpuInfo, 1);
+		bool osUsesXSave = (cpuInfo[2] & (1 << 27)) != 0;
+		bool cpuHasAvx = (cpuInfo[2] & (1 << 28)) != 0;
+		if (!osUsesXSave || !cpuHasAvx || (_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+		__cpuidex(cpuInfo, 7, 0);
+		return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	static const bool avx2Supported = cpuSupportsAvx2();
+#endif
+
+
+	static const uint8_t* findFirst(const uint8_t* current, const uint8_t* lastStart, const PatternView& pattern)
+	{
+		if (pattern.compareMask[pattern.anchorIndex] != 0)
+		{
+			// no fully compared byte to anchor on, so only wildcards and nibble wildcards: compare at every position.
+			for (; current <= lastStart; current++)
+			{
+				if (matchesAt(current, pattern))
+				{
+					return current;
+				}
+			}
+			return nullptr;
+		}
+#ifdef IGCS_SCANNER_X86
+		return avx2Supported ? findFirstAvx2(current, lastStart, pattern) : findFirstSse2(current, lastStart, pattern);
+#else
+		return findFirstScalar(current, lastStart, pattern);
+#endif
+	}
+
+
+	const uint8_t* findPattern(const uint8_t* rangeStart, size_t rangeLength, const PatternView& pattern, int occurrence)
+	{
+		if (nullptr == rangeStart || pattern.patternSize <= 0 || rangeLength < static_cast<size_t>(pattern.patternSize))
+		{
+			return nullptr;
+		}
+		const uint8_t* lastStart = rangeStart + (rangeLength - pattern.patternSize);
+		const uint8_t* toReturn = nullptr;
+		const uint8_t* startOfScan = rangeStart;
+		for (int i = 0; i < occurrence; i++)
+		{
+			toReturn = findFirst(startOfScan, lastStart, pattern);
+			if (nullptr == toReturn)
+			{
+				// not found, give up
+				return nullptr;
+			}
+			startOfScan = toReturn + 1;	// otherwise we'll match ourselves.
+		}
+		return toReturn;
+	}
+
+
+	int findOccurrences(const uint8_t* rangeStart, size_t rangeLength, const PatternView& pattern, int maxNumberOfOccurrences, std::vector<const uint8_t*>& occurrences)
+	{
+		if (nullptr == rangeStart || pattern.patternSize <= 0 || rangeLength < static_cast<size_t>(pattern.patternSize))
+		{
+			return 0;
+		}
+		const uint8_t* lastStart = rangeStart + (rangeLength - pattern.patternSize);
+		const uint8_t* startOfScan = rangeStart;
+		int toReturn = 0;
+		for (; toReturn < maxNumberOfOccurrences; toReturn++)
+		{
+			const uint8_t* location = findFirst(startOfScan, lastStart, pattern);
+			if (nullptr == location)
+			{
+				break;
+			}
+			occurrences.push_back(location);
+			startOfScan = location + 1;
+		}
+		return toReturn;
+	}
+}
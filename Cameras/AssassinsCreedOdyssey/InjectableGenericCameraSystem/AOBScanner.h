@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+
+namespace IGCS
+{
+	// Plain view on a parsed AOB pattern, used by the scanner. compareMask contains the bits to ignore per byte: 0x00 for bytes which have to
+	// match, 0xFF for wildcard bytes and 0x0F / 0xF0 for bytes of which only one nibble has to match, so a masked compare is a simple
+	// ((image ^ pattern) & ~compareMask) == 0. anchorIndex and secondaryAnchorIndex are the indices of the two least common fully compared
+	// bytes in the pattern: the scanner searches for these first and only compares the full pattern on a hit.
+	struct PatternView
+	{
+		const uint8_t* bytePattern;
+		const uint8_t* compareMask;
+		int patternSize;
+		int anchorIndex;
+		int secondaryAnchorIndex;
+	};
+
+
+	// A range of bytes to scan.
+	struct ScanRange
+	{
+		const uint8_t* start;
+		size_t length;
+	};
+
+
+	namespace AOBScanner
+	{
+		// Byte values ordered from most common to less common in x64 code (prefixes, modrm bytes, opcodes, padding). Bytes not in this list
+		// are considered rare. Used to pick the anchor bytes of a pattern: the rarer the anchor, the fewer full compares the scanner has to do.
+		constexpr uint8_t commonBytesInCode[] =
+		{
+			0x00, 0xFF, 0x48, 0x8B, 0x89, 0x0F, 0x24, 0x4C, 0x44, 0x8D, 0x41, 0xE8, 0x85, 0xC0, 0x01, 0x83,
+			0x45, 0x74, 0x49, 0x10, 0x4D, 0x75, 0x20, 0x08, 0x40, 0x28, 0x11, 0x18, 0x30, 0xCC, 0xC3, 0x05,
+			0x0D, 0x38, 0xF3, 0xC7, 0x33, 0xE9, 0x90, 0x50, 0x02, 0x04, 0xC1, 0x84, 0x80, 0x58, 0x60, 0xD2,
+		};
+
+		constexpr std::array<uint8_t, 256> createByteCommonnessTable()
+		{
+			std::array<uint8_t, 256> toReturn{};
+			const int numberOfCommonBytes = static_cast<int>(sizeof(commonBytesInCode));
+			for (int i = 0; i < numberOfCommonBytes; i++)
+			{
+				toReturn[commonBytesInCode[i]] = static_cast<uint8_t>(numberOfCommonBytes - i);
+			}
+			return toReturn;
+		}
+
+		constexpr std::array<uint8_t, 256> byteCommonnessTable = createByteCommonnessTable();
+
+		// Returns the location of the occurrence-th (starts at 1) match of the pattern in the range [rangeStart, rangeStart+rangeLength)
+		// or nullptr if there's no such match. Matches are allowed to overlap, like the original scanner.
+		const uint8_t* findPattern(const uint8_t* rangeStart, size_t rangeLength, const PatternView& pattern, int occurrence);
+		// Appends the locations of the first maxNumberOfOccurrences matches of the pattern in the range specified to occurrences, in one pass.
+		// Returns the number of locations appended.
+		int findOccurrences(const uint8_t* rangeStart, size_t rangeLength, const PatternView& pattern, int maxNumberOfOccurrences, std::vector<const uint8_t*>& occurrences);
+		// Returns true if the pattern matches at the location specified. The caller has to make sure patternSize bytes are readable there.
+		bool matchesAt(const uint8_t* location, const PatternView& pattern);
+
+		// Returns the commonness of the byte value specified in x64 code: 0 is rare, higher values are more common.
+		constexpr int byteCommonness(uint8_t value)
+		{
+			return byteCommonnessTable[value];
+		}
+
+
+		// Determines the anchor indices for the pattern specified, by picking the least common fully compared bytes. constexpr so pattern
+		// literals get their anchors at compile time.
+		constexpr void determineAnchors(const uint8_t* bytePattern, const uint8_t* compareMask, int patternSize, int& anchorIndex, int& secondaryAnchorIndex)
+		{
+			anchorIndex = -1;
+			secondaryAnchorIndex = -1;
+			for (int i = 0; i < patternSize; i++)
+			{
+				if (compareMask[i] != 0)
+				{
+					continue;
+				}
+				if (anchorIndex < 0 || byteCommonness(bytePattern[i]) < byteCommonness(bytePattern[anchorIndex]))
+				{
+					anchorIndex = i;
+				}
+			}
+			if (anchorIndex < 0)
+			{
+				// all wildcards: anything matches, anchor on the first byte.
+				anchorIndex = 0;
+				secondaryAnchorIndex = 0;
+				return;
+			}
+			for (int i = 0; i < patternSize; i++)
+			{
+				if (compareMask[i] != 0 || i == anchorIndex)
+				{
+					continue;
+				}
+				// prefer a secondary anchor with a different value, as a repeated value filters less.
+				if (secondaryAnchorIndex < 0)
+				{
+					secondaryAnchorIndex = i;
+					continue;
+				}
+				bool candidateIsDifferent = bytePattern[i] != bytePattern[anchorIndex];
+				bool currentIsDifferent = bytePattern[secondaryAnchorIndex] != bytePattern[anchorIndex];
+				if ((candidateIsDifferent && !currentIsDifferent) ||
+					(candidateIsDifferent == currentIsDifferent && byteCommonness(bytePattern[i]) < byteCommonness(bytePattern[secondaryAnchorIndex])))
+				{
+					secondaryAnchorIndex = i;
+				}
+			}
+			if (secondaryAnchorIndex < 0)
+			{
+				// only one fully compared byte
+				secondaryAnchorIndex = anchorIndex;
+			}
+		}
+	}
+}
@@ -0,0 +1,279 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ApproximateScanner.h"
+#include <atomic>
+#include <thread>
+
+namespace IGCS::ApproximateScanner
+{
+	static const size_t CHUNK_SIZE = 256 * 1024;
+	static const int MAX_NUMBER_OF_WORDS = 8;
+
+	// The shift-add tables of a pattern. Every pattern position has a counter of counterBits bits, the highest bit of which is the overflow
+	// bit. Per byte value, mismatchCounters contains the words with a 1 in the counter of every position the byte doesn't match.
+	struct ShiftAddTables
+	{
+		int patternSize;
+		int counterBits;
+		int countersPerWord;
+		int numberOfWords;
+		std::vector<uint64_t> mismatchCounters;		// 256 * numberOfWords
+		uint64_t overflowBits;						// the overflow bit of every counter in a word
+	};
+
+
+	// The best location found in a chunk.
+	struct ChunkResult
+	{
+		int numberOfMismatches;
+		int numberOfCandidates;
+		const uint8_t* location;
+	};
+
+
+	static bool buildTables(const PatternView& pattern, int maxNumberOfMismatches, ShiftAddTables& tables)
+	{
+		// the counter has to be able to hold maxNumberOfMismatches without setting the overflow bit. Powers of 2 only, so the counters
+		// fill the words completely.
+		int counterBits = 2;
+		while ((1 << (counterBits - 1)) <= maxNumberOfMismatches)
+		{
+			counterBits *= 2;
+		}
+		tables.patternSize = pattern.patternSize;
+		tables.counterBits = counterBits;
+		tables.countersPerWord = 64 / counterBits;
+		tables.numberOfWords = (pattern.patternSize + tables.countersPerWord - 1) / tables.countersPerWord;
+		if (tables.numberOfWords > MAX_NUMBER_OF_WORDS)
+		{
+			return false;
+		}
+		tables.overflowBits = 0;
+		for (int i = 0; i < tables.countersPerWord; i++)
+		{
+			tables.overflowBits |= 1ULL << (i * counterBits + counterBits - 1);
+		}
+		tables.mismatchCounters.assign(256 * static_cast<size_t>(tables.numberOfWords), 0);
+		for (int value = 0; value < 256; value++)
+		{
+			uint64_t* counters = &tables.mismatchCounters[static_cast<size_t>(value) * tables.numberOfWords];
+			for (int position = 0; position < pattern.patternSize; position++)
+			{
+				if (((value ^ pattern.bytePattern[position]) & ~pattern.compareMask[position] & 0xFF) != 0)
+				{
+					counters[position / tables.countersPerWord] |= 1ULL << ((position % tables.countersPerWord) * counterBits);
+				}
+			}
+		}
+		return true;
+	}
+
+
+	// Finds the best location of the pattern which starts inside the chunk [chunkStart, chunkStart+chunkLength) of the range. Bytes after
+	// the chunk are read for locations which start in the chunk. After reading the byte at index i, the counter of position p contains the
+	// number of mismatches of pattern bytes 0..p aligned to end at i, so the counter of the last position is the number of mismatches of
+	// the pattern starting at i - patternSize + 1.
+	template<int NumberOfWords>
+	static ChunkResult scanChunk(const ShiftAddTables& tables, const uint8_t* rangeStart, size_t rangeLength, size_t chunkStart, size_t chunkLength, int maxNumberOfMismatches)
+	{
+		ChunkResult toReturn{ maxNumberOfMismatches + 1, 0, nullptr };
+		const size_t patternSize = static_cast<size_t>(tables.patternSize);
+		if (rangeLength < patternSize || chunkStart > rangeLength - patternSize)
+		{
+			return toReturn;
+		}
+		const size_t endOfStarts = (std::min)(chunkStart + chunkLength, rangeLength - patternSize + 1);
+		const size_t endOfBytesToRead = endOfStarts + patternSize - 1;
+		const int counterBits = tables.counterBits;
+		const int topCounterShift = (tables.countersPerWord - 1) * counterBits;
+		const int lastWord = (tables.patternSize - 1) / tables.countersPerWord;
+		const int lastCounterShift = ((tables.patternSize - 1) % tables.countersPerWord) * counterBits;
+		const uint64_t counterValueMask = (1ULL << (counterBits - 1)) - 1;
+		const uint64_t overflowBits = tables.overflowBits;
+		uint64_t counters[NumberOfWords] = {};
+		uint64_t overflows[NumberOfWords] = {};
+		for (size_t index = chunkStart; index < endOfBytesToRead; index++)
+		{
+			const uint64_t* mismatchCounters = &tables.mismatchCounters[static_cast<size_t>(rangeStart[index]) * NumberOfWords];
+			// shift every counter one position up, the top counter of a word moves to the bottom of the next word.
+			for (int word = NumberOfWords - 1; word >= 0; word--)
+			{
+				const uint64_t carry = word > 0 ? (counters[word - 1] >> topCounterShift) : 0;
+				const uint64_t overflowCarry = word > 0 ? (overflows[word - 1] >> topCounterShift) : 0;
+				counters[word] = ((counters[word] << counterBits) | carry) + mismatchCounters[word];
+				overflows[word] = (overflows[word] << counterBits) | overflowCarry | (counters[word] & overflowBits);
+				counters[word] &= ~overflowBits;
+			}
+			if (index < chunkStart + patternSize - 1)
+			{
+				// not a full pattern read yet.
+				continue;
+			}
+			if ((overflows[lastWord] >> (lastCounterShift + counterBits - 1)) & 1)
+			{
+				continue;
+			}
+			const int numberOfMismatches = static_cast<int>((counters[lastWord] >> lastCounterShift) & counterValueMask);
+			if (numberOfMismatches > toReturn.numberOfMismatches)
+			{
+				continue;
+			}
+			if (numberOfMismatches < toReturn.numberOfMismatches)
+			{
+				toReturn.numberOfMismatches = numberOfMismatches;
+				toReturn.numberOfCandidates = 0;
+				toReturn.location = rangeStart + index + 1 - patternSize;
+			}
+			toReturn.numberOfCandidates++;
+		}
+		return toReturn;
+	}
+
+
+	typedef ChunkResult (*ScanChunkFunction)(const ShiftAddTables&, const uint8_t*, size_t, size_t, size_t, int);
+
+	static ScanChunkFunction selectScanChunkFunction(int numberOfWords)
+	{
+		static const ScanChunkFunction functions[MAX_NUMBER_OF_WORDS] =
+		{
+			&scanChunk<1>, &scanChunk<2>, &scanChunk<3>, &scanChunk<4>, &scanChunk<5>, &scanChunk<6>, &scanChunk<7>, &scanChunk<8>,
+		};
+		return functions[numberOfWords - 1];
+	}
+
+
+	ApproximateMatch findBestMatch(const std::vector<ScanRange>& ranges, const PatternView& pattern, int maxNumberOfMismatches, int numberOfThreads)
+	{
+		ApproximateMatch toReturn{ nullptr, 0, 0, 0, {} };
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			toReturn.numberOfComparedBytes += (pattern.compareMask[i] != 0xFF) ? 1 : 0;
+		}
+		ShiftAddTables tables;
+		if (pattern.patternSize <= 0 || maxNumberOfMismatches < 0 || maxNumberOfMismatches > MAX_NUMBER_OF_MISMATCHES || !buildTables(pattern, maxNumberOfMismatches, tables))
+		{
+			return toReturn;
+		}
+		struct Chunk
+		{
+			const ScanRange* range;
+			size_t chunkStart;
+			size_t chunkLength;
+		};
+		std::vector<Chunk> chunks;
+		for (auto& range : ranges)
+		{
+			for (size_t chunkStart = 0; chunkStart < range.length; chunkStart += CHUNK_SIZE)
+			{
+				chunks.push_back(Chunk{ &range, chunkStart, (std::min)(CHUNK_SIZE, range.length - chunkStart) });
+			}
+		}
+		const ScanChunkFunction scanChunkFunction = selectScanChunkFunction(tables.numberOfWords);
+		std::vector<ChunkResult> resultPerChunk(chunks.size());
+		std::atomic<size_t> nextChunk{ 0 };
+		auto worker = [&]()
+		{
+			for (size_t chunkIndex = nextChunk++; chunkIndex < chunks.size(); chunkIndex = nextChunk++)
+			{
+				const Chunk& chunk = chunks[chunkIndex];
+				resultPerChunk[chunkIndex] = scanChunkFunction(tables, chunk.range->start, chunk.range->length, chunk.chunkStart, chunk.chunkLength, maxNumberOfMismatches);
+			}
+		};
+		const int numberOfWorkers = (std::max)(1, (std::min)(numberOfThreads, static_cast<int>(chunks.size())));
+		if (numberOfWorkers <= 1)
+		{
+			worker();
+		}
+		else
+		{
+			std::vector<std::thread> workers;
+			for (int i = 0; i < numberOfWorkers; i++)
+			{
+				workers.emplace_back(worker);
+			}
+			for (auto& workerThread : workers)
+			{
+				workerThread.join();
+			}
+		}
+
+		// merge in image order, so the location reported for equally close candidates doesn't depend on the threads.
+		ChunkResult best{ maxNumberOfMismatches + 1, 0, nullptr };
+		for (auto& chunkResult : resultPerChunk)
+		{
+			if (nullptr == chunkResult.location || chunkResult.numberOfMismatches > best.numberOfMismatches)
+			{
+				continue;
+			}
+			if (chunkResult.numberOfMismatches < best.numberOfMismatches)
+			{
+				best = chunkResult;
+				continue;
+			}
+			best.numberOfCandidates += chunkResult.numberOfCandidates;
+		}
+		if (nullptr == best.location)
+		{
+			return toReturn;
+		}
+		toReturn.location = best.location;
+		toReturn.numberOfMismatches = best.numberOfMismatches;
+		toReturn.numberOfCandidates = best.numberOfCandidates;
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			if (((best.location[i] ^ pattern.bytePattern[i]) & ~pattern.compareMask[i] & 0xFF) != 0)
+			{
+				toReturn.mismatchIndices.push_back(i);
+			}
+		}
+		return toReturn;
+	}
+
+
+	std::string createPatternText(const uint8_t* location, const PatternView& pattern, int customOffset)
+	{
+		static const char hexDigits[] = "0123456789ABCDEF";
+		std::string toReturn;
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			if (i > 0)
+			{
+				toReturn += ' ';
+			}
+			if (customOffset > 0 && i == customOffset)
+			{
+				toReturn += "| ";
+			}
+			const uint8_t compareMask = pattern.compareMask[i];
+			toReturn += (compareMask & 0xF0) ? '?' : hexDigits[location[i] >> 4];
+			toReturn += (compareMask & 0x0F) ? '?' : hexDigits[location[i] & 0x0F];
+		}
+		return toReturn;
+	}
+}
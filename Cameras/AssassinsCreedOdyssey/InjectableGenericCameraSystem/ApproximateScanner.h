@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "AOBScanner.h"
+#include <string>
+#include <vector>
+
+namespace IGCS
+{
+	// The location of a pattern with the fewest mismatched bytes, found by ApproximateScanner.
+	struct ApproximateMatch
+	{
+		const uint8_t* location;			// nullptr if no location has at most the maximum number of mismatches specified.
+		int numberOfMismatches;
+		int numberOfComparedBytes;			// the bytes of the pattern which aren't wildcards.
+		int numberOfCandidates;				// the number of locations with numberOfMismatches mismatches.
+		std::vector<int> mismatchIndices;	// indices in the pattern of the bytes which don't match at location.
+
+		// The fraction of the compared bytes which match at location.
+		double confidence() const
+		{
+			return numberOfComparedBytes > 0 ? static_cast<double>(numberOfComparedBytes - numberOfMismatches) / numberOfComparedBytes : 0.0;
+		}
+
+		// Only a unique best location which matches well enough is usable: if two locations are equally close, there's no way to tell
+		// which one the pattern was written for.
+		bool isUsable(double minimumConfidence) const
+		{
+			return nullptr != location && 1 == numberOfCandidates && confidence() >= minimumConfidence;
+		}
+	};
+
+
+	// Finds the location of a pattern with the fewest mismatched bytes, up to a maximum k, with a bit-parallel shift-add scan (the k-mismatch
+	// variant of shift-or): per pattern position a small mismatch counter is kept in a 64 bit word, so every byte scanned costs a table
+	// lookup, a shift and an add per word of counters, regardless of k. Used as a fallback for blocks of which the exact patterns aren't found
+	// anymore, e.g. because a game update changed a register or a struct offset in the code they match.
+	namespace ApproximateScanner
+	{
+		const double MINIMUM_CONFIDENCE = 0.75;
+		// the counters are at most 8 bits, of which one is the overflow bit.
+		const int MAX_NUMBER_OF_MISMATCHES = 127;
+
+		// Scans the ranges for the location of the pattern with the fewest mismatches, with at most maxNumberOfMismatches. Wildcard bytes
+		// always match, of bytes with a nibble wildcard only the other nibble is compared. A match can't span two ranges.
+		ApproximateMatch findBestMatch(const std::vector<ScanRange>& ranges, const PatternView& pattern, int maxNumberOfMismatches, int numberOfThreads);
+		// Creates the text of a pattern which matches location exactly: the pattern's wildcards and custom offset with the bytes at location,
+		// e.g. to update a pattern after an approximate match.
+		std::string createPatternText(const uint8_t* location, const PatternView& pattern, int customOffset);
+	}
+}
@@ -125,6 +125,11 @@ namespace IGCS::D3D11Hooker
 			screenshotController.storeGrabbedShot(capture_frame(pSwapChain));
 		}
 		screenshotController.presentCalled();
+		if (!(Flags & DXGI_PRESENT_TEST))
+		{
+			// the frame is out, so the camera for the next one can be updated
+			Globals::instance().presentScheduler().presentOccurred();
+		}
 		_presentInProgress = false;
 		return toReturn;
 	}
@@ -33,11 +33,14 @@
 namespace IGCS
 {
 	// System defaults
-	#define FRAME_SLEEP								8		// in milliseconds
+	#define FRAME_SLEEP								8		// in milliseconds. The movement and rotation speeds are tuned for an update at this interval
+	#define PRESENT_WAIT_TIMEOUT_MS					100		// if no frame is presented within this time, camera updates fall back to a timer
+	#define MAX_TICK_DELTA_SECONDS					0.1f	// longer stalls are simulated as this much time
 	#define IGCS_OVERLAY_INI_FILENAME				"IGCS_overlay.ini"
 	#define IGCS_SETTINGS_INI_FILENAME				"IGCS_settings.ini"
 	#define IGCS_SETTINGS_SAVE_DELAY				5.0f	// in seconds
-	#define IGCS_SPLASH_DURATION					8.0f	// in seconds	
+	#define IGCS_SPLASH_DURATION					8.0f	// in seconds
+	#define IGCS_SCAN_CACHE_FILE_EXTENSION			".scancache"	// the scan result cache is stored next to the dll with this extension	
 	#define IGCS_SUPPORT_RAWKEYBOARDINPUT			true	// if set to false, raw keyboard input is ignored.
 
 	// Keyboard system control
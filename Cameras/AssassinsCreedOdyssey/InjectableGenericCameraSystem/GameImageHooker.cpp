@@ -29,9 +29,68 @@
 #include "GameImageHooker.h"
 #include "Defaults.h"
 #include "OverlayConsole.h"
+#include "InstructionDecoder.h"
 
 namespace IGCS::GameImageHooker
 {
+#ifdef _WIN64
+	// jmp qword ptr [0000] followed by the 8 byte address
+	static const int HOOK_INSTRUCTION_LENGTH = sizeof(jmpFarInstructionBytes) + 8;
+#else
+	// jmp <relative address>
+	static const int HOOK_INSTRUCTION_LENGTH = 5;
+#endif
+	// Number of bytes to decode at the start of a hook, enough for the instructions overwritten by the jmp.
+	static const int HOOK_DECODE_WINDOW = HOOK_INSTRUCTION_LENGTH + InstructionDecoder::MAX_INSTRUCTION_LENGTH * 2;
+
+
+#ifdef _WIN64
+	// Checks whether the continue offset specified is at the start of an instruction and past the jmp written by setHook. If not, the
+	// interceptor would continue in the middle of an instruction and the game would crash. Also reports position dependent instructions
+	// in the range overwritten, as the asm function has to replicate these differently.
+	static void validateContinueOffset(LPBYTE startOfHookAddress, DWORD continueOffset)
+	{
+		const uint8_t* code = startOfHookAddress;
+		const size_t available = continueOffset + InstructionDecoder::MAX_INSTRUCTION_LENGTH;
+		const int minimumContinueOffset = InstructionDecoder::coveringLength(code, available, HOOK_INSTRUCTION_LENGTH);
+		if (minimumContinueOffset < 0)
+		{
+			OverlayConsole::instance().logDebug("Couldn't decode the instructions at hook address %p, continue offset isn't checked.", (void*)startOfHookAddress);
+			return;
+		}
+		if (continueOffset < static_cast<DWORD>(HOOK_INSTRUCTION_LENGTH) || !InstructionDecoder::isInstructionBoundary(code, available, continueOffset))
+		{
+			OverlayConsole::instance().logError("Continue offset 0x%x of hook at address %p isn't at the end of an instruction overwritten by the hook. Expected offset: 0x%x",
+												continueOffset, (void*)startOfHookAddress, minimumContinueOffset);
+			return;
+		}
+		for (DWORD offset = 0; offset < continueOffset;)
+		{
+			DecodedInstruction instruction;
+			InstructionDecoder::decode(code + offset, available - offset, instruction);
+			if (instruction.isPositionDependent())
+			{
+				OverlayConsole::instance().logDebug("Hook at address %p overwrites a rip relative instruction or relative jump at offset 0x%x.", (void*)startOfHookAddress, offset);
+			}
+			offset += instruction.length;
+		}
+	}
+#endif
+
+
+	// Determines the continue offset of a hook at the address specified: the offset of the first instruction after the instructions
+	// overwritten by the jmp statement setHook writes. Returns -1 if the instructions can't be decoded.
+	int determineContinueOffset(LPBYTE startOfHookAddress)
+	{
+#ifdef _WIN64
+		return InstructionDecoder::coveringLength(startOfHookAddress, HOOK_DECODE_WINDOW, HOOK_INSTRUCTION_LENGTH);
+#else
+		// the decoder only decodes x64 code.
+		return -1;
+#endif
+	}
+
+
 	// Sets a jmp qword ptr [address] statement at hostImageAddress + startOffset for x64 and a jmp <relative address> for x86
 	void setHook(LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction)
 	{
@@ -42,6 +101,7 @@ namespace IGCS::GameImageHooker
 		LPBYTE startOfHookAddress = hostImageAddress + startOffset;
 		*interceptionContinue = startOfHookAddress + continueOffset;
 #ifdef _WIN64
+		validateContinueOffset(startOfHookAddress, continueOffset);
 		// x64
 		BYTE instruction[14];	// 6 bytes of the jmp qword ptr [0] and 8 bytes for the real address which is stored right after the 6 bytes of jmp qword ptr [0] bytes 
 								// write bytes of jmp qword ptr [address], which is jmp qword ptr 0 offset.
@@ -79,6 +139,24 @@ namespace IGCS::GameImageHooker
 	}
 
 
+	// Sets a hook like the overload above, with as continue offset the end of the instructions overwritten by the jmp statement. Only usable
+	// if the asm function replicates exactly these instructions.
+	void setHook(AOBBlock* hookData, LPBYTE* interceptionContinue, void* asmFunction)
+	{
+		if (hookData->locationInImage() == nullptr)
+		{
+			return;
+		}
+		const int continueOffset = determineContinueOffset(hookData->absoluteAddress());
+		if (continueOffset < 0)
+		{
+			OverlayConsole::instance().logError("Couldn't determine the continue offset for hook '%s', so couldn't set hook.", hookData->blockName().c_str());
+			return;
+		}
+		setHook(hookData, static_cast<DWORD>(continueOffset), interceptionContinue, asmFunction);
+	}
+
+
 	// Writes the bytes pointed at by bufferToWrite starting at address startAddress, for the length in 'length'.
 	void writeRange(LPBYTE startAddress, BYTE* bufferToWrite, int length)
 	{
@@ -34,6 +34,8 @@ namespace IGCS::GameImageHooker
 	void nopRange(AOBBlock* hookData, int length);
 	void setHook(LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction);
 	void setHook(AOBBlock* hookData, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction);
+	void setHook(AOBBlock* hookData, LPBYTE* interceptionContinue, void* asmFunction);
+	int determineContinueOffset(LPBYTE startOfHookAddress);
 	void writeRange(LPBYTE startAddress, BYTE* bufferToWrite, int length);
 	void writeRange(AOBBlock* hookData, BYTE* bufferToWrite, int length);
 }
@@ -37,6 +37,7 @@
 #include "ActionData.h"
 #include <map>
 #include "ScreenshotController.h"
+#include "PresentScheduler.h"
 
 extern "C" BYTE g_cameraEnabled;
 extern "C" BYTE g_gamePaused;
@@ -69,6 +70,7 @@ namespace IGCS
 		ActionData& getKeyCollector() { return _keyCollectorData; }
 		ScreenshotController& getScreenshotController() { return _screenshotController; }
 		void reinitializeScreenshotController();
+		PresentScheduler& presentScheduler() { return _presentScheduler; }
 
 	private:
 		void initializeKeyBindings();
@@ -82,5 +84,6 @@ namespace IGCS
 		map<ActionType, ActionData*> _keyBindingPerActionType;
 		ActionData _keyCollectorData = ActionData("KeyCollector", "", 0, false, false, false);
 		ScreenshotController _screenshotController;
+		PresentScheduler _presentScheduler;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ImageScanner.h"
+#include "Defaults.h"
+#include "MultiPatternScanner.h"
+#include "PEImage.h"
+#include "ScanResultCache.h"
+#include "ApproximateScanner.h"
+#include "OverlayConsole.h"
+#include "Utils.h"
+#include <thread>
+
+using namespace std;
+
+namespace IGCS::ImageScanner
+{
+	// Returns the ranges of the sections of the class specified, or the whole image if it's not a valid PE image.
+	static vector<ScanRange> determineScanRanges(const PEImage& image, SectionClass sectionClass)
+	{
+		if (!image.isValid())
+		{
+			return vector<ScanRange>{ ScanRange{ image.imageStart(), image.imageSize() } };
+		}
+		return image.rangesOfClass(sectionClass);
+	}
+
+
+	// Reports the bytes which differ of a block found with an approximate match and the pattern which matches at its location, so the
+	// maintainers get a head start on updating the camera.
+	static void reportApproximateMatch(AOBBlock* block)
+	{
+		const ApproximateMatch& match = block->approximateMatch();
+		ScanPattern& pattern = block->patternThatMatched();
+		OverlayConsole::instance().logLine("Pattern %d of block '%s' only matches approximately: %d of %d bytes differ. The game has likely been updated, please report this.",
+										   block->patternIndexThatMatched(), block->blockName().c_str(), match.numberOfMismatches, match.numberOfComparedBytes);
+		string mismatches;
+		for (int index : match.mismatchIndices)
+		{
+			char mismatch[64];
+			sprintf_s(mismatch, sizeof(mismatch), "%s%d: %02X instead of %02X", mismatches.empty() ? "" : ", ", index, match.location[index], pattern.view().bytePattern[index]);
+			mismatches += mismatch;
+		}
+		OverlayConsole::instance().logLine("Mismatched bytes of block '%s': %s", block->blockName().c_str(), mismatches.c_str());
+		OverlayConsole::instance().logLine("Pattern of block '%s' at the location found: %s", block->blockName().c_str(),
+										   ApproximateScanner::createPatternText(match.location, pattern.view(), pattern.customOffset()).c_str());
+	}
+
+
+	// Scans the image for all blocks specified, only in the sections each block targets. If the scan result cache next to the dll was created
+	// for the same executable, the cached locations are verified in place and only blocks which fail that verification are scanned.
+	// Returns false if one or more critical blocks weren't found.
+	bool scanForBlocks(LPBYTE imageAddress, DWORD imageSize, map<string, AOBBlock*>& aobBlocks)
+	{
+		PEImage image(imageAddress, imageSize, true);
+		uint64_t fingerprint = calculateExecutableFingerprint(image);
+		string cacheFilename = Utils::obtainDllPath().replace_extension(IGCS_SCAN_CACHE_FILE_EXTENSION).string();
+		ScanResultCache cache;
+		bool cacheLoaded = fingerprint != 0 && cache.load(cacheFilename, fingerprint);
+
+		// one scanner per section class, so each pass only covers the sections its blocks target.
+		map<SectionClass, MultiPatternScanner> scannerPerSectionClass;
+		vector<AOBBlock*> blocksToScan;
+		for (auto& blockEntry : aobBlocks)
+		{
+			AOBBlock* block = blockEntry.second;
+			CachedLocation location;
+			if (cacheLoaded && cache.tryGet(blockEntry.first, location) && block->verifyLocation(image, location))
+			{
+				continue;
+			}
+			block->registerPatterns(scannerPerSectionClass[block->targetSectionClass()]);
+			blocksToScan.push_back(block);
+		}
+		if (blocksToScan.empty())
+		{
+			OverlayConsole::instance().logDebug("All interception offsets obtained from the scan result cache.");
+			return true;
+		}
+		int numberOfThreads = (std::max)(1, static_cast<int>(thread::hardware_concurrency()));
+		for (auto& scannerEntry : scannerPerSectionClass)
+		{
+			vector<ScanRange> ranges = determineScanRanges(image, scannerEntry.first);
+			size_t numberOfBytesToScan = 0;
+			for (auto& range : ranges)
+			{
+				numberOfBytesToScan += range.length;
+			}
+			OverlayConsole::instance().logDebug("Scanning %zu of %u bytes for %d patterns", numberOfBytesToScan, imageSize, scannerEntry.second.numberOfPatterns());
+			scannerEntry.second.scanParallel(ranges, numberOfThreads);
+		}
+		bool toReturn = true;
+		for (AOBBlock* block : blocksToScan)
+		{
+			bool blockResult = block->processScanResults(scannerPerSectionClass[block->targetSectionClass()]);
+			if (!block->found() && block->allowsFuzzyMatching())
+			{
+				blockResult = block->scanApproximately(determineScanRanges(image, block->targetSectionClass()), numberOfThreads);
+				if (block->isApproximateMatch())
+				{
+					reportApproximateMatch(block);
+				}
+			}
+			toReturn &= blockResult;
+		}
+		if (0 == fingerprint)
+		{
+			// not a valid PE image, can't cache.
+			return toReturn;
+		}
+		cache.clear(fingerprint);
+		for (auto& blockEntry : aobBlocks)
+		{
+			AOBBlock* block = blockEntry.second;
+			// an approximate match doesn't verify in place, so it's found again with a scan next time.
+			if (block->found() && !block->isApproximateMatch())
+			{
+				cache.set(blockEntry.first, block->cachedLocation(imageAddress));
+			}
+		}
+		if (!cache.save(cacheFilename))
+		{
+			OverlayConsole::instance().logDebug("Couldn't write scan result cache '%s'", cacheFilename.c_str());
+		}
+		return toReturn;
+	}
+}
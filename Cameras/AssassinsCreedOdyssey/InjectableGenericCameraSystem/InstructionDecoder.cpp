@@ -0,0 +1,399 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "InstructionDecoder.h"
+#include <algorithm>
+
+namespace IGCS::InstructionDecoder
+{
+	// Per opcode flags of the decoding tables.
+	static const uint16_t N = 0x0000;		// no operands encoded in the instruction bytes
+	static const uint16_t M = 0x0001;		// ModRM byte, optionally followed by a SIB byte and a displacement
+	static const uint16_t I8 = 0x0002;		// 8 bit immediate
+	static const uint16_t I16 = 0x0004;		// 16 bit immediate
+	static const uint16_t IZ = 0x0008;		// 16 or 32 bit immediate, depending on the operand size
+	static const uint16_t IV = 0x0010;		// 16, 32 or 64 bit immediate, depending on the operand size (mov reg, imm)
+	static const uint16_t MO = 0x0020;		// 32 or 64 bit absolute address, depending on the address size (mov al/eax, moffs)
+	static const uint16_t R8 = 0x0040;		// 8 bit relative branch target
+	static const uint16_t R32 = 0x0080;		// 32 bit relative branch target
+	static const uint16_t G3 = 0x0100;		// group 3 (test/not/neg/mul/div), only test has an immediate
+	static const uint16_t X = 0x0200;		// invalid in 64-bit mode or not supported
+	static const uint16_t VX = 0x0400;		// VEX prefix
+	static const uint16_t EV = 0x0800;		// EVEX prefix
+	static const uint16_t RG = 0x1000;		// ModRM always addresses a register, regardless of mod (mov to/from control/debug registers)
+
+	static const uint16_t oneByteOpcodes[256] =
+	{
+		//  0       1       2       3       4       5       6       7       8       9       A       B       C       D       E       F
+			M,      M,      M,      M,      I8,     IZ,     X,      X,      M,      M,      M,      M,      I8,     IZ,     X,      N,		// 0x
+			M,      M,      M,      M,      I8,     IZ,     X,      X,      M,      M,      M,      M,      I8,     IZ,     X,      X,		// 1x
+			M,      M,      M,      M,      I8,     IZ,     N,      X,      M,      M,      M,      M,      I8,     IZ,     N,      X,		// 2x
+			M,      M,      M,      M,      I8,     IZ,     N,      X,      M,      M,      M,      M,      I8,     IZ,     N,      X,		// 3x
+			N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,		// 4x
+			N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      N,		// 5x
+			X,      X,      EV,     M,      N,      N,      N,      N,      IZ,     M|IZ,   I8,     M|I8,   N,      N,      N,      N,		// 6x
+			R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,     R8,		// 7x
+			M|I8,   M|IZ,   X,      M|I8,   M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// 8x
+			N,      N,      N,      N,      N,      N,      N,      N,      N,      N,      X,      N,      N,      N,      N,      N,		// 9x
+			MO,     MO,     MO,     MO,     N,      N,      N,      N,      I8,     IZ,     N,      N,      N,      N,      N,      N,		// Ax
+			I8,     I8,     I8,     I8,     I8,     I8,     I8,     I8,     IV,     IV,     IV,     IV,     IV,     IV,     IV,     IV,		// Bx
+			M|I8,   M|I8,   I16,    N,      VX,     VX,     M|I8,   M|IZ,   I16|I8, N,      I16,    N,      N,      I8,     X,      N,		// Cx
+			M,      M,      M,      M,      X,      X,      X,      N,      M,      M,      M,      M,      M,      M,      M,      M,		// Dx
+			R8,     R8,     R8,     R8,     I8,     I8,     I8,     I8,     R32,    R32,    X,      R8,     N,      N,      N,      N,		// Ex
+			N,      N,      N,      N,      N,      N,      M|G3,   M|G3,   N,      N,      N,      N,      N,      N,      M,      M,		// Fx
+	};
+
+	// 0F xx. 0F 38 xx and 0F 3A xx are handled in decode.
+	static const uint16_t twoByteOpcodes[256] =
+	{
+		//  0       1       2       3       4       5       6       7       8       9       A       B       C       D       E       F
+			M,      M,      M,      M,      X,      N,      N,      N,      N,      N,      X,      N,      X,      M,      N,      M|I8,	// 0x
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// 1x
+			M|RG,   M|RG,   M|RG,   M|RG,   X,      X,      X,      X,      M,      M,      M,      M,      M,      M,      M,      M,		// 2x
+			N,      N,      N,      N,      N,      N,      X,      N,      X,      X,      X,      X,      X,      X,      X,      X,		// 3x
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// 4x
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// 5x
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// 6x
+			M|I8,   M|I8,   M|I8,   M|I8,   M,      M,      M,      N,      M,      M,      X,      X,      M,      M,      M,      M,		// 7x
+			R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,    R32,	// 8x
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// 9x
+			N,      N,      N,      M,      M|I8,   M,      X,      X,      N,      N,      N,      M,      M|I8,   M,      M,      M,		// Ax
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M|I8,   M,      M,      M,      M,      M,		// Bx
+			M,      M,      M|I8,   M,      M|I8,   M|I8,   M|I8,   M,      N,      N,      N,      N,      N,      N,      N,      N,		// Cx
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// Dx
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// Ex
+			M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,      M,		// Fx
+	};
+
+
+	static bool isLegacyPrefix(uint8_t value)
+	{
+		switch (value)
+		{
+			case 0x26:
+			case 0x2E:
+			case 0x36:
+			case 0x3E:
+			case 0x64:
+			case 0x65:
+			case 0x66:
+			case 0x67:
+			case 0xF0:
+			case 0xF2:
+			case 0xF3:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+
+	// Returns the flags of an opcode in the opcode map specified by a VEX, EVEX or XOP prefix. All these instructions have a ModRM byte, except
+	// vzeroupper/vzeroall. Map 1 is 0F xx, map 2 is 0F 38 xx, map 3 is 0F 3A xx, maps 5 and 6 are the EVEX only FP16 maps and maps 8-10
+	// are AMD's XOP maps.
+	static uint16_t flagsOfVexOpcode(int map, uint8_t opcode, bool isEvex)
+	{
+		switch (map)
+		{
+			case 1:
+				if (!isEvex && opcode == 0x77)
+				{
+					return N;
+				}
+				return M | (twoByteOpcodes[opcode] & I8);
+			case 2:
+				return M;
+			case 3:
+				return M | I8;
+			case 5:
+			case 6:
+				return isEvex ? M : X;
+			case 8:
+				return M | I8;
+			case 9:
+				return M;
+			case 10:
+				return M | IZ;
+			default:
+				return X;
+		}
+	}
+
+
+	bool decode(const uint8_t* code, size_t available, DecodedInstruction& instruction)
+	{
+		instruction = DecodedInstruction();
+		instruction.modRMOffset = -1;
+		instruction.sibOffset = -1;
+		const size_t maxLength = (std::min)(available, static_cast<size_t>(MAX_INSTRUCTION_LENGTH));
+		size_t index = 0;
+		bool operandSize16 = false;
+		bool addressSize32 = false;
+		bool rexW = false;
+		while (index < maxLength && isLegacyPrefix(code[index]))
+		{
+			operandSize16 |= (code[index] == 0x66);
+			addressSize32 |= (code[index] == 0x67);
+			index++;
+		}
+		// a REX prefix is only a REX prefix if it's directly in front of the opcode
+		if (index < maxLength && (code[index] & 0xF0) == 0x40)
+		{
+			rexW = (code[index] & 0x08) != 0;
+			index++;
+		}
+		instruction.prefixCount = static_cast<int>(index);
+		if (index >= maxLength)
+		{
+			return false;
+		}
+
+		uint16_t flags = N;
+		const uint8_t firstOpcodeByte = code[index];
+		if (firstOpcodeByte == 0x0F)
+		{
+			instruction.opcodeOffset = static_cast<int>(index);
+			index++;
+			if (index >= maxLength)
+			{
+				return false;
+			}
+			switch (code[index])
+			{
+				case 0x38:
+					flags = M;
+					index++;
+					break;
+				case 0x3A:
+					flags = M | I8;
+					index++;
+					break;
+				default:
+					flags = twoByteOpcodes[code[index]];
+					break;
+			}
+		}
+		else
+		{
+			flags = oneByteOpcodes[firstOpcodeByte];
+			// 8F is pop r/m, unless the map select bits of the byte after it are 8 or higher: then it's an XOP prefix, which is laid out like
+			// a 3 byte VEX prefix.
+			const bool isXop = (firstOpcodeByte == 0x8F) && (index + 1 < maxLength) && ((code[index + 1] & 0x1F) >= 8);
+			if (isXop || (flags & (VX | EV)))
+			{
+				// C5 <1 byte>, C4 <2 bytes>, 62 <3 bytes>. The opcode map is in the first byte after C4 or 62.
+				const bool isVex3 = (firstOpcodeByte == 0xC4) || isXop;
+				const size_t prefixLength = (firstOpcodeByte == 0xC5) ? 2 : (isVex3 ? 3 : 4);
+				if (index + prefixLength >= maxLength)
+				{
+					return false;
+				}
+				int map = 1;
+				if (firstOpcodeByte != 0xC5)
+				{
+					map = code[index + 1] & (isVex3 ? 0x1F : 0x07);
+				}
+				index += prefixLength;
+				flags = flagsOfVexOpcode(map, code[index], firstOpcodeByte == 0x62);
+			}
+			instruction.opcodeOffset = static_cast<int>(index);
+		}
+		if (flags & X)
+		{
+			return false;
+		}
+		// past the (last) opcode byte.
+		index++;
+
+		if (flags & M)
+		{
+			if (index >= maxLength)
+			{
+				return false;
+			}
+			const uint8_t modRM = code[index];
+			instruction.modRMOffset = static_cast<int>(index);
+			index++;
+			const int mod = (flags & RG) ? 3 : (modRM >> 6);
+			const int rm = modRM & 0x07;
+			if (mod != 3)
+			{
+				if (rm == 4)
+				{
+					if (index >= maxLength)
+					{
+						return false;
+					}
+					instruction.sibOffset = static_cast<int>(index);
+					if (mod == 0 && (code[index] & 0x07) == 5)
+					{
+						// [index*scale + disp32], no base
+						instruction.displacementSize = 4;
+					}
+					index++;
+				}
+				if (mod == 0 && rm == 5)
+				{
+					instruction.displacementSize = 4;
+					instruction.isRipRelative = true;
+				}
+				else if (mod == 1)
+				{
+					instruction.displacementSize = 1;
+				}
+				else if (mod == 2)
+				{
+					instruction.displacementSize = 4;
+				}
+			}
+			if ((flags & G3) && ((modRM >> 3) & 0x07) < 2)
+			{
+				// test r/m, imm
+				flags |= (firstOpcodeByte == 0xF6) ? I8 : IZ;
+			}
+		}
+		if (instruction.displacementSize > 0)
+		{
+			instruction.displacementOffset = static_cast<int>(index);
+			index += instruction.displacementSize;
+		}
+
+		int immediateSize = 0;
+		immediateSize += (flags & I8) ? 1 : 0;
+		immediateSize += (flags & I16) ? 2 : 0;
+		immediateSize += (flags & IZ) ? ((operandSize16 && !rexW) ? 2 : 4) : 0;
+		immediateSize += (flags & IV) ? (rexW ? 8 : (operandSize16 ? 2 : 4)) : 0;
+		immediateSize += (flags & MO) ? (addressSize32 ? 4 : 8) : 0;
+		immediateSize += (flags & R8) ? 1 : 0;
+		immediateSize += (flags & R32) ? 4 : 0;
+		if (immediateSize > 0)
+		{
+			instruction.immediateOffset = static_cast<int>(index);
+			instruction.immediateSize = immediateSize;
+			// xbegin (C7 F8) has a relative target instead of an immediate.
+			instruction.isRelativeBranch = ((flags & (R8 | R32)) != 0) || (firstOpcodeByte == 0xC7 && instruction.modRMOffset >= 0 && code[instruction.modRMOffset] == 0xF8);
+			index += immediateSize;
+		}
+		if (index > maxLength)
+		{
+			return false;
+		}
+		instruction.length = static_cast<int>(index);
+		return true;
+	}
+
+
+	int coveringLength(const uint8_t* code, size_t available, int minimumLength)
+	{
+		int length = 0;
+		while (length < minimumLength)
+		{
+			DecodedInstruction instruction;
+			if (static_cast<size_t>(length) >= available || !decode(code + length, available - length, instruction))
+			{
+				return -1;
+			}
+			length += instruction.length;
+		}
+		return length;
+	}
+
+
+	bool isInstructionBoundary(const uint8_t* code, size_t available, int offset)
+	{
+		return coveringLength(code, available, offset) == offset;
+	}
+
+
+	bool createCompareMask(const uint8_t* code, int length, uint32_t wildcardFlags, uint8_t* compareMask)
+	{
+		int offset = 0;
+		while (offset < length)
+		{
+			DecodedInstruction instruction;
+			if (!decode(code + offset, static_cast<size_t>(length - offset), instruction))
+			{
+				return false;
+			}
+			uint8_t* instructionMask = compareMask + offset;
+			std::fill(instructionMask, instructionMask + instruction.length, static_cast<uint8_t>(0x00));
+			if (instruction.displacementSize > 0)
+			{
+				const bool wildcardDisplacement = instruction.isRipRelative ? (wildcardFlags & WildcardRipRelative) != 0
+																			: (wildcardFlags & WildcardMemoryDisplacements) != 0;
+				if (wildcardDisplacement)
+				{
+					std::fill(instructionMask + instruction.displacementOffset, instructionMask + instruction.displacementOffset + instruction.displacementSize, static_cast<uint8_t>(0xFF));
+				}
+			}
+			if (instruction.immediateSize > 0)
+			{
+				const bool wildcardImmediate = instruction.isRelativeBranch ? ((wildcardFlags & WildcardBranchTargets) != 0 && instruction.immediateSize == 4)
+																			: ((wildcardFlags & WildcardLargeImmediates) != 0 && instruction.immediateSize >= 4);
+				if (wildcardImmediate)
+				{
+					std::fill(instructionMask + instruction.immediateOffset, instructionMask + instruction.immediateOffset + instruction.immediateSize, static_cast<uint8_t>(0xFF));
+				}
+			}
+			offset += instruction.length;
+		}
+		return true;
+	}
+
+
+	std::string createPattern(const uint8_t* code, int length, uint32_t wildcardFlags)
+	{
+		if (length <= 0)
+		{
+			return "";
+		}
+		std::string compareMask(static_cast<size_t>(length), '\0');
+		if (!createCompareMask(code, length, wildcardFlags, reinterpret_cast<uint8_t*>(&compareMask[0])))
+		{
+			return "";
+		}
+		static const char hexDigits[] = "0123456789ABCDEF";
+		std::string toReturn;
+		toReturn.reserve(static_cast<size_t>(length) * 3);
+		for (int i = 0; i < length; i++)
+		{
+			if (i > 0)
+			{
+				toReturn += ' ';
+			}
+			if (compareMask[i] != '\0')
+			{
+				toReturn += "??";
+				continue;
+			}
+			toReturn += hexDigits[code[i] >> 4];
+			toReturn += hexDigits[code[i] & 0x0F];
+		}
+		return toReturn;
+	}
+}
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace IGCS
+{
+	// The fields of a single decoded x64 instruction. Offsets are relative to the start of the instruction, a size of 0 means the instruction
+	// doesn't have that field.
+	struct DecodedInstruction
+	{
+		int length;
+		int prefixCount;			// legacy prefixes and REX prefix
+		int opcodeOffset;			// offset of the first opcode byte, after a VEX/EVEX prefix if present
+		int modRMOffset;			// -1 if the instruction doesn't have a ModRM byte
+		int sibOffset;				// -1 if the instruction doesn't have a SIB byte
+		int displacementOffset;
+		int displacementSize;
+		int immediateOffset;
+		int immediateSize;			// also used for the address of mov al/eax, moffs and the target of relative branches
+		bool isRipRelative;			// the displacement is relative to the end of the instruction
+		bool isRelativeBranch;		// the immediate is a branch target relative to the end of the instruction
+
+		// true if the instruction can't be executed at another address as-is.
+		bool isPositionDependent() const { return isRipRelative || isRelativeBranch; }
+	};
+
+
+	// Compact length decoder for x64 code (64-bit mode only): determines the length of an instruction and where its displacement and immediate
+	// are, without decoding what the instruction does. Used to determine how many bytes a hook overwrites and to create patterns from code.
+	namespace InstructionDecoder
+	{
+		// Which bytes createCompareMask / createPattern make wildcards.
+		enum WildcardFlags : uint32_t
+		{
+			WildcardNone = 0,
+			WildcardRipRelative = 0x1,				// displacements of rip relative operands, they change with every build
+			WildcardBranchTargets = 0x2,			// rel32 targets of call/jmp/jcc. rel8 targets are local to the function and are kept
+			WildcardLargeImmediates = 0x4,			// 32 and 64 bit immediates and absolute addresses
+			WildcardMemoryDisplacements = 0x8,		// displacements of other memory operands, e.g. offsets in structs
+			WildcardDefault = WildcardRipRelative | WildcardBranchTargets | WildcardLargeImmediates,
+		};
+
+		const int MAX_INSTRUCTION_LENGTH = 15;
+
+		// Decodes the instruction at code, reading at most available bytes. Returns false if the bytes aren't a valid x64 instruction or if
+		// the instruction is longer than available.
+		bool decode(const uint8_t* code, size_t available, DecodedInstruction& instruction);
+		// Returns the length of the whole instructions starting at code which together are at least minimumLength bytes long, i.e. the
+		// number of bytes a jmp of minimumLength bytes overwrites. Returns -1 if the code can't be decoded.
+		int coveringLength(const uint8_t* code, size_t available, int minimumLength);
+		// Returns true if offset is the start of an instruction when decoding from code.
+		bool isInstructionBoundary(const uint8_t* code, size_t available, int offset);
+		// Fills compareMask (length bytes) with the mask for the instructions in code, in the format of PatternView::compareMask: 0xFF for
+		// the bytes to skip as specified by wildcardFlags, 0x00 for the others. Returns false if code doesn't end on an instruction boundary
+		// at length or can't be decoded.
+		bool createCompareMask(const uint8_t* code, int length, uint32_t wildcardFlags, uint8_t* compareMask);
+		// Creates a pattern for ScanPattern from the first length bytes of code, e.g. "48 8B 05 ?? ?? ?? ?? 48 85 C0". Returns an empty
+		// string if the bytes can't be decoded.
+		std::string createPattern(const uint8_t* code, int length, uint32_t wildcardFlags = WildcardDefault);
+	}
+}
@@ -32,6 +32,7 @@
 #include <map>
 #include "OverlayConsole.h"
 #include "CameraManipulator.h"
+#include "ImageScanner.h"
 
 using namespace std;
 
@@ -65,26 +66,21 @@ namespace IGCS::GameSpecific::InterceptorHelper
 {
 	void initializeAOBBlocks(LPBYTE hostImageAddress, DWORD hostImageSize, map<string, AOBBlock*> &aobBlocks)
 	{
-		aobBlocks[CAMERA_ADDRESS_INTERCEPT_KEY] = new AOBBlock(CAMERA_ADDRESS_INTERCEPT_KEY, "66 0F 7F 86 90 00 00 00 66 0F 7F 0F", 1);	
-		aobBlocks[CAMERA_WRITE1_INTERCEPT_KEY] = new AOBBlock(CAMERA_WRITE1_INTERCEPT_KEY, "0F 29 02 0F 28 71 20 41 0F 28 10 41 0F 28 38 0F 28 E2", 1);
-		aobBlocks[CAMERA_WRITE2_INTERCEPT_KEY] = new AOBBlock(CAMERA_WRITE2_INTERCEPT_KEY, "41 0F 29 38 F3 0F 10 41 30 F3 41 0F 58 01 0F 28 3C 24 F3 41 0F 11 01", 1);
-		aobBlocks[TIMESTOP_READ_INTERCEPT_KEY] = new AOBBlock(TIMESTOP_READ_INTERCEPT_KEY, "48 89 54 24 28 48 8B 57 18 83 E1 10 4C 31 C1 41 0F 29 7B A8", 1);
-		aobBlocks[TOD_WRITE_INTERCEPT_KEY] = new AOBBlock(TOD_WRITE_INTERCEPT_KEY, "0F 2F D1 F3 0F 11 12 72 ?? F3 0F 5C D1", 1);
-		aobBlocks[RESOLUTION_SCALE_INTERCEPT_KEY] = new AOBBlock(RESOLUTION_SCALE_INTERCEPT_KEY, "48 8B 70 60 48 8B 82 48 02 00 00 48 89 B4 24 B8 00 00 00", 1);
-		aobBlocks[PAUSE_FUNCTION_LOCATION_KEY] = new AOBBlock(PAUSE_FUNCTION_LOCATION_KEY, "53 48 83 EC 20 48 89 CB 48 8D 0D ?? ?? ?? ?? E8 ?? ?? ?? ?? FF 83 6C 18 00 00 83 BB 6C 18 00 00 01", 1);
-		aobBlocks[UNPAUSE_FUNCTION_LOCATION_KEY] = new AOBBlock(UNPAUSE_FUNCTION_LOCATION_KEY, "53 48 83 EC 20 48 89 CB 48 8D 0D ?? ?? ?? ?? E8 ?? ?? ?? ?? 8B 83 ?? ?? ?? ?? 85 C0", 1);
-		aobBlocks[HUD_RENDER_INTERCEPT_KEY] = new AOBBlock(HUD_RENDER_INTERCEPT_KEY, "48 89 E0 48 89 58 08 55 56 57 41 54 41 55 41 56 41 57 48 ?? ?? ?? B0", 1);
-		aobBlocks[PHOTOMODE_RANGE_DISABLE_KEY] = new AOBBlock(PHOTOMODE_RANGE_DISABLE_KEY, "F3 41 0F 5D D0 0F 28 C1 0F C6 D2 00 41 0F 59 D2", 1);
-		aobBlocks[DOF_ENABLE_WRITE_LOCATION_KEY] = new AOBBlock(DOF_ENABLE_WRITE_LOCATION_KEY, "88 83 11 01 00 00 E8 ?? ?? ?? ?? 88 83 13 01 00 00 84 C0", 1);
-		aobBlocks[AR_LIMIT_LOCATION_KEY] = new AOBBlock(AR_LIMIT_LOCATION_KEY, "F3 44 0F 59 CF 41 0F 28 D0 F3 0F 5C C2 0F 28 FA 44 0F 28 F2", 1);
-		aobBlocks[FOG_READ_INTERCEPT_KEY] = new AOBBlock(FOG_READ_INTERCEPT_KEY, "F3 41 0F 10 7E 58 F3 44 0F 59 51 20 F3 45 0F 10 46 50 0F 29 44 24 70", 1);
+		aobBlocks[CAMERA_ADDRESS_INTERCEPT_KEY] = new AOBBlock(CAMERA_ADDRESS_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("66 0F 7F 86 90 00 00 00 66 0F 7F 0F"), 1));	
+		aobBlocks[CAMERA_WRITE1_INTERCEPT_KEY] = new AOBBlock(CAMERA_WRITE1_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("0F 29 02 0F 28 71 20 41 0F 28 10 41 0F 28 38 0F 28 E2"), 1));
+		aobBlocks[CAMERA_WRITE2_INTERCEPT_KEY] = new AOBBlock(CAMERA_WRITE2_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("41 0F 29 38 F3 0F 10 41 30 F3 41 0F 58 01 0F 28 3C 24 F3 41 0F 11 01"), 1));
+		aobBlocks[TIMESTOP_READ_INTERCEPT_KEY] = new AOBBlock(TIMESTOP_READ_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("48 89 54 24 28 48 8B 57 18 83 E1 10 4C 31 C1 41 0F 29 7B A8"), 1));
+		aobBlocks[TOD_WRITE_INTERCEPT_KEY] = new AOBBlock(TOD_WRITE_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("0F 2F D1 F3 0F 11 12 72 ?? F3 0F 5C D1"), 1));
+		aobBlocks[RESOLUTION_SCALE_INTERCEPT_KEY] = new AOBBlock(RESOLUTION_SCALE_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("48 8B 70 60 48 8B 82 48 02 00 00 48 89 B4 24 B8 00 00 00"), 1));
+		aobBlocks[PAUSE_FUNCTION_LOCATION_KEY] = new AOBBlock(PAUSE_FUNCTION_LOCATION_KEY, ScanPattern(IGCS_AOB_PATTERN("53 48 83 EC 20 48 89 CB 48 8D 0D ?? ?? ?? ?? E8 ?? ?? ?? ?? FF 83 6C 18 00 00 83 BB 6C 18 00 00 01"), 1));
+		aobBlocks[UNPAUSE_FUNCTION_LOCATION_KEY] = new AOBBlock(UNPAUSE_FUNCTION_LOCATION_KEY, ScanPattern(IGCS_AOB_PATTERN("53 48 83 EC 20 48 89 CB 48 8D 0D ?? ?? ?? ?? E8 ?? ?? ?? ?? 8B 83 ?? ?? ?? ?? 85 C0"), 1));
+		aobBlocks[HUD_RENDER_INTERCEPT_KEY] = new AOBBlock(HUD_RENDER_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("48 89 E0 48 89 58 08 55 56 57 41 54 41 55 41 56 41 57 48 ?? ?? ?? B0"), 1));
+		aobBlocks[PHOTOMODE_RANGE_DISABLE_KEY] = new AOBBlock(PHOTOMODE_RANGE_DISABLE_KEY, ScanPattern(IGCS_AOB_PATTERN("F3 41 0F 5D D0 0F 28 C1 0F C6 D2 00 41 0F 59 D2"), 1));
+		aobBlocks[DOF_ENABLE_WRITE_LOCATION_KEY] = new AOBBlock(DOF_ENABLE_WRITE_LOCATION_KEY, ScanPattern(IGCS_AOB_PATTERN("88 83 11 01 00 00 E8 ?? ?? ?? ?? 88 83 13 01 00 00 84 C0"), 1));
+		aobBlocks[AR_LIMIT_LOCATION_KEY] = new AOBBlock(AR_LIMIT_LOCATION_KEY, ScanPattern(IGCS_AOB_PATTERN("F3 44 0F 59 CF 41 0F 28 D0 F3 0F 5C C2 0F 28 FA 44 0F 28 F2"), 1));
+		aobBlocks[FOG_READ_INTERCEPT_KEY] = new AOBBlock(FOG_READ_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("F3 41 0F 10 7E 58 F3 44 0F 59 51 20 F3 45 0F 10 46 50 0F 29 44 24 70"), 1));
 
-		map<string, AOBBlock*>::iterator it;
-		bool result = true;
-		for (it = aobBlocks.begin(); it != aobBlocks.end(); it++)
-		{
-			result &= it->second->scan(hostImageAddress, hostImageSize);
-		}
+		bool result = ImageScanner::scanForBlocks(hostImageAddress, hostImageSize, aobBlocks);
 		if (result)
 		{
 			OverlayConsole::instance().logLine("All interception offsets found.");
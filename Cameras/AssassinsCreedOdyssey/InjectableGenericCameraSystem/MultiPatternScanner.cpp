@@ -0,0 +1,373 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "MultiPatternScanner.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace IGCS
+{
+	// Segments are capped so the tables stay small, and patterns with a shorter non-wildcard run than the minimum would limit the shift
+	// distance for all other patterns, so these are scanned individually.
+	static const int MAX_SEGMENT_LENGTH = 16;
+	static const int MIN_SEGMENT_LENGTH = 4;
+	static const int NUMBER_OF_BLOCK_HASHES = 0x10000;
+	// Size of the chunks scanned by a worker thread in a parallel scan. Small enough to stay in the L2 cache of a core.
+	static const size_t CHUNK_SIZE = 256 * 1024;
+	// Number of matches recorded per pattern in the occurrence index, unless a later occurrence is requested. A pattern which matches more often
+	// than this is useless anyway, this merely prevents a pattern like that from filling memory.
+	static const int MATCH_INDEX_LIMIT = 32;
+
+	MultiPatternScanner::MultiPatternScanner() : _segmentLength{ 0 }, _maxPatternSize{ 1 }
+	{
+	}
+
+
+	MultiPatternScanner::~MultiPatternScanner()
+	{
+	}
+
+
+	int MultiPatternScanner::addPattern(const PatternView& pattern, int occurrence)
+	{
+		int patternIndex = 0;
+		for (; patternIndex < static_cast<int>(_patterns.size()); patternIndex++)
+		{
+			const PatternView& existing = _patterns[patternIndex].pattern;
+			if (existing.patternSize == pattern.patternSize && (pattern.patternSize <= 0 ||
+				(memcmp(existing.bytePattern, pattern.bytePattern, pattern.patternSize) == 0 && memcmp(existing.compareMask, pattern.compareMask, pattern.patternSize) == 0)))
+			{
+				break;
+			}
+		}
+		if (patternIndex >= static_cast<int>(_patterns.size()))
+		{
+			_patterns.push_back(PatternEntry{ pattern, -1, MATCH_INDEX_LIMIT, {} });
+		}
+		// record one more than requested, so we can tell whether the requested occurrence is ambiguous.
+		_patterns[patternIndex].matchLimit = (std::max)(_patterns[patternIndex].matchLimit, occurrence + 1);
+		_queries.push_back(PatternQuery{ patternIndex, occurrence });
+		return static_cast<int>(_queries.size()) - 1;
+	}
+
+
+	const uint8_t* MultiPatternScanner::location(int patternId, int occurrence) const
+	{
+		const std::vector<const uint8_t*>& indexedOccurrences = occurrences(patternId);
+		if (occurrence <= 0 || static_cast<size_t>(occurrence) > indexedOccurrences.size())
+		{
+			return nullptr;
+		}
+		return indexedOccurrences[occurrence - 1];
+	}
+
+
+	bool MultiPatternScanner::isIndexComplete(int patternId) const
+	{
+		const PatternEntry& entry = _patterns[_queries[patternId].patternIndex];
+		return entry.occurrences.size() < static_cast<size_t>(entry.matchLimit);
+	}
+
+
+	void MultiPatternScanner::scan(const uint8_t* rangeStart, size_t rangeLength)
+	{
+		scan(std::vector<ScanRange>{ ScanRange{ rangeStart, rangeLength } });
+	}
+
+
+	void MultiPatternScanner::scan(const std::vector<ScanRange>& ranges)
+	{
+		buildTables();
+		resetResults();
+		MatchesPerPattern matches(_patterns.size());
+		for (auto& range : ranges)
+		{
+			scanChunk(range.start, range.length, 0, range.length, matches);
+		}
+		mergeChunkResults(matches);
+	}
+
+
+	void MultiPatternScanner::scanParallel(const uint8_t* rangeStart, size_t rangeLength, int numberOfThreads)
+	{
+		scanParallel(std::vector<ScanRange>{ ScanRange{ rangeStart, rangeLength } }, numberOfThreads);
+	}
+
+
+	void MultiPatternScanner::scanParallel(const std::vector<ScanRange>& ranges, int numberOfThreads)
+	{
+		struct Chunk
+		{
+			const ScanRange* range;
+			size_t chunkStart;
+			size_t chunkLength;
+		};
+
+		std::vector<Chunk> chunks;
+		for (auto& range : ranges)
+		{
+			for (size_t chunkStart = 0; chunkStart < range.length; chunkStart += CHUNK_SIZE)
+			{
+				chunks.push_back(Chunk{ &range, chunkStart, (std::min)(CHUNK_SIZE, range.length - chunkStart) });
+			}
+		}
+		if (numberOfThreads <= 1 || chunks.size() <= 1)
+		{
+			scan(ranges);
+			return;
+		}
+		buildTables();
+		resetResults();
+		std::vector<MatchesPerPattern> matchesPerChunk(chunks.size(), MatchesPerPattern(_patterns.size()));
+		std::atomic<size_t> nextChunk{ 0 };
+		auto worker = [&]()
+		{
+			for (size_t chunkIndex = nextChunk++; chunkIndex < chunks.size(); chunkIndex = nextChunk++)
+			{
+				const Chunk& chunk = chunks[chunkIndex];
+				scanChunk(chunk.range->start, chunk.range->length, chunk.chunkStart, chunk.chunkLength, matchesPerChunk[chunkIndex]);
+			}
+		};
+		std::vector<std::thread> workers;
+		for (int i = 0; i < numberOfThreads; i++)
+		{
+			workers.emplace_back(worker);
+		}
+		for (auto& workerThread : workers)
+		{
+			workerThread.join();
+		}
+		// merge in image order, this makes the occurrence counting deterministic regardless of which thread scanned what.
+		for (auto& matches : matchesPerChunk)
+		{
+			mergeChunkResults(matches);
+		}
+	}
+
+
+	void MultiPatternScanner::resetResults()
+	{
+		for (auto& entry : _patterns)
+		{
+			entry.occurrences.clear();
+		}
+	}
+
+
+	// Collects the matches of all patterns which start inside the chunk [chunkStart, chunkStart+chunkLength). Bytes after the chunk are read
+	// up to the largest pattern size - 1 so matches which start at the end of the chunk are found too. Matches are collected till the pattern's
+	// match limit has been reached.
+	void MultiPatternScanner::scanChunk(const uint8_t* rangeStart, size_t rangeLength, size_t chunkStart, size_t chunkLength, MatchesPerPattern& matches)
+	{
+		const size_t chunkEnd = chunkStart + chunkLength;
+		int numberOfPatternsToIndex = 0;
+		for (size_t patternIndex = 0; patternIndex < _patterns.size(); patternIndex++)
+		{
+			PatternEntry& entry = _patterns[patternIndex];
+			if (matches[patternIndex].size() >= static_cast<size_t>(entry.matchLimit))
+			{
+				// limit already reached in an earlier range
+				continue;
+			}
+			if (entry.segmentOffset >= 0)
+			{
+				numberOfPatternsToIndex++;
+				continue;
+			}
+			// scanned individually. Any match in this window starts inside the chunk.
+			const size_t scanEnd = (std::min)(rangeLength, chunkEnd + entry.pattern.patternSize - 1);
+			AOBScanner::findOccurrences(rangeStart + chunkStart, scanEnd - chunkStart, entry.pattern, 
+										entry.matchLimit - static_cast<int>(matches[patternIndex].size()), matches[patternIndex]);
+		}
+		const size_t scanEnd = (std::min)(rangeLength, chunkEnd + _maxPatternSize - 1);
+		if (numberOfPatternsToIndex <= 0 || scanEnd - chunkStart < static_cast<size_t>(_segmentLength))
+		{
+			return;
+		}
+		size_t position = chunkStart + _segmentLength - 1;		// position of the last byte of the window.
+		while (position < scanEnd)
+		{
+			int hash = blockHash(rangeStart + position - 1);
+			uint8_t shift = _shiftTable[hash];
+			if (shift > 0)
+			{
+				position += shift;
+				continue;
+			}
+			const size_t windowStart = position - (_segmentLength - 1);
+			for (uint32_t i = _bucketStarts[hash]; i < _bucketStarts[hash + 1]; i++)
+			{
+				int patternIndex = _bucketPatternIndices[i];
+				PatternEntry& entry = _patterns[patternIndex];
+				if (matches[patternIndex].size() >= static_cast<size_t>(entry.matchLimit) || windowStart < chunkStart + entry.segmentOffset)
+				{
+					continue;
+				}
+				const size_t patternStart = windowStart - entry.segmentOffset;
+				if (patternStart >= chunkEnd || rangeLength - patternStart < static_cast<size_t>(entry.pattern.patternSize) ||
+					memcmp(rangeStart + windowStart, entry.pattern.bytePattern + entry.segmentOffset, _segmentLength) != 0 ||
+					!AOBScanner::matchesAt(rangeStart + patternStart, entry.pattern))
+				{
+					continue;
+				}
+				matches[patternIndex].push_back(rangeStart + patternStart);
+				if (matches[patternIndex].size() >= static_cast<size_t>(entry.matchLimit))
+				{
+					numberOfPatternsToIndex--;
+					if (numberOfPatternsToIndex <= 0)
+					{
+						// all limits reached, no need to scan the rest of the chunk.
+						return;
+					}
+				}
+			}
+			position++;
+		}
+	}
+
+
+	void MultiPatternScanner::mergeChunkResults(const MatchesPerPattern& matches)
+	{
+		for (size_t patternIndex = 0; patternIndex < _patterns.size(); patternIndex++)
+		{
+			PatternEntry& entry = _patterns[patternIndex];
+			for (const uint8_t* location : matches[patternIndex])
+			{
+				if (entry.occurrences.size() >= static_cast<size_t>(entry.matchLimit))
+				{
+					break;
+				}
+				entry.occurrences.push_back(location);
+			}
+		}
+	}
+
+
+	void MultiPatternScanner::buildTables()
+	{
+		_segmentLength = MAX_SEGMENT_LENGTH;
+		_maxPatternSize = 1;
+		bool patternsToShareScan = false;
+		for (auto& entry : _patterns)
+		{
+			_maxPatternSize = (std::max)(_maxPatternSize, entry.pattern.patternSize);
+			int runLength = longestNonWildcardRun(entry.pattern);
+			if (runLength < MIN_SEGMENT_LENGTH)
+			{
+				entry.segmentOffset = -1;
+				continue;
+			}
+			_segmentLength = (std::min)(_segmentLength, runLength);
+			patternsToShareScan = true;
+		}
+		_shiftTable.assign(NUMBER_OF_BLOCK_HASHES, static_cast<uint8_t>(_segmentLength - 1));
+		_bucketStarts.assign(NUMBER_OF_BLOCK_HASHES + 1, 0);
+		_bucketPatternIndices.clear();
+		if (!patternsToShareScan)
+		{
+			return;
+		}
+		std::vector<int> lastBlockHashPerPattern(_patterns.size(), -1);
+		for (size_t patternIndex = 0; patternIndex < _patterns.size(); patternIndex++)
+		{
+			PatternEntry& entry = _patterns[patternIndex];
+			if (longestNonWildcardRun(entry.pattern) < MIN_SEGMENT_LENGTH)
+			{
+				continue;
+			}
+			entry.segmentOffset = findSegmentOffset(entry.pattern, _segmentLength);
+			const uint8_t* segment = entry.pattern.bytePattern + entry.segmentOffset;
+			for (int blockEnd = 2; blockEnd <= _segmentLength; blockEnd++)
+			{
+				int hash = blockHash(segment + blockEnd - 2);
+				_shiftTable[hash] = (std::min)(_shiftTable[hash], static_cast<uint8_t>(_segmentLength - blockEnd));
+			}
+			int lastBlockHash = blockHash(segment + _segmentLength - 2);
+			lastBlockHashPerPattern[patternIndex] = lastBlockHash;
+			_bucketStarts[lastBlockHash + 1]++;
+		}
+		for (int hash = 0; hash < NUMBER_OF_BLOCK_HASHES; hash++)
+		{
+			_bucketStarts[hash + 1] += _bucketStarts[hash];
+		}
+		_bucketPatternIndices.resize(_bucketStarts[NUMBER_OF_BLOCK_HASHES]);
+		std::vector<uint32_t> insertPositions(_bucketStarts.begin(), _bucketStarts.end() - 1);
+		for (size_t patternIndex = 0; patternIndex < _patterns.size(); patternIndex++)
+		{
+			if (lastBlockHashPerPattern[patternIndex] >= 0)
+			{
+				_bucketPatternIndices[insertPositions[lastBlockHashPerPattern[patternIndex]]++] = static_cast<int>(patternIndex);
+			}
+		}
+	}
+
+
+	// Returns the offset of the run of segmentLength non-wildcard bytes in the pattern with the least common bytes, which keeps the number
+	// of full compares low.
+	int MultiPatternScanner::findSegmentOffset(const PatternView& pattern, int segmentLength)
+	{
+		int toReturn = -1;
+		int lowestCommonness = 0;
+		int runLength = 0;
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			runLength = pattern.compareMask[i] == 0 ? runLength + 1 : 0;
+			if (runLength < segmentLength)
+			{
+				continue;
+			}
+			int offset = i - segmentLength + 1;
+			int commonness = 0;
+			for (int j = offset; j <= i; j++)
+			{
+				commonness += AOBScanner::byteCommonness(pattern.bytePattern[j]);
+			}
+			if (toReturn < 0 || commonness < lowestCommonness)
+			{
+				toReturn = offset;
+				lowestCommonness = commonness;
+			}
+		}
+		return toReturn;
+	}
+
+
+	int MultiPatternScanner::longestNonWildcardRun(const PatternView& pattern)
+	{
+		int toReturn = 0;
+		int runLength = 0;
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			runLength = pattern.compareMask[i] == 0 ? runLength + 1 : 0;
+			toReturn = (std::max)(toReturn, runLength);
+		}
+		return toReturn;
+	}
+}
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "AOBScanner.h"
+#include <vector>
+
+namespace IGCS
+{
+	// Scans an image for a set of patterns in a single pass, using a Wu-Manber style shift table over a fixed length segment of
+	// non-wildcard bytes taken from every pattern. Occurrences are found in image order, so the n-th occurrence of a pattern is the same
+	// location as the one found by AOBScanner::findPattern. Patterns without a long enough non-wildcard segment are scanned individually.
+	// Every match of a pattern is recorded in an occurrence index (up to a limit), so any occurrence can be served without scanning again,
+	// identical patterns added more than once, e.g. for different occurrences, are scanned for once, and patterns which match more often
+	// than expected can be reported.
+	class MultiPatternScanner
+	{
+	public:
+		MultiPatternScanner();
+		~MultiPatternScanner();
+
+		// Adds the pattern to the set to scan for and returns its id. The pattern data has to stay alive till scan() has been called.
+		// Adding a pattern which is identical to one added earlier shares the scan and the occurrence index of the earlier one.
+		int addPattern(const PatternView& pattern, int occurrence);
+		void scan(const uint8_t* rangeStart, size_t rangeLength);
+		// Scans the ranges specified, in the order specified, as if they're one image: occurrences are counted across the ranges.
+		// A match can't span two ranges.
+		void scan(const std::vector<ScanRange>& ranges);
+		// Same result as scan() but the ranges are split into chunks which are scanned by numberOfThreads worker threads. Matches are merged
+		// in chunk order afterwards so the n-th occurrence of a pattern is the same as with a serial scan.
+		void scanParallel(const uint8_t* rangeStart, size_t rangeLength, int numberOfThreads);
+		void scanParallel(const std::vector<ScanRange>& ranges, int numberOfThreads);
+		// Returns the location of the requested occurrence of the pattern with the id specified or nullptr if not found.
+		const uint8_t* location(int patternId) const { return location(patternId, _queries[patternId].occurrence); }
+		// Returns the location of the occurrence specified (starts at 1) of the pattern with the id specified, served from the occurrence index,
+		// or nullptr if there's no such occurrence or it's past the index limit.
+		const uint8_t* location(int patternId, int occurrence) const;
+		// Returns all indexed matches of the pattern with the id specified, in image order.
+		const std::vector<const uint8_t*>& occurrences(int patternId) const { return _patterns[_queries[patternId].patternIndex].occurrences; }
+		// Returns true if the pattern with the id specified matches more often than the occurrence it was added with, e.g. because a game
+		// update added another match: the location found might not be the one the pattern was written for.
+		bool isAmbiguous(int patternId) const { return occurrences(patternId).size() > static_cast<size_t>(_queries[patternId].occurrence); }
+		// Returns true if all matches of the pattern with the id specified are in the index, false if the index limit was reached.
+		bool isIndexComplete(int patternId) const;
+		int numberOfPatterns() const { return static_cast<int>(_queries.size()); }
+
+	private:
+		// A unique pattern to scan for.
+		struct PatternEntry
+		{
+			PatternView pattern;
+			int segmentOffset;		// offset of the segment in the pattern, -1 if the pattern has to be scanned individually.
+			int matchLimit;			// maximum number of matches to record in the occurrence index.
+			std::vector<const uint8_t*> occurrences;
+		};
+
+		// A pattern as added by the caller: which unique pattern to use and which occurrence of it is requested.
+		struct PatternQuery
+		{
+			int patternIndex;
+			int occurrence;
+		};
+
+		// per pattern index the matches found in a chunk, in image order, at most 'matchLimit' per pattern.
+		typedef std::vector<std::vector<const uint8_t*>> MatchesPerPattern;
+
+		void buildTables();
+		void resetResults();
+		void scanChunk(const uint8_t* rangeStart, size_t rangeLength, size_t chunkStart, size_t chunkLength, MatchesPerPattern& matches);
+		void mergeChunkResults(const MatchesPerPattern& matches);
+		int findSegmentOffset(const PatternView& pattern, int segmentLength);
+		static int longestNonWildcardRun(const PatternView& pattern);
+		static int blockHash(const uint8_t* lastTwoBytes) { return (lastTwoBytes[0] << 8) | lastTwoBytes[1]; }
+
+		std::vector<PatternEntry> _patterns;
+		std::vector<PatternQuery> _queries;
+		int _segmentLength;
+		int _maxPatternSize;
+		std::vector<uint8_t> _shiftTable;			// per 2-byte block hash: how far the window can shift.
+		std::vector<uint32_t> _bucketStarts;		// per 2-byte block hash: start index in _bucketPatternIndices of the patterns ending with that block.
+		std::vector<int> _bucketPatternIndices;
+	};
+}
@@ -291,6 +291,9 @@ Special thanks to:
 			ImGui::SameLine(); showHelpMarker("The camera control device chosen will be blocked for game input.\n");
 			ImGui::TextUnformatted("");  ImGui::SameLine((ImGui::GetWindowWidth() * 0.3f) - 11.0f);
 			settingsChanged |= ImGui::Checkbox("Allow camera movement when this menu is up", &currentSettings.allowCameraMovementWhenMenuIsUp);
+			ImGui::TextUnformatted("");  ImGui::SameLine((ImGui::GetWindowWidth() * 0.3f) - 11.0f);
+			settingsChanged |= ImGui::Checkbox("Sync camera updates to the game's frame rate", &currentSettings.syncCameraUpdatesToFrameRate);
+			ImGui::SameLine(); showHelpMarker("Updates the camera once per rendered frame, right after the game presented it,\ninstead of on a fixed timer. This removes judder between camera and frame rate.\nIf the game doesn't present frames, the timer is used.\n");
 		}
 		if (ImGui::CollapsingHeader("Camera rotation options", ImGuiTreeNodeFlags_DefaultOpen))
 		{
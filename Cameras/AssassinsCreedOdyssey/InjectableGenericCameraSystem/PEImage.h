@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "AOBScanner.h"
+#include <string>
+#include <vector>
+
+namespace IGCS
+{
+	// The kind of data a section contains, based on its characteristics.
+	enum class SectionClass : uint8_t
+	{
+		Code,				// executable
+		ReadOnlyData,		// not executable, not writable, e.g. .rdata
+		Data,				// writable, e.g. .data
+	};
+
+
+	struct PESection
+	{
+		std::string name;
+		uint32_t virtualAddress;
+		uint32_t virtualSize;
+		uint32_t pointerToRawData;
+		uint32_t sizeOfRawData;
+		uint32_t characteristics;
+		SectionClass sectionClass;
+		size_t offset;			// offset of the section's data in the image, depends on the layout.
+		size_t length;			// number of bytes of the section's data available in the image.
+	};
+
+
+	// Minimal, platform independent parser of the headers and section table of a PE image. If mappedLayout is true, the image is laid out
+	// as loaded by the OS loader (sections at their virtual address), otherwise it's laid out as the file on disk (sections at their raw
+	// data pointer).
+	class PEImage
+	{
+	public:
+		PEImage(const uint8_t* imageStart, size_t imageSize, bool mappedLayout);
+		~PEImage();
+
+		bool isValid() const { return _isValid; }
+		const uint8_t* imageStart() const { return _imageStart; }
+		size_t imageSize() const { return _imageSize; }
+		bool mappedLayout() const { return _mappedLayout; }
+		// the COFF file header, 20 bytes.
+		const uint8_t* fileHeader() const { return _imageStart + _ntHeadersOffset + 4; }
+		const uint8_t* optionalHeader() const { return _imageStart + _ntHeadersOffset + 24; }
+		const uint8_t* sectionTable() const { return _imageStart + _sectionTableOffset; }
+		size_t sectionTableSize() const { return _sections.size() * SECTION_HEADER_SIZE; }
+		uint32_t sizeOfImage() const { return _sizeOfImage; }
+		uint64_t imageBase() const { return _imageBase; }
+		const std::vector<PESection>& sections() const { return _sections; }
+		// Returns the ranges in the image of the sections of the class specified, in image order.
+		std::vector<ScanRange> rangesOfClass(SectionClass sectionClass) const;
+		// Converts an RVA to an offset in the image, taking the layout into account. Returns false if the rva isn't in the image.
+		bool rvaToOffset(uint32_t rva, size_t& offset) const;
+		// Converts an offset in the image to an RVA, taking the layout into account. Returns false if the offset isn't in a section or the headers.
+		bool offsetToRva(size_t offset, uint32_t& rva) const;
+
+		static const size_t SECTION_HEADER_SIZE = 40;
+
+	private:
+		void parse();
+
+		const uint8_t* _imageStart;
+		size_t _imageSize;
+		bool _mappedLayout;
+		bool _isValid;
+		size_t _ntHeadersOffset;
+		size_t _sectionTableOffset;
+		uint32_t _sizeOfHeaders;
+		uint32_t _sizeOfImage;
+		uint64_t _imageBase;
+		std::vector<PESection> _sections;
+	};
+
+
+	namespace PEReader
+	{
+		// Little endian reads, byte by byte, so they don't depend on the platform or alignment.
+		inline uint16_t readUInt16(const uint8_t* source)
+		{
+			return static_cast<uint16_t>(source[0] | (source[1] << 8));
+		}
+
+		inline uint32_t readUInt32(const uint8_t* source)
+		{
+			return static_cast<uint32_t>(source[0]) | (static_cast<uint32_t>(source[1]) << 8) | (static_cast<uint32_t>(source[2]) << 16) | (static_cast<uint32_t>(source[3]) << 24);
+		}
+
+		inline uint64_t readUInt64(const uint8_t* source)
+		{
+			return static_cast<uint64_t>(readUInt32(source)) | (static_cast<uint64_t>(readUInt32(source + 4)) << 32);
+		}
+	}
+}
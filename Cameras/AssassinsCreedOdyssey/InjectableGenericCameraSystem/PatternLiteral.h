@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "AOBScanner.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace IGCS
+{
+	namespace PatternParser
+	{
+		// Returns the value of the hexadecimal digit specified or -1 if it's not a hexadecimal digit.
+		constexpr int hexValue(char c)
+		{
+			if (c >= '0' && c <= '9')
+			{
+				return c - '0';
+			}
+			if (c >= 'a' && c <= 'f')
+			{
+				return c - 'a' + 10;
+			}
+			if (c >= 'A' && c <= 'F')
+			{
+				return c - 'A' + 10;
+			}
+			return -1;
+		}
+
+
+		// Parses a pattern in the form of "aa bb ?? c? ?d | ee" into bytePattern and compareMask, which both have to have room for maxPatternSize
+		// bytes. '??' (or a single '?') is a byte which is skipped in the comparison, 'c?' and '?d' are bytes of which only the high or low nibble
+		// has to match and 'aa' is a byte which has to have that value at that position. If a '|' is specified, the position of the byte
+		// following it is stored in customOffset. Returns false if the text isn't a valid pattern. Used at compile time for pattern literals
+		// and at runtime for patterns loaded from elsewhere, so both produce the same bytes.
+		constexpr bool parse(const char* text, size_t textLength, uint8_t* bytePattern, uint8_t* compareMask, int maxPatternSize, int& patternSize, int& customOffset)
+		{
+			patternSize = 0;
+			customOffset = 0;
+			size_t index = 0;
+			while (index < textLength && text[index] != '\0')
+			{
+				const char current = text[index];
+				if (current == ' ')
+				{
+					index++;
+					continue;
+				}
+				if (current == '|')
+				{
+					customOffset = patternSize;
+					index++;
+					continue;
+				}
+				if (patternSize >= maxPatternSize)
+				{
+					return false;
+				}
+				const char next = index + 1 < textLength ? text[index + 1] : '\0';
+				if (next == '\0' || next == ' ' || next == '|')
+				{
+					if (current != '?')
+					{
+						return false;
+					}
+					bytePattern[patternSize] = 0x00;
+					compareMask[patternSize++] = 0xFF;
+					index++;
+					continue;
+				}
+				const int highNibble = hexValue(current);
+				const int lowNibble = hexValue(next);
+				if ((highNibble < 0 && current != '?') || (lowNibble < 0 && next != '?'))
+				{
+					return false;
+				}
+				bytePattern[patternSize] = static_cast<uint8_t>(((highNibble < 0 ? 0 : highNibble) << 4) | (lowNibble < 0 ? 0 : lowNibble));
+				compareMask[patternSize++] = static_cast<uint8_t>((highNibble < 0 ? 0xF0 : 0x00) | (lowNibble < 0 ? 0x0F : 0x00));
+				index += 2;
+			}
+			return patternSize > 0;
+		}
+
+
+		// Not constexpr on purpose: calling it while evaluating a pattern literal at compile time makes the compilation fail.
+		inline void invalidPatternLiteral()
+		{
+		}
+	}
+
+
+	// AOB pattern parsed at compile time. Capacity is the length of the pattern text, which is always enough room for the parsed bytes.
+	template<size_t Capacity>
+	struct PatternLiteral
+	{
+		uint8_t bytePattern[Capacity] = {};
+		uint8_t compareMask[Capacity] = {};
+		int patternSize = 0;
+		int customOffset = 0;
+		int anchorIndex = 0;
+		int secondaryAnchorIndex = 0;
+
+		PatternView view() const { return PatternView{ bytePattern, compareMask, patternSize, anchorIndex, secondaryAnchorIndex }; }
+	};
+
+
+	// Parses the pattern text specified into a PatternLiteral, including its anchors. Meant to be used in a constant expression, e.g. through
+	// IGCS_AOB_PATTERN, so an invalid pattern is a compile error and there's no parsing at runtime.
+	template<size_t TextLength>
+	constexpr PatternLiteral<TextLength> makePatternLiteral(const char (&text)[TextLength])
+	{
+		PatternLiteral<TextLength> toReturn{};
+		if (!PatternParser::parse(text, TextLength, toReturn.bytePattern, toReturn.compareMask, static_cast<int>(TextLength), toReturn.patternSize, toReturn.customOffset))
+		{
+			PatternParser::invalidPatternLiteral();
+		}
+		AOBScanner::determineAnchors(toReturn.bytePattern, toReturn.compareMask, toReturn.patternSize, toReturn.anchorIndex, toReturn.secondaryAnchorIndex);
+		return toReturn;
+	}
+}
+
+// Evaluates to a reference to a PatternLiteral with static storage duration, parsed at compile time from the string literal specified.
+#define IGCS_AOB_PATTERN(patternText) ([]() -> const auto& { static constexpr auto patternLiteral = IGCS::makePatternLiteral(patternText); return patternLiteral; }())
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "PresentScheduler.h"
+#include <thread>
+
+namespace IGCS
+{
+	PresentScheduler::PresentScheduler() : _presentCounter(0), _waiting(false), _syncToPresent(false), _lastSeenPresent(0), _presentsArriving(false),
+										   _fallbackInterval(std::chrono::milliseconds(8)), _presentTimeout(std::chrono::milliseconds(100))
+	{
+	}
+
+
+	PresentScheduler::~PresentScheduler()
+	{
+	}
+
+
+	// Blocks till the next update of the camera has to run. Returns true if that's because the game presented a frame, false if it's a
+	// timer tick. Presents which came in while the previous update ran wake it up immediately, but several of them still give one tick.
+	bool PresentScheduler::waitForNextTick()
+	{
+		if (!_syncToPresent)
+		{
+			_presentsArriving = false;
+			std::this_thread::sleep_for(_fallbackInterval);
+			_lastSeenPresent = _presentCounter.load();
+			return false;
+		}
+		// while presents come in, wait long for the next one. Otherwise wait a timer tick, but switch back as soon as a present comes in.
+		_presentsArriving = waitForPresent(_presentsArriving ? _presentTimeout : _fallbackInterval);
+		return _presentsArriving;
+	}
+
+
+	// Called by the Present hook, once per frame.
+	void PresentScheduler::presentOccurred()
+	{
+		_presentCounter++;
+		// Either the main loop sees the new counter value before it waits, or we see it's waiting and it's woken up. Taking the mutex makes 
+		// sure the notify can't fall between its check of the counter and the wait.
+		if (_waiting)
+		{
+			std::lock_guard<std::mutex> lock(_waitMutex);
+			_presentSignal.notify_one();
+		}
+	}
+
+
+	bool PresentScheduler::waitForPresent(std::chrono::microseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(_waitMutex);
+		_waiting = true;
+		bool presentOccurred = _presentSignal.wait_for(lock, timeout, [this] { return _presentCounter.load() != _lastSeenPresent; });
+		_waiting = false;
+		_lastSeenPresent = _presentCounter.load();
+		return presentOccurred;
+	}
+}
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace IGCS
+{
+	// Decides when the main loop runs its next camera update. Synchronized to presents, the loop blocks till the Present hook signals a 
+	// frame, so input and camera are updated once per rendered frame, right after the game presented it. If no present comes in within the
+	// present timeout (no swapchain hook, or the game is minimized or loading) it falls back to a timer tick every fallback interval, till
+	// presents come in again. It only uses standard library primitives so it can be driven by a simulated present source. presentOccurred()
+	// is called from the render thread, the other methods from the main loop's thread.
+	class PresentScheduler
+	{
+	public:
+		PresentScheduler();
+		~PresentScheduler();
+
+		bool waitForNextTick();
+		void presentOccurred();
+		void setSyncToPresent(bool syncToPresent) { _syncToPresent = syncToPresent; }
+		void setFallbackInterval(std::chrono::microseconds interval) { _fallbackInterval = interval; }
+		void setPresentTimeout(std::chrono::microseconds timeout) { _presentTimeout = timeout; }
+		bool presentsArriving() const { return _presentsArriving; }
+
+	private:
+		bool waitForPresent(std::chrono::microseconds timeout);
+
+		std::mutex _waitMutex;
+		std::condition_variable _presentSignal;
+		std::atomic<uint64_t> _presentCounter;
+		std::atomic_bool _waiting;			// if false, a present doesn't have to take the mutex to wake the main loop
+		std::atomic_bool _syncToPresent;
+		uint64_t _lastSeenPresent;
+		bool _presentsArriving;
+		std::chrono::microseconds _fallbackInterval;
+		std::chrono::microseconds _presentTimeout;
+	};
+}
@@ -25,17 +25,17 @@
 // OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 #include "stdafx.h"
 #include "ScanPattern.h"
+#include "PatternArena.h"
 
 namespace IGCS
 {
-	ScanPattern::ScanPattern(std::string bytePatternAsString, int occurrence) : 
-		_bytePatternAsString{ bytePatternAsString }, _occurrence{ occurrence }, _bytePattern{ nullptr }, _patternMask{ nullptr }, _patternSize{-1}, 
-		_customOffset{ 0 }
+	ScanPattern::ScanPattern(const std::string& bytePatternAsString, int occurrence) : 
+		_occurrence{ occurrence }, _bytePattern{ nullptr }, _compareMask{ nullptr }, _patternSize{ 0 }, _customOffset{ 0 }, _anchorIndex{ 0 }, 
+		_secondaryAnchorIndex{ 0 }
 	{
-		createAOBPatternFromStringPattern();
+		createAOBPatternFromStringPattern(bytePatternAsString);
 	}
 
 
@@ -44,57 +44,27 @@ namespace IGCS
 	}
 
 
-	// Updates this pattern with the data used with an aob scan. This pattern contains a string in the form of "aa bb ??" where '??' is a byte
-	// which has to be skipped in the comparison, and 'aa' and 'bb' are hexadecimal bytes which have to have that value at that position.
-	// If a '|' is specified in the pattern, the position of the byte following it is the start offset returned by the aob scanner, instead of
-	// the position of the first byte of the pattern. 
-	void ScanPattern::createAOBPatternFromStringPattern()
+	// Updates this pattern with the data used with an aob scan, parsed from a pattern string at runtime. See PatternParser::parse for the format.
+	// The data is stored in the pattern arena. Patterns known at compile time should use IGCS_AOB_PATTERN instead, which does this at compile time.
+	// If the string isn't a valid pattern, the pattern size is 0 and the pattern never matches.
+	void ScanPattern::createAOBPatternFromStringPattern(const std::string& bytePatternAsString)
 	{
-		if (_bytePattern != nullptr)
+		int maxPatternSize = static_cast<int>(bytePatternAsString.size());
+		if (maxPatternSize <= 0)
 		{
-			// already initialized
 			return;
 		}
-		int index = 0;
-		char* pChar = (char*)_bytePatternAsString.c_str();
-		_patternSize = static_cast<int>(_bytePatternAsString.size());
-		_bytePattern = (LPBYTE)calloc(_patternSize, sizeof(BYTE));
-		_patternMask = (char*)calloc((__int64)_patternSize + 2, sizeof(char));
-		_customOffset = 0;
-
-		while (*pChar)
+		uint8_t* bytePattern = PatternArena::instance().allocate(static_cast<size_t>(maxPatternSize) * 2);
+		uint8_t* compareMask = bytePattern + maxPatternSize;
+		int patternSize = 0;
+		if (!PatternParser::parse(bytePatternAsString.c_str(), bytePatternAsString.size(), bytePattern, compareMask, maxPatternSize, patternSize, _customOffset))
 		{
-			if (*pChar == ' ')
-			{
-				pChar++;
-				continue;
-			}
-
-			if (*pChar == '|')
-			{
-				pChar++;
-				_customOffset = index;
-				continue;
-			}
-
-			if (*pChar == '?')
-			{
-				_patternMask[index++] += '?';
-				pChar += 2;
-				continue;
-			}
-
-			_patternMask[index] = 'x';
-			_bytePattern[index++] = (CharToByte(pChar[0]) << 4) + CharToByte(pChar[1]);
-			pChar += 2;
+			_customOffset = 0;
+			return;
 		}
+		_bytePattern = bytePattern;
+		_compareMask = compareMask;
+		_patternSize = patternSize;
+		AOBScanner::determineAnchors(_bytePattern, _compareMask, _patternSize, _anchorIndex, _secondaryAnchorIndex);
 	}
-	
-
-	BYTE ScanPattern::CharToByte(char c)
-	{
-		BYTE b;
-		sscanf_s(&c, "%hhx", &b);
-		return b;
-	}
-}
\ No newline at end of file
+}
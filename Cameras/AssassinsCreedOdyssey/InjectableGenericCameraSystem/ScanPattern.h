@@ -26,30 +26,43 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include "AOBScanner.h"
+#include "PatternLiteral.h"
+#include <string>
 
 namespace IGCS
 {
+	// An AOB pattern with its occurrence. Doesn't own the pattern data: it either points to a PatternLiteral parsed at compile time or
+	// to data in the PatternArena, so it can be copied around freely.
 	class ScanPattern
 	{
 	public:
-		ScanPattern(std::string bytePatternAsString, int occurrence);
+		ScanPattern(const std::string& bytePatternAsString, int occurrence);
+		template<size_t Capacity>
+		ScanPattern(const PatternLiteral<Capacity>& patternLiteral, int occurrence) : 
+			_occurrence{ occurrence }, _bytePattern{ patternLiteral.bytePattern }, _compareMask{ patternLiteral.compareMask }, _patternSize{ patternLiteral.patternSize },
+			_customOffset{ patternLiteral.customOffset }, _anchorIndex{ patternLiteral.anchorIndex }, _secondaryAnchorIndex{ patternLiteral.secondaryAnchorIndex }
+		{
+		}
 		~ScanPattern();
 
 		int occurrence() { return _occurrence; }
-		LPBYTE bytePattern() { return _bytePattern; }
-		char* patternMask() { return _patternMask; }
+		const uint8_t* bytePattern() { return _bytePattern; }
+		const uint8_t* compareMask() { return _compareMask; }
 		int customOffset() { return _customOffset; }
 		int patternSize() { return _patternSize; }
+		int anchorIndex() { return _anchorIndex; }
+		PatternView view() { return PatternView{ _bytePattern, _compareMask, _patternSize, _anchorIndex, _secondaryAnchorIndex }; }
 
 	private:
-		void createAOBPatternFromStringPattern();
-		BYTE CharToByte(char c);
+		void createAOBPatternFromStringPattern(const std::string& bytePatternAsString);
 
-		std::string _bytePatternAsString;
 		int _occurrence = -1;
-		LPBYTE _bytePattern = nullptr;
-		char* _patternMask = nullptr;
-		int _patternSize = -1;
+		const uint8_t* _bytePattern = nullptr;
+		const uint8_t* _compareMask = nullptr;		// bits to ignore per byte, see PatternView
+		int _patternSize = 0;
 		int _customOffset = 0;
+		int _anchorIndex = 0;
+		int _secondaryAnchorIndex = 0;
 	};
 }
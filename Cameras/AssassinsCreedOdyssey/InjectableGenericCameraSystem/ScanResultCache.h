@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <string>
+#include "PEImage.h"
+
+namespace IGCS
+{
+	// Calculates a fingerprint of a PE image: a hash of the file header (which contains the link timestamp), the key fields of the optional
+	// header and the section table. The contents of the sections aren't hashed: base relocations change the code of a loaded image. If
+	// mappedLayout is true, the image is laid out as loaded by the OS loader (sections at their virtual address), otherwise as the file on
+	// disk (sections at their raw data pointer). Returns 0 if the image isn't a valid PE image.
+	uint64_t calculateExecutableFingerprint(const uint8_t* imageStart, size_t imageSize, bool mappedLayout);
+	uint64_t calculateExecutableFingerprint(const PEImage& image);
+
+
+	// The location of a block found by a scan: which of its patterns matched, the pattern (as a hash) and the occurrence it was scanned for,
+	// and the RVA of the match.
+	struct CachedLocation
+	{
+		int patternIndex;
+		int occurrence;
+		uint32_t patternHash;
+		uint32_t rva;
+	};
+
+
+	// Cache of AOB scan results for an executable, stored on disk and keyed by the fingerprint of the executable. Per block it stores where
+	// it was found, so a next session can verify the pattern at that location instead of scanning the whole image.
+	class ScanResultCache
+	{
+	public:
+		ScanResultCache();
+		~ScanResultCache();
+
+		// Loads the cache file specified. Returns false if the file doesn't exist, isn't valid or is for a different executable.
+		bool load(const std::string& filename, uint64_t fingerprint);
+		bool save(const std::string& filename) const;
+		bool tryGet(const std::string& blockName, CachedLocation& location) const;
+		void set(const std::string& blockName, const CachedLocation& location);
+		void clear(uint64_t fingerprint);
+
+		static uint32_t calculatePatternHash(const PatternView& pattern);
+		// Returns the location in the image of a cached location if it's still the location of the occurrence specified of the pattern: the
+		// pattern and the occurrence are the ones it was scanned for, and the pattern matches there inside a section of the class specified.
+		// Only the bytes at the location are compared, the scan which found the location in the same executable counted the occurrences.
+		// Returns nullptr otherwise, and the block has to be scanned for.
+		static const uint8_t* verifyLocation(const PEImage& image, SectionClass sectionClass, const PatternView& pattern, int occurrence, const CachedLocation& location);
+
+	private:
+		uint64_t _fingerprint;
+		std::map<std::string, CachedLocation> _entries;
+	};
+}
@@ -24,6 +24,7 @@ namespace IGCS
 		int cameraControlDevice;		// 0==keyboard/mouse, 1 == gamepad, 2 == both, see Defaults.h
 		bool allowCameraMovementWhenMenuIsUp;
 		bool disableInGameDofWhenCameraIsEnabled;
+		bool syncCameraUpdatesToFrameRate;
 		// screenshot settings
 		int numberOfFramesToWaitBetweenSteps;
 		float distanceBetweenLightfieldShots;
@@ -52,6 +53,7 @@ namespace IGCS
 			invertY = iniFile.GetBool("invertY", "CameraSettings");
 			allowCameraMovementWhenMenuIsUp = iniFile.GetBool("allowCameraMovementWhenMenuIsUp", "CameraSettings");
 			disableInGameDofWhenCameraIsEnabled = iniFile.GetBool("disableInGameDofWhenCameraIsEnabled", "CameraSettings");
+			syncCameraUpdatesToFrameRate = iniFile.GetBool("syncCameraUpdatesToFrameRate", "CameraSettings");
 			fastMovementMultiplier = Utils::clamp(iniFile.GetFloat("fastMovementMultiplier", "CameraSettings"), 0.0f, FASTER_MULTIPLIER);
 			slowMovementMultiplier = Utils::clamp(iniFile.GetFloat("slowMovementMultiplier", "CameraSettings"), 0.0f, SLOWER_MULTIPLIER);
 			movementUpMultiplier = Utils::clamp(iniFile.GetFloat("movementUpMultiplier", "CameraSettings"), 0.0f, DEFAULT_UP_MOVEMENT_MULTIPLIER);
@@ -90,6 +92,7 @@ namespace IGCS
 			iniFile.SetBool("invertY", invertY, "", "CameraSettings");
 			iniFile.SetBool("allowCameraMovementWhenMenuIsUp", allowCameraMovementWhenMenuIsUp, "", "CameraSettings");
 			iniFile.SetBool("disableInGameDofWhenCameraIsEnabled", disableInGameDofWhenCameraIsEnabled, "", "CameraSettings");
+			iniFile.SetBool("syncCameraUpdatesToFrameRate", syncCameraUpdatesToFrameRate, "", "CameraSettings");
 			iniFile.SetFloat("fastMovementMultiplier", fastMovementMultiplier, "", "CameraSettings");
 			iniFile.SetFloat("slowMovementMultiplier", slowMovementMultiplier, "", "CameraSettings");
 			iniFile.SetFloat("movementUpMultiplier", movementUpMultiplier, "", "CameraSettings");
@@ -135,6 +138,7 @@ namespace IGCS
 			cameraControlDevice = DEVICE_ID_ALL;
 			allowCameraMovementWhenMenuIsUp = false;
 			disableInGameDofWhenCameraIsEnabled = false;
+			syncCameraUpdatesToFrameRate = false;
 			numberOfFramesToWaitBetweenSteps = 1;
 			// Screenshot settings
 			distanceBetweenLightfieldShots = 1.0f;
@@ -49,7 +49,7 @@ namespace IGCS
 {
 	using namespace IGCS::GameSpecific;
 
-	System::System()
+	System::System() : _frameClock(_timeSource)
 	{
 	}
 
@@ -66,6 +66,10 @@ namespace IGCS
 		_hostImageSize = hostImageSize;
 		Globals::instance().gamePad().setInvertLStickY(CONTROLLER_Y_INVERT);
 		Globals::instance().gamePad().setInvertRStickY(CONTROLLER_Y_INVERT);
+		PresentScheduler& scheduler = Globals::instance().presentScheduler();
+		scheduler.setFallbackInterval(std::chrono::milliseconds(FRAME_SLEEP));
+		scheduler.setPresentTimeout(std::chrono::milliseconds(PRESENT_WAIT_TIMEOUT_MS));
+		_frameClock.setMaxDeltaSeconds(MAX_TICK_DELTA_SECONDS);
 		initialize();		// will block till camera is found
 		mainLoop();
 	}
@@ -74,23 +78,28 @@ namespace IGCS
 	// Core loop of the system
 	void System::mainLoop()
 	{
+		PresentScheduler& scheduler = Globals::instance().presentScheduler();
+		_frameClock.reset();
 		while (Globals::instance().systemActive())
 		{
-			Sleep(FRAME_SLEEP);
-			updateFrame();
+			scheduler.setSyncToPresent(Globals::instance().settings().syncCameraUpdatesToFrameRate);
+			scheduler.waitForNextTick();
+			updateFrame(_frameClock.tick());
 		}
 	}
 
 
 	// updates the data and camera for a frame 
-	void System::updateFrame()
+	void System::updateFrame(const FrameTime& frameTime)
 	{
-		handleUserInput();
+		// ticks follow the frame rate when synced to presents, so movement is scaled by the time elapsed to keep its speed.
+		handleUserInput(frameTime.deltaSeconds / (FRAME_SLEEP / 1000.0f));
 		CameraManipulator::updateCameraDataInGameData(_camera);
 	}
 
 
-	void System::handleUserInput()
+	// timeMultiplier scales keyboard and gamepad movement, which is a speed. Mouse movement is a distance, so it's not scaled.
+	void System::handleUserInput(float timeMultiplier)
 	{
 		Globals::instance().gamePad().update();
 		if (_applyHammerPrevention)
@@ -98,6 +107,7 @@ namespace IGCS
 			_applyHammerPrevention = false;
 			// sleep main thread for 200ms so key repeat delay is simulated. 
 			Sleep(300);
+			_frameClock.discardElapsedTime();
 		}
 
 		if (Input::isActionActivated(ActionType::ToggleOverlay))
@@ -206,13 +216,13 @@ namespace IGCS
 		bool altPressed = Utils::altPressed();
 		bool rcontrolPressed = Utils::keyDown(VK_RCONTROL);
 		float multiplier = altPressed ? settings.fastMovementMultiplier : rcontrolPressed ? settings.slowMovementMultiplier : 1.0f;
-		handleKeyboardCameraMovement(multiplier);
+		handleKeyboardCameraMovement(multiplier * timeMultiplier);
 		handleMouseCameraMovement(multiplier);
-		handleGamePadMovement(multiplier);
+		handleGamePadMovement(multiplier, timeMultiplier);
 	}
 
 
-	void System::handleGamePadMovement(float multiplierBase)
+	void System::handleGamePadMovement(float multiplierBase, float timeMultiplier)
 	{
 		if(!Globals::instance().controllerControlsCamera())
 		{
@@ -226,6 +236,7 @@ namespace IGCS
 			Settings& settings = Globals::instance().settings();
 			float  multiplier = gamePad.isButtonPressed(IGCS_BUTTON_FASTER) ? settings.fastMovementMultiplier 
 																			: gamePad.isButtonPressed(IGCS_BUTTON_SLOWER) ? settings.slowMovementMultiplier : multiplierBase;
+			multiplier *= timeMultiplier;
 			vec2 rightStickPosition = gamePad.getRStickPosition();
 			_camera.pitch(rightStickPosition.y * multiplier);
 			_camera.yaw(rightStickPosition.x * multiplier);
@@ -371,7 +382,7 @@ namespace IGCS
 		OverlayConsole::instance().logLine("Waiting for camera struct interception...");
 		while(!GameSpecific::CameraManipulator::isCameraFound())
 		{
-			handleUserInput();
+			handleUserInput(1.0f);
 			Sleep(100);
 		}
 		OverlayControl::addNotification("Camera found.");
@@ -31,6 +31,7 @@
 #include "Gamepad.h"
 #include <map>
 #include "AOBBlock.h"
+#include "FrameClock.h"
 
 namespace IGCS
 {
@@ -44,13 +45,13 @@ namespace IGCS
 	private:
 		void mainLoop();
 		void initialize();
-		void updateFrame();
-		void handleUserInput();
+		void updateFrame(const FrameTime& frameTime);
+		void handleUserInput(float timeMultiplier);
 		void displayCameraState();
 		void toggleCameraMovementLockState(bool newValue);
 		void handleKeyboardCameraMovement(float multiplier);
 		void handleMouseCameraMovement(float multiplier);
-		void handleGamePadMovement(float multiplierBase);
+		void handleGamePadMovement(float multiplierBase, float timeMultiplier);
 		void waitForCameraStructAddresses();
 		void toggleInputBlockState(bool newValue);
 		void toggleTimestopState();
@@ -59,6 +60,8 @@ namespace IGCS
 		void takeSingleScreenshot();
 
 		Camera _camera;
+		SteadyTimeSource _timeSource;
+		FrameClock _frameClock;
 		LPBYTE _hostImageAddress;
 		DWORD _hostImageSize;
 		bool _timeStopped = false;
@@ -29,9 +29,11 @@
 #include "Utils.h"
 #include "GameConstants.h"
 #include "AOBBlock.h"
+#include "AOBScanner.h"
 #include "OverlayConsole.h"
 #include <comdef.h>
 #include <codecvt>
+#include <filesystem>
 
 #pragma warning(disable : 4996)
 
@@ -158,75 +160,10 @@ namespace IGCS::Utils
 	}
 
 
-	bool DataCompare(LPBYTE image, LPBYTE bytePattern, char* patternMask)
+	// Scans the image for the pattern specified using the vectorized scanner. See AOBScanner for details.
+	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, ScanPattern& pattern)
 	{
-		for (; *patternMask; ++patternMask, ++image, ++bytePattern)
-		{
-			if (*patternMask == 'x' && *image != *bytePattern)
-			{
-				return false;
-			}
-		}
-		return (*patternMask) == 0;
-	}
-
-
-	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, ScanPattern pattern)
-	{
-		BYTE firstByte = pattern.bytePattern()[0];
-		__int64 length = (__int64)imageAddress + imageSize - pattern.patternSize();
-
-		LPBYTE toReturn = nullptr;
-		LPBYTE startOfScan = imageAddress;
-		for (int occurrence = 0; occurrence < pattern.occurrence(); occurrence++)
-		{
-			// reset the pointer found, as we're not interested in this occurrence, we need a following occurrence.
-			toReturn = nullptr;
-			for (__int64 i = (__int64)startOfScan; i < length; i += 4)
-			{
-				unsigned x = *(unsigned*)(i);
-
-				if ((x & 0xFF) == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<BYTE*>(i), pattern.bytePattern(), pattern.patternMask()))
-					{
-						toReturn = reinterpret_cast<BYTE*>(i);
-						break;
-					}
-				}
-				if ((x & 0xFF00) >> 8 == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<BYTE*>(i + 1), pattern.bytePattern(), pattern.patternMask()))
-					{
-						toReturn = reinterpret_cast<BYTE*>(i + 1);
-						break;
-					}
-				}
-				if ((x & 0xFF0000) >> 16 == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<BYTE*>(i + 2), pattern.bytePattern(), pattern.patternMask()))
-					{
-						toReturn = reinterpret_cast<BYTE*>(i + 2);
-						break;
-					}
-				}
-				if ((x & 0xFF000000) >> 24 == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<BYTE*>(i + 3), pattern.bytePattern(), pattern.patternMask()))
-					{
-						toReturn = reinterpret_cast<BYTE*>(i + 3);
-						break;
-					}
-				}
-			}
-			if (nullptr == toReturn)
-			{
-				// not found, give up
-				return toReturn;
-			}
-			startOfScan = toReturn + 1;	// otherwise we'll match ourselves. 
-		}
-		return toReturn;
+		return const_cast<LPBYTE>(AOBScanner::findPattern(imageAddress, imageSize, pattern.view(), pattern.occurrence()));
 	}
 
 
@@ -288,4 +225,15 @@ namespace IGCS::Utils
 		string toReturn = vkCodeToStringLookup[vkCode];
 		return toReturn;
 	}
+
+
+	// Obtains the filename + path of this dll and returns that as a path object.
+	std::filesystem::path obtainDllPath()
+	{
+		HMODULE dllModule = nullptr;
+		GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCSTR>(&obtainDllPath), &dllModule);
+		char lpBuffer[MAX_PATH];
+		GetModuleFileNameA(dllModule, lpBuffer, MAX_PATH);
+		return filesystem::path(lpBuffer);
+	}
 }
\ No newline at end of file
@@ -28,6 +28,7 @@
 #pragma once
 #include "stdafx.h"
 #include "ScanPattern.h"
+#include <filesystem>
 
 namespace IGCS
 {
@@ -61,11 +62,12 @@ namespace IGCS::Utils
 	HWND findMainWindow(unsigned long process_id);
 	MODULEINFO getModuleInfoOfContainingProcess();
 	MODULEINFO getModuleInfoOfDll(LPCWSTR libraryName);
-	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, ScanPattern pattern);
+	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, ScanPattern& pattern);
 	BYTE CharToByte(char c);
 	LPBYTE calculateAbsoluteAddress(AOBBlock* locationData, int nextOpCodeOffset);
 	bool stringStartsWith(const char *a, const char *b);
 	bool keyDown(int virtualKeyCode);
 	bool altPressed();
 	std::string vkCodeToString(int vkCode);
+	std::filesystem::path obtainDllPath();
 }
\ No newline at end of file
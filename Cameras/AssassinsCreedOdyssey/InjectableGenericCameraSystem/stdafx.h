@@ -32,6 +32,7 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include "targetver.h"
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
@@ -47,5 +48,15 @@
 #include <utility>
 #include <vector>
 #include "DirectXMath.h"
+#else
+// Not building the camera dll: the platform independent sources (the AOB scanner and PE parser) are also compiled into the AOBResolver tool 
+// on other platforms.
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#endif
 
 // TODO: reference additional headers your program requires here
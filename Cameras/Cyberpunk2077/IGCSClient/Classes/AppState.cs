@@ -332,6 +332,13 @@ namespace IGCSClient.Classes
 		}
 
 
+		public void ClearAttachedProcess()
+		{
+			_attachedProcess = null;
+			_attachedProcessMainWindowHwnd = IntPtr.Zero;
+		}
+
+
 		public void StoreRecentlyUsedResolutions(IEnumerable<Resolution> recentlyUsedResolutions)
 		{
 			if(recentlyUsedResolutions == null)
@@ -116,6 +116,16 @@ namespace IGCSClient.Classes
 		}
 
 
+		/// <summary>
+		/// Sends a 2-byte message to signal the dll that it should remove its hooks and unload itself, so a new build can be injected.
+		/// </summary>
+		public void SendUnloadDllAction()
+		{
+			// send a message of 2 bytes, first byte is 'Action', second byte, the id, is the action type, UnloadDll. No payload required. 
+			_pipeClient.Send(new IGCSMessage(MessageType.Action, ActionType.UnloadDll, null));
+		}
+
+
 		private void HandleNamedPipeMessageReceived(ContainerEventArgs<byte[]> e)
 		{
 			if(e.Value.Length < 2)
@@ -135,5 +135,6 @@ namespace IGCSClient
 	{
 		public const byte RehookXInput = 1;
 		public const byte ResizeViewPort = 2;
+		public const byte UnloadDll = 3;
 	}
 }
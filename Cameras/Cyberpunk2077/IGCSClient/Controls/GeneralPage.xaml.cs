@@ -33,6 +33,8 @@ using System.Configuration;
 using System.Diagnostics;
 using System.IO;
 using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
 using System.Windows;
 using System.Windows.Controls;
 using System.Windows.Forms;
@@ -55,6 +57,7 @@ namespace IGCSClient.Controls
 		private string _defaultDllName;
 
 		public event EventHandler DllInjected;
+		public event EventHandler DllUnloaded;
 		public event EventHandler AttachedProcessExited;
 		#endregion
 
@@ -277,5 +280,53 @@ namespace IGCSClient.Controls
 		{
 			MessageHandlerSingleton.Instance().SendRehookXInputAction();
 		}
+
+
+		private async void _unloadDllButton_OnClick(object sender, RoutedEventArgs e)
+		{
+			var attachedProcess = AppStateSingleton.Instance().AttachedProcess;
+			if(attachedProcess == null)
+			{
+				return;
+			}
+			_unloadDllButton.IsEnabled = false;
+			string dllFilename = GetAbsolutePathForDllName();
+			MessageHandlerSingleton.Instance().SendUnloadDllAction();
+			// the dll restores the game's code and frees itself, which takes a little while. Wait till it's gone from the process.
+			bool unloaded = await Task.Run(() => WaitForDllUnload(attachedProcess, dllFilename));
+			_unloadDllButton.IsEnabled = true;
+			if(!unloaded)
+			{
+				MessageBox.Show("The camera dll didn't unload. Please check the log for details.", "Unload result", MessageBoxButton.OK, MessageBoxImage.Error);
+				return;
+			}
+			attachedProcess.Exited -= _selectedProcess_Exited;
+			AppStateSingleton.Instance().ClearAttachedProcess();
+			DisplayAttachedProcessInUI();
+			EnableDisableInjectButton();
+			this.DllUnloaded.RaiseEvent(this);
+		}
+
+
+		private static bool WaitForDllUnload(Process attachedProcess, string dllFilename)
+		{
+			for(int i = 0; i < 50; i++)
+			{
+				Thread.Sleep(200);
+				attachedProcess.Refresh();
+				try
+				{
+					if(!attachedProcess.Modules.Cast<ProcessModule>().Any(m => string.Equals(m.FileName, dllFilename, StringComparison.OrdinalIgnoreCase)))
+					{
+						return true;
+					}
+				}
+				catch
+				{
+					// the module list can change while we enumerate it, try again next time.
+				}
+			}
+			return false;
+		}
 	}
 }
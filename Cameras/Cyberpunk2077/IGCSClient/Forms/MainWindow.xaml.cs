@@ -183,6 +183,16 @@ namespace IGCSClient.Forms
 		}
 
 
+		private void _generalTabControl_OnDllUnloaded(object sender, EventArgs e)
+		{
+			// no dll to talk to anymore, so disable the tabs again till a new one has been injected.
+			_hotSamplingTab.IsEnabled = false;
+			_configurationTab.IsEnabled = false;
+			_keybindingsTab.IsEnabled = false;
+			_environmentAdjustmentsTab.IsEnabled = false;
+		}
+
+
 		private void _generalTabControl_OnAttachedProcessExited(object sender, EventArgs e)
 		{
 			// Attached process died, we should too. So sad...
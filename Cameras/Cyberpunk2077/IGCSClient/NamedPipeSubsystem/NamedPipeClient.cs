@@ -363,8 +363,10 @@ namespace IGCSClient.NamedPipeSubSystem
 							}
 							catch
 							{
-								// stream operation caused an exception. We can't deal with the exception here, nor can we bubble it upwards as nothing higher up 
-								// the call chain can handle it. -> swallow
+								// stream operation caused an exception, e.g. because the stream is broken after the dll was unloaded. A broken stream
+								// can't connect again, so start over with a new one in the next iteration.
+								_stream.Dispose();
+								_stream = null;
 							}
 						}
 					}
@@ -34,9 +34,18 @@
 namespace IGCS
 {
 	AOBBlock::AOBBlock(string blockName, string bytePatternAsString, int occurrence)
-									: _blockName{ blockName }, _bytePatternAsString{ bytePatternAsString }, _customOffset{ 0 }, _occurrence{ occurrence },
-									  _bytePattern{ nullptr }, _patternMask{ nullptr }, _locationInImage{ nullptr }
+									: _blockName{ blockName }, _scanPattern{ bytePatternAsString, occurrence }, _patternIdInScanner{ -1 }, 
+									  _targetSectionClass{ SectionClass::Code }, _locationInImage{ nullptr }
 	{
+		buildPatternMask();
+	}
+
+
+	AOBBlock::AOBBlock(string blockName, const ScanPattern& pattern)
+									: _blockName{ blockName }, _scanPattern{ pattern }, _patternIdInScanner{ -1 }, 
+									  _targetSectionClass{ SectionClass::Code }, _locationInImage{ nullptr }
+	{
+		buildPatternMask();
 	}
 
 
@@ -47,62 +56,83 @@ namespace IGCS
 
 	bool AOBBlock::scan(LPBYTE imageAddress, DWORD imageSize)
 	{
-		createAOBPatternFromStringPattern(_bytePatternAsString);
-		LPBYTE aobPatternLocation = Utils::findAOBPattern(imageAddress, imageSize, this);
-		if (nullptr == aobPatternLocation)
+		return storeScanResult(Utils::findAOBPattern(imageAddress, imageSize, _scanPattern));
+	}
+
+
+	// Adds the pattern of this block to the scanner specified, so it can be scanned for in one pass together with the patterns of other blocks.
+	void AOBBlock::registerPatterns(MultiPatternScanner& scanner)
+	{
+		_patternIdInScanner = scanner.addPattern(_scanPattern.view(), _scanPattern.occurrence());
+	}
+
+
+	// Picks the result of the pattern of this block from the scanner the pattern was registered with. Same result as scan()
+	bool AOBBlock::processScanResults(const MultiPatternScanner& scanner)
+	{
+		LPBYTE aobPatternLocation = const_cast<LPBYTE>(scanner.location(_patternIdInScanner));
+		if (nullptr != aobPatternLocation && scanner.isAmbiguous(_patternIdInScanner))
+		{
+			MessageHandler::logLine("Pattern for block '%s' is ambiguous: %d%s matches, occurrence %d used. The game might have been updated.", 
+									_blockName.c_str(), static_cast<int>(scanner.occurrences(_patternIdInScanner).size()), 
+									scanner.isIndexComplete(_patternIdInScanner) ? "" : "+", _scanPattern.occurrence());
+		}
+		return storeScanResult(aobPatternLocation);
+	}
+
+
+	// Verifies whether the location found in a previous session is still the location of this block: the pattern is the same pattern with 
+	// the same occurrence and matches at the rva specified, inside the sections the block targets. If so, the block is marked as found at 
+	// that location, without scanning.
+	bool AOBBlock::verifyLocation(const PEImage& image, const CachedLocation& location)
+	{
+		if (location.patternIndex != 0)
 		{
-			MessageHandler::logError("Can't find pattern for block '%s'! Hook not set.", _blockName.c_str());
 			return false;
 		}
-		else
+		LPBYTE verifiedLocation = const_cast<LPBYTE>(ScanResultCache::verifyLocation(image, _targetSectionClass, _scanPattern.view(), _scanPattern.occurrence(), location));
+		if (nullptr == verifiedLocation)
 		{
-			MessageHandler::logDebug("Pattern for block '%s' found at address: %p", _blockName.c_str(), (void*)aobPatternLocation);
+			MessageHandler::logDebug("Cached location of block '%s' is stale, scanning for it.", _blockName.c_str());
+			return false;
 		}
-		_locationInImage = aobPatternLocation;
+		MessageHandler::logDebug("Pattern for block '%s' verified at cached address: %p", _blockName.c_str(), (void*)verifiedLocation);
+		_locationInImage = verifiedLocation;
 		return true;
 	}
-	
 
-	// Creates an aob_pattern struct which is usable with an aob scan. The pattern given is in the form of "aa bb ??" where '??' is a byte
-	// which has to be skipped in the comparison, and 'aa' and 'bb' are hexadecimal bytes which have to have that value at that position.
-	// If a '|' is specified in the pattern, the position of the byte following it is the start offset returned by the aob scanner, instead of
-	// the position of the first byte of the pattern. 
-	void AOBBlock::createAOBPatternFromStringPattern(string pattern)
+
+	CachedLocation AOBBlock::cachedLocation(LPBYTE imageAddress)
 	{
-		int index = 0;
-		char* pChar = &pattern[0];
+		// a block has one pattern, so the pattern index is always 0.
+		return CachedLocation{ 0, _scanPattern.occurrence(), ScanResultCache::calculatePatternHash(_scanPattern.view()),
+							   static_cast<uint32_t>(_locationInImage - imageAddress) };
+	}
 
-		_patternSize = static_cast<int>(pattern.size());
-		_bytePattern = (LPBYTE)calloc(0x1, _patternSize);
-		_patternMask = (char*)calloc(0x1, _patternSize);
-		_customOffset = 0;
 
-		while (*pChar)
+	// Builds the mask the hook transaction verifies the bytes at the hook location with, before it patches them.
+	void AOBBlock::buildPatternMask()
+	{
+		const uint8_t* compareMask = _scanPattern.compareMask();
+		for (int i = 0; i < _scanPattern.patternSize(); i++)
 		{
-			if (*pChar == ' ')
-			{
-				pChar++;
-				continue;
-			}
-
-			if (*pChar == '|')
-			{
-				pChar++;
-				_customOffset = index;
-				continue;
-			}
-
-			if (*pChar == '?')
-			{
-				_patternMask[index++] += '?';
-				pChar += 2;
-				continue;
-			}
-
-			_patternMask[index] = 'x';
-			_bytePattern[index++] = (Utils::CharToByte(pChar[0]) << 4) + Utils::CharToByte(pChar[1]);
-			pChar += 2;
+			_patternMask += compareMask[i] == 0 ? 'x' : '?';
 		}
 	}
 
+
+	bool AOBBlock::storeScanResult(LPBYTE aobPatternLocation)
+	{
+		if (nullptr == aobPatternLocation)
+		{
+			MessageHandler::logError("Can't find pattern for block '%s'! Hook not set.", _blockName.c_str());
+			return false;
+		}
+		else
+		{
+			MessageHandler::logDebug("Pattern for block '%s' found at address: %p", _blockName.c_str(), (void*)aobPatternLocation);
+		}
+		_locationInImage = aobPatternLocation;
+		return true;
+	}
 }
@@ -28,6 +28,10 @@
 #pragma once
 #include "AOBBlock.h"
 #include "Utils.h"
+#include "ScanPattern.h"
+#include "MultiPatternScanner.h"
+#include "PEImage.h"
+#include "ScanResultCache.h"
 
 using namespace std;
 
@@ -36,29 +40,43 @@ namespace IGCS
 	class AOBBlock
 	{
 	public:
+		// For patterns only known at runtime. Patterns in the source are given as a ScanPattern of an IGCS_AOB_PATTERN, which is parsed
+		// at compile time.
 		AOBBlock(string blockName, string bytePatternAsString, int occurrence);
+		AOBBlock(string blockName, const ScanPattern& pattern);
 		~AOBBlock();
 
 		bool scan(LPBYTE imageAddress, DWORD imageSize);
+		void registerPatterns(MultiPatternScanner& scanner);
+		bool processScanResults(const MultiPatternScanner& scanner);
+		bool verifyLocation(const PEImage& image, const CachedLocation& location);
+		// The location the block was found at, to be stored in the scan result cache. Only valid if the block was found.
+		CachedLocation cachedLocation(LPBYTE imageAddress);
 		LPBYTE locationInImage() { return _locationInImage; }
-		LPBYTE bytePattern() { return _bytePattern; }
-		int occurrence() { return _occurrence; }
-		int patternSize() { return _patternSize; }
-		char* patternMask() { return _patternMask; }
-		int customOffset() { return _customOffset; }
+		string blockName() { return _blockName; }
+		const uint8_t* bytePattern() { return _scanPattern.bytePattern(); }
+		int occurrence() { return _scanPattern.occurrence(); }
+		int patternSize() { return _scanPattern.patternSize(); }
+		// 'x' for a byte which has to match, '?' for a (partial) wildcard byte.
+		const char* patternMask() { return _patternMask.c_str(); }
+		int numberOfPatternBytes() { return static_cast<int>(_patternMask.size()); }
+		int customOffset() { return _scanPattern.customOffset(); }
 		LPBYTE absoluteAddress() { return (LPBYTE)(_locationInImage + (DWORD)customOffset()); }
+		bool found() { return nullptr != _locationInImage; }
+		// The class of the sections to scan for this block. By default code, as that's what interceptors hook into. 
+		SectionClass targetSectionClass() { return _targetSectionClass; }
+		void targetSectionClass(SectionClass value) { _targetSectionClass = value; }
 
 	private:
-		void createAOBPatternFromStringPattern(string pattern);
+		void buildPatternMask();
+		bool storeScanResult(LPBYTE aobPatternLocation);
 
 		string _blockName;
-		string _bytePatternAsString;
-		LPBYTE _bytePattern;
-		char* _patternMask;
-		int _patternSize;
-		int _customOffset;
-		int _occurrence;		// starts at 1: if there are more occurrences, and e.g. the 3rd has to be picked, set this to 3.
+		ScanPattern _scanPattern;
+		string _patternMask;
+		int _patternIdInScanner;
+		SectionClass _targetSectionClass;
 		LPBYTE _locationInImage;	// the location to use after the scan has been completed.
 	};
 
-}
\ No newline at end of file
+}
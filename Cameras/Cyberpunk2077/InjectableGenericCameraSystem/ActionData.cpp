@@ -45,12 +45,17 @@ namespace IGCS
 	// keys as required, will ignore altCtrlOptional and always test for these keys. 
 	bool ActionData::isActive(bool altCtrlOptional)
 	{
-		bool toReturn = (_available && Utils::keyDown(_keyCode)) && (_shiftRequired== Utils::shiftPressed());
-		if((_altRequired || _ctrlRequired) || !altCtrlOptional)
+		return (_available && Utils::keyDown(_keyCode)) && (_shiftRequired== Utils::shiftPressed()) && altCtrlMatch(altCtrlOptional);
+	}
+
+	// Returns true if the state of alt and ctrl is what this action requires. See isActive for altCtrlOptional.
+	bool ActionData::altCtrlMatch(bool altCtrlOptional)
+	{
+		if (!(_altRequired || _ctrlRequired) && altCtrlOptional)
 		{
-			toReturn = toReturn && (Utils::altPressed() == _altRequired) && (Utils::ctrlPressed() == _ctrlRequired);
+			return true;
 		}
-		return toReturn;
+		return (Utils::altPressed() == _altRequired) && (Utils::ctrlPressed() == _ctrlRequired);
 	}
 
 	void ActionData::setKeyCode(int newKeyCode)
@@ -71,6 +71,7 @@ namespace IGCS
 		~ActionData();
 
 		bool isActive(bool ignoreAltCtrl);
+		bool altCtrlMatch(bool altCtrlOptional);
 		void clear();
 		void update(uint8_t newKeyCode, bool altRequired, bool ctrlRequired, bool shiftRequired);
 		void setKeyCode(int newKeyCode);
@@ -79,6 +80,10 @@ namespace IGCS
 		// If false, the action is ignored to be edited / in help. Code isn't anticipating on it either, as it's not supported in this particular camera. 
 		bool getAvailable() { return _available; }
 		bool isValid() { return _keyCode > 0; }
+		int getKeyCode() { return _keyCode; }
+		bool getAltRequired() { return _altRequired; }
+		bool getCtrlRequired() { return _ctrlRequired; }
+		bool getShiftRequired() { return _shiftRequired; }
 		void setAltRequired() { _altRequired = true; }
 		void setCtrlRequired() { _ctrlRequired = true; }
 		void setShiftRequired() { _shiftRequired = true; }
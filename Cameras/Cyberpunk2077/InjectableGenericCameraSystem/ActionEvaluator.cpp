@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ActionEvaluator.h"
+#include <cstring>
+
+namespace IGCS
+{
+	static_assert(static_cast<int>(ActionType::Amount) <= 32, "The action masks have a bit per action");
+
+	// The virtual key codes of the modifier keys. The VK_ defines are Windows only.
+	static const int KEY_LSHIFT = 0xA0;
+	static const int KEY_RSHIFT = 0xA1;
+	static const int KEY_LCONTROL = 0xA2;
+	static const int KEY_RCONTROL = 0xA3;
+	static const int KEY_LMENU = 0xA4;
+	static const int KEY_RMENU = 0xA5;
+
+	void KeyboardSnapshot::clear()
+	{
+		for (uint64_t& word : keysDown)
+		{
+			word = 0;
+		}
+	}
+
+
+	// keyStates is in the format GetKeyboardState fills: the high bit of a byte is set if that key is down.
+	void KeyboardSnapshot::setFromKeyStates(const uint8_t keyStates[256])
+	{
+		for (int word = 0; word < 4; word++)
+		{
+			uint64_t bits = 0;
+			for (int i = 0; i < 8; i++)
+			{
+				// the high bits of 8 states at once: the multiplication moves the bit of byte n to bit 56+n.
+				uint64_t states;
+				memcpy(&states, keyStates + (word * 64) + (i * 8), sizeof(states));
+				bits |= (((states & 0x8080808080808080ull) >> 7) * 0x0102040810204080ull >> 56) << (i * 8);
+			}
+			keysDown[word] = bits;
+		}
+	}
+
+
+	bool KeyboardSnapshot::isKeyDown(int virtualKeyCode) const
+	{
+		if (virtualKeyCode < 0 || virtualKeyCode > 255)
+		{
+			return false;
+		}
+		return (keysDown[virtualKeyCode >> 6] >> (virtualKeyCode & 63)) & 1;
+	}
+
+
+	void KeyboardSnapshot::setKeyDown(int virtualKeyCode)
+	{
+		if (virtualKeyCode < 0 || virtualKeyCode > 255)
+		{
+			return;
+		}
+		keysDown[virtualKeyCode >> 6] |= static_cast<uint64_t>(1) << (virtualKeyCode & 63);
+	}
+
+
+	ActionEvaluator::ActionEvaluator() : _activeMask{ 0, 0 }, _altCtrlMatchMask{ 0, 0 }, _modifiersDown(Modifier::None)
+	{
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			compile(static_cast<ActionType>(i), nullptr);
+		}
+	}
+
+
+	ActionEvaluator::~ActionEvaluator()
+	{
+	}
+
+
+	// Compiles the key binding of the action specified. Has to be called again when the binding changes. data can be nullptr, then the 
+	// action is never active.
+	void ActionEvaluator::compile(ActionType type, ActionData* data)
+	{
+		if (!isValidType(type))
+		{
+			return;
+		}
+		CompiledBinding& binding = _bindings[static_cast<int>(type)];
+		int keyCode = nullptr == data ? 0 : data->getKeyCode();
+		bool canBeActive = nullptr != data && data->getAvailable() && keyCode > 0 && keyCode < 256;
+		binding.keyBit = canBeActive ? static_cast<uint64_t>(1) << (keyCode & 63) : 0;
+		binding.keyWord = canBeActive ? static_cast<uint8_t>(keyCode >> 6) : 0;
+		if (nullptr == data)
+		{
+			binding.requiredModifiers = Modifier::None;
+			binding.modifiersToTest[0] = binding.modifiersToTest[1] = Modifier::None;
+			return;
+		}
+		binding.requiredModifiers = static_cast<uint8_t>((data->getAltRequired() ? Modifier::Alt : Modifier::None) | (data->getCtrlRequired() ? Modifier::Ctrl : Modifier::None)
+														| (data->getShiftRequired() ? Modifier::Shift : Modifier::None));
+		binding.modifiersToTest[0] = static_cast<uint8_t>(Modifier::Alt | Modifier::Ctrl | Modifier::Shift);
+		// see ActionData::isActive: alt/ctrl are only optional if neither of them is required, shift always has to match.
+		binding.modifiersToTest[1] = (binding.requiredModifiers & (Modifier::Alt | Modifier::Ctrl)) ? binding.modifiersToTest[0] : static_cast<uint8_t>(Modifier::Shift);
+	}
+
+
+	void ActionEvaluator::evaluate(const KeyboardSnapshot& snapshot)
+	{
+		uint8_t modifiersDown = static_cast<uint8_t>((snapshot.isKeyDown(KEY_LMENU) || snapshot.isKeyDown(KEY_RMENU) ? Modifier::Alt : Modifier::None)
+												   | (snapshot.isKeyDown(KEY_LCONTROL) || snapshot.isKeyDown(KEY_RCONTROL) ? Modifier::Ctrl : Modifier::None)
+												   | (snapshot.isKeyDown(KEY_LSHIFT) || snapshot.isKeyDown(KEY_RSHIFT) ? Modifier::Shift : Modifier::None));
+		uint32_t activeMask[2] = { 0, 0 };
+		uint32_t altCtrlMatchMask[2] = { 0, 0 };
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			const CompiledBinding& binding = _bindings[i];
+			uint32_t keyDown = (snapshot.keysDown[binding.keyWord] & binding.keyBit) != 0;
+			uint8_t modifiersDifferent = static_cast<uint8_t>(modifiersDown ^ binding.requiredModifiers);
+			for (int altCtrlOptional = 0; altCtrlOptional < 2; altCtrlOptional++)
+			{
+				uint8_t modifiersToTest = binding.modifiersToTest[altCtrlOptional];
+				uint32_t modifiersMatch = (modifiersDifferent & modifiersToTest) == 0;
+				uint32_t altCtrlMatch = (modifiersDifferent & modifiersToTest & (Modifier::Alt | Modifier::Ctrl)) == 0;
+				activeMask[altCtrlOptional] |= (keyDown & modifiersMatch) << i;
+				altCtrlMatchMask[altCtrlOptional] |= altCtrlMatch << i;
+			}
+		}
+		_modifiersDown = modifiersDown;
+		_activeMask[0] = activeMask[0];
+		_activeMask[1] = activeMask[1];
+		_altCtrlMatchMask[0] = altCtrlMatchMask[0];
+		_altCtrlMatchMask[1] = altCtrlMatchMask[1];
+	}
+
+
+	// Returns what ActionData::isActive returns for the action's binding, at the moment of the last evaluated snapshot.
+	bool ActionEvaluator::isActive(ActionType type, bool altCtrlOptional) const
+	{
+		return isValidType(type) && ((_activeMask[altCtrlOptional ? 1 : 0] >> static_cast<int>(type)) & 1);
+	}
+
+
+	// Returns what ActionData::altCtrlMatch returns for the action's binding, at the moment of the last evaluated snapshot.
+	bool ActionEvaluator::altCtrlMatch(ActionType type, bool altCtrlOptional) const
+	{
+		return isValidType(type) && ((_altCtrlMatchMask[altCtrlOptional ? 1 : 0] >> static_cast<int>(type)) & 1);
+	}
+}
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "ActionData.h"
+#include <cstdint>
+
+namespace IGCS
+{
+	// The state of all keys at one moment, a bit per virtual key code.
+	struct KeyboardSnapshot
+	{
+		uint64_t keysDown[4];
+
+		void clear();
+		void setFromKeyStates(const uint8_t keyStates[256]);
+		bool isKeyDown(int virtualKeyCode) const;
+		void setKeyDown(int virtualKeyCode);
+	};
+
+
+	// Evaluates all actions against a KeyboardSnapshot in one pass. The key bindings are compiled into a bit test on the snapshot plus
+	// masks for the modifier keys, so evaluating an action doesn't need to look up its binding or ask Windows for key states. 
+	class ActionEvaluator
+	{
+	public:
+		ActionEvaluator();
+		~ActionEvaluator();
+
+		void compile(ActionType type, ActionData* data);
+		void evaluate(const KeyboardSnapshot& snapshot);
+		bool isActive(ActionType type, bool altCtrlOptional) const;
+		bool altCtrlMatch(ActionType type, bool altCtrlOptional) const;
+		bool altPressed() const { return (_modifiersDown & Modifier::Alt) != 0; }
+		bool ctrlPressed() const { return (_modifiersDown & Modifier::Ctrl) != 0; }
+		bool shiftPressed() const { return (_modifiersDown & Modifier::Shift) != 0; }
+
+	private:
+		enum Modifier : uint8_t
+		{
+			None = 0,
+			Alt = 1,
+			Ctrl = 2,
+			Shift = 4,
+		};
+
+		struct CompiledBinding
+		{
+			uint64_t keyBit;					// 0 if the action can't be activated
+			uint8_t keyWord;					// index in KeyboardSnapshot::keysDown
+			uint8_t requiredModifiers;
+			uint8_t modifiersToTest[2];			// indexed by altCtrlOptional
+		};
+
+		static bool isValidType(ActionType type) { return type < ActionType::Amount; }
+
+		CompiledBinding _bindings[static_cast<int>(ActionType::Amount)];
+		uint32_t _activeMask[2];				// a bit per action, indexed by altCtrlOptional
+		uint32_t _altCtrlMatchMask[2];			// a bit per action, indexed by altCtrlOptional
+		uint8_t _modifiersDown;
+	};
+}
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ActionStateMachine.h"
+
+namespace IGCS
+{
+	ActionStateMachine::ActionStateMachine(int repeatDelayInMilliseconds, float repeatRate) : _repeatDelay(0), _repeatInterval(0)
+	{
+		setRepeatDelay(repeatDelayInMilliseconds);
+		setRepeatRate(repeatRate);
+		reset();
+	}
+
+
+	ActionStateMachine::~ActionStateMachine()
+	{
+	}
+
+
+	void ActionStateMachine::update(ActionType type, bool keysDown, int64_t nowInMicroseconds)
+	{
+		ActionState* state = getState(type);
+		if (nullptr == state)
+		{
+			return;
+		}
+		state->edges = ActionEdge::None;
+		if (keysDown != state->isDown)
+		{
+			state->isDown = keysDown;
+			state->edges = keysDown ? ActionEdge::Pressed : ActionEdge::Released;
+			state->nextRepeatTime = nowInMicroseconds + _repeatDelay;
+			return;
+		}
+		if (!keysDown || _repeatInterval <= 0 || nowInMicroseconds < state->nextRepeatTime)
+		{
+			return;
+		}
+		state->edges = ActionEdge::Repeated;
+		state->nextRepeatTime += _repeatInterval;
+		if (state->nextRepeatTime <= nowInMicroseconds)
+		{
+			// the ticks are further apart than the repeat interval. One repeat per tick is enough, a burst of them isn't what the user wants.
+			state->nextRepeatTime = nowInMicroseconds + _repeatInterval;
+		}
+	}
+
+
+	// Forgets all key states, e.g. when the game loses focus and we don't see the keys being released.
+	void ActionStateMachine::reset()
+	{
+		for (ActionState& state : _states)
+		{
+			state.isDown = false;
+			state.edges = ActionEdge::None;
+			state.nextRepeatTime = 0;
+		}
+	}
+
+
+	bool ActionStateMachine::isDown(ActionType type)
+	{
+		ActionState* state = getState(type);
+		return nullptr != state && state->isDown;
+	}
+
+
+	bool ActionStateMachine::wasPressed(ActionType type)
+	{
+		ActionState* state = getState(type);
+		return nullptr != state && (state->edges & ActionEdge::Pressed);
+	}
+
+
+	bool ActionStateMachine::wasReleased(ActionType type)
+	{
+		ActionState* state = getState(type);
+		return nullptr != state && (state->edges & ActionEdge::Released);
+	}
+
+
+	bool ActionStateMachine::wasRepeated(ActionType type)
+	{
+		ActionState* state = getState(type);
+		return nullptr != state && (state->edges & ActionEdge::Repeated);
+	}
+
+
+	void ActionStateMachine::setRepeatDelay(int milliseconds)
+	{
+		_repeatDelay = static_cast<int64_t>(milliseconds < 0 ? 0 : milliseconds) * 1000;
+	}
+
+
+	void ActionStateMachine::setRepeatRate(float repeatsPerSecond)
+	{
+		_repeatInterval = repeatsPerSecond > 0.0f ? static_cast<int64_t>(1000000.0f / repeatsPerSecond + 0.5f) : 0;
+	}
+
+
+	// Obtains what's kept of an action between updates. The edges aren't, they're found again by the next update.
+	void ActionStateMachine::saveActionState(ActionType type, bool& isDown, int64_t& nextRepeatTime)
+	{
+		ActionState* state = getState(type);
+		isDown = nullptr != state && state->isDown;
+		nextRepeatTime = nullptr == state ? 0 : state->nextRepeatTime;
+	}
+
+
+	void ActionStateMachine::restoreActionState(ActionType type, bool isDown, int64_t nextRepeatTime)
+	{
+		ActionState* state = getState(type);
+		if (nullptr == state)
+		{
+			return;
+		}
+		state->isDown = isDown;
+		state->edges = ActionEdge::None;
+		state->nextRepeatTime = nextRepeatTime;
+	}
+
+
+	ActionStateMachine::ActionState* ActionStateMachine::getState(ActionType type)
+	{
+		int index = static_cast<int>(type);
+		if (index < 0 || index >= static_cast<int>(ActionType::Amount))
+		{
+			return nullptr;
+		}
+		return &_states[index];
+	}
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "ActionData.h"
+#include <cstdint>
+
+namespace IGCS
+{
+	// Tracks for every action whether its keys are down and turns that into edges: pressed, released and, while the keys are held, repeated
+	// after the repeat delay at the repeat rate, like Windows' key repeat. update() is called once per tick for every action with the state 
+	// of its keys, the edges found are valid till the next update. Nothing in here waits, so it can be evaluated on the camera thread.
+	class ActionStateMachine
+	{
+	public:
+		ActionStateMachine(int repeatDelayInMilliseconds, float repeatRate);
+		~ActionStateMachine();
+
+		void update(ActionType type, bool keysDown, int64_t nowInMicroseconds);
+		void reset();
+		bool isDown(ActionType type);
+		bool wasPressed(ActionType type);
+		bool wasReleased(ActionType type);
+		bool wasRepeated(ActionType type);
+		void setRepeatDelay(int milliseconds);
+		void setRepeatRate(float repeatsPerSecond);
+		void saveActionState(ActionType type, bool& isDown, int64_t& nextRepeatTime);
+		void restoreActionState(ActionType type, bool isDown, int64_t nextRepeatTime);
+
+	private:
+		enum ActionEdge : uint8_t
+		{
+			None = 0,
+			Pressed = 1,
+			Released = 2,
+			Repeated = 4,
+		};
+
+		struct ActionState
+		{
+			bool isDown;
+			uint8_t edges;				// the ActionEdge values found by the last update
+			int64_t nextRepeatTime;		// in microseconds
+		};
+
+		ActionState* getState(ActionType type);
+
+		ActionState _states[static_cast<int>(ActionType::Amount)];
+		int64_t _repeatDelay;			// in microseconds
+		int64_t _repeatInterval;		// in microseconds. 0 means no repeats
+	};
+}
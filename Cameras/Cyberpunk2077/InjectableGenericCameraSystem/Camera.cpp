@@ -32,12 +32,14 @@
 #include "Globals.h"
 #include "MessageHandler.h"
 
-using namespace DirectX;
-
 namespace IGCS
 {
-	Camera::Camera() : _yaw(0), _pitch(0), _roll(0), _movementOccurred(false), _lookDirectionInverter(1.0f), _direction(XMFLOAT3(0.0f, 0.0f, 0.0f))
+	using namespace GameSpecific;
+
+	Camera::Camera() : _direction{ 0.0f, 0.0f, 0.0f }, _movementOccurred(false), _previousStepOffset{ 0.0f, 0.0f, 0.0f }, 
+					   _lastStepOffset{ 0.0f, 0.0f, 0.0f }, _lookDirectionInverter(1.0f)
 	{
+		snapStepOrientations();
 	}
 
 
@@ -46,77 +48,83 @@ namespace IGCS
 	}
 
 
-	XMVECTOR Camera::calculateLookQuaternion()
+	// The orientation is kept as a quaternion and renormalized after every rotation, so it can be handed to the game as-is. An
+	// interpolationFactor of 1.0 returns the orientation of the last step.
+	Math::Quat Camera::calculateLookQuaternion(float interpolationFactor)
 	{
-		// for the camera 3x3 matrix, it uses X right, Z up and Y into the screen.
-		XMVECTOR xQ = XMQuaternionRotationNormal(XMVectorSet(1.0f, 0.0f, 0.0f, 1.0f), _pitch);
-		XMVECTOR yQ = XMQuaternionRotationNormal(XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f), _roll);			// y into the screen
-		XMVECTOR zQ = XMQuaternionRotationNormal(XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f), _yaw);
+		if (interpolationFactor >= 1.0f)
+		{
+			return _lastStepOrientation;
+		}
+		return Math::nlerp(_previousStepOrientation, _lastStepOrientation, interpolationFactor);
+	}
 
-		XMVECTOR tmpQ = XMQuaternionMultiply(xQ, zQ);
-		XMVECTOR qToReturn = XMQuaternionMultiply(yQ, tmpQ);
-		XMQuaternionNormalize(qToReturn);
-		return qToReturn;
+
+	// Returns the coordinates to write to the game, given the coordinates written last time.
+	Math::Vec3d Camera::calculateNewCoords(const Math::Vec3d& currentCoords, float interpolationFactor)
+	{
+		Math::Vec3 offset = Math::lerp(_previousStepOffset, _lastStepOffset, interpolationFactor);
+		// the offsets are relative to what's written to the game, so move them along with it
+		_previousStepOffset = Math::subtract(_previousStepOffset, offset);
+		_lastStepOffset = Math::subtract(_lastStepOffset, offset);
+		return Math::add(currentCoords, offset);
 	}
 
 
-	void Camera::resetMovement()
+	// Ends a simulation step: the movement collected since the previous step is moved along the orientation at the end of this step.
+	void Camera::endStep()
 	{
+		_previousStepOrientation = _lastStepOrientation;
+		_lastStepOrientation = _orientation.orientation();
+		_previousStepOffset = _lastStepOffset;
+		if (_movementOccurred)
+		{
+			_lastStepOffset = Math::add(_lastStepOffset, Math::rotate(_direction, _lastStepOrientation));
+		}
 		_movementOccurred = false;
-		_direction.x = 0.0f;
-		_direction.y = 0.0f;
-		_direction.z = 0.0f;
+		_direction = { 0.0f, 0.0f, 0.0f };
 	}
 
 
-	void Camera::resetAngles()
+	// Forgets all movement which hasn't been written to the game yet.
+	void Camera::resetMovement()
 	{
-		setPitch(INITIAL_PITCH_RADIANS);
-		setRoll(INITIAL_ROLL_RADIANS);
-		setYaw(INITIAL_YAW_RADIANS);
+		_movementOccurred = false;
+		_direction = { 0.0f, 0.0f, 0.0f };
+		_previousStepOffset = { 0.0f, 0.0f, 0.0f };
+		_lastStepOffset = { 0.0f, 0.0f, 0.0f };
 	}
 
 
-	XMFLOAT3 Camera::calculateNewCoords(const XMFLOAT3 currentCoords, const XMVECTOR lookQ)
+	void Camera::resetAngles()
 	{
-		XMFLOAT3 toReturn;
-		toReturn.x = currentCoords.x;
-		toReturn.y = currentCoords.y;
-		toReturn.z = currentCoords.z;
-		if (_movementOccurred)
-		{
-			XMVECTOR directionAsQ = XMVectorSet(_direction.x, _direction.y, _direction.z, 0.0f);
-			XMVECTOR newDirection = XMVector3Rotate(directionAsQ, lookQ);
-			toReturn.x += XMVectorGetX(newDirection);
-			toReturn.y += XMVectorGetY(newDirection);
-			toReturn.z += XMVectorGetZ(newDirection);
-		}
-		return toReturn;
+		_orientation.setFromEuler(INITIAL_PITCH_RADIANS, INITIAL_YAW_RADIANS, INITIAL_ROLL_RADIANS);
+		snapStepOrientations();
 	}
 
 
 	void Camera::moveForward(float amount)
 	{
-		_direction.y += (Globals::instance().settings().movementSpeed * amount);		// z up, y into of the screen.
+		_direction[CameraAxes::forward] += (Globals::instance().settings().movementSpeed * amount);
 		_movementOccurred = true;
 	}
 
 	void Camera::moveRight(float amount)
 	{
-		_direction.x += (Globals::instance().settings().movementSpeed * amount);		// x is right
+		_direction[CameraAxes::right] += (Globals::instance().settings().movementSpeed * amount);
 		_movementOccurred = true;
 	}
 
 	void Camera::moveUp(float amount)
 	{
-		_direction.z += (Globals::instance().settings().movementSpeed * amount * Globals::instance().settings().movementUpMultiplier);
+		_direction[CameraAxes::up] += (Globals::instance().settings().movementSpeed * amount * Globals::instance().settings().movementUpMultiplier);
 		_movementOccurred = true;
 	}
 
 	void Camera::yaw(float amount)
 	{
-		_yaw -= (Globals::instance().settings().rotationSpeed * amount);				// Z is up, so we have to rotate to the left.
-		_yaw = clampAngle(_yaw);
+		// rotating around the up axis turns to the left, so negate the amount to turn right
+		_orientation.integrate(0.0f, -(Globals::instance().settings().rotationSpeed * amount), 0.0f);
 	}
 
 	void Camera::pitch(float amount)
@@ -126,42 +134,90 @@ namespace IGCS
 		{
 			lookDirectionInverter = -lookDirectionInverter;
 		}
-		_pitch += (Globals::instance().settings().rotationSpeed * amount * lookDirectionInverter);
-		_pitch = clampAngle(_pitch);
+		_orientation.integrate(Globals::instance().settings().rotationSpeed * amount * lookDirectionInverter, 0.0f, 0.0f);
 	}
 
 	void Camera::roll(float amount)
 	{
-		_roll += (Globals::instance().settings().rotationSpeed * amount);
-		_roll = clampAngle(_roll);
+		_orientation.integrate(0.0f, 0.0f, Globals::instance().settings().rotationSpeed * amount);
 	}
 
 	void Camera::setPitch(float angle)
 	{
-		_pitch = clampAngle(angle);
+		float pitch, yaw, roll;
+		_orientation.toEuler(pitch, yaw, roll);
+		_orientation.setFromEuler(angle, yaw, roll);
+		snapStepOrientations();
 	}
 
 	void Camera::setYaw(float angle)
 	{
-		_yaw = clampAngle(angle);
+		float pitch, yaw, roll;
+		_orientation.toEuler(pitch, yaw, roll);
+		_orientation.setFromEuler(pitch, angle, roll);
+		snapStepOrientations();
 	}
 
 	void Camera::setRoll(float angle)
 	{
-		_roll = clampAngle(angle);
+		float pitch, yaw, roll;
+		_orientation.toEuler(pitch, yaw, roll);
+		_orientation.setFromEuler(pitch, yaw, angle);
+		snapStepOrientations();
 	}
 
-	// Keep the angle in the range 0 to 360 (2*PI)
-	float Camera::clampAngle(float angle) const
+	float Camera::getPitch()
 	{
-		while (angle > XM_2PI)
-		{
-			angle -= XM_2PI;
-		}
-		while (angle < 0)
-		{
-			angle += XM_2PI;
-		}
-		return angle;
+		float pitch, yaw, roll;
+		_orientation.toEuler(pitch, yaw, roll);
+		return pitch;
+	}
+
+	float Camera::getYaw()
+	{
+		float pitch, yaw, roll;
+		_orientation.toEuler(pitch, yaw, roll);
+		return yaw;
+	}
+
+	float Camera::getRoll()
+	{
+		float pitch, yaw, roll;
+		_orientation.toEuler(pitch, yaw, roll);
+		return roll;
+	}
+
+	// Only valid between ticks. The movement of a tick which simulated no step is part of the state, as the next step picks it up.
+	CameraState Camera::getState()
+	{
+		CameraState toReturn;
+		toReturn.orientation = _orientation.orientation();
+		toReturn.previousStepOrientation = _previousStepOrientation;
+		toReturn.lastStepOrientation = _lastStepOrientation;
+		toReturn.previousStepOffset = _previousStepOffset;
+		toReturn.lastStepOffset = _lastStepOffset;
+		toReturn.lookDirectionInverter = _lookDirectionInverter;
+		toReturn.pendingMovement = _direction;
+		toReturn.movementPending = _movementOccurred;
+		return toReturn;
+	}
+
+	void Camera::setState(const CameraState& state)
+	{
+		_orientation.restoreOrientation(state.orientation);
+		_previousStepOrientation = state.previousStepOrientation;
+		_lastStepOrientation = state.lastStepOrientation;
+		_previousStepOffset = state.previousStepOffset;
+		_lastStepOffset = state.lastStepOffset;
+		_lookDirectionInverter = state.lookDirectionInverter;
+		_direction = state.pendingMovement;
+		_movementOccurred = state.movementPending;
+	}
+
+	// An orientation which is set isn't interpolated to: the camera has to be there right away.
+	void Camera::snapStepOrientations()
+	{
+		_previousStepOrientation = _orientation.orientation();
+		_lastStepOrientation = _previousStepOrientation;
 	}
 }
\ No newline at end of file
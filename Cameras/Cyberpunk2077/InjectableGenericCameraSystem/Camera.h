@@ -27,17 +27,34 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "stdafx.h"
+#include "CameraMath.h"
+#include "GameConstants.h"
 
 namespace IGCS
 {
+	// Everything a Camera keeps from one tick to the next, so a recorded session can be replayed from the middle. 
+	struct CameraState
+	{
+		Math::Quat orientation;
+		Math::Quat previousStepOrientation;
+		Math::Quat lastStepOrientation;
+		Math::Vec3 previousStepOffset;
+		Math::Vec3 lastStepOffset;
+		float lookDirectionInverter;
+		Math::Vec3 pendingMovement;		// moved in a tick without a step, which the next step picks up
+		bool movementPending;
+	};
+
+
 	class Camera
 	{
 	public:
 		Camera();
 		~Camera(void);
 
-		DirectX::XMVECTOR calculateLookQuaternion();
-		DirectX::XMFLOAT3 calculateNewCoords(const DirectX::XMFLOAT3 currentCoords, const DirectX::XMVECTOR lookQ);
+		Math::Quat calculateLookQuaternion(float interpolationFactor);
+		Math::Vec3d calculateNewCoords(const Math::Vec3d& currentCoords, float interpolationFactor);
+		void endStep();
 		void resetMovement();
 		void resetAngles();
 		void moveForward(float amount);
@@ -49,20 +66,25 @@ namespace IGCS
 		void setPitch(float angle);
 		void setYaw(float angle);
 		void setRoll(float angle);
-		float getPitch() { return _pitch; }
-		float getYaw() { return _yaw; }
-		float getRoll() { return _roll; }
+		float getPitch();
+		float getYaw();
+		float getRoll();
 		float lookDirectionInverter() { return _lookDirectionInverter; }
 		void toggleLookDirectionInverter() { _lookDirectionInverter = -_lookDirectionInverter; }
+		CameraState getState();
+		void setState(const CameraState& state);
 
 	private:
-		float clampAngle(float angle) const;
+		void snapStepOrientations();
 
-		DirectX::XMFLOAT3 _direction;
-		float _yaw;
-		float _pitch;
-		float _roll;
+		Math::Vec3 _direction;		// movement in camera space since the last step
+		Math::CameraOrientation<GameSpecific::CameraAxes> _orientation;
 		bool _movementOccurred;
+		// state at the end of the last two steps. The offsets are relative to the coordinates written to the game by calculateNewCoords
+		Math::Quat _previousStepOrientation;
+		Math::Quat _lastStepOrientation;
+		Math::Vec3 _previousStepOffset;
+		Math::Vec3 _lastStepOffset;
 		float _lookDirectionInverter;
 	};
 }
\ No newline at end of file
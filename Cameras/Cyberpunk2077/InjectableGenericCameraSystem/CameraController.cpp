@@ -0,0 +1,565 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "CameraController.h"
+#include "Globals.h"
+#include "Defaults.h"
+#include "GameConstants.h"
+#include "Gamepad.h"
+#include "CameraManipulator.h"
+#include "Input.h"
+#include "MessageHandler.h"
+#include "SessionRecording.h"
+
+namespace IGCS
+{
+	using namespace IGCS::GameSpecific;
+
+	CameraController::CameraController()
+	{
+	}
+
+
+	CameraController::~CameraController()
+	{
+	}
+
+
+	// Runs a tick: handles the actions of the user, moves the camera by the time the tick simulates and writes it to the game.
+	void CameraController::update(const TickInput& input)
+	{
+		const FrameTime& frameTime = input.frameTime;
+		bool cameraCanMove = handleUserInput(input);
+		float multiplier = cameraCanMove ? calculateMovementMultiplier() : 0.0f;
+		// Mouse input is a distance and a keyboard action like a 90 degree tilt happens once, so they're applied once per tick, also if the
+		// tick simulates no step: the camera keeps them till the next step. Keyboard and gamepad input is a speed, so it's applied in every
+		// step, scaled by the time the step simulates. Fov changes are a speed too, but they aren't part of the camera's steps, so they're
+		// applied once per tick, scaled by the time the tick simulates.
+		if (cameraCanMove)
+		{
+			handleKeyboardCameraActions();
+			handleMouseCameraMovement(multiplier);
+			handleGamePadCameraActions(frameTime.deltaSeconds / REFERENCE_TICK_SECONDS);
+		}
+		float timeMultiplier = frameTime.stepSeconds / REFERENCE_TICK_SECONDS;
+		for (int i = 0; i < frameTime.numberOfSteps; i++)
+		{
+			if (cameraCanMove)
+			{
+				handleKeyboardCameraMovement(multiplier * timeMultiplier);
+				handleGamePadMovement(multiplier, timeMultiplier);
+			}
+			_camera.endStep();
+		}
+		CameraManipulator::updateCameraDataInGameData(_camera, frameTime.interpolationFactor);
+	}
+
+
+	void CameraController::onCameraStructFound()
+	{
+		_cameraStructFound = true;
+		_camera.setPitch(INITIAL_PITCH_RADIANS);
+		_camera.setRoll(INITIAL_ROLL_RADIANS);
+		_camera.setYaw(INITIAL_YAW_RADIANS);
+
+		CameraManipulator::applySettingsToGameState();
+	}
+
+
+	// Gives the game its own camera, time and hud back, e.g. before the dll is unloaded.
+	void CameraController::restoreGameState()
+	{
+		if (!_cameraStructFound)
+		{
+			return;
+		}
+		if (g_cameraEnabled)
+		{
+			onCameraDisabled();
+			g_cameraEnabled = 0;
+		}
+		if (CameraManipulator::gameIsPaused())
+		{
+			toggleGamePause(false);
+		}
+		if (!Globals::instance().hudVisible())
+		{
+			toggleHud();
+		}
+	}
+
+
+	// Obtains what the ticks depend on, so a recorded session can be replayed from this point. Call between ticks.
+	void CameraController::saveState(SessionKeyframe& keyframe)
+	{
+		Globals& globals = Globals::instance();
+		keyframe.cameraStructFound = _cameraStructFound;
+		keyframe.cameraEnabled = g_cameraEnabled != 0;
+		keyframe.cameraMovementLocked = _cameraMovementLocked;
+		keyframe.inputBlocked = globals.inputBlocked();
+		keyframe.hudVisible = globals.hudVisible();
+		keyframe.camera = _camera.getState();
+		CameraManipulator::getState(keyframe.cameraManipulator);
+		Input::getState(keyframe.input);
+		keyframe.settings = globals.settings();
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			KeyBindingState& binding = keyframe.keyBindings[i];
+			ActionData* data = globals.getActionData(static_cast<ActionType>(i));
+			binding.keyCode = nullptr == data ? 0 : static_cast<uint8_t>(data->getKeyCode());
+			binding.altRequired = nullptr != data && data->getAltRequired();
+			binding.ctrlRequired = nullptr != data && data->getCtrlRequired();
+			binding.shiftRequired = nullptr != data && data->getShiftRequired();
+		}
+	}
+
+
+	void CameraController::restoreState(const SessionKeyframe& keyframe)
+	{
+		Globals& globals = Globals::instance();
+		_cameraStructFound = keyframe.cameraStructFound;
+		g_cameraEnabled = keyframe.cameraEnabled ? (uint8_t)1 : (uint8_t)0;
+		_cameraMovementLocked = keyframe.cameraMovementLocked;
+		globals.inputBlocked(keyframe.inputBlocked);
+		globals.hudVisible(keyframe.hudVisible);
+		_camera.setState(keyframe.camera);
+		CameraManipulator::setState(keyframe.cameraManipulator);
+		Input::setState(keyframe.input);
+		globals.settings() = keyframe.settings;
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			const KeyBindingState& binding = keyframe.keyBindings[i];
+			globals.setKeyBinding(static_cast<ActionType>(i), binding.keyCode, binding.altRequired, binding.ctrlRequired, binding.shiftRequired);
+		}
+	}
+
+
+	// The settings are changed in the client, so its messages are applied also when the game doesn't have the focus.
+	void CameraController::applyMessages(const TickInput& input)
+	{
+		for (int i = 0; i < input.numberOfMessages; i++)
+		{
+			Globals::instance().applyMessage(input.messages[i]);
+		}
+		if (input.numberOfMessages > 0)
+		{
+			CameraManipulator::applySettingsToGameState();
+		}
+	}
+
+
+	void CameraController::onCameraDisabled()
+	{
+		CameraManipulator::restoreOriginalValuesAfterCameraDisable();
+		toggleCameraMovementLockState(false);
+	}
+
+	void CameraController::onCameraEnabled()
+	{
+		CameraManipulator::cacheOriginalValuesBeforeCameraEnable();
+		_camera.resetAngles();
+		_camera.resetMovement();
+	}
+
+	// Handles the actions of the user. Returns true if the camera can be moved by the user.
+	bool CameraController::handleUserInput(const TickInput& input)
+	{
+		applyMessages(input);
+		// the mouse input of this tick, which is thrown away if it's not used, so it doesn't pile up till the camera can move
+		Input::applyMouseInput(input.mouse);
+		if (!input.gameHasFocus)
+		{
+			// our window isn't focused, exit. We won't see keys being released, so forget which ones were down.
+			Input::resetActionStates();
+			return false;
+		}
+		
+		Globals::instance().gamePad().update(input.gamepad, input.gamepadConnected);
+		Input::updateActionStates(input.keyboard, input.nowInMicroseconds);
+
+		if (!_cameraStructFound)
+		{
+			// camera not found yet, can't proceed.
+			return false;
+		}
+
+		// If we've changed settings by a keyboard setting, we'll apply them here. 
+		CameraManipulator::applySettingsToGameState();
+
+#ifdef _DEBUG
+		static bool debugInfoKeyWasDown = false;
+		bool debugInfoKeyDown = Input::isKeyDown(VK_END);
+		if(debugInfoKeyDown && !debugInfoKeyWasDown)
+		{
+			CameraManipulator::displayDebugInfo();
+		}
+		debugInfoKeyWasDown = debugInfoKeyDown;
+#endif
+		
+		if (Input::isActionActivated(ActionType::CameraEnable))
+		{
+			if (g_cameraEnabled)
+			{
+				// it's going to be disabled, make sure things are alright when we give it back to the host
+				onCameraDisabled();
+			}
+			else
+			{
+				// it's going to be enabled, so cache the original values before we enable it so we can restore it afterwards
+				onCameraEnabled();
+			}
+			g_cameraEnabled = g_cameraEnabled == 0 ? (uint8_t)1 : (uint8_t)0;
+			displayCameraState();
+		}
+
+		// held keys change the time of day and the fov at a speed, so scale the change by the time the tick simulates
+		float timeMultiplier = input.frameTime.deltaSeconds / REFERENCE_TICK_SECONDS;
+		if (Input::isActionDown(ActionType::TimeOfDayEarlier, true))
+		{
+			CameraManipulator::changeTimeOfDayUsingAmount(-DEFAULT_TOD_CHANGE * (Input::altPressed() ? 0.1f : 1.0f) * timeMultiplier);
+		}
+		if (Input::isActionDown(ActionType::TimeOfDayLater, true))
+		{
+			CameraManipulator::changeTimeOfDayUsingAmount(DEFAULT_TOD_CHANGE * (Input::altPressed() ? 0.1f : 1.0f) * timeMultiplier);
+		}
+		if (Input::isActionActivated(ActionType::FovReset) && Globals::instance().keyboardMouseControlCamera())
+		{
+			CameraManipulator::resetFoV();
+		}
+		if (Input::isActionDown(ActionType::FovDecrease, false) && Globals::instance().keyboardMouseControlCamera())
+		{
+			CameraManipulator::changeFoV(-Globals::instance().settings().fovChangeSpeed * timeMultiplier);
+		}
+		if (Input::isActionDown(ActionType::FovIncrease, false) && Globals::instance().keyboardMouseControlCamera())
+		{
+			CameraManipulator::changeFoV(Globals::instance().settings().fovChangeSpeed * timeMultiplier);
+		}
+		if (Input::isActionActivated(ActionType::Timestop))
+		{
+			toggleGamePause();
+		}
+		if (Input::isActionActivated(ActionType::SkipFrames, true))
+		{
+			CameraManipulator::stepGameInPause();
+		}
+		if (Input::isActionActivated(ActionType::HudToggle))
+		{
+			toggleHud();
+		}
+		if (!g_cameraEnabled)
+		{
+			// camera is disabled. We simply disable all input to the camera movement, by returning now.
+			return false;
+		}
+		if (Input::isActionActivated(ActionType::BlockInput))
+		{
+			toggleInputBlockState(!Globals::instance().inputBlocked());
+		}
+		if (Input::isActionActivated(ActionType::CameraLock)) 
+		{
+			toggleCameraMovementLockState(!_cameraMovementLocked);
+		}
+		// if locked, no movement allowed
+		return !_cameraMovementLocked;
+	}
+
+
+	float CameraController::calculateMovementMultiplier()
+	{
+		Settings& settings = Globals::instance().settings();
+		bool altPressed = Input::altPressed();
+		bool controlPressed = Input::ctrlPressed();
+		float multiplier = altPressed ? settings.fastMovementMultiplier : controlPressed ? settings.slowMovementMultiplier : 1.0f;
+		// Calculates a multiplier based on the current fov. We have a baseline of DEFAULT_FOV. If the fov is > than that, use 1.0
+		// otherwise calculate a factor by using the currentfov / DEFAULT_FOV. Cap the minimum at 0.1 so some movement is still possible :)
+		multiplier *= Utils::clamp(abs(CameraManipulator::getCurrentFoV()) / DEFAULT_FOV_DEGREES, 0.01f, 1.0f);
+		return multiplier;
+	}
+
+
+	void CameraController::handleGamePadMovement(float multiplierBase, float timeMultiplier)
+	{
+		if(!Globals::instance().controllerControlsCamera())
+		{
+			return;
+		}
+
+		Gamepad& gamePad = Globals::instance().gamePad();
+
+		if (gamePad.isConnected())
+		{
+			Settings& settings = Globals::instance().settings();
+			float  multiplier = gamePad.isButtonPressed(IGCS_BUTTON_FASTER) ? settings.fastMovementMultiplier 
+																			: gamePad.isButtonPressed(IGCS_BUTTON_SLOWER) ? settings.slowMovementMultiplier : multiplierBase;
+			multiplier *= timeMultiplier;
+			vec2 rightStickPosition = gamePad.getRStickPosition();
+			_camera.pitch(rightStickPosition.y * multiplier);
+			_camera.yaw(rightStickPosition.x * multiplier);
+
+			vec2 leftStickPosition = gamePad.getLStickPosition();
+			_camera.moveUp((gamePad.getLTrigger() - gamePad.getRTrigger()) * multiplier);
+			_camera.moveForward(leftStickPosition.y * multiplier);
+			_camera.moveRight(leftStickPosition.x * multiplier);
+
+			if (gamePad.isButtonPressed(IGCS_BUTTON_TILT_LEFT))
+			{
+				_camera.roll(multiplier);
+			}
+			if (gamePad.isButtonPressed(IGCS_BUTTON_TILT_RIGHT))
+			{
+				_camera.roll(-multiplier);
+			}
+		}
+	}
+
+
+	void CameraController::handleGamePadCameraActions(float timeMultiplier)
+	{
+		if (!Globals::instance().controllerControlsCamera())
+		{
+			return;
+		}
+
+		Gamepad& gamePad = Globals::instance().gamePad();
+
+		if (gamePad.isConnected())
+		{
+			if (gamePad.isButtonPressed(IGCS_BUTTON_RESET_FOV))
+			{
+				CameraManipulator::resetFoV();
+			}
+			if (gamePad.isButtonPressed(IGCS_BUTTON_FOV_DECREASE))
+			{
+				CameraManipulator::changeFoV(-Globals::instance().settings().fovChangeSpeed * timeMultiplier);
+			}
+			if (gamePad.isButtonPressed(IGCS_BUTTON_FOV_INCREASE))
+			{
+				CameraManipulator::changeFoV(Globals::instance().settings().fovChangeSpeed * timeMultiplier);
+			}
+		}
+	}
+
+
+	void CameraController::handleMouseCameraMovement(float multiplier)
+	{
+		if (!Globals::instance().keyboardMouseControlCamera())
+		{
+			return;
+		}
+		long mouseDeltaX = Input::getMouseDeltaX();
+		long mouseDeltaY = Input::getMouseDeltaY();
+		bool leftButtonPressed = Input::isMouseButtonDown(0);
+		bool rightButtonPressed = Input::isMouseButtonDown(1);
+		bool noButtonPressed = !(leftButtonPressed || rightButtonPressed);
+		if (mouseDeltaY != 0)
+		{
+			float yValue = (static_cast<float>(mouseDeltaY) * MOUSE_SPEED_CORRECTION * multiplier);
+			if (noButtonPressed)
+			{
+				_camera.pitch(-yValue);
+			}
+			else
+			{
+				if (leftButtonPressed)
+				{
+					// move up / down
+					_camera.moveUp(-yValue);
+				}
+				else
+				{
+					// forward/backwards
+					_camera.moveForward(-yValue);
+				}
+			}
+		}
+		if (mouseDeltaX != 0)
+		{
+			float xValue = static_cast<float>(mouseDeltaX) * MOUSE_SPEED_CORRECTION * multiplier;
+			if (noButtonPressed)
+			{
+				_camera.yaw(xValue);
+			}
+			else
+			{
+				// if both buttons are pressed: do tilt
+				if (leftButtonPressed && rightButtonPressed)
+				{
+					_camera.roll(-xValue);
+				}
+				else
+				{
+					// always left/right
+					_camera.moveRight(xValue);
+				}
+			}
+		}
+		short mouseWheelDelta = Input::getMouseWheelDelta();
+		if (abs(mouseWheelDelta) > 0)
+		{
+			MessageHandler::logDebug("Changing for with mouse delta: %d", mouseWheelDelta);
+			CameraManipulator::changeFoV(-(static_cast<float>(mouseWheelDelta) * Globals::instance().settings().fovChangeSpeed));
+		}
+	}
+
+
+	// The keyboard actions which set the camera instead of moving it, like a 90 degree tilt.
+	void CameraController::handleKeyboardCameraActions()
+	{
+		if (!Globals::instance().keyboardMouseControlCamera())
+		{
+			return;
+		}
+		if (Input::isActionDown(ActionType::ResetTilt, true))
+		{
+			_camera.setRoll(0.0f);
+		}
+		if (!Input::altPressed())
+		{
+			return;
+		}
+		if (Input::isActionActivated(ActionType::TiltLeft, false, true))
+		{
+			_camera.setRoll(_camera.getRoll() + (0.5 * Math::PI));
+		}
+		if (Input::isActionActivated(ActionType::TiltRight, false, true))
+		{
+			_camera.setRoll(_camera.getRoll() - (0.5 * Math::PI));
+		}
+	}
+
+
+	void CameraController::handleKeyboardCameraMovement(float multiplier)
+	{
+		if (!Globals::instance().keyboardMouseControlCamera())
+		{
+			return;
+		}
+		bool altPressed = Input::altPressed();
+		if (Input::isActionDown(ActionType::MoveForward, true))
+		{
+			_camera.moveForward(multiplier);
+		}
+		if (Input::isActionDown(ActionType::MoveBackward, true))
+		{
+			_camera.moveForward(-multiplier);
+		}
+		if (Input::isActionDown(ActionType::MoveRight, true))
+		{
+			_camera.moveRight(multiplier);
+		}
+		if (Input::isActionDown(ActionType::MoveLeft, true))
+		{
+			_camera.moveRight(-multiplier);
+		}
+		if (Input::isActionDown(ActionType::MoveUp, true))
+		{
+			_camera.moveUp(multiplier);
+		}
+		if (Input::isActionDown(ActionType::MoveDown, true))
+		{
+			_camera.moveUp(-multiplier);
+		}
+		if (Input::isActionDown(ActionType::RotateDown, true))
+		{
+			_camera.pitch(-multiplier);
+		}
+		if (Input::isActionDown(ActionType::RotateUp, true))
+		{
+			_camera.pitch(multiplier);
+		}
+		if (Input::isActionDown(ActionType::RotateRight, true))
+		{
+			_camera.yaw(multiplier);
+		}
+		if (Input::isActionDown(ActionType::RotateLeft, true))
+		{
+			_camera.yaw(-multiplier);
+		}
+		if (!altPressed)
+		{
+			// with alt these tilt by 90 degrees, see handleKeyboardCameraActions
+			if (Input::isActionDown(ActionType::TiltLeft, true))
+			{
+				_camera.roll(multiplier);
+			}
+			if (Input::isActionDown(ActionType::TiltRight, true))
+			{
+				_camera.roll(-multiplier);
+			}
+		}
+	}
+
+
+	void CameraController::toggleCameraMovementLockState(bool newValue)
+	{
+		if (_cameraMovementLocked == newValue)
+		{
+			// already in this state. Ignore
+			return;
+		}
+		_cameraMovementLocked = newValue;
+		MessageHandler::addNotification(_cameraMovementLocked ? "Camera movement is locked" : "Camera movement is unlocked");
+	}
+	
+
+	void CameraController::toggleInputBlockState(bool newValue)
+	{
+		if (Globals::instance().inputBlocked() == newValue)
+		{
+			// already in this state. Ignore
+			return;
+		}
+		Globals::instance().inputBlocked(newValue);
+		MessageHandler::addNotification(newValue ? "Input to game blocked" : "Input to game enabled");
+	}
+
+	void CameraController::toggleHud()
+	{
+		bool hudVisible = Globals::instance().toggleHudVisible();
+		CameraManipulator::toggleHud(hudVisible);
+		MessageHandler::addNotification(hudVisible ? "HUD visible" : "HUD hidden");
+	}
+
+
+	void CameraController::displayCameraState()
+	{
+		MessageHandler::addNotification(g_cameraEnabled ? "Camera enabled" : "Camera disabled");
+	}
+	
+
+	void CameraController::toggleGamePause(bool displayNotification)
+	{
+		bool gameIsPaused = CameraManipulator::gameIsPaused();
+		CameraManipulator::setTimeStopValue(!gameIsPaused);
+		if (displayNotification)
+		{
+			// gameIsPaused is the state before we toggled it, so we have to display the reverse text!
+			MessageHandler::addNotification(gameIsPaused ? "Game unpaused" : "Game paused");
+		}
+	}
+}
@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "Camera.h"
+#include "TickInput.h"
+
+namespace IGCS
+{
+	struct SessionKeyframe;
+
+	// Runs the ticks of the camera: it handles the actions of the user and moves the camera with the input of a tick, then writes the camera
+	// to the game. It doesn't read any input itself, that's captured by System into a TickInput, so a recorded session can be fed through
+	// the same code, also without the game. 
+	class CameraController
+	{
+	public:
+		CameraController();
+		~CameraController();
+
+		void update(const TickInput& input);
+		bool handleUserInput(const TickInput& input);
+		void onCameraStructFound();
+		void restoreGameState();
+		void saveState(SessionKeyframe& keyframe);
+		void restoreState(const SessionKeyframe& keyframe);
+
+	private:
+		void applyMessages(const TickInput& input);
+		void onCameraDisabled();
+		void onCameraEnabled();
+		void displayCameraState();
+		void toggleCameraMovementLockState(bool newValue);
+		void handleKeyboardCameraActions();
+		void handleKeyboardCameraMovement(float multiplier);
+		void handleMouseCameraMovement(float multiplier);
+		void handleGamePadMovement(float multiplierBase, float timeMultiplier);
+		void handleGamePadCameraActions(float timeMultiplier);
+		float calculateMovementMultiplier();
+		void toggleInputBlockState(bool newValue);
+		void toggleHud();
+		void toggleGamePause(bool displayNotification = true);
+
+		Camera _camera;
+		bool _cameraMovementLocked = false;
+		bool _cameraStructFound = false;
+	};
+}
@@ -31,16 +31,32 @@
 #include "Globals.h"
 #include "Camera.h"
 #include "GameCameraData.h"
-#include "GameImageHooker.h"
 #include "MessageHandler.h"
+#include <chrono>
+#include <thread>
 
-using namespace DirectX;
 using namespace std;
 
 namespace IGCS::GameSpecific::CameraManipulator
 {
 	static GameCameraData _originalCameraData;
 	static float _coordMultiplierFactor = 0.0f;
+	// While the camera is enabled this is the camera position: what's in the camera struct is this position rounded to packed int32s, and
+	// continuing from that would lose slow movement. It's only taken from the camera struct again if something else moved the camera.
+	static Math::Vec3d _cameraPosition;
+	static bool _cameraPositionIsValid = false;
+	static int32_t _publishedCoordsHistory[PUBLISHED_COORDS_HISTORY_SIZE][3];
+	static int _publishedCoordsHistoryCount = 0;
+	static int _publishedCoordsHistoryIndex = 0;
+	static uint32_t _lastAppliedSequence = 0;
+	static uint64_t _lastPoseAppliedTime = 0;
+
+
+	// Milliseconds since some fixed point in time, like GetTickCount64.
+	uint64_t currentTimeInMs()
+	{
+		return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
 
 
 	bool isPhotomodeActivated()
@@ -59,19 +75,63 @@ namespace IGCS::GameSpecific::CameraManipulator
 	}
 	
 
-	float convertPackedInt32ToFloat(int toConvert)
+	double getCoordMultiplierFactor()
 	{
-		return static_cast<float>(toConvert) * _coordMultiplierFactor;
+		return _coordMultiplierFactor <= 0.0f ? 1.0 : static_cast<double>(_coordMultiplierFactor);
 	}
 
-	
-	int convertFloatToPackedInt32(float toConvert)
+
+	void addToPublishedCoordsHistory(const int32_t packedCoords[3])
+	{
+		memcpy(_publishedCoordsHistory[_publishedCoordsHistoryIndex], packedCoords, sizeof(int32_t) * 3);
+		_publishedCoordsHistoryIndex = (_publishedCoordsHistoryIndex + 1) % PUBLISHED_COORDS_HISTORY_SIZE;
+		_publishedCoordsHistoryCount = (std::min)(_publishedCoordsHistoryCount + 1, PUBLISHED_COORDS_HISTORY_SIZE);
+	}
+
+
+	bool wasPublishedRecently(const int32_t packedCoords[3])
 	{
-		if(_coordMultiplierFactor<=0.0f)
+		for (int i = 0; i < _publishedCoordsHistoryCount; i++)
 		{
-			return static_cast<int>(toConvert);
+			if (0 == memcmp(_publishedCoordsHistory[i], packedCoords, sizeof(int32_t) * 3))
+			{
+				return true;
+			}
 		}
-		return static_cast<int>(toConvert / _coordMultiplierFactor);
+		return false;
+	}
+
+
+	void invalidateCameraPosition()
+	{
+		_cameraPositionIsValid = false;
+		_publishedCoordsHistoryCount = 0;
+		_publishedCoordsHistoryIndex = 0;
+	}
+
+
+	// Takes the position from the camera struct if we don't have one or if the coordinates in there aren't ones we published, which means
+	// the game moved the camera. 
+	void syncCameraPositionWithGame()
+	{
+		volatile int32_t* coordsInMemory = reinterpret_cast<volatile int32_t*>(g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET);
+		int32_t packedCoords[3] = { coordsInMemory[0], coordsInMemory[1], coordsInMemory[2] };
+		if (_cameraPositionIsValid)
+		{
+			if (wasPublishedRecently(packedCoords))
+			{
+				return;
+			}
+			// the interceptor could have been writing while we read, then the coordinates are a mix of two poses. 
+			int32_t packedCoordsReadAgain[3] = { coordsInMemory[0], coordsInMemory[1], coordsInMemory[2] };
+			if (0 != memcmp(packedCoords, packedCoordsReadAgain, sizeof(packedCoords)))
+			{
+				return;
+			}
+			MessageHandler::logDebug("The camera was moved by the game, continuing from its position.");
+		}
+		_cameraPosition = Math::packedToWorld(packedCoords, getCoordMultiplierFactor());
+		_cameraPositionIsValid = true;
 	}
 
 	
@@ -108,7 +168,7 @@ namespace IGCS::GameSpecific::CameraManipulator
 	}
 
 
-	void updateCameraDataInGameData(Camera& camera)
+	void updateCameraDataInGameData(Camera& camera, float interpolationFactor)
 	{
 		if (!g_cameraEnabled)
 		{
@@ -116,14 +176,17 @@ namespace IGCS::GameSpecific::CameraManipulator
 		}
 
 		// calculate new camera values. We have two cameras, but they might not be available both, so we have to test before we do anything. 
-		DirectX::XMVECTOR newLookQuaternion = camera.calculateLookQuaternion();
-		DirectX::XMFLOAT3 currentCoords;
-		DirectX::XMFLOAT3 newCoords;
+		Math::Quat newLookQuaternion = camera.calculateLookQuaternion(interpolationFactor);
 		if (isCameraFound())
 		{
-			currentCoords = getCurrentCameraCoords();
-			newCoords = camera.calculateNewCoords(currentCoords, newLookQuaternion);
-			writeNewCameraValuesToGameData(newCoords, newLookQuaternion);
+			syncCameraPositionWithGame();
+			_cameraPosition = camera.calculateNewCoords(_cameraPosition, interpolationFactor);
+			publishNewCameraValues(_cameraPosition, newLookQuaternion);
+		}
+		else
+		{
+			// nothing to move, so don't let the movement pile up till the camera is back
+			camera.resetMovement();
 		}
 	}
 
@@ -175,7 +238,7 @@ namespace IGCS::GameSpecific::CameraManipulator
 		{
 			// game is paused
 			setTimeStopValue(false); // unpause
-			Sleep(66);	// wait a couple of frames
+			this_thread::sleep_for(chrono::milliseconds(66));	// wait a couple of frames
 			setTimeStopValue(true);	// pause again
 		}
 	}
@@ -271,34 +334,56 @@ namespace IGCS::GameSpecific::CameraManipulator
 	}
 	
 
-	XMFLOAT3 getCurrentCameraCoords()
+	Math::Vec3d getCurrentCameraCoords()
 	{
-		int* coordsInMemory = reinterpret_cast<int*>(g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET);
-		return XMFLOAT3(convertPackedInt32ToFloat(coordsInMemory[0]), convertPackedInt32ToFloat(coordsInMemory[1]), convertPackedInt32ToFloat(coordsInMemory[2]));
+		int32_t* coordsInMemory = reinterpret_cast<int32_t*>(g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET);
+		return Math::packedToWorld(coordsInMemory, getCoordMultiplierFactor());
 	}
 
 
 	// newCoords are the new coordinates for the camera in worldspace. 
-	void writeNewCameraValuesToGameData(XMFLOAT3 newCoords, XMVECTOR newLookQuaternion)
+	void writeNewCameraValuesToGameData(Math::Vec3d newCoords, Math::Quat newLookQuaternion)
 	{
 		if (!isCameraFound())
 		{
 			return;
 		}
 
-		XMFLOAT4 qAsFloat4;
-		XMStoreFloat4(&qAsFloat4, newLookQuaternion);
-
-		int* coordsInMemory = reinterpret_cast<int*>(g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET);
-		coordsInMemory[0] = convertFloatToPackedInt32(newCoords.x);
-		coordsInMemory[1] = convertFloatToPackedInt32(newCoords.y);
-		coordsInMemory[2] = convertFloatToPackedInt32(newCoords.z);
+		int32_t* coordsInMemory = reinterpret_cast<int32_t*>(g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET);
+		Math::worldToPacked(newCoords, getCoordMultiplierFactor(), coordsInMemory);
 
 		float* quaternionInMemory = reinterpret_cast<float*>(g_activeCamStructAddress + QUATERNION_IN_CAMSTRUCT_OFFSET);
-		quaternionInMemory[0] = qAsFloat4.x;
-		quaternionInMemory[1] = qAsFloat4.y;
-		quaternionInMemory[2] = qAsFloat4.z;
-		quaternionInMemory[3] = qAsFloat4.w;
+		quaternionInMemory[0] = newLookQuaternion.x;
+		quaternionInMemory[1] = newLookQuaternion.y;
+		quaternionInMemory[2] = newLookQuaternion.z;
+		quaternionInMemory[3] = newLookQuaternion.w;
+	}
+
+
+	// Publishes the pose for activeCamWrite1Interceptor, which writes it to the camera struct when the game writes its camera. If the game
+	// hasn't done that for a while, e.g. because it doesn't update its camera in some state, the pose is written directly. 
+	void publishNewCameraValues(Math::Vec3d newCoords, Math::Quat newLookQuaternion)
+	{
+		CameraPose pose;
+		Math::worldToPacked(newCoords, getCoordMultiplierFactor(), pose.coords);
+		pose.quaternion[0] = newLookQuaternion.x;
+		pose.quaternion[1] = newLookQuaternion.y;
+		pose.quaternion[2] = newLookQuaternion.z;
+		pose.quaternion[3] = newLookQuaternion.w;
+		g_cameraPose.publish(pose);
+		addToPublishedCoordsHistory(pose.coords);
+
+		uint64_t now = currentTimeInMs();
+		uint32_t appliedSequence = g_cameraPose.appliedSequence();
+		if (appliedSequence != _lastAppliedSequence)
+		{
+			_lastAppliedSequence = appliedSequence;
+			_lastPoseAppliedTime = now;
+		}
+		if (now - _lastPoseAppliedTime > POSE_APPLY_TIMEOUT_MS)
+		{
+			writeNewCameraValuesToGameData(newCoords, newLookQuaternion);
+		}
 	}
 
 
@@ -336,8 +421,60 @@ namespace IGCS::GameSpecific::CameraManipulator
 	}
 
 
+	// Reads the coordinates and fov the camera struct has right now. Returns false if the camera hasn't been found.
+	bool readGameCameraData(int32_t coords[3], float& fov)
+	{
+		if (!isCameraFound())
+		{
+			return false;
+		}
+		memcpy(coords, g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET, sizeof(int32_t) * 3);
+		fov = getCurrentFoV();
+		return true;
+	}
+
+
+	// Puts back what readGameCameraData read, so a replayed tick starts with the camera struct the recorded tick saw.
+	void writeGameCameraData(const int32_t coords[3], float fov)
+	{
+		if (!isCameraFound())
+		{
+			return;
+		}
+		memcpy(g_activeCamStructAddress + COORDS_IN_CAMSTRUCT_OFFSET, coords, sizeof(int32_t) * 3);
+		*reinterpret_cast<float*>(g_activeCamStructAddress + getFovOffsetInActiveCameraStruct()) = fov;
+	}
+
+
+	void getState(CameraManipulatorState& state)
+	{
+		state.cameraPosition = _cameraPosition;
+		state.cameraPositionIsValid = _cameraPositionIsValid;
+		state.originalCameraData = _originalCameraData;
+		state.coordMultiplierFactor = _coordMultiplierFactor;
+		memcpy(state.publishedCoordsHistory, _publishedCoordsHistory, sizeof(_publishedCoordsHistory));
+		state.publishedCoordsHistoryCount = _publishedCoordsHistoryCount;
+		state.publishedCoordsHistoryIndex = _publishedCoordsHistoryIndex;
+	}
+
+
+	void setState(const CameraManipulatorState& state)
+	{
+		_cameraPosition = state.cameraPosition;
+		_cameraPositionIsValid = state.cameraPositionIsValid;
+		_originalCameraData = state.originalCameraData;
+		_coordMultiplierFactor = state.coordMultiplierFactor;
+		memcpy(_publishedCoordsHistory, state.publishedCoordsHistory, sizeof(_publishedCoordsHistory));
+		_publishedCoordsHistoryCount = (std::max)(0, (std::min)(state.publishedCoordsHistoryCount, PUBLISHED_COORDS_HISTORY_SIZE));
+		_publishedCoordsHistoryIndex = (std::max)(0, (std::min)(state.publishedCoordsHistoryIndex, PUBLISHED_COORDS_HISTORY_SIZE - 1));
+	}
+
+
 	void restoreOriginalValuesAfterCameraDisable()
 	{
+		// the interceptor mustn't overwrite the restored values with our last pose
+		g_cameraPose.clear();
+		invalidateCameraPosition();
 		restoreGameCameraDataWithCachedData(_originalCameraData);
 	}
 
@@ -345,5 +482,7 @@ namespace IGCS::GameSpecific::CameraManipulator
 	void cacheOriginalValuesBeforeCameraEnable()
 	{
 		cacheGameCameraDataInCache(_originalCameraData);
+		invalidateCameraPosition();
+		_lastPoseAppliedTime = currentTimeInMs();
 	}
 }
\ No newline at end of file
@@ -32,11 +32,28 @@
 
 namespace IGCS::GameSpecific::CameraManipulator
 {
-	void updateCameraDataInGameData(Camera& camera);
-	void writeNewCameraValuesToGameData(DirectX::XMFLOAT3 newCoords, DirectX::XMVECTOR newLookQuaternion);
+	// # of published packed coordinates remembered, a bit more than the POSE_APPLY_TIMEOUT_MS worth of updates, so the coordinates in the 
+	// camera struct are one of them unless something else wrote them.
+	#define PUBLISHED_COORDS_HISTORY_SIZE	64
+
+	// What's kept between ticks about the camera, so a recorded session can be replayed from the middle.
+	struct CameraManipulatorState
+	{
+		Math::Vec3d cameraPosition;
+		bool cameraPositionIsValid;
+		GameCameraData originalCameraData;
+		float coordMultiplierFactor;
+		int32_t publishedCoordsHistory[PUBLISHED_COORDS_HISTORY_SIZE][3];
+		int publishedCoordsHistoryCount;
+		int publishedCoordsHistoryIndex;
+	};
+
+	void updateCameraDataInGameData(Camera& camera, float interpolationFactor);
+	void writeNewCameraValuesToGameData(Math::Vec3d newCoords, Math::Quat newLookQuaternion);
+	void publishNewCameraValues(Math::Vec3d newCoords, Math::Quat newLookQuaternion);
 	void restoreOriginalValuesAfterCameraDisable();
 	void cacheOriginalValuesBeforeCameraEnable();
-	DirectX::XMFLOAT3 getCurrentCameraCoords();
+	Math::Vec3d getCurrentCameraCoords();
 	void resetFoV();
 	void changeFoV(float amount);
 	float getCurrentFoV();
@@ -53,4 +70,8 @@ namespace IGCS::GameSpecific::CameraManipulator
 	bool gameIsPaused();
 	void stepGameInPause();
 	void setTimeStopValue(bool pauseGame);
+	bool readGameCameraData(int32_t coords[3], float& fov);
+	void writeGameCameraData(const int32_t coords[3], float fov);
+	void getState(CameraManipulatorState& state);
+	void setState(const CameraManipulatorState& state);
 }
@@ -0,0 +1,394 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// Define IGCS_MATH_SCALAR to use the scalar code on every platform, e.g. to test it.
+#if defined(IGCS_MATH_SCALAR)
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define IGCS_MATH_SSE
+	#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+	#define IGCS_MATH_NEON
+	#include <arm_neon.h>
+#endif
+
+// Header-only math for the camera: vectors, quaternions and matrices, and the integration of pitch/yaw/roll deltas into an
+// orientation quaternion. It has no dependencies on Windows or DirectXMath so it can be tested and benchmarked on any platform. Quaternions
+// are stored as x, y, z, w, which is the layout the games store them in, and are multiplied Hamilton style: a * b rotates by b, then by a.
+namespace IGCS::Math
+{
+	constexpr float PI = 3.141592654f;
+	constexpr float TWO_PI = 6.283185307f;
+	constexpr float HALF_PI = 1.570796327f;
+	constexpr float ONE_OVER_TWO_PI = 0.159154943f;
+
+	struct Vec3
+	{
+		float x, y, z;
+
+		float& operator[](int index) { return (&x)[index]; }
+		float operator[](int index) const { return (&x)[index]; }
+	};
+
+	// World positions are kept in doubles: a float can't hold both a position far from the origin and the tiny steps of slow movement.
+	struct Vec3d
+	{
+		double x, y, z;
+	};
+
+	struct alignas(16) Quat
+	{
+		float x, y, z, w;
+	};
+
+	// Row major, with the translation in the last row, like the matrices the games store.
+	struct alignas(16) Mat4
+	{
+		float m[4][4];
+	};
+
+
+	inline Vec3 add(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Vec3 subtract(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Vec3d add(const Vec3d& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Vec3 scale(const Vec3& v, float factor) { return { v.x * factor, v.y * factor, v.z * factor }; }
+	inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline Vec3 cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline Vec3 unitAxis(int axis)
+	{
+		Vec3 toReturn = { 0.0f, 0.0f, 0.0f };
+		toReturn[axis] = 1.0f;
+		return toReturn;
+	}
+
+
+	// Wraps angle into the range [-PI, PI] without loops. Rounds with a cast, as floor is a function call without SSE4.1.
+	inline float wrapAngle(float angle)
+	{
+		float quotient = angle * ONE_OVER_TWO_PI;
+		quotient = static_cast<float>(static_cast<int>(angle >= 0.0f ? quotient + 0.5f : quotient - 0.5f));
+		return angle - TWO_PI * quotient;
+	}
+
+
+	inline Quat identityQuat() { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+
+
+	// Creates the quaternion for a rotation of angle radians around the given unit axis (0 = x, 1 = y, 2 = z).
+	inline Quat axisRotation(int axis, float angle)
+	{
+		Quat toReturn = { 0.0f, 0.0f, 0.0f, std::cos(angle * 0.5f) };
+		(&toReturn.x)[axis] = std::sin(angle * 0.5f);
+		return toReturn;
+	}
+
+
+	// Returns a * b, which rotates by b first, then by a.
+	inline Quat multiply(const Quat& a, const Quat& b)
+	{
+		Quat toReturn;
+#if defined(IGCS_MATH_SSE)
+		// the four products are independent and only their signs differ per lane, which is flipped with an xor, so they're summed as a tree.
+		const __m128 signsX = _mm_castsi128_ps(_mm_setr_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+		const __m128 signsY = _mm_castsi128_ps(_mm_setr_epi32(0, 0, (int)0x80000000, (int)0x80000000));
+		const __m128 signsZ = _mm_castsi128_ps(_mm_setr_epi32((int)0x80000000, 0, 0, (int)0x80000000));
+		__m128 av = _mm_load_ps(&a.x);
+		__m128 bv = _mm_load_ps(&b.x);
+		__m128 termW = _mm_mul_ps(_mm_shuffle_ps(av, av, _MM_SHUFFLE(3, 3, 3, 3)), bv);
+		__m128 termX = _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(av, av, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(0, 1, 2, 3))), signsX);
+		__m128 termY = _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(av, av, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(1, 0, 3, 2))), signsY);
+		__m128 termZ = _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(av, av, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(2, 3, 0, 1))), signsZ);
+		_mm_store_ps(&toReturn.x, _mm_add_ps(_mm_add_ps(termW, termX), _mm_add_ps(termY, termZ)));
+#elif defined(IGCS_MATH_NEON)
+		static const float signsX[4] = { 1.0f, -1.0f, 1.0f, -1.0f };
+		static const float signsY[4] = { 1.0f, 1.0f, -1.0f, -1.0f };
+		static const float signsZ[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+		float32x4_t av = vld1q_f32(&a.x);
+		float32x4_t bv = vld1q_f32(&b.x);
+		float32x4_t bZwxy = vextq_f32(bv, bv, 2);
+		float32x4_t bWzyx = vrev64q_f32(bZwxy);
+		float32x4_t bYxwz = vrev64q_f32(bv);
+		float32x4_t result = vmulq_n_f32(bv, vgetq_lane_f32(av, 3));
+		result = vmlaq_f32(result, vmulq_n_f32(bWzyx, vgetq_lane_f32(av, 0)), vld1q_f32(signsX));
+		result = vmlaq_f32(result, vmulq_n_f32(bZwxy, vgetq_lane_f32(av, 1)), vld1q_f32(signsY));
+		result = vmlaq_f32(result, vmulq_n_f32(bYxwz, vgetq_lane_f32(av, 2)), vld1q_f32(signsZ));
+		vst1q_f32(&toReturn.x, result);
+#else
+		toReturn.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+		toReturn.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+		toReturn.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+		toReturn.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+#endif
+		return toReturn;
+	}
+
+
+	inline float lengthSquared(const Quat& q)
+	{
+		return q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+	}
+
+
+	// Brings q back to unit length. Integrating small rotations every frame only lets the length drift a little, which one Newton step on
+	// 1/sqrt corrects without a division or square root. Larger errors get a full normalization and a degenerate q becomes the identity.
+	inline Quat renormalize(const Quat& q)
+	{
+		float lengthSq = lengthSquared(q);
+		float factor;
+		if (std::fabs(1.0f - lengthSq) < 1e-3f)
+		{
+			factor = (3.0f - lengthSq) * 0.5f;
+		}
+		else
+		{
+			if (lengthSq < 1e-12f)
+			{
+				return identityQuat();
+			}
+			factor = 1.0f / std::sqrt(lengthSq);
+		}
+		return { q.x * factor, q.y * factor, q.z * factor, q.w * factor };
+	}
+
+
+	inline Vec3 lerp(const Vec3& from, const Vec3& to, float factor)
+	{
+		return add(from, scale(subtract(to, from), factor));
+	}
+
+
+	// Normalized linear interpolation between two unit quaternions, along the shortest arc. For the small rotations between two camera
+	// updates it's indistinguishable from a slerp and doesn't need any trigonometry.
+	inline Quat nlerp(const Quat& from, const Quat& to, float factor)
+	{
+		float cosAngle = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+		float toFactor = cosAngle < 0.0f ? -factor : factor;
+		float fromFactor = 1.0f - factor;
+		Quat toReturn = { from.x * fromFactor + to.x * toFactor, from.y * fromFactor + to.y * toFactor,
+						  from.z * fromFactor + to.z * toFactor, from.w * fromFactor + to.w * toFactor };
+		return renormalize(toReturn);
+	}
+
+
+	// Rotates v by the unit quaternion q.
+	inline Vec3 rotate(const Vec3& v, const Quat& q)
+	{
+		Vec3 u = { q.x, q.y, q.z };
+		Vec3 t = scale(cross(u, v), 2.0f);
+		return add(add(v, scale(t, q.w)), cross(u, t));
+	}
+
+
+	// Creates the rotation/translation matrix for a camera with orientation q at position.
+	inline Mat4 matrixFromQuatAndPosition(const Quat& q, const Vec3& position)
+	{
+		float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		Mat4 toReturn = { {
+			{ 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f },
+			{ 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f },
+			{ 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f },
+			{ position.x, position.y, position.z, 1.0f } } };
+		return toReturn;
+	}
+
+
+	inline Vec3 transformPoint(const Mat4& matrix, const Vec3& point)
+	{
+		return { point.x * matrix.m[0][0] + point.y * matrix.m[1][0] + point.z * matrix.m[2][0] + matrix.m[3][0],
+				 point.x * matrix.m[0][1] + point.y * matrix.m[1][1] + point.z * matrix.m[2][1] + matrix.m[3][1],
+				 point.x * matrix.m[0][2] + point.y * matrix.m[1][2] + point.z * matrix.m[2][2] + matrix.m[3][2] };
+	}
+
+
+	// Converts coordinates stored as int32s, which are multiples of factor, to world coordinates.
+	inline Vec3d packedToWorld(const int32_t packed[3], double factor)
+	{
+		Vec3d toReturn;
+#if defined(IGCS_MATH_SSE)
+		__m128d factors = _mm_set1_pd(factor);
+		__m128d xy = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(packed)));
+		_mm_storeu_pd(&toReturn.x, _mm_mul_pd(xy, factors));
+		_mm_store_sd(&toReturn.z, _mm_mul_sd(_mm_cvtsi32_sd(_mm_setzero_pd(), packed[2]), factors));
+#elif defined(IGCS_MATH_NEON)
+		float64x2_t xy = vcvtq_f64_s64(vmovl_s32(vld1_s32(packed)));
+		vst1q_f64(&toReturn.x, vmulq_n_f64(xy, factor));
+		toReturn.z = static_cast<double>(packed[2]) * factor;
+#else
+		toReturn.x = static_cast<double>(packed[0]) * factor;
+		toReturn.y = static_cast<double>(packed[1]) * factor;
+		toReturn.z = static_cast<double>(packed[2]) * factor;
+#endif
+		return toReturn;
+	}
+
+
+	// Converts world coordinates to int32s which are multiples of factor. Rounds to the nearest int32 (ties to even), where a cast would 
+	// truncate towards zero, and saturates at the int32 range.
+	inline void worldToPacked(const Vec3d& world, double factor, int32_t packed[3])
+	{
+		const double minPacked = -2147483648.0;
+		const double maxPacked = 2147483647.0;
+#if defined(IGCS_MATH_SSE)
+		__m128d factors = _mm_set1_pd(factor);
+		__m128d xy = _mm_div_pd(_mm_loadu_pd(&world.x), factors);
+		__m128d z = _mm_div_sd(_mm_load_sd(&world.z), factors);
+		xy = _mm_min_pd(_mm_max_pd(xy, _mm_set1_pd(minPacked)), _mm_set1_pd(maxPacked));
+		z = _mm_min_sd(_mm_max_sd(z, _mm_set_sd(minPacked)), _mm_set_sd(maxPacked));
+		// both convert with the rounding mode in MXCSR, which is round to nearest unless someone changed it
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(packed), _mm_cvtpd_epi32(xy));
+		packed[2] = _mm_cvtsd_si32(z);
+#elif defined(IGCS_MATH_NEON)
+		float64x2_t xy = vdivq_f64(vld1q_f64(&world.x), vdupq_n_f64(factor));
+		vst1_s32(packed, vqmovn_s64(vcvtnq_s64_f64(xy)));
+		double z = world.z / factor;
+		z = z > minPacked ? z : minPacked;
+		z = z < maxPacked ? z : maxPacked;
+		packed[2] = static_cast<int32_t>(std::nearbyint(z));
+#else
+		for (int i = 0; i < 3; i++)
+		{
+			double value = (&world.x)[i] / factor;
+			// written like this, and not with min/max, so a NaN ends up as minPacked, like it does with SSE
+			value = value > minPacked ? value : minPacked;
+			value = value < maxPacked ? value : maxPacked;
+			packed[i] = static_cast<int32_t>(std::nearbyint(value));
+		}
+#endif
+	}
+
+
+	// The axes of a game's camera space, as indices 0 (x), 1 (y) and 2 (z). Pitch rotates around the right axis, yaw around the up axis and
+	// roll around the forward axis.
+	template<int RightAxis, int ForwardAxis, int UpAxis>
+	struct AxisConvention
+	{
+		static_assert(RightAxis != ForwardAxis && RightAxis != UpAxis && ForwardAxis != UpAxis, "Each axis has to be used once");
+		static constexpr int right = RightAxis;
+		static constexpr int forward = ForwardAxis;
+		static constexpr int up = UpAxis;
+	};
+
+
+	// The orientation of a camera as a quaternion, changed by integrating pitch/yaw/roll deltas. Yaw rotates around the world's up axis so the
+	// horizon stays level, pitch and roll rotate around the camera's own axes. Without roll this gives exactly the same orientation as 
+	// yaw * pitch * roll built from the summed angles, with roll the camera pitches towards the top of the screen instead of the world's up.
+	template<typename Axes>
+	class CameraOrientation
+	{
+	public:
+		CameraOrientation() : _orientation(identityQuat()), _pitch(0.0f), _yaw(0.0f), _roll(0.0f), _eulerIsValid(true)
+		{
+		}
+
+		// The angles are kept, so toEuler doesn't have to decompose an orientation built from them. A pitch past straight up or down
+		// decomposes into different angles, so those aren't kept.
+		void setFromEuler(float pitch, float yaw, float roll)
+		{
+			_orientation = renormalize(multiply(axisRotation(Axes::up, yaw), multiply(axisRotation(Axes::right, pitch), axisRotation(Axes::forward, roll))));
+			_pitch = wrapAngle(pitch);
+			_yaw = wrapAngle(yaw);
+			_roll = wrapAngle(roll);
+			_eulerIsValid = std::fabs(_pitch) <= HALF_PI;
+		}
+
+		void integrate(float pitchDelta, float yawDelta, float rollDelta)
+		{
+			Quat toReturn = _orientation;
+			if (yawDelta != 0.0f)
+			{
+				toReturn = multiply(axisRotation(Axes::up, yawDelta), toReturn);
+			}
+			if (pitchDelta != 0.0f)
+			{
+				toReturn = multiply(toReturn, axisRotation(Axes::right, pitchDelta));
+			}
+			if (rollDelta != 0.0f)
+			{
+				toReturn = multiply(toReturn, axisRotation(Axes::forward, rollDelta));
+			}
+			_orientation = renormalize(toReturn);
+			_eulerIsValid = false;
+		}
+
+		// Returns the angles setFromEuler would need to build the orientation. Angles are in [-PI, PI], pitch is in [-PI/2, PI/2].
+		void toEuler(float& pitch, float& yaw, float& roll) const
+		{
+			if (!_eulerIsValid)
+			{
+				decompose(_pitch, _yaw, _roll);
+				_eulerIsValid = true;
+			}
+			pitch = _pitch;
+			yaw = _yaw;
+			roll = _roll;
+		}
+
+		Quat orientation() const { return _orientation; }
+		void orientation(const Quat& newValue) { _orientation = renormalize(newValue); _eulerIsValid = false; }
+		// Sets an orientation obtained with orientation() as-is, so a restored camera continues bit for bit where it was.
+		void restoreOrientation(const Quat& value) { _orientation = value; _eulerIsValid = false; }
+
+	private:
+		// Everything is calculated with atan2 from the rotated axes, which stays accurate close to looking straight up or down.
+		void decompose(float& pitch, float& yaw, float& roll) const
+		{
+			Vec3 right = unitAxis(Axes::right);
+			Vec3 forward = unitAxis(Axes::forward);
+			Vec3 up = unitAxis(Axes::up);
+			Vec3 yawDirection = cross(up, forward);				// the direction yaw turns forward to
+			float handedness = dot(cross(right, forward), up);	// -1 for a left handed convention, where pitch turns forward down.
+			Vec3 lookDirection = rotate(forward, _orientation);
+			Vec3 upDirection = rotate(up, _orientation);
+			Vec3 rightDirection = rotate(right, _orientation);
+			float lookForward = dot(lookDirection, forward);
+			float lookSideways = dot(lookDirection, yawDirection);
+			float horizontalLength = std::sqrt(lookForward * lookForward + lookSideways * lookSideways);
+			pitch = std::atan2(handedness * dot(lookDirection, up), horizontalLength);
+			if (horizontalLength < 1e-5f)
+			{
+				// looking straight up or down: yaw and roll rotate around the same axis. Attribute it all to yaw.
+				yaw = std::atan2(dot(rightDirection, cross(up, right)), dot(rightDirection, right));
+				roll = 0.0f;
+				return;
+			}
+			yaw = std::atan2(lookSideways, lookForward);
+			roll = std::atan2(-handedness * dot(rightDirection, up), dot(upDirection, up));
+		}
+
+		Quat _orientation;
+		// the angles of _orientation, calculated on first use after the orientation was changed other than with setFromEuler
+		mutable float _pitch;
+		mutable float _yaw;
+		mutable float _roll;
+		mutable bool _eulerIsValid;
+	};
+}
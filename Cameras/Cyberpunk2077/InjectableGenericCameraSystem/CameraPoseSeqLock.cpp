@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "CameraPoseSeqLock.h"
+
+namespace IGCS
+{
+	CameraPoseSeqLock::CameraPoseSeqLock() : _sequence(0), _coords{ 0, 0, 0 }, _quaternion{ 0.0f, 0.0f, 0.0f, 1.0f }, _hasPose(0), _appliedSequence(0)
+	{
+	}
+
+
+	CameraPoseSeqLock::~CameraPoseSeqLock()
+	{
+	}
+
+
+	// Only to be called by the camera thread.
+	void CameraPoseSeqLock::publish(const CameraPose& pose)
+	{
+		uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+		_sequence.store(sequence + 1, std::memory_order_relaxed);
+		// the odd sequence number has to be visible before any of the pose is
+		std::atomic_thread_fence(std::memory_order_release);
+		for (int i = 0; i < 3; i++)
+		{
+			_coords[i].store(pose.coords[i], std::memory_order_relaxed);
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			_quaternion[i].store(pose.quaternion[i], std::memory_order_relaxed);
+		}
+		_hasPose.store(1, std::memory_order_relaxed);
+		_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+
+	// Only to be called by the camera thread. Readers get no pose till the next publish.
+	void CameraPoseSeqLock::clear()
+	{
+		uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+		_sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		_hasPose.store(0, std::memory_order_relaxed);
+		_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+
+	// Copies the latest published pose into pose. Returns false if there's no pose, in which case pose is undefined. This is what the asm
+	// in activeCamWrite1Interceptor does, on x64 plain loads are already ordered like this.
+	bool CameraPoseSeqLock::read(CameraPose& pose) const
+	{
+		while (true)
+		{
+			uint32_t sequence = _sequence.load(std::memory_order_acquire);
+			if (sequence & 1)
+			{
+				// a pose is being written
+				continue;
+			}
+			for (int i = 0; i < 3; i++)
+			{
+				pose.coords[i] = _coords[i].load(std::memory_order_relaxed);
+			}
+			for (int i = 0; i < 4; i++)
+			{
+				pose.quaternion[i] = _quaternion[i].load(std::memory_order_relaxed);
+			}
+			bool hasPose = _hasPose.load(std::memory_order_relaxed) != 0;
+			// the pose has to be read before the sequence number is read again
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (_sequence.load(std::memory_order_relaxed) == sequence)
+			{
+				return hasPose;
+			}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace IGCS
+{
+	// A camera pose in the format the game stores it: the coordinates as packed int32s and the orientation as x, y, z, w.
+	struct CameraPose
+	{
+		int32_t coords[3];
+		float quaternion[4];
+	};
+
+
+	// Hands the camera pose from the camera thread to the game thread. The camera thread publishes complete poses and the game thread
+	// copies the latest one in activeCamWrite1Interceptor, at the point the game writes its own camera, so the game never renders a pose
+	// which is half old and half new. It's a seqlock: the sequence number is odd while a pose is written and a reader retries if it was
+	// odd or has changed after the pose was copied. There's one writer, the camera thread, and readers never block it. 
+	// Interceptor.asm reads the fields directly, so their offsets, which are checked below, can't change.
+	class CameraPoseSeqLock
+	{
+	public:
+		CameraPoseSeqLock();
+		~CameraPoseSeqLock();
+
+		void publish(const CameraPose& pose);
+		void clear();
+		bool read(CameraPose& pose) const;
+		uint32_t appliedSequence() const { return _appliedSequence.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<uint32_t> _sequence;
+		std::atomic<int32_t> _coords[3];
+		std::atomic<float> _quaternion[4];
+		std::atomic<uint32_t> _hasPose;				// 0 after clear(), so the game keeps its own pose
+		std::atomic<uint32_t> _appliedSequence;		// written by the interceptor: the sequence number of the pose it copied last
+
+		static void checkLayout()
+		{
+			static_assert(offsetof(CameraPoseSeqLock, _sequence) == 0, "Interceptor.asm expects the sequence number at offset 0");
+			static_assert(offsetof(CameraPoseSeqLock, _coords) == 4, "Interceptor.asm expects the coords at offset 4");
+			static_assert(offsetof(CameraPoseSeqLock, _quaternion) == 16, "Interceptor.asm expects the quaternion at offset 16");
+			static_assert(offsetof(CameraPoseSeqLock, _hasPose) == 32, "Interceptor.asm expects hasPose at offset 32");
+			static_assert(offsetof(CameraPoseSeqLock, _appliedSequence) == 36, "Interceptor.asm expects appliedSequence at offset 36");
+		}
+	};
+}
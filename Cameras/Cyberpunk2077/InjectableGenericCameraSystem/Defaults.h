@@ -29,13 +29,50 @@
 
 #include "stdafx.h"
 #include "Gamepad.h"
+#include "SystemDefaults.h"
+
+#ifndef _WIN32
+// The virtual key codes and the wheel delta as Windows.h defines them, for the platforms without it.
+#define VK_NEXT			0x22
+#define VK_END			0x23
+#define VK_HOME			0x24
+#define VK_LEFT			0x25
+#define VK_UP			0x26
+#define VK_RIGHT		0x27
+#define VK_DOWN			0x28
+#define VK_INSERT		0x2D
+#define VK_DELETE		0x2E
+#define VK_NUMPAD0		0x60
+#define VK_NUMPAD1		0x61
+#define VK_NUMPAD2		0x62
+#define VK_NUMPAD3		0x63
+#define VK_NUMPAD4		0x64
+#define VK_NUMPAD5		0x65
+#define VK_NUMPAD6		0x66
+#define VK_NUMPAD7		0x67
+#define VK_NUMPAD8		0x68
+#define VK_NUMPAD9		0x69
+#define VK_MULTIPLY		0x6A
+#define VK_ADD			0x6B
+#define VK_SUBTRACT		0x6D
+#define VK_DECIMAL		0x6E
+#define VK_OEM_PLUS		0xBB
+#define VK_OEM_MINUS	0xBD
+#define WHEEL_DELTA		120
+#endif
 
 namespace IGCS
 {
-	// System defaults
-	#define FRAME_SLEEP								8		// in milliseconds
-	#define IGCS_SUPPORT_RAWKEYBOARDINPUT			true	// if set to false, raw keyboard input is ignored.
-	#define IGCS_MAX_MESSAGE_SIZE					4*1024	// in bytes
+	// Gamepad defaults
+	#define GAMEPAD_POLL_INTERVAL_MS				4		// how often a connected gamepad is polled, on its own thread
+	#define GAMEPAD_MIN_RECONNECT_INTERVAL_MS		100		// a disconnected gamepad is polled after this interval, doubling every time it's still not there
+	#define GAMEPAD_MAX_RECONNECT_INTERVAL_MS		2000	// ... up to this interval
+	#define GAMEPAD_LSTICK_DEADZONE					(XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE / 32767.0f)		// radial, as a fraction of the full range
+	#define GAMEPAD_RSTICK_DEADZONE					(XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE / 32767.0f)
+	#define GAMEPAD_STICK_OUTER_DEADZONE			0.98f	// beyond this fraction of the full range a stick counts as fully pushed
+	#define GAMEPAD_STICK_RESPONSE_EXPONENT			1.0f	// 1 is linear, higher values give finer control near the center
+	#define GAMEPAD_TRIGGER_DEADZONE				(XINPUT_GAMEPAD_TRIGGER_THRESHOLD / 255.0f)
+	#define GAMEPAD_TRIGGER_RESPONSE_EXPONENT		1.0f
 
 	// Keyboard system control
 	#define IGCS_KEY_CAMERA_ENABLE					VK_INSERT
@@ -72,49 +109,4 @@ namespace IGCS
 	#define IGCS_BUTTON_SLOWER						Gamepad::button_t::X
 
 	static const uint8_t jmpFarInstructionBytes[6] = { 0xff, 0x25, 0, 0, 0, 0 };	// instruction bytes for jmp qword ptr [0000]
-
-	#define DEVICE_ID_KEYBOARD_MOUSE			0
-	#define DEVICE_ID_GAMEPAD					1
-	#define DEVICE_ID_ALL						2
-
-	#define IGCS_PIPENAME_DLL_TO_CLIENT				"\\\\.\\pipe\\IgcsDllToClient"
-	#define IGCS_PIPENAME_CLIENT_TO_DLL				"\\\\.\\pipe\\IgcsClientToDll"
-
-
-
-	enum class SettingType : uint8_t
-	{
-		FastMovementMultiplier = 0,
-		SlowMovementMultiplier = 1,
-		UpMovementMultiplier = 2,
-		MovementSpeed = 3,
-		CameraControlDevice = 4,
-		RotationSpeed = 5,
-		InvertYLookDirection = 6,
-		FoVZoomSpeed = 7,
-		TimeOfDay = 8,
-		Wetness_OverrideParameters = 9,
-		Wetness_StreetWetnessFactor = 10,
-		Wetness_PuddleSize = 11,
-		
-		// add more here
-	};
-
-	
-	enum class MessageType : uint8_t
-	{
-		Setting = 1,
-		KeyBinding = 2,
-		Notification = 3,
-		NormalTextMessage = 4,
-		ErrorTextMessage = 5,
-		DebugTextMessage= 6,
-		Action = 7,
-	};
-
-	enum class ActionMessageType : uint8_t
-	{
-		RehookXInput = 1,
-		ResizeViewport = 2,
-	};
-}
\ No newline at end of file
+}
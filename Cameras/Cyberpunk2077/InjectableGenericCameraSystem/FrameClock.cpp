@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "FrameClock.h"
+#include <algorithm>
+#include <chrono>
+
+namespace IGCS
+{
+	static int64_t microsecondsFromRate(float ratePerSecond)
+	{
+		return ratePerSecond > 0.0f ? (std::max)(static_cast<int64_t>(1000000.0f / ratePerSecond + 0.5f), (int64_t)1) : 0;
+	}
+
+
+	int64_t SteadyTimeSource::nowInMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+
+	FrameClock::FrameClock(TimeSource& timeSource) : _timeSource(timeSource), _lastTickTime(0), _tickInterval(8000), _stepLength(0), _accumulatedTime(0),
+													 _maxDelta(100000)
+	{
+		_lastTickTime = _timeSource.nowInMicroseconds();
+	}
+
+
+	FrameClock::~FrameClock()
+	{
+	}
+
+
+	void FrameClock::reset()
+	{
+		_lastTickTime = _timeSource.nowInMicroseconds();
+		_accumulatedTime = 0;
+	}
+
+
+	FrameTime FrameClock::tick()
+	{
+		int64_t now = _timeSource.nowInMicroseconds();
+		// a stall, e.g. a breakpoint or a loading screen, shouldn't make the camera jump. 
+		int64_t delta = (std::min)((std::max)(now - _lastTickTime, (int64_t)0), _maxDelta);
+		_lastTickTime = now;
+		FrameTime toReturn;
+		toReturn.deltaSeconds = static_cast<float>(delta) / 1000000.0f;
+		if (_stepLength <= 0)
+		{
+			toReturn.numberOfSteps = 1;
+			toReturn.stepSeconds = toReturn.deltaSeconds;
+			toReturn.interpolationFactor = 1.0f;
+			return toReturn;
+		}
+		_accumulatedTime += delta;
+		toReturn.numberOfSteps = static_cast<int>(_accumulatedTime / _stepLength);
+		_accumulatedTime -= toReturn.numberOfSteps * _stepLength;
+		toReturn.stepSeconds = static_cast<float>(_stepLength) / 1000000.0f;
+		toReturn.interpolationFactor = static_cast<float>(_accumulatedTime) / static_cast<float>(_stepLength);
+		return toReturn;
+	}
+
+
+	// Lets the next tick start counting from now, e.g. after the loop deliberately slept for a while.
+	void FrameClock::discardElapsedTime()
+	{
+		_lastTickTime = _timeSource.nowInMicroseconds();
+	}
+
+
+	int64_t FrameClock::microsecondsTillNextTick()
+	{
+		return (std::max)(_lastTickTime + _tickInterval - _timeSource.nowInMicroseconds(), (int64_t)0);
+	}
+
+
+	void FrameClock::setTickRate(float ticksPerSecond)
+	{
+		int64_t interval = microsecondsFromRate(ticksPerSecond);
+		if (interval > 0)
+		{
+			_tickInterval = interval;
+		}
+	}
+
+
+	// 0 or less switches to variable step mode.
+	void FrameClock::setFixedStepRate(float stepsPerSecond)
+	{
+		_stepLength = microsecondsFromRate(stepsPerSecond);
+		_accumulatedTime = 0;
+	}
+
+
+	void FrameClock::setMaxDeltaSeconds(float maxDeltaSeconds)
+	{
+		_maxDelta = static_cast<int64_t>(maxDeltaSeconds * 1000000.0f);
+	}
+}
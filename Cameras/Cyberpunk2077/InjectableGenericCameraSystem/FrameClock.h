@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+
+namespace IGCS
+{
+	// Monotonic time in microseconds, counted from an arbitrary point. Abstract so a FrameClock can be driven by a simulated clock.
+	class TimeSource
+	{
+	public:
+		virtual ~TimeSource() {}
+		virtual int64_t nowInMicroseconds() = 0;
+	};
+
+
+	// The high resolution steady clock. On Windows this is QueryPerformanceCounter.
+	class SteadyTimeSource : public TimeSource
+	{
+	public:
+		int64_t nowInMicroseconds() override;
+	};
+
+
+	// What a tick of the camera has to simulate. In variable step mode that's one step of the elapsed time, with the interpolation factor
+	// at 1.0. In fixed step mode it's zero or more steps of equal length, and the state to write to the game lies interpolationFactor of the
+	// way between the state of the second to last step and the last step.
+	struct FrameTime
+	{
+		float deltaSeconds;				// time elapsed since the previous tick
+		int numberOfSteps;
+		float stepSeconds;				// time simulated by each step
+		float interpolationFactor;
+	};
+
+
+	// Measures the time between the ticks of the camera's update loop, so movement depends on the time that elapsed instead of on how
+	// long Sleep() took. It also tells the loop how long to wait for the next tick, at the configured tick rate. Time is kept in integer
+	// microseconds so fixed steps are deterministic. Not thread safe: the camera's update loop owns it.
+	class FrameClock
+	{
+	public:
+		FrameClock(TimeSource& timeSource);
+		~FrameClock();
+
+		void reset();
+		FrameTime tick();
+		void discardElapsedTime();
+		int64_t microsecondsTillNextTick();
+		void setTickRate(float ticksPerSecond);
+		void setFixedStepRate(float stepsPerSecond);
+		void setMaxDeltaSeconds(float maxDeltaSeconds);
+
+	private:
+		TimeSource& _timeSource;
+		int64_t _lastTickTime;
+		int64_t _tickInterval;					// in microseconds
+		int64_t _stepLength;					// in microseconds. 0 means variable step mode
+		int64_t _accumulatedTime;				// time not simulated yet in fixed step mode, in microseconds
+		int64_t _maxDelta;						// in microseconds
+	};
+}
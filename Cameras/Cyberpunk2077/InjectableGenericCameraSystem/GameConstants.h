@@ -26,6 +26,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include "CameraMath.h"
 
 namespace IGCS::GameSpecific
 {
@@ -35,8 +36,8 @@ namespace IGCS::GameSpecific
 	#define CAMERA_CREDITS								"Otis_Inf / Jim2Point0"
 	#define GAME_WINDOW_TITLE							"Cyberpunk 2077"
 	#define INITIAL_PITCH_RADIANS						0.0f	// around X axis	(right)
-	#define INITIAL_YAW_RADIANS							0.0f	// around Y axis	(out of the screen)
-	#define INITIAL_ROLL_RADIANS						0.0f	// around Z axis	(up)
+	#define INITIAL_YAW_RADIANS							0.0f	// around Z axis	(up)
+	#define INITIAL_ROLL_RADIANS						0.0f	// around Y axis	(into the screen)
 	#define CONTROLLER_Y_INVERT							false
 	// These will be overwritten by settings sent by the client. These defines are for initial usage. 
 	#define FASTER_MULTIPLIER							5.0f
@@ -50,6 +51,9 @@ namespace IGCS::GameSpecific
 	#define DEFAULT_TOD_CHANGE							0.01f
 	// End Mandatory constants
 
+	// Camera space: X right, Y into the screen, Z up.
+	typedef Math::AxisConvention<0, 1, 2> CameraAxes;
+
 	// AOB Keys for interceptor's AOB scanner
 	#define PMSTRUCT_ADDRESS_INTERCEPT_KEY				"AOB_PMSTRUCT_ADDRESS_INTERCEPT"
 	#define ACTIVECAM_ADDRESS_INTERCEPT_KEY				"AOB_ACTIVECAM_ADDRESS_INTERCEPT"
@@ -28,50 +28,565 @@
 #include "stdafx.h"
 #include "GameImageHooker.h"
 #include "Defaults.h"
+#include "InstructionDecoder.h"
 #include "MessageHandler.h"
+#include "Utils.h"
+#include <algorithm>
+#include <TlHelp32.h>
 
 namespace IGCS::GameImageHooker
 {
-	// Sets a jmp qword ptr [address] statement at hostImageAddress + startOffset for x64 and a jmp <relative address> for x86
-	void setHook(LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction)
+	// Executable memory for stubs emitted at runtime. Blocks are allocated close to the game's code so rip relative operands of relocated
+	// instructions can still be reached from the stubs.
+	struct StubMemoryBlock
 	{
-		if (hostImageAddress == nullptr)
+		LPBYTE start;
+		size_t size;
+		size_t used;
+		vector<StubAllocation> freeStubs;		// released stubs below used, reused first
+	};
+
+	// jmp qword ptr [0000] followed by the 8 byte address
+	static const int HOOK_INSTRUCTION_LENGTH = sizeof(jmpFarInstructionBytes) + sizeof(__int64);
+	// Number of bytes to decode at the start of a hook, enough for the instructions overwritten by the jmp.
+	static const int HOOK_DECODE_WINDOW = HOOK_INSTRUCTION_LENGTH + InstructionDecoder::MAX_INSTRUCTION_LENGTH * 2;
+	static const size_t STUB_MEMORY_BLOCK_SIZE = 0x10000;
+	static const int64_t STUB_MEMORY_MAX_DISTANCE = 0x70000000;		// well within the 2GB a rip relative displacement can reach
+	static vector<StubMemoryBlock> _stubMemoryBlocks;
+	// All transactions committed to the game's code, so they can be rolled back before the dll is unloaded.
+	static HookJournal _journal;
+
+
+	static bool isCloseTo(LPBYTE address, LPBYTE nearAddress)
+	{
+		int64_t distance = address - nearAddress;
+		return distance > -STUB_MEMORY_MAX_DISTANCE && distance < STUB_MEMORY_MAX_DISTANCE;
+	}
+
+
+	// Allocates a new stub memory block in a free region close to nearAddress, first searching downwards, then upwards.
+	static LPBYTE allocateStubMemoryBlock(LPBYTE nearAddress)
+	{
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		uintptr_t granularity = systemInfo.dwAllocationGranularity;
+		uintptr_t start = reinterpret_cast<uintptr_t>(nearAddress) & ~(granularity - 1);
+		uintptr_t lowest = (std::max)(reinterpret_cast<uintptr_t>(systemInfo.lpMinimumApplicationAddress), start > static_cast<uintptr_t>(STUB_MEMORY_MAX_DISTANCE) ? start - STUB_MEMORY_MAX_DISTANCE : 0);
+		uintptr_t highest = (std::min)(reinterpret_cast<uintptr_t>(systemInfo.lpMaximumApplicationAddress), start + STUB_MEMORY_MAX_DISTANCE);
+		for (int direction = -1; direction <= 1; direction += 2)
 		{
-			return;
+			for (uintptr_t candidate = start + direction * granularity; candidate >= lowest && candidate + STUB_MEMORY_BLOCK_SIZE <= highest; candidate += direction * granularity)
+			{
+				MEMORY_BASIC_INFORMATION memoryInfo;
+				if (0 == VirtualQuery((LPCVOID)candidate, &memoryInfo, sizeof(memoryInfo)))
+				{
+					break;
+				}
+				if (memoryInfo.State != MEM_FREE)
+				{
+					continue;
+				}
+				LPBYTE block = (LPBYTE)VirtualAlloc((LPVOID)candidate, STUB_MEMORY_BLOCK_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+				if (nullptr != block)
+				{
+					return block;
+				}
+			}
 		}
-		LPBYTE startOfHookAddress = hostImageAddress + startOffset;
-		// interception continue isn't always specified, i.e. in the case of when the intercepted block by itself issues a ret.
-		if (nullptr != interceptionContinue)
+		return nullptr;
+	}
+
+
+	// Takes length bytes of executable memory close to nearAddress for a stub of the transaction, or returns nullptr if there's none
+	// available. The memory is owned by the transaction, so it's released again if the transaction isn't committed or is rolled back.
+	static LPBYTE allocateStubMemory(HookTransaction& transaction, LPBYTE nearAddress, size_t length)
+	{
+		// keep stubs 16 byte aligned
+		length = (length + 15) & ~(size_t)15;
+		if (length > STUB_MEMORY_BLOCK_SIZE)
 		{
-			*interceptionContinue = startOfHookAddress + continueOffset;
+			return nullptr;
+		}
+		LPBYTE toReturn = nullptr;
+		for (auto& block : _stubMemoryBlocks)
+		{
+			if (!isCloseTo(block.start, nearAddress) || !isCloseTo(block.start + block.size, nearAddress))
+			{
+				continue;
+			}
+			auto freeStub = find_if(block.freeStubs.begin(), block.freeStubs.end(), [&](StubAllocation& stub) { return stub.length >= length; });
+			if (freeStub != block.freeStubs.end())
+			{
+				toReturn = freeStub->address;
+				freeStub->address += length;
+				freeStub->length -= length;
+				if (freeStub->length == 0)
+				{
+					block.freeStubs.erase(freeStub);
+				}
+				break;
+			}
+			if (block.size - block.used >= length)
+			{
+				toReturn = block.start + block.used;
+				block.used += length;
+				break;
+			}
+		}
+		if (nullptr == toReturn)
+		{
+			toReturn = allocateStubMemoryBlock(nearAddress);
+			if (nullptr == toReturn)
+			{
+				return nullptr;
+			}
+			_stubMemoryBlocks.push_back({ toReturn, STUB_MEMORY_BLOCK_SIZE, length, {} });
+		}
+		transaction.addStub(toReturn, length);
+		return toReturn;
+	}
+
+
+	// Gives the memory of the stubs of the transaction back, for stubs of transactions which follow. Only call this if no thread can end up
+	// in them anymore: the transaction wasn't written or it has been rolled back.
+	static void releaseStubs(HookTransaction& transaction)
+	{
+		for (auto& stub : transaction.stubs())
+		{
+			for (auto& block : _stubMemoryBlocks)
+			{
+				if (stub.address < block.start || stub.address >= block.start + block.size)
+				{
+					continue;
+				}
+				if (stub.address + stub.length == block.start + block.used)
+				{
+					block.used -= stub.length;
+				}
+				else
+				{
+					block.freeStubs.push_back(stub);
+				}
+				break;
+			}
 		}
+		transaction.stubs().clear();
+	}
+
+
+	// Creates a jmp qword ptr [address] statement for x64 and a jmp <relative address> for x86 in instruction, which has to be at least 14 bytes.
+	// Returns the length of the statement.
+	static int createJumpInstruction(LPBYTE startOfHookAddress, void* asmFunction, uint8_t* instruction)
+	{
 #ifdef _WIN64
 		// x64
-		uint8_t instruction[14];	// 6 bytes of the jmp qword ptr [0] and 8 bytes for the real address which is stored right after the 6 bytes of jmp qword ptr [0] bytes 
-								// write bytes of jmp qword ptr [address], which is jmp qword ptr 0 offset.
+		// 6 bytes of the jmp qword ptr [0] and 8 bytes for the real address which is stored right after the 6 bytes of jmp qword ptr [0] bytes 
+		// write bytes of jmp qword ptr [address], which is jmp qword ptr 0 offset.
 		memcpy(instruction, jmpFarInstructionBytes, sizeof(jmpFarInstructionBytes));
 		// now write the address. Do this with a recast of the pointer to an __int64 pointer to avoid endianmess.
 		__int64* targetAddressLocationInInstruction = (__int64*)(&instruction[6]);
 		__int64 targetAddress = (__int64)asmFunction;
+		targetAddressLocationInInstruction[0] = targetAddress;	// write bytes this way to avoid endianess
+		return 14;
 #else	
 		// x86
 		// we will write a jmp <relative address> as x86 doesn't have a jmp <absolute address>. 
 		// calculate this relative address by using Destination - Current, which is: &asmFunction - (<base> + startOffset + 5), as jmp <relative> is 5 bytes.
-		uint8_t instruction[5];
 		instruction[0] = 0xE9;	// JMP relative
 		DWORD targetAddress = (DWORD)asmFunction - (((DWORD)startOfHookAddress) + 5);
 		DWORD* targetAddressLocationInInstruction = (DWORD*)&instruction[1];
-#endif
 		targetAddressLocationInInstruction[0] = targetAddress;	// write bytes this way to avoid endianess
-		SIZE_T noBytesWritten;
-		BOOL result = WriteProcessMemory(OpenProcess(PROCESS_VM_OPERATION | PROCESS_VM_WRITE, FALSE, GetCurrentProcessId()), startOfHookAddress, instruction, sizeof(instruction), &noBytesWritten);
-		if (result)
+		return 5;
+#endif
+	}
+
+
+	// Fails the transaction if continueOffset isn't the end of an instruction at or past the end of the jmp the hook writes: the game's code
+	// would continue in the middle of an instruction and crash.
+	static bool checkContinueOffset(HookTransaction& transaction, AOBBlock* hookData, LPBYTE startOfHookAddress, DWORD continueOffset)
+	{
+		const size_t available = continueOffset + InstructionDecoder::MAX_INSTRUCTION_LENGTH;
+		if (continueOffset >= static_cast<DWORD>(HOOK_INSTRUCTION_LENGTH) && InstructionDecoder::isInstructionBoundary(startOfHookAddress, available, continueOffset))
+		{
+			return true;
+		}
+		transaction.fail(Utils::formatString("Continue offset 0x%x of block '%s' isn't at the end of an instruction overwritten by the hook. Expected offset: 0x%x",
+											 continueOffset, hookData->blockName().c_str(), InstructionDecoder::coveringLength(startOfHookAddress, HOOK_DECODE_WINDOW, HOOK_INSTRUCTION_LENGTH)));
+		return false;
+	}
+
+
+	// Returns the ids of all threads of this process except the current one. Collected before any thread is suspended: a suspended thread
+	// might hold the heap lock, so nothing may be allocated while threads are suspended.
+	static vector<DWORD> collectOtherThreadIds()
+	{
+		vector<DWORD> toReturn;
+		HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+		if (INVALID_HANDLE_VALUE == snapshot)
+		{
+			return toReturn;
+		}
+		DWORD processId = GetCurrentProcessId();
+		DWORD currentThreadId = GetCurrentThreadId();
+		THREADENTRY32 threadEntry;
+		threadEntry.dwSize = sizeof(threadEntry);
+		for (BOOL found = Thread32First(snapshot, &threadEntry); found; found = Thread32Next(snapshot, &threadEntry))
+		{
+			if (threadEntry.th32OwnerProcessID == processId && threadEntry.th32ThreadID != currentThreadId)
+			{
+				toReturn.push_back(threadEntry.th32ThreadID);
+			}
+		}
+		CloseHandle(snapshot);
+		return toReturn;
+	}
+
+
+	static void resumeThreads(vector<HANDLE>& suspendedThreads)
+	{
+		for (HANDLE thread : suspendedThreads)
+		{
+			ResumeThread(thread);
+			CloseHandle(thread);
+		}
+		suspendedThreads.clear();
+	}
+
+
+	// Suspends the threads specified. suspendedThreads has to have room for all of them, so it doesn't allocate. Returns false if a suspended
+	// thread is about to execute an instruction which is partly overwritten by the transaction or, when the patches are restored, is still
+	// inside a stub of the transaction, in which case the threads are resumed again.
+	static bool suspendThreads(const vector<DWORD>& threadIds, HookTransaction& transaction, bool applyPatches, vector<HANDLE>& suspendedThreads)
+	{
+		for (DWORD threadId : threadIds)
+		{
+			HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE, threadId);
+			if (nullptr == thread)
+			{
+				// the thread has ended since the snapshot.
+				continue;
+			}
+			if (SuspendThread(thread) == (DWORD)-1)
+			{
+				CloseHandle(thread);
+				continue;
+			}
+			suspendedThreads.push_back(thread);
+			CONTEXT context;
+			context.ContextFlags = CONTEXT_CONTROL;
+			if (!GetThreadContext(thread, &context))
+			{
+				continue;
+			}
+#ifdef _WIN64
+			const uint8_t* instructionPointer = reinterpret_cast<const uint8_t*>(context.Rip);
+#else
+			const uint8_t* instructionPointer = reinterpret_cast<const uint8_t*>(context.Eip);
+#endif
+			if (transaction.isInsidePatch(instructionPointer) || (!applyPatches && transaction.isInsideStub(instructionPointer)))
+			{
+				resumeThreads(suspendedThreads);
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// Suspends all other threads of the process, so none of them executes code which is being patched, makes the pages the transaction writes
+	// to writable, one VirtualProtect call per page, then applies or restores the patches, puts the original protection back, flushes the
+	// instruction cache once for the whole range and resumes the threads. If a thread is halfway through the code to patch, the threads are
+	// resumed and it's tried again a bit later. Nothing is allocated or logged while the threads are suspended.
+	static bool writeTransaction(HookTransaction& transaction, bool applyPatches)
+	{
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		vector<uintptr_t> pages = transaction.pagesToUnprotect(systemInfo.dwPageSize);
+		vector<DWORD> oldProtections;
+		oldProtections.reserve(pages.size());
+		vector<DWORD> threadIds = collectOtherThreadIds();
+		vector<HANDLE> suspendedThreads;
+		suspendedThreads.reserve(threadIds.size());
+		bool threadsSuspended = false;
+		for (int attempt = 0; attempt < HOOK_WRITE_MAX_ATTEMPTS && !threadsSuspended; attempt++)
+		{
+			if (attempt > 0)
+			{
+				Sleep(HOOK_WRITE_RETRY_DELAY_MS);
+			}
+			threadsSuspended = suspendThreads(threadIds, transaction, applyPatches, suspendedThreads);
+		}
+		if (!threadsSuspended)
+		{
+			MessageHandler::logError("Couldn't write to process memory: a thread keeps executing the code to patch.");
+			return false;
+		}
+		uintptr_t pageNotUnprotected = 0;
+		DWORD errorCode = 0;
+		for (auto page : pages)
+		{
+			DWORD oldProtection;
+			if (!VirtualProtect((LPVOID)page, systemInfo.dwPageSize, PAGE_EXECUTE_READWRITE, &oldProtection))
+			{
+				pageNotUnprotected = page;
+				errorCode = GetLastError();
+				break;
+			}
+			oldProtections.push_back(oldProtection);
+		}
+		bool pagesUnprotected = 0 == pageNotUnprotected;
+		if (pagesUnprotected)
+		{
+			if (applyPatches)
+			{
+				transaction.apply();
+			}
+			else
+			{
+				transaction.restore();
+			}
+		}
+		for (size_t i = 0; i < oldProtections.size(); i++)
+		{
+			DWORD dummy;
+			VirtualProtect((LPVOID)pages[i], systemInfo.dwPageSize, oldProtections[i], &dummy);
+		}
+		if (pagesUnprotected)
+		{
+			FlushInstructionCache(GetCurrentProcess(), transaction.codeRangeStart(), transaction.codeRangeLength());
+		}
+		resumeThreads(suspendedThreads);
+		if (!pagesUnprotected)
+		{
+			MessageHandler::logError("Couldn't make page %p writable. Error code: %010x", (void*)pageNotUnprotected, errorCode);
+		}
+		return pagesUnprotected;
+	}
+
+
+	// Validates the staged patches and if they're all OK, writes them in one batch. If one patch isn't OK, nothing is written and the memory
+	// of the stubs of the transaction is released.
+	bool commit(HookTransaction& transaction)
+	{
+		if (!transaction.validate())
+		{
+			MessageHandler::logError("Couldn't set hooks: %s", transaction.lastError().c_str());
+			releaseStubs(transaction);
+			return false;
+		}
+		if (transaction.numberOfPatches() <= 0)
+		{
+			return true;
+		}
+		if (!_journal.canRecord(transaction))
+		{
+			MessageHandler::logError("Couldn't set hooks: they overlap hooks which have already been set.");
+			releaseStubs(transaction);
+			return false;
+		}
+		if (!writeTransaction(transaction, true))
+		{
+			MessageHandler::logError("Couldn't write to process memory, so couldn't set hooks.");
+			releaseStubs(transaction);
+			return false;
+		}
+		_journal.record(transaction);
+		MessageHandler::logDebug("%d patches written to process memory", transaction.numberOfPatches());
+		return true;
+	}
+
+
+	// Restores the original bytes of all patches of a committed transaction in one batch and releases the memory of its stubs.
+	bool rollback(HookTransaction& transaction)
+	{
+		if (!transaction.isApplied())
 		{
-			MessageHandler::logDebug("Hook set to address: %p", (void*)startOfHookAddress);
+			return true;
 		}
-		else
+		if (!transaction.validateRollback())
 		{
-			MessageHandler::logError("Couldn't write to process memory, so couldn't set hook. Error code: %010x", GetLastError());
+			MessageHandler::logError("Couldn't remove hooks: %s", transaction.lastError().c_str());
+			return false;
+		}
+		if (!writeTransaction(transaction, false))
+		{
+			MessageHandler::logError("Couldn't write to process memory, so couldn't remove hooks.");
+			return false;
+		}
+		_journal.forget(transaction);
+		releaseStubs(transaction);
+		MessageHandler::logDebug("%d patches removed from process memory", transaction.numberOfPatches());
+		return true;
+	}
+
+
+	// Restores the original bytes of every patch committed so far, newest first. Returns false if a patch couldn't be restored, in which
+	// case the game can still jump into our code and the dll can't be unloaded.
+	bool removeAllHooks()
+	{
+		int numberOfFailures = _journal.rollbackAll([](HookTransaction& transaction)
+													{
+														if (!transaction.validateRollback())
+														{
+															MessageHandler::logError("Couldn't remove hooks: %s", transaction.lastError().c_str());
+															return false;
+														}
+														return writeTransaction(transaction, false);
+													});
+		if (numberOfFailures > 0)
+		{
+			MessageHandler::logError("%d hook transactions couldn't be removed.", numberOfFailures);
+			return false;
+		}
+		MessageHandler::logDebug("All hooks removed from process memory");
+		return true;
+	}
+
+
+	// Frees the memory of all emitted stubs. Only call this after removeAllHooks succeeded and no thread can be running in a stub anymore.
+	void releaseStubMemory()
+	{
+		for (auto& block : _stubMemoryBlocks)
+		{
+			VirtualFree(block.start, 0, MEM_RELEASE);
+		}
+		_stubMemoryBlocks.clear();
+	}
+
+
+	// Stages a jmp qword ptr [address] statement at hostImageAddress + startOffset for x64 and a jmp <relative address> for x86
+	void setHook(HookTransaction& transaction, LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction)
+	{
+		if (hostImageAddress == nullptr)
+		{
+			return;
+		}
+		LPBYTE startOfHookAddress = hostImageAddress + startOffset;
+		// interception continue isn't always specified, i.e. in the case of when the intercepted block by itself issues a ret.
+		if (nullptr != interceptionContinue)
+		{
+			*interceptionContinue = startOfHookAddress + continueOffset;
+		}
+		uint8_t instruction[14];
+		int instructionLength = createJumpInstruction(startOfHookAddress, asmFunction, instruction);
+		transaction.stagePatch(startOfHookAddress, instruction, instructionLength, "hook");
+	}
+
+
+	// Stages a jmp qword ptr [address] statement at baseAddress + startOffset for x64 and a jmp <relative address> for x86. The hook is only set
+	// if the bytes at the location of the block still match the block's pattern when the transaction is committed.
+	void setHook(HookTransaction& transaction, AOBBlock* hookData, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction)
+	{
+		LPBYTE hostImageAddress = hookData->locationInImage();
+		if (hostImageAddress == nullptr)
+		{
+			return;
+		}
+		LPBYTE startOfHookAddress = hostImageAddress + hookData->customOffset();
+		if (!checkContinueOffset(transaction, hookData, startOfHookAddress, continueOffset))
+		{
+			return;
+		}
+		if (nullptr != interceptionContinue)
+		{
+			*interceptionContinue = startOfHookAddress + continueOffset;
+		}
+		uint8_t instruction[14];
+		int instructionLength = createJumpInstruction(startOfHookAddress, asmFunction, instruction);
+		transaction.stagePatch(startOfHookAddress, instruction, instructionLength, hostImageAddress, hookData->bytePattern(), hookData->patternMask(), 
+							   hookData->numberOfPatternBytes(), hookData->blockName());
+	}
+
+
+	// Emits a capture stub for the code at the hook location of hookData and stages a hook which jumps to it. The stub takes the place of
+	// an asm interceptor which only stores a register and runs the original statements: it runs the continueOffset bytes the hook
+	// overwrites, relocated, and jumps back to the game's code at continueOffset. If the stub can't be created, the transaction fails.
+	void setCaptureHook(HookTransaction& transaction, AOBBlock* hookData, DWORD continueOffset, const CaptureDescription& capture)
+	{
+		if (hookData->locationInImage() == nullptr)
+		{
+			return;
+		}
+		LPBYTE startOfHookAddress = hookData->absoluteAddress();
+		if (!checkContinueOffset(transaction, hookData, startOfHookAddress, continueOffset))
+		{
+			return;
+		}
+		// the length of a stub doesn't depend on where it's emitted, so emit it once to know how much memory to allocate for it.
+		StubEmitter sizingEmitter(startOfHookAddress);
+		if (!sizingEmitter.emitCaptureStub(capture, startOfHookAddress, continueOffset))
+		{
+			transaction.fail(Utils::formatString("Couldn't create the stub for block '%s': %s", hookData->blockName().c_str(), sizingEmitter.lastError().c_str()));
+			return;
+		}
+		LPBYTE stubAddress = allocateStubMemory(transaction, startOfHookAddress, sizingEmitter.length());
+		if (nullptr == stubAddress)
+		{
+			transaction.fail(Utils::formatString("Couldn't allocate memory for the stub of block '%s' close to the game's code.", hookData->blockName().c_str()));
+			return;
+		}
+		StubEmitter emitter(stubAddress);
+		if (!emitter.emitCaptureStub(capture, startOfHookAddress, continueOffset))
+		{
+			transaction.fail(Utils::formatString("Couldn't create the stub for block '%s': %s", hookData->blockName().c_str(), emitter.lastError().c_str()));
+			return;
+		}
+		memcpy(stubAddress, emitter.code().data(), emitter.length());
+		FlushInstructionCache(GetCurrentProcess(), stubAddress, emitter.length());
+		setHook(transaction, hookData, continueOffset, nullptr, stubAddress);
+	}
+
+
+	// Emits a capture stub which runs the instructions the hook's jmp overwrites, and not more, and stages a hook which jumps to it. The
+	// continue offset is the end of these instructions, determined by decoding them.
+	void setCaptureHook(HookTransaction& transaction, AOBBlock* hookData, const CaptureDescription& capture)
+	{
+		if (hookData->locationInImage() == nullptr)
+		{
+			return;
+		}
+		const int continueOffset = InstructionDecoder::coveringLength(hookData->absoluteAddress(), HOOK_DECODE_WINDOW, HOOK_INSTRUCTION_LENGTH);
+		if (continueOffset < 0)
+		{
+			transaction.fail(Utils::formatString("The code at the hook location of block '%s' can't be decoded.", hookData->blockName().c_str()));
+			return;
+		}
+		setCaptureHook(transaction, hookData, static_cast<DWORD>(continueOffset), capture);
+	}
+
+
+	// Emits a capture stub for the code at the hook location of hookData and sets a hook which jumps to it.
+	void setCaptureHook(AOBBlock* hookData, DWORD continueOffset, const CaptureDescription& capture)
+	{
+		HookTransaction transaction;
+		setCaptureHook(transaction, hookData, continueOffset, capture);
+		if (commit(transaction) && transaction.numberOfPatches() > 0)
+		{
+			MessageHandler::logDebug("Capture hook set to address: %p", (void*)hookData->absoluteAddress());
+		}
+	}
+
+
+	// Emits a capture stub for the code at the hook location of hookData and sets a hook which jumps to it. The continue offset is decoded.
+	void setCaptureHook(AOBBlock* hookData, const CaptureDescription& capture)
+	{
+		HookTransaction transaction;
+		setCaptureHook(transaction, hookData, capture);
+		if (commit(transaction) && transaction.numberOfPatches() > 0)
+		{
+			MessageHandler::logDebug("Capture hook set to address: %p", (void*)hookData->absoluteAddress());
+		}
+	}
+
+
+	// Sets a jmp qword ptr [address] statement at hostImageAddress + startOffset for x64 and a jmp <relative address> for x86
+	void setHook(LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction)
+	{
+		HookTransaction transaction;
+		setHook(transaction, hostImageAddress, startOffset, continueOffset, interceptionContinue, asmFunction);
+		if (commit(transaction) && transaction.numberOfPatches() > 0)
+		{
+			MessageHandler::logDebug("Hook set to address: %p", (void*)(hostImageAddress + startOffset));
 		}
 	}
 	
@@ -79,15 +594,25 @@ namespace IGCS::GameImageHooker
 	// Sets a jmp qword ptr [address] statement at baseAddress + startOffset for x64 and a jmp <relative address> for x86
 	void setHook(AOBBlock* hookData, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction)
 	{
-		setHook(hookData->locationInImage(), hookData->customOffset(), continueOffset, interceptionContinue, asmFunction);
+		HookTransaction transaction;
+		setHook(transaction, hookData, continueOffset, interceptionContinue, asmFunction);
+		if (commit(transaction) && transaction.numberOfPatches() > 0)
+		{
+			MessageHandler::logDebug("Hook set to address: %p", (void*)hookData->absoluteAddress());
+		}
 	}
 
 
 	// Writes the bytes pointed at by bufferToWrite starting at address startAddress, for the length in 'length'.
 	void writeRange(LPBYTE startAddress, uint8_t* bufferToWrite, int length)
 	{
-		SIZE_T noBytesWritten;
-		WriteProcessMemory(OpenProcess(PROCESS_VM_OPERATION | PROCESS_VM_WRITE, FALSE, GetCurrentProcessId()), startAddress, bufferToWrite, length, &noBytesWritten);
+		if (nullptr == startAddress || length <= 0)
+		{
+			return;
+		}
+		HookTransaction transaction;
+		transaction.stagePatch(startAddress, bufferToWrite, length, "range");
+		commit(transaction);
 	}
 
 
@@ -101,20 +626,13 @@ namespace IGCS::GameImageHooker
 	// Writes NOP opcodes to a range of memory.
 	void nopRange(LPBYTE startAddress, int length)
 	{
-		uint8_t* nopBuffer;
 		if (length < 0 || length>1024)
 		{
 			// no can/wont do 
 			return;
 		}
-		nopBuffer = (uint8_t*)malloc(length * sizeof(uint8_t));
-		for (int i = 0; i < length; i++)
-		{
-			nopBuffer[i] = 0x90;
-		}
-		SIZE_T noBytesWritten;
-		WriteProcessMemory(OpenProcess(PROCESS_VM_OPERATION | PROCESS_VM_WRITE, FALSE, GetCurrentProcessId()), startAddress, nopBuffer, length, &noBytesWritten);
-		free(nopBuffer);
+		vector<uint8_t> nopBuffer(length, 0x90);
+		writeRange(startAddress, nopBuffer.data(), length);
 	}
 
 
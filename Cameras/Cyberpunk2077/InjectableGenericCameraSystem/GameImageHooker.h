@@ -27,13 +27,25 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "AOBBlock.h"
+#include "HookTransaction.h"
+#include "StubEmitter.h"
 
 namespace IGCS::GameImageHooker
 {
+	bool commit(HookTransaction& transaction);
+	bool rollback(HookTransaction& transaction);
+	bool removeAllHooks();
+	void releaseStubMemory();
 	void nopRange(LPBYTE startAddress, int length);
 	void nopRange(AOBBlock* hookData, int length);
 	void setHook(LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction);
 	void setHook(AOBBlock* hookData, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction);
+	void setHook(HookTransaction& transaction, LPBYTE hostImageAddress, DWORD startOffset, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction);
+	void setHook(HookTransaction& transaction, AOBBlock* hookData, DWORD continueOffset, LPBYTE* interceptionContinue, void* asmFunction);
+	void setCaptureHook(AOBBlock* hookData, DWORD continueOffset, const CaptureDescription& capture);
+	void setCaptureHook(AOBBlock* hookData, const CaptureDescription& capture);
+	void setCaptureHook(HookTransaction& transaction, AOBBlock* hookData, DWORD continueOffset, const CaptureDescription& capture);
+	void setCaptureHook(HookTransaction& transaction, AOBBlock* hookData, const CaptureDescription& capture);
 	void writeRange(LPBYTE startAddress, uint8_t* bufferToWrite, int length);
 	void writeRange(AOBBlock* hookData, uint8_t* bufferToWrite, int length);
 }
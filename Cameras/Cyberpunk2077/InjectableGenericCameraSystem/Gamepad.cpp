@@ -3,14 +3,49 @@
 //////////////////////////////////////////////////////////////////////
 #include "stdafx.h"
 #include "Gamepad.h"
-#include <Windows.h>
-#include <Xinput.h>
 #include <algorithm>
 #include <limits>
 
 #define clamp(v, _min, _max) max(min(v, _max), _min)
 
+#ifdef _WIN32
+#include <Windows.h>
+#include <Xinput.h>
+
+static_assert(sizeof(IGCS::GamepadState) == sizeof(XINPUT_GAMEPAD), "GamepadState has to have the layout of XINPUT_GAMEPAD");
+
+// Copies the state XInput reported into our own type.
+static IGCS::GamepadState toGamepadState(const XINPUT_GAMEPAD& xinputState) {
+	IGCS::GamepadState state;
+	state.wButtons = xinputState.wButtons;
+	state.bLeftTrigger = xinputState.bLeftTrigger;
+	state.bRightTrigger = xinputState.bRightTrigger;
+	state.sThumbLX = xinputState.sThumbLX;
+	state.sThumbLY = xinputState.sThumbLY;
+	state.sThumbRX = xinputState.sThumbRX;
+	state.sThumbRY = xinputState.sThumbRY;
+	return state;
+}
+#endif
+
+Gamepad::Gamepad(int index) : buttonDownCallback{ nullptr }, buttonUpCallback{ nullptr }, gpCurrent{}, gpIndex{ index }, buttonState{ 0x0 }, connected{ false },
+							  invertLSY{ false }, invertRSY{ false }, polling{ false } {
+#ifdef _WIN32
+	ZeroMemory(&gpState, sizeof(XINPUT_STATE));
+#endif
+	// the deadzones XInput recommends
+	lStickResponse.configure(XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE / 32767.0f, 1.0f, 1.0f);
+	rStickResponse.configure(XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE / 32767.0f, 1.0f, 1.0f);
+	triggerResponse.configure(XINPUT_GAMEPAD_TRIGGER_THRESHOLD / 255.0f, 1.0f, 1.0f);
+}
+
+Gamepad::~Gamepad() {
+	stopPolling();
+}
+
+#ifdef _WIN32
 XINPUT_STATE* Gamepad::getState() { return &gpState; }
+#endif
 int Gamepad::getIndex() { return gpIndex; }
 bool Gamepad::isConnected() { return connected; }
 void Gamepad::setButtonDownCallback(function<void(button_t)> fn) { buttonDownCallback = fn; }
@@ -19,13 +54,93 @@ bool Gamepad::isButtonPressed(button_t b) { return (buttonState & b); }
 void Gamepad::setInvertLStickY(bool b) { invertLSY = b; }
 void Gamepad::setInvertRStickY(bool b) { invertRSY = b; }
 
-void Gamepad::update() {
+void Gamepad::setStickResponse(float lStickInnerDeadzone, float rStickInnerDeadzone, float outerDeadzone, float curveExponent) {
+	lStickResponse.configure(lStickInnerDeadzone, outerDeadzone, curveExponent);
+	rStickResponse.configure(rStickInnerDeadzone, outerDeadzone, curveExponent);
+}
+
+void Gamepad::setTriggerResponse(float innerDeadzone, float outerDeadzone, float curveExponent) {
+	triggerResponse.configure(innerDeadzone, outerDeadzone, curveExponent);
+}
+
+// Reads the state from XInput and publishes it for 'update()'. Returns true if the gamepad is connected. Without XInput there's never one.
+bool Gamepad::poll() {
+	PolledState toPublish;
+#ifdef _WIN32
 	ZeroMemory(&gpState, sizeof(XINPUT_STATE));
-	connected = (XInputGetState(gpIndex, &gpState) == ERROR_SUCCESS);
-	if (buttonState != gpState.Gamepad.wButtons) {
-		WORD stateDiff = buttonState ^ gpState.Gamepad.wButtons;
-		WORD buttonStateCopy = buttonState;
-		for (WORD i{ 0x1 };; i <<= 0x1) {
+	toPublish.connected = (XInputGetState(gpIndex, &gpState) == ERROR_SUCCESS) ? 1 : 0;
+	toPublish.gamepad = toGamepadState(gpState.Gamepad);
+#else
+	toPublish.connected = 0;
+	toPublish.gamepad = {};
+#endif
+	polledState.publish(toPublish);
+	return toPublish.connected != 0;
+}
+
+void Gamepad::startPolling(int pollIntervalMs, int minReconnectIntervalMs, int maxReconnectIntervalMs) {
+	if (polling) {
+		return;
+	}
+	polling = true;
+	pollThread = thread(&Gamepad::pollLoop, this, pollIntervalMs, minReconnectIntervalMs, maxReconnectIntervalMs);
+}
+
+void Gamepad::stopPolling() {
+	if (!pollThread.joinable()) {
+		return;
+	}
+	{
+		lock_guard<mutex> lock(pollMutex);
+		polling = false;
+	}
+	pollStopped.notify_all();
+	pollThread.join();
+}
+
+void Gamepad::pollLoop(int pollIntervalMs, int minReconnectIntervalMs, int maxReconnectIntervalMs) {
+	int reconnectIntervalMs = minReconnectIntervalMs;
+	unique_lock<mutex> lock(pollMutex);
+	while (polling) {
+		lock.unlock();
+		bool isConnected = poll();
+		lock.lock();
+		int waitMs = pollIntervalMs;
+		if (isConnected) {
+			reconnectIntervalMs = minReconnectIntervalMs;
+		} else {
+			// nobody's there, so back off exponentially: every poll of an empty slot is expensive.
+			waitMs = reconnectIntervalMs;
+			reconnectIntervalMs = min(reconnectIntervalMs * 2, maxReconnectIntervalMs);
+		}
+		pollStopped.wait_for(lock, chrono::milliseconds(waitMs), [this] { return !polling; });
+	}
+}
+
+void Gamepad::update() {
+	IGCS::GamepadState latest;
+	bool isConnected = readState(latest);
+	update(latest, isConnected);
+}
+
+bool Gamepad::readState(IGCS::GamepadState& state) {
+	if (polling) {
+		PolledState latest = polledState.read();
+		state = latest.gamepad;
+		return latest.connected != 0;
+	}
+	bool isConnected = poll();
+	state = polledState.read().gamepad;
+	return isConnected;
+}
+
+void Gamepad::update(const IGCS::GamepadState& state, bool isConnected) {
+	connected = isConnected;
+	gpCurrent = state;
+	if (buttonState != gpCurrent.wButtons) {
+		uint16_t stateDiff = buttonState ^ gpCurrent.wButtons;
+		uint16_t buttonStateCopy = buttonState;
+		for (uint16_t i{ 0x1 };; i <<= 0x1) {
 			if (stateDiff & 0x1) {
 				if (buttonStateCopy & 0x1) {
 					if (buttonUpCallback)
@@ -42,48 +157,33 @@ void Gamepad::update() {
 			}
 		}
 	}
-	buttonState = gpState.Gamepad.wButtons;
+	buttonState = gpCurrent.wButtons;
 }
 
 vec2 Gamepad::getLStickPosition() {
-	auto x = gpState.Gamepad.sThumbLX;
-	auto y = gpState.Gamepad.sThumbLY;
-	if (abs(x) <= XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE &&
-		abs(y) <= XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE ) {
-		return { 0.0f, 0.0f };
-	} else {
-		auto xf = float{ static_cast<float>(x) / static_cast<float>(SHRT_MAX) };
-		auto yf = float{ (invertLSY ? -1.0f : 1.0f) * static_cast<float>(y) / static_cast<float>(SHRT_MAX) };
-		return { clamp(xf, -1.0f, 1.0f), clamp(yf, -1.0f, 1.0f) };
-	};
+	float xf, yf;
+	lStickResponse.apply(gpCurrent.sThumbLX, gpCurrent.sThumbLY, xf, yf);
+	return { xf, (invertLSY ? -1.0f : 1.0f) * yf };
 }
 
 vec2 Gamepad::getRStickPosition() {
-	auto x = gpState.Gamepad.sThumbRX;
-	auto y = gpState.Gamepad.sThumbRY;
-	if (abs(x) <= XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE &&
-		abs(y) <= XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE ) {
-		return { 0.0f, 0.0f };
-	} else {
-		auto xf = float{ static_cast<float>(x) / static_cast<float>(SHRT_MAX) };
-		auto yf = float{ (invertRSY ? -1.0f : 1.0f) * static_cast<float>(y) / static_cast<float>(SHRT_MAX) };
-		return { clamp(xf, -1.0f, 1.0f), clamp(yf, -1.0f, 1.0f) };
-	};
+	float xf, yf;
+	rStickResponse.apply(gpCurrent.sThumbRX, gpCurrent.sThumbRY, xf, yf);
+	return { xf, (invertRSY ? -1.0f : 1.0f) * yf };
 }
 
 float Gamepad::getLTrigger() {
-	auto x = gpState.Gamepad.bLeftTrigger;
-	return (x > XINPUT_GAMEPAD_TRIGGER_THRESHOLD) ? static_cast<float>(x) / 255.0f : 0.0f;
+	return triggerResponse.apply(gpCurrent.bLeftTrigger);
 }
 
 float Gamepad::getRTrigger() {
-	auto x = gpState.Gamepad.bRightTrigger;
-	return (x > XINPUT_GAMEPAD_TRIGGER_THRESHOLD) ? static_cast<float>(x) / 255.0f : 0.0f;
+	return triggerResponse.apply(gpCurrent.bRightTrigger);
 }
 
 void Gamepad::vibrate(float L, float R) {
 	L = clamp(L, 0.0f, 1.0f);
 	R = clamp(R, 0.0f, 1.0f);
+#ifdef _WIN32
 	XINPUT_VIBRATION vState;
 	ZeroMemory(&vState, sizeof(XINPUT_VIBRATION));
 	int iL = static_cast<WORD>(L * 65535.0f + 0.4999f);
@@ -91,4 +191,5 @@ void Gamepad::vibrate(float L, float R) {
 	vState.wLeftMotorSpeed = iL;
 	vState.wRightMotorSpeed = iR;
 	XInputSetState(gpIndex, &vState);
+#endif
 }
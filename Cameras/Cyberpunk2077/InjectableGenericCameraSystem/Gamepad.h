@@ -12,7 +12,16 @@
 #endif
 
 #include <functional>
+#ifdef _WIN32
 #include <Xinput.h>
+#endif
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "GamepadResponse.h"
+#include "GamepadState.h"
+#include "SeqLockSnapshot.h"
 using namespace std;
 
 /* The positions of the analog sticks will be returned as 'vec2'.
@@ -48,7 +57,10 @@ public:
 		BACK = XINPUT_GAMEPAD_BACK
 	};
 	// If you have multiple gamepads, create multiple instances of the class using different indexes. The connected gamepads are numbered 0-4. The default argument is 0, meaning this instance will take control of the first (or only one) gamepad connected to the system.
-	Gamepad(int index = 0) : gpIndex{ index }, buttonDownCallback{ nullptr }, buttonUpCallback{ nullptr }, buttonState{ 0x0 } {}
+	Gamepad(int index = 0);
+	~Gamepad();
+	Gamepad(const Gamepad&) = delete;
+	Gamepad& operator=(const Gamepad&) = delete;
 
 	// Set a function (of type 'void', with a 'button_t' argument) to be called each time a button is pressed on the gamepad. The value of the argument should be checked against values of the 'button_t' enum to determine which button was pressed.
 	void setButtonDownCallback(function<void(button_t)> fn);
@@ -56,6 +68,14 @@ public:
 	void setButtonUpCallback(function<void(button_t)> fn);
 	// Ths update function should be called every cycle of your app (before any other member calls) to keep things up to date. NOTE: All data that other member functions return is actually read from the device at the time you call this function, and will not be updated until you call 'update()' again.
 	void update();
+	// Reads the latest state of the gamepad, as 'update()' does, without making it the current state. Returns true if the gamepad is connected.
+	bool readState(IGCS::GamepadState& state);
+	// Makes a state obtained with 'readState()' the current state, which is the other half of 'update()'. A recorded state can be passed in too.
+	void update(const IGCS::GamepadState& state, bool isConnected);
+	// Starts a thread which polls the gamepad, so 'update()' only has to pick up the latest state. Polling a gamepad which isn't connected can take milliseconds, so while it's disconnected it's polled less and less often.
+	void startPolling(int pollIntervalMs, int minReconnectIntervalMs, int maxReconnectIntervalMs);
+	// Stops the polling thread and waits for it to end.
+	void stopPolling();
 	// Indicates if the gamepad is connected or not. This should be checked before fetching any data.
 	bool isConnected();
 	// Indicates if a button (specified by the argument) is currently pressed or not (well, at the time of the last 'update()' call anyway).
@@ -74,18 +94,44 @@ public:
 	void setInvertLStickY(bool b);
 	// If set to true, the Y-axis of the right analog stick will be inverted.
 	void setInvertRStickY(bool b);
+	// Sets the radial deadzones and the response curve of the analog sticks. The deadzones are a fraction of the full range, see 'StickResponse'.
+	void setStickResponse(float lStickInnerDeadzone, float rStickInnerDeadzone, float outerDeadzone, float curveExponent);
+	// Sets the deadzones and the response curve of the triggers, see 'TriggerResponse'.
+	void setTriggerResponse(float innerDeadzone, float outerDeadzone, float curveExponent);
 
-	// Only use this if you want to use some XInput functionality directly. It returns a pointer to the current state.
+#ifdef _WIN32
+	// Returns the pointer to the buffer the state is read into from XInput. 
 	XINPUT_STATE* getState();
+#endif
 	// Returns the gamepad's index (the argument the constructor was given). Kind of pointless, but whatever.
 	int getIndex();
 private:
+	// What the polling thread hands to 'update()'.
+	struct PolledState {
+		IGCS::GamepadState gamepad;
+		uint32_t connected;
+	};
+
+	bool poll();
+	void pollLoop(int pollIntervalMs, int minReconnectIntervalMs, int maxReconnectIntervalMs);
+
 	function<void(button_t)> buttonDownCallback;
 	function<void(button_t)> buttonUpCallback;
-	XINPUT_STATE gpState;
+#ifdef _WIN32
+	XINPUT_STATE gpState;			// written by XInputGetState, on the polling thread if it runs
+#endif
+	IGCS::GamepadState gpCurrent;	// the state picked up by the last 'update()'
 	int gpIndex;
-	WORD buttonState;
+	uint16_t buttonState;
 	bool connected;
 	bool invertLSY;
 	bool invertRSY;
+	IGCS::StickResponse lStickResponse;
+	IGCS::StickResponse rStickResponse;
+	IGCS::TriggerResponse triggerResponse;
+	IGCS::SeqLockSnapshot<PolledState> polledState;
+	thread pollThread;
+	atomic<bool> polling;
+	mutex pollMutex;
+	condition_variable pollStopped;
 };
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "GamepadResponse.h"
+#include <algorithm>
+#include <cmath>
+
+namespace IGCS
+{
+	static const float MAX_RAW_STICK_VALUE = 32767.0f;
+
+	// Returns the response for a normalized distance from the rest position.
+	static float calculateResponse(float distance, float innerDeadzone, float outerDeadzone, float curveExponent)
+	{
+		if (distance <= innerDeadzone)
+		{
+			return 0.0f;
+		}
+		if (distance >= outerDeadzone)
+		{
+			return 1.0f;
+		}
+		return std::pow((distance - innerDeadzone) / (outerDeadzone - innerDeadzone), curveExponent);
+	}
+
+
+	// Clamps the settings to sane values, so the tables are always valid.
+	static void sanitizeSettings(float& innerDeadzone, float& outerDeadzone, float& curveExponent)
+	{
+		innerDeadzone = (std::min)((std::max)(innerDeadzone, 0.0f), 0.9f);
+		outerDeadzone = (std::min)((std::max)(outerDeadzone, innerDeadzone + 0.05f), 1.0f);
+		curveExponent = (std::min)((std::max)(curveExponent, 0.1f), 10.0f);
+	}
+
+
+	StickResponse::StickResponse() : _innerDeadzoneSquared(0.0f)
+	{
+		configure(0.0f, 1.0f, 1.0f);
+	}
+
+
+	StickResponse::~StickResponse()
+	{
+	}
+
+
+	void StickResponse::configure(float innerDeadzone, float outerDeadzone, float curveExponent)
+	{
+		sanitizeSettings(innerDeadzone, outerDeadzone, curveExponent);
+		_innerDeadzoneSquared = innerDeadzone * innerDeadzone;
+		for (int i = 1; i <= TABLE_SIZE; i++)
+		{
+			float distance = std::sqrt(2.0f * static_cast<float>(i) / static_cast<float>(TABLE_SIZE));
+			// the factor the normalized position is scaled with, so the distance becomes the response
+			_scaleTable[i] = calculateResponse(distance, innerDeadzone, outerDeadzone, curveExponent) / distance;
+		}
+		// the factor at the center itself doesn't matter, but it's interpolated with for positions close to it: without a deadzone a 0 there
+		// would pull these towards the center.
+		_scaleTable[0] = _scaleTable[1];
+	}
+
+
+	void StickResponse::apply(int16_t rawX, int16_t rawY, float& x, float& y) const
+	{
+		// -32768 is clamped, so both halves of an axis have the same range
+		float normalizedX = (std::max)(static_cast<float>(rawX), -MAX_RAW_STICK_VALUE) / MAX_RAW_STICK_VALUE;
+		float normalizedY = (std::max)(static_cast<float>(rawY), -MAX_RAW_STICK_VALUE) / MAX_RAW_STICK_VALUE;
+		float distanceSquared = normalizedX * normalizedX + normalizedY * normalizedY;
+		if (distanceSquared <= _innerDeadzoneSquared)
+		{
+			x = 0.0f;
+			y = 0.0f;
+			return;
+		}
+		float position = distanceSquared * (0.5f * static_cast<float>(TABLE_SIZE));
+		int index = (std::min)(static_cast<int>(position), TABLE_SIZE - 1);
+		float fraction = (std::min)(position - static_cast<float>(index), 1.0f);
+		float scale = _scaleTable[index] + (_scaleTable[index + 1] - _scaleTable[index]) * fraction;
+		x = (std::min)((std::max)(normalizedX * scale, -1.0f), 1.0f);
+		y = (std::min)((std::max)(normalizedY * scale, -1.0f), 1.0f);
+	}
+
+
+	TriggerResponse::TriggerResponse()
+	{
+		configure(0.0f, 1.0f, 1.0f);
+	}
+
+
+	TriggerResponse::~TriggerResponse()
+	{
+	}
+
+
+	void TriggerResponse::configure(float innerDeadzone, float outerDeadzone, float curveExponent)
+	{
+		sanitizeSettings(innerDeadzone, outerDeadzone, curveExponent);
+		for (int i = 0; i < 256; i++)
+		{
+			_table[i] = calculateResponse(static_cast<float>(i) / 255.0f, innerDeadzone, outerDeadzone, curveExponent);
+		}
+	}
+}
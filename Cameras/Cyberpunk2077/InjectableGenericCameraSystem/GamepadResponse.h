@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+
+namespace IGCS
+{
+	// Maps the raw position of an analog stick to a position in [-1, 1] with a radial deadzone and a response curve. Within innerDeadzone 
+	// of the center the stick is at rest, beyond outerDeadzone it's fully pushed, in between the distance is rescaled to [0, 1] and raised to
+	// the power curveExponent (1 is linear, higher gives finer control near the center). The direction is kept. The mapping is precomputed
+	// in a table indexed by the squared distance, which gives the factor to scale the raw position with, so applying it needs no sqrt/pow.
+	class StickResponse
+	{
+	public:
+		StickResponse();
+		~StickResponse();
+
+		void configure(float innerDeadzone, float outerDeadzone, float curveExponent);
+		void apply(int16_t rawX, int16_t rawY, float& x, float& y) const;
+
+	private:
+		// the squared distance ranges from 0 to 2, as the stick reaches the corners of the square the raw values span.
+		static const int TABLE_SIZE = 1024;
+
+		float _scaleTable[TABLE_SIZE + 1];
+		float _innerDeadzoneSquared;		// tested exactly, as the table would interpolate into the deadzone
+	};
+
+
+	// Maps the raw position of a trigger, 0-255, to [0, 1] with a deadzone at the start, one at the end and a response curve, like
+	// StickResponse does. There are only 256 raw values, so all of them are precomputed.
+	class TriggerResponse
+	{
+	public:
+		TriggerResponse();
+		~TriggerResponse();
+
+		void configure(float innerDeadzone, float outerDeadzone, float curveExponent);
+		float apply(uint8_t raw) const { return _table[raw]; }
+
+	private:
+		float _table[256];
+	};
+}
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+
+#ifndef _WIN32
+// The button masks and deadzones as Xinput.h defines them, for the platforms without XInput. There's no gamepad there, but the code 
+// which reads one still builds.
+#define XINPUT_GAMEPAD_DPAD_UP			0x0001
+#define XINPUT_GAMEPAD_DPAD_DOWN		0x0002
+#define XINPUT_GAMEPAD_DPAD_LEFT		0x0004
+#define XINPUT_GAMEPAD_DPAD_RIGHT		0x0008
+#define XINPUT_GAMEPAD_START			0x0010
+#define XINPUT_GAMEPAD_BACK				0x0020
+#define XINPUT_GAMEPAD_LEFT_THUMB		0x0040
+#define XINPUT_GAMEPAD_RIGHT_THUMB		0x0080
+#define XINPUT_GAMEPAD_LEFT_SHOULDER	0x0100
+#define XINPUT_GAMEPAD_RIGHT_SHOULDER	0x0200
+#define XINPUT_GAMEPAD_A				0x1000
+#define XINPUT_GAMEPAD_B				0x2000
+#define XINPUT_GAMEPAD_X				0x4000
+#define XINPUT_GAMEPAD_Y				0x8000
+#define XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE	7849
+#define XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE	8689
+#define XINPUT_GAMEPAD_TRIGGER_THRESHOLD	30
+#endif
+
+namespace IGCS
+{
+	// The state of a gamepad as XInput reports it: the buttons pressed, the triggers and the sticks. It has the layout and the field names 
+	// of XINPUT_GAMEPAD, so Gamepad can copy one into the other, but it's our own type, which lets TickInput and a recorded session hold 
+	// gamepad state without pulling in XInput.
+	struct GamepadState
+	{
+		uint16_t wButtons;
+		uint8_t bLeftTrigger;
+		uint8_t bRightTrigger;
+		int16_t sThumbLX;
+		int16_t sThumbLY;
+		int16_t sThumbRX;
+		int16_t sThumbRY;
+	};
+}
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "Globals.h"
 #include "GameConstants.h"
+#include "MessageHandler.h"
 
 //--------------------------------------------------------------------------------------------------------------------------------
 // data shared with asm functions. This is allocated here, 'C' style and not in some datastructure as passing that to 
@@ -36,14 +37,15 @@ extern "C" {
 	uint8_t g_cameraEnabled = 0;
 	uint8_t g_wetness_OverrideParameters = 0;
 	float g_wetness_StreetWetnessFactor = 0.0f;
-	LPBYTE g_pmStructAddress = nullptr;
-	LPBYTE g_activeCamStructAddress = nullptr;
-	LPBYTE g_resolutionStructAddress = nullptr;
-	LPBYTE g_todStructAddress = nullptr;
-	LPBYTE g_playHudWidgetAddress = nullptr;
-	LPBYTE g_pmHudWidgetAddress = nullptr;
-	LPBYTE g_timestopStructAddress = nullptr;
-	LPBYTE g_weatherStructAddress = nullptr;
+	uint8_t* g_pmStructAddress = nullptr;
+	uint8_t* g_activeCamStructAddress = nullptr;
+	uint8_t* g_resolutionStructAddress = nullptr;
+	uint8_t* g_todStructAddress = nullptr;
+	uint8_t* g_playHudWidgetAddress = nullptr;
+	uint8_t* g_pmHudWidgetAddress = nullptr;
+	uint8_t* g_timestopStructAddress = nullptr;
+	uint8_t* g_weatherStructAddress = nullptr;
+	IGCS::CameraPoseSeqLock g_cameraPose;
 }
 
 namespace IGCS
@@ -66,14 +68,61 @@ namespace IGCS
 		return theInstance;
 	}
 
+
+	// Called by the thread reading the named pipe for setting and key binding messages, which are applied by the camera thread. 
+	void Globals::queueMessage(uint8_t payload[], uint32_t payloadLength)
+	{
+		PipeMessage message;
+		if (payloadLength > sizeof(message.payload))
+		{
+			MessageHandler::logError("Message of %d bytes is too long to be queued, it's ignored.", (int)payloadLength);
+			return;
+		}
+		memcpy(message.payload, payload, payloadLength);
+		message.length = static_cast<uint8_t>(payloadLength);
+		if (!_queuedMessages.push(message))
+		{
+			MessageHandler::logError("Too many messages are waiting to be applied, the message is ignored.");
+		}
+	}
+
+
+	// camera thread only
+	bool Globals::dequeueMessage(PipeMessage& message)
+	{
+		return _queuedMessages.pop(message);
+	}
+
+
+	void Globals::applyMessage(const PipeMessage& message)
+	{
+		if (message.length < 2)
+		{
+			return;
+		}
+		PipeMessage toApply = message;
+		switch (static_cast<MessageType>(toApply.payload[0]))
+		{
+		case MessageType::Setting:
+			handleSettingMessage(toApply.payload, toApply.length);
+			break;
+		case MessageType::KeyBinding:
+			handleKeybindingMessage(toApply.payload, toApply.length);
+			break;
+		default:
+			// not a message which is queued
+			break;
+		}
+	}
+
 	
-	void Globals::handleSettingMessage(uint8_t payload[], DWORD payloadLength)
+	void Globals::handleSettingMessage(uint8_t payload[], uint32_t payloadLength)
 	{
 		_settings.setValueFromMessage(payload, payloadLength);
 	}
 
 	
-	void Globals::handleKeybindingMessage(uint8_t payload[], DWORD payloadLength)
+	void Globals::handleKeybindingMessage(uint8_t payload[], uint32_t payloadLength)
 	{
 		if(payloadLength<6)
 		{
@@ -84,54 +133,67 @@ namespace IGCS
 		//payload[3] = _altPressed;
 		//payload[4] = _ctrlPressed;
 		//payload[5] = _shiftPressed;
-		ActionType idOfBinding = static_cast<ActionType>(payload[1]);
-		ActionData* toUpdate = getActionData(idOfBinding);
+		setKeyBinding(static_cast<ActionType>(payload[1]), payload[2], payload[3] == 0x01, payload[4] == 0x01, payload[5] == 0x01);
+	}
+
+
+	void Globals::setKeyBinding(ActionType type, uint8_t keyCode, bool altRequired, bool ctrlRequired, bool shiftRequired)
+	{
+		ActionData* toUpdate = getActionData(type);
 		if (nullptr == toUpdate)
 		{
 			return;
 		}
-		toUpdate->update(payload[2], payload[3] == 0x01, payload[4] == 0x01, payload[5] == 0x01);
+		toUpdate->update(keyCode, altRequired, ctrlRequired, shiftRequired);
+		_keyBindingsVersion++;
 	}
 
 
 	ActionData* Globals::getActionData(ActionType type)
 	{
-		if (_keyBindingPerActionType.count(type) != 1)
+		int index = static_cast<int>(type);
+		if (index < 0 || index >= static_cast<int>(ActionType::Amount))
 		{
 			return nullptr;
 		}
-		return _keyBindingPerActionType.at(type);
+		return _keyBindingPerActionType[index];
+	}
+
+
+	void Globals::addActionData(ActionType type, ActionData* data)
+	{
+		_keyBindingPerActionType[static_cast<int>(type)] = data;
 	}
 	
 
 	void Globals::initializeKeyBindings()
 	{
 		// initialize the bindings with defaults. First the features which are always supported.
-		_keyBindingPerActionType[ActionType::BlockInput] = new ActionData("BlockInput", IGCS_KEY_BLOCK_INPUT, false, false, false);
-		_keyBindingPerActionType[ActionType::CameraEnable] = new ActionData("CameraEnable", IGCS_KEY_CAMERA_ENABLE, false, false, false);
-		_keyBindingPerActionType[ActionType::CameraLock] = new ActionData("CameraLock", IGCS_KEY_CAMERA_LOCK, false, false, false);
-		_keyBindingPerActionType[ActionType::FovDecrease] = new ActionData("FovDecrease", IGCS_KEY_FOV_DECREASE, false, false, false);
-		_keyBindingPerActionType[ActionType::FovIncrease] = new ActionData("FovIncrease", IGCS_KEY_FOV_INCREASE, false, false, false);
-		_keyBindingPerActionType[ActionType::FovReset] = new ActionData("FovReset", IGCS_KEY_FOV_RESET, false, false, false);
-		_keyBindingPerActionType[ActionType::MoveBackward] = new ActionData("MoveBackward", IGCS_KEY_MOVE_BACKWARD, false, false, false);
-		_keyBindingPerActionType[ActionType::MoveDown] = new ActionData("MoveDown", IGCS_KEY_MOVE_DOWN, false, false, false);
-		_keyBindingPerActionType[ActionType::MoveForward] = new ActionData("MoveForward", IGCS_KEY_MOVE_FORWARD, false, false, false);
-		_keyBindingPerActionType[ActionType::MoveLeft] = new ActionData("MoveLeft", IGCS_KEY_MOVE_LEFT, false, false, false);
-		_keyBindingPerActionType[ActionType::MoveRight] = new ActionData("MoveRight", IGCS_KEY_MOVE_RIGHT, false, false, false);
-		_keyBindingPerActionType[ActionType::MoveUp] = new ActionData("MoveUp", IGCS_KEY_MOVE_UP, false, false, false);
-		_keyBindingPerActionType[ActionType::RotateDown] = new ActionData("RotateDown", IGCS_KEY_ROTATE_DOWN, false, false, false);
-		_keyBindingPerActionType[ActionType::RotateLeft] = new ActionData("RotateLeft", IGCS_KEY_ROTATE_LEFT, false, false, false);
-		_keyBindingPerActionType[ActionType::RotateRight] = new ActionData("RotateRight", IGCS_KEY_ROTATE_RIGHT, false, false, false);
-		_keyBindingPerActionType[ActionType::RotateUp] = new ActionData("RotateUp", IGCS_KEY_ROTATE_UP, false, false, false);
-		_keyBindingPerActionType[ActionType::TiltLeft] = new ActionData("TiltLeft", IGCS_KEY_TILT_LEFT, false, false, false);
-		_keyBindingPerActionType[ActionType::TiltRight] = new ActionData("TiltRight", IGCS_KEY_TILT_RIGHT, false, false, false);
-		_keyBindingPerActionType[ActionType::ResetTilt] = new ActionData("ResetTilt", IGCS_KEY_RESET_TILT, false, false, false);
-		_keyBindingPerActionType[ActionType::HudToggle] = new ActionData("HudToggle", IGCS_KEY_HUD_TOGGLE, false, false, false);
-		_keyBindingPerActionType[ActionType::Timestop] = new ActionData("Timestop", IGCS_KEY_TIMESTOP, false, false, false);
-		_keyBindingPerActionType[ActionType::SkipFrames] = new ActionData("SkipFrames", IGCS_KEY_SKIP_FRAMES, false, false, false);
-
-		_keyBindingPerActionType[ActionType::TimeOfDayEarlier] = new ActionData("TimeOfDayEarlier", IGCS_KEY_TOD_EARLIER, false, false, false);
-		_keyBindingPerActionType[ActionType::TimeOfDayLater] = new ActionData("TimeOfDayLater", IGCS_KEY_TOD_EARLIER, false, false, false);
+		addActionData(ActionType::BlockInput, new ActionData("BlockInput", IGCS_KEY_BLOCK_INPUT, false, false, false));
+		addActionData(ActionType::CameraEnable, new ActionData("CameraEnable", IGCS_KEY_CAMERA_ENABLE, false, false, false));
+		addActionData(ActionType::CameraLock, new ActionData("CameraLock", IGCS_KEY_CAMERA_LOCK, false, false, false));
+		addActionData(ActionType::FovDecrease, new ActionData("FovDecrease", IGCS_KEY_FOV_DECREASE, false, false, false));
+		addActionData(ActionType::FovIncrease, new ActionData("FovIncrease", IGCS_KEY_FOV_INCREASE, false, false, false));
+		addActionData(ActionType::FovReset, new ActionData("FovReset", IGCS_KEY_FOV_RESET, false, false, false));
+		addActionData(ActionType::MoveBackward, new ActionData("MoveBackward", IGCS_KEY_MOVE_BACKWARD, false, false, false));
+		addActionData(ActionType::MoveDown, new ActionData("MoveDown", IGCS_KEY_MOVE_DOWN, false, false, false));
+		addActionData(ActionType::MoveForward, new ActionData("MoveForward", IGCS_KEY_MOVE_FORWARD, false, false, false));
+		addActionData(ActionType::MoveLeft, new ActionData("MoveLeft", IGCS_KEY_MOVE_LEFT, false, false, false));
+		addActionData(ActionType::MoveRight, new ActionData("MoveRight", IGCS_KEY_MOVE_RIGHT, false, false, false));
+		addActionData(ActionType::MoveUp, new ActionData("MoveUp", IGCS_KEY_MOVE_UP, false, false, false));
+		addActionData(ActionType::RotateDown, new ActionData("RotateDown", IGCS_KEY_ROTATE_DOWN, false, false, false));
+		addActionData(ActionType::RotateLeft, new ActionData("RotateLeft", IGCS_KEY_ROTATE_LEFT, false, false, false));
+		addActionData(ActionType::RotateRight, new ActionData("RotateRight", IGCS_KEY_ROTATE_RIGHT, false, false, false));
+		addActionData(ActionType::RotateUp, new ActionData("RotateUp", IGCS_KEY_ROTATE_UP, false, false, false));
+		addActionData(ActionType::TiltLeft, new ActionData("TiltLeft", IGCS_KEY_TILT_LEFT, false, false, false));
+		addActionData(ActionType::TiltRight, new ActionData("TiltRight", IGCS_KEY_TILT_RIGHT, false, false, false));
+		addActionData(ActionType::ResetTilt, new ActionData("ResetTilt", IGCS_KEY_RESET_TILT, false, false, false));
+		addActionData(ActionType::HudToggle, new ActionData("HudToggle", IGCS_KEY_HUD_TOGGLE, false, false, false));
+		addActionData(ActionType::Timestop, new ActionData("Timestop", IGCS_KEY_TIMESTOP, false, false, false));
+		addActionData(ActionType::SkipFrames, new ActionData("SkipFrames", IGCS_KEY_SKIP_FRAMES, false, false, false));
+
+		addActionData(ActionType::TimeOfDayEarlier, new ActionData("TimeOfDayEarlier", IGCS_KEY_TOD_EARLIER, false, false, false));
+		addActionData(ActionType::TimeOfDayLater, new ActionData("TimeOfDayLater", IGCS_KEY_TOD_EARLIER, false, false, false));
 
 		// Bindings which are often optional. Specify 'false' for available to disable it if the binding should be hidden.
 		// To enable the commands, remove the last 'false' in the calls below to make them available for code. (they're currently not available)
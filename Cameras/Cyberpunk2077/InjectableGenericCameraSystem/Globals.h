@@ -29,23 +29,25 @@
 #include "stdafx.h"
 #include "Gamepad.h"
 #include "Defaults.h"
-#include <map>
 #include <atomic>
 #include "ActionData.h"
-#include <map>
 #include "Settings.h"
+#include "CameraPoseSeqLock.h"
+#include "SpscRing.h"
+#include "PipeMessageQueue.h"
 
 extern "C" uint8_t g_cameraEnabled;
 extern "C" uint8_t g_wetness_OverrideParameters;
 extern "C" float g_wetness_StreetWetnessFactor;
-extern "C" LPBYTE g_pmStructAddress;
-extern "C" LPBYTE g_activeCamStructAddress;
-extern "C" LPBYTE g_resolutionStructAddress;
-extern "C" LPBYTE g_todStructAddress;
-extern "C" LPBYTE g_playHudWidgetAddress;
-extern "C" LPBYTE g_pmHudWidgetAddress;
-extern "C" LPBYTE g_timestopStructAddress;
-extern "C" LPBYTE g_weatherStructAddress;
+extern "C" uint8_t* g_pmStructAddress;
+extern "C" uint8_t* g_activeCamStructAddress;
+extern "C" uint8_t* g_resolutionStructAddress;
+extern "C" uint8_t* g_todStructAddress;
+extern "C" uint8_t* g_playHudWidgetAddress;
+extern "C" uint8_t* g_pmHudWidgetAddress;
+extern "C" uint8_t* g_timestopStructAddress;
+extern "C" uint8_t* g_weatherStructAddress;
+extern "C" IGCS::CameraPoseSeqLock g_cameraPose;
 
 namespace IGCS
 {
@@ -61,8 +63,14 @@ namespace IGCS
 		void inputBlocked(bool value) { _inputBlocked = value; }
 		bool systemActive() const { return _systemActive; }
 		void systemActive(bool value) { _systemActive = value; }
+		bool unloadRequested() const { return _unloadRequested; }
+		void unloadRequested(bool value) { _unloadRequested = value; }
+#ifdef _WIN32
 		HWND mainWindowHandle() const { return _mainWindowHandle; }
 		void mainWindowHandle(HWND handle) { _mainWindowHandle = handle; }
+#endif
+		bool hudVisible() const { return _hudVisible; }
+		void hudVisible(bool value) { _hudVisible = value; }
 		bool toggleHudVisible()
 		{
 			_hudVisible = !_hudVisible;
@@ -73,18 +81,29 @@ namespace IGCS
 		bool keyboardMouseControlCamera() const { return _settings.cameraControlDevice == DEVICE_ID_KEYBOARD_MOUSE || _settings.cameraControlDevice == DEVICE_ID_ALL; }
 		bool controllerControlsCamera() const { return _settings.cameraControlDevice == DEVICE_ID_GAMEPAD || _settings.cameraControlDevice == DEVICE_ID_ALL; }
 		ActionData* getActionData(ActionType type);
-		void handleSettingMessage(uint8_t payload[], DWORD payloadLength);
-		void handleKeybindingMessage(uint8_t payload[], DWORD payloadLength);
+		uint32_t keyBindingsVersion() const { return _keyBindingsVersion; }
+		void setKeyBinding(ActionType type, uint8_t keyCode, bool altRequired, bool ctrlRequired, bool shiftRequired);
+		void queueMessage(uint8_t payload[], uint32_t payloadLength);
+		bool dequeueMessage(PipeMessage& message);
+		void applyMessage(const PipeMessage& message);
 
 	private:
+		void handleSettingMessage(uint8_t payload[], uint32_t payloadLength);
+		void handleKeybindingMessage(uint8_t payload[], uint32_t payloadLength);
 		void initializeKeyBindings();
+		void addActionData(ActionType type, ActionData* data);
 
 		bool _inputBlocked = true;
 		atomic_bool _systemActive = false;
+		atomic_bool _unloadRequested = false;		// set by the client, makes the system remove its hooks and unload the dll when it stops.
 		Gamepad _gamePad;
+#ifdef _WIN32
 		HWND _mainWindowHandle;
+#endif
 		Settings _settings;
-		map<ActionType, ActionData*> _keyBindingPerActionType;
+		ActionData* _keyBindingPerActionType[static_cast<int>(ActionType::Amount)] = {};
+		atomic<uint32_t> _keyBindingsVersion = 0;		// incremented when a key binding changes
 		bool _hudVisible = true;
+		SpscRing<PipeMessage, 64> _queuedMessages;		// filled by the named pipe thread, emptied by the camera thread
 	};
 }
\ No newline at end of file
@@ -0,0 +1,387 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "HookTransaction.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace IGCS
+{
+	static std::atomic<uint64_t> nextTransactionId{ 1 };
+
+	static std::string formatError(const char* fmt, ...)
+	{
+		char buffer[512];
+		va_list args;
+		va_start(args, fmt);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
+		va_end(args);
+		return std::string(buffer);
+	}
+
+
+	HookTransaction::HookTransaction() : _isApplied{ false }, _id{ 0 }
+	{
+	}
+
+
+	HookTransaction::~HookTransaction()
+	{
+	}
+
+
+	// Stages a patch which is written as-is, without checking what's currently at the address.
+	void HookTransaction::stagePatch(uint8_t* address, const uint8_t* bytesToWrite, size_t length, std::string description)
+	{
+		stagePatch(address, bytesToWrite, length, nullptr, nullptr, nullptr, 0, description);
+	}
+
+
+	// Stages a patch which is only written if the bytes at expectedBytesAddress still match expectedBytes, using expectedMask to skip wildcards.
+	void HookTransaction::stagePatch(uint8_t* address, const uint8_t* bytesToWrite, size_t length, uint8_t* expectedBytesAddress, const uint8_t* expectedBytes,
+									 const char* expectedMask, size_t expectedLength, std::string description)
+	{
+		StagedPatch toAdd;
+		toAdd.address = address;
+		if (nullptr != bytesToWrite)
+		{
+			toAdd.bytesToWrite.assign(bytesToWrite, bytesToWrite + length);
+		}
+		toAdd.expectedBytesAddress = nullptr;
+		if (nullptr != expectedBytesAddress && nullptr != expectedBytes && nullptr != expectedMask && expectedLength > 0)
+		{
+			toAdd.expectedBytesAddress = expectedBytesAddress;
+			toAdd.expectedBytes.assign(expectedBytes, expectedBytes + expectedLength);
+			toAdd.expectedMask.assign(expectedMask, expectedLength);
+		}
+		toAdd.description = description;
+		_patches.push_back(toAdd);
+	}
+
+
+	// Marks the transaction as failed, e.g. because a patch couldn't be created, so validate() fails and nothing is written.
+	void HookTransaction::fail(std::string reason)
+	{
+		if (_failureReason.empty())
+		{
+			_failureReason = reason;
+		}
+	}
+
+
+	// Records memory a patch of this transaction jumps to, so it's released with the transaction.
+	void HookTransaction::addStub(uint8_t* address, size_t length)
+	{
+		_stubs.push_back(StubAllocation{ address, length });
+	}
+
+
+	// Checks whether all staged patches can be applied: they have to have an address and bytes, can't overlap each other and the bytes they
+	// expect have to be present. If so, the bytes which will be overwritten are stored for restore(). Nothing is written.
+	bool HookTransaction::validate()
+	{
+		_lastError = "";
+		if (_isApplied)
+		{
+			_lastError = "The transaction has already been applied.";
+			return false;
+		}
+		if (!_failureReason.empty())
+		{
+			_lastError = _failureReason;
+			return false;
+		}
+		for (auto& patch : _patches)
+		{
+			if (nullptr == patch.address || patch.bytesToWrite.empty())
+			{
+				_lastError = formatError("Patch '%s' has no address or no bytes to write.", patch.description.c_str());
+				return false;
+			}
+			if (nullptr == patch.expectedBytesAddress)
+			{
+				continue;
+			}
+			for (size_t i = 0; i < patch.expectedBytes.size(); i++)
+			{
+				if (patch.expectedMask[i] == 'x' && patch.expectedBytesAddress[i] != patch.expectedBytes[i])
+				{
+					_lastError = formatError("Patch '%s': byte at %p is %02X, expected %02X. The code was changed after it was scanned.", patch.description.c_str(), 
+											 (void*)(patch.expectedBytesAddress + i), patch.expectedBytesAddress[i], patch.expectedBytes[i]);
+					return false;
+				}
+			}
+		}
+		// sort a list of indices on address so overlapping patches end up next to each other.
+		std::vector<size_t> indices(_patches.size());
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			indices[i] = i;
+		}
+		std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) { return _patches[a].address < _patches[b].address; });
+		for (size_t i = 1; i < indices.size(); i++)
+		{
+			StagedPatch& previous = _patches[indices[i - 1]];
+			StagedPatch& current = _patches[indices[i]];
+			if (previous.address + previous.bytesToWrite.size() > current.address)
+			{
+				_lastError = formatError("Patch '%s' overlaps with patch '%s'.", current.description.c_str(), previous.description.c_str());
+				return false;
+			}
+		}
+		for (auto& patch : _patches)
+		{
+			patch.originalBytes.assign(patch.address, patch.address + patch.bytesToWrite.size());
+		}
+		return true;
+	}
+
+
+	// Checks whether the applied patches are still in place, so restore() won't overwrite code someone else has patched after us.
+	bool HookTransaction::validateRollback()
+	{
+		_lastError = "";
+		if (!_isApplied)
+		{
+			_lastError = "The transaction hasn't been applied.";
+			return false;
+		}
+		for (auto& patch : _patches)
+		{
+			if (memcmp(patch.address, patch.bytesToWrite.data(), patch.bytesToWrite.size()) != 0)
+			{
+				_lastError = formatError("Patch '%s' at %p has been overwritten after it was applied.", patch.description.c_str(), (void*)patch.address);
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// Returns the start addresses of all the pages the staged patches write to, sorted and without duplicates. pageSize has to be a power of 2.
+	std::vector<uintptr_t> HookTransaction::pagesToUnprotect(size_t pageSize)
+	{
+		std::vector<uintptr_t> toReturn;
+		uintptr_t pageMask = ~(static_cast<uintptr_t>(pageSize) - 1);
+		for (auto& patch : _patches)
+		{
+			if (nullptr == patch.address || patch.bytesToWrite.empty())
+			{
+				continue;
+			}
+			uintptr_t firstPage = reinterpret_cast<uintptr_t>(patch.address) & pageMask;
+			uintptr_t lastPage = (reinterpret_cast<uintptr_t>(patch.address) + patch.bytesToWrite.size() - 1) & pageMask;
+			for (uintptr_t page = firstPage; page <= lastPage; page += pageSize)
+			{
+				toReturn.push_back(page);
+			}
+		}
+		std::sort(toReturn.begin(), toReturn.end());
+		toReturn.erase(std::unique(toReturn.begin(), toReturn.end()), toReturn.end());
+		return toReturn;
+	}
+
+
+	// Writes all staged patches. The pages have to be writable and validate() has to have succeeded.
+	void HookTransaction::apply()
+	{
+		for (auto& patch : _patches)
+		{
+			memcpy(patch.address, patch.bytesToWrite.data(), patch.bytesToWrite.size());
+		}
+		_isApplied = true;
+		_id = nextTransactionId++;
+	}
+
+
+	// Writes back the original bytes of all patches, in reverse order. The pages have to be writable.
+	void HookTransaction::restore()
+	{
+		for (auto it = _patches.rbegin(); it != _patches.rend(); ++it)
+		{
+			memcpy(it->address, it->originalBytes.data(), it->originalBytes.size());
+		}
+		_isApplied = false;
+	}
+
+
+	// Removes all staged patches and stubs. Doesn't restore or release anything.
+	void HookTransaction::clear()
+	{
+		_patches.clear();
+		_stubs.clear();
+		_isApplied = false;
+		_id = 0;
+		_failureReason = "";
+		_lastError = "";
+	}
+
+
+	// Returns the lowest address written to by the staged patches, for flushing the instruction cache in one go.
+	uint8_t* HookTransaction::codeRangeStart()
+	{
+		uint8_t* toReturn = nullptr;
+		for (auto& patch : _patches)
+		{
+			if (nullptr == toReturn || patch.address < toReturn)
+			{
+				toReturn = patch.address;
+			}
+		}
+		return toReturn;
+	}
+
+
+	// Returns the number of bytes from codeRangeStart() up to and including the last byte written by the staged patches.
+	size_t HookTransaction::codeRangeLength()
+	{
+		uint8_t* start = codeRangeStart();
+		uint8_t* end = start;
+		for (auto& patch : _patches)
+		{
+			end = (std::max)(end, patch.address + patch.bytesToWrite.size());
+		}
+		return static_cast<size_t>(end - start);
+	}
+
+
+	// Returns true if address is inside a patch but not at its first byte. A thread which is about to execute an instruction there while the
+	// patch is written would execute a mix of the old and the new instructions, so the patch can't be written until it has moved on.
+	bool HookTransaction::isInsidePatch(const uint8_t* address)
+	{
+		for (auto& patch : _patches)
+		{
+			if (address > patch.address && address < patch.address + patch.bytesToWrite.size())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	// Returns true if address is inside one of the stubs of this transaction, e.g. because a thread is executing it.
+	bool HookTransaction::isInsideStub(const uint8_t* address)
+	{
+		for (auto& stub : _stubs)
+		{
+			if (address >= stub.address && address < stub.address + stub.length)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	// Returns true if a patch of this transaction writes to a byte a patch of the other transaction writes to.
+	bool HookTransaction::overlaps(HookTransaction& other)
+	{
+		for (auto& patch : _patches)
+		{
+			for (auto& otherPatch : other._patches)
+			{
+				if (patch.address < otherPatch.address + otherPatch.bytesToWrite.size() && otherPatch.address < patch.address + patch.bytesToWrite.size())
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+
+	HookJournal::HookJournal()
+	{
+	}
+
+
+	HookJournal::~HookJournal()
+	{
+	}
+
+
+	// Returns true if the transaction doesn't overlap any recorded transaction, so it can be applied and recorded.
+	bool HookJournal::canRecord(HookTransaction& transaction)
+	{
+		for (auto& recorded : _transactions)
+		{
+			if (recorded.overlaps(transaction))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// Stores a copy of an applied transaction. Transactions which haven't been applied, have no patches or overlap a recorded transaction
+	// aren't stored, in which case false is returned.
+	bool HookJournal::record(const HookTransaction& transaction)
+	{
+		HookTransaction toAdd = transaction;
+		if (!toAdd.isApplied() || toAdd.numberOfPatches() <= 0 || !canRecord(toAdd))
+		{
+			return false;
+		}
+		_transactions.push_back(toAdd);
+		return true;
+	}
+
+
+	// Removes the copy of a transaction which has been rolled back by its owner: the copy made when it was applied, which has the same id.
+	void HookJournal::forget(HookTransaction& transaction)
+	{
+		auto toRemove = std::find_if(_transactions.begin(), _transactions.end(), [&](HookTransaction& recorded) { return recorded.id() == transaction.id(); });
+		if (toRemove != _transactions.end())
+		{
+			_transactions.erase(toRemove);
+		}
+	}
+
+
+	// Rolls back all recorded transactions, newest first, using rollbackFunc. Returns the number of transactions which couldn't be rolled
+	// back, e.g. because their patches were overwritten by someone else. Those stay in the journal, as the game can still end up in our code
+	// through them.
+	int HookJournal::rollbackAll(const std::function<bool(HookTransaction&)>& rollbackFunc)
+	{
+		std::vector<HookTransaction> notRolledBack;
+		for (auto it = _transactions.rbegin(); it != _transactions.rend(); ++it)
+		{
+			if (!rollbackFunc(*it))
+			{
+				notRolledBack.insert(notRolledBack.begin(), *it);
+			}
+		}
+		_transactions = notRolledBack;
+		return static_cast<int>(notRolledBack.size());
+	}
+}
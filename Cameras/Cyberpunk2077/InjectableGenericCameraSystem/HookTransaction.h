@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace IGCS
+{
+	// A single change to the game's code: the bytes to write at address and, optionally, the bytes which have to be present in the image
+	// before anything is written. The expected bytes don't have to cover the bytes to write: for a hook they're the pattern of the AOB block.
+	struct StagedPatch
+	{
+		uint8_t* address;
+		std::vector<uint8_t> bytesToWrite;
+		std::vector<uint8_t> originalBytes;			// filled by validate(), used by restore()
+		uint8_t* expectedBytesAddress;				// nullptr if there's nothing to validate
+		std::vector<uint8_t> expectedBytes;
+		std::string expectedMask;					// 'x' for a byte which has to match, '?' for a byte to skip.
+		std::string description;
+	};
+
+
+	// Memory taken for code a transaction's patches jump to, e.g. a capture stub. Owned by the transaction until it's committed, so it can be
+	// released again if the transaction fails or is rolled back.
+	struct StubAllocation
+	{
+		uint8_t* address;
+		size_t length;
+	};
+
+
+	// Collects patches to the game's code so they can be validated up front, applied in one batch and rolled back in one go. This class only
+	// plans and copies bytes and doesn't touch memory protection, threads or the instruction cache, so it's usable on plain byte buffers:
+	// GameImageHooker::commit/rollback suspend the game's other threads, make the pages returned by pagesToUnprotect writable, call
+	// apply/restore and flush the cache once.
+	class HookTransaction
+	{
+	public:
+		HookTransaction();
+		~HookTransaction();
+
+		void stagePatch(uint8_t* address, const uint8_t* bytesToWrite, size_t length, std::string description);
+		void stagePatch(uint8_t* address, const uint8_t* bytesToWrite, size_t length, uint8_t* expectedBytesAddress, const uint8_t* expectedBytes,
+						const char* expectedMask, size_t expectedLength, std::string description);
+		void fail(std::string reason);
+		void addStub(uint8_t* address, size_t length);
+		bool validate();
+		bool validateRollback();
+		std::vector<uintptr_t> pagesToUnprotect(size_t pageSize);
+		void apply();
+		void restore();
+		void clear();
+		uint8_t* codeRangeStart();
+		size_t codeRangeLength();
+		bool isInsidePatch(const uint8_t* address);
+		bool isInsideStub(const uint8_t* address);
+		bool overlaps(HookTransaction& other);
+
+		int numberOfPatches() { return static_cast<int>(_patches.size()); }
+		bool isApplied() { return _isApplied; }
+		// Unique per apply(), so a copy of the transaction can be told apart from a copy of an earlier or later application. 0 if never applied.
+		uint64_t id() { return _id; }
+		std::vector<StubAllocation>& stubs() { return _stubs; }
+		std::string lastError() { return _lastError; }
+
+	private:
+		std::vector<StagedPatch> _patches;
+		std::vector<StubAllocation> _stubs;
+		bool _isApplied;
+		uint64_t _id;
+		std::string _failureReason;		// set if a patch couldn't be staged, so the transaction won't be applied partially
+		std::string _lastError;
+	};
+
+
+	// Keeps a copy of every transaction which has been applied to the game's code, with the original bytes of its patches, so all patches
+	// can be undone when the dll is unloaded. The transactions in the journal never overlap: a transaction which writes to a byte a recorded
+	// transaction has patched is refused, so it has to be checked with canRecord before it's applied. The original bytes of every recorded
+	// patch are therefore the game's own bytes, and restoring them in any order gives the game its original code back.
+	class HookJournal
+	{
+	public:
+		HookJournal();
+		~HookJournal();
+
+		bool canRecord(HookTransaction& transaction);
+		bool record(const HookTransaction& transaction);
+		void forget(HookTransaction& transaction);
+		int rollbackAll(const std::function<bool(HookTransaction&)>& rollbackFunc);
+
+		int numberOfTransactions() { return static_cast<int>(_transactions.size()); }
+
+	private:
+		std::vector<HookTransaction> _transactions;
+	};
+}
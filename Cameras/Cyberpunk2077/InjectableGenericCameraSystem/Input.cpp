@@ -30,117 +30,89 @@
 #include "Globals.h"
 #include <atomic>
 #include "MessageHandler.h"
+#include "ActionEvaluator.h"
+#include "MouseInputAccumulator.h"
+#include "MessageClassifier.h"
+#include "SpscRing.h"
+#include "Defaults.h"
 
 namespace IGCS::Input
 {
 	using namespace std;
 
-	// The key/mouse states are unprotected for write/read. This is initially bad, but protecting it with a mutex is difficult as the present call
-	// will read it and multiple calls from that thread causes mutex problems. For now they're unprotected (not that bad, the next frame it will be corrected anyway).
-	static uint8_t g_keyStates[256];		// 0x0==nothing, 0x88==key is down this frame, 0x08==key is released, 0x80==key was down previous frame.
-	static uint8_t g_mouseButtonStates[3];	// 0x0==nothing, 0x88==button is down this frame, 0x08==button is released, 0x80==button was down previous frame.
-	static short g_mouseWheelDelta = 0;
-	static atomic_long _deltaMouseX = 0;
-	static atomic_long _deltaMouseY = 0;
-	
-	void setMouseButtonState(int button, bool down);
-
-	
-	bool isActionActivated(ActionType type)
-	{
-		return isActionActivated(type, false);
-	}
+	// The thread handling the window messages and the camera thread don't share any state other than the lock free accumulator and ring below.
+	// the keys which went down according to the key messages, passed to the camera thread, which adds them to the next keyboard snapshot.
+	static SpscRing<uint8_t, 256> _keysPressed;
+	// the raw mouse events are collected in the accumulator by the thread handling the window messages. The camera thread consumes them
+	// once per tick.
+	static MouseInputAccumulator _mouseInputAccumulator;
 
 
-	// altCtrlOptional is only effective for actions which don't have alt/ctrl/shift as a required key. Actions which do have one or more of these
-	// keys as required, will ignore altCtrlShiftOptional and always test for these keys. 
-	bool isActionActivated(ActionType type, bool altCtrlOptional)
+	// Takes a snapshot of the keyboard for the next tick. Camera thread only.
+	void captureKeyboard(KeyboardSnapshot& snapshot)
 	{
-		ActionData* data = Globals::instance().getActionData(type);
-		if (nullptr == data)
+		// same key states as GetKeyState returns, for all keys in one call.
+		uint8_t keyStates[256];
+		if (GetKeyboardState(keyStates))
 		{
-			return false;
+			snapshot.setFromKeyStates(keyStates);
 		}
-		return data->isActive(altCtrlOptional);
-	}
-
-
-	// Resets the states in the keystates buffer by resetting their lower 4 bits. This will make sure the keystate interpretation code in NewFrame will
-	// only pick up the key when its Keydown message was received the first time. 0x88/0x08 is used as this is the way GetKeyState() is reporting states too.
-	void resetKeyStates()
-	{
-		// clear 0x08 bit on keys in keystate array so we avoid repeat issues.
-		for (int i = 0; i < 256; i++)
+		else
 		{
-			g_keyStates[i] &= ~0x08;
+			snapshot.clear();
 		}
-	}
-
-
-	void resetMouseState()
-	{
-		// clear 0x08 bit on mouse buttons in mouse state array so we avoid repeat issues.
-		for (int i = 0; i < 3; i++)
+		// a key which went down since the previous tick is down in this tick, even if it's up again already.
+		uint8_t keyPressed;
+		while (_keysPressed.pop(keyPressed))
 		{
-			g_mouseButtonStates[i] &= ~0x08;
+			snapshot.setKeyDown(keyPressed);
 		}
-		g_mouseWheelDelta = 0;
 	}
 
 
-	void setMouseButtonState(int button, bool down)
+	// Takes the mouse input which arrived since the previous tick. Call once per tick, also when the input isn't used, so it doesn't pile up.
+	// Camera thread only.
+	MouseInput captureMouseInput()
 	{
-		if (button < 0 || button >= 3)
-		{
-			return;
-		}
-		g_mouseButtonStates[button] = down ? 0x88 : 0x08;
+		return _mouseInputAccumulator.consume();
 	}
 
 
-	bool isMouseButtonDown(int button)
+	void processRawMouseData(const RAWMOUSE *rmouse)
 	{
-		if (button < 0 || button >= 3)
+		if (MOUSE_MOVE_RELATIVE == (rmouse->usFlags & MOUSE_MOVE_ABSOLUTE))
 		{
-			return false;
+			_mouseInputAccumulator.addMovement(rmouse->lLastX, rmouse->lLastY);
 		}
-		return (g_mouseButtonStates[button] & 0xF0) == 0x80;
-	}
-
-	
-	void resetMouseDeltas()
-	{
-		_deltaMouseX = 0;
-		_deltaMouseY = 0;
-		g_mouseWheelDelta = 0;
-	}
-
-
-	void processRawMouseData(const RAWMOUSE *rmouse)
-	{
-		if (MOUSE_MOVE_RELATIVE == rmouse->usFlags)
+		const USHORT buttonFlags = rmouse->usButtonFlags;
+		if (buttonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)
 		{
-			_deltaMouseX = rmouse->lLastX;
-			_deltaMouseY = rmouse->lLastY;
+			_mouseInputAccumulator.setButtonState(0, true);
+		}
+		if (buttonFlags & RI_MOUSE_LEFT_BUTTON_UP)
+		{
+			_mouseInputAccumulator.setButtonState(0, false);
+		}
+		if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)
+		{
+			_mouseInputAccumulator.setButtonState(1, true);
+		}
+		if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_UP)
+		{
+			_mouseInputAccumulator.setButtonState(1, false);
+		}
+		if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN)
+		{
+			_mouseInputAccumulator.setButtonState(2, true);
+		}
+		if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)
+		{
+			_mouseInputAccumulator.setButtonState(2, false);
+		}
+		if (buttonFlags & RI_MOUSE_WHEEL)
+		{
+			_mouseInputAccumulator.addWheel(static_cast<short>(rmouse->usButtonData));
 		}
-	}
-
-
-	long getMouseDeltaX()
-	{
-		return _deltaMouseX;
-	}
-
-
-	long getMouseDeltaY()
-	{
-		return _deltaMouseY;
-	}
-
-
-	short getMouseWheelDelta()
-	{
-		return g_mouseWheelDelta;
 	}
 
 
@@ -164,163 +136,74 @@ namespace IGCS::Input
 	}
 
 
-	// returns true if the message was handled by this method, otherwise false.
+	// Returns true if the message was handled by this method, otherwise false. Called by the thread handling the messages of the game's window
+	// only.
 	bool handleMessage(LPMSG lpMsg)
 	{
 		if (lpMsg == nullptr || lpMsg->hwnd == nullptr)
 		{
 			return false;
 		}
-
-		// simply use our main window handle.
-		const HWND handleToUse = Globals::instance().mainWindowHandle();
-		if (handleToUse == nullptr)
+		const MessageKind kind = classifyMessage(lpMsg->message);
+		if (MessageKind::Irrelevant == kind || Globals::instance().mainWindowHandle() == nullptr)
 		{
 			return false;
 		}
 
-		// grab mouse position
-		ScreenToClient(static_cast<HWND>(handleToUse), &lpMsg->pt);
 		bool toReturn = false;
-		switch (lpMsg->message)
+		switch (kind)
 		{
-			case WM_INPUT:
+			case MessageKind::RawInput:
 			{
-				// Determine how big the buffer should be
-				UINT bufferSize;
-				GetRawInputData((HRAWINPUT)lpMsg->lParam, RID_INPUT, nullptr, &bufferSize, sizeof(RAWINPUTHEADER));
-				const LPBYTE lpb = new uint8_t[bufferSize];
-				// Get the raw input data
-				const UINT readSize = GetRawInputData((HRAWINPUT)lpMsg->lParam, RID_INPUT, lpb, &bufferSize, sizeof(RAWINPUTHEADER));
-				if (readSize == bufferSize)
+				// we only registered the mouse, and mouse and keyboard input fit in a RAWINPUT, so a buffer on the stack is enough. Larger 
+				// (HID) input makes GetRawInputData fail, and it's then ignored.
+				RAWINPUT rawData;
+				UINT bufferSize = sizeof(rawData);
+				const UINT readSize = GetRawInputData((HRAWINPUT)lpMsg->lParam, RID_INPUT, &rawData, &bufferSize, sizeof(RAWINPUTHEADER));
+				if (readSize != static_cast<UINT>(-1) && readSize >= sizeof(RAWINPUTHEADER))
 				{
-					RAWINPUT* pRawData = (RAWINPUT*)lpb;
 					// Process the Mouse Messages
-					if (pRawData->header.dwType == RIM_TYPEMOUSE)
+					if (rawData.header.dwType == RIM_TYPEMOUSE)
 					{
-						processRawMouseData(&pRawData->data.mouse);
-						// check mouse buttons / wheel.
-						if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)
-						{
-							setMouseButtonState(0, true);
-						}
-						else
-						{
-							if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_UP)
-							{
-								setMouseButtonState(0, false);
-							}
-						}
-						if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)
-						{
-							setMouseButtonState(1, true);
-						}
-						else
-						{
-							if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_UP)
-							{
-								setMouseButtonState(1, false);
-							}
-						}
-						if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN)
-						{
-							setMouseButtonState(2, true);
-						}
-						else
-						{
-							if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)
-							{
-								setMouseButtonState(2, false);
-							}
-						}
-						if (pRawData->data.mouse.usButtonFlags & RI_MOUSE_WHEEL)
-						{
-							g_mouseWheelDelta += static_cast<short>(pRawData->data.mouse.usButtonData) / WHEEL_DELTA;
-						}
+						processRawMouseData(&rawData.data.mouse);
 					}
-					if (pRawData->header.dwType == RIM_TYPEKEYBOARD && IGCS_SUPPORT_RAWKEYBOARDINPUT)
+					if (rawData.header.dwType == RIM_TYPEKEYBOARD && IGCS_SUPPORT_RAWKEYBOARDINPUT)
 					{
 						// convert keyboard input to keypress/keydown.
-						if (pRawData->data.keyboard.VKey != 0xFF)
+						if (rawData.data.keyboard.VKey < 0xFF && (rawData.data.keyboard.Flags & RI_KEY_BREAK) == 0)
 						{
-							g_keyStates[pRawData->data.keyboard.VKey] = (pRawData->data.keyboard.Flags & RI_KEY_BREAK) == 0 ? 0x88 : 0x08;
+							_keysPressed.push(static_cast<uint8_t>(rawData.data.keyboard.VKey));
 						}
 					}
 				}
-				delete[] lpb;
 				toReturn = true;
 			}
 			break;
 			// simply return true for all messages related to mouse / keyboard so they won't reach the message pump of the main window. 
-			case WM_KEYDOWN:
+			case MessageKind::KeyDown:
 				if (lpMsg->wParam < 256)
 				{
-					g_keyStates[lpMsg->wParam] = 0x88;
+					_keysPressed.push(static_cast<uint8_t>(lpMsg->wParam));
 				}
 				toReturn = true;
 				break;
-			case WM_KEYUP:
-				if (lpMsg->wParam < 256)
-				{
-					g_keyStates[lpMsg->wParam] = 0x08;
-				}
+			case MessageKind::KeyUp:
 				toReturn = true;
 				break;
-			case WM_SYSKEYDOWN:
+			case MessageKind::SysKeyDown:
 				if (IGCS_SUPPORT_RAWKEYBOARDINPUT)
 				{
 					if (lpMsg->wParam < 256)
 					{
-						g_keyStates[lpMsg->wParam] = 0x88;
+						_keysPressed.push(static_cast<uint8_t>(lpMsg->wParam));
 					}
 					toReturn = true;
 				}
 				break;
-			case WM_SYSKEYUP:
-				if (IGCS_SUPPORT_RAWKEYBOARDINPUT)
-				{
-					if (lpMsg->wParam < 256)
-					{
-						g_keyStates[lpMsg->wParam] = 0x08;
-					}
-					toReturn = true;
-				}
+			case MessageKind::SysKeyUp:
+				toReturn = IGCS_SUPPORT_RAWKEYBOARDINPUT;
 				break;
-			case WM_CAPTURECHANGED:
-			case WM_LBUTTONDBLCLK:
-			case WM_LBUTTONDOWN:
-			case WM_MBUTTONDBLCLK:
-			case WM_MBUTTONDOWN:
-			case WM_MBUTTONUP:
-			case WM_MOUSEACTIVATE:
-			case WM_MOUSEHOVER:
-			case WM_MOUSEHWHEEL:
-			case WM_MOUSEMOVE:
-			case WM_MOUSELEAVE:
-			case WM_MOUSEWHEEL:
-			case WM_NCHITTEST:
-			case WM_NCLBUTTONDBLCLK:
-			case WM_NCLBUTTONDOWN:
-			case WM_NCLBUTTONUP:
-			case WM_NCMBUTTONDBLCLK:
-			case WM_NCMBUTTONDOWN:
-			case WM_NCMBUTTONUP:
-			case WM_NCMOUSEHOVER:
-			case WM_NCMOUSELEAVE:
-			case WM_NCMOUSEMOVE:
-			case WM_NCRBUTTONDBLCLK:
-			case WM_NCRBUTTONDOWN:
-			case WM_NCRBUTTONUP:
-			case WM_NCXBUTTONDBLCLK:
-			case WM_NCXBUTTONDOWN:
-			case WM_NCXBUTTONUP:
-			case WM_RBUTTONDBLCLK:
-			case WM_RBUTTONDOWN:
-			case WM_RBUTTONUP:
-			case WM_XBUTTONDBLCLK:
-			case WM_XBUTTONDOWN:
-			case WM_XBUTTONUP:
-			case WM_LBUTTONUP:
+			case MessageKind::Mouse:
 				// say we handled it, so the host won't see it
 				toReturn = true;
 				break;
@@ -28,19 +28,41 @@
 #pragma once
 #include "stdafx.h"
 #include "ActionData.h"
+#include "ActionEvaluator.h"
+#include "MouseInputAccumulator.h"
 
 namespace IGCS::Input
 {
+	// What Input keeps from one tick to the next, so a recorded session can be replayed from the middle.
+	struct InputState
+	{
+		bool actionDown[static_cast<int>(ActionType::Amount)];
+		int64_t actionNextRepeatTime[static_cast<int>(ActionType::Amount)];
+		int32_t mouseWheelRemainder;
+	};
+
+	void captureKeyboard(KeyboardSnapshot& snapshot);
+	MouseInput captureMouseInput();
+	void applyMouseInput(const MouseInput& mouseInput);
 	long getMouseDeltaX();
 	long getMouseDeltaY();
+#ifdef _WIN32
+	// raw input and window messages only reach the camera dll
 	void processRawMouseData(const RAWMOUSE *rmouse);
-	void resetMouseDeltas();
 	bool handleMessage(LPMSG lpMsg);
+#endif
 	void registerRawInput();
-	void resetKeyStates();
-	void resetMouseState();
+	void updateActionStates(const KeyboardSnapshot& snapshot, int64_t nowInMicroseconds);
+	void resetActionStates();
 	bool isActionActivated(ActionType type);
-	bool isActionActivated(ActionType type, bool altCtrlShiftOptional);
+	bool isActionActivated(ActionType type, bool repeat);
+	bool isActionActivated(ActionType type, bool repeat, bool altCtrlOptional);
+	bool isActionDown(ActionType type, bool altCtrlOptional);
+	bool isKeyDown(int virtualKeyCode);
+	bool altPressed();
+	bool ctrlPressed();
 	bool isMouseButtonDown(int button);
 	short getMouseWheelDelta();
+	void getState(InputState& state);
+	void setState(const InputState& state);
 }
\ No newline at end of file
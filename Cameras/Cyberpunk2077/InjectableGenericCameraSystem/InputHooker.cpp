@@ -31,6 +31,8 @@
 #include "Globals.h"
 #include "input.h"
 #include "MessageHandler.h"
+#include "MessageClassifier.h"
+#include <atomic>
 
 using namespace std;
 
@@ -58,7 +60,17 @@ namespace IGCS::InputHooker
 
 	//-----------------------------------------------
 	// statics
-	static CRITICAL_SECTION _messageProcessCriticalSection;
+	static atomic<DWORD> _messageThreadId = 0;			// the thread handling the messages of the game's window
+	static atomic_int _numberOfDetoursRunning = 0;		// threads currently in one of our detours, so they can be waited for before the dll is unloaded.
+
+	static const int DETOUR_DRAIN_TIMEOUT_MS = 2000;
+	
+	// Counts a thread as running in a detour for the lifetime of the object.
+	struct DetourScope
+	{
+		DetourScope() { _numberOfDetoursRunning++; }
+		~DetourScope() { _numberOfDetoursRunning--; }
+	};
 
 	//--------------------------------------------------------------------------------------------------------------------------------
 	// Implementations
@@ -80,6 +92,7 @@ namespace IGCS::InputHooker
 	// Our own version of XInputGetState
 	DWORD WINAPI detourXInputGetState(DWORD dwUserIndex, XINPUT_STATE* pState)
 	{
+		DetourScope scope;
 		// first call the original function
 		DWORD toReturn = hookedXInputGetState(dwUserIndex, pState);
 		// check if the passed in pState is equal to our gamestate. If so, always allow.
@@ -98,6 +111,7 @@ namespace IGCS::InputHooker
 	// Our own version of GetMessageA
 	BOOL WINAPI detourGetMessageA(LPMSG lpMsg, HWND hWnd, UINT wMsgFilterMin, UINT wMsgFilterMax)
 	{
+		DetourScope scope;
 		// first call the original function
 		if (!hookedGetMessageA(lpMsg, hWnd, wMsgFilterMin, wMsgFilterMax))
 		{
@@ -110,6 +124,7 @@ namespace IGCS::InputHooker
 	// Our own version of GetMessageW
 	BOOL WINAPI detourGetMessageW(LPMSG lpMsg, HWND hWnd, UINT wMsgFilterMin, UINT wMsgFilterMax)
 	{
+		DetourScope scope;
 		// first call the original function
 		if (!hookedGetMessageW(lpMsg, hWnd, wMsgFilterMin, wMsgFilterMax))
 		{
@@ -122,6 +137,7 @@ namespace IGCS::InputHooker
 	// Our own version of PeekMessageA
 	BOOL WINAPI detourPeekMessageA(LPMSG lpMsg, HWND hWnd, UINT wMsgFilterMin, UINT wMsgFilterMax, UINT wRemoveMsg)
 	{
+		DetourScope scope;
 		// first call the original function
 		if (!hookedPeekMessageA(lpMsg, hWnd, wMsgFilterMin, wMsgFilterMax, wRemoveMsg))
 		{
@@ -133,6 +149,7 @@ namespace IGCS::InputHooker
 	// Our own version of PeekMessageW
 	BOOL WINAPI detourPeekMessageW(LPMSG lpMsg, HWND hWnd, UINT wMsgFilterMin, UINT wMsgFilterMax, UINT wRemoveMsg)
 	{
+		DetourScope scope;
 		// first call the original function
 		if (!hookedPeekMessageW(lpMsg, hWnd, wMsgFilterMin, wMsgFilterMax, wRemoveMsg))
 		{
@@ -142,10 +159,15 @@ namespace IGCS::InputHooker
 	}
 
 
+	// Called for every message the game gets or peeks, which can be thousands per frame, so everything but input messages of the game's window
+	// thread is let through without further work. Input handles the rest without locks. 
 	BOOL processMessage(LPMSG lpMsg, bool removeIfRequired)
 	{
-		EnterCriticalSection(&_messageProcessCriticalSection);
-		if (lpMsg != nullptr && Input::handleMessage(lpMsg))
+		if (lpMsg == nullptr || Input::MessageKind::Irrelevant == Input::classifyMessage(lpMsg->message) || GetCurrentThreadId() != _messageThreadId)
+		{
+			return TRUE;
+		}
+		if (Input::handleMessage(lpMsg))
 		{
 			// message was handled by our code. This means it's a message we want to block if input blocking is enabled or the overlay / menu is shown
 			if (g_cameraEnabled && Globals::instance().inputBlocked() && Globals::instance().keyboardMouseControlCamera())
@@ -153,7 +175,6 @@ namespace IGCS::InputHooker
 				lpMsg->message = WM_NULL;
 			}
 		}
-		LeaveCriticalSection(&_messageProcessCriticalSection);
 		return TRUE;
 	}
 
@@ -185,7 +206,9 @@ namespace IGCS::InputHooker
 	// Sets the input hooks for the various input related functions we defined own wrapper functions for. After a successful hook setup they're enabled. 
 	void setInputHooks()
 	{
-		InitializeCriticalSectionAndSpinCount(&_messageProcessCriticalSection, 0x400);
+		// the input messages and raw input of the game's window arrive on the thread which created it. Only that thread feeds Input, which 
+		// passes the input on to the camera thread through single producer queues.
+		_messageThreadId = GetWindowThreadProcessId(Globals::instance().mainWindowHandle(), nullptr);
 
 		setXInputHook(false);
 
@@ -223,4 +246,37 @@ namespace IGCS::InputHooker
 			MessageHandler::logError("Enabling hooks failed.");
 		}
 	}
+
+
+	// Disables and removes all MinHook hooks and waits till no thread is running in one of our detours anymore. A thread blocked in
+	// GetMessage inside a detour is woken up by posting WM_NULL to the game's window. Returns false if threads are still in a detour after
+	// the timeout, in which case the dll can't be unloaded.
+	bool removeInputHooks()
+	{
+		if (MH_DisableHook(MH_ALL_HOOKS) != MH_OK)
+		{
+			MessageHandler::logError("Disabling hooks failed.");
+			return false;
+		}
+		int waitedMs = 0;
+		while (_numberOfDetoursRunning > 0 && waitedMs < DETOUR_DRAIN_TIMEOUT_MS)
+		{
+			PostMessage(Globals::instance().mainWindowHandle(), WM_NULL, 0, 0);
+			Sleep(10);
+			waitedMs += 10;
+		}
+		if (_numberOfDetoursRunning > 0)
+		{
+			MessageHandler::logError("%d threads are still running in an input hook.", (int)_numberOfDetoursRunning);
+			return false;
+		}
+		MH_Uninitialize();
+		hookedXInputGetState = nullptr;
+		hookedGetMessageA = nullptr;
+		hookedGetMessageW = nullptr;
+		hookedPeekMessageA = nullptr;
+		hookedPeekMessageW = nullptr;
+		MessageHandler::logDebug("Input hooks removed");
+		return true;
+	}
 }
\ No newline at end of file
@@ -31,4 +31,5 @@ namespace IGCS::InputHooker
 {
 	void setInputHooks();
 	void setXInputHook(bool enableHook);
+	bool removeInputHooks();
 }
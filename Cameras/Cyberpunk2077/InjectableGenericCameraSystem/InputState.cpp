@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2019, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "Input.h"
+#include "Globals.h"
+#include "ActionStateMachine.h"
+#include "Defaults.h"
+
+namespace IGCS::Input
+{
+	using namespace std;
+
+	// The input of the current tick, as the camera thread sees it. Nothing in here is touched by the thread handling the window messages, 
+	// the tick gets its input from captureKeyboard and captureMouseInput, or from a recording.
+	static MouseInput _mouseInput = {};
+	static int32_t _mouseWheelRemainder = 0;		// wheel units which didn't add up to a notch yet
+	static short _mouseWheelNotches = 0;
+	static ActionStateMachine _actionStates(ACTION_REPEAT_DELAY_MS, ACTION_REPEAT_RATE);
+	// the keyboard as it was at the start of the tick, and the actions evaluated against it, so the key states are obtained once per tick.
+	static KeyboardSnapshot _keyboardSnapshot;
+	static ActionEvaluator _actionEvaluator;
+	static uint32_t _compiledKeyBindingsVersion = 0;
+	static bool _keyBindingsCompiled = false;
+	
+	
+	void compileKeyBindingsIfChanged()
+	{
+		uint32_t keyBindingsVersion = Globals::instance().keyBindingsVersion();
+		if (_keyBindingsCompiled && keyBindingsVersion == _compiledKeyBindingsVersion)
+		{
+			return;
+		}
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			ActionType type = static_cast<ActionType>(i);
+			_actionEvaluator.compile(type, Globals::instance().getActionData(type));
+		}
+		_compiledKeyBindingsVersion = keyBindingsVersion;
+		_keyBindingsCompiled = true;
+	}
+
+
+	// Evaluates all actions against the keyboard snapshot of the tick and feeds the result to the action state machine. Call once per tick,
+	// before the actions are tested.
+	void updateActionStates(const KeyboardSnapshot& snapshot, int64_t nowInMicroseconds)
+	{
+		compileKeyBindingsIfChanged();
+		_keyboardSnapshot = snapshot;
+		_actionEvaluator.evaluate(_keyboardSnapshot);
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			ActionType type = static_cast<ActionType>(i);
+			// alt/ctrl are tested when the action is, so e.g. alt can be held down while the key is pressed a couple of times.
+			_actionStates.update(type, _actionEvaluator.isActive(type, true), nowInMicroseconds);
+		}
+	}
+
+
+	void resetActionStates()
+	{
+		_actionStates.reset();
+	}
+
+
+	bool isActionActivated(ActionType type)
+	{
+		return isActionActivated(type, false, false);
+	}
+
+
+	bool isActionActivated(ActionType type, bool repeat)
+	{
+		return isActionActivated(type, repeat, false);
+	}
+
+
+	// Returns true if the action's keys were pressed since the previous tick or, if repeat is true, if they're held down long enough to repeat
+	// the action. For altCtrlOptional see isActionDown.
+	bool isActionActivated(ActionType type, bool repeat, bool altCtrlOptional)
+	{
+		bool activated = _actionStates.wasPressed(type) || (repeat && _actionStates.wasRepeated(type));
+		return activated && _actionEvaluator.altCtrlMatch(type, altCtrlOptional);
+	}
+
+
+	// Returns true if the action's keys are down in this tick's keyboard snapshot, for actions which last as long as the keys are held down.
+	// altCtrlOptional is only effective for actions which don't have alt/ctrl as a required key. Actions which do have one or more of these
+	// keys as required, will ignore altCtrlOptional and always test for these keys. 
+	bool isActionDown(ActionType type, bool altCtrlOptional)
+	{
+		return _actionEvaluator.isActive(type, altCtrlOptional);
+	}
+
+
+	// Returns true if the key is down in this tick's keyboard snapshot.
+	bool isKeyDown(int virtualKeyCode)
+	{
+		return _keyboardSnapshot.isKeyDown(virtualKeyCode);
+	}
+
+
+	bool altPressed()
+	{
+		return _actionEvaluator.altPressed();
+	}
+
+
+	bool ctrlPressed()
+	{
+		return _actionEvaluator.ctrlPressed();
+	}
+
+
+	// Makes the mouse input of the tick the current one. Call once per tick.
+	void applyMouseInput(const MouseInput& mouseInput)
+	{
+		_mouseInput = mouseInput;
+		// a high resolution wheel sends fractions of a notch
+		_mouseWheelRemainder += _mouseInput.wheelDelta;
+		_mouseWheelNotches = static_cast<short>(_mouseWheelRemainder / WHEEL_DELTA);
+		_mouseWheelRemainder %= WHEEL_DELTA;
+	}
+
+
+	// A button which was pressed and released again within one tick counts as down in that tick. 
+	bool isMouseButtonDown(int button)
+	{
+		if (button < 0 || button >= 3)
+		{
+			return false;
+		}
+		return ((_mouseInput.buttonsDown | _mouseInput.buttonsPressed) >> button) & 1;
+	}
+
+
+	long getMouseDeltaX()
+	{
+		return _mouseInput.deltaX;
+	}
+
+
+	long getMouseDeltaY()
+	{
+		return _mouseInput.deltaY;
+	}
+
+
+	// in notches
+	short getMouseWheelDelta()
+	{
+		return _mouseWheelNotches;
+	}
+
+
+	void getState(InputState& state)
+	{
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			_actionStates.saveActionState(static_cast<ActionType>(i), state.actionDown[i], state.actionNextRepeatTime[i]);
+		}
+		state.mouseWheelRemainder = _mouseWheelRemainder;
+	}
+
+
+	void setState(const InputState& state)
+	{
+		for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+		{
+			_actionStates.restoreActionState(static_cast<ActionType>(i), state.actionDown[i], state.actionNextRepeatTime[i]);
+		}
+		_mouseWheelRemainder = state.mouseWheelRemainder;
+	}
+}
@@ -33,35 +33,22 @@
 #include "MessageHandler.h"
 #include "CameraManipulator.h"
 #include "Globals.h"
+#include "ImageScanner.h"
 
 using namespace std;
 
 //--------------------------------------------------------------------------------------------------------------------------------
 // external asm functions
 extern "C" {
-	void pmStructAddressInterceptor();
-	void activeCamAddressInterceptor();
 	void activeCamWrite1Interceptor();
-	void resolutionStructAddressInterceptor();
-	void todStructAddressInterceptor();
-	void playHudWidgetReadInterceptor();
-	void pmHudWidgetReadInterceptor();
 	void fovPlayWriteInterceptor();
-	void timestopStructInterceptor();
 	void weatherStructInterceptor();
 }
 
 // external addresses used in asm.
 extern "C" {
-	LPBYTE _pmStructAddressInterceptionContinue = nullptr;
-	LPBYTE _activeCamAddressInterceptionContinue = nullptr;
 	LPBYTE _activeCamWrite1InterceptionContinue = nullptr;
-	LPBYTE _resolutionStructAddressInterceptionContinue = nullptr;
-	LPBYTE _todStructAddressInterceptionContinue = nullptr;
-	LPBYTE _playHudWidgetReadInterceptionContinue = nullptr;
-	LPBYTE _pmHudWidgetReadInterceptionContinue = nullptr;
 	LPBYTE _fovPlayWriteInterceptionContinue = nullptr;
-	LPBYTE _timestopStructInterceptionContinue = nullptr;
 	LPBYTE _weatherStructInterceptionContinue = nullptr;
 }
 
@@ -70,25 +57,19 @@ namespace IGCS::GameSpecific::InterceptorHelper
 {
 	void initializeAOBBlocks(LPBYTE hostImageAddress, DWORD hostImageSize, map<string, AOBBlock*> &aobBlocks)
 	{
-		aobBlocks[ACTIVECAM_ADDRESS_INTERCEPT_KEY] = new AOBBlock(ACTIVECAM_ADDRESS_INTERCEPT_KEY, "0F 11 42 10 48 8B 03 | FF 90 58 02 00 00 F3 0F 11 46 20 48 8D 54 24 20 48 8B 03 48 8B CB", 1);
-		aobBlocks[ACTIVECAM_CAMERA_WRITE1_INTERCEPT_KEY] = new AOBBlock(ACTIVECAM_CAMERA_WRITE1_INTERCEPT_KEY, "F2 0F 11 83 E0 00 00 00 0F 28 44 24 30 89 8B E8 00 00 00 0F 11 83 F0 00 00 00", 2);	// 2 entries, we need the second one
-		aobBlocks[PMSTRUCT_ADDRESS_INTERCEPT_KEY] = new AOBBlock(PMSTRUCT_ADDRESS_INTERCEPT_KEY, "49 8B 4E 40 48 8D 95 90 00 00 00 41 88 9E FB 02 00 00", 1);
-		aobBlocks[COORD_FACTOR_ADDRESS_KEY] = new AOBBlock(COORD_FACTOR_ADDRESS_KEY, "F3 44 0F 10 1D | ?? ?? ?? ?? 48 85 C0 74 38", 1);
-		aobBlocks[RESOLUTION_STRUCT_ADDRESS_INTERCEPT_KEY] = new AOBBlock(RESOLUTION_STRUCT_ADDRESS_INTERCEPT_KEY, "8B 81 84 00 00 00 89 41 44 8B 81 88 00 00 00 89 41 40", 1);
-		aobBlocks[TOD_READ_INTERCEPT_KEY] = new AOBBlock(TOD_READ_INTERCEPT_KEY, "48 8B DA 48 8B 01 FF 90 F8 00 00 00 48 8B C3", 1);
-		aobBlocks[PLAY_WIDGETBUCKET_READ_INTERCEPT_KEY] = new AOBBlock(PLAY_WIDGETBUCKET_READ_INTERCEPT_KEY, "88 81 B1 00 00 00 48 89 BC 24 98 00 00 00 48 8B 7C 24 20", 1);
-		aobBlocks[PM_WIDGETBUCKET_READ_INTERCEPT_KEY] = new AOBBlock(PM_WIDGETBUCKET_READ_INTERCEPT_KEY, "74 0A 80 7A 40 00 74 04 B3 01 EB 02 32 DB 48 8B 49 40 0F B6 D3", 1);
-		aobBlocks[FOV_PLAY_WRITE_INTERCEPT_KEY] = new AOBBlock(FOV_PLAY_WRITE_INTERCEPT_KEY, "F3 0F 11 9F 5C 02 00 00 48 8B 8F B0 01 00 00", 1);
-		aobBlocks[TIMESTOP_STRUCT_INTERCEPT_KEY] = new AOBBlock(TIMESTOP_STRUCT_INTERCEPT_KEY, "44 8B 49 1C 48 85 D2 75 07 45 85 C9", 1);
-		aobBlocks[WEATHER_STRUCT_INTERCEPT_KEY] = new AOBBlock(WEATHER_STRUCT_INTERCEPT_KEY, "F3 0F 11 96 F0 00 00 00 F3 0F 5C C2 F3 0F 10 8D 3C 0A 00 00", 1);
+		aobBlocks[ACTIVECAM_ADDRESS_INTERCEPT_KEY] = new AOBBlock(ACTIVECAM_ADDRESS_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("0F 11 42 10 48 8B 03 | FF 90 58 02 00 00 F3 0F 11 46 20 48 8D 54 24 20 48 8B 03 48 8B CB"), 1));
+		aobBlocks[ACTIVECAM_CAMERA_WRITE1_INTERCEPT_KEY] = new AOBBlock(ACTIVECAM_CAMERA_WRITE1_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("F2 0F 11 83 E0 00 00 00 0F 28 44 24 30 89 8B E8 00 00 00 0F 11 83 F0 00 00 00"), 2));	// 2 entries, we need the second one
+		aobBlocks[PMSTRUCT_ADDRESS_INTERCEPT_KEY] = new AOBBlock(PMSTRUCT_ADDRESS_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("49 8B 4E 40 48 8D 95 90 00 00 00 41 88 9E FB 02 00 00"), 1));
+		aobBlocks[COORD_FACTOR_ADDRESS_KEY] = new AOBBlock(COORD_FACTOR_ADDRESS_KEY, ScanPattern(IGCS_AOB_PATTERN("F3 44 0F 10 1D | ?? ?? ?? ?? 48 85 C0 74 38"), 1));
+		aobBlocks[RESOLUTION_STRUCT_ADDRESS_INTERCEPT_KEY] = new AOBBlock(RESOLUTION_STRUCT_ADDRESS_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("8B 81 84 00 00 00 89 41 44 8B 81 88 00 00 00 89 41 40"), 1));
+		aobBlocks[TOD_READ_INTERCEPT_KEY] = new AOBBlock(TOD_READ_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("48 8B DA 48 8B 01 FF 90 F8 00 00 00 48 8B C3"), 1));
+		aobBlocks[PLAY_WIDGETBUCKET_READ_INTERCEPT_KEY] = new AOBBlock(PLAY_WIDGETBUCKET_READ_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("88 81 B1 00 00 00 48 89 BC 24 98 00 00 00 48 8B 7C 24 20"), 1));
+		aobBlocks[PM_WIDGETBUCKET_READ_INTERCEPT_KEY] = new AOBBlock(PM_WIDGETBUCKET_READ_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("74 0A 80 7A 40 00 74 04 B3 01 EB 02 32 DB 48 8B 49 40 0F B6 D3"), 1));
+		aobBlocks[FOV_PLAY_WRITE_INTERCEPT_KEY] = new AOBBlock(FOV_PLAY_WRITE_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("F3 0F 11 9F 5C 02 00 00 48 8B 8F B0 01 00 00"), 1));
+		aobBlocks[TIMESTOP_STRUCT_INTERCEPT_KEY] = new AOBBlock(TIMESTOP_STRUCT_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("44 8B 49 1C 48 85 D2 75 07 45 85 C9"), 1));
+		aobBlocks[WEATHER_STRUCT_INTERCEPT_KEY] = new AOBBlock(WEATHER_STRUCT_INTERCEPT_KEY, ScanPattern(IGCS_AOB_PATTERN("F3 0F 11 96 F0 00 00 00 F3 0F 5C C2 F3 0F 10 8D 3C 0A 00 00"), 1));
 
-		map<string, AOBBlock*>::iterator it;
-		bool result = true;
-		for (it = aobBlocks.begin(); it != aobBlocks.end(); it++)
-		{
-			result &= it->second->scan(hostImageAddress, hostImageSize);
-		}
-		
+		bool result = ImageScanner::scanForBlocks(hostImageAddress, hostImageSize, aobBlocks);
 		if (result)
 		{
 			MessageHandler::logLine("All interception offsets found.");
@@ -102,21 +83,27 @@ namespace IGCS::GameSpecific::InterceptorHelper
 
 	void setCameraStructInterceptorHook(map<string, AOBBlock*>& aobBlocks)
 	{
-		GameImageHooker::setHook(aobBlocks[ACTIVECAM_ADDRESS_INTERCEPT_KEY], 0x10, &_activeCamAddressInterceptionContinue, &activeCamAddressInterceptor);
+		GameImageHooker::setCaptureHook(aobBlocks[ACTIVECAM_ADDRESS_INTERCEPT_KEY], CaptureDescription(X64Register::RCX, &g_activeCamStructAddress));
 	}
 
 	
 	void setPostCameraStructHooks(map<string, AOBBlock*>& aobBlocks)
 	{
-		GameImageHooker::setHook(aobBlocks[ACTIVECAM_CAMERA_WRITE1_INTERCEPT_KEY], 0x1A, &_activeCamWrite1InterceptionContinue, &activeCamWrite1Interceptor);
-		GameImageHooker::setHook(aobBlocks[PMSTRUCT_ADDRESS_INTERCEPT_KEY], (0x25B6758-0x25B6746), &_pmStructAddressInterceptionContinue, &pmStructAddressInterceptor);
-		GameImageHooker::setHook(aobBlocks[RESOLUTION_STRUCT_ADDRESS_INTERCEPT_KEY], 0x12, &_resolutionStructAddressInterceptionContinue, &resolutionStructAddressInterceptor);
-		GameImageHooker::setHook(aobBlocks[TOD_READ_INTERCEPT_KEY], (0x17461EC-0x17461DD), &_todStructAddressInterceptionContinue, &todStructAddressInterceptor);
-		GameImageHooker::setHook(aobBlocks[PLAY_WIDGETBUCKET_READ_INTERCEPT_KEY], (0x867BAA - 0x867B97), &_playHudWidgetReadInterceptionContinue, &playHudWidgetReadInterceptor);
-		GameImageHooker::setHook(aobBlocks[PM_WIDGETBUCKET_READ_INTERCEPT_KEY], (0x8BA926 - 0x8BA914), &_pmHudWidgetReadInterceptionContinue, &pmHudWidgetReadInterceptor);
-		GameImageHooker::setHook(aobBlocks[FOV_PLAY_WRITE_INTERCEPT_KEY], (0x16D4D62 - 0x16D4D53), &_fovPlayWriteInterceptionContinue, &fovPlayWriteInterceptor);
-		GameImageHooker::setHook(aobBlocks[TIMESTOP_STRUCT_INTERCEPT_KEY], (0xAB73F0 - 0xAB73E0), &_timestopStructInterceptionContinue, &timestopStructInterceptor);
-		GameImageHooker::setHook(aobBlocks[WEATHER_STRUCT_INTERCEPT_KEY], (0x111A068 - 0x111A040), &_weatherStructInterceptionContinue, &weatherStructInterceptor);
+		// stage all hooks first and write them in one go, so they're either all set or none are.
+		// Capture hooks which capture before the displaced code continue right after the instructions the jmp overwrites, decoded at runtime.
+		// The other hooks continue after the instructions their asm replicates, or after the instruction which sets the captured register,
+		// so their offsets are explicit. These are checked to be at an instruction boundary.
+		HookTransaction transaction;
+		GameImageHooker::setHook(transaction, aobBlocks[ACTIVECAM_CAMERA_WRITE1_INTERCEPT_KEY], 0x1A, &_activeCamWrite1InterceptionContinue, &activeCamWrite1Interceptor);
+		GameImageHooker::setCaptureHook(transaction, aobBlocks[PMSTRUCT_ADDRESS_INTERCEPT_KEY], CaptureDescription(X64Register::R14, &g_pmStructAddress));
+		GameImageHooker::setCaptureHook(transaction, aobBlocks[RESOLUTION_STRUCT_ADDRESS_INTERCEPT_KEY], CaptureDescription(X64Register::RBX, &g_resolutionStructAddress));
+		GameImageHooker::setCaptureHook(transaction, aobBlocks[TOD_READ_INTERCEPT_KEY], CaptureDescription(X64Register::RCX, &g_todStructAddress));
+		GameImageHooker::setCaptureHook(transaction, aobBlocks[PLAY_WIDGETBUCKET_READ_INTERCEPT_KEY], 0x13, CaptureDescription(X64Register::RDI, 0x40, &g_playHudWidgetAddress, true));
+		GameImageHooker::setCaptureHook(transaction, aobBlocks[PM_WIDGETBUCKET_READ_INTERCEPT_KEY], 0x12, CaptureDescription(X64Register::RCX, &g_pmHudWidgetAddress, true));
+		GameImageHooker::setHook(transaction, aobBlocks[FOV_PLAY_WRITE_INTERCEPT_KEY], 0x0F, &_fovPlayWriteInterceptionContinue, &fovPlayWriteInterceptor);
+		GameImageHooker::setCaptureHook(transaction, aobBlocks[TIMESTOP_STRUCT_INTERCEPT_KEY], CaptureDescription(X64Register::RCX, &g_timestopStructAddress));
+		GameImageHooker::setHook(transaction, aobBlocks[WEATHER_STRUCT_INTERCEPT_KEY], 0x28, &_weatherStructInterceptionContinue, &weatherStructInterceptor);
+		GameImageHooker::commit(transaction);
 
 		// Grab the factor from static memory.
 		LPBYTE factorAddress = Utils::calculateAbsoluteAddress(aobBlocks[COORD_FACTOR_ADDRESS_KEY], 4);
@@ -60,6 +60,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD  reason, LPVOID lpReserved)
 // lpParam gets the hModule value of the DllMain process
 DWORD WINAPI MainThread(LPVOID lpParam)
 {
+	bool unloadDll = false;
 	MODULEINFO hostModuleInfo = Utils::getModuleInfoOfContainingProcess();
 	if (nullptr == hostModuleInfo.lpBaseOfDll)
 	{
@@ -69,7 +70,13 @@ DWORD WINAPI MainThread(LPVOID lpParam)
 	{
 		System s;
 		s.start((LPBYTE)hostModuleInfo.lpBaseOfDll, hostModuleInfo.SizeOfImage);
+		// the client asks us to go away when a new build has to be injected. We can only unload if everything has been removed.
+		unloadDll = Globals::instance().unloadRequested() && s.shutdown();
 	}
 	Console::Release();
+	if (unloadDll)
+	{
+		FreeLibraryAndExitThread((HMODULE)lpParam, 0);
+	}
 	return 0;
 }
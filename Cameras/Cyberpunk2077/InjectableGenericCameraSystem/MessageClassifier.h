@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace IGCS::Input
+{
+	// What a window message is to us. Everything which isn't keyboard or mouse input is irrelevant.
+	enum class MessageKind : uint8_t
+	{
+		Irrelevant = 0,
+		RawInput,
+		KeyDown,
+		KeyUp,
+		SysKeyDown,
+		SysKeyUp,
+		Mouse,
+	};
+
+
+	// The ids of the input messages. The WM_ defines are Windows only, so they're checked against these below when building the dll.
+	constexpr unsigned int MESSAGE_ID_INPUT = 0x00FF;
+	constexpr unsigned int MESSAGE_ID_KEYDOWN = 0x0100;
+	constexpr unsigned int MESSAGE_ID_KEYUP = 0x0101;
+	constexpr unsigned int MESSAGE_ID_SYSKEYDOWN = 0x0104;
+	constexpr unsigned int MESSAGE_ID_SYSKEYUP = 0x0105;
+	constexpr unsigned int MESSAGE_ID_MOUSELEAVE = 0x02A3;			// the highest id of an input message
+	constexpr unsigned int MOUSE_MESSAGE_IDS[] = {
+		0x0215,		// WM_CAPTURECHANGED
+		0x0203,		// WM_LBUTTONDBLCLK
+		0x0201,		// WM_LBUTTONDOWN
+		0x0202,		// WM_LBUTTONUP
+		0x0209,		// WM_MBUTTONDBLCLK
+		0x0207,		// WM_MBUTTONDOWN
+		0x0208,		// WM_MBUTTONUP
+		0x0021,		// WM_MOUSEACTIVATE
+		0x02A1,		// WM_MOUSEHOVER
+		0x020E,		// WM_MOUSEHWHEEL
+		0x0200,		// WM_MOUSEMOVE
+		MESSAGE_ID_MOUSELEAVE,
+		0x020A,		// WM_MOUSEWHEEL
+		0x0084,		// WM_NCHITTEST
+		0x00A3,		// WM_NCLBUTTONDBLCLK
+		0x00A1,		// WM_NCLBUTTONDOWN
+		0x00A2,		// WM_NCLBUTTONUP
+		0x00A9,		// WM_NCMBUTTONDBLCLK
+		0x00A7,		// WM_NCMBUTTONDOWN
+		0x00A8,		// WM_NCMBUTTONUP
+		0x02A0,		// WM_NCMOUSEHOVER
+		0x02A2,		// WM_NCMOUSELEAVE
+		0x00A0,		// WM_NCMOUSEMOVE
+		0x00A6,		// WM_NCRBUTTONDBLCLK
+		0x00A4,		// WM_NCRBUTTONDOWN
+		0x00A5,		// WM_NCRBUTTONUP
+		0x00AD,		// WM_NCXBUTTONDBLCLK
+		0x00AB,		// WM_NCXBUTTONDOWN
+		0x00AC,		// WM_NCXBUTTONUP
+		0x0206,		// WM_RBUTTONDBLCLK
+		0x0204,		// WM_RBUTTONDOWN
+		0x0205,		// WM_RBUTTONUP
+		0x020D,		// WM_XBUTTONDBLCLK
+		0x020B,		// WM_XBUTTONDOWN
+		0x020C,		// WM_XBUTTONUP
+	};
+
+#ifdef _WIN32
+	constexpr unsigned int WINDOWS_MOUSE_MESSAGE_IDS[] = { WM_CAPTURECHANGED, WM_LBUTTONDBLCLK, WM_LBUTTONDOWN, WM_LBUTTONUP, WM_MBUTTONDBLCLK, 
+														   WM_MBUTTONDOWN, WM_MBUTTONUP, WM_MOUSEACTIVATE, WM_MOUSEHOVER, WM_MOUSEHWHEEL, WM_MOUSEMOVE, 
+														   WM_MOUSELEAVE, WM_MOUSEWHEEL, WM_NCHITTEST, WM_NCLBUTTONDBLCLK, WM_NCLBUTTONDOWN, WM_NCLBUTTONUP, 
+														   WM_NCMBUTTONDBLCLK, WM_NCMBUTTONDOWN, WM_NCMBUTTONUP, WM_NCMOUSEHOVER, WM_NCMOUSELEAVE, WM_NCMOUSEMOVE, 
+														   WM_NCRBUTTONDBLCLK, WM_NCRBUTTONDOWN, WM_NCRBUTTONUP, WM_NCXBUTTONDBLCLK, WM_NCXBUTTONDOWN, 
+														   WM_NCXBUTTONUP, WM_RBUTTONDBLCLK, WM_RBUTTONDOWN, WM_RBUTTONUP, WM_XBUTTONDBLCLK, WM_XBUTTONDOWN, 
+														   WM_XBUTTONUP };
+
+	constexpr bool mouseMessageIdsMatchWindows()
+	{
+		if (sizeof(MOUSE_MESSAGE_IDS) != sizeof(WINDOWS_MOUSE_MESSAGE_IDS))
+		{
+			return false;
+		}
+		for (size_t i = 0; i < sizeof(MOUSE_MESSAGE_IDS) / sizeof(MOUSE_MESSAGE_IDS[0]); i++)
+		{
+			if (MOUSE_MESSAGE_IDS[i] != WINDOWS_MOUSE_MESSAGE_IDS[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static_assert(MESSAGE_ID_INPUT == WM_INPUT && MESSAGE_ID_KEYDOWN == WM_KEYDOWN && MESSAGE_ID_KEYUP == WM_KEYUP && MESSAGE_ID_SYSKEYDOWN == WM_SYSKEYDOWN
+				  && MESSAGE_ID_SYSKEYUP == WM_SYSKEYUP, "The keyboard message ids don't match Windows'");
+	static_assert(mouseMessageIdsMatchWindows(), "The mouse message ids don't match Windows'");
+#endif
+
+
+	// The kind of every message id up to the highest input message id, built at compile time.
+	struct MessageKindTable
+	{
+		static constexpr unsigned int Size = MESSAGE_ID_MOUSELEAVE + 1;
+		MessageKind kinds[Size];
+
+		constexpr MessageKindTable() : kinds{}
+		{
+			kinds[MESSAGE_ID_INPUT] = MessageKind::RawInput;
+			kinds[MESSAGE_ID_KEYDOWN] = MessageKind::KeyDown;
+			kinds[MESSAGE_ID_KEYUP] = MessageKind::KeyUp;
+			kinds[MESSAGE_ID_SYSKEYDOWN] = MessageKind::SysKeyDown;
+			kinds[MESSAGE_ID_SYSKEYUP] = MessageKind::SysKeyUp;
+			for (unsigned int message : MOUSE_MESSAGE_IDS)
+			{
+				kinds[message] = MessageKind::Mouse;
+			}
+		}
+	};
+
+	inline constexpr MessageKindTable MESSAGE_KIND_TABLE{};
+
+
+	// Classifies a message with a compare and a table lookup, so the message hooks can let the many messages which aren't input through
+	// without doing anything else.
+	inline MessageKind classifyMessage(unsigned int message)
+	{
+		return message < MessageKindTable::Size ? MESSAGE_KIND_TABLE.kinds[message] : MessageKind::Irrelevant;
+	}
+}
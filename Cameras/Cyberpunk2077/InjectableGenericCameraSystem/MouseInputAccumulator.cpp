@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "MouseInputAccumulator.h"
+#include <algorithm>
+
+namespace IGCS
+{
+	static int32_t saturatingAdd(int32_t a, int32_t b)
+	{
+		int64_t sum = static_cast<int64_t>(a) + b;
+		return static_cast<int32_t>((std::min)((std::max)(sum, static_cast<int64_t>(INT32_MIN)), static_cast<int64_t>(INT32_MAX)));
+	}
+
+
+	MouseInputAccumulator::MouseInputAccumulator() : _movement(0), _wheelDelta(0), _buttonsDown(0), _buttonsPressed(0), _buttonsReleased(0)
+	{
+	}
+
+
+	MouseInputAccumulator::~MouseInputAccumulator()
+	{
+	}
+
+
+	void MouseInputAccumulator::addMovement(int32_t deltaX, int32_t deltaY)
+	{
+		if (0 == deltaX && 0 == deltaY)
+		{
+			return;
+		}
+		uint64_t current = _movement.load();
+		uint64_t updated;
+		do
+		{
+			int32_t currentX = static_cast<int32_t>(static_cast<uint32_t>(current));
+			int32_t currentY = static_cast<int32_t>(static_cast<uint32_t>(current >> 32));
+			updated = packMovement(saturatingAdd(currentX, deltaX), saturatingAdd(currentY, deltaY));
+		} while (!_movement.compare_exchange_weak(current, updated));
+	}
+
+
+	void MouseInputAccumulator::addWheel(int32_t wheelDelta)
+	{
+		_wheelDelta += wheelDelta;
+	}
+
+
+	void MouseInputAccumulator::setButtonState(int button, bool down)
+	{
+		if (button < 0 || button >= 32)
+		{
+			return;
+		}
+		uint32_t buttonBit = 1u << button;
+		if (down)
+		{
+			_buttonsDown |= buttonBit;
+			_buttonsPressed |= buttonBit;
+		}
+		else
+		{
+			_buttonsDown &= ~buttonBit;
+			_buttonsReleased |= buttonBit;
+		}
+	}
+
+
+	// Returns everything collected since the previous consume and starts collecting anew.
+	MouseInput MouseInputAccumulator::consume()
+	{
+		MouseInput toReturn;
+		uint64_t movement = _movement.exchange(0);
+		toReturn.deltaX = static_cast<int32_t>(static_cast<uint32_t>(movement));
+		toReturn.deltaY = static_cast<int32_t>(static_cast<uint32_t>(movement >> 32));
+		toReturn.wheelDelta = _wheelDelta.exchange(0);
+		// the edges first, so a button pressed after reading them shows up as down without its edge, and its edge is seen next time.
+		toReturn.buttonsPressed = _buttonsPressed.exchange(0);
+		toReturn.buttonsReleased = _buttonsReleased.exchange(0);
+		toReturn.buttonsDown = _buttonsDown.load();
+		return toReturn;
+	}
+
+
+	void MouseInputAccumulator::clear()
+	{
+		_movement = 0;
+		_wheelDelta = 0;
+		_buttonsDown = 0;
+		_buttonsPressed = 0;
+		_buttonsReleased = 0;
+	}
+
+
+	uint64_t MouseInputAccumulator::packMovement(int32_t deltaX, int32_t deltaY)
+	{
+		return static_cast<uint64_t>(static_cast<uint32_t>(deltaX)) | (static_cast<uint64_t>(static_cast<uint32_t>(deltaY)) << 32);
+	}
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include <atomic>
+#include <cstdint>
+
+namespace IGCS
+{
+	// The mouse input of one tick of the camera.
+	struct MouseInput
+	{
+		int32_t deltaX;
+		int32_t deltaY;
+		int32_t wheelDelta;			// in wheel units, not notches
+		uint32_t buttonsDown;		// a bit per button, at the moment the input was consumed
+		uint32_t buttonsPressed;	// a bit per button which went down since the previous consume, even if it's up again
+		uint32_t buttonsReleased;	// a bit per button which went up since the previous consume
+	};
+
+
+	// Collects the raw mouse events which arrive between two ticks of the camera. The thread handling the window messages adds the events,
+	// the camera thread consumes everything collected so far once per tick, so no event is lost or counted twice, however many arrive
+	// per tick. Lock free, so the message thread never waits for the camera thread.
+	class MouseInputAccumulator
+	{
+	public:
+		MouseInputAccumulator();
+		~MouseInputAccumulator();
+
+		void addMovement(int32_t deltaX, int32_t deltaY);
+		void addWheel(int32_t wheelDelta);
+		void setButtonState(int button, bool down);
+		MouseInput consume();
+		void clear();
+
+	private:
+		static uint64_t packMovement(int32_t deltaX, int32_t deltaY);
+
+		std::atomic<uint64_t> _movement;		// deltaX in the low 32 bits, deltaY in the high 32 bits, so they're consumed together
+		std::atomic<int32_t> _wheelDelta;
+		std::atomic<uint32_t> _buttonsDown;
+		std::atomic<uint32_t> _buttonsPressed;
+		std::atomic<uint32_t> _buttonsReleased;
+	};
+}
@@ -46,7 +46,8 @@ namespace IGCS
 		return This->listenerThread();
 	}
 
-	NamedPipeManager::NamedPipeManager(): _clientToDllPipe(nullptr), _clientToDllPipeConnected(false), _dllToClientPipe(nullptr), _dllToClientPipeConnected(false)
+	NamedPipeManager::NamedPipeManager(): _clientToDllPipe(nullptr), _clientToDllPipeConnected(false), _dllToClientPipe(nullptr), _dllToClientPipeConnected(false),
+										  _listenerThread(nullptr), _stopListening(false)
 	{
 	}
 
@@ -68,12 +69,15 @@ namespace IGCS
 		{
 			return;
 		}
-		_dllToClientPipe = CreateFile(TEXT(IGCS_PIPENAME_DLL_TO_CLIENT), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+		// overlapped, so the writer thread can give up on a client which doesn't read anymore.
+		_dllToClientPipe = CreateFile(TEXT(IGCS_PIPENAME_DLL_TO_CLIENT), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
 		_dllToClientPipeConnected = (_dllToClientPipe != INVALID_HANDLE_VALUE);
 		if(!_dllToClientPipeConnected)
 		{
 			Console::WriteError("Couldn't connect to named pipe DLL -> Client. Please start the client first.");
+			return;
 		}
+		_pipeWriter.start(_dllToClientPipe);
 	}
 
 	
@@ -81,22 +85,47 @@ namespace IGCS
 	{
 		// create a thread to listen to the named pipe for messages and handle them.
 		DWORD threadID;
-		HANDLE threadHandle = CreateThread(nullptr, 0, staticListenerThread, (LPVOID)this, 0, &threadID);
+		_stopListening = false;
+		_listenerThread = CreateThread(nullptr, 0, staticListenerThread, (LPVOID)this, 0, &threadID);
 	}
 
 
-	void NamedPipeManager::writeTextPayload(const std::string& messageText, MessageType typeOfMessage)
+	// Stops the listener thread and closes both pipes, so the client sees the dll disconnect. The listener thread is blocked in ConnectNamedPipe
+	// or ReadFile, so its synchronous I/O is cancelled till it has exited.
+	void NamedPipeManager::stopListening()
 	{
-		if (!_dllToClientPipeConnected)
+		_stopListening = true;
+		if (nullptr != _listenerThread)
 		{
-			return;
+			while (WaitForSingleObject(_listenerThread, 50) == WAIT_TIMEOUT)
+			{
+				CancelSynchronousIo(_listenerThread);
+			}
+			CloseHandle(_listenerThread);
+			_listenerThread = nullptr;
 		}
+		if (_clientToDllPipeConnected)
+		{
+			DisconnectNamedPipe(_clientToDllPipe);
+			CloseHandle(_clientToDllPipe);
+			_clientToDllPipe = nullptr;
+			_clientToDllPipeConnected = false;
+		}
+		if (_dllToClientPipeConnected)
+		{
+			// the messages still queued are written first
+			_pipeWriter.stop();
+			_dllToClientPipeConnected = false;
+			CloseHandle(_dllToClientPipe);
+			_dllToClientPipe = nullptr;
+		}
+	}
 
-		uint8_t payload[IGCS_MAX_MESSAGE_SIZE];
-		payload[0] = uint8_t(typeOfMessage);
-		strncpy_s((char*)(&payload[1]), IGCS_MAX_MESSAGE_SIZE-2, messageText.c_str(), messageText.length());
-		DWORD numberOfBytesWritten;
-		WriteFile(_dllToClientPipe, payload, messageText.length() + 1, &numberOfBytesWritten, nullptr);
+
+	// Any thread. The message is queued for the writer thread, so this doesn't wait for the client.
+	void NamedPipeManager::writeTextPayload(const std::string& messageText, MessageType typeOfMessage)
+	{
+		_pipeWriter.write(typeOfMessage, messageText.c_str(), messageText.length());
 	}
 
 	
@@ -169,18 +198,23 @@ namespace IGCS
 			Console::WriteError("Couldn't create the Client -> DLL named pipe.");
 			return 1;
 		}
-		while (_clientToDllPipe != INVALID_HANDLE_VALUE)
+		while (!_stopListening)
 		{
 			auto connectResult = ConnectNamedPipe(_clientToDllPipe, nullptr);
 			if(connectResult!=0 || GetLastError()==ERROR_PIPE_CONNECTED)
 			{
 				uint8_t buffer[1024];
 				DWORD bytesRead;
-				while (ReadFile(_clientToDllPipe, buffer, sizeof(buffer), &bytesRead, nullptr))
+				while (!_stopListening && ReadFile(_clientToDllPipe, buffer, sizeof(buffer), &bytesRead, nullptr))
 				{
 					handleMessage(buffer, bytesRead);
 				}
 			}
+			if (!_stopListening)
+			{
+				// the client disconnected, so drop its end of the pipe, otherwise it can't connect again.
+				DisconnectNamedPipe(_clientToDllPipe);
+			}
 		}
 		return 0;
 	}
@@ -196,11 +230,9 @@ namespace IGCS
 		switch(static_cast<MessageType>(buffer[0]))
 		{
 		case MessageType::Setting:
-			Globals::instance().handleSettingMessage(buffer, bytesRead);
-			GameSpecific::CameraManipulator::applySettingsToGameState();
-			break;
 		case MessageType::KeyBinding:
-			Globals::instance().handleKeybindingMessage(buffer, bytesRead);
+			// applied by the camera thread
+			Globals::instance().queueMessage(buffer, bytesRead);
 			break;
 		case MessageType::Action:
 			handleAction(buffer, bytesRead);
@@ -224,9 +256,16 @@ namespace IGCS
 			InputHooker::setXInputHook(true);
 			break;
 		case ActionMessageType::ResizeViewport:
-			// payload is 2x4 bytes which are width and height. payload starts at offset 2 in buffer.
-			int* intArrayInBuffer = (int*)(buffer + 2);
-			GameSpecific::CameraManipulator::resizeViewPort(intArrayInBuffer[0], intArrayInBuffer[1]);
+			{
+				// payload is 2x4 bytes which are width and height. payload starts at offset 2 in buffer.
+				int* intArrayInBuffer = (int*)(buffer + 2);
+				GameSpecific::CameraManipulator::resizeViewPort(intArrayInBuffer[0], intArrayInBuffer[1]);
+			}
+			break;
+		case ActionMessageType::UnloadDll:
+			// the main thread removes everything and unloads the dll once its loop ends, as this thread has to be stopped for that too.
+			Globals::instance().unloadRequested(true);
+			Globals::instance().systemActive(false);
 			break;
 		}
 	}
@@ -27,8 +27,10 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "stdafx.h"
+#include <atomic>
 #include <string>
 #include "Defaults.h"
+#include "NamedPipeWriter.h"
 
 namespace IGCS
 {
@@ -42,6 +44,7 @@ namespace IGCS
 
 		void connectDllToClient();
 		void startListening();
+		void stopListening();
 		void writeTextPayload(const std::string& messageText, MessageType typeOfMessage);
 		void writeMessage(const std::string& messageText);
 		void writeMessage(const std::string& messageText, bool isError);
@@ -55,8 +58,11 @@ namespace IGCS
 
 		HANDLE _dllToClientPipe;
 		HANDLE _clientToDllPipe;
+		HANDLE _listenerThread;
 		bool _dllToClientPipeConnected;
 		bool _clientToDllPipeConnected;
+		std::atomic_bool _stopListening;
+		NamedPipeWriter _pipeWriter;
 	};
 }
 
@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "NamedPipeWriter.h"
+#include <cstdio>
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+namespace IGCS
+{
+	#define PIPE_WRITER_WAIT_SLICE_MS			50		// how often a thread waiting for the writer checks whether it has to stop
+
+#ifdef _WIN32
+	NamedPipeWriter::NamedPipeWriter() : _pipe(INVALID_HANDLE_VALUE), _isRunning(false), _stopRequested(false), _writerWaiting(false), _numberOfCoalescedMessages(0),
+										 _hasCarriedMessage(false), _numberOfReportedDrops(0), _hasStopDeadline(false), _writeCompleted(nullptr)
+	{
+	}
+#else
+	NamedPipeWriter::NamedPipeWriter() : _pipe(-1), _isRunning(false), _stopRequested(false), _writerWaiting(false), _numberOfCoalescedMessages(0),
+										 _hasCarriedMessage(false), _numberOfReportedDrops(0), _hasStopDeadline(false)
+	{
+	}
+#endif
+
+
+	NamedPipeWriter::~NamedPipeWriter()
+	{
+		stop();
+#ifdef _WIN32
+		if (nullptr != _writeCompleted)
+		{
+			CloseHandle(_writeCompleted);
+		}
+#endif
+	}
+
+
+	// Starts the writer thread for the pipe specified. The pipe stays owned by the caller, who closes it after stop().
+	void NamedPipeWriter::start(PipeHandle pipe)
+	{
+		stop();
+#ifdef _WIN32
+		if (nullptr == _writeCompleted)
+		{
+			_writeCompleted = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+		}
+#endif
+		_pipe = pipe;
+		_stopRequested = false;
+		_hasCarriedMessage = false;
+		_hasStopDeadline = false;
+		_numberOfReportedDrops = _queue.numberOfDroppedMessages();
+		_isRunning.store(true, std::memory_order_release);
+		_writerThread = std::thread(&NamedPipeWriter::writerThread, this);
+	}
+
+
+	// Stops accepting messages and waits till the writer thread has written what's queued, or PIPE_WRITE_SHUTDOWN_TIMEOUT_MS have passed.
+	void NamedPipeWriter::stop()
+	{
+		if (!_writerThread.joinable())
+		{
+			return;
+		}
+		_isRunning.store(false, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(_wakeUpMutex);
+			_stopRequested = true;
+		}
+		_wakeUp.notify_one();
+		_writerThread.join();
+	}
+
+
+	// Any thread. Queues the message for the writer thread, which is woken up if it waits for messages.
+	void NamedPipeWriter::write(MessageType type, const char* text, size_t textLength)
+	{
+		if (!isRunning() || !_queue.push(type, text, textLength))
+		{
+			return;
+		}
+		// the message has to be visible before _writerWaiting is read, see waitForMessages.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_writerWaiting.load(std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> lock(_wakeUpMutex);
+			_wakeUp.notify_one();
+		}
+	}
+
+
+	void NamedPipeWriter::writerThread()
+	{
+		OutgoingPipeMessage message;
+		while (!shutdownTimedOut())
+		{
+			if (!nextMessage(message))
+			{
+				if (reportDroppedMessages())
+				{
+					continue;
+				}
+				if (_stopRequested)
+				{
+					break;
+				}
+				waitForMessages();
+				continue;
+			}
+			// the messages after this one are queued because the client lags. The ones which are the same are written once.
+			uint32_t numberOfRepeats = 1;
+			while (!_hasCarriedMessage && _queue.pop(_carriedMessage))
+			{
+				if (_carriedMessage.length == message.length && 0 == memcmp(_carriedMessage.payload, message.payload, message.length))
+				{
+					numberOfRepeats++;
+				}
+				else
+				{
+					_hasCarriedMessage = true;
+				}
+			}
+			if (numberOfRepeats > 1)
+			{
+				_numberOfCoalescedMessages.fetch_add(numberOfRepeats - 1, std::memory_order_relaxed);
+				char suffix[48];
+				const int suffixLength = snprintf(suffix, sizeof(suffix), " (repeated %u times)", numberOfRepeats);
+				const uint32_t textEnd = (std::min)(message.length, static_cast<uint32_t>(sizeof(message.payload) - suffixLength));
+				memcpy(message.payload + textEnd, suffix, suffixLength);
+				message.length = textEnd + suffixLength;
+			}
+			if (!writeToPipe(message))
+			{
+				// the client is gone, or it didn't read anything before the shutdown timeout. 
+				break;
+			}
+		}
+		_isRunning.store(false, std::memory_order_release);
+	}
+
+
+	bool NamedPipeWriter::nextMessage(OutgoingPipeMessage& message)
+	{
+		if (!_hasCarriedMessage)
+		{
+			return _queue.pop(message);
+		}
+		_hasCarriedMessage = false;
+		message.length = _carriedMessage.length;
+		memcpy(message.payload, _carriedMessage.payload, _carriedMessage.length);
+		return true;
+	}
+
+
+	// A producer either sees _writerWaiting set and wakes us up, or we see its message in the wait's predicate. The timeout is a fallback.
+	void NamedPipeWriter::waitForMessages()
+	{
+		std::unique_lock<std::mutex> lock(_wakeUpMutex);
+		_writerWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		_wakeUp.wait_for(lock, std::chrono::milliseconds(100), [this] { return _stopRequested || !_queue.isEmpty(); });
+		_writerWaiting.store(false, std::memory_order_relaxed);
+	}
+
+
+	// Tells the client how many messages were dropped since the last time it was told, once it has read everything that was queued.
+	// Returns true if that was necessary.
+	bool NamedPipeWriter::reportDroppedMessages()
+	{
+		const uint64_t numberOfDroppedMessages = _queue.numberOfDroppedMessages();
+		if (numberOfDroppedMessages == _numberOfReportedDrops)
+		{
+			return false;
+		}
+		const uint64_t numberOfNewDrops = numberOfDroppedMessages - _numberOfReportedDrops;
+		_numberOfReportedDrops = numberOfDroppedMessages;
+		OutgoingPipeMessage report;
+		report.payload[0] = static_cast<uint8_t>(MessageType::ErrorTextMessage);
+		const int textLength = snprintf(reinterpret_cast<char*>(report.payload + 1), sizeof(report.payload) - 1, 
+										"%llu messages were dropped as the client couldn't keep up.", static_cast<unsigned long long>(numberOfNewDrops));
+		report.length = static_cast<uint32_t>(textLength + 1);
+		writeToPipe(report);
+		return true;
+	}
+
+
+#ifdef _WIN32
+	bool NamedPipeWriter::writeToPipe(const OutgoingPipeMessage& message)
+	{
+		OVERLAPPED overlapped = {};
+		overlapped.hEvent = _writeCompleted;
+		if (!WriteFile(_pipe, message.payload, message.length, nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+		{
+			return false;
+		}
+		// only this thread waits for the client.
+		while (WaitForSingleObject(_writeCompleted, PIPE_WRITER_WAIT_SLICE_MS) == WAIT_TIMEOUT)
+		{
+			if (shutdownTimedOut())
+			{
+				CancelIoEx(_pipe, &overlapped);
+				break;
+			}
+		}
+		DWORD numberOfBytesWritten = 0;
+		return GetOverlappedResult(_pipe, &overlapped, &numberOfBytesWritten, TRUE) && numberOfBytesWritten == message.length;
+	}
+#else
+	bool NamedPipeWriter::writeToPipe(const OutgoingPipeMessage& message)
+	{
+		while (!shutdownTimedOut())
+		{
+			const ssize_t numberOfBytesWritten = send(_pipe, message.payload, message.length, MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (numberOfBytesWritten >= 0)
+			{
+				return static_cast<uint32_t>(numberOfBytesWritten) == message.length;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				return false;
+			}
+			pollfd toPoll = { _pipe, POLLOUT, 0 };
+			poll(&toPoll, 1, PIPE_WRITER_WAIT_SLICE_MS);
+		}
+		return false;
+	}
+#endif
+
+
+	// Writer thread only. True once a stop was requested longer than PIPE_WRITE_SHUTDOWN_TIMEOUT_MS ago.
+	bool NamedPipeWriter::shutdownTimedOut()
+	{
+		if (!_stopRequested)
+		{
+			return false;
+		}
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (!_hasStopDeadline)
+		{
+			_stopDeadline = now + std::chrono::milliseconds(PIPE_WRITE_SHUTDOWN_TIMEOUT_MS);
+			_hasStopDeadline = true;
+		}
+		return now > _stopDeadline;
+	}
+}
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "SystemDefaults.h"
+#include "PipeMessageQueue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace IGCS
+{
+	// Writes the messages for the client to the DLL -> Client pipe on its own thread, so a client which reads slowly or not at all doesn't block
+	// the thread which logs a message, which can be the camera thread or a game thread. Messages are queued in a PipeMessageQueue, see there
+	// for which ones are dropped if the client lags. Messages which are the same as the one before them in the queue are written once, with
+	// the number of times they were repeated. Once the client has caught up, it's told how many messages were dropped.
+	// On Windows the pipe has to be opened for overlapped I/O. Elsewhere the client is a socket, which is what the tests use.
+	class NamedPipeWriter
+	{
+	public:
+#ifdef _WIN32
+		typedef HANDLE PipeHandle;
+#else
+		typedef int PipeHandle;
+#endif
+
+		NamedPipeWriter();
+		~NamedPipeWriter();
+		NamedPipeWriter(const NamedPipeWriter&) = delete;
+		NamedPipeWriter& operator=(const NamedPipeWriter&) = delete;
+
+		void start(PipeHandle pipe);
+		void stop();
+		bool isRunning() const { return _isRunning.load(std::memory_order_acquire); }
+		void write(MessageType type, const char* text, size_t textLength);
+		uint64_t numberOfDroppedMessages(MessageType type) const { return _queue.numberOfDroppedMessages(type); }
+		uint64_t numberOfDroppedMessages() const { return _queue.numberOfDroppedMessages(); }
+		uint64_t numberOfCoalescedMessages() const { return _numberOfCoalescedMessages.load(std::memory_order_relaxed); }
+
+	private:
+		void writerThread();
+		bool nextMessage(OutgoingPipeMessage& message);
+		void waitForMessages();
+		bool reportDroppedMessages();
+		bool writeToPipe(const OutgoingPipeMessage& message);
+		bool shutdownTimedOut();
+
+		PipeMessageQueue<PIPE_WRITE_QUEUE_SIZE> _queue;
+		PipeHandle _pipe;
+		std::thread _writerThread;
+		std::atomic<bool> _isRunning;
+		std::atomic<bool> _stopRequested;
+		std::atomic<bool> _writerWaiting;			// the writer thread waits for messages, so a producer has to wake it up
+		std::mutex _wakeUpMutex;
+		std::condition_variable _wakeUp;
+		std::atomic<uint64_t> _numberOfCoalescedMessages;
+		// writer thread only
+		OutgoingPipeMessage _carriedMessage;		// popped while coalescing, written next
+		bool _hasCarriedMessage;
+		uint64_t _numberOfReportedDrops;
+		bool _hasStopDeadline;
+		std::chrono::steady_clock::time_point _stopDeadline;
+#ifdef _WIN32
+		HANDLE _writeCompleted;
+#endif
+	};
+}
@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "PEImage.h"
+
+namespace IGCS
+{
+	using namespace PEReader;
+
+	static const uint32_t SECTION_CONTAINS_CODE = 0x00000020;
+	static const uint32_t SECTION_IS_EXECUTABLE = 0x20000000;
+	static const uint32_t SECTION_IS_WRITABLE = 0x80000000;
+	static const uint16_t OPTIONAL_HEADER_MAGIC_PE32 = 0x10B;
+	static const uint16_t OPTIONAL_HEADER_MAGIC_PE32PLUS = 0x20B;
+
+	PEImage::PEImage(const uint8_t* imageStart, size_t imageSize, bool mappedLayout) :
+		_imageStart{ imageStart }, _imageSize{ imageSize }, _mappedLayout{ mappedLayout }, _isValid{ false }, _ntHeadersOffset{ 0 },
+		_sectionTableOffset{ 0 }, _sizeOfHeaders{ 0 }, _sizeOfImage{ 0 }, _imageBase{ 0 }
+	{
+		parse();
+	}
+
+
+	PEImage::~PEImage()
+	{
+	}
+
+
+	std::vector<ScanRange> PEImage::rangesOfClass(SectionClass sectionClass) const
+	{
+		std::vector<ScanRange> toReturn;
+		for (auto& section : _sections)
+		{
+			if (section.sectionClass == sectionClass && section.length > 0)
+			{
+				toReturn.push_back(ScanRange{ _imageStart + section.offset, section.length });
+			}
+		}
+		return toReturn;
+	}
+
+
+	bool PEImage::rvaToOffset(uint32_t rva, size_t& offset) const
+	{
+		if (rva < _sizeOfHeaders)
+		{
+			offset = rva;
+			return offset < _imageSize;
+		}
+		for (auto& section : _sections)
+		{
+			if (rva >= section.virtualAddress && rva - section.virtualAddress < section.length)
+			{
+				offset = section.offset + (rva - section.virtualAddress);
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	bool PEImage::offsetToRva(size_t offset, uint32_t& rva) const
+	{
+		if (offset < _sizeOfHeaders)
+		{
+			rva = static_cast<uint32_t>(offset);
+			return true;
+		}
+		for (auto& section : _sections)
+		{
+			if (offset >= section.offset && offset - section.offset < section.length)
+			{
+				rva = section.virtualAddress + static_cast<uint32_t>(offset - section.offset);
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	void PEImage::parse()
+	{
+		if (nullptr == _imageStart || _imageSize < 0x40 || _imageStart[0] != 'M' || _imageStart[1] != 'Z')
+		{
+			return;
+		}
+		_ntHeadersOffset = readUInt32(_imageStart + 0x3C);
+		if (_ntHeadersOffset > _imageSize || _imageSize - _ntHeadersOffset < 24 || memcmp(_imageStart + _ntHeadersOffset, "PE\0\0", 4) != 0)
+		{
+			return;
+		}
+		uint16_t numberOfSections = readUInt16(fileHeader() + 2);
+		uint16_t sizeOfOptionalHeader = readUInt16(fileHeader() + 16);
+		_sectionTableOffset = _ntHeadersOffset + 24 + sizeOfOptionalHeader;
+		if (sizeOfOptionalHeader < 68 || _sectionTableOffset + numberOfSections * SECTION_HEADER_SIZE > _imageSize)
+		{
+			return;
+		}
+		uint16_t magic = readUInt16(optionalHeader());
+		if (magic == OPTIONAL_HEADER_MAGIC_PE32PLUS)
+		{
+			_imageBase = readUInt64(optionalHeader() + 24);
+		}
+		else if (magic == OPTIONAL_HEADER_MAGIC_PE32)
+		{
+			_imageBase = readUInt32(optionalHeader() + 28);
+		}
+		else
+		{
+			return;
+		}
+		_sizeOfImage = readUInt32(optionalHeader() + 56);
+		_sizeOfHeaders = readUInt32(optionalHeader() + 60);
+		for (uint16_t sectionIndex = 0; sectionIndex < numberOfSections; sectionIndex++)
+		{
+			const uint8_t* sectionHeader = sectionTable() + sectionIndex * SECTION_HEADER_SIZE;
+			PESection section;
+			const char* name = reinterpret_cast<const char*>(sectionHeader);
+			section.name = std::string(name, strnlen(name, 8));
+			section.virtualSize = readUInt32(sectionHeader + 8);
+			section.virtualAddress = readUInt32(sectionHeader + 12);
+			section.sizeOfRawData = readUInt32(sectionHeader + 16);
+			section.pointerToRawData = readUInt32(sectionHeader + 20);
+			section.characteristics = readUInt32(sectionHeader + 36);
+			if ((section.characteristics & (SECTION_CONTAINS_CODE | SECTION_IS_EXECUTABLE)) != 0)
+			{
+				section.sectionClass = SectionClass::Code;
+			}
+			else
+			{
+				section.sectionClass = (section.characteristics & SECTION_IS_WRITABLE) != 0 ? SectionClass::Data : SectionClass::ReadOnlyData;
+			}
+			// in a mapped image the whole virtual size is there (zero filled beyond the raw data), in a file only the raw data.
+			section.offset = _mappedLayout ? section.virtualAddress : section.pointerToRawData;
+			size_t sectionLength = _mappedLayout ? (section.virtualSize > 0 ? section.virtualSize : section.sizeOfRawData) : section.sizeOfRawData;
+			if (section.offset >= _imageSize)
+			{
+				section.length = 0;
+			}
+			else
+			{
+				section.length = (_imageSize - section.offset) < sectionLength ? (_imageSize - section.offset) : sectionLength;
+			}
+			_sections.push_back(section);
+		}
+		_isValid = true;
+	}
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "PatternArena.h"
+
+namespace IGCS
+{
+	PatternArena::PatternArena() : _offsetInCurrentBlock{ BLOCK_SIZE }, _numberOfBytesAllocated{ 0 }
+	{
+	}
+
+
+	PatternArena::~PatternArena()
+	{
+	}
+
+
+	PatternArena& PatternArena::instance()
+	{
+		static PatternArena theInstance;
+		return theInstance;
+	}
+
+
+	uint8_t* PatternArena::allocate(size_t numberOfBytes)
+	{
+		std::lock_guard<std::mutex> lock(_allocationMutex);
+		_numberOfBytesAllocated += numberOfBytes;
+		if (numberOfBytes > BLOCK_SIZE / 4)
+		{
+			// large request: give it its own block, so the current block isn't wasted. Insert it before the current block so that one
+			// stays the last block.
+			auto insertPosition = _blocks.empty() ? _blocks.end() : _blocks.end() - 1;
+			return _blocks.insert(insertPosition, std::unique_ptr<uint8_t[]>(new uint8_t[numberOfBytes]()))->get();
+		}
+		if (_offsetInCurrentBlock + numberOfBytes > BLOCK_SIZE)
+		{
+			_blocks.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[BLOCK_SIZE]()));
+			_offsetInCurrentBlock = 0;
+		}
+		uint8_t* toReturn = _blocks.back().get() + _offsetInCurrentBlock;
+		_offsetInCurrentBlock += numberOfBytes;
+		return toReturn;
+	}
+}
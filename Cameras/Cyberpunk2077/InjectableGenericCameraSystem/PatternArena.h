@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace IGCS
+{
+	// Bump allocator for the data of patterns which are parsed at runtime. Memory is handed out from large blocks and is never released
+	// individually: it lives as long as the arena, so patterns can be copied around freely without owning their data.
+	class PatternArena
+	{
+	public:
+		PatternArena();
+		~PatternArena();
+
+		// Returns a zeroed block of numberOfBytes bytes which stays valid for the lifetime of the arena.
+		uint8_t* allocate(size_t numberOfBytes);
+		size_t numberOfBytesAllocated() { return _numberOfBytesAllocated; }
+
+		// The arena all runtime parsed patterns are stored in.
+		static PatternArena& instance();
+
+		static const size_t BLOCK_SIZE = 16 * 1024;
+
+	private:
+		std::vector<std::unique_ptr<uint8_t[]>> _blocks;
+		size_t _offsetInCurrentBlock;
+		size_t _numberOfBytesAllocated;
+		std::mutex _allocationMutex;
+	};
+}
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "SystemDefaults.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace IGCS
+{
+	// A setting or key binding message from the client. These are applied by the camera thread at the start of a tick, so the settings 
+	// don't change in the middle of one and a recorded session sees them at the same moment as the live one.
+	struct PipeMessage
+	{
+		uint8_t payload[IGCS_MAX_QUEUED_MESSAGE_SIZE];
+		uint8_t length;
+	};
+
+
+	// A message for the client as it's written to the pipe: the message type in the first byte, followed by the text.
+	struct OutgoingPipeMessage
+	{
+		uint32_t length;
+		uint8_t payload[PIPE_MESSAGE_SLOT_SIZE];
+	};
+
+
+	// Fixed size, lock free queue of messages for the client, for any number of producer threads and one consumer thread, the pipe writer.
+	// The cells are the message buffers, so queueing a message is a copy of its text and nothing is allocated. A producer never waits: 
+	// once the queue fills up because the client can't keep up, debug messages are dropped first, then normal messages, and errors and 
+	// notifications only when the queue is full. The messages dropped are counted per type. Capacity has to be a power of 2.
+	template<size_t Capacity>
+	class PipeMessageQueue
+	{
+		static_assert(Capacity >= 4 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of 2");
+
+	public:
+		PipeMessageQueue() : _enqueuePosition(0), _dequeuePosition(0)
+		{
+			for (size_t i = 0; i < Capacity; i++)
+			{
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+			for (std::atomic<uint64_t>& counter : _numberOfDroppedMessages)
+			{
+				counter.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		// Any thread. Text which doesn't fit in a cell is cut off. Returns false if the message was dropped.
+		bool push(MessageType type, const char* text, size_t textLength)
+		{
+			size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+			Cell* cell;
+			while (true)
+			{
+				const size_t dequeuePosition = _dequeuePosition.load(std::memory_order_relaxed);
+				if (!mayQueue(type, position > dequeuePosition ? position - dequeuePosition : 0))
+				{
+					countDroppedMessage(type);
+					return false;
+				}
+				cell = &_cells[position & (Capacity - 1)];
+				const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+				if (difference == 0)
+				{
+					// the cell is free, claim it
+					if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (difference < 0)
+				{
+					// the consumer hasn't taken the message in this cell yet, the queue is full
+					countDroppedMessage(type);
+					return false;
+				}
+				else
+				{
+					// another producer claimed the cell
+					position = _enqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+			const size_t length = (std::min)(textLength, sizeof(cell->message.payload) - 1);
+			cell->message.payload[0] = static_cast<uint8_t>(type);
+			memcpy(cell->message.payload + 1, text, length);
+			cell->message.length = static_cast<uint32_t>(length + 1);
+			cell->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer thread only
+		bool pop(OutgoingPipeMessage& message)
+		{
+			const size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+			Cell& cell = _cells[position & (Capacity - 1)];
+			if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+			{
+				// empty, or the producer which claimed the cell is still copying its message
+				return false;
+			}
+			message.length = cell.message.length;
+			memcpy(message.payload, cell.message.payload, cell.message.length);
+			cell.sequence.store(position + Capacity, std::memory_order_release);
+			_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// consumer thread only. True if there's no message which can be popped right now.
+		bool isEmpty() const
+		{
+			const size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+			return _cells[position & (Capacity - 1)].sequence.load(std::memory_order_acquire) != position + 1;
+		}
+
+		uint64_t numberOfDroppedMessages(MessageType type) const
+		{
+			const size_t index = static_cast<size_t>(type);
+			return index < NumberOfCounters ? _numberOfDroppedMessages[index].load(std::memory_order_relaxed) : 0;
+		}
+
+		uint64_t numberOfDroppedMessages() const
+		{
+			uint64_t toReturn = 0;
+			for (const std::atomic<uint64_t>& counter : _numberOfDroppedMessages)
+			{
+				toReturn += counter.load(std::memory_order_relaxed);
+			}
+			return toReturn;
+		}
+
+	private:
+		static const size_t NumberOfCounters = 8;
+
+		struct Cell
+		{
+			std::atomic<size_t> sequence;		// position + 1 if the cell has a message, the position it's free for otherwise
+			OutgoingPipeMessage message;
+		};
+
+		// The lower a message type's priority, the less of the queue it may fill.
+		static bool mayQueue(MessageType type, size_t numberOfQueuedMessages)
+		{
+			switch (type)
+			{
+				case MessageType::DebugTextMessage:
+					return numberOfQueuedMessages < Capacity / 2;
+				case MessageType::NormalTextMessage:
+					return numberOfQueuedMessages < Capacity - Capacity / 4;
+				default:
+					return numberOfQueuedMessages < Capacity;
+			}
+		}
+
+		void countDroppedMessage(MessageType type)
+		{
+			const size_t index = static_cast<size_t>(type);
+			_numberOfDroppedMessages[index < NumberOfCounters ? index : 0].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		alignas(64) std::atomic<size_t> _enqueuePosition;		// next cell to claim, shared by the producers
+		alignas(64) std::atomic<size_t> _dequeuePosition;		// next cell to pop, written by the consumer
+		alignas(64) Cell _cells[Capacity];
+		std::atomic<uint64_t> _numberOfDroppedMessages[NumberOfCounters];		// indexed by MessageType
+	};
+}
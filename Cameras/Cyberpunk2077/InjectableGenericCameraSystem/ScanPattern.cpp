@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2019, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ScanPattern.h"
+#include "PatternArena.h"
+
+namespace IGCS
+{
+	ScanPattern::ScanPattern(const std::string& bytePatternAsString, int occurrence) : 
+		_occurrence{ occurrence }, _bytePattern{ nullptr }, _compareMask{ nullptr }, _patternSize{ 0 }, _customOffset{ 0 }, _anchorIndex{ 0 }, 
+		_secondaryAnchorIndex{ 0 }
+	{
+		createAOBPatternFromStringPattern(bytePatternAsString);
+	}
+
+
+	ScanPattern::~ScanPattern()
+	{
+	}
+
+
+	// Updates this pattern with the data used with an aob scan, parsed from a pattern string at runtime. See PatternParser::parse for the format.
+	// The data is stored in the pattern arena. Patterns known at compile time should use IGCS_AOB_PATTERN instead, which does this at compile time.
+	// If the string isn't a valid pattern, the pattern size is 0 and the pattern never matches.
+	void ScanPattern::createAOBPatternFromStringPattern(const std::string& bytePatternAsString)
+	{
+		int maxPatternSize = static_cast<int>(bytePatternAsString.size());
+		if (maxPatternSize <= 0)
+		{
+			return;
+		}
+		uint8_t* bytePattern = PatternArena::instance().allocate(static_cast<size_t>(maxPatternSize) * 2);
+		uint8_t* compareMask = bytePattern + maxPatternSize;
+		int patternSize = 0;
+		if (!PatternParser::parse(bytePatternAsString.c_str(), bytePatternAsString.size(), bytePattern, compareMask, maxPatternSize, patternSize, _customOffset))
+		{
+			_customOffset = 0;
+			return;
+		}
+		_bytePattern = bytePattern;
+		_compareMask = compareMask;
+		_patternSize = patternSize;
+		AOBScanner::determineAnchors(_bytePattern, _compareMask, _patternSize, _anchorIndex, _secondaryAnchorIndex);
+	}
+}
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2019, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "AOBScanner.h"
+#include "PatternLiteral.h"
+#include <string>
+
+namespace IGCS
+{
+	// An AOB pattern with its occurrence. Doesn't own the pattern data: it either points to a PatternLiteral parsed at compile time or
+	// to data in the PatternArena, so it can be copied around freely.
+	class ScanPattern
+	{
+	public:
+		ScanPattern(const std::string& bytePatternAsString, int occurrence);
+		template<size_t Capacity>
+		ScanPattern(const PatternLiteral<Capacity>& patternLiteral, int occurrence) : 
+			_occurrence{ occurrence }, _bytePattern{ patternLiteral.bytePattern }, _compareMask{ patternLiteral.compareMask }, _patternSize{ patternLiteral.patternSize },
+			_customOffset{ patternLiteral.customOffset }, _anchorIndex{ patternLiteral.anchorIndex }, _secondaryAnchorIndex{ patternLiteral.secondaryAnchorIndex }
+		{
+		}
+		~ScanPattern();
+
+		int occurrence() { return _occurrence; }
+		const uint8_t* bytePattern() { return _bytePattern; }
+		const uint8_t* compareMask() { return _compareMask; }
+		int customOffset() { return _customOffset; }
+		int patternSize() { return _patternSize; }
+		int anchorIndex() { return _anchorIndex; }
+		PatternView view() { return PatternView{ _bytePattern, _compareMask, _patternSize, _anchorIndex, _secondaryAnchorIndex }; }
+
+	private:
+		void createAOBPatternFromStringPattern(const std::string& bytePatternAsString);
+
+		int _occurrence = -1;
+		const uint8_t* _bytePattern = nullptr;
+		const uint8_t* _compareMask = nullptr;		// bits to ignore per byte, see PatternView
+		int _patternSize = 0;
+		int _customOffset = 0;
+		int _anchorIndex = 0;
+		int _secondaryAnchorIndex = 0;
+	};
+}
@@ -0,0 +1,248 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ScanResultCache.h"
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace IGCS
+{
+	using namespace PEReader;
+
+	static const char CACHE_FILE_MAGIC[8] = { 'I', 'G', 'C', 'S', 'S', 'R', 'C', '2' };
+
+	static void hashBytes(uint64_t& hash, const uint8_t* bytes, size_t length)
+	{
+		// FNV-1a
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ULL;
+		}
+	}
+
+
+	static void hashUInt32(uint64_t& hash, uint32_t value)
+	{
+		uint8_t bytes[4] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+		hashBytes(hash, bytes, 4);
+	}
+
+
+	uint64_t calculateExecutableFingerprint(const uint8_t* imageStart, size_t imageSize, bool mappedLayout)
+	{
+		return calculateExecutableFingerprint(PEImage(imageStart, imageSize, mappedLayout));
+	}
+
+
+	uint64_t calculateExecutableFingerprint(const PEImage& image)
+	{
+		if (!image.isValid())
+		{
+			return 0;
+		}
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		// the file header has the timestamp of the link, which changes with every build.
+		hashBytes(hash, image.fileHeader(), 20);
+		// the image base isn't hashed, as the loader can change it. The linker version, SizeOfCode, SizeOfInitializedData, AddressOfEntryPoint,
+		// SizeOfImage, SizeOfHeaders and CheckSum are stable.
+		const uint8_t* optionalHeader = image.optionalHeader();
+		hashBytes(hash, optionalHeader + 2, 2);
+		hashUInt32(hash, readUInt32(optionalHeader + 4));
+		hashUInt32(hash, readUInt32(optionalHeader + 8));
+		hashUInt32(hash, readUInt32(optionalHeader + 16));
+		hashUInt32(hash, readUInt32(optionalHeader + 56));
+		hashUInt32(hash, readUInt32(optionalHeader + 60));
+		hashUInt32(hash, readUInt32(optionalHeader + 64));
+		hashBytes(hash, image.sectionTable(), image.sectionTableSize());
+		// 0 is used as 'invalid'
+		return hash == 0 ? 1 : hash;
+	}
+
+
+	ScanResultCache::ScanResultCache() : _fingerprint{ 0 }
+	{
+	}
+
+
+	ScanResultCache::~ScanResultCache()
+	{
+	}
+
+
+	// File format: magic (8 bytes), fingerprint (uint64), number of entries (uint32), then per entry: length of block name (uint32), block
+	// name (ascii), pattern index (int32), occurrence (int32), pattern hash (uint32), rva (uint32).
+	bool ScanResultCache::load(const std::string& filename, uint64_t fingerprint)
+	{
+		clear(fingerprint);
+		std::ifstream cacheFile(filename, std::ios::binary);
+		if (!cacheFile)
+		{
+			return false;
+		}
+		std::vector<uint8_t> contents((std::istreambuf_iterator<char>(cacheFile)), std::istreambuf_iterator<char>());
+		size_t index = 0;
+		auto canRead = [&](size_t numberOfBytes) { return contents.size() - index >= numberOfBytes; };
+		if (!canRead(sizeof(CACHE_FILE_MAGIC) + 12) || memcmp(contents.data(), CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0)
+		{
+			return false;
+		}
+		index += sizeof(CACHE_FILE_MAGIC);
+		uint64_t fingerprintInFile = readUInt64(&contents[index]);
+		index += 8;
+		if (fingerprintInFile != fingerprint)
+		{
+			// different executable
+			return false;
+		}
+		uint32_t numberOfEntries = readUInt32(&contents[index]);
+		index += 4;
+		for (uint32_t i = 0; i < numberOfEntries; i++)
+		{
+			if (!canRead(4))
+			{
+				_entries.clear();
+				return false;
+			}
+			uint32_t nameLength = readUInt32(&contents[index]);
+			index += 4;
+			if (!canRead(static_cast<size_t>(nameLength) + 16))
+			{
+				_entries.clear();
+				return false;
+			}
+			std::string blockName(reinterpret_cast<const char*>(&contents[index]), nameLength);
+			index += nameLength;
+			CachedLocation location;
+			location.patternIndex = static_cast<int>(readUInt32(&contents[index]));
+			location.occurrence = static_cast<int>(readUInt32(&contents[index + 4]));
+			location.patternHash = readUInt32(&contents[index + 8]);
+			location.rva = readUInt32(&contents[index + 12]);
+			index += 16;
+			set(blockName, location);
+		}
+		return true;
+	}
+
+
+	bool ScanResultCache::save(const std::string& filename) const
+	{
+		std::vector<uint8_t> contents(CACHE_FILE_MAGIC, CACHE_FILE_MAGIC + sizeof(CACHE_FILE_MAGIC));
+		auto writeUInt32 = [&](uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				contents.push_back(static_cast<uint8_t>(value >> (i * 8)));
+			}
+		};
+		writeUInt32(static_cast<uint32_t>(_fingerprint));
+		writeUInt32(static_cast<uint32_t>(_fingerprint >> 32));
+		writeUInt32(static_cast<uint32_t>(_entries.size()));
+		for (auto& entry : _entries)
+		{
+			writeUInt32(static_cast<uint32_t>(entry.first.size()));
+			contents.insert(contents.end(), entry.first.begin(), entry.first.end());
+			writeUInt32(static_cast<uint32_t>(entry.second.patternIndex));
+			writeUInt32(static_cast<uint32_t>(entry.second.occurrence));
+			writeUInt32(entry.second.patternHash);
+			writeUInt32(entry.second.rva);
+		}
+		std::ofstream cacheFile(filename, std::ios::binary | std::ios::trunc);
+		if (!cacheFile)
+		{
+			return false;
+		}
+		cacheFile.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+		return cacheFile.good();
+	}
+
+
+	bool ScanResultCache::tryGet(const std::string& blockName, CachedLocation& location) const
+	{
+		auto entry = _entries.find(blockName);
+		if (entry == _entries.end())
+		{
+			return false;
+		}
+		location = entry->second;
+		return true;
+	}
+
+
+	void ScanResultCache::set(const std::string& blockName, const CachedLocation& location)
+	{
+		_entries[blockName] = location;
+	}
+
+
+	void ScanResultCache::clear(uint64_t fingerprint)
+	{
+		_fingerprint = fingerprint;
+		_entries.clear();
+	}
+
+
+	uint32_t ScanResultCache::calculatePatternHash(const PatternView& pattern)
+	{
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		hashUInt32(hash, static_cast<uint32_t>(pattern.patternSize));
+		if (pattern.patternSize > 0)
+		{
+			hashBytes(hash, pattern.bytePattern, pattern.patternSize);
+			hashBytes(hash, pattern.compareMask, pattern.patternSize);
+		}
+		return static_cast<uint32_t>(hash ^ (hash >> 32));
+	}
+
+
+	const uint8_t* ScanResultCache::verifyLocation(const PEImage& image, SectionClass sectionClass, const PatternView& pattern, int occurrence, const CachedLocation& location)
+	{
+		if (pattern.patternSize <= 0 || location.occurrence != occurrence || location.patternHash != calculatePatternHash(pattern))
+		{
+			// the camera's patterns changed since the cache was written.
+			return nullptr;
+		}
+		size_t offset = 0;
+		if (!image.rvaToOffset(location.rva, offset))
+		{
+			return nullptr;
+		}
+		const uint8_t* toReturn = image.imageStart() + offset;
+		for (auto& range : image.rangesOfClass(sectionClass))
+		{
+			if (toReturn >= range.start && static_cast<size_t>(toReturn - range.start) + pattern.patternSize <= range.length)
+			{
+				return AOBScanner::matchesAt(toReturn, pattern) ? toReturn : nullptr;
+			}
+		}
+		// not in a section the block is scanned for.
+		return nullptr;
+	}
+}
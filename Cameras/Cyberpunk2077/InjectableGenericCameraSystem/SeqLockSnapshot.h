@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace IGCS
+{
+	// Hands the latest value of a small, trivially copyable type from one writer thread to any number of reader threads, without locks. 
+	// It's a seqlock: the sequence number is odd while the value is written and a reader retries if it was odd or has changed after the value
+	// was copied. The value is stored in atomic words, so the copying itself isn't a data race.
+	template<typename T>
+	class SeqLockSnapshot
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "T has to be trivially copyable");
+		static const size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	public:
+		SeqLockSnapshot() : _sequence(0)
+		{
+			for (std::atomic<uint64_t>& word : _words)
+			{
+				word.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		// writer thread only
+		void publish(const T& value)
+		{
+			uint64_t words[WordCount] = {};
+			memcpy(words, &value, sizeof(T));
+			const uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+			_sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (size_t i = 0; i < WordCount; i++)
+			{
+				_words[i].store(words[i], std::memory_order_relaxed);
+			}
+			_sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		// Returns the last published value, or a zeroed T if nothing was published yet.
+		T read() const
+		{
+			uint64_t words[WordCount];
+			uint32_t sequenceBefore;
+			uint32_t sequenceAfter;
+			do
+			{
+				sequenceBefore = _sequence.load(std::memory_order_acquire);
+				for (size_t i = 0; i < WordCount; i++)
+				{
+					words[i] = _words[i].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				sequenceAfter = _sequence.load(std::memory_order_relaxed);
+			} while ((sequenceBefore & 1) || sequenceBefore != sequenceAfter);
+			T toReturn;
+			memcpy(&toReturn, words, sizeof(T));
+			return toReturn;
+		}
+
+	private:
+		std::atomic<uint32_t> _sequence;
+		std::atomic<uint64_t> _words[WordCount];
+	};
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "SessionRecorder.h"
+#include "CameraController.h"
+#include "CameraManipulator.h"
+#include "Globals.h"
+#include "MessageHandler.h"
+
+namespace IGCS
+{
+	SessionRecorder::SessionRecorder() : _isRecording(false), _keyframeIntervalTicks(0), _ticksSinceKeyframe(0)
+	{
+	}
+
+
+	SessionRecorder::~SessionRecorder()
+	{
+		stop();
+	}
+
+
+	// Starts a new recording in the file specified, which is overwritten. The first tick recorded writes a keyframe.
+	bool SessionRecorder::start(const std::filesystem::path& path, uint64_t size, int keyframeIntervalTicks)
+	{
+		stop();
+		if (!_file.create(path, size) || !_ring.attach(_file.data(), _file.size(), true))
+		{
+			_file.close();
+			MessageHandler::logError("Couldn't create the session recording file '%s'.", path.u8string().c_str());
+			return false;
+		}
+		_keyframeIntervalTicks = (std::max)(1, keyframeIntervalTicks);
+		_ticksSinceKeyframe = _keyframeIntervalTicks;
+		_isRecording = true;
+		MessageHandler::logLine("Recording the session in '%s'.", path.u8string().c_str());
+		return true;
+	}
+
+
+	void SessionRecorder::stop()
+	{
+		if (!_isRecording)
+		{
+			return;
+		}
+		_isRecording = false;
+		_ring.detach();
+		_file.flush();
+		_file.close();
+	}
+
+
+	// Records the input of a tick, before the controller runs it. A keyframe is written first if one is due, so the state it has is the
+	// state the tick starts from.
+	void SessionRecorder::recordTick(const TickInput& input, CameraController& controller)
+	{
+		if (_ticksSinceKeyframe >= _keyframeIntervalTicks)
+		{
+			SessionKeyframe keyframe = {};
+			controller.saveState(keyframe);
+			append(SessionRecordType::Keyframe, SessionRecords::encodeKeyframe(keyframe, _buffer, sizeof(_buffer)));
+			_tickEncoder.reset();
+			_ticksSinceKeyframe = 0;
+		}
+		append(SessionRecordType::Tick, _tickEncoder.encode(input, _buffer, sizeof(_buffer)));
+		_ticksSinceKeyframe++;
+	}
+
+
+	// Records what the tick just run handed to the game.
+	void SessionRecorder::recordPose()
+	{
+		SessionPose pose = {};
+		pose.hasPose = g_cameraPose.read(pose.pose);
+		if (!pose.hasPose)
+		{
+			// the pose read is undefined then, e.g. the one of before the camera was disabled
+			pose.pose = CameraPose();
+		}
+		pose.fov = GameSpecific::CameraManipulator::getCurrentFoV();
+		append(SessionRecordType::Pose, SessionRecords::encodePose(pose, _buffer, sizeof(_buffer)));
+	}
+
+
+	// Appends the record in _buffer. If that fails the recording can't be replayed anymore from that point on, so it's stopped.
+	void SessionRecorder::append(SessionRecordType type, uint32_t size)
+	{
+		if (!_isRecording)
+		{
+			return;
+		}
+		if (0 == size || !_ring.append(type, _buffer, size))
+		{
+			MessageHandler::logError("A record didn't fit in the session recording. Recording stopped.");
+			stop();
+		}
+	}
+}
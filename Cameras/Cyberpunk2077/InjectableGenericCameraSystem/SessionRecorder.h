@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "SessionRecording.h"
+#include <filesystem>
+
+namespace IGCS
+{
+	class CameraController;
+
+	// Records the ticks of a CameraController into a memory mapped file, so a session which went wrong can be replayed with SessionReplayer. 
+	// Appending a record is a copy into the mapped file, the OS writes it to disk. Camera thread only.
+	class SessionRecorder
+	{
+	public:
+		SessionRecorder();
+		~SessionRecorder();
+
+		bool start(const std::filesystem::path& path, uint64_t size, int keyframeIntervalTicks);
+		void stop();
+		bool isRecording() const { return _isRecording; }
+		void recordTick(const TickInput& input, CameraController& controller);
+		void recordPose();
+
+	private:
+		void append(SessionRecordType type, uint32_t size);
+
+		SessionFile _file;
+		SessionRing _ring;
+		SessionTickEncoder _tickEncoder;
+		bool _isRecording;
+		int _keyframeIntervalTicks;
+		int _ticksSinceKeyframe;
+		uint8_t _buffer[4 * 1024];
+	};
+}
@@ -0,0 +1,812 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "SessionRecording.h"
+#include <cstring>
+#include <type_traits>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace IGCS
+{
+	#define SESSION_RING_MAGIC			0x52434749		// 'IGCR'
+	#define SESSION_RING_VERSION		2
+
+	namespace
+	{
+		uint64_t alignTo8(uint64_t value)
+		{
+			return (value + 7) & ~static_cast<uint64_t>(7);
+		}
+
+
+		// Values are stored as their bytes, which are little endian on every platform the camera system runs on.
+		class RecordWriter
+		{
+		public:
+			RecordWriter(uint8_t* buffer, uint32_t capacity) : _buffer(buffer), _capacity(capacity), _size(0), _overflow(false) {}
+
+			template<typename T>
+			void value(const T& toWrite)
+			{
+				static_assert(std::is_arithmetic<T>::value, "only plain values are written");
+				bytes(&toWrite, sizeof(T));
+			}
+
+			void bytes(const void* toWrite, uint32_t length)
+			{
+				if (_overflow || _capacity - _size < length)
+				{
+					_overflow = true;
+					return;
+				}
+				memcpy(_buffer + _size, toWrite, length);
+				_size += length;
+			}
+
+			uint32_t size() const { return _overflow ? 0 : _size; }
+
+		private:
+			uint8_t* _buffer;
+			uint32_t _capacity;
+			uint32_t _size;
+			bool _overflow;
+		};
+
+
+		class RecordReader
+		{
+		public:
+			RecordReader(const uint8_t* data, uint32_t size) : _data(data), _size(size), _position(0), _failed(false) {}
+
+			template<typename T>
+			void value(T& toRead)
+			{
+				static_assert(std::is_arithmetic<T>::value, "only plain values are read");
+				bytes(&toRead, sizeof(T));
+			}
+
+			void bytes(void* toRead, uint32_t length)
+			{
+				if (_failed || _size - _position < length)
+				{
+					_failed = true;
+					memset(toRead, 0, length);
+					return;
+				}
+				memcpy(toRead, _data + _position, length);
+				_position += length;
+			}
+
+			// true if everything could be read and nothing is left
+			bool succeeded() const { return !_failed && _position == _size; }
+
+		private:
+			const uint8_t* _data;
+			uint32_t _size;
+			uint32_t _position;
+			bool _failed;
+		};
+
+
+		// The keyframe is written and read by the same code: Archive is a RecordWriter with a const keyframe or a RecordReader.
+		template<typename Archive, typename Quat>
+		void transferQuat(Archive& archive, Quat& toTransfer)
+		{
+			archive.value(toTransfer.x);
+			archive.value(toTransfer.y);
+			archive.value(toTransfer.z);
+			archive.value(toTransfer.w);
+		}
+
+
+		template<typename Archive, typename Vec3>
+		void transferVec3(Archive& archive, Vec3& toTransfer)
+		{
+			archive.value(toTransfer.x);
+			archive.value(toTransfer.y);
+			archive.value(toTransfer.z);
+		}
+
+
+		template<typename Archive, typename Keyframe>
+		void transferKeyframe(Archive& archive, Keyframe& keyframe)
+		{
+			archive.value(keyframe.cameraStructFound);
+			archive.value(keyframe.cameraEnabled);
+			archive.value(keyframe.cameraMovementLocked);
+			archive.value(keyframe.inputBlocked);
+			archive.value(keyframe.hudVisible);
+
+			auto& camera = keyframe.camera;
+			transferQuat(archive, camera.orientation);
+			transferQuat(archive, camera.previousStepOrientation);
+			transferQuat(archive, camera.lastStepOrientation);
+			transferVec3(archive, camera.previousStepOffset);
+			transferVec3(archive, camera.lastStepOffset);
+			archive.value(camera.lookDirectionInverter);
+			transferVec3(archive, camera.pendingMovement);
+			archive.value(camera.movementPending);
+
+			auto& cameraManipulator = keyframe.cameraManipulator;
+			transferVec3(archive, cameraManipulator.cameraPosition);
+			archive.value(cameraManipulator.cameraPositionIsValid);
+			for (auto& coord : cameraManipulator.originalCameraData._coords)
+			{
+				archive.value(coord);
+			}
+			for (auto& component : cameraManipulator.originalCameraData._quaternion)
+			{
+				archive.value(component);
+			}
+			archive.value(cameraManipulator.originalCameraData._fov);
+			archive.value(cameraManipulator.coordMultiplierFactor);
+			for (auto& coords : cameraManipulator.publishedCoordsHistory)
+			{
+				for (auto& coord : coords)
+				{
+					archive.value(coord);
+				}
+			}
+			archive.value(cameraManipulator.publishedCoordsHistoryCount);
+			archive.value(cameraManipulator.publishedCoordsHistoryIndex);
+
+			auto& input = keyframe.input;
+			for (int i = 0; i < static_cast<int>(ActionType::Amount); i++)
+			{
+				archive.value(input.actionDown[i]);
+				archive.value(input.actionNextRepeatTime[i]);
+			}
+			archive.value(input.mouseWheelRemainder);
+
+			auto& settings = keyframe.settings;
+			archive.value(settings.invertY);
+			archive.value(settings.fastMovementMultiplier);
+			archive.value(settings.slowMovementMultiplier);
+			archive.value(settings.movementUpMultiplier);
+			archive.value(settings.movementSpeed);
+			archive.value(settings.rotationSpeed);
+			archive.value(settings.fovChangeSpeed);
+			archive.value(settings.cameraControlDevice);
+			archive.value(settings.timeOfDay);
+			archive.value(settings.wetness_OverrideParameters);
+			archive.value(settings.wetness_StreetWetnessFactor);
+			archive.value(settings.wetness_PuddleSize);
+			archive.value(settings.timeOfDayChanged);
+			archive.value(settings.wetnessSettingsChanged);
+
+			for (auto& binding : keyframe.keyBindings)
+			{
+				archive.value(binding.keyCode);
+				archive.value(binding.altRequired);
+				archive.value(binding.ctrlRequired);
+				archive.value(binding.shiftRequired);
+			}
+		}
+
+
+		// what follows the fixed part of a tick record
+		enum TickFlags : uint16_t
+		{
+			GameHasFocus = 1,
+			KeyboardChanged = 2,
+			MouseInputPresent = 4,
+			GamepadChanged = 8,
+			GamepadConnected = 16,
+			GameCameraFound = 32,
+		};
+
+
+		bool isMouseInputPresent(const MouseInput& mouse)
+		{
+			return mouse.deltaX != 0 || mouse.deltaY != 0 || mouse.wheelDelta != 0 || mouse.buttonsDown != 0 || mouse.buttonsPressed != 0 || mouse.buttonsReleased != 0;
+		}
+
+
+		bool gamepadStatesEqual(const GamepadState& a, const GamepadState& b)
+		{
+			return a.wButtons == b.wButtons && a.bLeftTrigger == b.bLeftTrigger && a.bRightTrigger == b.bRightTrigger && a.sThumbLX == b.sThumbLX &&
+				   a.sThumbLY == b.sThumbLY && a.sThumbRX == b.sThumbRX && a.sThumbRY == b.sThumbRY;
+		}
+
+
+		template<typename Archive, typename Gamepad>
+		void transferGamepad(Archive& archive, Gamepad& gamepad)
+		{
+			archive.value(gamepad.wButtons);
+			archive.value(gamepad.bLeftTrigger);
+			archive.value(gamepad.bRightTrigger);
+			archive.value(gamepad.sThumbLX);
+			archive.value(gamepad.sThumbLY);
+			archive.value(gamepad.sThumbRX);
+			archive.value(gamepad.sThumbRY);
+		}
+
+
+		template<typename Archive, typename Mouse>
+		void transferMouse(Archive& archive, Mouse& mouse)
+		{
+			archive.value(mouse.deltaX);
+			archive.value(mouse.deltaY);
+			archive.value(mouse.wheelDelta);
+			archive.value(mouse.buttonsDown);
+			archive.value(mouse.buttonsPressed);
+			archive.value(mouse.buttonsReleased);
+		}
+
+
+		template<typename Archive, typename Pose>
+		void transferPose(Archive& archive, Pose& pose)
+		{
+			archive.value(pose.hasPose);
+			for (auto& coord : pose.pose.coords)
+			{
+				archive.value(coord);
+			}
+			for (auto& component : pose.pose.quaternion)
+			{
+				archive.value(component);
+			}
+			archive.value(pose.fov);
+		}
+	}
+
+
+	SessionRing::SessionRing() : _header(nullptr), _records(nullptr)
+	{
+	}
+
+
+	SessionRing::~SessionRing()
+	{
+	}
+
+
+	// Uses size bytes at memory for the ring. If clear is false, the memory has to contain a ring already, e.g. from a file, and false is 
+	// returned if it doesn't.
+	bool SessionRing::attach(uint8_t* memory, uint64_t size, bool clear)
+	{
+		detach();
+		const uint64_t headerSize = alignTo8(sizeof(RingHeader));
+		if (nullptr == memory || size < headerSize + 1024)
+		{
+			return false;
+		}
+		RingHeader* header = reinterpret_cast<RingHeader*>(memory);
+		const uint64_t capacity = (size - headerSize) & ~static_cast<uint64_t>(7);
+		if (clear)
+		{
+			header->magic = SESSION_RING_MAGIC;
+			header->version = SESSION_RING_VERSION;
+			header->capacity = capacity;
+			header->begin = 0;
+			header->end = 0;
+			header->numberOfDroppedRecords = 0;
+		}
+		else if (header->magic != SESSION_RING_MAGIC || header->version != SESSION_RING_VERSION || header->capacity > capacity || 
+				 (header->capacity & 7) != 0 || header->begin > header->end || header->end - header->begin > header->capacity)
+		{
+			return false;
+		}
+		_header = header;
+		_records = memory + headerSize;
+		return true;
+	}
+
+
+	void SessionRing::detach()
+	{
+		_header = nullptr;
+		_records = nullptr;
+	}
+
+
+	bool SessionRing::append(SessionRecordType type, const uint8_t* data, uint32_t size)
+	{
+		if (!isAttached())
+		{
+			return false;
+		}
+		const uint64_t capacity = _header->capacity;
+		const uint64_t recordSize = sizeof(RecordHeader) + static_cast<uint64_t>(size);
+		const uint64_t recordStride = alignTo8(recordSize);
+		if (recordStride > capacity / 2)
+		{
+			return false;
+		}
+		// a record isn't split over the end of the ring. The rest of the ring is then filled with padding, which is at least a header
+		// as everything is a multiple of 8.
+		uint64_t end = _header->end;
+		const uint64_t spaceTillWrap = capacity - (end % capacity);
+		const uint64_t padding = spaceTillWrap < recordStride ? spaceTillWrap : 0;
+		while (end + padding + recordStride - _header->begin > capacity)
+		{
+			dropFirstRecord();
+		}
+		RecordHeader header = {};
+		if (padding > 0)
+		{
+			header.size = static_cast<uint32_t>(padding);
+			header.type = static_cast<uint16_t>(SessionRecordType::Padding);
+			memcpy(_records + (end % capacity), &header, sizeof(header));
+			end += padding;
+		}
+		uint8_t* destination = _records + (end % capacity);
+		header.size = static_cast<uint32_t>(recordSize);
+		header.type = static_cast<uint16_t>(type);
+		memcpy(destination, &header, sizeof(header));
+		memcpy(destination + sizeof(header), data, size);
+		memset(destination + recordSize, 0, recordStride - recordSize);
+		_header->end = end + recordStride;
+		return true;
+	}
+
+
+	uint64_t SessionRing::firstPosition() const
+	{
+		return isAttached() ? _header->begin : 0;
+	}
+
+
+	// Reads the record at position and moves position to the next one. Padding is skipped. Returns false if there are no more records or
+	// the ring is damaged.
+	bool SessionRing::read(uint64_t& position, SessionRecordType& type, const uint8_t*& data, uint32_t& size) const
+	{
+		while (true)
+		{
+			RecordHeader header;
+			if (!readHeader(position, header))
+			{
+				return false;
+			}
+			const uint64_t recordPosition = position;
+			position += alignTo8(header.size);
+			if (header.type == static_cast<uint16_t>(SessionRecordType::Padding))
+			{
+				continue;
+			}
+			type = static_cast<SessionRecordType>(header.type);
+			data = _records + (recordPosition % _header->capacity) + sizeof(RecordHeader);
+			size = header.size - static_cast<uint32_t>(sizeof(RecordHeader));
+			return true;
+		}
+	}
+
+
+	uint64_t SessionRing::numberOfDroppedRecords() const
+	{
+		return isAttached() ? _header->numberOfDroppedRecords : 0;
+	}
+
+
+	bool SessionRing::readHeader(uint64_t position, RecordHeader& header) const
+	{
+		if (!isAttached() || position < _header->begin || position >= _header->end)
+		{
+			return false;
+		}
+		const uint64_t offset = position % _header->capacity;
+		memcpy(&header, _records + offset, sizeof(header));
+		const uint64_t stride = alignTo8(header.size);
+		return header.size >= sizeof(RecordHeader) && stride <= _header->capacity - offset && stride <= _header->end - position;
+	}
+
+
+	void SessionRing::dropFirstRecord()
+	{
+		RecordHeader header;
+		if (!readHeader(_header->begin, header))
+		{
+			// nothing valid is left
+			_header->begin = _header->end;
+			return;
+		}
+		_header->begin += alignTo8(header.size);
+		if (header.type != static_cast<uint16_t>(SessionRecordType::Padding))
+		{
+			_header->numberOfDroppedRecords++;
+		}
+	}
+
+
+#ifdef _WIN32
+	SessionFile::SessionFile() : _file(INVALID_HANDLE_VALUE), _mapping(nullptr), _data(nullptr), _size(0)
+	{
+	}
+#else
+	SessionFile::SessionFile() : _file(-1), _data(nullptr), _size(0)
+	{
+	}
+#endif
+
+
+	SessionFile::~SessionFile()
+	{
+		close();
+	}
+
+
+#ifdef _WIN32
+	// Creates the file with the size specified, or overwrites it, and maps it for writing.
+	bool SessionFile::create(const std::filesystem::path& path, uint64_t size)
+	{
+		close();
+		_file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (INVALID_HANDLE_VALUE == _file)
+		{
+			return false;
+		}
+		_mapping = CreateFileMappingW(_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+		_data = nullptr == _mapping ? nullptr : static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(size)));
+		if (nullptr == _data)
+		{
+			close();
+			return false;
+		}
+		_size = size;
+		return true;
+	}
+
+
+	bool SessionFile::open(const std::filesystem::path& path)
+	{
+		close();
+		_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER fileSize;
+		if (INVALID_HANDLE_VALUE == _file || !GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart <= 0)
+		{
+			close();
+			return false;
+		}
+		_mapping = CreateFileMappingW(_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		_data = nullptr == _mapping ? nullptr : static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0));
+		if (nullptr == _data)
+		{
+			close();
+			return false;
+		}
+		_size = static_cast<uint64_t>(fileSize.QuadPart);
+		return true;
+	}
+
+
+	void SessionFile::flush()
+	{
+		if (nullptr != _data)
+		{
+			FlushViewOfFile(_data, 0);
+		}
+	}
+
+
+	void SessionFile::close()
+	{
+		if (nullptr != _data)
+		{
+			UnmapViewOfFile(_data);
+			_data = nullptr;
+		}
+		if (nullptr != _mapping)
+		{
+			CloseHandle(_mapping);
+			_mapping = nullptr;
+		}
+		if (INVALID_HANDLE_VALUE != _file)
+		{
+			CloseHandle(_file);
+			_file = INVALID_HANDLE_VALUE;
+		}
+		_size = 0;
+	}
+#else
+	// Creates the file with the size specified, or overwrites it, and maps it for writing.
+	bool SessionFile::create(const std::filesystem::path& path, uint64_t size)
+	{
+		close();
+		_file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (_file < 0 || ftruncate(_file, static_cast<off_t>(size)) != 0)
+		{
+			close();
+			return false;
+		}
+		void* mapped = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+		if (MAP_FAILED == mapped)
+		{
+			close();
+			return false;
+		}
+		_data = static_cast<uint8_t*>(mapped);
+		_size = size;
+		return true;
+	}
+
+
+	bool SessionFile::open(const std::filesystem::path& path)
+	{
+		close();
+		_file = ::open(path.c_str(), O_RDONLY);
+		struct stat fileStatus;
+		if (_file < 0 || fstat(_file, &fileStatus) != 0 || fileStatus.st_size <= 0)
+		{
+			close();
+			return false;
+		}
+		void* mapped = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, _file, 0);
+		if (MAP_FAILED == mapped)
+		{
+			close();
+			return false;
+		}
+		_data = static_cast<uint8_t*>(mapped);
+		_size = static_cast<uint64_t>(fileStatus.st_size);
+		return true;
+	}
+
+
+	void SessionFile::flush()
+	{
+		if (nullptr != _data)
+		{
+			msync(_data, static_cast<size_t>(_size), MS_ASYNC);
+		}
+	}
+
+
+	void SessionFile::close()
+	{
+		if (nullptr != _data)
+		{
+			munmap(_data, static_cast<size_t>(_size));
+			_data = nullptr;
+		}
+		if (_file >= 0)
+		{
+			::close(_file);
+			_file = -1;
+		}
+		_size = 0;
+	}
+#endif
+
+
+	SessionTickEncoder::SessionTickEncoder()
+	{
+		reset();
+	}
+
+
+	void SessionTickEncoder::reset()
+	{
+		_hasPrevious = false;
+		_previousKeyboard.clear();
+		memset(&_previousGamepad, 0, sizeof(_previousGamepad));
+	}
+
+
+	uint32_t SessionTickEncoder::encode(const TickInput& input, uint8_t* buffer, uint32_t bufferSize)
+	{
+		uint16_t flags = 0;
+		if (input.gameHasFocus)
+		{
+			flags |= TickFlags::GameHasFocus;
+		}
+		if (!_hasPrevious || 0 != memcmp(input.keyboard.keysDown, _previousKeyboard.keysDown, sizeof(_previousKeyboard.keysDown)))
+		{
+			flags |= TickFlags::KeyboardChanged;
+		}
+		if (isMouseInputPresent(input.mouse))
+		{
+			flags |= TickFlags::MouseInputPresent;
+		}
+		if (!_hasPrevious || !gamepadStatesEqual(input.gamepad, _previousGamepad))
+		{
+			flags |= TickFlags::GamepadChanged;
+		}
+		if (input.gamepadConnected)
+		{
+			flags |= TickFlags::GamepadConnected;
+		}
+		if (input.gameCameraFound)
+		{
+			flags |= TickFlags::GameCameraFound;
+		}
+
+		RecordWriter writer(buffer, bufferSize);
+		writer.value(input.nowInMicroseconds);
+		writer.value(input.frameTime.deltaSeconds);
+		writer.value(static_cast<int32_t>(input.frameTime.numberOfSteps));
+		writer.value(input.frameTime.stepSeconds);
+		writer.value(input.frameTime.interpolationFactor);
+		writer.value(flags);
+		if (flags & TickFlags::KeyboardChanged)
+		{
+			for (uint64_t word : input.keyboard.keysDown)
+			{
+				writer.value(word);
+			}
+		}
+		if (flags & TickFlags::MouseInputPresent)
+		{
+			transferMouse(writer, input.mouse);
+		}
+		if (flags & TickFlags::GamepadChanged)
+		{
+			transferGamepad(writer, input.gamepad);
+		}
+		if (flags & TickFlags::GameCameraFound)
+		{
+			for (int32_t coord : input.gameCameraCoords)
+			{
+				writer.value(coord);
+			}
+			writer.value(input.gameCameraFoV);
+		}
+		const uint8_t numberOfMessages = static_cast<uint8_t>((std::max)(0, (std::min)(input.numberOfMessages, TICK_INPUT_MAX_MESSAGES)));
+		writer.value(numberOfMessages);
+		for (int i = 0; i < numberOfMessages; i++)
+		{
+			const PipeMessage& message = input.messages[i];
+			const uint8_t length = (std::min)(message.length, static_cast<uint8_t>(sizeof(message.payload)));
+			writer.value(length);
+			writer.bytes(message.payload, length);
+		}
+
+		_previousKeyboard = input.keyboard;
+		_previousGamepad = input.gamepad;
+		_hasPrevious = true;
+		return writer.size();
+	}
+
+
+	SessionTickDecoder::SessionTickDecoder()
+	{
+		reset();
+	}
+
+
+	void SessionTickDecoder::reset()
+	{
+		_previousKeyboard.clear();
+		memset(&_previousGamepad, 0, sizeof(_previousGamepad));
+	}
+
+
+	bool SessionTickDecoder::decode(const uint8_t* data, uint32_t size, TickInput& input)
+	{
+		memset(&input, 0, sizeof(input));
+		RecordReader reader(data, size);
+		int32_t numberOfSteps;
+		uint16_t flags;
+		reader.value(input.nowInMicroseconds);
+		reader.value(input.frameTime.deltaSeconds);
+		reader.value(numberOfSteps);
+		reader.value(input.frameTime.stepSeconds);
+		reader.value(input.frameTime.interpolationFactor);
+		reader.value(flags);
+		input.frameTime.numberOfSteps = numberOfSteps;
+		input.gameHasFocus = (flags & TickFlags::GameHasFocus) != 0;
+		input.gamepadConnected = (flags & TickFlags::GamepadConnected) != 0;
+		input.gameCameraFound = (flags & TickFlags::GameCameraFound) != 0;
+		input.keyboard = _previousKeyboard;
+		if (flags & TickFlags::KeyboardChanged)
+		{
+			for (uint64_t& word : input.keyboard.keysDown)
+			{
+				reader.value(word);
+			}
+		}
+		if (flags & TickFlags::MouseInputPresent)
+		{
+			transferMouse(reader, input.mouse);
+		}
+		input.gamepad = _previousGamepad;
+		if (flags & TickFlags::GamepadChanged)
+		{
+			transferGamepad(reader, input.gamepad);
+		}
+		if (input.gameCameraFound)
+		{
+			for (int32_t& coord : input.gameCameraCoords)
+			{
+				reader.value(coord);
+			}
+			reader.value(input.gameCameraFoV);
+		}
+		uint8_t numberOfMessages;
+		reader.value(numberOfMessages);
+		if (numberOfMessages > TICK_INPUT_MAX_MESSAGES)
+		{
+			return false;
+		}
+		input.numberOfMessages = numberOfMessages;
+		for (int i = 0; i < numberOfMessages; i++)
+		{
+			PipeMessage& message = input.messages[i];
+			reader.value(message.length);
+			if (message.length > sizeof(message.payload))
+			{
+				return false;
+			}
+			reader.bytes(message.payload, message.length);
+		}
+		if (!reader.succeeded())
+		{
+			return false;
+		}
+		_previousKeyboard = input.keyboard;
+		_previousGamepad = input.gamepad;
+		return true;
+	}
+
+
+	namespace SessionRecords
+	{
+		uint32_t encodeKeyframe(const SessionKeyframe& keyframe, uint8_t* buffer, uint32_t bufferSize)
+		{
+			RecordWriter writer(buffer, bufferSize);
+			// so a recording of a build with a different set of actions isn't misread
+			writer.value(static_cast<uint8_t>(ActionType::Amount));
+			transferKeyframe(writer, keyframe);
+			return writer.size();
+		}
+
+
+		bool decodeKeyframe(const uint8_t* data, uint32_t size, SessionKeyframe& keyframe)
+		{
+			RecordReader reader(data, size);
+			uint8_t numberOfActions;
+			reader.value(numberOfActions);
+			if (numberOfActions != static_cast<uint8_t>(ActionType::Amount))
+			{
+				return false;
+			}
+			transferKeyframe(reader, keyframe);
+			return reader.succeeded();
+		}
+
+
+		uint32_t encodePose(const SessionPose& pose, uint8_t* buffer, uint32_t bufferSize)
+		{
+			RecordWriter writer(buffer, bufferSize);
+			transferPose(writer, pose);
+			return writer.size();
+		}
+
+
+		bool decodePose(const uint8_t* data, uint32_t size, SessionPose& pose)
+		{
+			RecordReader reader(data, size);
+			transferPose(reader, pose);
+			return reader.succeeded();
+		}
+	}
+}
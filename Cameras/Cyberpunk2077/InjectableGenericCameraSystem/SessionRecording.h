@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "Camera.h"
+#include "CameraManipulator.h"
+#include "CameraPoseSeqLock.h"
+#include "Input.h"
+#include "Settings.h"
+#include "TickInput.h"
+#include <cstdint>
+#include <filesystem>
+
+namespace IGCS
+{
+	// The records of a recorded session. A session starts with a keyframe, followed by a tick and a pose record for every tick. The messages
+	// of the client are part of the tick which applied them. Keyframes are repeated every so many ticks, so once the ring has wrapped and 
+	// the first keyframe is gone, the session can still be replayed from the oldest keyframe left.
+	enum class SessionRecordType : uint16_t
+	{
+		Padding = 0,			// fills the end of the ring if the next record doesn't fit there
+		Keyframe = 1,
+		Tick = 2,
+		Pose = 3,
+	};
+
+
+	struct KeyBindingState
+	{
+		uint8_t keyCode;
+		bool altRequired;
+		bool ctrlRequired;
+		bool shiftRequired;
+	};
+
+
+	// The state the ticks depend on, see CameraController::saveState.
+	struct SessionKeyframe
+	{
+		bool cameraStructFound;
+		bool cameraEnabled;
+		bool cameraMovementLocked;
+		bool inputBlocked;
+		bool hudVisible;
+		CameraState camera;
+		GameSpecific::CameraManipulator::CameraManipulatorState cameraManipulator;
+		Input::InputState input;
+		Settings settings;
+		KeyBindingState keyBindings[static_cast<int>(ActionType::Amount)];
+	};
+
+
+	// What a tick handed to the game: the pose published for the interceptor, and the fov.
+	struct SessionPose
+	{
+		bool hasPose;
+		CameraPose pose;
+		float fov;
+	};
+
+
+	// A ring of variable length records in a block of memory, usually a mapped SessionFile. If a record doesn't fit, the oldest records are
+	// dropped. The header is updated after the record is written, so if the process dies, the ring has every record appended before that.
+	// There's one writer and the ring isn't read while it's written.
+	class SessionRing
+	{
+	public:
+		SessionRing();
+		~SessionRing();
+
+		bool attach(uint8_t* memory, uint64_t size, bool clear);
+		void detach();
+		bool isAttached() const { return nullptr != _header; }
+		bool append(SessionRecordType type, const uint8_t* data, uint32_t size);
+		uint64_t firstPosition() const;
+		bool read(uint64_t& position, SessionRecordType& type, const uint8_t*& data, uint32_t& size) const;
+		uint64_t numberOfDroppedRecords() const;
+
+	private:
+		struct RingHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t capacity;					// in bytes, a multiple of 8
+			uint64_t begin;						// positions only increase, the record at a position is at position % capacity
+			uint64_t end;
+			uint64_t numberOfDroppedRecords;
+		};
+
+		struct RecordHeader
+		{
+			uint32_t size;						// in bytes, including the header. The next record starts at the next multiple of 8
+			uint16_t type;
+			uint16_t reserved;
+		};
+
+		bool readHeader(uint64_t position, RecordHeader& header) const;
+		void dropFirstRecord();
+
+		RingHeader* _header;
+		uint8_t* _records;
+	};
+
+
+	// A file mapped into memory. A file which is opened instead of created is mapped copy-on-write, so a replay doesn't change it.
+	class SessionFile
+	{
+	public:
+		SessionFile();
+		~SessionFile();
+		SessionFile(const SessionFile&) = delete;
+		SessionFile& operator=(const SessionFile&) = delete;
+
+		bool create(const std::filesystem::path& path, uint64_t size);
+		bool open(const std::filesystem::path& path);
+		void flush();
+		void close();
+		uint8_t* data() const { return _data; }
+		uint64_t size() const { return _size; }
+
+	private:
+#ifdef _WIN32
+		HANDLE _file;
+		HANDLE _mapping;
+#else
+		int _file;
+#endif
+		uint8_t* _data;
+		uint64_t _size;
+	};
+
+
+	// Tick records only contain the keyboard and the gamepad if they changed since the previous tick, and the mouse input if there is any. 
+	// The encoder and the decoder keep what the previous tick had and start over at a keyframe.
+	class SessionTickEncoder
+	{
+	public:
+		SessionTickEncoder();
+
+		void reset();
+		uint32_t encode(const TickInput& input, uint8_t* buffer, uint32_t bufferSize);
+
+	private:
+		bool _hasPrevious;
+		KeyboardSnapshot _previousKeyboard;
+		GamepadState _previousGamepad;
+	};
+
+
+	class SessionTickDecoder
+	{
+	public:
+		SessionTickDecoder();
+
+		void reset();
+		bool decode(const uint8_t* data, uint32_t size, TickInput& input);
+
+	private:
+		KeyboardSnapshot _previousKeyboard;
+		GamepadState _previousGamepad;
+	};
+
+
+	// The encode functions return the size of the record, 0 if it doesn't fit in the buffer.
+	namespace SessionRecords
+	{
+		uint32_t encodeKeyframe(const SessionKeyframe& keyframe, uint8_t* buffer, uint32_t bufferSize);
+		bool decodeKeyframe(const uint8_t* data, uint32_t size, SessionKeyframe& keyframe);
+		uint32_t encodePose(const SessionPose& pose, uint8_t* buffer, uint32_t bufferSize);
+		bool decodePose(const uint8_t* data, uint32_t size, SessionPose& pose);
+	}
+}
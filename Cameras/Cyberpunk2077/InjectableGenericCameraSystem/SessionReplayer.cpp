@@ -0,0 +1,191 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "SessionReplayer.h"
+#include "CameraController.h"
+#include "CameraManipulator.h"
+#include "Globals.h"
+#include "MessageHandler.h"
+#include <cmath>
+
+namespace IGCS
+{
+	SessionReplayer::SessionReplayer() : _position(0), _result()
+	{
+	}
+
+
+	SessionReplayer::~SessionReplayer()
+	{
+		close();
+	}
+
+
+	bool SessionReplayer::open(const std::filesystem::path& path)
+	{
+		close();
+		if (!_file.open(path) || !_ring.attach(_file.data(), _file.size(), false))
+		{
+			close();
+			MessageHandler::logError("'%s' isn't a session recording.", path.u8string().c_str());
+			return false;
+		}
+		return true;
+	}
+
+
+	void SessionReplayer::close()
+	{
+		_ring.detach();
+		_file.close();
+	}
+
+
+	// Puts the controller in the state of the oldest keyframe in the recording. Returns false if there's no keyframe.
+	bool SessionReplayer::start(CameraController& controller)
+	{
+		_result = SessionReplayResult();
+		_result.firstDifferingTick = -1;
+		_position = _ring.firstPosition();
+		SessionRecordType type;
+		const uint8_t* data;
+		uint32_t size;
+		while (_ring.read(_position, type, data, size))
+		{
+			if (SessionRecordType::Keyframe != type)
+			{
+				// the ticks before the oldest keyframe left can't be replayed, their state is gone
+				continue;
+			}
+			SessionKeyframe keyframe = {};
+			if (!SessionRecords::decodeKeyframe(data, size, keyframe))
+			{
+				MessageHandler::logError("The session recording has a keyframe of another version of the camera.");
+				return false;
+			}
+			controller.restoreState(keyframe);
+			_tickDecoder.reset();
+			return true;
+		}
+		return false;
+	}
+
+
+	// Runs the next recorded tick and compares its pose with the recorded one. Keyframes after the first only start a new tick sequence,
+	// the state isn't restored from them, so a replay which goes off course stays off course and the difference shows up in the result.
+	// Returns false if there are no ticks left.
+	bool SessionReplayer::replayNextTick(CameraController& controller)
+	{
+		SessionRecordType type;
+		const uint8_t* data;
+		uint32_t size;
+		while (_ring.read(_position, type, data, size))
+		{
+			switch (type)
+			{
+				case SessionRecordType::Keyframe:
+					_tickDecoder.reset();
+					break;
+				case SessionRecordType::Tick:
+				{
+					TickInput input;
+					if (!_tickDecoder.decode(data, size, input))
+					{
+						MessageHandler::logError("Tick %d in the session recording is damaged.", _result.numberOfTicks);
+						return false;
+					}
+					if (input.gameCameraFound)
+					{
+						GameSpecific::CameraManipulator::writeGameCameraData(input.gameCameraCoords, input.gameCameraFoV);
+					}
+					controller.update(input);
+					_result.numberOfTicks++;
+					// the pose of the tick directly follows it
+					uint64_t posePosition = _position;
+					SessionPose recordedPose;
+					if (_ring.read(posePosition, type, data, size) && SessionRecordType::Pose == type && SessionRecords::decodePose(data, size, recordedPose))
+					{
+						_position = posePosition;
+						comparePose(recordedPose);
+					}
+					return true;
+				}
+				default:
+					// a pose without a tick, which happens if the ring dropped the tick
+					break;
+			}
+		}
+		return false;
+	}
+
+
+	void SessionReplayer::replayAll(CameraController& controller)
+	{
+		while (replayNextTick(controller))
+		{
+		}
+	}
+
+
+	void SessionReplayer::comparePose(const SessionPose& recorded)
+	{
+		SessionPose replayed = {};
+		replayed.hasPose = g_cameraPose.read(replayed.pose);
+		if (!replayed.hasPose)
+		{
+			replayed.pose = CameraPose();
+		}
+		replayed.fov = GameSpecific::CameraManipulator::getCurrentFoV();
+		_result.numberOfPosesCompared++;
+
+		bool differs = replayed.hasPose != recorded.hasPose;
+		for (int i = 0; i < 3; i++)
+		{
+			const int32_t difference = std::abs(replayed.pose.coords[i] - recorded.pose.coords[i]);
+			_result.maxCoordDifference = (std::max)(_result.maxCoordDifference, difference);
+			differs |= difference != 0;
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			const float difference = std::fabs(replayed.pose.quaternion[i] - recorded.pose.quaternion[i]);
+			_result.maxQuaternionDifference = (std::max)(_result.maxQuaternionDifference, difference);
+			differs |= difference != 0.0f;
+		}
+		const float fovDifference = std::fabs(replayed.fov - recorded.fov);
+		_result.maxFoVDifference = (std::max)(_result.maxFoVDifference, fovDifference);
+		differs |= fovDifference != 0.0f;
+		if (differs)
+		{
+			if (0 == _result.numberOfPosesDiffering)
+			{
+				_result.firstDifferingTick = _result.numberOfTicks - 1;
+			}
+			_result.numberOfPosesDiffering++;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "SessionRecording.h"
+#include <filesystem>
+
+namespace IGCS
+{
+	class CameraController;
+
+	// How a replayed session compares to the recording.
+	struct SessionReplayResult
+	{
+		int numberOfTicks;
+		int numberOfPosesCompared;
+		int numberOfPosesDiffering;
+		int firstDifferingTick;					// -1 if all poses are the same
+		int32_t maxCoordDifference;				// in packed units
+		float maxQuaternionDifference;
+		float maxFoVDifference;
+	};
+
+
+	// Replays a session recorded by SessionRecorder through a CameraController, from the oldest keyframe in the recording, and compares the
+	// poses the controller produces with the recorded ones. The recorded camera struct contents are written to the camera struct before every
+	// tick, so the camera struct has to be found, which can be a block of memory outside the game. The file isn't changed by a replay.
+	class SessionReplayer
+	{
+	public:
+		SessionReplayer();
+		~SessionReplayer();
+
+		bool open(const std::filesystem::path& path);
+		void close();
+		bool start(CameraController& controller);
+		bool replayNextTick(CameraController& controller);
+		void replayAll(CameraController& controller);
+		const SessionReplayResult& result() const { return _result; }
+
+	private:
+		void comparePose(const SessionPose& recorded);
+
+		SessionFile _file;
+		SessionRing _ring;
+		SessionTickDecoder _tickDecoder;
+		uint64_t _position;
+		SessionReplayResult _result;
+	};
+}
@@ -27,10 +27,9 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "stdafx.h"
-#include "Gamepad.h"
 #include "Utils.h"
 #include "GameConstants.h"
-#include "Defaults.h"
+#include "SystemDefaults.h"
 #include <map>
 #include "ActionData.h"
 
@@ -56,7 +55,7 @@ namespace IGCS
 		bool timeOfDayChanged = false;
 		bool wetnessSettingsChanged = false;
 		
-		void setValueFromMessage(uint8_t payload[], DWORD payloadLength)
+		void setValueFromMessage(uint8_t payload[], uint32_t payloadLength)
 		{
 			// byte 1 is the id of the setting. Bytes 2 and further contain the data for the setting.
 			if(payloadLength<3)
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include <atomic>
+#include <cstddef>
+
+namespace IGCS
+{
+	// Fixed size, lock free ring buffer for one producer thread and one consumer thread. The producer never waits: if the ring is full,
+	// push() fails and the item is dropped. Capacity has to be a power of 2.
+	template<typename T, size_t Capacity>
+	class SpscRing
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of 2");
+
+	public:
+		SpscRing() : _head(0), _cachedTail(0), _tail(0), _cachedHead(0), _items() {}
+
+		// producer thread only
+		bool push(const T& item)
+		{
+			const size_t tail = _tail.load(std::memory_order_relaxed);
+			if (tail - _cachedHead == Capacity)
+			{
+				// looks full, see how far the consumer got
+				_cachedHead = _head.load(std::memory_order_acquire);
+				if (tail - _cachedHead == Capacity)
+				{
+					return false;
+				}
+			}
+			_items[tail & (Capacity - 1)] = item;
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer thread only
+		bool pop(T& item)
+		{
+			const size_t head = _head.load(std::memory_order_relaxed);
+			if (head == _cachedTail)
+			{
+				// looks empty, see how far the producer got
+				_cachedTail = _tail.load(std::memory_order_acquire);
+				if (head == _cachedTail)
+				{
+					return false;
+				}
+			}
+			item = _items[head & (Capacity - 1)];
+			_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		// the indices only increase, the slot is the index modulo Capacity. Each is on its own cache line, with the copy of the other index
+		// its thread uses, so the threads only share a cache line when the ring looks full or empty.
+		alignas(64) std::atomic<size_t> _head;		// next item to pop, written by the consumer
+		size_t _cachedTail;							// consumer's copy of _tail
+		alignas(64) std::atomic<size_t> _tail;		// next slot to push to, written by the producer
+		size_t _cachedHead;							// producer's copy of _head
+		alignas(64) T _items[Capacity];
+	};
+}
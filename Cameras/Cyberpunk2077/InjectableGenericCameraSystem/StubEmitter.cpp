@@ -0,0 +1,368 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "StubEmitter.h"
+#include "InstructionDecoder.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace IGCS
+{
+	struct BranchFixup
+	{
+		size_t position;		// position of the rel32 in the emitted code
+		int targetOffset;		// offset of the branch target in the displaced code
+	};
+
+
+	static std::string formatError(const char* fmt, ...)
+	{
+		char buffer[512];
+		va_list args;
+		va_start(args, fmt);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
+		va_end(args);
+		return std::string(buffer);
+	}
+
+
+	StubEmitter::StubEmitter(uint8_t* stubAddress) : _stubAddress{ stubAddress }
+	{
+	}
+
+
+	StubEmitter::~StubEmitter()
+	{
+	}
+
+
+	// Emits a complete capture stub: the capture, the relocated displaced code and a jmp back to the game's code right after the displaced
+	// code. displacedLength has to end on an instruction boundary.
+	bool StubEmitter::emitCaptureStub(const CaptureDescription& capture, const uint8_t* displacedCode, int displacedLength)
+	{
+		if (nullptr == capture.destinationSlot)
+		{
+			_lastError = "No destination slot specified for the captured value.";
+			return false;
+		}
+		if (!capture.captureAfterDisplacedCode)
+		{
+			emitCapture(capture);
+		}
+		if (!emitRelocatedCode(displacedCode, displacedLength))
+		{
+			return false;
+		}
+		if (capture.captureAfterDisplacedCode)
+		{
+			emitCapture(capture);
+		}
+		emitJumpAbsolute(displacedCode + displacedLength);
+		return true;
+	}
+
+
+	// Emits the instructions in code so they behave the same at their new address: rip relative displacements are adjusted, branches within
+	// code are re-targeted to their relocated instruction and branches out of code become absolute jumps, as the stub can be anywhere. A
+	// branch to the end of code goes to what's emitted after the relocated code, e.g. the capture and the jmp back of a capture stub.
+	bool StubEmitter::emitRelocatedCode(const uint8_t* code, int length)
+	{
+		// one more for the end of the code
+		std::vector<int> relocatedOffsets(length + 1, -1);
+		std::vector<BranchFixup> fixups;
+		int offset = 0;
+		while (offset < length)
+		{
+			DecodedInstruction instruction;
+			if (!InstructionDecoder::decode(code + offset, length - offset, instruction))
+			{
+				_lastError = formatError("The instruction at offset %d of the displaced code can't be decoded or doesn't end within the displaced code.", offset);
+				return false;
+			}
+			relocatedOffsets[offset] = this->length();
+			const uint8_t* source = code + offset;
+			const uint8_t* sourceNext = source + instruction.length;
+			if (instruction.isRelativeBranch)
+			{
+				for (int i = 0; i < instruction.opcodeOffset; i++)
+				{
+					if (source[i] == 0x66)
+					{
+						_lastError = formatError("The branch at offset %d of the displaced code has a 16 bit operand, which isn't supported.", offset);
+						return false;
+					}
+				}
+				int64_t relative = 0;
+				if (instruction.immediateSize == 1)
+				{
+					relative = static_cast<int8_t>(source[instruction.immediateOffset]);
+				}
+				else
+				{
+					int32_t relative32;
+					memcpy(&relative32, source + instruction.immediateOffset, sizeof(int32_t));
+					relative = relative32;
+				}
+				const uint8_t* target = sourceNext + relative;
+				int64_t targetOffset = target - code;
+				bool isInternal = targetOffset >= 0 && targetOffset <= length;
+				uint8_t opcode = source[instruction.opcodeOffset];
+				if (opcode == 0xE8)
+				{
+					// call
+					if (isInternal)
+					{
+						emitByte(0xE8);
+						fixups.push_back({ _code.size(), static_cast<int>(targetOffset) });
+						emitInt32(0);
+					}
+					else
+					{
+						// call qword ptr [rip+2]; jmp over the address; address
+						emitByte(0xFF); emitByte(0x15); emitInt32(2);
+						emitByte(0xEB); emitByte(0x08);
+						emitAddress(target);
+					}
+				}
+				else if (opcode == 0xE9 || opcode == 0xEB)
+				{
+					// jmp
+					if (isInternal)
+					{
+						emitByte(0xE9);
+						fixups.push_back({ _code.size(), static_cast<int>(targetOffset) });
+						emitInt32(0);
+					}
+					else
+					{
+						emitJumpAbsolute(target);
+					}
+				}
+				else if ((opcode & 0xF0) == 0x70 || (opcode == 0x0F && (source[instruction.opcodeOffset + 1] & 0xF0) == 0x80))
+				{
+					// jcc
+					uint8_t condition = (opcode == 0x0F ? source[instruction.opcodeOffset + 1] : opcode) & 0x0F;
+					if (isInternal)
+					{
+						emitByte(0x0F); emitByte(0x80 | condition);
+						fixups.push_back({ _code.size(), static_cast<int>(targetOffset) });
+						emitInt32(0);
+					}
+					else
+					{
+						// the inverted condition jumps over the absolute jmp.
+						emitByte(0x70 | (condition ^ 0x01)); emitByte(0x0E);
+						emitJumpAbsolute(target);
+					}
+				}
+				else if (opcode >= 0xE0 && opcode <= 0xE3)
+				{
+					// loop / jrcxz only have a rel8 form: keep the instruction with its prefixes and let it jump to a jmp to the target.
+					_code.insert(_code.end(), source, source + instruction.opcodeOffset);
+					emitByte(opcode); emitByte(0x02);
+					if (isInternal)
+					{
+						emitByte(0xEB); emitByte(0x05);
+						emitByte(0xE9);
+						fixups.push_back({ _code.size(), static_cast<int>(targetOffset) });
+						emitInt32(0);
+					}
+					else
+					{
+						emitByte(0xEB); emitByte(0x0E);
+						emitJumpAbsolute(target);
+					}
+				}
+				else
+				{
+					_lastError = formatError("The relative branch at offset %d of the displaced code can't be relocated.", offset);
+					return false;
+				}
+			}
+			else
+			{
+				size_t start = _code.size();
+				_code.insert(_code.end(), source, sourceNext);
+				if (instruction.isRipRelative)
+				{
+					int32_t displacement;
+					memcpy(&displacement, source + instruction.displacementOffset, sizeof(int32_t));
+					const uint8_t* target = sourceNext + displacement;
+					int64_t newDisplacement = target - (_stubAddress + _code.size());
+					if (!fitsInInt32(newDisplacement))
+					{
+						_lastError = formatError("The rip relative operand of the instruction at offset %d of the displaced code can't be reached from the stub.", offset);
+						return false;
+					}
+					int32_t newDisplacement32 = static_cast<int32_t>(newDisplacement);
+					memcpy(&_code[start + instruction.displacementOffset], &newDisplacement32, sizeof(int32_t));
+				}
+			}
+			offset += instruction.length;
+		}
+		relocatedOffsets[length] = this->length();
+		for (auto& fixup : fixups)
+		{
+			int relocatedTarget = relocatedOffsets[fixup.targetOffset];
+			if (relocatedTarget < 0)
+			{
+				_lastError = formatError("A branch in the displaced code jumps to offset %d, which isn't the start of an instruction.", fixup.targetOffset);
+				return false;
+			}
+			int32_t relative = relocatedTarget - static_cast<int32_t>(fixup.position + sizeof(int32_t));
+			memcpy(&_code[fixup.position], &relative, sizeof(int32_t));
+		}
+		return true;
+	}
+
+
+	// Emits code which stores the value described by capture in its destination slot. Only uses mov, push and pop so the flags are kept. 
+	// Two scratch registers are saved on the stack, so an rsp relative capture is corrected for them.
+	void StubEmitter::emitCapture(const CaptureDescription& capture)
+	{
+		X64Register scratch[2];
+		int numberOfScratchRegisters = 0;
+		for (X64Register candidate : { X64Register::RAX, X64Register::RCX, X64Register::RDX })
+		{
+			if (candidate != capture.registerToCapture && numberOfScratchRegisters < 2)
+			{
+				scratch[numberOfScratchRegisters++] = candidate;
+			}
+		}
+		int32_t stackCorrection = capture.registerToCapture == X64Register::RSP ? 2 * 8 : 0;
+		emitPush(scratch[0]);
+		emitPush(scratch[1]);
+		if (capture.isDereferenced)
+		{
+			// mov scratch0, [register+offset]
+			emitMemoryOperand(0x8B, scratch[0], capture.registerToCapture, capture.offset + stackCorrection);
+		}
+		else if (stackCorrection > 0)
+		{
+			// lea scratch0, [rsp+16]
+			emitMemoryOperand(0x8D, scratch[0], capture.registerToCapture, stackCorrection);
+		}
+		else
+		{
+			// mov scratch0, register
+			int source = static_cast<int>(capture.registerToCapture);
+			int destination = static_cast<int>(scratch[0]);
+			emitRexW(source, destination);
+			emitByte(0x89);
+			emitByte(0xC0 | ((source & 0x07) << 3) | (destination & 0x07));
+		}
+		// mov scratch1, destinationSlot
+		emitRexW(0, static_cast<int>(scratch[1]));
+		emitByte(0xB8 | (static_cast<int>(scratch[1]) & 0x07));
+		emitAddress(capture.destinationSlot);
+		// mov [scratch1], scratch0
+		emitMemoryOperand(0x89, scratch[0], scratch[1], 0);
+		emitPop(scratch[1]);
+		emitPop(scratch[0]);
+	}
+
+
+	// Emits jmp qword ptr [rip+0] followed by the target address.
+	void StubEmitter::emitJumpAbsolute(const uint8_t* target)
+	{
+		emitByte(0xFF);
+		emitByte(0x25);
+		emitInt32(0);
+		emitAddress(target);
+	}
+
+
+	void StubEmitter::emitByte(uint8_t value)
+	{
+		_code.push_back(value);
+	}
+
+
+	void StubEmitter::emitInt32(int32_t value)
+	{
+		uint8_t bytes[sizeof(int32_t)];
+		memcpy(bytes, &value, sizeof(int32_t));
+		_code.insert(_code.end(), bytes, bytes + sizeof(int32_t));
+	}
+
+
+	void StubEmitter::emitAddress(const void* address)
+	{
+		uint64_t value = reinterpret_cast<uintptr_t>(address);
+		uint8_t bytes[sizeof(uint64_t)];
+		memcpy(bytes, &value, sizeof(uint64_t));
+		_code.insert(_code.end(), bytes, bytes + sizeof(uint64_t));
+	}
+
+
+	// Emits a REX prefix for a 64 bit operation, with the high bits of the register numbers in the ModRM reg and rm fields.
+	void StubEmitter::emitRexW(int reg, int rm)
+	{
+		emitByte(0x48 | ((reg & 0x08) ? 0x04 : 0x00) | ((rm & 0x08) ? 0x01 : 0x00));
+	}
+
+
+	void StubEmitter::emitPush(X64Register toPush)
+	{
+		int index = static_cast<int>(toPush);
+		if (index & 0x08)
+		{
+			emitByte(0x41);
+		}
+		emitByte(0x50 | (index & 0x07));
+	}
+
+
+	void StubEmitter::emitPop(X64Register toPop)
+	{
+		int index = static_cast<int>(toPop);
+		if (index & 0x08)
+		{
+			emitByte(0x41);
+		}
+		emitByte(0x58 | (index & 0x07));
+	}
+
+
+	// Emits a 64 bit instruction with opcode and the operand [base+displacement], always with a 32 bit displacement.
+	void StubEmitter::emitMemoryOperand(uint8_t opcode, X64Register reg, X64Register base, int32_t displacement)
+	{
+		int regIndex = static_cast<int>(reg);
+		int baseIndex = static_cast<int>(base);
+		emitRexW(regIndex, baseIndex);
+		emitByte(opcode);
+		emitByte(0x80 | ((regIndex & 0x07) << 3) | (baseIndex & 0x07));
+		if ((baseIndex & 0x07) == 0x04)
+		{
+			// rsp and r12 need a SIB byte without index.
+			emitByte(0x24);
+		}
+		emitInt32(displacement);
+	}
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IGCS
+{
+	// x64 general purpose registers, in the order of their encoding.
+	enum class X64Register : uint8_t
+	{
+		RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+		R8, R9, R10, R11, R12, R13, R14, R15,
+	};
+
+
+	// Describes what a capture stub stores: either the value of a register or the qword at [register+offset]. destinationSlot is the
+	// address of the 8 byte variable which receives the value, e.g. &g_pmStructAddress.
+	struct CaptureDescription
+	{
+		CaptureDescription(X64Register registerToCapture, void* destinationSlot, bool captureAfterDisplacedCode = false)
+			: registerToCapture{ registerToCapture }, isDereferenced{ false }, offset{ 0 }, destinationSlot{ destinationSlot }, 
+			  captureAfterDisplacedCode{ captureAfterDisplacedCode }
+		{
+		}
+
+		CaptureDescription(X64Register baseRegister, int32_t offset, void* destinationSlot, bool captureAfterDisplacedCode = false)
+			: registerToCapture{ baseRegister }, isDereferenced{ true }, offset{ offset }, destinationSlot{ destinationSlot },
+			  captureAfterDisplacedCode{ captureAfterDisplacedCode }
+		{
+		}
+
+		X64Register registerToCapture;
+		bool isDereferenced;
+		int32_t offset;
+		void* destinationSlot;
+		bool captureAfterDisplacedCode;		// if false, the value is captured before the displaced code runs
+	};
+
+
+	// Emits x64 code for interceptor stubs at runtime, instead of writing them by hand in an asm file. A capture stub stores a register (or
+	// what it points to) in a slot, then runs the instructions the hook's jmp overwrote, relocated to the stub, and jumps back to the game's
+	// code. The code is emitted for the address the stub will live at, so stubAddress has to be known up front: rip relative operands of
+	// relocated instructions are only reachable if the stub is within 2GB of them. Emitting only produces bytes, it doesn't write anywhere.
+	class StubEmitter
+	{
+	public:
+		StubEmitter(uint8_t* stubAddress);
+		~StubEmitter();
+
+		bool emitCaptureStub(const CaptureDescription& capture, const uint8_t* displacedCode, int displacedLength);
+		bool emitRelocatedCode(const uint8_t* code, int length);
+		void emitCapture(const CaptureDescription& capture);
+		void emitJumpAbsolute(const uint8_t* target);
+
+		std::vector<uint8_t>& code() { return _code; }
+		int length() { return static_cast<int>(_code.size()); }
+		std::string lastError() { return _lastError; }
+
+	private:
+		void emitByte(uint8_t value);
+		void emitInt32(int32_t value);
+		void emitAddress(const void* address);
+		void emitRexW(int reg, int rm);
+		void emitPush(X64Register toPush);
+		void emitPop(X64Register toPop);
+		void emitMemoryOperand(uint8_t opcode, X64Register reg, X64Register base, int32_t displacement);
+		bool fitsInInt32(int64_t value) { return value >= INT32_MIN && value <= INT32_MAX; }
+
+		uint8_t* _stubAddress;
+		std::vector<uint8_t> _code;
+		std::string _lastError;
+	};
+}
@@ -38,12 +38,13 @@
 #include "MinHook.h"
 #include "NamedPipeManager.h"
 #include "MessageHandler.h"
+#include "GameImageHooker.h"
 
 namespace IGCS
 {
 	using namespace IGCS::GameSpecific;
 
-	System::System()
+	System::System() : _frameClock(_timeSource)
 	{
 	}
 
@@ -63,356 +64,101 @@ namespace IGCS
 		_hostExePath = hostExeFilenameAndPath.parent_path();
 		Globals::instance().gamePad().setInvertLStickY(CONTROLLER_Y_INVERT);
 		Globals::instance().gamePad().setInvertRStickY(CONTROLLER_Y_INVERT);
-		initialize();		// will block till camera is found
-		mainLoop();
-	}
-
-
-	// Core loop of the system
-	void System::mainLoop()
-	{
-		while (Globals::instance().systemActive())
+		Globals::instance().gamePad().setStickResponse(GAMEPAD_LSTICK_DEADZONE, GAMEPAD_RSTICK_DEADZONE, GAMEPAD_STICK_OUTER_DEADZONE, GAMEPAD_STICK_RESPONSE_EXPONENT);
+		Globals::instance().gamePad().setTriggerResponse(GAMEPAD_TRIGGER_DEADZONE, 1.0f, GAMEPAD_TRIGGER_RESPONSE_EXPONENT);
+		Globals::instance().gamePad().startPolling(GAMEPAD_POLL_INTERVAL_MS, GAMEPAD_MIN_RECONNECT_INTERVAL_MS, GAMEPAD_MAX_RECONNECT_INTERVAL_MS);
+		_frameClock.setTickRate(CAMERA_TICK_RATE);
+		_frameClock.setFixedStepRate(CAMERA_FIXED_STEP_RATE);
+		_frameClock.setMaxDeltaSeconds(MAX_TICK_DELTA_SECONDS);
+		if (SESSION_RECORDING_ENABLED)
 		{
-			Sleep(FRAME_SLEEP);
-			updateFrame();
+			_sessionRecorder.start(_hostExePath / SESSION_RECORDING_FILENAME, SESSION_RECORDING_SIZE_MB * 1024 * 1024, SESSION_KEYFRAME_INTERVAL_TICKS);
 		}
+		initialize();		// will block till camera is found
+		mainLoop();
 	}
 
 
-	// updates the data and camera for a frame 
-	void System::updateFrame()
-	{
-		handleUserInput();
-		CameraManipulator::updateCameraDataInGameData(_camera);
-	}
-
-
-	bool System::checkIfGameHasFocus()
-	{
-		HWND currentForegroundWindow = GetForegroundWindow();
-		return (currentForegroundWindow == Globals::instance().mainWindowHandle());
-	}
-
-
-	void System::onCameraDisabled()
-	{
-		CameraManipulator::restoreOriginalValuesAfterCameraDisable();
-		toggleCameraMovementLockState(false);
-	}
-
-	void System::onCameraEnabled()
-	{
-		CameraManipulator::cacheOriginalValuesBeforeCameraEnable();
-		_camera.resetAngles();
-	}
-
-	void System::handleUserInput()
+	// Gives the game back its original state and code: the camera is disabled, all hooks are removed and the named pipe threads are stopped.
+	// Call this after start() has returned. Returns true if the dll can be unloaded safely, false if the game can still end up in our code.
+	bool System::shutdown()
 	{
-		if (!checkIfGameHasFocus())
+		MessageHandler::logLine("Shutting down the camera system...");
+		_sessionRecorder.stop();
+		_cameraController.restoreGameState();
+		// the polling thread calls XInputGetState, which goes through our hook
+		Globals::instance().gamePad().stopPolling();
+		bool hooksRemoved = GameImageHooker::removeAllHooks();
+		bool inputHooksRemoved = InputHooker::removeInputHooks();
+		bool canUnload = hooksRemoved && inputHooksRemoved;
+		if (canUnload)
 		{
-			// our window isn't focused, exit
-			return;
+			// threads which were inside a stub or an interceptor when the hooks were removed have to leave it before the memory goes away.
+			Sleep(SHUTDOWN_GRACE_PERIOD_MS);
+			GameImageHooker::releaseStubMemory();
+			MessageHandler::logLine("All hooks removed. The camera dll will be unloaded.");
 		}
-		
-		Globals::instance().gamePad().update();
-		if (_applyHammerPrevention)
-		{
-			_applyHammerPrevention = false;
-			// sleep main thread for 300ms so key repeat delay is simulated. 
-			Sleep(300);
-		}
-
-		if (!_cameraStructFound)
+		else
 		{
-			// camera not found yet, can't proceed.
-			return;
+			MessageHandler::logError("Not all hooks could be removed, so the camera dll stays loaded. Please restart the game.");
 		}
+		NamedPipeManager::instance().stopListening();
+		return canUnload;
+	}
 
-		// If we've changed settings by a keyboard setting, we'll apply them here. 
-		CameraManipulator::applySettingsToGameState();
-
-#ifdef _DEBUG
-		if(Utils::keyDown(VK_END))
-		{
-			CameraManipulator::displayDebugInfo();
-			_applyHammerPrevention = true;
-		}
-#endif
-		
-		if (Input::isActionActivated(ActionType::CameraEnable))
-		{
-			if (g_cameraEnabled)
-			{
-				// it's going to be disabled, make sure things are alright when we give it back to the host
-				onCameraDisabled();
-			}
-			else
-			{
-				// it's going to be enabled, so cache the original values before we enable it so we can restore it afterwards
-				onCameraEnabled();
-			}
-			g_cameraEnabled = g_cameraEnabled == 0 ? (uint8_t)1 : (uint8_t)0;
-			displayCameraState();
-			_applyHammerPrevention = true;
-		}
 
-		if (Input::isActionActivated(ActionType::TimeOfDayEarlier, true))
-		{
-			CameraManipulator::changeTimeOfDayUsingAmount(-DEFAULT_TOD_CHANGE * (Utils::altPressed() ? 0.1f : 1.0f));
-		}
-		if (Input::isActionActivated(ActionType::TimeOfDayLater, true))
-		{
-			CameraManipulator::changeTimeOfDayUsingAmount(DEFAULT_TOD_CHANGE * (Utils::altPressed() ? 0.1f : 1.0f));
-		}
-		if (Input::isActionActivated(ActionType::FovReset) && Globals::instance().keyboardMouseControlCamera())
-		{
-			CameraManipulator::resetFoV();
-		}
-		if (Input::isActionActivated(ActionType::FovDecrease) && Globals::instance().keyboardMouseControlCamera())
-		{
-			CameraManipulator::changeFoV(-Globals::instance().settings().fovChangeSpeed);
-		}
-		if (Input::isActionActivated(ActionType::FovIncrease) && Globals::instance().keyboardMouseControlCamera())
-		{
-			CameraManipulator::changeFoV(Globals::instance().settings().fovChangeSpeed);
-		}
-		if (Input::isActionActivated(ActionType::Timestop))
-		{
-			toggleGamePause();
-			_applyHammerPrevention = true;
-		}
-		if (Input::isActionActivated(ActionType::SkipFrames))
-		{
-			CameraManipulator::stepGameInPause();
-			_applyHammerPrevention = true;
-		}
-		if (Input::isActionActivated(ActionType::HudToggle))
-		{
-			toggleHud();
-			_applyHammerPrevention = true;
-		}
-		if (!g_cameraEnabled)
-		{
-			// camera is disabled. We simply disable all input to the camera movement, by returning now.
-			return;
-		}
-		if (Input::isActionActivated(ActionType::BlockInput))
-		{
-			toggleInputBlockState(!Globals::instance().inputBlocked());
-			_applyHammerPrevention = true;
-		}
-		_camera.resetMovement();
-		Settings& settings = Globals::instance().settings();
-		if (Input::isActionActivated(ActionType::CameraLock)) 
-		{
-			toggleCameraMovementLockState(!_cameraMovementLocked);
-			_applyHammerPrevention = true;
-		}
-		if (_cameraMovementLocked)
+	// Core loop of the system
+	void System::mainLoop()
+	{
+		_frameClock.reset();
+		while (Globals::instance().systemActive())
 		{
-			// no movement allowed, simply return
-			return;
+			// Sleep has a coarse granularity and the scheduler adds jitter, which is fine as the camera moves by the time that actually elapsed.
+			Sleep(static_cast<DWORD>((_frameClock.microsecondsTillNextTick() + 999) / 1000));
+			updateFrame(_frameClock.tick());
 		}
-
-		bool altPressed = Utils::altPressed();
-		bool controlPressed = Utils::ctrlPressed();
-		float multiplier = altPressed ? settings.fastMovementMultiplier : controlPressed ? settings.slowMovementMultiplier : 1.0f;
-		// Calculates a multiplier based on the current fov. We have a baseline of DEFAULT_FOV. If the fov is > than that, use 1.0
-		// otherwise calculate a factor by using the currentfov / DEFAULT_FOV. Cap the minimum at 0.1 so some movement is still possible :)
-		multiplier *= Utils::clamp(abs(CameraManipulator::getCurrentFoV()) / DEFAULT_FOV_DEGREES, 0.01f, 1.0f);
-		_applyHammerPrevention |= handleKeyboardCameraMovement(multiplier);
-		handleMouseCameraMovement(multiplier);
-		handleGamePadMovement(multiplier);
 	}
 
 
-	void System::handleGamePadMovement(float multiplierBase)
+	// updates the data and camera for a frame 
+	void System::updateFrame(const FrameTime& frameTime)
 	{
-		if(!Globals::instance().controllerControlsCamera())
+		TickInput input = {};
+		captureTickInput(frameTime, input);
+		if (_sessionRecorder.isRecording())
 		{
-			return;
+			_sessionRecorder.recordTick(input, _cameraController);
 		}
-
-		auto gamePad = Globals::instance().gamePad();
-
-		if (gamePad.isConnected())
+		_cameraController.update(input);
+		if (_sessionRecorder.isRecording())
 		{
-			Settings& settings = Globals::instance().settings();
-			float  multiplier = gamePad.isButtonPressed(IGCS_BUTTON_FASTER) ? settings.fastMovementMultiplier 
-																			: gamePad.isButtonPressed(IGCS_BUTTON_SLOWER) ? settings.slowMovementMultiplier : multiplierBase;
-			vec2 rightStickPosition = gamePad.getRStickPosition();
-			_camera.pitch(rightStickPosition.y * multiplier);
-			_camera.yaw(rightStickPosition.x * multiplier);
-
-			vec2 leftStickPosition = gamePad.getLStickPosition();
-			_camera.moveUp((gamePad.getLTrigger() - gamePad.getRTrigger()) * multiplier);
-			_camera.moveForward(leftStickPosition.y * multiplier);
-			_camera.moveRight(leftStickPosition.x * multiplier);
-
-			if (gamePad.isButtonPressed(IGCS_BUTTON_TILT_LEFT))
-			{
-				_camera.roll(multiplier);
-			}
-			if (gamePad.isButtonPressed(IGCS_BUTTON_TILT_RIGHT))
-			{
-				_camera.roll(-multiplier);
-			}
-			if (gamePad.isButtonPressed(IGCS_BUTTON_RESET_FOV))
-			{
-				CameraManipulator::resetFoV();
-			}
-			if (gamePad.isButtonPressed(IGCS_BUTTON_FOV_DECREASE))
-			{
-				CameraManipulator::changeFoV(-Globals::instance().settings().fovChangeSpeed);
-			}
-			if (gamePad.isButtonPressed(IGCS_BUTTON_FOV_INCREASE))
-			{
-				CameraManipulator::changeFoV(Globals::instance().settings().fovChangeSpeed);
-			}
+			_sessionRecorder.recordPose();
 		}
 	}
 
 
-	void System::handleMouseCameraMovement(float multiplier)
+	// Collects everything the next tick takes from outside the camera system, see TickInput.
+	void System::captureTickInput(const FrameTime& frameTime, TickInput& input)
 	{
-		if (!Globals::instance().keyboardMouseControlCamera())
-		{
-			return;
-		}
-		long mouseDeltaX = Input::getMouseDeltaX();
-		long mouseDeltaY = Input::getMouseDeltaY();
-		bool leftButtonPressed = Input::isMouseButtonDown(0);
-		bool rightButtonPressed = Input::isMouseButtonDown(1);
-		bool noButtonPressed = !(leftButtonPressed || rightButtonPressed);
-		if (abs(mouseDeltaY) > 1)
-		{
-			float yValue = (static_cast<float>(mouseDeltaY) * MOUSE_SPEED_CORRECTION * multiplier);
-			if (noButtonPressed)
-			{
-				_camera.pitch(-yValue);
-			}
-			else
-			{
-				if (leftButtonPressed)
-				{
-					// move up / down
-					_camera.moveUp(-yValue);
-				}
-				else
-				{
-					// forward/backwards
-					_camera.moveForward(-yValue);
-				}
-			}
-		}
-		if (abs(mouseDeltaX) > 1)
+		input.nowInMicroseconds = _timeSource.nowInMicroseconds();
+		input.frameTime = frameTime;
+		input.gameHasFocus = checkIfGameHasFocus();
+		Input::captureKeyboard(input.keyboard);
+		input.mouse = Input::captureMouseInput();
+		input.gamepadConnected = Globals::instance().gamePad().readState(input.gamepad);
+		input.gameCameraFound = CameraManipulator::readGameCameraData(input.gameCameraCoords, input.gameCameraFoV);
+		input.numberOfMessages = 0;
+		while (input.numberOfMessages < TICK_INPUT_MAX_MESSAGES && Globals::instance().dequeueMessage(input.messages[input.numberOfMessages]))
 		{
-			float xValue = static_cast<float>(mouseDeltaX) * MOUSE_SPEED_CORRECTION * multiplier;
-			if (noButtonPressed)
-			{
-				_camera.yaw(xValue);
-			}
-			else
-			{
-				// if both buttons are pressed: do tilt
-				if (leftButtonPressed && rightButtonPressed)
-				{
-					_camera.roll(-xValue);
-				}
-				else
-				{
-					// always left/right
-					_camera.moveRight(xValue);
-				}
-			}
-		}
-		short mouseWheelDelta = Input::getMouseWheelDelta();
-		if (abs(mouseWheelDelta) > 0)
-		{
-			MessageHandler::logDebug("Changing for with mouse delta: %d", mouseWheelDelta);
-			CameraManipulator::changeFoV(-(static_cast<float>(mouseWheelDelta) * Globals::instance().settings().fovChangeSpeed));
+			input.numberOfMessages++;
 		}
-		Input::resetMouseDeltas();
 	}
 
 
-	bool System::handleKeyboardCameraMovement(float multiplier)
+	bool System::checkIfGameHasFocus()
 	{
-		if (!Globals::instance().keyboardMouseControlCamera())
-		{
-			return false;
-		}
-		bool altPressed = Utils::altPressed();
-		bool applyHammerPrevention = false;
-		if (Input::isActionActivated(ActionType::ResetTilt, true))
-		{
-			_camera.setRoll(0.0f);
-		}
-		if (Input::isActionActivated(ActionType::MoveForward, true))
-		{
-			_camera.moveForward(multiplier);
-		}
-		if (Input::isActionActivated(ActionType::MoveBackward, true))
-		{
-			_camera.moveForward(-multiplier);
-		}
-		if (Input::isActionActivated(ActionType::MoveRight, true))
-		{
-			_camera.moveRight(multiplier);
-		}
-		if (Input::isActionActivated(ActionType::MoveLeft, true))
-		{
-			_camera.moveRight(-multiplier);
-		}
-		if (Input::isActionActivated(ActionType::MoveUp, true))
-		{
-			_camera.moveUp(multiplier);
-		}
-		if (Input::isActionActivated(ActionType::MoveDown, true))
-		{
-			_camera.moveUp(-multiplier);
-		}
-		if (Input::isActionActivated(ActionType::RotateDown, true))
-		{
-			_camera.pitch(-multiplier);
-		}
-		if (Input::isActionActivated(ActionType::RotateUp, true))
-		{
-			_camera.pitch(multiplier);
-		}
-		if (Input::isActionActivated(ActionType::RotateRight, true))
-		{
-			_camera.yaw(multiplier);
-		}
-		if (Input::isActionActivated(ActionType::RotateLeft, true))
-		{
-			_camera.yaw(-multiplier);
-		}
-		if (Input::isActionActivated(ActionType::TiltLeft, true))
-		{
-			if (altPressed)
-			{
-				_camera.setRoll(_camera.getRoll() + (0.5 * DirectX::XM_PI));
-				applyHammerPrevention = true;
-			}
-			else
-			{
-				_camera.roll(multiplier);
-			}
-		}
-		if (Input::isActionActivated(ActionType::TiltRight, true))
-		{
-			if (altPressed)
-			{
-				_camera.setRoll(_camera.getRoll() - (0.5 * DirectX::XM_PI));
-				applyHammerPrevention = true;
-			}
-			else
-			{
-				_camera.roll(-multiplier);
-			}
-		}
-		return applyHammerPrevention;
+		HWND currentForegroundWindow = GetForegroundWindow();
+		return (currentForegroundWindow == Globals::instance().mainWindowHandle());
 	}
 
 
@@ -430,77 +176,34 @@ namespace IGCS
 		GameSpecific::InterceptorHelper::initializeAOBBlocks(_hostImageAddress, _hostImageSize, _aobBlocks);
 		GameSpecific::InterceptorHelper::setCameraStructInterceptorHook(_aobBlocks);
 		waitForCameraStructAddresses();		// blocks till camera is found.
+		if (!Globals::instance().systemActive())
+		{
+			// stopped while waiting, so there's no camera to set things up for.
+			return;
+		}
 		GameSpecific::InterceptorHelper::setPostCameraStructHooks(_aobBlocks);
 
 		// camera struct found, init our own camera object now and hook into game code which uses camera.
-		_cameraStructFound = true;
-		_camera.setPitch(INITIAL_PITCH_RADIANS);
-		_camera.setRoll(INITIAL_ROLL_RADIANS);
-		_camera.setYaw(INITIAL_YAW_RADIANS);
-
-		CameraManipulator::applySettingsToGameState();
+		_cameraController.onCameraStructFound();
 	}
 
 
-	// Waits for the interceptor to pick up the camera struct address. Should only return if address is found 
+	// Waits for the interceptor to pick up the camera struct address. Should only return if address is found or the system was stopped.
 	void System::waitForCameraStructAddresses()
 	{
 		MessageHandler::logLine("Waiting for camera struct interception...");
 		while(!GameSpecific::CameraManipulator::isCameraFound())
 		{
-			handleUserInput();
+			if (!Globals::instance().systemActive())
+			{
+				return;
+			}
+			TickInput input = {};
+			captureTickInput(FrameTime(), input);
+			_cameraController.handleUserInput(input);
 			Sleep(100);
 		}
 		MessageHandler::addNotification("Camera found.");
 		GameSpecific::CameraManipulator::displayCameraStructAddress();
 	}
-		
-
-	void System::toggleCameraMovementLockState(bool newValue)
-	{
-		if (_cameraMovementLocked == newValue)
-		{
-			// already in this state. Ignore
-			return;
-		}
-		_cameraMovementLocked = newValue;
-		MessageHandler::addNotification(_cameraMovementLocked ? "Camera movement is locked" : "Camera movement is unlocked");
-	}
-	
-
-	void System::toggleInputBlockState(bool newValue)
-	{
-		if (Globals::instance().inputBlocked() == newValue)
-		{
-			// already in this state. Ignore
-			return;
-		}
-		Globals::instance().inputBlocked(newValue);
-		MessageHandler::addNotification(newValue ? "Input to game blocked" : "Input to game enabled");
-	}
-
-	void System::toggleHud()
-	{
-		bool hudVisible = Globals::instance().toggleHudVisible();
-		CameraManipulator::toggleHud(hudVisible);
-		MessageHandler::addNotification(hudVisible ? "HUD visible" : "HUD hidden");
-	}
-
-
-	void System::displayCameraState()
-	{
-		MessageHandler::addNotification(g_cameraEnabled ? "Camera enabled" : "Camera disabled");
-	}
-	
-
-	void System::toggleGamePause(bool displayNotification)
-	{
-		bool gameIsPaused = CameraManipulator::gameIsPaused();
-		CameraManipulator::setTimeStopValue(!gameIsPaused);
-		if (displayNotification)
-		{
-			// gameIsPaused is the state before we toggled it, so we have to display the reverse text!
-			MessageHandler::addNotification(gameIsPaused ? "Game unpaused" : "Game paused");
-		}
-	}
 }
@@ -27,11 +27,14 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "stdafx.h"
-#include "Camera.h"
+#include "CameraController.h"
+#include "SessionRecorder.h"
+#include "TickInput.h"
 #include "InputHooker.h"
 #include "Gamepad.h"
 #include <map>
 #include "AOBBlock.h"
+#include "FrameClock.h"
 
 namespace IGCS
 {
@@ -41,34 +44,24 @@ namespace IGCS
 		System();
 		~System();
 		void start(LPBYTE hostBaseAddress, DWORD hostImageSize);
+		bool shutdown();
 
 	private:
 		void mainLoop();
 		void initialize();
-		void updateFrame();
+		void updateFrame(const FrameTime& frameTime);
+		void captureTickInput(const FrameTime& frameTime, TickInput& input);
 		bool checkIfGameHasFocus();
-		void onCameraDisabled();
-		void onCameraEnabled();
-		void handleUserInput();
-		void displayCameraState();
-		void toggleCameraMovementLockState(bool newValue);
-		bool handleKeyboardCameraMovement(float multiplier);
-		void handleMouseCameraMovement(float multiplier);
-		void handleGamePadMovement(float multiplierBase);
 		void waitForCameraStructAddresses();
-		void toggleInputBlockState(bool newValue);
-		void toggleHud();
-		void toggleGamePause(bool displayNotification = true);
 
-		Camera _camera;
+		CameraController _cameraController;
+		SessionRecorder _sessionRecorder;
+		SteadyTimeSource _timeSource;
+		FrameClock _frameClock;
 		LPBYTE _hostImageAddress;
 		DWORD _hostImageSize;
-		bool _cameraMovementLocked = false;
-		bool _cameraStructFound = false;
 		map<string, AOBBlock*> _aobBlocks;
-		bool _applyHammerPrevention = false;	// set to true by a keyboard action and which triggers a sleep before keyboard handling is performed.
 		std::filesystem::path _hostExePath;
 		std::filesystem::path _hostExeFilename;
 	};
 }
-
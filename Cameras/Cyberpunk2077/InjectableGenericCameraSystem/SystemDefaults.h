@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2017, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+
+// The defaults and message types without dependencies on Windows, so the platform independent sources can use them. The defaults which
+// use Windows or XInput values are in Defaults.h.
+namespace IGCS
+{
+	// System defaults
+	#define CAMERA_TICK_RATE						125.0f	// camera updates per second
+	#define CAMERA_FIXED_STEP_RATE					0.0f	// simulation steps per second. 0 simulates the elapsed time in one step per update, otherwise fixed steps are interpolated
+	#define REFERENCE_TICK_SECONDS					0.008f	// the movement and rotation speeds are tuned for an update every 8ms
+	#define MAX_TICK_DELTA_SECONDS					0.1f	// longer stalls are simulated as this much time
+	#define POSE_APPLY_TIMEOUT_MS					100		// if the game hasn't picked up a published camera pose for this long, the pose is written directly
+	#define ACTION_REPEAT_DELAY_MS					300		// time a key has to be held down before its action repeats, for actions which repeat
+	#define ACTION_REPEAT_RATE						10.0f	// repeats per second after the repeat delay
+	#define SHUTDOWN_GRACE_PERIOD_MS				250		// time given to game threads to leave our code after the hooks are removed
+	#define HOOK_WRITE_MAX_ATTEMPTS					50		// times the game's threads are suspended to patch code none of them is halfway through
+	#define HOOK_WRITE_RETRY_DELAY_MS				1		// time the game's threads get to leave the code to patch before the next attempt
+	#define IGCS_SCAN_CACHE_FILE_EXTENSION			".scancache"	// the scan result cache is stored next to the dll with this extension
+	#define SESSION_RECORDING_ENABLED				false	// if true, the input and the camera poses of every tick are recorded, so a session can be replayed
+	#define SESSION_RECORDING_FILENAME				L"IgcsSession.rec"	// in the folder of the game's exe
+	#define SESSION_RECORDING_SIZE_MB				16		// the oldest ticks are dropped once the recording is this large
+	#define SESSION_KEYFRAME_INTERVAL_TICKS			250		// ticks between the keyframes a replay can start from
+	#define IGCS_SUPPORT_RAWKEYBOARDINPUT			true	// if set to false, raw keyboard input is ignored.
+	#define IGCS_MAX_MESSAGE_SIZE					4*1024	// in bytes
+	#define IGCS_MAX_QUEUED_MESSAGE_SIZE			16		// in bytes. Setting and key binding messages are a couple of bytes
+	#define PIPE_WRITE_QUEUE_SIZE					256		// messages waiting for the client, a power of 2. Messages are dropped once it's full
+	#define PIPE_MESSAGE_SLOT_SIZE					1024	// in bytes. Longer messages to the client are cut off
+	#define PIPE_WRITE_SHUTDOWN_TIMEOUT_MS			500		// time the messages still queued get to reach the client when the pipe is closed
+
+	#define DEVICE_ID_KEYBOARD_MOUSE			0
+	#define DEVICE_ID_GAMEPAD					1
+	#define DEVICE_ID_ALL						2
+
+	#define IGCS_PIPENAME_DLL_TO_CLIENT				"\\\\.\\pipe\\IgcsDllToClient"
+	#define IGCS_PIPENAME_CLIENT_TO_DLL				"\\\\.\\pipe\\IgcsClientToDll"
+
+
+	enum class SettingType : uint8_t
+	{
+		FastMovementMultiplier = 0,
+		SlowMovementMultiplier = 1,
+		UpMovementMultiplier = 2,
+		MovementSpeed = 3,
+		CameraControlDevice = 4,
+		RotationSpeed = 5,
+		InvertYLookDirection = 6,
+		FoVZoomSpeed = 7,
+		TimeOfDay = 8,
+		Wetness_OverrideParameters = 9,
+		Wetness_StreetWetnessFactor = 10,
+		Wetness_PuddleSize = 11,
+		
+		// add more here
+	};
+
+	
+	enum class MessageType : uint8_t
+	{
+		Setting = 1,
+		KeyBinding = 2,
+		Notification = 3,
+		NormalTextMessage = 4,
+		ErrorTextMessage = 5,
+		DebugTextMessage= 6,
+		Action = 7,
+	};
+
+	enum class ActionMessageType : uint8_t
+	{
+		RehookXInput = 1,
+		ResizeViewport = 2,
+		UnloadDll = 3,
+	};
+}
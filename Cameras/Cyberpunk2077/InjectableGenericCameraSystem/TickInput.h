@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "stdafx.h"
+#include "FrameClock.h"
+#include "ActionEvaluator.h"
+#include "MouseInputAccumulator.h"
+#include "GamepadState.h"
+#include "PipeMessageQueue.h"
+
+namespace IGCS
+{
+	#define TICK_INPUT_MAX_MESSAGES		8		// messages queued beyond this are taken by the next tick
+
+	// Everything a tick of the camera takes from outside the camera system: the time, the state of the input devices, the messages of the
+	// client and the camera struct as the game left it. A CameraController which is given the same TickInputs in the same state moves the
+	// camera the same way, which is what a recorded session relies on.
+	struct TickInput
+	{
+		int64_t nowInMicroseconds;
+		FrameTime frameTime;
+		bool gameHasFocus;
+		KeyboardSnapshot keyboard;
+		MouseInput mouse;
+		GamepadState gamepad;
+		bool gamepadConnected;
+		bool gameCameraFound;				// if false, the coords and fov below aren't set
+		int32_t gameCameraCoords[3];
+		float gameCameraFoV;
+		int numberOfMessages;
+		PipeMessage messages[TICK_INPUT_MAX_MESSAGES];
+	};
+}
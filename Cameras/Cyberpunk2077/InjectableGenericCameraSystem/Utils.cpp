@@ -28,8 +28,11 @@
 #include "stdafx.h"
 #include "Utils.h"
 #include "GameConstants.h"
+#ifdef _WIN32
 #include "AOBBlock.h"
+#include "AOBScanner.h"
 #include <comdef.h>
+#endif
 #include <codecvt>
 #include <filesystem>
 #include "MessageHandler.h"
@@ -55,6 +58,7 @@ namespace IGCS::Utils
 		"Num Lock", "Scroll Lock",
 	};
 
+#ifdef _WIN32
 	// Obtains the exe's filename + path and returns that as a path object.
 	std::filesystem::path obtainHostExeAndPath()
 	{
@@ -62,6 +66,17 @@ namespace IGCS::Utils
 		GetModuleFileNameA(NULL, lpBuffer, MAX_PATH);
 		return filesystem::path(lpBuffer);
 	}
+
+
+	// Obtains the filename + path of this dll and returns that as a path object.
+	std::filesystem::path obtainDllPath()
+	{
+		HMODULE dllModule = nullptr;
+		GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCSTR>(&obtainDllPath), &dllModule);
+		char lpBuffer[MAX_PATH];
+		GetModuleFileNameA(dllModule, lpBuffer, MAX_PATH);
+		return filesystem::path(lpBuffer);
+	}
 	
 
 	BOOL isMainWindow(HWND handle)
@@ -161,83 +176,10 @@ namespace IGCS::Utils
 	}
 
 
-	uint8_t CharToByte(char c)
-	{
-		uint8_t b;
-		sscanf_s(&c, "%hhx", &b);
-		return b;
-	}
-
-
-	bool DataCompare(LPBYTE image, LPBYTE bytePattern, char* patternMask)
+	// Scans the image for the pattern specified using the vectorized scanner. See AOBScanner for details.
+	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, ScanPattern& pattern)
 	{
-		for (; *patternMask; ++patternMask, ++image, ++bytePattern)
-		{
-			if (*patternMask == 'x' && *image != *bytePattern)
-			{
-				return false;
-			}
-		}
-		return (*patternMask) == 0;
-	}
-
-
-	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, AOBBlock* const toScanFor)
-	{
-		uint8_t firstByte = *(toScanFor->bytePattern());
-		__int64 length = (__int64)imageAddress + imageSize - toScanFor->patternSize();
-
-		LPBYTE toReturn = nullptr;
-		LPBYTE startOfScan = imageAddress;
-		for (int occurrence = 0; occurrence < toScanFor->occurrence(); occurrence++)
-		{
-			// reset the pointer found, as we're not interested in this occurrence, we need a following occurrence.
-			toReturn = nullptr;
-			for (__int64 i = (__int64)startOfScan; i < length; i += 4)
-			{
-				unsigned x = *(unsigned*)(i);
-
-				if ((x & 0xFF) == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<uint8_t*>(i), toScanFor->bytePattern(), toScanFor->patternMask()))
-					{
-						toReturn = reinterpret_cast<uint8_t*>(i);
-						break;
-					}
-				}
-				if ((x & 0xFF00) >> 8 == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<uint8_t*>(i + 1), toScanFor->bytePattern(), toScanFor->patternMask()))
-					{
-						toReturn = reinterpret_cast<uint8_t*>(i + 1);
-						break;
-					}
-				}
-				if ((x & 0xFF0000) >> 16 == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<uint8_t*>(i + 2), toScanFor->bytePattern(), toScanFor->patternMask()))
-					{
-						toReturn = reinterpret_cast<uint8_t*>(i + 2);
-						break;
-					}
-				}
-				if ((x & 0xFF000000) >> 24 == firstByte)
-				{
-					if (DataCompare(reinterpret_cast<uint8_t*>(i + 3), toScanFor->bytePattern(), toScanFor->patternMask()))
-					{
-						toReturn = reinterpret_cast<uint8_t*>(i + 3);
-						break;
-					}
-				}
-			}
-			if (nullptr == toReturn)
-			{
-				// not found, give up
-				return toReturn;
-			}
-			startOfScan = toReturn + 1;	// otherwise we'll match ourselves. 
-		}
-		return toReturn;
+		return const_cast<LPBYTE>(AOBScanner::findPattern(imageAddress, imageSize, pattern.view(), pattern.occurrence()));
 	}
 
 
@@ -253,6 +195,7 @@ namespace IGCS::Utils
 		LPBYTE ripRelativeValueAddress = locationData->locationInImage() + locationData->customOffset();
 		return  ripRelativeValueAddress + nextOpCodeOffset + *((__int32*)ripRelativeValueAddress);
 	}
+#endif
 
 	
 	string formatString(const char* fmt, ...)
@@ -283,7 +226,7 @@ namespace IGCS::Utils
 		return strncmp(a, b, strlen(b)) == 0 ? 1 : 0;
 	}
 
-	
+#ifdef _WIN32
 	bool keyDown(int virtualKeyCode)
 	{
 		return (GetKeyState(virtualKeyCode) & 0x8000);
@@ -306,6 +249,7 @@ namespace IGCS::Utils
 	{
 		return keyDown(VK_LSHIFT) || keyDown(VK_RSHIFT);
 	}
+#endif
 
 	
 	std::string vkCodeToString(int vkCode)
@@ -319,9 +263,9 @@ namespace IGCS::Utils
 	}
 
 	
-	float floatFromBytes(uint8_t byteArray[], DWORD arrayLength, int startIndex)
+	float floatFromBytes(uint8_t byteArray[], uint32_t arrayLength, int startIndex)
 	{
-		if(arrayLength<startIndex+4)
+		if(arrayLength<static_cast<uint32_t>(startIndex)+4)
 		{
 			return -1.0f;
 		}
@@ -330,9 +274,9 @@ namespace IGCS::Utils
 	}
 
 	
-	int intFromBytes(uint8_t byteArray[], DWORD arrayLength, int startIndex)
+	int intFromBytes(uint8_t byteArray[], uint32_t arrayLength, int startIndex)
 	{
-		if (arrayLength < startIndex + 4)
+		if (arrayLength < static_cast<uint32_t>(startIndex) + 4)
 		{
 			return -1;
 		}
@@ -341,9 +285,9 @@ namespace IGCS::Utils
 	}
 
 	
-	std::string stringFromBytes(uint8_t byteArray[], DWORD arrayLength, int startIndex)
+	std::string stringFromBytes(uint8_t byteArray[], uint32_t arrayLength, int startIndex)
 	{
-		if (arrayLength < startIndex + 4)
+		if (arrayLength < static_cast<uint32_t>(startIndex) + 4)
 		{
 			return nullptr;
 		}
@@ -27,20 +27,26 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "stdafx.h"
+#include <cstdarg>
 #include <filesystem>
 
 namespace IGCS
 {
 	// forward declaration to avoid cyclic dependency.
 	class AOBBlock;
+	class ScanPattern;
 }
 
+// The functions which need Windows are only declared when building the camera dll. The rest is declared on every platform, so the sources
+// which use them, like ActionData.cpp, also compile into the unit tests, which provide keyDown and the other key functions themselves.
 namespace IGCS::Utils
 {
+#ifdef _WIN32
 	struct handle_data {
 		unsigned long process_id;
 		HWND best_handle;
 	};
+#endif
 
 	template <typename T>
 	T clamp(T value, T min, T max, T defaultValue)
@@ -56,12 +62,15 @@ namespace IGCS::Utils
 	}
 
 
+#ifdef _WIN32
 	HWND findMainWindow(unsigned long process_id);
 	MODULEINFO getModuleInfoOfContainingProcess();
 	MODULEINFO getModuleInfoOfDll(LPCWSTR libraryName);
-	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, AOBBlock* const toScanFor);
-	uint8_t CharToByte(char c);
+	LPBYTE findAOBPattern(LPBYTE imageAddress, DWORD imageSize, ScanPattern& pattern);
 	LPBYTE calculateAbsoluteAddress(AOBBlock* locationData, int nextOpCodeOffset);
+	std::filesystem::path obtainHostExeAndPath();
+	std::filesystem::path obtainDllPath();
+#endif
 	std::string formatString(const char* fmt, ...);
 	std::string formatStringVa(const char* fmt, va_list args);
 	bool stringStartsWith(const char *a, const char *b);
@@ -70,8 +79,7 @@ namespace IGCS::Utils
 	bool ctrlPressed();
 	bool shiftPressed();
 	std::string vkCodeToString(int vkCode);
-	float floatFromBytes(uint8_t byteArray[], DWORD arrayLength, int startIndex);
-	int intFromBytes(uint8_t byteArray[], DWORD arrayLength, int startIndex);
-	std::string stringFromBytes(uint8_t byteArray[], DWORD arrayLength, int startIndex);
-	std::filesystem::path obtainHostExeAndPath();
+	float floatFromBytes(uint8_t byteArray[], uint32_t arrayLength, int startIndex);
+	int intFromBytes(uint8_t byteArray[], uint32_t arrayLength, int startIndex);
+	std::string stringFromBytes(uint8_t byteArray[], uint32_t arrayLength, int startIndex);
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AOBResolver: resolves the AOB blocks of a camera in a game executable or minidump, offline, and writes the offsets found. Used to check
+// whether a camera's patterns still match after a game update without having to run the game. See ReadMe.md.
+
+#include "stdafx.h"
+#include "BlockResolver.h"
+#include "CameraPatternSet.h"
+#include "InstructionDecoder.h"
+#include "MappedFile.h"
+#include "MinidumpReader.h"
+#include "OffsetsWriter.h"
+#include "PatternLiteral.h"
+#include "PEImage.h"
+#include "ScanResultCache.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace std;
+using namespace IGCS;
+using namespace IGCS::AOBResolver;
+
+// Exit codes, so batch runs can tell a broken camera from a broken run.
+static const int EXIT_ALL_CRITICAL_BLOCKS_FOUND = 0;
+static const int EXIT_CRITICAL_BLOCKS_MISSING = 1;
+static const int EXIT_ERROR = 2;
+
+struct Arguments
+{
+	string cameraFolder;
+	string imageFilename;
+	string moduleName;
+	string jsonFilename;
+	string cacheFilename;
+	int numberOfThreads = 0;
+};
+
+static void displayUsage()
+{
+	cerr << "Usage: AOBResolver <camera folder> <exe, dll or minidump> [options]" << endl;
+	cerr << "Options:" << endl;
+	cerr << "  --module <name>    module to resolve in a minidump. Default: the executable." << endl;
+	cerr << "  --json <file>      file to write the offsets to as JSON. Default: standard output." << endl;
+	cerr << "  --cache <file>     file to write the offsets to as a scan result cache for the camera dll, e.g. <camera dll name>.scancache." << endl;
+	cerr << "  --threads <n>      number of threads to scan with. Default: number of cores." << endl;
+	cerr << "Or: AOBResolver --make-pattern \"<bytes>\" [--wildcard-displacements]" << endl;
+	cerr << "  creates a pattern from a byte capture, e.g. \"F3 44 0F59 15 005F75F8\", with wildcards for rip relative offsets, rel32 jump" << endl;
+	cerr << "  targets and large immediates, and displays the continue offset of a hook at the first byte." << endl;
+}
+
+
+// Creates a pattern from the bytes captured with e.g. Cheat Engine. Spaces between the bytes are optional.
+static int makePattern(int argc, char* argv[])
+{
+	if (argc < 3 || argc > 4 || (argc == 4 && string(argv[3]) != "--wildcard-displacements"))
+	{
+		displayUsage();
+		return EXIT_ERROR;
+	}
+	string hexDigits;
+	for (const char* current = argv[2]; *current != '\0'; current++)
+	{
+		if (*current == ' ')
+		{
+			continue;
+		}
+		if (PatternParser::hexValue(*current) < 0)
+		{
+			cerr << "'" << argv[2] << "' isn't a list of hexadecimal bytes" << endl;
+			return EXIT_ERROR;
+		}
+		hexDigits += *current;
+	}
+	if (hexDigits.empty() || (hexDigits.size() % 2) != 0)
+	{
+		cerr << "'" << argv[2] << "' isn't a list of hexadecimal bytes" << endl;
+		return EXIT_ERROR;
+	}
+	vector<uint8_t> code;
+	for (size_t i = 0; i < hexDigits.size(); i += 2)
+	{
+		code.push_back(static_cast<uint8_t>((PatternParser::hexValue(hexDigits[i]) << 4) | PatternParser::hexValue(hexDigits[i + 1])));
+	}
+	uint32_t wildcardFlags = InstructionDecoder::WildcardDefault;
+	if (argc == 4)
+	{
+		wildcardFlags |= InstructionDecoder::WildcardMemoryDisplacements;
+	}
+	// the last instruction can be cut off in a capture, so create the pattern for the whole instructions only.
+	int length = 0;
+	DecodedInstruction instruction;
+	while (length < static_cast<int>(code.size()) && InstructionDecoder::decode(code.data() + length, code.size() - length, instruction))
+	{
+		length += instruction.length;
+	}
+	if (length == 0)
+	{
+		cerr << "The bytes don't start with a valid x64 instruction" << endl;
+		return EXIT_ERROR;
+	}
+	if (length < static_cast<int>(code.size()))
+	{
+		cerr << "Warning: the bytes after offset 0x" << hex << length << dec << " aren't a whole instruction and are ignored." << endl;
+	}
+	cout << "Pattern: " << InstructionDecoder::createPattern(code.data(), length, wildcardFlags) << endl;
+	// the camera dlls overwrite the start of a hook with a 14 byte jmp qword ptr [0000] <address>.
+	const int continueOffset = InstructionDecoder::coveringLength(code.data(), length, 14);
+	if (continueOffset < 0)
+	{
+		cout << "Continue offset: more bytes needed" << endl;
+	}
+	else
+	{
+		cout << "Continue offset: 0x" << hex << uppercase << continueOffset << nouppercase << dec << endl;
+	}
+	return 0;
+}
+
+
+static bool parseArguments(int argc, char* argv[], Arguments& arguments)
+{
+	vector<string> positionalArguments;
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		if (argument.rfind("--", 0) != 0)
+		{
+			positionalArguments.push_back(argument);
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			return false;
+		}
+		string value = argv[++i];
+		if (argument == "--module")
+		{
+			arguments.moduleName = value;
+		}
+		else if (argument == "--json")
+		{
+			arguments.jsonFilename = value;
+		}
+		else if (argument == "--cache")
+		{
+			arguments.cacheFilename = value;
+		}
+		else if (argument == "--threads")
+		{
+			arguments.numberOfThreads = atoi(value.c_str());
+		}
+		else
+		{
+			return false;
+		}
+	}
+	if (positionalArguments.size() != 2)
+	{
+		return false;
+	}
+	arguments.cameraFolder = positionalArguments[0];
+	arguments.imageFilename = positionalArguments[1];
+	return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 2 && string(argv[1]) == "--make-pattern")
+	{
+		return makePattern(argc, argv);
+	}
+	Arguments arguments;
+	if (!parseArguments(argc, argv, arguments))
+	{
+		displayUsage();
+		return EXIT_ERROR;
+	}
+
+	CameraPatternSet patternSet;
+	string errorMessage;
+	if (!patternSet.load(arguments.cameraFolder, errorMessage))
+	{
+		cerr << errorMessage << endl;
+		return EXIT_ERROR;
+	}
+
+	MappedFile imageFile;
+	if (!imageFile.open(arguments.imageFilename))
+	{
+		cerr << "Can't open '" << arguments.imageFilename << "'" << endl;
+		return EXIT_ERROR;
+	}
+	ImageInfo imageInfo{ patternSet.cameraName(), filesystem::path(arguments.imageFilename).filename().string(), "", 0, 0, 0 };
+	// a minidump contains the modules as loaded, so their image is rebuilt in mapped layout. A file on disk is used as is.
+	vector<uint8_t> moduleImage;
+	const uint8_t* imageStart = imageFile.data();
+	size_t imageSize = imageFile.size();
+	bool mappedLayout = false;
+	if (MinidumpReader::isMinidump(imageFile.data(), imageFile.size()))
+	{
+		MinidumpReader reader(imageFile.data(), imageFile.size());
+		MinidumpModule module;
+		size_t numberOfBytesFound = 0;
+		if (!reader.readModules() || !reader.extractModuleImage(arguments.moduleName, moduleImage, module, numberOfBytesFound))
+		{
+			cerr << "Can't find module '" << (arguments.moduleName.empty() ? "<executable>" : arguments.moduleName) << "' in minidump '" << arguments.imageFilename << "'" << endl;
+			return EXIT_ERROR;
+		}
+		if (numberOfBytesFound < module.sizeOfImage)
+		{
+			cerr << "Warning: only " << numberOfBytesFound << " of " << module.sizeOfImage << " bytes of module '" << module.name << "' are in the minidump." << endl;
+		}
+		imageInfo.moduleName = module.name;
+		imageStart = moduleImage.data();
+		imageSize = moduleImage.size();
+		mappedLayout = true;
+	}
+	PEImage image(imageStart, imageSize, mappedLayout);
+	if (!image.isValid())
+	{
+		cerr << "'" << arguments.imageFilename << "' doesn't contain a valid PE image" << endl;
+		return EXIT_ERROR;
+	}
+	imageInfo.fingerprint = calculateExecutableFingerprint(image);
+	imageInfo.sizeOfImage = image.sizeOfImage();
+	imageInfo.imageBase = image.imageBase();
+
+	int numberOfThreads = arguments.numberOfThreads > 0 ? arguments.numberOfThreads : (std::max)(1, static_cast<int>(thread::hardware_concurrency()));
+	vector<BlockResult> results = BlockResolver::resolveBlocks(image, patternSet.blocks(), numberOfThreads);
+
+	if (arguments.jsonFilename.empty())
+	{
+		OffsetsWriter::writeJson(cout, imageInfo, results);
+	}
+	else
+	{
+		ofstream jsonFile(arguments.jsonFilename);
+		OffsetsWriter::writeJson(jsonFile, imageInfo, results);
+		if (!jsonFile)
+		{
+			cerr << "Can't write '" << arguments.jsonFilename << "'" << endl;
+			return EXIT_ERROR;
+		}
+	}
+	if (!arguments.cacheFilename.empty() && !OffsetsWriter::writeScanCache(arguments.cacheFilename, imageInfo, results))
+	{
+		cerr << "Can't write '" << arguments.cacheFilename << "'" << endl;
+		return EXIT_ERROR;
+	}
+
+	int toReturn = EXIT_ALL_CRITICAL_BLOCKS_FOUND;
+	for (auto& result : results)
+	{
+		if (!result.found && !result.definition->isNonCritical)
+		{
+			cerr << patternSet.cameraName() << ": can't find pattern for block '" << result.definition->name << "'" << endl;
+			toReturn = EXIT_CRITICAL_BLOCKS_MISSING;
+		}
+		else if (result.isApproximate)
+		{
+			cerr << patternSet.cameraName() << ": pattern for block '" << result.definition->name << "' only matches approximately (mismatches: " << result.numberOfMismatches 
+				 << "), updated pattern: " << result.updatedPattern << endl;
+		}
+		else if (result.isAmbiguous)
+		{
+			cerr << patternSet.cameraName() << ": pattern for block '" << result.definition->name << "' is ambiguous (" << result.numberOfMatches 
+				 << (result.numberOfMatchesIsComplete ? "" : "+") << " matches)" << endl;
+		}
+	}
+	return toReturn;
+}
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "BlockResolver.h"
+#include "ApproximateScanner.h"
+#include "MultiPatternScanner.h"
+#include "ScanPattern.h"
+
+using namespace std;
+
+namespace IGCS::AOBResolver::BlockResolver
+{
+	using namespace PEReader;
+
+	// Resolves the RIP relative value at the block's address like Utils::calculateAbsoluteAddress does, but in RVAs.
+	static RipRelativeTarget resolveRipRelativeTarget(const PEImage& image, const uint8_t* location, const BlockResult& result, int nextOpCodeOffset)
+	{
+		RipRelativeTarget toReturn{ nextOpCodeOffset, false, 0 };
+		const uint8_t* valueLocation = location + result.customOffset;
+		if (valueLocation < image.imageStart() || valueLocation + 4 > image.imageStart() + image.imageSize())
+		{
+			return toReturn;
+		}
+		int32_t ripRelativeValue = static_cast<int32_t>(readUInt32(valueLocation));
+		int64_t target = static_cast<int64_t>(result.rva) + result.customOffset + nextOpCodeOffset + ripRelativeValue;
+		if (target < 0 || target > static_cast<int64_t>(UINT32_MAX))
+		{
+			return toReturn;
+		}
+		toReturn.isResolved = true;
+		toReturn.rva = static_cast<uint32_t>(target);
+		return toReturn;
+	}
+
+
+	// Same as AOBBlock::scanApproximately: the pattern with the best unique approximate match wins.
+	static void resolveApproximately(const PEImage& image, const vector<ScanRange>& ranges, vector<ScanPattern>& patterns, BlockResult& result, int numberOfThreads)
+	{
+		for (size_t patternIndex = 0; patternIndex < patterns.size(); patternIndex++)
+		{
+			ScanPattern& pattern = patterns[patternIndex];
+			if (pattern.occurrence() != 1)
+			{
+				continue;
+			}
+			ApproximateMatch match = ApproximateScanner::findBestMatch(ranges, pattern.view(), result.definition->maxNumberOfMismatches, numberOfThreads);
+			uint32_t rva = 0;
+			if (!match.isUsable(ApproximateScanner::MINIMUM_CONFIDENCE) || (result.found && match.confidence() <= result.confidence) ||
+				!image.offsetToRva(static_cast<size_t>(match.location - image.imageStart()), rva))
+			{
+				continue;
+			}
+			result.found = true;
+			result.isApproximate = true;
+			result.patternIndex = static_cast<int>(patternIndex);
+			result.rva = rva;
+			result.customOffset = pattern.customOffset();
+			result.numberOfMatches = match.numberOfCandidates;
+			result.numberOfMatchesIsComplete = true;
+			result.isAmbiguous = false;
+			result.numberOfMismatches = match.numberOfMismatches;
+			result.confidence = match.confidence();
+			result.mismatchIndices = match.mismatchIndices;
+			result.updatedPattern = ApproximateScanner::createPatternText(match.location, pattern.view(), pattern.customOffset());
+			result.ripRelativeTargets.clear();
+			for (int nextOpCodeOffset : result.definition->ripRelativeNextOpCodeOffsets)
+			{
+				result.ripRelativeTargets.push_back(resolveRipRelativeTarget(image, match.location, result, nextOpCodeOffset));
+			}
+		}
+	}
+
+
+	vector<BlockResult> resolveBlocks(const PEImage& image, const vector<BlockDefinition>& blocks, int numberOfThreads)
+	{
+		// patterns are parsed at runtime here, so their data lives in the pattern arena; the scanner only keeps views on them.
+		vector<vector<ScanPattern>> patternsPerBlock;
+		vector<vector<int>> patternIdsPerBlock;
+		vector<BlockResult> toReturn;
+		MultiPatternScanner scanner;
+		for (auto& block : blocks)
+		{
+			BlockResult result{ &block, false, -1, 0, 0, 0, true, false, {}, {}, false, 0, 0.0, {}, "" };
+			vector<ScanPattern> patterns;
+			vector<int> patternIds;
+			for (auto& patternDefinition : block.patterns)
+			{
+				patterns.emplace_back(patternDefinition.patternText, patternDefinition.occurrence);
+				if (patterns.back().patternSize() <= 0)
+				{
+					result.invalidPatternIndices.push_back(static_cast<int>(patterns.size()) - 1);
+				}
+				patternIds.push_back(scanner.addPattern(patterns.back().view(), patternDefinition.occurrence));
+			}
+			patternsPerBlock.push_back(patterns);
+			patternIdsPerBlock.push_back(patternIds);
+			toReturn.push_back(result);
+		}
+		const vector<ScanRange> ranges = image.rangesOfClass(SectionClass::Code);
+		scanner.scanParallel(ranges, numberOfThreads);
+
+		for (size_t blockIndex = 0; blockIndex < blocks.size(); blockIndex++)
+		{
+			BlockResult& result = toReturn[blockIndex];
+			for (size_t patternIndex = 0; patternIndex < patternIdsPerBlock[blockIndex].size(); patternIndex++)
+			{
+				int patternId = patternIdsPerBlock[blockIndex][patternIndex];
+				const uint8_t* location = scanner.location(patternId);
+				uint32_t rva = 0;
+				if (nullptr == location || !image.offsetToRva(static_cast<size_t>(location - image.imageStart()), rva))
+				{
+					continue;
+				}
+				result.found = true;
+				result.patternIndex = static_cast<int>(patternIndex);
+				result.rva = rva;
+				result.customOffset = patternsPerBlock[blockIndex][patternIndex].customOffset();
+				result.numberOfMatches = static_cast<int>(scanner.occurrences(patternId).size());
+				result.numberOfMatchesIsComplete = scanner.isIndexComplete(patternId);
+				result.isAmbiguous = scanner.isAmbiguous(patternId);
+				for (int nextOpCodeOffset : blocks[blockIndex].ripRelativeNextOpCodeOffsets)
+				{
+					result.ripRelativeTargets.push_back(resolveRipRelativeTarget(image, location, result, nextOpCodeOffset));
+				}
+				break;
+			}
+			if (!result.found && blocks[blockIndex].maxNumberOfMismatches > 0)
+			{
+				resolveApproximately(image, ranges, patternsPerBlock[blockIndex], result, numberOfThreads);
+			}
+		}
+		return toReturn;
+	}
+}
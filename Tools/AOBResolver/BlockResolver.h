@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "CameraPatternSet.h"
+#include "PEImage.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IGCS::AOBResolver
+{
+	// The target of a Utils::calculateAbsoluteAddress call on a block, as an RVA.
+	struct RipRelativeTarget
+	{
+		int nextOpCodeOffset;
+		bool isResolved;
+		uint32_t rva;
+	};
+
+
+	// The result of resolving a block in an image. rva is the RVA of the match (the value the camera dll caches), the address the camera
+	// uses is rva + customOffset.
+	struct BlockResult
+	{
+		const BlockDefinition* definition;
+		bool found;
+		int patternIndex;
+		uint32_t rva;
+		int customOffset;
+		int numberOfMatches;				// of the pattern that matched, as far as indexed.
+		bool numberOfMatchesIsComplete;		// false if the pattern matches more often than the scanner's match index limit.
+		bool isAmbiguous;
+		std::vector<int> invalidPatternIndices;
+		std::vector<RipRelativeTarget> ripRelativeTargets;
+		// set if no pattern matched exactly and the block allows fuzzy matching: the pattern with patternIndex matched at rva with the
+		// bytes at mismatchIndices being different. updatedPattern is the pattern text which matches at rva exactly.
+		bool isApproximate;
+		int numberOfMismatches;
+		double confidence;
+		std::vector<int> mismatchIndices;
+		std::string updatedPattern;
+	};
+
+
+	namespace BlockResolver
+	{
+		// Scans the code sections of the image for all patterns of all blocks in one pass, the same way the camera dll does, and resolves
+		// each block: the first pattern of a block which is found wins. Blocks which allow fuzzy matching and aren't found are scanned for
+		// approximately, like the camera dll does.
+		std::vector<BlockResult> resolveBlocks(const PEImage& image, const std::vector<BlockDefinition>& blocks, int numberOfThreads);
+	}
+}
@@ -0,0 +1,315 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "CameraPatternSet.h"
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace IGCS::AOBResolver
+{
+	// A pattern argument is either a plain string or a pattern literal wrapped in a ScanPattern.
+	static const string PATTERN_ARGUMENT = R"expr((?:ScanPattern\s*\(\s*IGCS_AOB_PATTERN\s*\(\s*"([^"]*)"\s*\)|"([^"]*)")\s*,\s*(\d+))expr";
+	// A block is referred to by indexing the block map with its key constant or through a local variable.
+	static const string BLOCK_REFERENCE = R"expr((?:\[\s*(\w+)\s*\]|(\w+)))expr";
+
+	static bool readFile(const fs::path& filename, string& contents)
+	{
+		ifstream file(filename, ios::binary);
+		if (!file)
+		{
+			return false;
+		}
+		stringstream buffer;
+		buffer << file.rdbuf();
+		contents = buffer.str();
+		return true;
+	}
+
+
+	// Removes comments from the source text specified, so commented out blocks aren't picked up. String literals are left alone.
+	static string stripComments(const string& sourceText)
+	{
+		string toReturn;
+		toReturn.reserve(sourceText.size());
+		size_t index = 0;
+		while (index < sourceText.size())
+		{
+			const char current = sourceText[index];
+			const char next = index + 1 < sourceText.size() ? sourceText[index + 1] : '\0';
+			if (current == '"')
+			{
+				size_t end = index + 1;
+				while (end < sourceText.size() && sourceText[end] != '"' && sourceText[end] != '\n')
+				{
+					end += sourceText[end] == '\\' ? 2 : 1;
+				}
+				end = (std::min)(end + 1, sourceText.size());
+				toReturn.append(sourceText, index, end - index);
+				index = end;
+				continue;
+			}
+			if (current == '/' && next == '/')
+			{
+				size_t end = sourceText.find('\n', index);
+				index = end == string::npos ? sourceText.size() : end;
+				continue;
+			}
+			if (current == '/' && next == '*')
+			{
+				size_t end = sourceText.find("*/", index + 2);
+				index = end == string::npos ? sourceText.size() : end + 2;
+				toReturn += ' ';
+				continue;
+			}
+			toReturn += current;
+			index++;
+		}
+		return toReturn;
+	}
+
+
+	// Evaluates expressions like "4" and "4+1" as used for the next opcode offset.
+	static int evaluateSum(const string& expression)
+	{
+		int toReturn = 0;
+		stringstream terms(expression);
+		string term;
+		while (getline(terms, term, '+'))
+		{
+			toReturn += atoi(term.c_str());
+		}
+		return toReturn;
+	}
+
+
+	static string patternTextFromMatch(const smatch& match, int literalGroup)
+	{
+		return match[literalGroup].matched ? match[literalGroup].str() : match[literalGroup + 1].str();
+	}
+
+
+	CameraPatternSet::CameraPatternSet()
+	{
+	}
+
+
+	CameraPatternSet::~CameraPatternSet()
+	{
+	}
+
+
+	bool CameraPatternSet::load(const string& cameraFolder, string& errorMessage)
+	{
+		fs::path sourceFolder(cameraFolder);
+		if (!fs::exists(sourceFolder / "InterceptorHelper.cpp") && fs::exists(sourceFolder / "InjectableGenericCameraSystem" / "InterceptorHelper.cpp"))
+		{
+			sourceFolder /= "InjectableGenericCameraSystem";
+		}
+		if (!fs::exists(sourceFolder / "InterceptorHelper.cpp"))
+		{
+			errorMessage = "No InterceptorHelper.cpp found in '" + cameraFolder + "'";
+			return false;
+		}
+		fs::path cameraRoot = sourceFolder.filename() == "InjectableGenericCameraSystem" ? sourceFolder.parent_path() : sourceFolder;
+		_cameraName = cameraRoot.filename().string();
+		if (_cameraName.empty())
+		{
+			_cameraName = fs::absolute(cameraRoot).parent_path().filename().string();
+		}
+
+		vector<fs::path> headerFiles;
+		vector<fs::path> sourceFiles;
+		for (auto& entry : fs::directory_iterator(sourceFolder))
+		{
+			string extension = entry.path().extension().string();
+			if (extension == ".h")
+			{
+				headerFiles.push_back(entry.path());
+			}
+			else if (extension == ".cpp")
+			{
+				sourceFiles.push_back(entry.path());
+			}
+		}
+		sort(headerFiles.begin(), headerFiles.end());
+		sort(sourceFiles.begin(), sourceFiles.end());
+		for (auto& headerFile : headerFiles)
+		{
+			string sourceText;
+			if (readFile(headerFile, sourceText))
+			{
+				readKeyConstants(stripComments(sourceText));
+			}
+		}
+		vector<string> sourceTexts;
+		for (auto& sourceFile : sourceFiles)
+		{
+			string sourceText;
+			if (!readFile(sourceFile, sourceText))
+			{
+				errorMessage = "Can't read '" + sourceFile.string() + "'";
+				return false;
+			}
+			sourceTexts.push_back(stripComments(sourceText));
+			readKeyConstants(sourceTexts.back());
+		}
+		for (auto& sourceText : sourceTexts)
+		{
+			readBlocks(sourceText);
+		}
+		for (auto& sourceText : sourceTexts)
+		{
+			readRipRelativeUsages(sourceText);
+		}
+		if (_blocks.empty())
+		{
+			errorMessage = "No AOB blocks found in the sources in '" + sourceFolder.string() + "'";
+			return false;
+		}
+		return true;
+	}
+
+
+	void CameraPatternSet::readKeyConstants(const string& sourceText)
+	{
+		static const regex defineExpression(R"expr(#define\s+(\w+)\s+"([^"]*)")expr");
+		for (sregex_iterator it(sourceText.begin(), sourceText.end(), defineExpression), end; it != end; ++it)
+		{
+			_keyConstants[(*it)[1].str()] = (*it)[2].str();
+		}
+	}
+
+
+	// Reads the blocks created in the source text specified, then the alternatives, non-critical markers and fuzzy matching markers of the
+	// blocks, which can refer to a block through its key constant or the local variable the block was assigned to. A block is named after
+	// the map key it's assigned to, or the key passed to its constructor if it's assigned to a local variable. A block created again for
+	// the same key, e.g. in different branches for different game versions, gets the pattern added as an alternative.
+	void CameraPatternSet::readBlocks(const string& sourceText)
+	{
+		static const regex creationExpression(R"expr((?:)expr" + BLOCK_REFERENCE + R"expr(\s*=\s*)?new\s+AOBBlock\s*\(\s*(\w+)\s*,\s*)expr" + PATTERN_ARGUMENT);
+		static const regex alternativeExpression(BLOCK_REFERENCE + R"expr(\s*->\s*addAlternative\s*\(\s*)expr" + PATTERN_ARGUMENT);
+		static const regex nonCriticalExpression(BLOCK_REFERENCE + R"expr(\s*->\s*markAsNonCritical\s*\()expr");
+		static const regex fuzzyMatchingExpression(BLOCK_REFERENCE + R"expr(\s*->\s*allowFuzzyMatching\s*\(\s*(\d+)\s*\))expr");
+
+		map<string, string> keyConstantPerVariable;
+		for (sregex_iterator it(sourceText.begin(), sourceText.end(), creationExpression), end; it != end; ++it)
+		{
+			// the block is stored in the map under the key it's assigned to, which is the name used by the scan result cache as well.
+			const smatch& match = *it;
+			string keyConstant = match[1].matched ? match[1].str() : match[3].str();
+			PatternDefinition pattern{ patternTextFromMatch(match, 4), stoi(match[6].str()) };
+			if (match[2].matched)
+			{
+				keyConstantPerVariable[match[2].str()] = keyConstant;
+			}
+			BlockDefinition* existingBlock = findBlockByKeyConstant(keyConstant);
+			if (nullptr != existingBlock)
+			{
+				existingBlock->patterns.push_back(pattern);
+				continue;
+			}
+			BlockDefinition toAdd;
+			auto keyValue = _keyConstants.find(keyConstant);
+			toAdd.name = keyValue == _keyConstants.end() ? keyConstant : keyValue->second;
+			toAdd.keyConstant = keyConstant;
+			toAdd.patterns.push_back(pattern);
+			_blocks.push_back(toAdd);
+		}
+
+		auto resolveBlock = [&](const smatch& match) -> BlockDefinition*
+		{
+			if (match[1].matched)
+			{
+				return findBlockByKeyConstant(match[1].str());
+			}
+			auto variable = keyConstantPerVariable.find(match[2].str());
+			return variable == keyConstantPerVariable.end() ? nullptr : findBlockByKeyConstant(variable->second);
+		};
+		for (sregex_iterator it(sourceText.begin(), sourceText.end(), alternativeExpression), end; it != end; ++it)
+		{
+			BlockDefinition* block = resolveBlock(*it);
+			if (nullptr != block)
+			{
+				block->patterns.push_back(PatternDefinition{ patternTextFromMatch(*it, 3), stoi((*it)[5].str()) });
+			}
+		}
+		for (sregex_iterator it(sourceText.begin(), sourceText.end(), nonCriticalExpression), end; it != end; ++it)
+		{
+			BlockDefinition* block = resolveBlock(*it);
+			if (nullptr != block)
+			{
+				block->isNonCritical = true;
+			}
+		}
+		for (sregex_iterator it(sourceText.begin(), sourceText.end(), fuzzyMatchingExpression), end; it != end; ++it)
+		{
+			BlockDefinition* block = resolveBlock(*it);
+			if (nullptr != block)
+			{
+				block->maxNumberOfMismatches = stoi((*it)[3].str());
+			}
+		}
+	}
+
+
+	void CameraPatternSet::readRipRelativeUsages(const string& sourceText)
+	{
+		static const regex calculateAbsoluteAddressExpression(R"expr(calculateAbsoluteAddress\s*\(\s*\w+\s*\[\s*(\w+)\s*\]\s*,\s*([0-9+\s]+)\))expr");
+		for (sregex_iterator it(sourceText.begin(), sourceText.end(), calculateAbsoluteAddressExpression), end; it != end; ++it)
+		{
+			BlockDefinition* block = findBlockByKeyConstant((*it)[1].str());
+			if (nullptr == block)
+			{
+				continue;
+			}
+			int nextOpCodeOffset = evaluateSum((*it)[2].str());
+			if (find(block->ripRelativeNextOpCodeOffsets.begin(), block->ripRelativeNextOpCodeOffsets.end(), nextOpCodeOffset) == block->ripRelativeNextOpCodeOffsets.end())
+			{
+				block->ripRelativeNextOpCodeOffsets.push_back(nextOpCodeOffset);
+			}
+		}
+	}
+
+
+	BlockDefinition* CameraPatternSet::findBlockByKeyConstant(const string& keyConstant)
+	{
+		for (auto& block : _blocks)
+		{
+			if (block.keyConstant == keyConstant)
+			{
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+}
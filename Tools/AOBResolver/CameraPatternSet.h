@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+namespace IGCS::AOBResolver
+{
+	// A pattern of a block as written in the camera's sources.
+	struct PatternDefinition
+	{
+		std::string patternText;
+		int occurrence;
+	};
+
+
+	// An AOB block as created by a camera's InterceptorHelper: its name (the value of the key constant), its patterns in the order they're
+	// tried and the next opcode offsets of the Utils::calculateAbsoluteAddress calls done on it, if any.
+	struct BlockDefinition
+	{
+		std::string name;
+		std::string keyConstant;
+		std::vector<PatternDefinition> patterns;
+		std::vector<int> ripRelativeNextOpCodeOffsets;
+		bool isNonCritical = false;
+		int maxNumberOfMismatches = 0;		// set with allowFuzzyMatching(), 0 if the block has to match exactly.
+	};
+
+
+	// The set of AOB blocks a camera scans for, read from the camera's sources so it's always the set the camera dll uses and no camera
+	// has to be built for it. Understands the forms used in the InterceptorHelper files: 
+	// new AOBBlock(KEY, "pattern", occurrence), new AOBBlock(KEY, ScanPattern(IGCS_AOB_PATTERN("pattern"), occurrence)), addAlternative()
+	// with either form, markAsNonCritical(), allowFuzzyMatching(n) and Utils::calculateAbsoluteAddress(aobBlocks[KEY], offset).
+	class CameraPatternSet
+	{
+	public:
+		CameraPatternSet();
+		~CameraPatternSet();
+
+		// Reads the block definitions from the camera folder specified, which is either the camera's root folder or its
+		// InjectableGenericCameraSystem folder. Returns false and fills errorMessage if the sources couldn't be read.
+		bool load(const std::string& cameraFolder, std::string& errorMessage);
+		const std::vector<BlockDefinition>& blocks() const { return _blocks; }
+		const std::string& cameraName() const { return _cameraName; }
+
+	private:
+		void readKeyConstants(const std::string& sourceText);
+		void readBlocks(const std::string& sourceText);
+		void readRipRelativeUsages(const std::string& sourceText);
+		BlockDefinition* findBlockByKeyConstant(const std::string& keyConstant);
+
+		std::string _cameraName;
+		std::map<std::string, std::string> _keyConstants;		// key constant name -> value, from the #defines in the headers.
+		std::vector<BlockDefinition> _blocks;
+	};
+}
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace IGCS::AOBResolver
+{
+#ifdef _WIN32
+	MappedFile::MappedFile() : _data{ nullptr }, _size{ 0 }, _fileHandle{ INVALID_HANDLE_VALUE }, _mappingHandle{ nullptr }
+	{
+	}
+
+
+	bool MappedFile::open(const std::string& filename)
+	{
+		close();
+		_fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (INVALID_HANDLE_VALUE == _fileHandle)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+		{
+			close();
+			return false;
+		}
+		_mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (nullptr == _mappingHandle)
+		{
+			close();
+			return false;
+		}
+		_data = static_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (nullptr == _data)
+		{
+			close();
+			return false;
+		}
+		_size = static_cast<size_t>(fileSize.QuadPart);
+		return true;
+	}
+
+
+	void MappedFile::close()
+	{
+		if (nullptr != _data)
+		{
+			UnmapViewOfFile(_data);
+		}
+		if (nullptr != _mappingHandle)
+		{
+			CloseHandle(_mappingHandle);
+		}
+		if (INVALID_HANDLE_VALUE != _fileHandle)
+		{
+			CloseHandle(_fileHandle);
+		}
+		_data = nullptr;
+		_size = 0;
+		_mappingHandle = nullptr;
+		_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	MappedFile::MappedFile() : _data{ nullptr }, _size{ 0 }, _fileDescriptor{ -1 }
+	{
+	}
+
+
+	bool MappedFile::open(const std::string& filename)
+	{
+		close();
+		_fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+		if (_fileDescriptor < 0)
+		{
+			return false;
+		}
+		struct stat fileStatus;
+		if (fstat(_fileDescriptor, &fileStatus) != 0 || fileStatus.st_size <= 0)
+		{
+			close();
+			return false;
+		}
+		void* mapping = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+		if (MAP_FAILED == mapping)
+		{
+			close();
+			return false;
+		}
+		_data = static_cast<const uint8_t*>(mapping);
+		_size = static_cast<size_t>(fileStatus.st_size);
+		return true;
+	}
+
+
+	void MappedFile::close()
+	{
+		if (nullptr != _data)
+		{
+			munmap(const_cast<uint8_t*>(_data), _size);
+		}
+		if (_fileDescriptor >= 0)
+		{
+			::close(_fileDescriptor);
+		}
+		_data = nullptr;
+		_size = 0;
+		_fileDescriptor = -1;
+	}
+#endif
+
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+}
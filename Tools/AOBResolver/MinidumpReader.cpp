@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "MinidumpReader.h"
+#include "PEImage.h"
+#include <cctype>
+
+using namespace std;
+
+namespace IGCS::AOBResolver
+{
+	using namespace PEReader;
+
+	// Layout constants of the minidump format, see minidumpapiset.h.
+	static const uint32_t MINIDUMP_SIGNATURE = 0x504D444D;		// 'MDMP'
+	static const uint32_t MODULE_LIST_STREAM = 4;
+	static const uint32_t MEMORY_LIST_STREAM = 5;
+	static const uint32_t MEMORY64_LIST_STREAM = 9;
+	static const size_t HEADER_SIZE = 32;
+	static const size_t DIRECTORY_ENTRY_SIZE = 12;
+	static const size_t MODULE_ENTRY_SIZE = 108;
+	static const size_t MEMORY_DESCRIPTOR_SIZE = 16;
+	static const size_t MEMORY64_DESCRIPTOR_SIZE = 16;
+
+	static string toLower(string value)
+	{
+		transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+		return value;
+	}
+
+
+	MinidumpReader::MinidumpReader(const uint8_t* dumpStart, size_t dumpSize) : _dumpStart{ dumpStart }, _dumpSize{ dumpSize }
+	{
+	}
+
+
+	MinidumpReader::~MinidumpReader()
+	{
+	}
+
+
+	bool MinidumpReader::isMinidump(const uint8_t* dumpStart, size_t dumpSize)
+	{
+		return nullptr != dumpStart && dumpSize >= HEADER_SIZE && readUInt32(dumpStart) == MINIDUMP_SIGNATURE;
+	}
+
+
+	bool MinidumpReader::readModules()
+	{
+		_modules.clear();
+		uint32_t streamRva = 0;
+		uint32_t streamSize = 0;
+		if (!isMinidump(_dumpStart, _dumpSize) || !findStream(MODULE_LIST_STREAM, streamRva, streamSize) || streamSize < 4)
+		{
+			return false;
+		}
+		uint32_t numberOfModules = readUInt32(_dumpStart + streamRva);
+		if ((streamSize - 4) / MODULE_ENTRY_SIZE < numberOfModules)
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i < numberOfModules; i++)
+		{
+			const uint8_t* entry = _dumpStart + streamRva + 4 + i * MODULE_ENTRY_SIZE;
+			MinidumpModule module;
+			module.baseOfImage = readUInt64(entry);
+			module.sizeOfImage = readUInt32(entry + 8);
+			module.name = readModuleName(readUInt32(entry + 20));
+			_modules.push_back(module);
+		}
+		return !_modules.empty();
+	}
+
+
+	bool MinidumpReader::extractModuleImage(const string& moduleName, vector<uint8_t>& image, MinidumpModule& module, size_t& numberOfBytesFound) const
+	{
+		numberOfBytesFound = 0;
+		const MinidumpModule* moduleToExtract = nullptr;
+		for (auto& candidate : _modules)
+		{
+			if (moduleName.empty() || toLower(candidate.name) == toLower(moduleName))
+			{
+				moduleToExtract = &candidate;
+				break;
+			}
+		}
+		if (nullptr == moduleToExtract)
+		{
+			return false;
+		}
+		module = *moduleToExtract;
+		image.assign(module.sizeOfImage, 0);
+
+		uint32_t streamRva = 0;
+		uint32_t streamSize = 0;
+		if (findStream(MEMORY64_LIST_STREAM, streamRva, streamSize) && streamSize >= 16)
+		{
+			// full memory dumps: the data of all ranges is stored back to back, starting at BaseRva.
+			uint64_t numberOfRanges = readUInt64(_dumpStart + streamRva);
+			uint64_t dataRva = readUInt64(_dumpStart + streamRva + 8);
+			for (uint64_t i = 0; i < numberOfRanges && 16 + (i + 1) * MEMORY64_DESCRIPTOR_SIZE <= streamSize; i++)
+			{
+				const uint8_t* descriptor = _dumpStart + streamRva + 16 + i * MEMORY64_DESCRIPTOR_SIZE;
+				uint64_t rangeStart = readUInt64(descriptor);
+				uint64_t rangeSize = readUInt64(descriptor + 8);
+				numberOfBytesFound += copyRange(rangeStart, rangeSize, dataRva, module, image);
+				dataRva += rangeSize;
+			}
+		}
+		if (findStream(MEMORY_LIST_STREAM, streamRva, streamSize) && streamSize >= 4)
+		{
+			uint32_t numberOfRanges = readUInt32(_dumpStart + streamRva);
+			for (uint32_t i = 0; i < numberOfRanges && 4 + (i + 1) * MEMORY_DESCRIPTOR_SIZE <= streamSize; i++)
+			{
+				const uint8_t* descriptor = _dumpStart + streamRva + 4 + i * MEMORY_DESCRIPTOR_SIZE;
+				numberOfBytesFound += copyRange(readUInt64(descriptor), readUInt32(descriptor + 8), readUInt32(descriptor + 12), module, image);
+			}
+		}
+		return true;
+	}
+
+
+	bool MinidumpReader::findStream(uint32_t streamType, uint32_t& streamRva, uint32_t& streamSize) const
+	{
+		uint32_t numberOfStreams = readUInt32(_dumpStart + 8);
+		uint32_t directoryRva = readUInt32(_dumpStart + 12);
+		if (directoryRva > _dumpSize || (_dumpSize - directoryRva) / DIRECTORY_ENTRY_SIZE < numberOfStreams)
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i < numberOfStreams; i++)
+		{
+			const uint8_t* entry = _dumpStart + directoryRva + i * DIRECTORY_ENTRY_SIZE;
+			if (readUInt32(entry) != streamType)
+			{
+				continue;
+			}
+			streamSize = readUInt32(entry + 4);
+			streamRva = readUInt32(entry + 8);
+			return streamRva <= _dumpSize && streamSize <= _dumpSize - streamRva;
+		}
+		return false;
+	}
+
+
+	// Copies the part of the memory range [rangeStart, rangeStart+rangeSize), stored in the dump at dataRva, which overlaps with the module,
+	// into the module's image. Returns the number of bytes copied.
+	size_t MinidumpReader::copyRange(uint64_t rangeStart, uint64_t rangeSize, uint64_t dataRva, const MinidumpModule& module, vector<uint8_t>& image) const
+	{
+		uint64_t moduleEnd = module.baseOfImage + module.sizeOfImage;
+		uint64_t overlapStart = (std::max)(rangeStart, module.baseOfImage);
+		uint64_t overlapEnd = (std::min)(rangeStart + rangeSize, moduleEnd);
+		if (overlapStart >= overlapEnd)
+		{
+			return 0;
+		}
+		uint64_t sourceOffset = dataRva + (overlapStart - rangeStart);
+		uint64_t length = overlapEnd - overlapStart;
+		if (sourceOffset > _dumpSize || length > _dumpSize - sourceOffset)
+		{
+			// truncated dump
+			return 0;
+		}
+		memcpy(image.data() + (overlapStart - module.baseOfImage), _dumpStart + sourceOffset, static_cast<size_t>(length));
+		return static_cast<size_t>(length);
+	}
+
+
+	// Reads the MINIDUMP_STRING at the rva specified (UTF-16, length in bytes) and returns the file name part of it. Non-ASCII characters
+	// are replaced with '?', which is fine for matching module names.
+	string MinidumpReader::readModuleName(uint32_t nameRva) const
+	{
+		if (nameRva > _dumpSize || _dumpSize - nameRva < 4)
+		{
+			return "";
+		}
+		uint32_t lengthInBytes = readUInt32(_dumpStart + nameRva);
+		if (lengthInBytes > _dumpSize - nameRva - 4)
+		{
+			return "";
+		}
+		string toReturn;
+		for (uint32_t i = 0; i + 1 < lengthInBytes; i += 2)
+		{
+			uint16_t character = readUInt16(_dumpStart + nameRva + 4 + i);
+			toReturn += character < 0x80 ? static_cast<char>(character) : '?';
+		}
+		size_t lastSeparator = toReturn.find_last_of("\\/");
+		return lastSeparator == string::npos ? toReturn : toReturn.substr(lastSeparator + 1);
+	}
+}
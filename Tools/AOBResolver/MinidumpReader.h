@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IGCS::AOBResolver
+{
+	struct MinidumpModule
+	{
+		std::string name;			// file name of the module, without the path.
+		uint64_t baseOfImage;
+		uint32_t sizeOfImage;
+	};
+
+
+	// Minimal, platform independent reader of Windows minidump files: reads the module list and rebuilds the image of a module, as loaded
+	// in the process, from the memory ranges in the dump.
+	class MinidumpReader
+	{
+	public:
+		MinidumpReader(const uint8_t* dumpStart, size_t dumpSize);
+		~MinidumpReader();
+
+		// Returns true if the data starts with a minidump signature.
+		static bool isMinidump(const uint8_t* dumpStart, size_t dumpSize);
+		// Reads the module list. Returns false if the dump isn't valid or doesn't contain a module list.
+		bool readModules();
+		const std::vector<MinidumpModule>& modules() const { return _modules; }
+		// Copies the memory of the module with the name specified (case insensitive, or the first module, which is the executable, if the
+		// name is empty) into image, which is sized to the module's SizeOfImage. Bytes not present in the dump are 0. Returns false if the
+		// module isn't in the dump. numberOfBytesFound receives the number of bytes of the module present in the dump.
+		bool extractModuleImage(const std::string& moduleName, std::vector<uint8_t>& image, MinidumpModule& module, size_t& numberOfBytesFound) const;
+
+	private:
+		bool findStream(uint32_t streamType, uint32_t& streamRva, uint32_t& streamSize) const;
+		size_t copyRange(uint64_t rangeStart, uint64_t rangeSize, uint64_t dataRva, const MinidumpModule& module, std::vector<uint8_t>& image) const;
+		std::string readModuleName(uint32_t nameRva) const;
+
+		const uint8_t* _dumpStart;
+		size_t _dumpSize;
+		std::vector<MinidumpModule> _modules;
+	};
+}
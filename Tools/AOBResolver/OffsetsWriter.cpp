@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "OffsetsWriter.h"
+#include "ScanPattern.h"
+#include "ScanResultCache.h"
+#include <cstdio>
+
+using namespace std;
+
+namespace IGCS::AOBResolver::OffsetsWriter
+{
+	static string toHex(uint64_t value)
+	{
+		char buffer[24];
+		snprintf(buffer, sizeof(buffer), "0x%llX", static_cast<unsigned long long>(value));
+		return buffer;
+	}
+
+
+	static string toJsonString(const string& value)
+	{
+		string toReturn = "\"";
+		for (char c : value)
+		{
+			switch (c)
+			{
+			case '"':
+				toReturn += "\\\"";
+				break;
+			case '\\':
+				toReturn += "\\\\";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04X", static_cast<unsigned char>(c));
+					toReturn += buffer;
+				}
+				else
+				{
+					toReturn += c;
+				}
+				break;
+			}
+		}
+		return toReturn + "\"";
+	}
+
+
+	void writeJson(ostream& output, const ImageInfo& imageInfo, const vector<BlockResult>& results)
+	{
+		output << "{" << endl;
+		output << "\t\"camera\": " << toJsonString(imageInfo.cameraName) << "," << endl;
+		output << "\t\"image\": " << toJsonString(imageInfo.imageFilename) << "," << endl;
+		output << "\t\"module\": " << toJsonString(imageInfo.moduleName) << "," << endl;
+		output << "\t\"fingerprint\": " << toJsonString(toHex(imageInfo.fingerprint)) << "," << endl;
+		output << "\t\"sizeOfImage\": " << toJsonString(toHex(imageInfo.sizeOfImage)) << "," << endl;
+		output << "\t\"imageBase\": " << toJsonString(toHex(imageInfo.imageBase)) << "," << endl;
+		output << "\t\"blocks\": [";
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const BlockResult& result = results[i];
+			output << (i > 0 ? "," : "") << endl << "\t\t{" << endl;
+			output << "\t\t\t\"name\": " << toJsonString(result.definition->name) << "," << endl;
+			output << "\t\t\t\"found\": " << (result.found ? "true" : "false") << "," << endl;
+			output << "\t\t\t\"critical\": " << (result.definition->isNonCritical ? "false" : "true");
+			if (!result.invalidPatternIndices.empty())
+			{
+				output << "," << endl << "\t\t\t\"invalidPatterns\": [";
+				for (size_t j = 0; j < result.invalidPatternIndices.size(); j++)
+				{
+					output << (j > 0 ? ", " : "") << result.invalidPatternIndices[j];
+				}
+				output << "]";
+			}
+			if (result.found)
+			{
+				output << "," << endl;
+				output << "\t\t\t\"patternIndex\": " << result.patternIndex << "," << endl;
+				output << "\t\t\t\"rva\": " << toJsonString(toHex(result.rva)) << "," << endl;
+				output << "\t\t\t\"customOffset\": " << result.customOffset << "," << endl;
+				output << "\t\t\t\"matches\": " << result.numberOfMatches << "," << endl;
+				output << "\t\t\t\"matchesComplete\": " << (result.numberOfMatchesIsComplete ? "true" : "false") << "," << endl;
+				output << "\t\t\t\"ambiguous\": " << (result.isAmbiguous ? "true" : "false");
+				if (result.isApproximate)
+				{
+					output << "," << endl << "\t\t\t\"approximate\": { \"mismatches\": " << result.numberOfMismatches << ", \"confidence\": " << result.confidence
+						   << ", \"mismatchIndices\": [";
+					for (size_t j = 0; j < result.mismatchIndices.size(); j++)
+					{
+						output << (j > 0 ? ", " : "") << result.mismatchIndices[j];
+					}
+					output << "], \"updatedPattern\": " << toJsonString(result.updatedPattern) << " }";
+				}
+				if (!result.ripRelativeTargets.empty())
+				{
+					output << "," << endl << "\t\t\t\"ripRelativeTargets\": [";
+					for (size_t j = 0; j < result.ripRelativeTargets.size(); j++)
+					{
+						const RipRelativeTarget& target = result.ripRelativeTargets[j];
+						output << (j > 0 ? ", " : "") << "{ \"nextOpCodeOffset\": " << target.nextOpCodeOffset << ", \"rva\": "
+							   << (target.isResolved ? toJsonString(toHex(target.rva)) : "null") << " }";
+					}
+					output << "]";
+				}
+			}
+			output << endl << "\t\t}";
+		}
+		output << endl << "\t]" << endl << "}" << endl;
+	}
+
+
+	bool writeScanCache(const string& filename, const ImageInfo& imageInfo, const vector<BlockResult>& results)
+	{
+		ScanResultCache cache;
+		cache.clear(imageInfo.fingerprint);
+		for (auto& result : results)
+		{
+			// an approximate match doesn't verify in place in the camera dll, so it's not cached.
+			if (result.found && !result.isApproximate)
+			{
+				const PatternDefinition& patternDefinition = result.definition->patterns[result.patternIndex];
+				ScanPattern pattern(patternDefinition.patternText, patternDefinition.occurrence);
+				cache.set(result.definition->name, CachedLocation{ result.patternIndex, patternDefinition.occurrence, ScanResultCache::calculatePatternHash(pattern.view()), result.rva });
+			}
+		}
+		return cache.save(filename);
+	}
+}
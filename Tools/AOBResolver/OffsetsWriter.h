@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "BlockResolver.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace IGCS::AOBResolver
+{
+	// Information about the image the blocks were resolved in, written in the header of the offsets files.
+	struct ImageInfo
+	{
+		std::string cameraName;
+		std::string imageFilename;
+		std::string moduleName;
+		uint64_t fingerprint;
+		uint32_t sizeOfImage;
+		uint64_t imageBase;
+	};
+
+
+	namespace OffsetsWriter
+	{
+		// Writes the results as a JSON document, with all RVAs as hexadecimal strings.
+		void writeJson(std::ostream& output, const ImageInfo& imageInfo, const std::vector<BlockResult>& results);
+		// Writes the results as a scan result cache file, which the camera dll loads at startup, when placed next to the dll with the
+		// same name and the .scancache extension, to verify the offsets in place instead of scanning. Returns false if the file couldn't
+		// be written.
+		bool writeScanCache(const std::string& filename, const ImageInfo& imageInfo, const std::vector<BlockResult>& results);
+	}
+}
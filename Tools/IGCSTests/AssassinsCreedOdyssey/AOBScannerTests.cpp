@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "ScannerTestData.h"
+#include "AOBScanner.h"
+#include "ScanPattern.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace IGCS;
+using namespace IGCS::Tests;
+
+namespace
+{
+	// Checks findPattern and findOccurrences against the naive scanner for the pattern specified.
+	void checkAgainstNaiveScanner(const uint8_t* rangeStart, size_t rangeLength, const PatternView& pattern)
+	{
+		std::vector<const uint8_t*> expected = findAllNaive(rangeStart, rangeLength, pattern);
+		std::vector<const uint8_t*> found;
+		int numberFound = AOBScanner::findOccurrences(rangeStart, rangeLength, pattern, 1000000, found);
+		CHECK(numberFound == static_cast<int>(expected.size()));
+		CHECK(found == expected);
+		int numberOfOccurrencesToCheck = (std::min)(static_cast<int>(expected.size()), 4);
+		for (int occurrence = 1; occurrence <= numberOfOccurrencesToCheck; occurrence++)
+		{
+			CHECK(AOBScanner::findPattern(rangeStart, rangeLength, pattern, occurrence) == expected[occurrence - 1]);
+		}
+		CHECK(AOBScanner::findPattern(rangeStart, rangeLength, pattern, static_cast<int>(expected.size()) + 1) == nullptr);
+	}
+}
+
+
+IGCS_TEST(AOBScanner, MatchesNaiveScannerOnRandomImages)
+{
+	std::mt19937 random(1);
+	for (int round = 0; round < 200; round++)
+	{
+		// odd sizes, so the tails after the 16 and 32 byte blocks are scanned as well
+		size_t imageSize = 64 + random() % 5000;
+		std::vector<uint8_t> image = createCodeLikeImage(imageSize, static_cast<uint32_t>(round));
+		int patternSize = 1 + static_cast<int>(random() % 40);
+		size_t offset = random() % (imageSize - patternSize + 1);
+		TestPattern pattern = createPatternFromImage(image, offset, patternSize, random);
+		checkAgainstNaiveScanner(image.data(), image.size(), pattern.view());
+	}
+}
+
+
+IGCS_TEST(AOBScanner, FindsMatchesAtTheEdgesOfTheRange)
+{
+	std::mt19937 random(2);
+	std::vector<uint8_t> image = createCodeLikeImage(1000, 2);
+	for (int patternSize : { 1, 2, 15, 16, 17, 31, 32, 33, 48 })
+	{
+		TestPattern atStart = createPatternFromImage(image, 0, patternSize, random);
+		TestPattern atEnd = createPatternFromImage(image, image.size() - patternSize, patternSize, random);
+		checkAgainstNaiveScanner(image.data(), image.size(), atStart.view());
+		checkAgainstNaiveScanner(image.data(), image.size(), atEnd.view());
+		// a range which ends in the middle of the match doesn't contain it
+		std::vector<const uint8_t*> found;
+		AOBScanner::findOccurrences(image.data(), image.size() - 1, atEnd.view(), 1000, found);
+		CHECK(std::find(found.begin(), found.end(), image.data() + image.size() - patternSize) == found.end());
+	}
+}
+
+
+IGCS_TEST(AOBScanner, FindsOverlappingOccurrences)
+{
+	std::vector<uint8_t> image(300, 0x90);
+	for (size_t i = 100; i < 200; i++)
+	{
+		image[i] = 0xAB;
+	}
+	ScanPattern pattern("AB AB AB", 1);
+	checkAgainstNaiveScanner(image.data(), image.size(), pattern.view());
+	CHECK(AOBScanner::findPattern(image.data(), image.size(), pattern.view(), 1) == image.data() + 100);
+	CHECK(AOBScanner::findPattern(image.data(), image.size(), pattern.view(), 98) == image.data() + 197);
+	CHECK(AOBScanner::findPattern(image.data(), image.size(), pattern.view(), 99) == nullptr);
+}
+
+
+IGCS_TEST(AOBScanner, MatchesPatternsWithoutFullyComparedBytes)
+{
+	std::vector<uint8_t> image = createCodeLikeImage(777, 3);
+	ScanPattern allWildcards("?? ?? ??", 1);
+	checkAgainstNaiveScanner(image.data(), image.size(), allWildcards.view());
+	ScanPattern nibblesOnly("4? ?B ??", 1);
+	checkAgainstNaiveScanner(image.data(), image.size(), nibblesOnly.view());
+}
+
+
+IGCS_TEST(AOBScanner, PicksRareBytesAsAnchors)
+{
+	ScanPattern pattern("48 8B 05 ?? ?? ?? ?? 48 85 C0 74 3A", 1);
+	REQUIRE(pattern.patternSize() == 12);
+	// 0x3A isn't in the list of common bytes in code, 0x05 is the least common of the others
+	CHECK(pattern.anchorIndex() == 11);
+	CHECK(pattern.view().secondaryAnchorIndex == 2);
+}
+
+
+IGCS_TEST(AOBScanner, ParsesPatternText)
+{
+	ScanPattern pattern("48 ?? 4? ?C | 90 ?", 1);
+	REQUIRE(pattern.patternSize() == 6);
+	const uint8_t expectedBytes[] = { 0x48, 0x00, 0x40, 0x0C, 0x90, 0x00 };
+	const uint8_t expectedMask[] = { 0x00, 0xFF, 0x0F, 0xF0, 0x00, 0xFF };
+	CHECK(memcmp(pattern.bytePattern(), expectedBytes, sizeof(expectedBytes)) == 0);
+	CHECK(memcmp(pattern.compareMask(), expectedMask, sizeof(expectedMask)) == 0);
+	CHECK(pattern.customOffset() == 4);
+
+	ScanPattern invalid("48 8X", 1);
+	CHECK(invalid.patternSize() == 0);
+	std::vector<uint8_t> image(64, 0x48);
+	CHECK(AOBScanner::findPattern(image.data(), image.size(), invalid.view(), 1) == nullptr);
+}
+
+
+IGCS_TEST(AOBScanner, ParsesPatternLiteralsLikeRuntimePatterns)
+{
+	const auto& literal = IGCS_AOB_PATTERN("F3 0F 10 ?? ?? 8B | 4? 28 C3");
+	ScanPattern fromLiteral(literal, 1);
+	ScanPattern fromText("F3 0F 10 ?? ?? 8B | 4? 28 C3", 1);
+	REQUIRE(fromLiteral.patternSize() == fromText.patternSize());
+	CHECK(memcmp(fromLiteral.bytePattern(), fromText.bytePattern(), fromText.patternSize()) == 0);
+	CHECK(memcmp(fromLiteral.compareMask(), fromText.compareMask(), fromText.patternSize()) == 0);
+	CHECK(fromLiteral.customOffset() == fromText.customOffset());
+	CHECK(fromLiteral.anchorIndex() == fromText.anchorIndex());
+}
@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "ScannerTestData.h"
+#include "ApproximateScanner.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace IGCS;
+using namespace IGCS::Tests;
+
+namespace
+{
+	struct NaiveMatch
+	{
+		const uint8_t* location = nullptr;
+		int numberOfMismatches = 0;
+		int numberOfCandidates = 0;
+	};
+
+
+	int countMismatches(const uint8_t* location, const PatternView& pattern)
+	{
+		int toReturn = 0;
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			toReturn += ((location[i] ^ pattern.bytePattern[i]) & ~pattern.compareMask[i] & 0xFF) != 0 ? 1 : 0;
+		}
+		return toReturn;
+	}
+
+
+	// The reference for findBestMatch: the first location with the fewest mismatches, at most maxNumberOfMismatches, and the number of
+	// locations with that many mismatches.
+	NaiveMatch findBestMatchNaive(const std::vector<ScanRange>& ranges, const PatternView& pattern, int maxNumberOfMismatches)
+	{
+		NaiveMatch toReturn;
+		toReturn.numberOfMismatches = maxNumberOfMismatches + 1;
+		for (auto& range : ranges)
+		{
+			for (size_t start = 0; start + pattern.patternSize <= range.length; start++)
+			{
+				int numberOfMismatches = countMismatches(range.start + start, pattern);
+				if (numberOfMismatches < toReturn.numberOfMismatches)
+				{
+					toReturn.location = range.start + start;
+					toReturn.numberOfMismatches = numberOfMismatches;
+					toReturn.numberOfCandidates = 0;
+				}
+				toReturn.numberOfCandidates += numberOfMismatches == toReturn.numberOfMismatches ? 1 : 0;
+			}
+		}
+		return toReturn;
+	}
+
+
+	// Changes numberOfChanges fully compared bytes of the pattern (fewer if it doesn't have that many), so it matches its source with that
+	// many mismatches. Returns the indices changed, in order.
+	std::vector<int> changeComparedBytes(TestPattern& pattern, int numberOfChanges, std::mt19937& random)
+	{
+		std::vector<int> toReturn;
+		numberOfChanges = (std::min)(numberOfChanges, static_cast<int>(std::count(pattern.compareMask.begin(), pattern.compareMask.end(), static_cast<uint8_t>(0))));
+		while (static_cast<int>(toReturn.size()) < numberOfChanges)
+		{
+			int index = static_cast<int>(random() % pattern.bytePattern.size());
+			if (pattern.compareMask[index] != 0 || std::find(toReturn.begin(), toReturn.end(), index) != toReturn.end())
+			{
+				continue;
+			}
+			pattern.bytePattern[index] ^= static_cast<uint8_t>(1 + random() % 255);
+			toReturn.push_back(index);
+		}
+		std::sort(toReturn.begin(), toReturn.end());
+		return toReturn;
+	}
+}
+
+
+IGCS_TEST(ApproximateScanner, MatchesNaiveScannerOnRandomImages)
+{
+	std::mt19937 random(11);
+	// the maximum number of mismatches determines the counter size, so each one tests another table layout.
+	for (int maxNumberOfMismatches : { 0, 1, 3, 7, 20, 127 })
+	{
+		const int maxPatternSize = maxNumberOfMismatches < 2 ? 256 : (maxNumberOfMismatches < 8 ? 128 : 64);
+		for (int round = 0; round < 20; round++)
+		{
+			std::vector<uint8_t> image = createCodeLikeImage(2000 + random() % 3000, static_cast<uint32_t>(round));
+			int patternSize = 1 + static_cast<int>(random() % maxPatternSize);
+			TestPattern pattern = createPatternFromImage(image, random() % (image.size() - patternSize), patternSize, random);
+			changeComparedBytes(pattern, static_cast<int>(random() % 4), random);
+			// two ranges, with a gap a match can't span.
+			std::vector<ScanRange> ranges{ ScanRange{ image.data(), image.size() / 2 }, ScanRange{ image.data() + image.size() / 2 + 3, image.size() / 2 - 3 } };
+			NaiveMatch expected = findBestMatchNaive(ranges, pattern.view(), maxNumberOfMismatches);
+			ApproximateMatch match = ApproximateScanner::findBestMatch(ranges, pattern.view(), maxNumberOfMismatches, 1);
+			CHECK(match.location == expected.location);
+			if (nullptr != expected.location)
+			{
+				CHECK(match.numberOfMismatches == expected.numberOfMismatches);
+				CHECK(match.numberOfCandidates == expected.numberOfCandidates);
+				CHECK(static_cast<int>(match.mismatchIndices.size()) == match.numberOfMismatches);
+			}
+		}
+	}
+}
+
+
+IGCS_TEST(ApproximateScanner, ReportsTheMismatchesOfTheLocationFound)
+{
+	std::mt19937 random(12);
+	std::vector<uint8_t> image = createCodeLikeImage(64 * 1024, 12);
+	const size_t offset = 40000;
+	TestPattern pattern = createPatternFromImage(image, offset, 48, random);
+	std::vector<int> changedIndices = changeComparedBytes(pattern, 5, random);
+	std::vector<ScanRange> ranges{ ScanRange{ image.data(), image.size() } };
+	ApproximateMatch match = ApproximateScanner::findBestMatch(ranges, pattern.view(), 10, 1);
+	REQUIRE(match.location == image.data() + offset);
+	CHECK(match.numberOfMismatches == 5);
+	CHECK(match.mismatchIndices == changedIndices);
+	CHECK(match.numberOfCandidates == 1);
+	int numberOfWildcards = static_cast<int>(std::count(pattern.compareMask.begin(), pattern.compareMask.end(), static_cast<uint8_t>(0xFF)));
+	CHECK(match.numberOfComparedBytes == 48 - numberOfWildcards);
+	CHECK(match.isUsable(ApproximateScanner::MINIMUM_CONFIDENCE) == (match.confidence() >= ApproximateScanner::MINIMUM_CONFIDENCE));
+	// too many mismatches: not found, but the number of compared bytes is still reported.
+	ApproximateMatch noMatch = ApproximateScanner::findBestMatch(ranges, pattern.view(), 4, 1);
+	CHECK(noMatch.location == nullptr);
+	CHECK(noMatch.numberOfComparedBytes == match.numberOfComparedBytes);
+	CHECK(!noMatch.isUsable(0.0));
+}
+
+
+IGCS_TEST(ApproximateScanner, CountsEquallyCloseCandidatesAcrossChunks)
+{
+	std::mt19937 random(13);
+	// larger than a few chunks, so the chunks are scanned by several threads and merged.
+	std::vector<uint8_t> image = createCodeLikeImage(1100 * 1024, 13);
+	TestPattern pattern = createPatternFromImage(image, 100, 40, random);
+	changeComparedBytes(pattern, 2, random);
+	std::vector<ScanRange> ranges{ ScanRange{ image.data(), image.size() } };
+	ApproximateMatch match = ApproximateScanner::findBestMatch(ranges, pattern.view(), 6, 4);
+	CHECK(match.location == image.data() + 100);
+	CHECK(match.numberOfCandidates == 1);
+	CHECK(match.numberOfMismatches == 2);
+	// the same code in another chunk, across a chunk boundary: equally close, so the location isn't usable.
+	const size_t copyOffset = 512 * 1024 - 20;
+	memcpy(&image[copyOffset], &image[100], 40);
+	ApproximateMatch ambiguousMatch = ApproximateScanner::findBestMatch(ranges, pattern.view(), 6, 4);
+	CHECK(ambiguousMatch.location == image.data() + 100);
+	CHECK(ambiguousMatch.numberOfCandidates == 2);
+	CHECK(!ambiguousMatch.isUsable(ApproximateScanner::MINIMUM_CONFIDENCE));
+	NaiveMatch expected = findBestMatchNaive(ranges, pattern.view(), 6);
+	CHECK(ambiguousMatch.numberOfCandidates == expected.numberOfCandidates);
+}
+
+
+IGCS_TEST(ApproximateScanner, CreatesThePatternTextOfTheLocation)
+{
+	const uint8_t location[] = { 0x48, 0x8B, 0x05, 0x12, 0x34, 0x56, 0x78, 0xF3 };
+	const uint8_t bytePattern[] = { 0x48, 0x8B, 0x05, 0x00, 0x00, 0x00, 0x00, 0xF2 };
+	const uint8_t compareMask[] = { 0x00, 0x00, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+	PatternView pattern{ bytePattern, compareMask, 8, 0, 1 };
+	CHECK(ApproximateScanner::createPatternText(location, pattern, 0) == "48 8B 0? ?? ?? ?? ?? F3");
+	CHECK(ApproximateScanner::createPatternText(location, pattern, 3) == "48 8B 0? | ?? ?? ?? ?? F3");
+}
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "FrameClock.h"
+#include <cmath>
+
+using namespace IGCS;
+
+namespace
+{
+	class SimulatedTimeSource : public TimeSource
+	{
+	public:
+		SimulatedTimeSource() : _now(1000000) {}
+		int64_t nowInMicroseconds() override { return _now; }
+		void advance(int64_t microseconds) { _now += microseconds; }
+
+	private:
+		int64_t _now;
+	};
+}
+
+
+IGCS_TEST(FrameClock, MeasuresTheElapsedTime)
+{
+	SimulatedTimeSource timeSource;
+	FrameClock clock(timeSource);
+	timeSource.advance(16667);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.016667f) < 1e-7f);
+	timeSource.advance(4000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.004f) < 1e-7f);
+	// no time elapsed, no movement
+	CHECK(clock.tick().deltaSeconds == 0.0f);
+}
+
+
+IGCS_TEST(FrameClock, CapsAStallAtTheMaxDelta)
+{
+	SimulatedTimeSource timeSource;
+	FrameClock clock(timeSource);
+	clock.setMaxDeltaSeconds(0.05f);
+	timeSource.advance(5000000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.05f) < 1e-7f);
+	timeSource.advance(8000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.008f) < 1e-7f);
+}
+
+
+// The hammer prevention sleep and the time before the loop starts aren't simulated.
+IGCS_TEST(FrameClock, DiscardsTheElapsedTime)
+{
+	SimulatedTimeSource timeSource;
+	FrameClock clock(timeSource);
+	timeSource.advance(300000);
+	clock.discardElapsedTime();
+	timeSource.advance(2000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.002f) < 1e-7f);
+	timeSource.advance(50000);
+	clock.reset();
+	timeSource.advance(3000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.003f) < 1e-7f);
+}
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "ScannerTestData.h"
+#include "MultiPatternScanner.h"
+#include "ScanPattern.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace IGCS;
+using namespace IGCS::Tests;
+
+namespace
+{
+	const size_t CHUNK_SIZE = 256 * 1024;		// as used by MultiPatternScanner::scanParallel
+	const int MATCH_INDEX_LIMIT = 32;
+
+
+	// Creates a set of patterns found in the image: long ones which share the Wu-Manber scan, short ones which are scanned individually,
+	// and some which are copied into the image a couple of times, also across the chunk boundaries of a parallel scan.
+	std::vector<TestPattern> createPatterns(std::vector<uint8_t>& image, std::mt19937& random)
+	{
+		std::vector<TestPattern> toReturn;
+		for (int i = 0; i < 60; i++)
+		{
+			int patternSize = (i % 4 == 0) ? 2 + static_cast<int>(random() % 4) : 6 + static_cast<int>(random() % 30);
+			size_t offset = random() % (image.size() - patternSize);
+			TestPattern pattern = createPatternFromImage(image, offset, patternSize, random);
+			int numberOfCopies = static_cast<int>(random() % 4);
+			for (int copy = 0; copy < numberOfCopies; copy++)
+			{
+				// half of the copies straddle a chunk boundary
+				size_t copyOffset = (copy % 2 == 0) ? (1 + random() % (image.size() / CHUNK_SIZE - 1)) * CHUNK_SIZE - random() % patternSize
+													: random() % (image.size() - patternSize);
+				memcpy(image.data() + copyOffset, image.data() + offset, patternSize);
+			}
+			toReturn.push_back(pattern);
+		}
+		return toReturn;
+	}
+
+
+	std::vector<const uint8_t*> findAllNaive(const std::vector<ScanRange>& ranges, const PatternView& pattern)
+	{
+		std::vector<const uint8_t*> toReturn;
+		for (auto& range : ranges)
+		{
+			std::vector<const uint8_t*> inRange = IGCS::Tests::findAllNaive(range.start, range.length, pattern);
+			toReturn.insert(toReturn.end(), inRange.begin(), inRange.end());
+		}
+		return toReturn;
+	}
+
+
+	// Checks the occurrence index of every pattern against the naive scanner. The patterns were added with the occurrences specified.
+	void checkResults(const MultiPatternScanner& scanner, const std::vector<TestPattern>& patterns, const std::vector<int>& occurrences, 
+					  const std::vector<ScanRange>& ranges)
+	{
+		for (int id = 0; id < scanner.numberOfPatterns(); id++)
+		{
+			std::vector<const uint8_t*> expected = findAllNaive(ranges, patterns[id].view());
+			int matchLimit = (std::max)(MATCH_INDEX_LIMIT, occurrences[id] + 1);
+			bool expectedIndexComplete = expected.size() < static_cast<size_t>(matchLimit);
+			if (!expectedIndexComplete)
+			{
+				expected.resize(matchLimit);
+			}
+			// a pattern added more than once shares its index, which has the highest limit of both, so only compare what both have.
+			const std::vector<const uint8_t*>& found = scanner.occurrences(id);
+			REQUIRE(found.size() >= (std::min)(expected.size(), static_cast<size_t>(MATCH_INDEX_LIMIT)));
+			CHECK(std::equal(found.begin(), found.begin() + (std::min)(found.size(), expected.size()), expected.begin()));
+			const uint8_t* expectedLocation = static_cast<size_t>(occurrences[id]) <= expected.size() ? expected[occurrences[id] - 1] : nullptr;
+			CHECK(scanner.location(id) == expectedLocation);
+			CHECK(scanner.isAmbiguous(id) == (expected.size() > static_cast<size_t>(occurrences[id])));
+		}
+	}
+}
+
+
+IGCS_TEST(MultiPatternScanner, MatchesNaiveScanner)
+{
+	std::mt19937 random(10);
+	std::vector<uint8_t> image = createCodeLikeImage(4 * CHUNK_SIZE + 1234, 10);
+	std::vector<TestPattern> patterns = createPatterns(image, random);
+	MultiPatternScanner scanner;
+	std::vector<int> occurrences;
+	for (auto& pattern : patterns)
+	{
+		occurrences.push_back(1 + static_cast<int>(random() % 3));
+		scanner.addPattern(pattern.view(), occurrences.back());
+	}
+	std::vector<ScanRange> ranges{ ScanRange{ image.data(), image.size() } };
+	scanner.scan(image.data(), image.size());
+	checkResults(scanner, patterns, occurrences, ranges);
+}
+
+
+IGCS_TEST(MultiPatternScanner, ParallelScanMatchesSerialScan)
+{
+	std::mt19937 random(11);
+	std::vector<uint8_t> image = createCodeLikeImage(6 * CHUNK_SIZE + 777, 11);
+	std::vector<TestPattern> patterns = createPatterns(image, random);
+	std::vector<int> occurrences;
+	for (size_t i = 0; i < patterns.size(); i++)
+	{
+		occurrences.push_back(1 + static_cast<int>(random() % 3));
+	}
+	std::vector<ScanRange> ranges{ ScanRange{ image.data(), image.size() } };
+	MultiPatternScanner serialScanner;
+	for (size_t i = 0; i < patterns.size(); i++)
+	{
+		serialScanner.addPattern(patterns[i].view(), occurrences[i]);
+	}
+	serialScanner.scan(ranges);
+	for (int numberOfThreads : { 2, 3, 8 })
+	{
+		MultiPatternScanner parallelScanner;
+		for (size_t i = 0; i < patterns.size(); i++)
+		{
+			parallelScanner.addPattern(patterns[i].view(), occurrences[i]);
+		}
+		parallelScanner.scanParallel(ranges, numberOfThreads);
+		for (int id = 0; id < parallelScanner.numberOfPatterns(); id++)
+		{
+			CHECK(parallelScanner.occurrences(id) == serialScanner.occurrences(id));
+			CHECK(parallelScanner.location(id) == serialScanner.location(id));
+		}
+		checkResults(parallelScanner, patterns, occurrences, ranges);
+	}
+}
+
+
+IGCS_TEST(MultiPatternScanner, FindsMatchesAcrossChunkBoundaries)
+{
+	std::vector<uint8_t> image = createCodeLikeImage(8 * CHUNK_SIZE, 13);
+	// one pattern which shares the Wu-Manber scan and one without a long enough run of bytes, which is scanned individually. They're placed
+	// across the chunk boundaries in turn, each at a different offset.
+	ScanPattern sharedScanPattern("3A 3B 3C 3D 3E 3F 5A 5B", 1);
+	ScanPattern individualPattern("6A ?? 6B ?? 6C ?? 6D", 1);
+	std::vector<const uint8_t*> expectedShared;
+	std::vector<const uint8_t*> expectedIndividual;
+	for (size_t chunk = 1; chunk < 8; chunk++)
+	{
+		ScanPattern& pattern = (chunk % 2 == 1) ? sharedScanPattern : individualPattern;
+		uint8_t* location = image.data() + chunk * CHUNK_SIZE - 1 - chunk % 6;
+		memcpy(location, pattern.bytePattern(), pattern.patternSize());
+		(chunk % 2 == 1 ? expectedShared : expectedIndividual).push_back(location);
+	}
+	REQUIRE(findAllNaive(image.data(), image.size(), sharedScanPattern.view()) == expectedShared);
+	REQUIRE(findAllNaive(image.data(), image.size(), individualPattern.view()) == expectedIndividual);
+	for (int numberOfThreads : { 1, 4 })
+	{
+		MultiPatternScanner scanner;
+		int sharedId = scanner.addPattern(sharedScanPattern.view(), 1);
+		int individualId = scanner.addPattern(individualPattern.view(), 1);
+		scanner.scanParallel(image.data(), image.size(), numberOfThreads);
+		CHECK(scanner.occurrences(sharedId) == expectedShared);
+		CHECK(scanner.occurrences(individualId) == expectedIndividual);
+	}
+}
+
+
+IGCS_TEST(MultiPatternScanner, CountsOccurrencesAcrossRanges)
+{
+	std::vector<uint8_t> image = createCodeLikeImage(3 * CHUNK_SIZE, 12);
+	ScanPattern pattern("DE AD BE EF 13 37 ?? C0 DE", 1);
+	const uint8_t bytes[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x13, 0x37, 0x99, 0xC0, 0xDE };
+	// one in the first range, one spanning the gap between the ranges and one in the second range
+	memcpy(image.data() + 1000, bytes, sizeof(bytes));
+	memcpy(image.data() + CHUNK_SIZE - 4, bytes, sizeof(bytes));
+	memcpy(image.data() + 2 * CHUNK_SIZE + 100, bytes, sizeof(bytes));
+	std::vector<ScanRange> ranges{ ScanRange{ image.data(), CHUNK_SIZE }, ScanRange{ image.data() + CHUNK_SIZE, 2 * CHUNK_SIZE } };
+	for (int numberOfThreads : { 1, 4 })
+	{
+		MultiPatternScanner scanner;
+		int first = scanner.addPattern(pattern.view(), 1);
+		int second = scanner.addPattern(pattern.view(), 2);
+		scanner.scanParallel(ranges, numberOfThreads);
+		CHECK(scanner.location(first) == image.data() + 1000);
+		CHECK(scanner.location(second) == image.data() + 2 * CHUNK_SIZE + 100);
+		CHECK(scanner.location(first, 3) == nullptr);
+		CHECK(scanner.isIndexComplete(first));
+		CHECK(scanner.isAmbiguous(first));
+		CHECK(!scanner.isAmbiguous(second));
+	}
+}
+
+
+IGCS_TEST(MultiPatternScanner, LimitsTheOccurrenceIndex)
+{
+	std::vector<uint8_t> image(64 * 1024, 0xCC);
+	ScanPattern pattern("CC CC CC CC CC", 1);
+	MultiPatternScanner scanner;
+	int first = scanner.addPattern(pattern.view(), 1);
+	int late = scanner.addPattern(pattern.view(), 100);
+	scanner.scan(image.data(), image.size());
+	CHECK(!scanner.isIndexComplete(first));
+	CHECK(scanner.occurrences(first).size() == 101);
+	CHECK(scanner.location(late) == image.data() + 99);
+	CHECK(scanner.location(first, 102) == nullptr);
+}
@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "PEImage.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+using namespace IGCS;
+using namespace IGCS::PEReader;
+
+namespace
+{
+	const size_t NT_HEADERS_OFFSET = 0x40;
+	const size_t FILE_HEADER_OFFSET = NT_HEADERS_OFFSET + 4;
+	const size_t OPTIONAL_HEADER_OFFSET = FILE_HEADER_OFFSET + 20;
+	// Offset of the end of the section table of Tiny64: the image isn't valid without the whole table.
+	const size_t TINY64_HEADERS_END = OPTIONAL_HEADER_OFFSET + 240 + 3 * PEImage::SECTION_HEADER_SIZE;
+
+	// Reads a fixture from the Fixtures folder, see the ReadMe.md there for what's in them.
+	std::vector<uint8_t> readFixture(const char* fileName)
+	{
+		std::ifstream file(std::string(IGCS_TEST_FIXTURE_FOLDER) + "/" + fileName, std::ios::binary);
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+
+	// The section of the image with the name specified, or nullptr if there's no such section.
+	const PESection* findSection(const PEImage& image, const char* name)
+	{
+		for (const PESection& section : image.sections())
+		{
+			if (section.name == name)
+			{
+				return &section;
+			}
+		}
+		return nullptr;
+	}
+
+
+	// True if the rva converts to an offset at which the image has the bytes specified.
+	bool rvaHasBytes(const PEImage& image, uint32_t rva, const void* expected, size_t length)
+	{
+		size_t offset = 0;
+		return image.rvaToOffset(rva, offset) && offset + length <= image.imageSize() && memcmp(image.imageStart() + offset, expected, length) == 0;
+	}
+
+
+	// Checks that everything the image hands out is within the image.
+	bool staysWithinTheImage(const PEImage& image)
+	{
+		bool toReturn = true;
+		for (const PESection& section : image.sections())
+		{
+			toReturn &= (section.length == 0) || (section.offset < image.imageSize() && image.imageSize() - section.offset >= section.length);
+		}
+		const SectionClass classes[] = { SectionClass::Code, SectionClass::ReadOnlyData, SectionClass::Data };
+		for (SectionClass sectionClass : classes)
+		{
+			for (const ScanRange& range : image.rangesOfClass(sectionClass))
+			{
+				toReturn &= range.start >= image.imageStart() && range.start + range.length <= image.imageStart() + image.imageSize();
+			}
+		}
+		for (uint32_t rva = 0; rva < 0x1100; rva += 4)
+		{
+			size_t offset = 0;
+			if (image.rvaToOffset(rva, offset))
+			{
+				toReturn &= offset < image.imageSize();
+			}
+		}
+		return toReturn;
+	}
+
+
+	// Parses a copy of the bytes in a buffer of exactly their size, so reading past the end is caught by e.g. AddressSanitizer.
+	bool parsesAsValid(const std::vector<uint8_t>& bytes)
+	{
+		std::unique_ptr<uint8_t[]> copy(new uint8_t[bytes.size()]);
+		std::copy(bytes.begin(), bytes.end(), copy.get());
+		PEImage image(copy.get(), bytes.size(), false);
+		return image.isValid() && staysWithinTheImage(image);
+	}
+}
+
+
+IGCS_TEST(PEImage, ParsesTheHeaders)
+{
+	std::vector<uint8_t> bytes = readFixture("Tiny64File.bin");
+	REQUIRE(bytes.size() == 0x700);
+	PEImage image(bytes.data(), bytes.size(), false);
+	REQUIRE(image.isValid());
+	CHECK(image.imageBase() == 0x140000000ull);
+	CHECK(image.sizeOfImage() == 0x1000);
+	CHECK(readUInt16(image.fileHeader()) == 0x8664);
+	CHECK(readUInt16(image.optionalHeader()) == 0x20B);
+	CHECK(image.sectionTable() == bytes.data() + OPTIONAL_HEADER_OFFSET + 240);
+	CHECK(image.sectionTableSize() == 3 * PEImage::SECTION_HEADER_SIZE);
+	REQUIRE(image.sections().size() == 3);
+	const PESection& rdata = image.sections()[1];
+	CHECK(rdata.name == ".rdata");
+	CHECK(rdata.virtualAddress == 0x800);
+	CHECK(rdata.virtualSize == 0x60);
+	CHECK(rdata.pointerToRawData == 0x400);
+	CHECK(rdata.sizeOfRawData == 0x200);
+	CHECK(rdata.characteristics == 0x40000040);
+
+	std::vector<uint8_t> bytes32 = readFixture("Tiny32File.bin");
+	PEImage image32(bytes32.data(), bytes32.size(), false);
+	REQUIRE(image32.isValid());
+	CHECK(image32.imageBase() == 0x10000000);
+	CHECK(image32.sizeOfImage() == 0x3000);
+	CHECK(image32.sections().size() == 2);
+}
+
+
+IGCS_TEST(PEImage, ClassifiesTheSections)
+{
+	std::vector<uint8_t> bytes = readFixture("Tiny64File.bin");
+	PEImage image(bytes.data(), bytes.size(), false);
+	REQUIRE(image.sections().size() == 3);
+	CHECK(image.sections()[0].sectionClass == SectionClass::Code);
+	CHECK(image.sections()[1].sectionClass == SectionClass::ReadOnlyData);
+	CHECK(image.sections()[2].sectionClass == SectionClass::Data);
+	const std::vector<ScanRange> code = image.rangesOfClass(SectionClass::Code);
+	REQUIRE(code.size() == 1);
+	CHECK(code[0].start == bytes.data() + 0x200);
+	CHECK(code[0].length == 0x200);
+	CHECK(image.rangesOfClass(SectionClass::ReadOnlyData).size() == 1);
+	CHECK(image.rangesOfClass(SectionClass::Data).size() == 1);
+
+	// uninitialized data is data too, but without raw data there's nothing of it in the file.
+	std::vector<uint8_t> bytes32 = readFixture("Tiny32File.bin");
+	PEImage image32(bytes32.data(), bytes32.size(), false);
+	const PESection* bss = findSection(image32, ".bss");
+	REQUIRE(bss != nullptr);
+	CHECK(bss->sectionClass == SectionClass::Data);
+	CHECK(bss->length == 0);
+	CHECK(image32.rangesOfClass(SectionClass::Data).empty());
+	CHECK(image32.rangesOfClass(SectionClass::Code).size() == 1);
+}
+
+
+// The file has the sections at their raw data, the mapped image at their rva, with the whole virtual size.
+IGCS_TEST(PEImage, LaysOutTheSectionsForTheLayout)
+{
+	std::vector<uint8_t> fileBytes = readFixture("Tiny64File.bin");
+	std::vector<uint8_t> mappedBytes = readFixture("Tiny64Mapped.bin");
+	REQUIRE(mappedBytes.size() == 0x1000);
+	PEImage file(fileBytes.data(), fileBytes.size(), false);
+	PEImage mapped(mappedBytes.data(), mappedBytes.size(), true);
+	REQUIRE(file.isValid() && mapped.isValid());
+	CHECK(!file.mappedLayout());
+	CHECK(mapped.mappedLayout());
+	const size_t fileOffsets[] = { 0x200, 0x400, 0x600 };
+	const size_t fileLengths[] = { 0x200, 0x200, 0x100 };
+	const size_t mappedOffsets[] = { 0x400, 0x800, 0xC00 };
+	const size_t mappedLengths[] = { 0x1F0, 0x60, 0x300 };
+	REQUIRE(file.sections().size() == 3 && mapped.sections().size() == 3);
+	for (size_t i = 0; i < 3; i++)
+	{
+		CHECK(file.sections()[i].offset == fileOffsets[i]);
+		CHECK(file.sections()[i].length == fileLengths[i]);
+		CHECK(mapped.sections()[i].offset == mappedOffsets[i]);
+		CHECK(mapped.sections()[i].length == mappedLengths[i]);
+		// the data the two layouts have in common is the same
+		const size_t commonLength = (std::min)(fileLengths[i], mappedLengths[i]);
+		CHECK(memcmp(fileBytes.data() + fileOffsets[i], mappedBytes.data() + mappedOffsets[i], commonLength) == 0);
+	}
+	// a mapped image which is cut off only has the part of a section which is there
+	PEImage cutOff(mappedBytes.data(), 0xD00, true);
+	REQUIRE(cutOff.isValid());
+	CHECK(cutOff.sections()[2].length == 0x100);
+}
+
+
+IGCS_TEST(PEImage, ConvertsRvasToOffsets)
+{
+	std::vector<uint8_t> fileBytes = readFixture("Tiny64File.bin");
+	std::vector<uint8_t> mappedBytes = readFixture("Tiny64Mapped.bin");
+	PEImage file(fileBytes.data(), fileBytes.size(), false);
+	PEImage mapped(mappedBytes.data(), mappedBytes.size(), true);
+	REQUIRE(file.isValid() && mapped.isValid());
+
+	const char text[] = "IGCS test image";
+	const uint8_t dataValue[] = { 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+	const uint8_t code[] = { 0x48, 0x8B, 0x05, 0xF9, 0x03, 0x00, 0x00, 0xC3 };
+	for (const PEImage* image : { &file, &mapped })
+	{
+		CHECK(rvaHasBytes(*image, 0, "MZ", 2));
+		CHECK(rvaHasBytes(*image, 0x400, code, sizeof(code)));
+		// the rip relative operand of the first instruction addresses the string
+		CHECK(rvaHasBytes(*image, 0x400 + 7 + 0x3F9, text, sizeof(text)));
+		CHECK(rvaHasBytes(*image, 0xC00, dataValue, sizeof(dataValue)));
+		size_t offset = 0;
+		CHECK(!image->rvaToOffset(0x300, offset));		// between the headers and .text
+		CHECK(!image->rvaToOffset(0x1000, offset));		// past the image
+		CHECK(!image->rvaToOffset(0xFFFFFFFF, offset));
+	}
+	size_t offset = 0;
+	CHECK(file.rvaToOffset(0x800, offset) && offset == 0x400);
+	CHECK(mapped.rvaToOffset(0x800, offset) && offset == 0x800);
+	// the zero filled part of .data past its raw data is only in the mapped image
+	CHECK(mapped.rvaToOffset(0xE00, offset) && offset == 0xE00 && mappedBytes[offset] == 0);
+	CHECK(!file.rvaToOffset(0xE00, offset));
+	// .rdata's raw data is larger than its virtual size: in the file the part past the virtual size is there as well
+	CHECK(file.rvaToOffset(0x900, offset) && offset == 0x500);
+	CHECK(!mapped.rvaToOffset(0x900, offset));
+
+	for (uint32_t rva = 0; rva < 0x1000; rva++)
+	{
+		for (const PEImage* image : { &file, &mapped })
+		{
+			uint32_t roundTripped = 0;
+			if (image->rvaToOffset(rva, offset))
+			{
+				CHECK(image->offsetToRva(offset, roundTripped) && roundTripped == rva);
+			}
+		}
+	}
+}
+
+
+IGCS_TEST(PEImage, RejectsMalformedHeaders)
+{
+	const std::vector<uint8_t> valid = readFixture("Tiny64File.bin");
+	REQUIRE(parsesAsValid(valid));
+	// each of these makes the headers invalid
+	const std::vector<std::pair<size_t, std::vector<uint8_t>>> corruptions = {
+		{ 0, { 'Z', 'M' } },														// no MZ
+		{ 0x3C, { 0xF0, 0xFF, 0xFF, 0xFF } },										// NT headers past the image
+		{ 0x3C, { 0xF0, 0x06, 0x00, 0x00 } },										// NT headers cut off
+		{ NT_HEADERS_OFFSET, { 'P', 'E', 0, 1 } },									// wrong signature
+		{ FILE_HEADER_OFFSET + 2, { 0xFF, 0xFF } },									// more sections than in the image
+		{ FILE_HEADER_OFFSET + 2, { 0x2A, 0x00 } },									// a section table past the image
+		{ FILE_HEADER_OFFSET + 16, { 0x10, 0x00 } },								// optional header too small
+		{ FILE_HEADER_OFFSET + 16, { 0xF0, 0xFF } },								// optional header past the image
+		{ OPTIONAL_HEADER_OFFSET, { 0x07, 0x01 } },									// ROM image
+	};
+	for (const auto& corruption : corruptions)
+	{
+		std::vector<uint8_t> corrupted = valid;
+		std::copy(corruption.second.begin(), corruption.second.end(), corrupted.begin() + corruption.first);
+		CHECK(!parsesAsValid(corrupted));
+		PEImage image(corrupted.data(), corrupted.size(), false);
+		size_t offset = 0;
+		CHECK(image.sections().empty());
+		CHECK(!image.rvaToOffset(0x800, offset));
+	}
+	PEImage empty(nullptr, 0, false);
+	CHECK(!empty.isValid());
+}
+
+
+// Cut off before the end of the section table the image is rejected, after it the sections are cut off at the end of the image.
+IGCS_TEST(PEImage, DoesntReadPastTheEndOfATruncatedImage)
+{
+	const std::vector<uint8_t> valid = readFixture("Tiny64File.bin");
+	for (size_t length = 0; length <= valid.size(); length++)
+	{
+		const std::vector<uint8_t> truncated(valid.begin(), valid.begin() + length);
+		CHECK(parsesAsValid(truncated) == (length >= TINY64_HEADERS_END));
+	}
+}
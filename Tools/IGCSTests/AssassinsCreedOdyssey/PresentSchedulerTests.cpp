@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "PresentScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace IGCS;
+using namespace std::chrono;
+
+namespace
+{
+	// Stands in for the game's render thread: calls presentOccurred once per frame interval, like the Present hook does.
+	class SimulatedPresentSource
+	{
+	public:
+		SimulatedPresentSource(PresentScheduler& scheduler, int numberOfFrames, microseconds frameInterval) : _numberOfPresents(0), _done(false)
+		{
+			_thread = std::thread([this, &scheduler, numberOfFrames, frameInterval]
+			{
+				for (int i = 0; i < numberOfFrames; i++)
+				{
+					std::this_thread::sleep_for(frameInterval);
+					// counted first, so a tick never sees fewer presents than it was woken for
+					_numberOfPresents++;
+					scheduler.presentOccurred();
+				}
+				_done = true;
+			});
+		}
+
+		~SimulatedPresentSource() { _thread.join(); }
+
+		int numberOfPresents() const { return _numberOfPresents; }
+		bool done() const { return _done; }
+
+	private:
+		std::thread _thread;
+		std::atomic<int> _numberOfPresents;
+		std::atomic_bool _done;
+	};
+}
+
+
+IGCS_TEST(PresentScheduler, FallsBackToTheTimerWithoutPresents)
+{
+	PresentScheduler scheduler;
+	scheduler.setSyncToPresent(true);
+	scheduler.setFallbackInterval(milliseconds(2));
+	steady_clock::time_point start = steady_clock::now();
+	CHECK(!scheduler.waitForNextTick());
+	CHECK(!scheduler.presentsArriving());
+	CHECK(steady_clock::now() - start >= milliseconds(2));
+}
+
+
+IGCS_TEST(PresentScheduler, PresentsSinceTheLastTickGiveOneTick)
+{
+	PresentScheduler scheduler;
+	scheduler.setSyncToPresent(true);
+	scheduler.setFallbackInterval(milliseconds(1));
+	scheduler.setPresentTimeout(milliseconds(5));
+	// a present while the previous update ran wakes the loop immediately, from the timer fallback too
+	scheduler.presentOccurred();
+	scheduler.presentOccurred();
+	scheduler.presentOccurred();
+	CHECK(scheduler.waitForNextTick());
+	CHECK(scheduler.presentsArriving());
+	// all three were handled by that tick
+	CHECK(!scheduler.waitForNextTick());
+	CHECK(!scheduler.presentsArriving());
+	scheduler.presentOccurred();
+	CHECK(scheduler.waitForNextTick());
+}
+
+
+IGCS_TEST(PresentScheduler, IgnoresPresentsWhenNotSynchronized)
+{
+	PresentScheduler scheduler;
+	scheduler.setFallbackInterval(milliseconds(1));
+	scheduler.setPresentTimeout(milliseconds(5));
+	scheduler.presentOccurred();
+	CHECK(!scheduler.waitForNextTick());
+	CHECK(!scheduler.presentsArriving());
+	// the present was seen by the timer tick, so it doesn't give a tick after switching
+	scheduler.setSyncToPresent(true);
+	CHECK(!scheduler.waitForNextTick());
+}
+
+
+// A present which comes in while the loop waits has to wake it, not the timeout: a lost wakeup would make this wait ten seconds.
+IGCS_TEST(PresentScheduler, WakesUpOnAPresent)
+{
+	PresentScheduler scheduler;
+	scheduler.setSyncToPresent(true);
+	scheduler.setFallbackInterval(seconds(10));
+	scheduler.setPresentTimeout(seconds(10));
+	steady_clock::time_point start = steady_clock::now();
+	{
+		SimulatedPresentSource presentSource(scheduler, 1, milliseconds(20));
+		CHECK(scheduler.waitForNextTick());
+	}
+	CHECK(steady_clock::now() - start < seconds(5));
+}
+
+
+// Runs the main loop against a game presenting at 500 fps: it ticks once per present, or less if presents come in during an update, and
+// falls back to the timer after the last one.
+IGCS_TEST(PresentScheduler, TicksOncePerPresent)
+{
+	const int numberOfFrames = 200;
+	PresentScheduler scheduler;
+	scheduler.setSyncToPresent(true);
+	scheduler.setFallbackInterval(milliseconds(1));
+	scheduler.setPresentTimeout(seconds(1));
+	int presentTicks = 0;
+	int timerTicks = 0;
+	{
+		SimulatedPresentSource presentSource(scheduler, numberOfFrames, microseconds(2000));
+		// bounded, so a scheduler which keeps returning true fails instead of hanging
+		while ((!presentSource.done() || scheduler.presentsArriving()) && presentTicks <= numberOfFrames)
+		{
+			if (scheduler.waitForNextTick())
+			{
+				presentTicks++;
+				CHECK(presentTicks <= presentSource.numberOfPresents());
+			}
+			else
+			{
+				timerTicks++;
+			}
+		}
+	}
+	CHECK(presentTicks > 0);
+	CHECK(presentTicks <= numberOfFrames);
+	CHECK(!scheduler.presentsArriving());
+	// only before the first present and after the last one
+	CHECK(timerTicks <= 50);
+}
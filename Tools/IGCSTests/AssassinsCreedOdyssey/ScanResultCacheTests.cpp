@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "ScannerTestData.h"
+#include "ScanResultCache.h"
+#include "PEImage.h"
+#include <cstring>
+#include <filesystem>
+
+using namespace IGCS;
+using namespace IGCS::Tests;
+using namespace IGCS::PEReader;
+
+namespace
+{
+	const uint32_t TEXT_RVA = 0x1000;
+	const uint32_t TEXT_SIZE = 0x2000;
+	const uint32_t DATA_RVA = 0x3000;
+	const uint32_t DATA_SIZE = 0x1000;
+	const uint32_t IMAGE_SIZE = 0x4000;
+
+	void writeUInt16(std::vector<uint8_t>& image, size_t offset, uint16_t value)
+	{
+		image[offset] = static_cast<uint8_t>(value);
+		image[offset + 1] = static_cast<uint8_t>(value >> 8);
+	}
+
+
+	void writeUInt32(std::vector<uint8_t>& image, size_t offset, uint32_t value)
+	{
+		writeUInt16(image, offset, static_cast<uint16_t>(value));
+		writeUInt16(image, offset + 2, static_cast<uint16_t>(value >> 16));
+	}
+
+
+	void writeSectionHeader(std::vector<uint8_t>& image, size_t offset, const char* name, uint32_t rva, uint32_t size, uint32_t characteristics)
+	{
+		memcpy(&image[offset], name, strlen(name));
+		writeUInt32(image, offset + 8, size);
+		writeUInt32(image, offset + 12, rva);
+		writeUInt32(image, offset + 16, size);
+		writeUInt32(image, offset + 20, rva);
+		writeUInt32(image, offset + 36, characteristics);
+	}
+
+
+	// Creates a mapped x64 PE image with a code section (.text) and a writable data section (.data), both filled with code-like bytes.
+	std::vector<uint8_t> createMappedImage(uint32_t timeDateStamp)
+	{
+		std::vector<uint8_t> image = createCodeLikeImage(IMAGE_SIZE, 7);
+		std::fill(image.begin(), image.begin() + TEXT_RVA, static_cast<uint8_t>(0));
+		image[0] = 'M';
+		image[1] = 'Z';
+		const size_t ntHeadersOffset = 0x80;
+		writeUInt32(image, 0x3C, ntHeadersOffset);
+		memcpy(&image[ntHeadersOffset], "PE\0\0", 4);
+		const size_t fileHeader = ntHeadersOffset + 4;
+		writeUInt16(image, fileHeader, 0x8664);
+		writeUInt16(image, fileHeader + 2, 2);
+		writeUInt32(image, fileHeader + 4, timeDateStamp);
+		writeUInt16(image, fileHeader + 16, 240);
+		const size_t optionalHeader = fileHeader + 20;
+		writeUInt16(image, optionalHeader, 0x20B);
+		writeUInt32(image, optionalHeader + 4, TEXT_SIZE);
+		writeUInt32(image, optionalHeader + 16, TEXT_RVA);
+		writeUInt32(image, optionalHeader + 24, 0x40000000);
+		writeUInt32(image, optionalHeader + 56, IMAGE_SIZE);
+		writeUInt32(image, optionalHeader + 60, TEXT_RVA);
+		const size_t sectionTable = optionalHeader + 240;
+		writeSectionHeader(image, sectionTable, ".text", TEXT_RVA, TEXT_SIZE, 0x60000020);
+		writeSectionHeader(image, sectionTable + PEImage::SECTION_HEADER_SIZE, ".data", DATA_RVA, DATA_SIZE, 0xC0000040);
+		return image;
+	}
+
+
+	// The location a scan for the pattern specified would have stored for a match at the rva specified.
+	CachedLocation createLocation(const TestPattern& pattern, int occurrence, uint32_t rva)
+	{
+		return CachedLocation{ 0, occurrence, ScanResultCache::calculatePatternHash(pattern.view()), rva };
+	}
+}
+
+
+IGCS_TEST(ScanResultCache, FingerprintDoesntDependOnTheCode)
+{
+	std::vector<uint8_t> image = createMappedImage(0x5F000000);
+	uint64_t fingerprint = calculateExecutableFingerprint(image.data(), image.size(), true);
+	CHECK(fingerprint != 0);
+	// base relocations patch the code of a loaded image, that mustn't invalidate the cache.
+	std::vector<uint8_t> relocatedImage = image;
+	for (uint32_t rva = TEXT_RVA; rva < TEXT_RVA + TEXT_SIZE; rva += 0x100)
+	{
+		relocatedImage[rva] ^= 0x5A;
+	}
+	CHECK(calculateExecutableFingerprint(relocatedImage.data(), relocatedImage.size(), true) == fingerprint);
+	// another build of the executable
+	std::vector<uint8_t> rebuiltImage = createMappedImage(0x5F000001);
+	CHECK(calculateExecutableFingerprint(rebuiltImage.data(), rebuiltImage.size(), true) != fingerprint);
+	std::vector<uint8_t> notAnImage(IMAGE_SIZE, 0);
+	CHECK(calculateExecutableFingerprint(notAnImage.data(), notAnImage.size(), true) == 0);
+}
+
+
+IGCS_TEST(ScanResultCache, SavesAndLoadsLocations)
+{
+	std::string filename = (std::filesystem::temp_directory_path() / "IGCSTests_ScanResultCache.scancache").string();
+	ScanResultCache cache;
+	cache.clear(0x1234);
+	cache.set("BlockA", CachedLocation{ 1, 3, 0xDEADBEEF, 0x1234 });
+	cache.set("BlockB", CachedLocation{ 0, 1, 0x01020304, 0x2000 });
+	REQUIRE(cache.save(filename));
+
+	ScanResultCache loadedCache;
+	REQUIRE(loadedCache.load(filename, 0x1234));
+	CachedLocation location;
+	REQUIRE(loadedCache.tryGet("BlockA", location));
+	CHECK(location.patternIndex == 1);
+	CHECK(location.occurrence == 3);
+	CHECK(location.patternHash == 0xDEADBEEF);
+	CHECK(location.rva == 0x1234);
+	REQUIRE(loadedCache.tryGet("BlockB", location));
+	CHECK(location.rva == 0x2000);
+	CHECK(!loadedCache.tryGet("BlockC", location));
+	// a cache of another executable isn't used.
+	ScanResultCache otherCache;
+	CHECK(!otherCache.load(filename, 0x5678));
+	CHECK(!otherCache.tryGet("BlockA", location));
+	std::filesystem::remove(filename);
+}
+
+
+IGCS_TEST(ScanResultCache, VerifiesTheCachedLocation)
+{
+	std::vector<uint8_t> imageBytes = createMappedImage(0x5F000000);
+	PEImage image(imageBytes.data(), imageBytes.size(), true);
+	REQUIRE(image.isValid());
+	std::mt19937 random(3);
+	const uint32_t rva = TEXT_RVA + 0x345;
+	TestPattern pattern = createPatternFromImage(imageBytes, rva, 24, random);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, pattern.view(), 2, createLocation(pattern, 2, rva)) == imageBytes.data() + rva);
+	// the code at the location changed
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, pattern.view(), 2, createLocation(pattern, 2, rva + 1)) == nullptr);
+}
+
+
+IGCS_TEST(ScanResultCache, RejectsALocationOfAnotherOccurrence)
+{
+	std::vector<uint8_t> imageBytes = createMappedImage(0x5F000000);
+	PEImage image(imageBytes.data(), imageBytes.size(), true);
+	std::mt19937 random(4);
+	const uint32_t rva = TEXT_RVA + 0x100;
+	TestPattern pattern = createPatternFromImage(imageBytes, rva, 24, random);
+	// the bytes match, but the camera now asks for another occurrence of the pattern.
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, pattern.view(), 2, createLocation(pattern, 1, rva)) == nullptr);
+}
+
+
+IGCS_TEST(ScanResultCache, RejectsALocationOfAnotherPattern)
+{
+	std::vector<uint8_t> imageBytes = createMappedImage(0x5F000000);
+	PEImage image(imageBytes.data(), imageBytes.size(), true);
+	std::mt19937 random(5);
+	const uint32_t rva = TEXT_RVA + 0x200;
+	TestPattern pattern = createPatternFromImage(imageBytes, rva, 24, random);
+	// a shorter pattern matches at the location too, but isn't the pattern the location was found for.
+	TestPattern shorterPattern = pattern;
+	shorterPattern.bytePattern.resize(16);
+	shorterPattern.compareMask.resize(16);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, shorterPattern.view(), 1, createLocation(pattern, 1, rva)) == nullptr);
+	TestPattern wildcardedPattern = pattern;
+	wildcardedPattern.compareMask[10] = 0xFF;
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, wildcardedPattern.view(), 1, createLocation(pattern, 1, rva)) == nullptr);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, pattern.view(), 1, createLocation(pattern, 1, rva)) != nullptr);
+}
+
+
+IGCS_TEST(ScanResultCache, RejectsALocationOutsideTheTargetedSections)
+{
+	std::vector<uint8_t> imageBytes = createMappedImage(0x5F000000);
+	PEImage image(imageBytes.data(), imageBytes.size(), true);
+	std::mt19937 random(6);
+	// matches in the data section, but the block targets code.
+	const uint32_t dataRva = DATA_RVA + 0x40;
+	TestPattern dataPattern = createPatternFromImage(imageBytes, dataRva, 24, random);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, dataPattern.view(), 1, createLocation(dataPattern, 1, dataRva)) == nullptr);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Data, dataPattern.view(), 1, createLocation(dataPattern, 1, dataRva)) != nullptr);
+	// crosses the end of the code section.
+	const uint32_t crossingRva = DATA_RVA - 8;
+	TestPattern crossingPattern = createPatternFromImage(imageBytes, crossingRva, 24, random);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, crossingPattern.view(), 1, createLocation(crossingPattern, 1, crossingRva)) == nullptr);
+	// in the headers
+	TestPattern headerPattern = createPatternFromImage(imageBytes, 0x80, 24, random);
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, headerPattern.view(), 1, createLocation(headerPattern, 1, 0x80)) == nullptr);
+	// beyond the image
+	CHECK(ScanResultCache::verifyLocation(image, SectionClass::Code, dataPattern.view(), 1, createLocation(dataPattern, 1, IMAGE_SIZE + 0x100)) == nullptr);
+}
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "AOBScanner.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Test data for the scanner tests: images with the byte distribution of x64 code and the naive scanner the results are compared with.
+namespace IGCS::Tests
+{
+	// A pattern which owns its bytes.
+	struct TestPattern
+	{
+		std::vector<uint8_t> bytePattern;
+		std::vector<uint8_t> compareMask;
+		int anchorIndex = 0;
+		int secondaryAnchorIndex = 0;
+
+		PatternView view() const
+		{
+			return PatternView{ bytePattern.data(), compareMask.data(), static_cast<int>(bytePattern.size()), anchorIndex, secondaryAnchorIndex };
+		}
+	};
+
+
+	// Creates an image in which the bytes AOBScanner considers common in code are common, so the anchors are picked as they are in a game.
+	inline std::vector<uint8_t> createCodeLikeImage(size_t size, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<uint8_t> toReturn(size);
+		const int numberOfCommonBytes = static_cast<int>(sizeof(AOBScanner::commonBytesInCode));
+		for (size_t i = 0; i < size; i++)
+		{
+			uint32_t value = random();
+			toReturn[i] = (value & 0x300) != 0 ? AOBScanner::commonBytesInCode[(value >> 12) % numberOfCommonBytes] : static_cast<uint8_t>(value);
+		}
+		return toReturn;
+	}
+
+
+	// Creates a pattern of patternSize bytes from the image at offset, with random wildcards and nibble wildcards.
+	inline TestPattern createPatternFromImage(const std::vector<uint8_t>& image, size_t offset, int patternSize, std::mt19937& random)
+	{
+		TestPattern toReturn;
+		for (int i = 0; i < patternSize; i++)
+		{
+			uint8_t mask = 0x00;
+			switch (random() % 10)
+			{
+			case 0:
+				mask = 0xFF;
+				break;
+			case 1:
+				mask = 0x0F;
+				break;
+			case 2:
+				mask = 0xF0;
+				break;
+			}
+			// the scanner doesn't require the masked bits to be 0 in the pattern
+			toReturn.bytePattern.push_back(static_cast<uint8_t>(image[offset + i] ^ (mask & random())));
+			toReturn.compareMask.push_back(mask);
+		}
+		AOBScanner::determineAnchors(toReturn.bytePattern.data(), toReturn.compareMask.data(), patternSize, toReturn.anchorIndex, toReturn.secondaryAnchorIndex);
+		return toReturn;
+	}
+
+
+	// The reference the scanners are tested against: compares the pattern at every position.
+	inline std::vector<const uint8_t*> findAllNaive(const uint8_t* rangeStart, size_t rangeLength, const PatternView& pattern)
+	{
+		std::vector<const uint8_t*> toReturn;
+		for (size_t start = 0; start + pattern.patternSize <= rangeLength; start++)
+		{
+			bool matches = true;
+			for (int i = 0; i < pattern.patternSize && matches; i++)
+			{
+				matches = ((rangeStart[start + i] ^ pattern.bytePattern[i]) & ~pattern.compareMask[i]) == 0;
+			}
+			if (matches)
+			{
+				toReturn.push_back(rangeStart + start);
+			}
+		}
+		return toReturn;
+	}
+}
@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "ScannerTestData.h"
+#include "AOBScanner.h"
+#include "MultiPatternScanner.h"
+#include "ScanPattern.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Compares the scanner with the scanner it replaced (Utils::findAOBPattern before AOBScanner was added) on an image with the byte
+// distribution of x64 code, for the patterns of the AC Odyssey camera. With 'multi' it compares scanning for the patterns one after the
+// other with AOBScanner against scanning for all of them in one pass with MultiPatternScanner, which is how the camera scans.
+// Usage: AOBScannerBenchmark [multi] [image size in MB, default 256]
+
+using namespace IGCS;
+using namespace IGCS::Tests;
+
+namespace
+{
+	// The previous scanner: the pattern as bytes with an 'x'/'?' mask string, looked for by testing 4 positions per 32 bit read for the
+	// first byte of the pattern and comparing the whole pattern byte by byte on a hit.
+	struct PreviousPattern
+	{
+		std::vector<uint8_t> bytePattern;
+		std::string patternMask;
+	};
+
+	PreviousPattern createPreviousPattern(const PatternView& pattern)
+	{
+		PreviousPattern toReturn;
+		for (int i = 0; i < pattern.patternSize; i++)
+		{
+			toReturn.bytePattern.push_back(pattern.bytePattern[i]);
+			toReturn.patternMask.push_back(pattern.compareMask[i] == 0 ? 'x' : '?');
+		}
+		return toReturn;
+	}
+
+	bool dataCompare(const uint8_t* image, const uint8_t* bytePattern, const char* patternMask)
+	{
+		for (; *patternMask; ++patternMask, ++image, ++bytePattern)
+		{
+			if (*patternMask == 'x' && *image != *bytePattern)
+			{
+				return false;
+			}
+		}
+		return (*patternMask) == 0;
+	}
+
+	const uint8_t* previousFindPattern(const uint8_t* imageAddress, size_t imageSize, const PreviousPattern& pattern)
+	{
+		uint8_t firstByte = pattern.bytePattern[0];
+		const uint8_t* end = imageAddress + imageSize - pattern.bytePattern.size();
+		for (const uint8_t* current = imageAddress; current < end; current += 4)
+		{
+			uint32_t x;
+			memcpy(&x, current, sizeof(x));
+			for (int i = 0; i < 4; i++)
+			{
+				if (((x >> (i * 8)) & 0xFF) == firstByte && dataCompare(current + i, pattern.bytePattern.data(), pattern.patternMask.c_str()))
+				{
+					return current + i;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+
+	double secondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+
+	// Plants the patterns near the end of the image, so the scanners go through almost all of it.
+	void plantPatterns(std::vector<uint8_t>& image, std::vector<ScanPattern>& patterns)
+	{
+		for (size_t i = 0; i < patterns.size(); i++)
+		{
+			PatternView view = patterns[i].view();
+			size_t location = image.size() - image.size() / 100 - i * 64;
+			memcpy(image.data() + location, view.bytePattern, view.patternSize);
+		}
+	}
+
+
+	int compareWithPreviousScanner(const std::vector<uint8_t>& image, std::vector<ScanPattern>& patterns)
+	{
+		printf("%-8s %12s %12s %8s\n", "pattern", "previous ms", "current ms", "speedup");
+		double previousTotal = 0.0;
+		double currentTotal = 0.0;
+		for (size_t i = 0; i < patterns.size(); i++)
+		{
+			PatternView view = patterns[i].view();
+			PreviousPattern previousPattern = createPreviousPattern(view);
+
+			auto start = std::chrono::steady_clock::now();
+			const uint8_t* previousResult = previousFindPattern(image.data(), image.size(), previousPattern);
+			double previousSeconds = secondsSince(start);
+			start = std::chrono::steady_clock::now();
+			const uint8_t* currentResult = AOBScanner::findPattern(image.data(), image.size(), view, 1);
+			double currentSeconds = secondsSince(start);
+			if (previousResult != currentResult)
+			{
+				printf("Pattern %zu: the scanners found different locations.\n", i);
+				return 1;
+			}
+			previousTotal += previousSeconds;
+			currentTotal += currentSeconds;
+			printf("%-8zu %12.2f %12.2f %7.1fx\n", i, previousSeconds * 1000.0, currentSeconds * 1000.0, previousSeconds / currentSeconds);
+		}
+		printf("%-8s %12.2f %12.2f %7.1fx\n", "total", previousTotal * 1000.0, currentTotal * 1000.0, previousTotal / currentTotal);
+		return 0;
+	}
+
+
+	// A scan per pattern with AOBScanner against one pass for all patterns with MultiPatternScanner, serial and with a thread per core.
+	// The multi pattern times include building its tables.
+	int compareWithMultiPatternScanner(const std::vector<uint8_t>& image, std::vector<ScanPattern>& patterns)
+	{
+		std::vector<const uint8_t*> sequentialResults;
+		auto start = std::chrono::steady_clock::now();
+		for (ScanPattern& pattern : patterns)
+		{
+			sequentialResults.push_back(AOBScanner::findPattern(image.data(), image.size(), pattern.view(), 1));
+		}
+		double sequentialSeconds = secondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		MultiPatternScanner scanner;
+		for (ScanPattern& pattern : patterns)
+		{
+			scanner.addPattern(pattern.view(), 1);
+		}
+		scanner.scan(image.data(), image.size());
+		double multiSeconds = secondsSince(start);
+
+		const int numberOfThreads = (std::max)(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		start = std::chrono::steady_clock::now();
+		MultiPatternScanner parallelScanner;
+		for (ScanPattern& pattern : patterns)
+		{
+			parallelScanner.addPattern(pattern.view(), 1);
+		}
+		parallelScanner.scanParallel(image.data(), image.size(), numberOfThreads);
+		double parallelSeconds = secondsSince(start);
+
+		for (size_t i = 0; i < patterns.size(); i++)
+		{
+			const int patternId = static_cast<int>(i);
+			if (scanner.location(patternId) != sequentialResults[i] || parallelScanner.location(patternId) != sequentialResults[i])
+			{
+				printf("Pattern %zu: the scanners found different locations.\n", i);
+				return 1;
+			}
+		}
+		printf("%-30s %12s %8s\n", "scan", "ms", "speedup");
+		printf("%-30s %12.2f %7.1fx\n", "AOBScanner, pattern by pattern", sequentialSeconds * 1000.0, 1.0);
+		printf("%-30s %12.2f %7.1fx\n", "MultiPatternScanner", multiSeconds * 1000.0, sequentialSeconds / multiSeconds);
+		const std::string parallelLabel = "MultiPatternScanner, " + std::to_string(numberOfThreads) + " threads";
+		printf("%-30s %12.2f %7.1fx\n", parallelLabel.c_str(), parallelSeconds * 1000.0, sequentialSeconds / parallelSeconds);
+		return 0;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	int argumentIndex = 1;
+	const bool multiPatternMode = argc > argumentIndex && strcmp(argv[argumentIndex], "multi") == 0;
+	if (multiPatternMode)
+	{
+		argumentIndex++;
+	}
+	size_t imageSizeInMB = argc > argumentIndex ? strtoul(argv[argumentIndex], nullptr, 10) : 256;
+	if (imageSizeInMB == 0)
+	{
+		printf("Usage: AOBScannerBenchmark [multi] [image size in MB]\n");
+		return 1;
+	}
+	const char* patternTexts[] =
+	{
+		"66 0F 7F 86 90 00 00 00 66 0F 7F 0F",
+		"0F 29 02 0F 28 71 20 41 0F 28 10 41 0F 28 38 0F 28 E2",
+		"41 0F 29 38 F3 0F 10 41 30 F3 41 0F 58 01 0F 28 3C 24 F3 41 0F 11 01",
+		"48 89 54 24 28 48 8B 57 18 83 E1 10 4C 31 C1 41 0F 29 7B A8",
+		"0F 2F D1 F3 0F 11 12 72 ?? F3 0F 5C D1",
+		"48 8B 70 60 48 8B 82 48 02 00 00 48 89 B4 24 B8 00 00 00",
+		"53 48 83 EC 20 48 89 CB 48 8D 0D ?? ?? ?? ?? E8 ?? ?? ?? ?? FF 83 6C 18 00 00 83 BB 6C 18 00 00 01",
+		"48 89 E0 48 89 58 08 55 56 57 41 54 41 55 41 56 41 57 48 ?? ?? ?? B0",
+		"F3 41 0F 5D D0 0F 28 C1 0F C6 D2 00 41 0F 59 D2",
+	};
+	std::vector<ScanPattern> patterns;
+	patterns.reserve(sizeof(patternTexts) / sizeof(patternTexts[0]));
+	for (const char* patternText : patternTexts)
+	{
+		patterns.emplace_back(patternText, 1);
+	}
+	std::vector<uint8_t> image = createCodeLikeImage(imageSizeInMB * 1024 * 1024, 42);
+	plantPatterns(image, patterns);
+	printf("Image of %zu MB, %zu patterns found in the last 1%% of the image:\n", imageSizeInMB, patterns.size());
+	return multiPatternMode ? compareWithMultiPatternScanner(image, patterns) : compareWithPreviousScanner(image, patterns);
+}
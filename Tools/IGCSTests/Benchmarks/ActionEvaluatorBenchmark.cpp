@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "BenchmarkSupport.h"
+#include "ActionData.h"
+#include "ActionEvaluator.h"
+#include "Defaults.h"
+#include "Utils.h"
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Compares evaluating the camera's actions every tick the way Input::isActionActivated did, with a map lookup per action and
+// ActionData::isActive asking for the state of the action's key and the modifier keys, against ActionEvaluator, which evaluates all
+// actions in one pass over one keyboard snapshot. The key states come from a fake key source which counts the queries: in the camera each
+// query is a GetKeyState call, the snapshot is a single GetKeyboardState call. Usage: ActionEvaluatorBenchmark [ticks in millions, default 5]
+
+using namespace IGCS;
+using namespace IGCS::Benchmarks;
+
+namespace
+{
+	const int KEY_LSHIFT = 0xA0;
+	const int KEY_RSHIFT = 0xA1;
+	const int KEY_LCONTROL = 0xA2;
+	const int KEY_RCONTROL = 0xA3;
+	const int KEY_LMENU = 0xA4;
+	const int KEY_RMENU = 0xA5;
+	// Number of keyboard states the ticks cycle through, a power of 2 so a tick's state is picked with a mask.
+	const int NUMBER_OF_KEYBOARDS = 256;
+
+	// The fake key source: the key states of the current tick, in the format of GetKeyboardState.
+	const uint8_t* currentKeyStates = nullptr;
+	uint64_t numberOfKeyQueries = 0;
+}
+
+
+namespace IGCS::Utils
+{
+	bool keyDown(int virtualKeyCode)
+	{
+		numberOfKeyQueries++;
+		return (currentKeyStates[virtualKeyCode & 0xFF] & 0x80) != 0;
+	}
+
+	bool altPressed() { return keyDown(KEY_LMENU) || keyDown(KEY_RMENU); }
+	bool ctrlPressed() { return keyDown(KEY_LCONTROL) || keyDown(KEY_RCONTROL); }
+	bool shiftPressed() { return keyDown(KEY_LSHIFT) || keyDown(KEY_RSHIFT); }
+}
+
+
+namespace
+{
+	struct Binding
+	{
+		ActionType type;
+		const char* name;
+		int keyCode;
+	};
+
+	// The default key bindings of the camera.
+	const Binding DEFAULT_BINDINGS[] =
+	{
+		{ ActionType::BlockInput, "BlockInput", IGCS_KEY_BLOCK_INPUT },
+		{ ActionType::CameraEnable, "CameraEnable", IGCS_KEY_CAMERA_ENABLE },
+		{ ActionType::CameraLock, "CameraLock", IGCS_KEY_CAMERA_LOCK },
+		{ ActionType::FovDecrease, "FovDecrease", IGCS_KEY_FOV_DECREASE },
+		{ ActionType::FovIncrease, "FovIncrease", IGCS_KEY_FOV_INCREASE },
+		{ ActionType::FovReset, "FovReset", IGCS_KEY_FOV_RESET },
+		{ ActionType::MoveBackward, "MoveBackward", IGCS_KEY_MOVE_BACKWARD },
+		{ ActionType::MoveDown, "MoveDown", IGCS_KEY_MOVE_DOWN },
+		{ ActionType::MoveForward, "MoveForward", IGCS_KEY_MOVE_FORWARD },
+		{ ActionType::MoveLeft, "MoveLeft", IGCS_KEY_MOVE_LEFT },
+		{ ActionType::MoveRight, "MoveRight", IGCS_KEY_MOVE_RIGHT },
+		{ ActionType::MoveUp, "MoveUp", IGCS_KEY_MOVE_UP },
+		{ ActionType::RotateDown, "RotateDown", IGCS_KEY_ROTATE_DOWN },
+		{ ActionType::RotateLeft, "RotateLeft", IGCS_KEY_ROTATE_LEFT },
+		{ ActionType::RotateRight, "RotateRight", IGCS_KEY_ROTATE_RIGHT },
+		{ ActionType::RotateUp, "RotateUp", IGCS_KEY_ROTATE_UP },
+		{ ActionType::TiltLeft, "TiltLeft", IGCS_KEY_TILT_LEFT },
+		{ ActionType::TiltRight, "TiltRight", IGCS_KEY_TILT_RIGHT },
+		{ ActionType::ResetTilt, "ResetTilt", IGCS_KEY_RESET_TILT },
+		{ ActionType::HudToggle, "HudToggle", IGCS_KEY_HUD_TOGGLE },
+		{ ActionType::Timestop, "Timestop", IGCS_KEY_TIMESTOP },
+		{ ActionType::SkipFrames, "SkipFrames", IGCS_KEY_SKIP_FRAMES },
+		{ ActionType::TimeOfDayEarlier, "TimeOfDayEarlier", IGCS_KEY_TOD_EARLIER },
+		{ ActionType::TimeOfDayLater, "TimeOfDayLater", IGCS_KEY_TOD_LATER },
+	};
+
+
+	// Keyboards with up to 3 bound keys down, and a modifier key down in a quarter of them.
+	std::vector<std::vector<uint8_t>> createKeyboards()
+	{
+		std::mt19937 random(20);
+		std::uniform_int_distribution<int> binding(0, static_cast<int>(sizeof(DEFAULT_BINDINGS) / sizeof(DEFAULT_BINDINGS[0])) - 1);
+		std::uniform_int_distribution<int> zeroToThree(0, 3);
+		const int modifierKeys[] = { KEY_LSHIFT, KEY_RSHIFT, KEY_LCONTROL, KEY_RCONTROL, KEY_LMENU, KEY_RMENU };
+		std::uniform_int_distribution<int> modifier(0, 5);
+		std::vector<std::vector<uint8_t>> toReturn;
+		for (int i = 0; i < NUMBER_OF_KEYBOARDS; i++)
+		{
+			std::vector<uint8_t> keyStates(256, 0);
+			for (int key = zeroToThree(random); key > 0; key--)
+			{
+				keyStates[DEFAULT_BINDINGS[binding(random)].keyCode] = 0x80;
+			}
+			if (zeroToThree(random) == 0)
+			{
+				keyStates[modifierKeys[modifier(random)]] = 0x80;
+			}
+			toReturn.push_back(keyStates);
+		}
+		return toReturn;
+	}
+
+
+	// Input::isActionActivated before ActionEvaluator: a lookup of the action's binding and the key states of the binding.
+	uint32_t previousActiveActions(std::map<ActionType, ActionData*>& keyBindingPerActionType)
+	{
+		uint32_t toReturn = 0;
+		for (int type = 0; type < static_cast<int>(ActionType::Amount); type++)
+		{
+			ActionType actionType = static_cast<ActionType>(type);
+			if (keyBindingPerActionType.count(actionType) != 0 && keyBindingPerActionType.at(actionType)->isActive(false))
+			{
+				toReturn |= 1u << type;
+			}
+		}
+		return toReturn;
+	}
+
+
+	uint32_t currentActiveActions(ActionEvaluator& evaluator, KeyboardSnapshot& snapshot, const uint8_t* keyStates)
+	{
+		snapshot.setFromKeyStates(keyStates);
+		evaluator.evaluate(snapshot);
+		uint32_t toReturn = 0;
+		for (int type = 0; type < static_cast<int>(ActionType::Amount); type++)
+		{
+			if (evaluator.isActive(static_cast<ActionType>(type), false))
+			{
+				toReturn |= 1u << type;
+			}
+		}
+		return toReturn;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	int ticksInMillions = argc > 1 ? atoi(argv[1]) : 5;
+	if (ticksInMillions <= 0)
+	{
+		printf("Usage: ActionEvaluatorBenchmark [ticks in millions]\n");
+		return 1;
+	}
+	const int ticks = ticksInMillions * 1000000;
+	std::vector<std::unique_ptr<ActionData>> actions;
+	std::map<ActionType, ActionData*> keyBindingPerActionType;
+	ActionEvaluator evaluator;
+	for (const Binding& binding : DEFAULT_BINDINGS)
+	{
+		actions.emplace_back(new ActionData(binding.name, binding.keyCode, false, false, false));
+		keyBindingPerActionType[binding.type] = actions.back().get();
+		evaluator.compile(binding.type, actions.back().get());
+	}
+	const std::vector<std::vector<uint8_t>> keyboards = createKeyboards();
+	KeyboardSnapshot snapshot;
+
+	// both have to find the same actions active
+	for (const std::vector<uint8_t>& keyStates : keyboards)
+	{
+		currentKeyStates = keyStates.data();
+		if (previousActiveActions(keyBindingPerActionType) != currentActiveActions(evaluator, snapshot, keyStates.data()))
+		{
+			printf("The evaluations found different actions active.\n");
+			return 1;
+		}
+	}
+
+	printf("%d million ticks, %zu actions\n", ticksInMillions, actions.size());
+	printHeader();
+	numberOfKeyQueries = 0;
+	double previous = nanosecondsPerCall(ticks, [&](int i)
+	{
+		currentKeyStates = keyboards[i & (NUMBER_OF_KEYBOARDS - 1)].data();
+		keep(static_cast<float>(previousActiveActions(keyBindingPerActionType)));
+	});
+	const double previousQueriesPerTick = static_cast<double>(numberOfKeyQueries) / static_cast<double>(ticks);
+	printResult("map lookup and ActionData::isActive per action", previous, previous);
+	numberOfKeyQueries = 0;
+	double current = nanosecondsPerCall(ticks, [&](int i)
+	{
+		keep(static_cast<float>(currentActiveActions(evaluator, snapshot, keyboards[i & (NUMBER_OF_KEYBOARDS - 1)].data())));
+	});
+	printResult("ActionEvaluator on a keyboard snapshot", current, previous);
+	printf("Key state queries per tick: %.1f with a lookup per action, none with ActionEvaluator, which uses one snapshot.\n", previousQueriesPerTick);
+	return 0;
+}
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <chrono>
+#include <cstdio>
+
+// Timing and reporting shared by the microbenchmarks.
+namespace IGCS::Benchmarks
+{
+	// Results are stored here, so the compiler can't optimize away the code which calculates them.
+	inline volatile float resultSink = 0.0f;
+
+	inline void keep(float value)
+	{
+		resultSink = value;
+	}
+
+
+	inline double secondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+
+	// Calls function(i) for i in [0, iterations) and returns the average time of a call in nanoseconds.
+	template<typename Function>
+	double nanosecondsPerCall(int iterations, Function function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			function(i);
+		}
+		return secondsSince(start) * 1e9 / static_cast<double>(iterations);
+	}
+
+
+	inline void printHeader()
+	{
+		printf("%-56s %12s %8s\n", "benchmark", "ns per call", "speedup");
+	}
+
+
+	// Prints the time of a call, and how much faster it is than the baseline's time.
+	inline void printResult(const char* name, double nanoseconds, double baselineNanoseconds)
+	{
+		printf("%-56s %12.2f %7.1fx\n", name, nanoseconds, baselineNanoseconds / nanoseconds);
+	}
+}
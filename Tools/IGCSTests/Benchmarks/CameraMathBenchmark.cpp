@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "BenchmarkSupport.h"
+#include "CameraMath.h"
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Compares the camera math with the code it replaced: rebuilding the look quaternion from the Euler angles every frame the way
+// Camera::calculateLookQuaternion did with DirectXMath, normalizing with a square root and a division, and clamping angles with loops.
+// Also times the quaternion multiply against its scalar version and the matrix operations.
+// Usage: CameraMathBenchmark [iterations in millions, default 20]
+
+using namespace IGCS;
+using namespace IGCS::Benchmarks;
+
+namespace
+{
+	// Cyberpunk's axes: x right, y into the screen, z up.
+	typedef Math::AxisConvention<0, 1, 2> CameraAxes;
+
+	// Number of precalculated inputs, a power of 2 so an iteration's input is picked with a mask.
+	const int NUMBER_OF_INPUTS = 1024;
+	const int INPUT_MASK = NUMBER_OF_INPUTS - 1;
+
+	struct Inputs
+	{
+		std::vector<float> deltas;			// per frame angle changes, small like those of a moving camera
+		std::vector<float> angles;			// angles of up to a few turns, as they are before clamping
+		std::vector<Math::Quat> rotations;	// unit quaternions
+		std::vector<Math::Quat> driftedRotations;	// unit quaternions with the length error of a frame's integration
+		std::vector<Math::Vec3> points;
+	};
+
+
+	Inputs createInputs()
+	{
+		Inputs toReturn;
+		std::mt19937 random(14);
+		std::uniform_real_distribution<float> delta(-0.02f, 0.02f);
+		std::uniform_real_distribution<float> angle(-4.0f * Math::PI, 4.0f * Math::PI);
+		std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+		std::uniform_real_distribution<float> drift(0.9999f, 1.0001f);
+		for (int i = 0; i < NUMBER_OF_INPUTS; i++)
+		{
+			toReturn.deltas.push_back(delta(random));
+			toReturn.angles.push_back(angle(random));
+			Math::CameraOrientation<CameraAxes> orientation;
+			orientation.setFromEuler(angle(random), angle(random), angle(random));
+			Math::Quat rotation = orientation.orientation();
+			toReturn.rotations.push_back(rotation);
+			float factor = drift(random);
+			toReturn.driftedRotations.push_back({ rotation.x * factor, rotation.y * factor, rotation.z * factor, rotation.w * factor });
+			toReturn.points.push_back({ coordinate(random), coordinate(random), coordinate(random) });
+		}
+		return toReturn;
+	}
+
+
+	Math::Quat scalarMultiply(const Math::Quat& a, const Math::Quat& b)
+	{
+		return { a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+				 a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+				 a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+				 a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z };
+	}
+
+
+	Math::Quat normalizeWithSquareRoot(const Math::Quat& q)
+	{
+		float length = std::sqrt(Math::lengthSquared(q));
+		return { q.x / length, q.y / length, q.z / length, q.w / length };
+	}
+
+
+	// Camera::calculateLookQuaternion before CameraOrientation: three axis quaternions from the summed angles, multiplied and normalized.
+	Math::Quat previousLookQuaternion(float pitch, float yaw, float roll)
+	{
+		Math::Quat xQ = { std::sin(pitch * 0.5f), 0.0f, 0.0f, std::cos(pitch * 0.5f) };
+		Math::Quat yQ = { 0.0f, std::sin(roll * 0.5f), 0.0f, std::cos(roll * 0.5f) };
+		Math::Quat zQ = { 0.0f, 0.0f, std::sin(yaw * 0.5f), std::cos(yaw * 0.5f) };
+		return normalizeWithSquareRoot(scalarMultiply(scalarMultiply(zQ, xQ), yQ));
+	}
+
+
+	// Camera::clampAngle before wrapAngle.
+	float previousClampAngle(float angle)
+	{
+		while (angle > Math::PI)
+		{
+			angle -= Math::TWO_PI;
+		}
+		while (angle < -Math::PI)
+		{
+			angle += Math::TWO_PI;
+		}
+		return angle;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	int iterationsInMillions = argc > 1 ? atoi(argv[1]) : 20;
+	if (iterationsInMillions <= 0)
+	{
+		printf("Usage: CameraMathBenchmark [iterations in millions]\n");
+		return 1;
+	}
+	const int iterations = iterationsInMillions * 1000000;
+	const Inputs inputs = createInputs();
+	printf("%d million iterations, %s\n", iterationsInMillions,
+#if defined(IGCS_MATH_SSE)
+		   "SSE2");
+#elif defined(IGCS_MATH_NEON)
+		   "NEON");
+#else
+		   "scalar");
+#endif
+	printHeader();
+
+	// a frame of a moving camera: the new orientation from this frame's deltas
+	float pitch = 0.0f, yaw = 0.0f, roll = 0.0f;
+	double previous = nanosecondsPerCall(iterations, [&](int i)
+	{
+		pitch = previousClampAngle(pitch + inputs.deltas[i & INPUT_MASK]);
+		yaw = previousClampAngle(yaw + inputs.deltas[(i + 1) & INPUT_MASK]);
+		roll = previousClampAngle(roll + inputs.deltas[(i + 2) & INPUT_MASK]);
+		keep(previousLookQuaternion(pitch, yaw, roll).w);
+	});
+	printResult("look quaternion from the summed angles (previous)", previous, previous);
+	Math::CameraOrientation<CameraAxes> orientation;
+	double current = nanosecondsPerCall(iterations, [&](int i)
+	{
+		orientation.integrate(inputs.deltas[i & INPUT_MASK], inputs.deltas[(i + 1) & INPUT_MASK], inputs.deltas[(i + 2) & INPUT_MASK]);
+		keep(orientation.orientation().w);
+	});
+	printResult("CameraOrientation::integrate", current, previous);
+
+	previous = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(scalarMultiply(inputs.rotations[i & INPUT_MASK], inputs.rotations[(i * 7 + 3) & INPUT_MASK]).x);
+	});
+	printResult("quaternion multiply, scalar", previous, previous);
+	current = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(Math::multiply(inputs.rotations[i & INPUT_MASK], inputs.rotations[(i * 7 + 3) & INPUT_MASK]).x);
+	});
+	printResult("Math::multiply", current, previous);
+
+	previous = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(normalizeWithSquareRoot(inputs.driftedRotations[i & INPUT_MASK]).x);
+	});
+	printResult("normalize with a square root and divisions (previous)", previous, previous);
+	current = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(Math::renormalize(inputs.driftedRotations[i & INPUT_MASK]).x);
+	});
+	printResult("Math::renormalize", current, previous);
+
+	previous = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(previousClampAngle(inputs.angles[i & INPUT_MASK]));
+	});
+	printResult("clamp an angle with loops (previous)", previous, previous);
+	current = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(Math::wrapAngle(inputs.angles[i & INPUT_MASK]));
+	});
+	printResult("Math::wrapAngle", current, previous);
+
+	current = nanosecondsPerCall(iterations, [&](int i)
+	{
+		Math::Mat4 matrix = Math::matrixFromQuatAndPosition(inputs.rotations[i & INPUT_MASK], inputs.points[(i + 1) & INPUT_MASK]);
+		keep(Math::transformPoint(matrix, inputs.points[i & INPUT_MASK]).x);
+	});
+	printResult("Math::matrixFromQuatAndPosition + transformPoint", current, current);
+	current = nanosecondsPerCall(iterations, [&](int i)
+	{
+		keep(Math::rotate(inputs.points[i & INPUT_MASK], inputs.rotations[(i + 1) & INPUT_MASK]).x);
+	});
+	printResult("Math::rotate", current, current);
+	return 0;
+}
@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "BenchmarkSupport.h"
+#include "MessageClassifier.h"
+#include "SpscRing.h"
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Measures the message hook's fast path: classifying the messages a game pulls through the hooked message functions, against taking a
+// lock for every message and classifying it with a switch as the hook did before, and the throughput of the SpscRing the hook pushes key
+// presses into, against a queue with a lock. Usage: MessagePumpBenchmark [messages in millions, default 20]
+
+using namespace IGCS;
+using namespace IGCS::Benchmarks;
+using namespace IGCS::Input;
+
+namespace
+{
+	// Number of message ids the messages cycle through, a power of 2 so a message's id is picked with a mask.
+	const int NUMBER_OF_MESSAGES = 4096;
+	const size_t RING_CAPACITY = 256;
+
+	// Message ids with about 1 in 10 an input message, like a game which spins PeekMessage while the user moves the mouse.
+	std::vector<unsigned int> createMessageIds()
+	{
+		std::mt19937 random(22);
+		const unsigned int otherMessages[] = { 0x000F, 0x0113, 0x0118, 0x0020, 0x0400, 0x0401, 0xC0F1, 0x0086, 0x001C, 0x0102 };		// WM_PAINT, WM_TIMER, ..., WM_CHAR
+		const unsigned int inputMessages[] = { MESSAGE_ID_INPUT, MESSAGE_ID_KEYDOWN, MESSAGE_ID_KEYUP, 0x0200, 0x020A, 0x0201, 0x0202 };
+		std::uniform_int_distribution<int> otherIndex(0, static_cast<int>(sizeof(otherMessages) / sizeof(otherMessages[0])) - 1);
+		std::uniform_int_distribution<int> inputIndex(0, static_cast<int>(sizeof(inputMessages) / sizeof(inputMessages[0])) - 1);
+		std::uniform_int_distribution<int> oneInTen(0, 9);
+		std::vector<unsigned int> toReturn;
+		for (int i = 0; i < NUMBER_OF_MESSAGES; i++)
+		{
+			toReturn.push_back(oneInTen(random) == 0 ? inputMessages[inputIndex(random)] : otherMessages[otherIndex(random)]);
+		}
+		return toReturn;
+	}
+
+
+	// The classification the message hook did before MessageClassifier, inside its critical section.
+	MessageKind previousClassifyMessage(unsigned int message)
+	{
+		switch (message)
+		{
+			case MESSAGE_ID_INPUT:
+				return MessageKind::RawInput;
+			case MESSAGE_ID_KEYDOWN:
+				return MessageKind::KeyDown;
+			case MESSAGE_ID_KEYUP:
+				return MessageKind::KeyUp;
+			case MESSAGE_ID_SYSKEYDOWN:
+				return MessageKind::SysKeyDown;
+			case MESSAGE_ID_SYSKEYUP:
+				return MessageKind::SysKeyUp;
+			default:
+				for (unsigned int mouseMessage : MOUSE_MESSAGE_IDS)
+				{
+					if (mouseMessage == message)
+					{
+						return MessageKind::Mouse;
+					}
+				}
+				return MessageKind::Irrelevant;
+		}
+	}
+
+
+	// A producer thread pushes the values 0..numberOfItems-1, the calling thread pops them. Returns the time per item in nanoseconds, or -1
+	// if the items didn't arrive in order.
+	template<typename Push, typename Pop>
+	double nanosecondsPerTransfer(int numberOfItems, Push push, Pop pop)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::thread producer([&]()
+		{
+			for (int i = 0; i < numberOfItems; i++)
+			{
+				while (!push(static_cast<uint8_t>(i)))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+		bool inOrder = true;
+		for (int i = 0; i < numberOfItems; i++)
+		{
+			uint8_t item = 0;
+			while (!pop(item))
+			{
+				std::this_thread::yield();
+			}
+			inOrder &= (item == static_cast<uint8_t>(i));
+		}
+		producer.join();
+		return inOrder ? secondsSince(start) * 1e9 / static_cast<double>(numberOfItems) : -1.0;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	int messagesInMillions = argc > 1 ? atoi(argv[1]) : 20;
+	if (messagesInMillions <= 0)
+	{
+		printf("Usage: MessagePumpBenchmark [messages in millions]\n");
+		return 1;
+	}
+	const int messages = messagesInMillions * 1000000;
+	const std::vector<unsigned int> messageIds = createMessageIds();
+	for (unsigned int message : messageIds)
+	{
+		if (previousClassifyMessage(message) != classifyMessage(message))
+		{
+			printf("The classifiers classified message 0x%04X differently.\n", message);
+			return 1;
+		}
+	}
+	printf("%d million messages, 1 in 10 is input\n", messagesInMillions);
+	printHeader();
+
+	std::mutex messageMutex;
+	double previous = nanosecondsPerCall(messages, [&](int i)
+	{
+		std::lock_guard<std::mutex> lock(messageMutex);
+		keep(static_cast<float>(previousClassifyMessage(messageIds[i & (NUMBER_OF_MESSAGES - 1)])));
+	});
+	printResult("lock and switch per message (previous)", previous, previous);
+	double current = nanosecondsPerCall(messages, [&](int i)
+	{
+		keep(static_cast<float>(classifyMessage(messageIds[i & (NUMBER_OF_MESSAGES - 1)])));
+	});
+	printResult("classifyMessage", current, previous);
+
+	// a key press pushed and popped by the same thread, without contention
+	SpscRing<uint8_t, RING_CAPACITY> ring;
+	std::deque<uint8_t> queue;
+	std::mutex queueMutex;
+	previous = nanosecondsPerCall(messages, [&](int i)
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			queue.push_back(static_cast<uint8_t>(i));
+		}
+		std::lock_guard<std::mutex> lock(queueMutex);
+		keep(static_cast<float>(queue.front()));
+		queue.pop_front();
+	});
+	printResult("push and pop, deque with a lock, one thread", previous, previous);
+	current = nanosecondsPerCall(messages, [&](int i)
+	{
+		uint8_t item = 0;
+		ring.push(static_cast<uint8_t>(i));
+		ring.pop(item);
+		keep(static_cast<float>(item));
+	});
+	printResult("push and pop, SpscRing, one thread", current, previous);
+
+	// the message thread pushes, the camera thread pops
+	const int items = messages / 4;
+	previous = nanosecondsPerTransfer(items, [&](uint8_t item)
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (queue.size() >= RING_CAPACITY)
+		{
+			return false;
+		}
+		queue.push_back(item);
+		return true;
+	}, [&](uint8_t& item)
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (queue.empty())
+		{
+			return false;
+		}
+		item = queue.front();
+		queue.pop_front();
+		return true;
+	});
+	current = nanosecondsPerTransfer(items, [&](uint8_t item) { return ring.push(item); }, [&](uint8_t& item) { return ring.pop(item); });
+	if (previous < 0.0 || current < 0.0)
+	{
+		printf("Items didn't arrive in the order they were pushed.\n");
+		return 1;
+	}
+	printResult("transfer between threads, deque with a lock", previous, previous);
+	printResult("transfer between threads, SpscRing", current, previous);
+	return 0;
+}
@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "ActionData.h"
+#include "ActionEvaluator.h"
+#include "Utils.h"
+#include <random>
+#include <vector>
+
+using namespace IGCS;
+
+namespace
+{
+	// The keyboard ActionData::isActive sees: the camera asks Windows for the key states, the tests provide them below.
+	KeyboardSnapshot keyboard;
+
+	const int KEY_LSHIFT = 0xA0;
+	const int KEY_RSHIFT = 0xA1;
+	const int KEY_LCONTROL = 0xA2;
+	const int KEY_RCONTROL = 0xA3;
+	const int KEY_LMENU = 0xA4;
+	const int KEY_RMENU = 0xA5;
+}
+
+
+namespace IGCS::Utils
+{
+	bool keyDown(int virtualKeyCode) { return keyboard.isKeyDown(virtualKeyCode); }
+	bool altPressed() { return keyDown(KEY_LMENU) || keyDown(KEY_RMENU); }
+	bool ctrlPressed() { return keyDown(KEY_LCONTROL) || keyDown(KEY_RCONTROL); }
+	bool shiftPressed() { return keyDown(KEY_LSHIFT) || keyDown(KEY_RSHIFT); }
+}
+
+
+// The evaluator has to give the same answers as evaluating each ActionData on its own, for every combination of binding, key and
+// modifier keys.
+IGCS_TEST(ActionEvaluator, MatchesActionData)
+{
+	std::vector<ActionData> actions;
+	for (int required = 0; required < 8; required++)
+	{
+		actions.emplace_back("action", 0x41 + required, (required & 1) != 0, (required & 2) != 0, (required & 4) != 0);
+	}
+	actions.emplace_back("unavailable", 0x4A, false, false, false, false);
+	actions.emplace_back("unbound", 0, false, false, false);
+	actions.emplace_back("high key code", 0xFE, false, true, false);
+	REQUIRE(actions.size() <= static_cast<size_t>(ActionType::Amount));
+	ActionEvaluator evaluator;
+	for (size_t i = 0; i < actions.size(); i++)
+	{
+		evaluator.compile(static_cast<ActionType>(i), &actions[i]);
+	}
+	const int modifierKeys[][2] = { { KEY_LMENU, KEY_RMENU }, { KEY_LCONTROL, KEY_RCONTROL }, { KEY_LSHIFT, KEY_RSHIFT } };
+	for (int keyCode : { 0x41, 0x43, 0x47, 0x48, 0x4A, 0xFE })
+	{
+		// per modifier: 0 up, 1 left down, 2 right down
+		for (int modifiers = 0; modifiers < 27; modifiers++)
+		{
+			keyboard.clear();
+			keyboard.setKeyDown(keyCode);
+			for (int modifier = 0, state = modifiers; modifier < 3; modifier++, state /= 3)
+			{
+				if (state % 3 != 0)
+				{
+					keyboard.setKeyDown(modifierKeys[modifier][state % 3 - 1]);
+				}
+			}
+			evaluator.evaluate(keyboard);
+			CHECK(evaluator.altPressed() == Utils::altPressed());
+			CHECK(evaluator.ctrlPressed() == Utils::ctrlPressed());
+			CHECK(evaluator.shiftPressed() == Utils::shiftPressed());
+			for (size_t i = 0; i < actions.size(); i++)
+			{
+				ActionType type = static_cast<ActionType>(i);
+				for (bool altCtrlOptional : { false, true })
+				{
+					CHECK(evaluator.isActive(type, altCtrlOptional) == actions[i].isActive(altCtrlOptional));
+					CHECK(evaluator.altCtrlMatch(type, altCtrlOptional) == actions[i].altCtrlMatch(altCtrlOptional));
+				}
+			}
+		}
+	}
+}
+
+
+IGCS_TEST(ActionEvaluator, FollowsARecompiledBinding)
+{
+	ActionData action("action", 0x41, false, false, false);
+	ActionEvaluator evaluator;
+	evaluator.compile(ActionType::HudToggle, &action);
+	keyboard.clear();
+	keyboard.setKeyDown(0x42);
+	evaluator.evaluate(keyboard);
+	CHECK(!evaluator.isActive(ActionType::HudToggle, false));
+	action.setKeyCode(0x42);
+	// the old binding is used till it's compiled again
+	evaluator.evaluate(keyboard);
+	CHECK(!evaluator.isActive(ActionType::HudToggle, false));
+	evaluator.compile(ActionType::HudToggle, &action);
+	evaluator.evaluate(keyboard);
+	CHECK(evaluator.isActive(ActionType::HudToggle, false));
+	evaluator.compile(ActionType::HudToggle, nullptr);
+	evaluator.evaluate(keyboard);
+	CHECK(!evaluator.isActive(ActionType::HudToggle, false));
+	CHECK(!evaluator.isActive(ActionType::Amount, false));
+}
+
+
+// setFromKeyStates takes the high bit of every byte, like GetKeyboardState reports a key which is down. The low bit, the toggle state of
+// e.g. caps lock, is ignored.
+IGCS_TEST(ActionEvaluator, SnapshotsKeyStates)
+{
+	std::mt19937 random(20);
+	for (int iteration = 0; iteration < 100; iteration++)
+	{
+		uint8_t keyStates[256];
+		for (uint8_t& keyState : keyStates)
+		{
+			keyState = static_cast<uint8_t>(random());
+		}
+		KeyboardSnapshot snapshot;
+		snapshot.setFromKeyStates(keyStates);
+		for (int keyCode = 0; keyCode < 256; keyCode++)
+		{
+			CHECK(snapshot.isKeyDown(keyCode) == ((keyStates[keyCode] & 0x80) != 0));
+		}
+	}
+	KeyboardSnapshot snapshot;
+	snapshot.clear();
+	CHECK(!snapshot.isKeyDown(-1));
+	CHECK(!snapshot.isKeyDown(256));
+	snapshot.setKeyDown(256);
+	for (uint64_t word : snapshot.keysDown)
+	{
+		CHECK(word == 0);
+	}
+}
@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "ActionStateMachine.h"
+#include <algorithm>
+#include <string>
+
+using namespace IGCS;
+
+namespace
+{
+	const int64_t MILLISECOND = 1000;
+
+	// What the last update found for type, as a string so a failing check shows it: P(ressed), R(eleased), r(epeated) or -.
+	char edgesOf(ActionStateMachine& stateMachine, ActionType type)
+	{
+		int numberOfEdges = stateMachine.wasPressed(type) + stateMachine.wasReleased(type) + stateMachine.wasRepeated(type);
+		if (numberOfEdges > 1)
+		{
+			return '!';
+		}
+		return stateMachine.wasPressed(type) ? 'P' : stateMachine.wasReleased(type) ? 'R' : stateMachine.wasRepeated(type) ? 'r' : '-';
+	}
+
+
+	// Updates type once per tick with the key states given ('1' down, '0' up) and returns the edges found per tick.
+	std::string run(ActionStateMachine& stateMachine, ActionType type, const std::string& keysDown, int64_t tickInterval, int64_t& now)
+	{
+		std::string toReturn;
+		for (char keyDown : keysDown)
+		{
+			stateMachine.update(type, keyDown == '1', now);
+			toReturn += edgesOf(stateMachine, type);
+			now += tickInterval;
+		}
+		return toReturn;
+	}
+}
+
+
+IGCS_TEST(ActionStateMachine, FindsPressesAndReleases)
+{
+	ActionStateMachine stateMachine(500, 0.0f);
+	int64_t now = 0;
+	CHECK(run(stateMachine, ActionType::HudToggle, "0110001111100", 10 * MILLISECOND, now) == "-P-R--P----R-");
+	CHECK(!stateMachine.isDown(ActionType::HudToggle));
+	stateMachine.update(ActionType::HudToggle, true, now);
+	CHECK(stateMachine.isDown(ActionType::HudToggle));
+	// the other actions aren't affected
+	CHECK(!stateMachine.isDown(ActionType::Timestop));
+	CHECK(edgesOf(stateMachine, ActionType::Timestop) == '-');
+}
+
+
+// A press shorter than a tick is lost, like it was with polling. A press which spans ticks is found once, however fast the ticks are.
+IGCS_TEST(ActionStateMachine, APressGivesOneEdgeAtAnyTickRate)
+{
+	for (int64_t tickInterval : { 1 * MILLISECOND, 8 * MILLISECOND, 33 * MILLISECOND })
+	{
+		ActionStateMachine stateMachine(500, 0.0f);
+		int64_t now = 0;
+		std::string edges = run(stateMachine, ActionType::CameraEnable, std::string(5, '0') + std::string(200, '1') + std::string(5, '0'), tickInterval, now);
+		CHECK(std::count(edges.begin(), edges.end(), 'P') == 1);
+		CHECK(std::count(edges.begin(), edges.end(), 'R') == 1);
+		CHECK(std::count(edges.begin(), edges.end(), 'r') == 0);
+	}
+}
+
+
+IGCS_TEST(ActionStateMachine, RepeatsAfterTheRepeatDelay)
+{
+	// 400ms delay, then 10 repeats per second, ticks every 50ms.
+	ActionStateMachine stateMachine(400, 10.0f);
+	int64_t now = 0;
+	CHECK(run(stateMachine, ActionType::FovIncrease, "0111111111111110", 50 * MILLISECOND, now) == "-P-------r-r-r-R");
+	// a held key repeats at the repeat rate, not at the tick rate
+	ActionStateMachine fastTicks(400, 10.0f);
+	now = 0;
+	std::string edges = run(fastTicks, ActionType::FovIncrease, "1" + std::string(999, '1'), 1 * MILLISECOND, now);
+	CHECK(edges[0] == 'P');
+	CHECK(edges.find('r') == 400);
+	CHECK(std::count(edges.begin(), edges.end(), 'r') == 6);
+}
+
+
+// Ticks further apart than the repeat interval give one repeat per tick, not a burst.
+IGCS_TEST(ActionStateMachine, SlowTicksDontGiveBurstsOfRepeats)
+{
+	ActionStateMachine stateMachine(100, 50.0f);
+	int64_t now = 0;
+	CHECK(run(stateMachine, ActionType::FovDecrease, "11111", 100 * MILLISECOND, now) == "Prrrr");
+	// after a stall, repeats continue at the rate from the stall's end
+	stateMachine.update(ActionType::FovDecrease, true, now + 1000 * MILLISECOND);
+	CHECK(edgesOf(stateMachine, ActionType::FovDecrease) == 'r');
+	stateMachine.update(ActionType::FovDecrease, true, now + 1010 * MILLISECOND);
+	CHECK(edgesOf(stateMachine, ActionType::FovDecrease) == '-');
+	stateMachine.update(ActionType::FovDecrease, true, now + 1020 * MILLISECOND);
+	CHECK(edgesOf(stateMachine, ActionType::FovDecrease) == 'r');
+}
+
+
+IGCS_TEST(ActionStateMachine, ResetForgetsHeldKeys)
+{
+	ActionStateMachine stateMachine(400, 10.0f);
+	stateMachine.update(ActionType::MoveForward, true, 0);
+	CHECK(stateMachine.isDown(ActionType::MoveForward));
+	// e.g. the game lost focus: the release isn't seen, but after a reset a key which is still down is pressed again
+	stateMachine.reset();
+	CHECK(!stateMachine.isDown(ActionType::MoveForward));
+	CHECK(edgesOf(stateMachine, ActionType::MoveForward) == '-');
+	stateMachine.update(ActionType::MoveForward, true, 10 * MILLISECOND);
+	CHECK(edgesOf(stateMachine, ActionType::MoveForward) == 'P');
+}
+
+
+IGCS_TEST(ActionStateMachine, RestoresTheSavedState)
+{
+	ActionStateMachine stateMachine(400, 10.0f);
+	int64_t now = 0;
+	run(stateMachine, ActionType::SkipFrames, "1111111", 50 * MILLISECOND, now);
+	bool isDown;
+	int64_t nextRepeatTime;
+	stateMachine.saveActionState(ActionType::SkipFrames, isDown, nextRepeatTime);
+	CHECK(isDown);
+	int64_t savedNow = now;
+	std::string expected = run(stateMachine, ActionType::SkipFrames, "111110", 50 * MILLISECOND, now);
+
+	ActionStateMachine restored(400, 10.0f);
+	restored.restoreActionState(ActionType::SkipFrames, isDown, nextRepeatTime);
+	CHECK(edgesOf(restored, ActionType::SkipFrames) == '-');
+	CHECK(run(restored, ActionType::SkipFrames, "111110", 50 * MILLISECOND, savedNow) == expected);
+
+	// invalid types are ignored
+	restored.update(ActionType::Amount, true, 0);
+	CHECK(!restored.isDown(ActionType::Amount));
+	CHECK(!restored.wasPressed(ActionType::Amount));
+}
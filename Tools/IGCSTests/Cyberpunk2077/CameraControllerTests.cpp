@@ -0,0 +1,381 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "CameraController.h"
+#include "CameraManipulator.h"
+#include "Globals.h"
+#include "Input.h"
+#include "MessageHandler.h"
+#include "SessionRecorder.h"
+#include "SessionReplayer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+using namespace IGCS;
+using namespace IGCS::GameSpecific;
+
+// The camera logs to the client through the named pipe. The tests have no client.
+namespace IGCS::MessageHandler
+{
+	void logDebug(const char*, ...) {}
+	void logError(const char*, ...) {}
+	void logLine(const char*, ...) {}
+	void addNotification(const std::string&) {}
+}
+
+
+namespace
+{
+	const float COORD_MULTIPLIER_FACTOR = 1.0f / 131072.0f;
+	const int CAMERA_STRUCT_SIZE = 0x400;
+	const int KEY_LMENU = 0xA4;
+
+	// The game, as far as the camera sees it: a camera struct, here a block of memory, and the interceptor which copies the published pose
+	// into it when the game writes its camera. Creating one puts the camera system in the state it has when the camera struct was just found.
+	class FakeGame
+	{
+	public:
+		FakeGame() : _cameraStruct(CAMERA_STRUCT_SIZE / sizeof(uint64_t))
+		{
+			const int32_t coords[3] = { 10 * 131072, -20 * 131072, 3 * 131072 };
+			const float quaternion[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+			const float fov = 70.0f;
+			memcpy(cameraStruct() + COORDS_IN_CAMSTRUCT_OFFSET, coords, sizeof(coords));
+			memcpy(cameraStruct() + QUATERNION_IN_CAMSTRUCT_OFFSET, quaternion, sizeof(quaternion));
+			memcpy(cameraStruct() + FOV_IN_PLAYCAMSTRUCT_OFFSET, &fov, sizeof(fov));
+			g_activeCamStructAddress = cameraStruct();
+			g_cameraEnabled = 0;
+			g_cameraPose.clear();
+			CameraManipulator::setCoordMultiplierFactor(COORD_MULTIPLIER_FACTOR);
+			Globals::instance().settings().init(false);
+			Globals::instance().hudVisible(true);
+			Input::InputState inputState = {};
+			Input::setState(inputState);
+		}
+
+		~FakeGame()
+		{
+			g_activeCamStructAddress = nullptr;
+			g_cameraEnabled = 0;
+			g_cameraPose.clear();
+		}
+
+		uint8_t* cameraStruct() { return reinterpret_cast<uint8_t*>(_cameraStruct.data()); }
+
+		// What activeCamWrite1Interceptor does.
+		void writeCamera()
+		{
+			CameraPose pose;
+			if (g_cameraPose.read(pose))
+			{
+				memcpy(cameraStruct() + COORDS_IN_CAMSTRUCT_OFFSET, pose.coords, sizeof(pose.coords));
+				memcpy(cameraStruct() + QUATERNION_IN_CAMSTRUCT_OFFSET, pose.quaternion, sizeof(pose.quaternion));
+			}
+		}
+
+	private:
+		std::vector<uint64_t> _cameraStruct;	// as 64 bit words so it's aligned like the game's
+	};
+
+
+	// A tick without any input, which simulates the number of steps specified.
+	TickInput createTick(int tick, int numberOfSteps)
+	{
+		TickInput input = {};
+		input.nowInMicroseconds = 1000000 + static_cast<int64_t>(tick) * 11000;
+		input.frameTime.deltaSeconds = 0.011f;
+		input.frameTime.numberOfSteps = numberOfSteps;
+		input.frameTime.stepSeconds = REFERENCE_TICK_SECONDS;
+		input.frameTime.interpolationFactor = 1.0f;
+		input.gameHasFocus = true;
+		input.keyboard.clear();
+		input.gameCameraFound = CameraManipulator::readGameCameraData(input.gameCameraCoords, input.gameCameraFoV);
+		return input;
+	}
+
+
+	// Tick 'tick' of a session in which the camera is enabled and moved with the keyboard, the mouse and a gamepad, tilted and zoomed, at
+	// a frame rate which varies, so some ticks simulate no step and others several.
+	TickInput createSessionTick(int tick)
+	{
+		TickInput input = createTick(tick, tick % 3);
+		input.frameTime.interpolationFactor = static_cast<float>(tick % 4) * 0.25f;
+		if (1 == tick)
+		{
+			input.keyboard.setKeyDown(IGCS_KEY_CAMERA_ENABLE);
+		}
+		if (tick >= 5 && tick < 40)
+		{
+			input.keyboard.setKeyDown(IGCS_KEY_MOVE_FORWARD);
+		}
+		if (tick >= 20 && tick < 30)
+		{
+			input.keyboard.setKeyDown(IGCS_KEY_ROTATE_LEFT);
+		}
+		if (45 == tick || 46 == tick)
+		{
+			input.keyboard.setKeyDown(KEY_LMENU);
+			input.keyboard.setKeyDown(IGCS_KEY_TILT_LEFT);
+		}
+		input.mouse.deltaX = (tick * 7) % 13 - 6;
+		input.mouse.deltaY = (tick * 5) % 11 - 5;
+		if (tick >= 50 && tick < 60)
+		{
+			input.mouse.buttonsDown = 1;
+		}
+		if (70 == tick)
+		{
+			input.mouse.wheelDelta = 180;
+		}
+		input.gamepadConnected = true;
+		if (tick >= 80 && tick < 100)
+		{
+			input.gamepad.sThumbLY = 20000;
+			input.gamepad.sThumbRX = -15000;
+		}
+		return input;
+	}
+
+
+	bool posesEqual(const CameraPose& a, const CameraPose& b)
+	{
+		return 0 == memcmp(a.coords, b.coords, sizeof(a.coords)) && 0 == memcmp(a.quaternion, b.quaternion, sizeof(a.quaternion));
+	}
+
+
+	// The angle in radians the pose is rotated by from the orientation the camera starts with.
+	float rotationAngle(const CameraPose& pose)
+	{
+		return 2.0f * std::acos((std::min)(1.0f, std::fabs(pose.quaternion[3])));
+	}
+
+
+	// Runs the ticks specified through a controller for which the camera struct was just found, after a tick which enables the camera.
+	// Returns the pose the last tick handed to the game.
+	CameraPose runTicks(const std::vector<TickInput>& ticks)
+	{
+		FakeGame game;
+		CameraController controller;
+		controller.onCameraStructFound();
+		TickInput enable = createTick(0, 1);
+		enable.keyboard.setKeyDown(IGCS_KEY_CAMERA_ENABLE);
+		controller.update(enable);
+		game.writeCamera();
+		for (const TickInput& input : ticks)
+		{
+			controller.update(input);
+			game.writeCamera();
+		}
+		CameraPose pose = {};
+		g_cameraPose.read(pose);
+		return pose;
+	}
+
+
+	// A tick which simulates the number of steps specified, in which the mouse moved horizontally by deltaX.
+	TickInput createMouseTick(int tick, int numberOfSteps, int32_t deltaX)
+	{
+		TickInput input = createTick(tick, numberOfSteps);
+		input.mouse.deltaX = deltaX;
+		return input;
+	}
+}
+
+
+// With fixed steps a tick can simulate no step. The mouse movement of such a tick is picked up by the next step, once.
+IGCS_TEST(CameraController, MouseMovementOfATickWithoutAStepIsAppliedOnce)
+{
+	const CameraPose notMoved = runTicks({ createMouseTick(1, 0, 0), createMouseTick(2, 1, 0) });
+	const CameraPose movedInTickWithoutStep = runTicks({ createMouseTick(1, 0, 40), createMouseTick(2, 1, 0) });
+	const CameraPose movedInTickWithStep = runTicks({ createMouseTick(1, 0, 0), createMouseTick(2, 1, 40) });
+	const CameraPose movedInBoth = runTicks({ createMouseTick(1, 0, 40), createMouseTick(2, 1, 40) });
+	const CameraPose movedInTwoTicksWithoutStep = runTicks({ createMouseTick(1, 0, 40), createMouseTick(2, 0, 40), createMouseTick(3, 1, 0) });
+	const float angle = rotationAngle(movedInTickWithStep);
+	CHECK(rotationAngle(notMoved) == 0.0f);
+	CHECK(angle > 0.01f);
+	CHECK(posesEqual(movedInTickWithoutStep, movedInTickWithStep));
+	CHECK(std::fabs(rotationAngle(movedInBoth) - 2.0f * angle) < 1e-4f);
+	CHECK(std::fabs(rotationAngle(movedInTwoTicksWithoutStep) - 2.0f * angle) < 1e-4f);
+}
+
+
+// A keyboard action like the 90 degree tilt happens when its key goes down, also in a tick without a step, and only once.
+IGCS_TEST(CameraController, KeyboardActionOfATickWithoutAStepIsAppliedOnce)
+{
+	for (int numberOfSteps : { 0, 1, 3 })
+	{
+		TickInput tilt = createTick(1, numberOfSteps);
+		tilt.keyboard.setKeyDown(KEY_LMENU);
+		tilt.keyboard.setKeyDown(IGCS_KEY_TILT_LEFT);
+		// the keys are still down in the next tick
+		TickInput held = tilt;
+		held.frameTime.numberOfSteps = 1;
+		const CameraPose pose = runTicks({ tilt, held });
+		CHECK(std::fabs(rotationAngle(pose) - 0.5f * static_cast<float>(Math::PI)) < 1e-4f);
+	}
+}
+
+
+// A held fov key changes the fov at a speed, so a tick which simulates twice the time changes it twice as much, whatever the number of steps.
+IGCS_TEST(CameraController, HeldFovKeyIsScaledByTheTimeOfTheTick)
+{
+	for (int numberOfSteps : { 0, 1, 2 })
+	{
+		float fovChanges[2] = {};
+		for (int i = 0; i < 2; i++)
+		{
+			FakeGame game;
+			CameraController controller;
+			controller.onCameraStructFound();
+			TickInput enable = createTick(0, 1);
+			enable.keyboard.setKeyDown(IGCS_KEY_CAMERA_ENABLE);
+			controller.update(enable);
+			const float fovBefore = CameraManipulator::getCurrentFoV();
+			TickInput zoom = createTick(1, numberOfSteps);
+			zoom.frameTime.deltaSeconds = REFERENCE_TICK_SECONDS * static_cast<float>(i + 1);
+			zoom.keyboard.setKeyDown(IGCS_KEY_FOV_INCREASE);
+			controller.update(zoom);
+			fovChanges[i] = CameraManipulator::getCurrentFoV() - fovBefore;
+		}
+		CHECK(std::fabs(fovChanges[0] - Globals::instance().settings().fovChangeSpeed) < 1e-4f);
+		CHECK(std::fabs(fovChanges[1] - 2.0f * fovChanges[0]) < 1e-4f);
+	}
+}
+
+
+// Movement of a tick without a step, e.g. with a mouse button down, isn't lost when a keyframe is taken before the next step.
+IGCS_TEST(CameraController, KeyframeKeepsTheMovementOfATickWithoutAStep)
+{
+	FakeGame game;
+	CameraController controller;
+	controller.onCameraStructFound();
+	TickInput enable = createTick(0, 1);
+	enable.keyboard.setKeyDown(IGCS_KEY_CAMERA_ENABLE);
+	controller.update(enable);
+	game.writeCamera();
+	TickInput moveForward = createMouseTick(1, 0, 0);
+	moveForward.mouse.deltaY = -50;
+	moveForward.mouse.buttonsDown = 2;
+	controller.update(moveForward);
+	game.writeCamera();
+
+	SessionKeyframe keyframe = {};
+	controller.saveState(keyframe);
+	const TickInput step = createTick(2, 1);
+	controller.update(step);
+	CameraPose expected = {};
+	REQUIRE(g_cameraPose.read(expected));
+	// the step moved the camera
+	CHECK(0 != memcmp(expected.coords, game.cameraStruct() + COORDS_IN_CAMSTRUCT_OFFSET, sizeof(expected.coords)));
+	CameraController restored;
+	restored.restoreState(keyframe);
+	restored.update(step);
+	CameraPose replayed = {};
+	REQUIRE(g_cameraPose.read(replayed));
+	CHECK(posesEqual(expected, replayed));
+}
+
+
+// A session recorded the way System records it, replayed from its first keyframe through another controller without the game, has to
+// give the same pose in every tick.
+IGCS_TEST(SessionReplay, ReplayGivesTheRecordedPosesFrameByFrame)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "IGCSSessionReplayTest.igcsr";
+	const int numberOfTicks = 120;
+	std::vector<CameraPose> recordedPoses;
+	{
+		FakeGame game;
+		CameraController controller;
+		controller.onCameraStructFound();
+		SessionRecorder recorder;
+		REQUIRE(recorder.start(path, 1024 * 1024, 16));
+		for (int tick = 0; tick < numberOfTicks; tick++)
+		{
+			TickInput input = createSessionTick(tick);
+			recorder.recordTick(input, controller);
+			controller.update(input);
+			recorder.recordPose();
+			CameraPose pose = {};
+			g_cameraPose.read(pose);
+			recordedPoses.push_back(pose);
+			game.writeCamera();
+		}
+		recorder.stop();
+	}
+	// the session went somewhere
+	CHECK(!posesEqual(recordedPoses[2], recordedPoses[numberOfTicks - 1]));
+	CHECK(recordedPoses[2].coords[1] != recordedPoses[numberOfTicks - 1].coords[1]);
+	CHECK(recordedPoses[2].quaternion[3] != recordedPoses[numberOfTicks - 1].quaternion[3]);
+
+	{
+		FakeGame game;
+		CameraController controller;
+		SessionReplayer replayer;
+		REQUIRE(replayer.open(path));
+		REQUIRE(replayer.start(controller));
+		for (int tick = 0; tick < numberOfTicks; tick++)
+		{
+			REQUIRE(replayer.replayNextTick(controller));
+			CameraPose pose = {};
+			const bool hasPose = g_cameraPose.read(pose);
+			// the camera is enabled in the second tick, before that there's no pose
+			CHECK(hasPose == (tick > 0));
+			CHECK(!hasPose || posesEqual(pose, recordedPoses[tick]));
+			game.writeCamera();
+		}
+		CHECK(!replayer.replayNextTick(controller));
+		const SessionReplayResult& result = replayer.result();
+		CHECK(result.numberOfTicks == numberOfTicks);
+		CHECK(result.numberOfPosesCompared == numberOfTicks);
+		CHECK(result.numberOfPosesDiffering == 0);
+		CHECK(result.firstDifferingTick == -1);
+	}
+
+	// a replay which goes another way shows where it started to differ
+	{
+		FakeGame game;
+		CameraController controller;
+		SessionReplayer replayer;
+		REQUIRE(replayer.open(path));
+		REQUIRE(replayer.start(controller));
+		Globals::instance().settings().movementSpeed *= 2.0f;
+		replayer.replayAll(controller);
+		const SessionReplayResult& result = replayer.result();
+		CHECK(result.numberOfTicks == numberOfTicks);
+		CHECK(result.numberOfPosesDiffering > 0);
+		// the first tick which moves the camera is the first with a step after the move key went down
+		CHECK(result.firstDifferingTick == 5);
+		CHECK(result.maxCoordDifference > 0);
+	}
+	std::error_code ignored;
+	std::filesystem::remove(path, ignored);
+}
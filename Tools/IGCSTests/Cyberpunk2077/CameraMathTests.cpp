@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "CameraMath.h"
+#include <cmath>
+#include <random>
+
+using namespace IGCS;
+
+namespace
+{
+	// Cyberpunk's axes: x right, y into the screen, z up.
+	typedef Math::AxisConvention<0, 1, 2> CameraAxes;
+
+	// XMQuaternionRotationNormal
+	Math::Quat xmQuaternionRotationNormal(const Math::Vec3& axis, float angle)
+	{
+		float s = std::sin(angle * 0.5f);
+		return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+	}
+
+
+	// XMQuaternionMultiply, which returns q2 * q1: the rotation by q1 followed by the one by q2.
+	Math::Quat xmQuaternionMultiply(const Math::Quat& q1, const Math::Quat& q2)
+	{
+		return { q2.w * q1.x + q2.x * q1.w + q2.y * q1.z - q2.z * q1.y,
+				 q2.w * q1.y - q2.x * q1.z + q2.y * q1.w + q2.z * q1.x,
+				 q2.w * q1.z + q2.x * q1.y - q2.y * q1.x + q2.z * q1.w,
+				 q2.w * q1.w - q2.x * q1.x - q2.y * q1.y - q2.z * q1.z };
+	}
+
+
+	// The look quaternion as Camera::calculateLookQuaternion calculated it with DirectXMath, normalized.
+	Math::Quat directXLookQuaternion(float pitch, float yaw, float roll)
+	{
+		Math::Quat xQ = xmQuaternionRotationNormal({ 1.0f, 0.0f, 0.0f }, pitch);
+		Math::Quat yQ = xmQuaternionRotationNormal({ 0.0f, 1.0f, 0.0f }, roll);
+		Math::Quat zQ = xmQuaternionRotationNormal({ 0.0f, 0.0f, 1.0f }, yaw);
+		Math::Quat toReturn = xmQuaternionMultiply(yQ, xmQuaternionMultiply(xQ, zQ));
+		float length = std::sqrt(Math::lengthSquared(toReturn));
+		return { toReturn.x / length, toReturn.y / length, toReturn.z / length, toReturn.w / length };
+	}
+
+
+	// q and -q are the same rotation.
+	bool isSameRotation(const Math::Quat& a, const Math::Quat& b, float tolerance)
+	{
+		float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w) < 0.0f ? -1.0f : 1.0f;
+		return std::fabs(a.x - sign * b.x) <= tolerance && std::fabs(a.y - sign * b.y) <= tolerance &&
+			   std::fabs(a.z - sign * b.z) <= tolerance && std::fabs(a.w - sign * b.w) <= tolerance;
+	}
+}
+
+
+IGCS_TEST(CameraMath, SetFromEulerMatchesTheDirectXComposition)
+{
+	const float angles[] = { -3.1f, -2.0f, -Math::HALF_PI, -0.7f, -0.01f, 0.0f, 0.3f, 1.2f, Math::HALF_PI, 2.5f, 3.1f };
+	for (float pitch : angles)
+	{
+		for (float yaw : angles)
+		{
+			for (float roll : angles)
+			{
+				Math::CameraOrientation<CameraAxes> orientation;
+				orientation.setFromEuler(pitch, yaw, roll);
+				CHECK(isSameRotation(orientation.orientation(), directXLookQuaternion(pitch, yaw, roll), 1e-5f));
+			}
+		}
+	}
+}
+
+
+// Without roll the order of the deltas doesn't matter: the camera ends up where the summed angles put it. Roll applied last does too.
+IGCS_TEST(CameraMath, IntegratingDeltasMatchesTheSummedAngles)
+{
+	std::mt19937 random(14);
+	std::uniform_real_distribution<float> delta(-0.05f, 0.05f);
+	Math::CameraOrientation<CameraAxes> orientation;
+	float pitch = 0.4f;
+	float yaw = -1.0f;
+	float roll = 0.0f;
+	orientation.setFromEuler(pitch, yaw, roll);
+	for (int i = 0; i < 1000; i++)
+	{
+		float pitchDelta = (i % 3) == 0 ? 0.0f : delta(random);
+		float yawDelta = (i % 5) == 0 ? 0.0f : delta(random);
+		orientation.integrate(pitchDelta, yawDelta, 0.0f);
+		pitch += pitchDelta;
+		yaw += yawDelta;
+	}
+	CHECK(isSameRotation(orientation.orientation(), directXLookQuaternion(pitch, yaw, roll), 1e-4f));
+	for (int i = 0; i < 100; i++)
+	{
+		float rollDelta = delta(random);
+		orientation.integrate(0.0f, 0.0f, rollDelta);
+		roll += rollDelta;
+	}
+	CHECK(isSameRotation(orientation.orientation(), directXLookQuaternion(pitch, yaw, roll), 1e-4f));
+	CHECK(std::fabs(Math::lengthSquared(orientation.orientation()) - 1.0f) < 1e-5f);
+}
+
+
+IGCS_TEST(CameraMath, ToEulerReturnsTheAnglesSetFromEuler)
+{
+	Math::CameraOrientation<CameraAxes> orientation;
+	float pitch, yaw, roll;
+	orientation.toEuler(pitch, yaw, roll);
+	CHECK(pitch == 0.0f && yaw == 0.0f && roll == 0.0f);
+	orientation.setFromEuler(0.5f, -2.0f, 1.0f);
+	orientation.toEuler(pitch, yaw, roll);
+	CHECK(pitch == 0.5f && yaw == -2.0f && roll == 1.0f);
+	// wrapped into [-PI, PI]
+	orientation.setFromEuler(0.5f, 4.0f, 1.0f);
+	orientation.toEuler(pitch, yaw, roll);
+	CHECK(std::fabs(yaw - (4.0f - Math::TWO_PI)) < 1e-5f);
+}
+
+
+IGCS_TEST(CameraMath, ToEulerDecomposesAChangedOrientation)
+{
+	Math::CameraOrientation<CameraAxes> orientation;
+	orientation.setFromEuler(0.5f, -2.0f, 0.3f);
+	orientation.integrate(0.0f, 0.25f, 0.0f);
+	float pitch, yaw, roll;
+	orientation.toEuler(pitch, yaw, roll);
+	CHECK(std::fabs(pitch - 0.5f) < 1e-5f);
+	CHECK(std::fabs(yaw - -1.75f) < 1e-5f);
+	CHECK(std::fabs(roll - 0.3f) < 1e-5f);
+
+	// a pitch past straight up isn't what the decomposition returns, but the angles build the same orientation.
+	orientation.setFromEuler(2.0f, 0.5f, 0.0f);
+	orientation.toEuler(pitch, yaw, roll);
+	CHECK(std::fabs(pitch) <= Math::HALF_PI);
+	Math::CameraOrientation<CameraAxes> rebuilt;
+	rebuilt.setFromEuler(pitch, yaw, roll);
+	CHECK(isSameRotation(rebuilt.orientation(), orientation.orientation(), 1e-5f));
+
+	Math::Quat restored = orientation.orientation();
+	orientation.setFromEuler(0.1f, 0.2f, 0.3f);
+	orientation.restoreOrientation(restored);
+	orientation.toEuler(pitch, yaw, roll);
+	rebuilt.setFromEuler(pitch, yaw, roll);
+	CHECK(isSameRotation(rebuilt.orientation(), restored, 1e-5f));
+}
@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "Camera.h"
+#include "FrameClock.h"
+#include "Globals.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace IGCS;
+
+namespace
+{
+	class SimulatedTimeSource : public TimeSource
+	{
+	public:
+		SimulatedTimeSource() : _now(1000000) {}
+		int64_t nowInMicroseconds() override { return _now; }
+		void advance(int64_t microseconds) { _now += microseconds; }
+
+	private:
+		int64_t _now;
+	};
+
+
+	double length(const Math::Vec3d& vector)
+	{
+		return std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+	}
+
+
+	// A Camera moved forward at speed units per second, in steps like CameraController moves it. position is what's written to the game:
+	// the coordinates interpolationFactor of the way between the last two steps. distance is how far that is from where it started.
+	struct MovingCamera
+	{
+		Camera camera;
+		Math::Vec3d position = { 0.0, 0.0, 0.0 };
+		double distance = 0.0;
+		std::vector<double> stepDistances;
+
+		void update(const FrameTime& frameTime, double speed)
+		{
+			// moveForward moves by the movement speed setting times the amount
+			const double movementSpeed = Globals::instance().settings().movementSpeed;
+			for (int i = 0; i < frameTime.numberOfSteps; i++)
+			{
+				camera.moveForward(static_cast<float>(speed * frameTime.stepSeconds / movementSpeed));
+				camera.endStep();
+				// the offset of the last step is relative to the position written last
+				const Math::Vec3 lastStepOffset = camera.getState().lastStepOffset;
+				stepDistances.push_back(length({ position.x + lastStepOffset.x, position.y + lastStepOffset.y, position.z + lastStepOffset.z }));
+			}
+			position = camera.calculateNewCoords(position, frameTime.interpolationFactor);
+			distance = length(position);
+		}
+	};
+
+
+	bool distancesMatch(const std::vector<double>& a, const std::vector<double>& b, double tolerance)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (std::fabs(a[i] - b[i]) > tolerance)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// Ticks for totalTime with the tick intervals given, repeated, and returns the camera after the last tick.
+	MovingCamera runCamera(float fixedStepRate, const std::vector<int64_t>& tickIntervals, int64_t totalTime)
+	{
+		SimulatedTimeSource timeSource;
+		FrameClock clock(timeSource);
+		clock.setFixedStepRate(fixedStepRate);
+		MovingCamera camera;
+		int64_t elapsed = 0;
+		for (size_t i = 0; elapsed < totalTime; i++)
+		{
+			int64_t interval = (std::min)(tickIntervals[i % tickIntervals.size()], totalTime - elapsed);
+			timeSource.advance(interval);
+			elapsed += interval;
+			camera.update(clock.tick(), 10.0);
+		}
+		return camera;
+	}
+}
+
+
+IGCS_TEST(FrameClock, VariableStepMovesTheElapsedTime)
+{
+	SimulatedTimeSource timeSource;
+	FrameClock clock(timeSource);
+	timeSource.advance(16667);
+	FrameTime frameTime = clock.tick();
+	CHECK(frameTime.numberOfSteps == 1);
+	CHECK(std::fabs(frameTime.deltaSeconds - 0.016667f) < 1e-6f);
+	CHECK(frameTime.stepSeconds == frameTime.deltaSeconds);
+	CHECK(frameTime.interpolationFactor == 1.0f);
+	// a stall is capped at the max delta
+	timeSource.advance(5000000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.1f) < 1e-6f);
+	clock.setMaxDeltaSeconds(0.05f);
+	timeSource.advance(5000000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.05f) < 1e-6f);
+}
+
+
+IGCS_TEST(FrameClock, MovementDoesntDependOnTheTickRate)
+{
+	const double expected = 10.0 * 2.0;
+	for (int64_t interval : { 1000, 4000, 8000, 16667, 33333 })
+	{
+		MovingCamera camera = runCamera(0.0f, { interval }, 2000000);
+		CHECK(std::fabs(camera.distance - expected) < 1e-3);
+	}
+	MovingCamera jittery = runCamera(0.0f, { 3000, 11000, 7500, 500, 20000 }, 2000000);
+	CHECK(std::fabs(jittery.distance - expected) < 1e-3);
+}
+
+
+IGCS_TEST(FrameClock, FixedStepsAccumulateTheElapsedTime)
+{
+	SimulatedTimeSource timeSource;
+	FrameClock clock(timeSource);
+	clock.setFixedStepRate(100.0f);
+	timeSource.advance(4000);
+	FrameTime frameTime = clock.tick();
+	CHECK(frameTime.numberOfSteps == 0);
+	CHECK(std::fabs(frameTime.stepSeconds - 0.01f) < 1e-7f);
+	CHECK(std::fabs(frameTime.interpolationFactor - 0.4f) < 1e-6f);
+	timeSource.advance(17000);
+	frameTime = clock.tick();
+	CHECK(frameTime.numberOfSteps == 2);
+	CHECK(std::fabs(frameTime.interpolationFactor - 0.1f) < 1e-6f);
+	timeSource.advance(9000);
+	frameTime = clock.tick();
+	CHECK(frameTime.numberOfSteps == 1);
+	CHECK(frameTime.interpolationFactor == 0.0f);
+	// switching the rate starts accumulating anew
+	timeSource.advance(5000);
+	clock.setFixedStepRate(50.0f);
+	timeSource.advance(5000);
+	frameTime = clock.tick();
+	CHECK(frameTime.numberOfSteps == 0);
+	CHECK(std::fabs(frameTime.interpolationFactor - 0.5f) < 1e-6f);
+	// as does a reset
+	timeSource.advance(15000);
+	clock.reset();
+	timeSource.advance(10000);
+	CHECK(std::fabs(clock.tick().interpolationFactor - 0.5f) < 1e-6f);
+}
+
+
+// With fixed steps every tick rate simulates the same steps, and the interpolated position follows the time one step behind. The steps
+// aren't bit for bit the same, as the camera keeps them in floats relative to the position written last, which depends on the tick rate.
+IGCS_TEST(FrameClock, FixedStepsAreDeterministicAndInterpolated)
+{
+	const std::vector<std::vector<int64_t>> tickIntervals = { { 1000 }, { 6944 }, { 16667 }, { 33333 }, { 3000, 11000, 7500, 500, 20000 } };
+	const int64_t totalTime = 1234567;
+	const double speed = 10.0;
+	const double stepSeconds = 1.0 / 60.0;
+	MovingCamera reference = runCamera(60.0f, tickIntervals[0], totalTime);
+	for (const std::vector<int64_t>& intervals : tickIntervals)
+	{
+		MovingCamera camera = runCamera(60.0f, intervals, totalTime);
+		CHECK(distancesMatch(camera.stepDistances, reference.stepDistances, 1e-4));
+		double expected = speed * (static_cast<double>(totalTime) / 1000000.0 - stepSeconds);
+		CHECK(std::fabs(camera.distance - expected) < 1e-3);
+	}
+	CHECK(reference.stepDistances.size() == static_cast<size_t>(totalTime / 16667));
+}
+
+
+IGCS_TEST(FrameClock, WaitsForTheNextTick)
+{
+	SimulatedTimeSource timeSource;
+	FrameClock clock(timeSource);
+	clock.setTickRate(250.0f);
+	clock.tick();
+	CHECK(clock.microsecondsTillNextTick() == 4000);
+	timeSource.advance(1500);
+	CHECK(clock.microsecondsTillNextTick() == 2500);
+	timeSource.advance(10000);
+	CHECK(clock.microsecondsTillNextTick() == 0);
+	// discarding the elapsed time waits a whole interval again, and the discarded time isn't simulated.
+	clock.discardElapsedTime();
+	CHECK(clock.microsecondsTillNextTick() == 4000);
+	timeSource.advance(2000);
+	CHECK(std::fabs(clock.tick().deltaSeconds - 0.002f) < 1e-7f);
+}
@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "GamepadResponse.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace IGCS;
+
+namespace
+{
+	const float PI = 3.14159265f;
+	// The table is interpolated linearly on the squared distance, this is how far it may be off from the exact response. An exponent below 1
+	// makes the curve very steep right past the deadzone, where the interpolation is further off.
+	const float TABLE_TOLERANCE = 0.005f;
+	const float STEEP_CURVE_TABLE_TOLERANCE = 0.02f;
+
+	struct ResponseSettings
+	{
+		float innerDeadzone;
+		float outerDeadzone;
+		float curveExponent;
+	};
+
+	const ResponseSettings SETTINGS[] = {
+		{ 0.0f, 1.0f, 1.0f },
+		{ 0.24f, 0.95f, 1.0f },
+		{ 0.24f, 0.95f, 2.0f },
+		{ 0.1f, 0.8f, 3.0f },
+		{ 0.3f, 1.0f, 0.5f },
+	};
+
+
+	// The response for a normalized distance, calculated without tables.
+	float exactResponse(float distance, const ResponseSettings& settings)
+	{
+		if (distance <= settings.innerDeadzone)
+		{
+			return 0.0f;
+		}
+		const float rescaled = (std::min)((distance - settings.innerDeadzone) / (settings.outerDeadzone - settings.innerDeadzone), 1.0f);
+		return std::pow(rescaled, settings.curveExponent);
+	}
+
+
+	int16_t toRaw(float normalized)
+	{
+		return static_cast<int16_t>(std::lround(normalized * 32767.0f));
+	}
+
+
+	float normalizedDistance(int16_t rawX, int16_t rawY)
+	{
+		return std::hypot(static_cast<float>(rawX), static_cast<float>(rawY)) / 32767.0f;
+	}
+}
+
+
+IGCS_TEST(GamepadResponse, StickIsAtRestInsideTheDeadzone)
+{
+	StickResponse response;
+	response.configure(0.24f, 0.95f, 1.0f);
+	for (int angleStep = 0; angleStep < 64; angleStep++)
+	{
+		const float angle = 2.0f * PI * static_cast<float>(angleStep) / 64.0f;
+		for (float distance = 0.0f; distance < 0.239f; distance += 0.001f)
+		{
+			const int16_t rawX = toRaw(distance * std::cos(angle));
+			const int16_t rawY = toRaw(distance * std::sin(angle));
+			float x = 1.0f;
+			float y = 1.0f;
+			response.apply(rawX, rawY, x, y);
+			CHECK(x == 0.0f);
+			CHECK(y == 0.0f);
+		}
+	}
+}
+
+
+// Past the deadzone the response starts at 0 again, beyond the outer deadzone the stick is fully pushed.
+IGCS_TEST(GamepadResponse, StickIsRescaledToTheFullRange)
+{
+	StickResponse response;
+	response.configure(0.24f, 0.95f, 1.0f);
+	for (int angleStep = 0; angleStep < 64; angleStep++)
+	{
+		const float angle = 2.0f * PI * static_cast<float>(angleStep) / 64.0f;
+		float x, y;
+		response.apply(toRaw(0.245f * std::cos(angle)), toRaw(0.245f * std::sin(angle)), x, y);
+		CHECK(std::hypot(x, y) < 0.02f);
+		response.apply(toRaw(0.96f * std::cos(angle)), toRaw(0.96f * std::sin(angle)), x, y);
+		CHECK(std::fabs(std::hypot(x, y) - 1.0f) < TABLE_TOLERANCE);
+	}
+	float x, y;
+	response.apply(32767, 0, x, y);
+	CHECK(x == 1.0f);
+	CHECK(y == 0.0f);
+	// -32768 is clamped to the range of the positive half
+	response.apply(0, -32768, x, y);
+	CHECK(x == 0.0f);
+	CHECK(y == -1.0f);
+	// in the corners the axes stay within [-1, 1]
+	response.apply(-32768, 32767, x, y);
+	CHECK(x >= -1.0f && x < 0.0f);
+	CHECK(y <= 1.0f && y > 0.0f);
+}
+
+
+IGCS_TEST(GamepadResponse, StickKeepsTheDirection)
+{
+	for (const ResponseSettings& settings : SETTINGS)
+	{
+		StickResponse response;
+		response.configure(settings.innerDeadzone, settings.outerDeadzone, settings.curveExponent);
+		for (int angleStep = 0; angleStep < 360; angleStep++)
+		{
+			const float angle = 2.0f * PI * static_cast<float>(angleStep) / 360.0f;
+			const int16_t rawX = toRaw(0.7f * std::cos(angle));
+			const int16_t rawY = toRaw(0.7f * std::sin(angle));
+			float x, y;
+			response.apply(rawX, rawY, x, y);
+			const float rawAngle = std::atan2(static_cast<float>(rawY), static_cast<float>(rawX));
+			CHECK(std::fabs(std::remainder(std::atan2(y, x) - rawAngle, 2.0f * PI)) < 1e-5f);
+		}
+	}
+}
+
+
+IGCS_TEST(GamepadResponse, StickResponseIsMonotonic)
+{
+	for (const ResponseSettings& settings : SETTINGS)
+	{
+		StickResponse response;
+		response.configure(settings.innerDeadzone, settings.outerDeadzone, settings.curveExponent);
+		for (int angleStep = 0; angleStep < 16; angleStep++)
+		{
+			const float angle = 2.0f * PI * static_cast<float>(angleStep) / 16.0f;
+			float previousMagnitude = 0.0f;
+			for (int rawDistance = 0; rawDistance <= 32767; rawDistance += 7)
+			{
+				float x, y;
+				response.apply(static_cast<int16_t>(std::lround(rawDistance * std::cos(angle))), static_cast<int16_t>(std::lround(rawDistance * std::sin(angle))), x, y);
+				const float magnitude = std::hypot(x, y);
+				CHECK(magnitude >= previousMagnitude - 1e-6f);
+				previousMagnitude = magnitude;
+			}
+		}
+	}
+}
+
+
+IGCS_TEST(GamepadResponse, StickTableMatchesTheExactCurve)
+{
+	for (const ResponseSettings& settings : SETTINGS)
+	{
+		StickResponse response;
+		response.configure(settings.innerDeadzone, settings.outerDeadzone, settings.curveExponent);
+		float largestError = 0.0f;
+		for (int rawX = -32767; rawX <= 32767; rawX += 251)
+		{
+			for (int rawY = -32767; rawY <= 32767; rawY += 257)
+			{
+				const float distance = normalizedDistance(static_cast<int16_t>(rawX), static_cast<int16_t>(rawY));
+				if (distance > 1.0f)
+				{
+					// the corners are clamped per axis
+					continue;
+				}
+				float x, y;
+				response.apply(static_cast<int16_t>(rawX), static_cast<int16_t>(rawY), x, y);
+				largestError = (std::max)(largestError, std::fabs(std::hypot(x, y) - exactResponse(distance, settings)));
+			}
+		}
+		CHECK(largestError < (settings.curveExponent < 1.0f ? STEEP_CURVE_TABLE_TOLERANCE : TABLE_TOLERANCE));
+	}
+}
+
+
+IGCS_TEST(GamepadResponse, TriggerTableIsTheExactCurve)
+{
+	for (const ResponseSettings& settings : SETTINGS)
+	{
+		TriggerResponse response;
+		response.configure(settings.innerDeadzone, settings.outerDeadzone, settings.curveExponent);
+		float previous = 0.0f;
+		for (int raw = 0; raw < 256; raw++)
+		{
+			const float value = response.apply(static_cast<uint8_t>(raw));
+			const float distance = static_cast<float>(raw) / 255.0f;
+			CHECK(std::fabs(value - exactResponse(distance, settings)) < 1e-6f);
+			if (distance <= settings.innerDeadzone)
+			{
+				CHECK(value == 0.0f);
+			}
+			if (distance >= settings.outerDeadzone)
+			{
+				CHECK(value == 1.0f);
+			}
+			CHECK(value >= previous);
+			previous = value;
+		}
+	}
+	// the default is linear without deadzones
+	TriggerResponse linear;
+	for (int raw = 0; raw < 256; raw++)
+	{
+		CHECK(std::fabs(linear.apply(static_cast<uint8_t>(raw)) - static_cast<float>(raw) / 255.0f) < 1e-6f);
+	}
+}
+
+
+// Settings out of range are clamped, so the responses stay within range and monotonic.
+IGCS_TEST(GamepadResponse, ClampsSettingsOutOfRange)
+{
+	TriggerResponse trigger;
+	trigger.configure(0.95f, 0.5f, 0.0f);		// inner becomes 0.9, outer 0.95, the exponent 0.1
+	CHECK(trigger.apply(229) == 0.0f);
+	CHECK(trigger.apply(230) > 0.0f);
+	CHECK(trigger.apply(243) == 1.0f);
+	StickResponse stick;
+	stick.configure(-1.0f, 5.0f, 100.0f);		// inner becomes 0, outer 1, the exponent 10
+	float x, y;
+	stick.apply(16384, 0, x, y);
+	CHECK(std::fabs(x - std::pow(16384.0f / 32767.0f, 10.0f)) < TABLE_TOLERANCE);
+	stick.apply(32767, 0, x, y);
+	CHECK(x == 1.0f);
+}
@@ -0,0 +1,319 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "HookTransaction.h"
+#include <cstring>
+
+using namespace IGCS;
+
+namespace
+{
+	// A buffer standing in for the game's code, with recognizable original bytes.
+	std::vector<uint8_t> createCode(size_t size)
+	{
+		std::vector<uint8_t> toReturn(size);
+		for (size_t i = 0; i < size; i++)
+		{
+			toReturn[i] = static_cast<uint8_t>(i * 7 + 3);
+		}
+		return toReturn;
+	}
+
+	const uint8_t JUMP_BYTES[] = { 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+	const uint8_t NOP_BYTES[] = { 0x90, 0x90, 0x90 };
+}
+
+
+IGCS_TEST(HookTransaction, AppliesAllPatchesInOneBatch)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookTransaction transaction;
+	transaction.stagePatch(&code[100], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	transaction.stagePatch(&code[20], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	REQUIRE(transaction.validate());
+	// validating doesn't write anything.
+	CHECK(code == createCode(256));
+	transaction.apply();
+	CHECK(transaction.isApplied());
+	CHECK(memcmp(&code[100], JUMP_BYTES, sizeof(JUMP_BYTES)) == 0);
+	CHECK(memcmp(&code[20], NOP_BYTES, sizeof(NOP_BYTES)) == 0);
+	CHECK(transaction.codeRangeStart() == &code[20]);
+	CHECK(transaction.codeRangeLength() == 100 + sizeof(JUMP_BYTES) - 20);
+	// validating again would store the patched bytes as the original ones.
+	CHECK(!transaction.validate());
+}
+
+
+IGCS_TEST(HookTransaction, RollbackRestoresTheOriginalBytes)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookTransaction transaction;
+	transaction.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	transaction.stagePatch(&code[30], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	REQUIRE(transaction.validate());
+	CHECK(!transaction.validateRollback());
+	transaction.apply();
+	REQUIRE(transaction.validateRollback());
+	transaction.restore();
+	CHECK(!transaction.isApplied());
+	CHECK(code == createCode(256));
+}
+
+
+IGCS_TEST(HookTransaction, DoesntRollBackPatchesOverwrittenBySomeoneElse)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookTransaction transaction;
+	transaction.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	REQUIRE(transaction.validate());
+	transaction.apply();
+	code[15] = 0xCC;
+	CHECK(!transaction.validateRollback());
+	CHECK(!transaction.lastError().empty());
+}
+
+
+IGCS_TEST(HookTransaction, WritesNothingIfTheExpectedBytesDiffer)
+{
+	std::vector<uint8_t> code = createCode(256);
+	std::vector<uint8_t> expectedBytes(code.begin() + 40, code.begin() + 56);
+	expectedBytes[3] ^= 0xFF;		// skipped by the mask
+	const char* mask = "xxx?xxxxxxxxxxxx";
+	HookTransaction transaction;
+	transaction.stagePatch(&code[10], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	transaction.stagePatch(&code[44], JUMP_BYTES, sizeof(JUMP_BYTES), &code[40], expectedBytes.data(), mask, expectedBytes.size(), "hook");
+	CHECK(transaction.validate());
+
+	// the game's code changed after it was scanned.
+	code[50] ^= 0xFF;
+	std::vector<uint8_t> changedCode = code;
+	HookTransaction changedTransaction;
+	changedTransaction.stagePatch(&code[10], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	changedTransaction.stagePatch(&code[44], JUMP_BYTES, sizeof(JUMP_BYTES), &code[40], expectedBytes.data(), mask, expectedBytes.size(), "hook");
+	CHECK(!changedTransaction.validate());
+	CHECK(changedTransaction.lastError().find("hook") != std::string::npos);
+	CHECK(code == changedCode);
+}
+
+
+IGCS_TEST(HookTransaction, RefusesOverlappingAndIncompletePatches)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookTransaction overlapping;
+	overlapping.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	overlapping.stagePatch(&code[10 + sizeof(JUMP_BYTES) - 1], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	CHECK(!overlapping.validate());
+	HookTransaction adjacent;
+	adjacent.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	adjacent.stagePatch(&code[10 + sizeof(JUMP_BYTES)], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	CHECK(adjacent.validate());
+	HookTransaction withoutAddress;
+	withoutAddress.stagePatch(nullptr, NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	CHECK(!withoutAddress.validate());
+	// a patch which couldn't be created fails the whole transaction.
+	HookTransaction failed;
+	failed.stagePatch(&code[10], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	failed.fail("no stub");
+	CHECK(!failed.validate());
+	CHECK(failed.lastError() == "no stub");
+}
+
+
+IGCS_TEST(HookTransaction, ReturnsEveryPageToUnprotectOnce)
+{
+	HookTransaction transaction;
+	uint8_t* base = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(0x10000));
+	transaction.stagePatch(base + 0x0FF8, JUMP_BYTES, sizeof(JUMP_BYTES), "crosses a page boundary");
+	transaction.stagePatch(base + 0x1100, NOP_BYTES, sizeof(NOP_BYTES), "same page");
+	transaction.stagePatch(base + 0x5000, NOP_BYTES, sizeof(NOP_BYTES), "other page");
+	std::vector<uintptr_t> pages = transaction.pagesToUnprotect(0x1000);
+	CHECK(pages == (std::vector<uintptr_t>{ 0x10000, 0x11000, 0x15000 }));
+}
+
+
+IGCS_TEST(HookTransaction, KnowsWhichInstructionsAPatchSplits)
+{
+	std::vector<uint8_t> code = createCode(64);
+	HookTransaction transaction;
+	transaction.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	// a thread at the start of the patch executes either the old or the new instruction, one inside it would execute a mix.
+	CHECK(!transaction.isInsidePatch(&code[10]));
+	CHECK(transaction.isInsidePatch(&code[11]));
+	CHECK(transaction.isInsidePatch(&code[10 + sizeof(JUMP_BYTES) - 1]));
+	CHECK(!transaction.isInsidePatch(&code[10 + sizeof(JUMP_BYTES)]));
+	CHECK(!transaction.isInsidePatch(&code[9]));
+}
+
+
+IGCS_TEST(HookTransaction, OwnsTheStubsItsPatchesJumpTo)
+{
+	std::vector<uint8_t> stubMemory(128);
+	HookTransaction transaction;
+	transaction.addStub(&stubMemory[32], 48);
+	CHECK(transaction.stubs().size() == 1);
+	CHECK(!transaction.isInsideStub(&stubMemory[31]));
+	CHECK(transaction.isInsideStub(&stubMemory[32]));
+	CHECK(transaction.isInsideStub(&stubMemory[79]));
+	CHECK(!transaction.isInsideStub(&stubMemory[80]));
+	// the journal's copy owns them too, so they can be released when the dll is unloaded.
+	HookTransaction copy = transaction;
+	CHECK(copy.isInsideStub(&stubMemory[40]));
+	transaction.clear();
+	CHECK(transaction.stubs().empty());
+}
+
+
+namespace
+{
+	// Does what GameImageHooker does for a transaction, minus the memory protection: validate and apply, then record it in the journal.
+	bool commit(HookJournal& journal, HookTransaction& transaction)
+	{
+		if (!transaction.validate() || !journal.canRecord(transaction))
+		{
+			return false;
+		}
+		transaction.apply();
+		return journal.record(transaction);
+	}
+
+
+	// The rollback GameImageHooker::removeAllHooks does when the dll is unloaded, minus the memory protection.
+	bool restoreForUnload(HookTransaction& transaction)
+	{
+		if (!transaction.validateRollback())
+		{
+			return false;
+		}
+		transaction.restore();
+		return true;
+	}
+}
+
+
+IGCS_TEST(HookJournal, UnloadRestoresTheOriginalBytes)
+{
+	std::vector<uint8_t> code = createCode(512);
+	std::vector<uint8_t> expectedBytes(code.begin() + 200, code.begin() + 216);
+	HookJournal journal;
+	HookTransaction hooks;
+	hooks.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook 1");
+	hooks.stagePatch(&code[200], JUMP_BYTES, sizeof(JUMP_BYTES), &code[200], expectedBytes.data(), "xxxxxxxxxxxxxxxx", expectedBytes.size(), "hook 2");
+	REQUIRE(commit(journal, hooks));
+	HookTransaction nops;
+	nops.stagePatch(&code[100], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	REQUIRE(commit(journal, nops));
+	HookTransaction range;
+	range.stagePatch(&code[400], NOP_BYTES, sizeof(NOP_BYTES), "range");
+	REQUIRE(commit(journal, range));
+	CHECK(journal.numberOfTransactions() == 3);
+	CHECK(code != createCode(512));
+
+	CHECK(journal.rollbackAll(&restoreForUnload) == 0);
+	CHECK(journal.numberOfTransactions() == 0);
+	CHECK(code == createCode(512));
+}
+
+
+IGCS_TEST(HookJournal, RefusesTransactionsWhichOverlapRecordedOnes)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookJournal journal;
+	HookTransaction hook;
+	hook.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "hook");
+	REQUIRE(commit(journal, hook));
+	// writing over the hook would make its original bytes the hook's bytes for the second transaction.
+	HookTransaction overHook;
+	overHook.stagePatch(&code[12], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	REQUIRE(overHook.validate());
+	CHECK(!journal.canRecord(overHook));
+	overHook.apply();
+	CHECK(!journal.record(overHook));
+	overHook.restore();
+	CHECK(journal.numberOfTransactions() == 1);
+	HookTransaction nextToHook;
+	nextToHook.stagePatch(&code[10 + sizeof(JUMP_BYTES)], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	CHECK(commit(journal, nextToHook));
+	// not applied: nothing to roll back.
+	HookTransaction notApplied;
+	notApplied.stagePatch(&code[100], NOP_BYTES, sizeof(NOP_BYTES), "nops");
+	CHECK(!journal.record(notApplied));
+	CHECK(journal.numberOfTransactions() == 2);
+}
+
+
+IGCS_TEST(HookJournal, ForgetsTheTransactionRolledBackByItsOwner)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookJournal journal;
+	HookTransaction first;
+	first.stagePatch(&code[10], NOP_BYTES, sizeof(NOP_BYTES), "first");
+	REQUIRE(commit(journal, first));
+	HookTransaction second;
+	second.stagePatch(&code[50], NOP_BYTES, sizeof(NOP_BYTES), "second");
+	REQUIRE(commit(journal, second));
+	CHECK(first.id() != second.id());
+
+	// the owner rolls back the first one and applies it again, e.g. when a hook is toggled.
+	HookTransaction firstApplication = first;
+	REQUIRE(restoreForUnload(first));
+	journal.forget(first);
+	CHECK(journal.numberOfTransactions() == 1);
+	REQUIRE(commit(journal, first));
+	CHECK(first.id() != firstApplication.id());
+	// a copy of the earlier application doesn't match the current one.
+	journal.forget(firstApplication);
+	CHECK(journal.numberOfTransactions() == 2);
+	REQUIRE(restoreForUnload(second));
+	journal.forget(second);
+	CHECK(journal.numberOfTransactions() == 1);
+	CHECK(journal.rollbackAll(&restoreForUnload) == 0);
+	CHECK(code == createCode(256));
+}
+
+
+IGCS_TEST(HookJournal, KeepsTransactionsWhichCouldntBeRolledBack)
+{
+	std::vector<uint8_t> code = createCode(256);
+	HookJournal journal;
+	HookTransaction overwritten;
+	overwritten.stagePatch(&code[10], JUMP_BYTES, sizeof(JUMP_BYTES), "overwritten");
+	REQUIRE(commit(journal, overwritten));
+	HookTransaction intact;
+	intact.stagePatch(&code[100], NOP_BYTES, sizeof(NOP_BYTES), "intact");
+	REQUIRE(commit(journal, intact));
+	// another tool patched our hook.
+	code[12] = 0xCC;
+
+	CHECK(journal.rollbackAll(&restoreForUnload) == 1);
+	CHECK(journal.numberOfTransactions() == 1);
+	CHECK(memcmp(&code[100], &createCode(256)[100], sizeof(NOP_BYTES)) == 0);
+	// once the other tool has removed its patch, a next unload attempt succeeds.
+	code[12] = JUMP_BYTES[2];
+	CHECK(journal.rollbackAll(&restoreForUnload) == 0);
+	CHECK(code == createCode(256));
+}
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "InstructionDecoder.h"
+#include <vector>
+
+using namespace IGCS;
+
+namespace
+{
+	// An encoded instruction with the fields the decoder has to find in it. -1 means the instruction doesn't have the field.
+	struct CorpusEntry
+	{
+		const char* description;
+		std::vector<uint8_t> bytes;
+		int prefixCount;
+		int opcodeOffset;
+		int modRMOffset;
+		int sibOffset;
+		int displacementOffset;
+		int displacementSize;
+		int immediateOffset;
+		int immediateSize;
+		bool isRipRelative;
+		bool isRelativeBranch;
+	};
+
+	const std::vector<CorpusEntry> CORPUS = {
+		//  description							bytes																		pfx	opc	mrm	sib	dsp	dsz	imm	isz	rip		branch
+		{ "nop",								{ 0x90 },																	0,	0,	-1,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "ret",								{ 0xC3 },																	0,	0,	-1,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "mov rax, rbx",						{ 0x48, 0x8B, 0xC3 },														1,	1,	2,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "mov rax, [rip+d32]",					{ 0x48, 0x8B, 0x05, 0x11, 0x22, 0x33, 0x44 },								1,	1,	2,	-1,	3,	4,	-1,	0,	true,	false },
+		{ "mov eax, [rsp+20h]",					{ 0x8B, 0x44, 0x24, 0x20 },													0,	0,	1,	2,	3,	1,	-1,	0,	false,	false },
+		{ "mov eax, [d32]",						{ 0x8B, 0x04, 0x25, 0x78, 0x56, 0x34, 0x12 },								0,	0,	1,	2,	3,	4,	-1,	0,	false,	false },
+		{ "mov rax, [rax+rcx*8+100h]",			{ 0x48, 0x8B, 0x84, 0xC8, 0x00, 0x01, 0x00, 0x00 },							1,	1,	2,	3,	4,	4,	-1,	0,	false,	false },
+		{ "mov [r14+2FBh], bl",				{ 0x41, 0x88, 0x9E, 0xFB, 0x02, 0x00, 0x00 },								1,	1,	2,	-1,	3,	4,	-1,	0,	false,	false },
+		{ "mov [rcx+44h], ax",					{ 0x66, 0x89, 0x41, 0x44 },													1,	1,	2,	-1,	3,	1,	-1,	0,	false,	false },
+		{ "mov word [rcx+10h], 1234h",			{ 0x66, 0xC7, 0x41, 0x10, 0x34, 0x12 },										1,	1,	2,	-1,	3,	1,	4,	2,	false,	false },
+		{ "mov dword [rcx+10h], imm32",			{ 0xC7, 0x41, 0x10, 0x78, 0x56, 0x34, 0x12 },								0,	0,	1,	-1,	2,	1,	3,	4,	false,	false },
+		{ "mov qword [rcx+10h], imm32",			{ 0x48, 0xC7, 0x41, 0x10, 0x78, 0x56, 0x34, 0x12 },							1,	1,	2,	-1,	3,	1,	4,	4,	false,	false },
+		{ "mov eax, imm32",						{ 0xB8, 0x78, 0x56, 0x34, 0x12 },											0,	0,	-1,	-1,	-1,	0,	1,	4,	false,	false },
+		{ "mov ax, imm16",						{ 0x66, 0xB8, 0x34, 0x12 },													1,	1,	-1,	-1,	-1,	0,	2,	2,	false,	false },
+		{ "mov rax, imm64",						{ 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 },										1,	1,	-1,	-1,	-1,	0,	2,	8,	false,	false },
+		{ "mov rax, [moffs64]",					{ 0x48, 0xA1, 1, 2, 3, 4, 5, 6, 7, 8 },										1,	1,	-1,	-1,	-1,	0,	2,	8,	false,	false },
+		{ "mov eax, [moffs32]",					{ 0x67, 0xA1, 1, 2, 3, 4 },													1,	1,	-1,	-1,	-1,	0,	2,	4,	false,	false },
+		{ "test cl, 1",							{ 0xF6, 0xC1, 0x01 },														0,	0,	1,	-1,	-1,	0,	2,	1,	false,	false },
+		{ "test ecx, imm32",					{ 0xF7, 0xC1, 0x78, 0x56, 0x34, 0x12 },										0,	0,	1,	-1,	-1,	0,	2,	4,	false,	false },
+		{ "neg eax",							{ 0xF7, 0xD8 },																0,	0,	1,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "call rel32",							{ 0xE8, 0x10, 0x20, 0x30, 0x40 },											0,	0,	-1,	-1,	-1,	0,	1,	4,	false,	true },
+		{ "je rel8",							{ 0x74, 0x0A },																0,	0,	-1,	-1,	-1,	0,	1,	1,	false,	true },
+		{ "je rel32",							{ 0x0F, 0x84, 0x10, 0x20, 0x30, 0x40 },										0,	0,	-1,	-1,	-1,	0,	2,	4,	false,	true },
+		{ "xbegin rel32",						{ 0xC7, 0xF8, 0x10, 0x20, 0x30, 0x40 },										0,	0,	1,	-1,	-1,	0,	2,	4,	false,	true },
+		{ "call [rip+d32]",						{ 0xFF, 0x15, 0x10, 0x20, 0x30, 0x40 },										0,	0,	1,	-1,	2,	4,	-1,	0,	true,	false },
+		{ "call [rax+258h]",					{ 0xFF, 0x90, 0x58, 0x02, 0x00, 0x00 },										0,	0,	1,	-1,	2,	4,	-1,	0,	false,	false },
+		{ "movss [rsi+20h], xmm0",				{ 0xF3, 0x0F, 0x11, 0x46, 0x20 },											1,	1,	3,	-1,	4,	1,	-1,	0,	false,	false },
+		{ "movss xmm11, [rip+d32]",				{ 0xF3, 0x44, 0x0F, 0x10, 0x1D, 0x10, 0x20, 0x30, 0x40 },					2,	2,	4,	-1,	5,	4,	-1,	0,	true,	false },
+		{ "palignr xmm0, xmm1, 8",				{ 0x66, 0x0F, 0x3A, 0x0F, 0xC1, 0x08 },										1,	1,	4,	-1,	-1,	0,	5,	1,	false,	false },
+		{ "pshufb xmm0, [rax]",					{ 0x66, 0x0F, 0x38, 0x00, 0x00 },											1,	1,	4,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "lock cmpxchg [rdx], rcx",			{ 0xF0, 0x48, 0x0F, 0xB1, 0x0A },											2,	2,	4,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "mov rax, cr0",						{ 0x0F, 0x20, 0x05 },														0,	0,	2,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "pop [rsp]",							{ 0x8F, 0x04, 0x24 },														0,	0,	1,	2,	-1,	0,	-1,	0,	false,	false },
+		{ "vzeroupper",							{ 0xC5, 0xF8, 0x77 },														0,	2,	-1,	-1,	-1,	0,	-1,	0,	false,	false },
+		{ "vmovss xmm0, [rip+d32]",				{ 0xC5, 0xFA, 0x10, 0x05, 0x10, 0x20, 0x30, 0x40 },							0,	2,	3,	-1,	4,	4,	-1,	0,	true,	false },
+		{ "vpermilps xmm0, xmm0, 1",			{ 0xC4, 0xE3, 0x79, 0x04, 0xC0, 0x01 },										0,	3,	4,	-1,	-1,	0,	5,	1,	false,	false },
+		{ "vmovups zmm0, [rip+d32]",			{ 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x05, 0x10, 0x20, 0x30, 0x40 },				0,	4,	5,	-1,	6,	4,	-1,	0,	true,	false },
+		{ "vprotb xmm0, xmm0, 5",				{ 0x8F, 0xE8, 0x78, 0xC0, 0xC0, 0x05 },										0,	3,	4,	-1,	-1,	0,	5,	1,	false,	false },
+	};
+
+
+	// The bytes at the hook locations of the Cyberpunk 2077 camera, from the patterns in InterceptorHelper.cpp.
+	const std::vector<uint8_t> ACTIVECAM_ADDRESS_CODE = { 0xFF, 0x90, 0x58, 0x02, 0x00, 0x00, 0xF3, 0x0F, 0x11, 0x46, 0x20, 0x48, 0x8D, 0x54, 0x24, 0x20, 0x48, 0x8B, 0x03, 0x48, 0x8B, 0xCB };
+	const std::vector<uint8_t> ACTIVECAM_CAMERA_WRITE1_CODE = { 0xF2, 0x0F, 0x11, 0x83, 0xE0, 0x00, 0x00, 0x00, 0x0F, 0x28, 0x44, 0x24, 0x30, 0x89, 0x8B, 0xE8, 0x00, 0x00, 0x00, 0x0F, 0x11, 0x83, 0xF0, 0x00, 0x00, 0x00 };
+	const std::vector<uint8_t> PMSTRUCT_ADDRESS_CODE = { 0x49, 0x8B, 0x4E, 0x40, 0x48, 0x8D, 0x95, 0x90, 0x00, 0x00, 0x00, 0x41, 0x88, 0x9E, 0xFB, 0x02, 0x00, 0x00 };
+	const std::vector<uint8_t> RESOLUTION_STRUCT_ADDRESS_CODE = { 0x8B, 0x81, 0x84, 0x00, 0x00, 0x00, 0x89, 0x41, 0x44, 0x8B, 0x81, 0x88, 0x00, 0x00, 0x00, 0x89, 0x41, 0x40 };
+	const std::vector<uint8_t> TOD_READ_CODE = { 0x48, 0x8B, 0xDA, 0x48, 0x8B, 0x01, 0xFF, 0x90, 0xF8, 0x00, 0x00, 0x00, 0x48, 0x8B, 0xC3 };
+	const std::vector<uint8_t> PLAY_WIDGETBUCKET_READ_CODE = { 0x88, 0x81, 0xB1, 0x00, 0x00, 0x00, 0x48, 0x89, 0xBC, 0x24, 0x98, 0x00, 0x00, 0x00, 0x48, 0x8B, 0x7C, 0x24, 0x20 };
+	const std::vector<uint8_t> PM_WIDGETBUCKET_READ_CODE = { 0x74, 0x0A, 0x80, 0x7A, 0x40, 0x00, 0x74, 0x04, 0xB3, 0x01, 0xEB, 0x02, 0x32, 0xDB, 0x48, 0x8B, 0x49, 0x40, 0x0F, 0xB6, 0xD3 };
+	const std::vector<uint8_t> FOV_PLAY_WRITE_CODE = { 0xF3, 0x0F, 0x11, 0x9F, 0x5C, 0x02, 0x00, 0x00, 0x48, 0x8B, 0x8F, 0xB0, 0x01, 0x00, 0x00 };
+	// jmp qword ptr [0000] followed by the 8 byte address, which is what GameImageHooker writes at a hook location.
+	const int HOOK_INSTRUCTION_LENGTH = 14;
+}
+
+
+IGCS_TEST(InstructionDecoder, DecodesTheFieldsOfTheCorpus)
+{
+	for (const CorpusEntry& entry : CORPUS)
+	{
+		DecodedInstruction instruction;
+		REQUIRE(InstructionDecoder::decode(entry.bytes.data(), entry.bytes.size(), instruction));
+		const bool fieldsMatch = instruction.length == static_cast<int>(entry.bytes.size()) && instruction.prefixCount == entry.prefixCount &&
+								 instruction.opcodeOffset == entry.opcodeOffset && instruction.modRMOffset == entry.modRMOffset &&
+								 instruction.sibOffset == entry.sibOffset && instruction.displacementSize == entry.displacementSize &&
+								 (entry.displacementSize == 0 || instruction.displacementOffset == entry.displacementOffset) &&
+								 instruction.immediateSize == entry.immediateSize &&
+								 (entry.immediateSize == 0 || instruction.immediateOffset == entry.immediateOffset) &&
+								 instruction.isRipRelative == entry.isRipRelative && instruction.isRelativeBranch == entry.isRelativeBranch;
+		if (!fieldsMatch)
+		{
+			printf("  %s decoded as: length %d, prefixes %d, opcode %d, modrm %d, sib %d, displacement %d/%d, immediate %d/%d, rip %d, branch %d\n",
+				   entry.description, instruction.length, instruction.prefixCount, instruction.opcodeOffset, instruction.modRMOffset, instruction.sibOffset,
+				   instruction.displacementOffset, instruction.displacementSize, instruction.immediateOffset, instruction.immediateSize,
+				   instruction.isRipRelative, instruction.isRelativeBranch);
+		}
+		CHECK(fieldsMatch);
+		CHECK(instruction.isPositionDependent() == (entry.isRipRelative || entry.isRelativeBranch));
+	}
+}
+
+
+// Bytes past the instruction aren't read, and an instruction which doesn't fit in the available bytes isn't decoded.
+IGCS_TEST(InstructionDecoder, RejectsTruncatedInstructions)
+{
+	for (const CorpusEntry& entry : CORPUS)
+	{
+		std::vector<uint8_t> followedByGarbage(entry.bytes);
+		followedByGarbage.insert(followedByGarbage.end(), { 0x0F, 0x0F, 0x0F, 0x0F });
+		DecodedInstruction instruction;
+		CHECK(InstructionDecoder::decode(followedByGarbage.data(), followedByGarbage.size(), instruction));
+		CHECK(instruction.length == static_cast<int>(entry.bytes.size()));
+		for (size_t available = 0; available < entry.bytes.size(); available++)
+		{
+			CHECK(!InstructionDecoder::decode(entry.bytes.data(), available, instruction));
+		}
+	}
+}
+
+
+IGCS_TEST(InstructionDecoder, RejectsInvalidInstructions)
+{
+	const std::vector<std::vector<uint8_t>> invalidInstructions = {
+		{ 0x06 },					// push es
+		{ 0x27 },					// daa
+		{ 0x9A, 1, 2, 3, 4, 5, 6 },	// call far ptr16:32
+		{ 0x0F, 0x04 },
+		{ 0xC4, 0xE0, 0x79, 0x10, 0xC0 },	// VEX with map 0
+	};
+	for (const auto& bytes : invalidInstructions)
+	{
+		DecodedInstruction instruction;
+		CHECK(!InstructionDecoder::decode(bytes.data(), bytes.size(), instruction));
+	}
+
+	// 14 prefixes and an opcode is the longest an instruction can be, one more prefix makes it too long.
+	std::vector<uint8_t> prefixedNop(14, 0x66);
+	prefixedNop.push_back(0x90);
+	DecodedInstruction instruction;
+	CHECK(InstructionDecoder::decode(prefixedNop.data(), prefixedNop.size(), instruction));
+	CHECK(instruction.length == InstructionDecoder::MAX_INSTRUCTION_LENGTH);
+	CHECK(instruction.prefixCount == 14);
+	prefixedNop.insert(prefixedNop.begin(), 0x66);
+	CHECK(!InstructionDecoder::decode(prefixedNop.data(), prefixedNop.size(), instruction));
+}
+
+
+// REX.W takes precedence over the 66 operand size prefix.
+IGCS_TEST(InstructionDecoder, RexWOverridesTheOperandSizePrefix)
+{
+	const uint8_t rexInFront[] = { 0x66, 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 };		// mov rax, imm64
+	DecodedInstruction instruction;
+	REQUIRE(InstructionDecoder::decode(rexInFront, sizeof(rexInFront), instruction));
+	CHECK(instruction.length == 11);
+	CHECK(instruction.immediateSize == 8);
+
+	const uint8_t signExtended[] = { 0x66, 0x48, 0xC7, 0xC0, 0x78, 0x56, 0x34, 0x12 };		// mov rax, imm32
+	REQUIRE(InstructionDecoder::decode(signExtended, sizeof(signExtended), instruction));
+	CHECK(instruction.length == 8);
+	CHECK(instruction.immediateSize == 4);
+}
+
+
+IGCS_TEST(InstructionDecoder, DeterminesCoveringLengthsAndBoundaries)
+{
+	std::vector<uint8_t> code;
+	std::vector<int> boundaries = { 0 };
+	for (const CorpusEntry& entry : CORPUS)
+	{
+		code.insert(code.end(), entry.bytes.begin(), entry.bytes.end());
+		boundaries.push_back(static_cast<int>(code.size()));
+	}
+	size_t nextBoundary = 0;
+	for (int offset = 0; offset <= static_cast<int>(code.size()); offset++)
+	{
+		const bool isBoundary = (offset == boundaries[nextBoundary]);
+		CHECK(InstructionDecoder::isInstructionBoundary(code.data(), code.size(), offset) == isBoundary);
+		CHECK(InstructionDecoder::coveringLength(code.data(), code.size(), offset) == boundaries[nextBoundary]);
+		if (isBoundary && nextBoundary + 1 < boundaries.size())
+		{
+			nextBoundary++;
+		}
+	}
+	// past the end of the code there's nothing to decode.
+	CHECK(InstructionDecoder::coveringLength(code.data(), code.size(), static_cast<int>(code.size()) + 1) == -1);
+	const uint8_t invalid[] = { 0x90, 0x06, 0x90 };
+	CHECK(InstructionDecoder::coveringLength(invalid, sizeof(invalid), 2) == -1);
+}
+
+
+// The continue offsets of the capture hooks which are decoded at runtime and the explicit ones the other hooks use.
+IGCS_TEST(InstructionDecoder, DecodesTheContinueOffsetsOfTheHooks)
+{
+	CHECK(InstructionDecoder::coveringLength(ACTIVECAM_ADDRESS_CODE.data(), ACTIVECAM_ADDRESS_CODE.size(), HOOK_INSTRUCTION_LENGTH) == 0x10);
+	CHECK(InstructionDecoder::coveringLength(PMSTRUCT_ADDRESS_CODE.data(), PMSTRUCT_ADDRESS_CODE.size(), HOOK_INSTRUCTION_LENGTH) == 0x12);
+	CHECK(InstructionDecoder::coveringLength(RESOLUTION_STRUCT_ADDRESS_CODE.data(), RESOLUTION_STRUCT_ADDRESS_CODE.size(), HOOK_INSTRUCTION_LENGTH) == 0x0F);
+	CHECK(InstructionDecoder::coveringLength(TOD_READ_CODE.data(), TOD_READ_CODE.size(), HOOK_INSTRUCTION_LENGTH) == 0x0F);
+
+	CHECK(InstructionDecoder::isInstructionBoundary(ACTIVECAM_CAMERA_WRITE1_CODE.data(), ACTIVECAM_CAMERA_WRITE1_CODE.size(), 0x1A));
+	CHECK(InstructionDecoder::isInstructionBoundary(PLAY_WIDGETBUCKET_READ_CODE.data(), PLAY_WIDGETBUCKET_READ_CODE.size(), 0x13));
+	CHECK(InstructionDecoder::isInstructionBoundary(PM_WIDGETBUCKET_READ_CODE.data(), PM_WIDGETBUCKET_READ_CODE.size(), 0x12));
+	CHECK(InstructionDecoder::isInstructionBoundary(FOV_PLAY_WRITE_CODE.data(), FOV_PLAY_WRITE_CODE.size(), 0x0F));
+	// one byte off is in the middle of an instruction
+	CHECK(!InstructionDecoder::isInstructionBoundary(PLAY_WIDGETBUCKET_READ_CODE.data(), PLAY_WIDGETBUCKET_READ_CODE.size(), 0x12));
+	CHECK(!InstructionDecoder::isInstructionBoundary(FOV_PLAY_WRITE_CODE.data(), FOV_PLAY_WRITE_CODE.size(), 0x0E));
+}
+
+
+IGCS_TEST(InstructionDecoder, CreatesPatternsWithWildcards)
+{
+	const uint8_t code[] = {
+		0x48, 0x8B, 0x05, 0x11, 0x22, 0x33, 0x44,		// mov rax, [rip+d32]
+		0xE8, 0x10, 0x20, 0x30, 0x40,					// call rel32
+		0x74, 0x0A,										// je rel8
+		0xC7, 0x41, 0x10, 0x78, 0x56, 0x34, 0x12,		// mov dword [rcx+10h], imm32
+		0x80, 0x7A, 0x40, 0x00,							// cmp byte [rdx+40h], 0
+	};
+	const int length = static_cast<int>(sizeof(code));
+	CHECK(InstructionDecoder::createPattern(code, length) == "48 8B 05 ?? ?? ?? ?? E8 ?? ?? ?? ?? 74 0A C7 41 10 ?? ?? ?? ?? 80 7A 40 00");
+	CHECK(InstructionDecoder::createPattern(code, length, InstructionDecoder::WildcardNone) == "48 8B 05 11 22 33 44 E8 10 20 30 40 74 0A C7 41 10 78 56 34 12 80 7A 40 00");
+	CHECK(InstructionDecoder::createPattern(code, length, InstructionDecoder::WildcardMemoryDisplacements) == "48 8B 05 11 22 33 44 E8 10 20 30 40 74 0A C7 41 ?? 78 56 34 12 80 7A ?? 00");
+	CHECK(InstructionDecoder::createPattern(code, length, InstructionDecoder::WildcardRipRelative) == "48 8B 05 ?? ?? ?? ?? E8 10 20 30 40 74 0A C7 41 10 78 56 34 12 80 7A 40 00");
+
+	uint8_t compareMask[sizeof(code)];
+	REQUIRE(InstructionDecoder::createCompareMask(code, length, InstructionDecoder::WildcardBranchTargets, compareMask));
+	for (int i = 0; i < length; i++)
+	{
+		CHECK(compareMask[i] == ((i >= 8 && i < 12) ? 0xFF : 0x00));
+	}
+	// a length in the middle of an instruction can't be masked
+	CHECK(!InstructionDecoder::createCompareMask(code, 6, InstructionDecoder::WildcardDefault, compareMask));
+	CHECK(InstructionDecoder::createPattern(code, 6).empty());
+	CHECK(InstructionDecoder::createPattern(code, 0).empty());
+}
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "MessageClassifier.h"
+#include <map>
+
+using namespace IGCS::Input;
+
+namespace
+{
+	// The kinds of the input messages, with the ids from the Windows documentation.
+	const std::map<unsigned int, MessageKind> EXPECTED_KINDS = {
+		{ 0x00FF, MessageKind::RawInput },		// WM_INPUT
+		{ 0x0100, MessageKind::KeyDown },		// WM_KEYDOWN
+		{ 0x0101, MessageKind::KeyUp },			// WM_KEYUP
+		{ 0x0104, MessageKind::SysKeyDown },	// WM_SYSKEYDOWN
+		{ 0x0105, MessageKind::SysKeyUp },		// WM_SYSKEYUP
+		{ 0x0021, MessageKind::Mouse },			// WM_MOUSEACTIVATE
+		{ 0x0084, MessageKind::Mouse },			// WM_NCHITTEST
+		{ 0x00A0, MessageKind::Mouse },			// WM_NCMOUSEMOVE
+		{ 0x00A1, MessageKind::Mouse },			// WM_NCLBUTTONDOWN
+		{ 0x00A2, MessageKind::Mouse },			// WM_NCLBUTTONUP
+		{ 0x00A3, MessageKind::Mouse },			// WM_NCLBUTTONDBLCLK
+		{ 0x00A4, MessageKind::Mouse },			// WM_NCRBUTTONDOWN
+		{ 0x00A5, MessageKind::Mouse },			// WM_NCRBUTTONUP
+		{ 0x00A6, MessageKind::Mouse },			// WM_NCRBUTTONDBLCLK
+		{ 0x00A7, MessageKind::Mouse },			// WM_NCMBUTTONDOWN
+		{ 0x00A8, MessageKind::Mouse },			// WM_NCMBUTTONUP
+		{ 0x00A9, MessageKind::Mouse },			// WM_NCMBUTTONDBLCLK
+		{ 0x00AB, MessageKind::Mouse },			// WM_NCXBUTTONDOWN
+		{ 0x00AC, MessageKind::Mouse },			// WM_NCXBUTTONUP
+		{ 0x00AD, MessageKind::Mouse },			// WM_NCXBUTTONDBLCLK
+		{ 0x0200, MessageKind::Mouse },			// WM_MOUSEMOVE
+		{ 0x0201, MessageKind::Mouse },			// WM_LBUTTONDOWN
+		{ 0x0202, MessageKind::Mouse },			// WM_LBUTTONUP
+		{ 0x0203, MessageKind::Mouse },			// WM_LBUTTONDBLCLK
+		{ 0x0204, MessageKind::Mouse },			// WM_RBUTTONDOWN
+		{ 0x0205, MessageKind::Mouse },			// WM_RBUTTONUP
+		{ 0x0206, MessageKind::Mouse },			// WM_RBUTTONDBLCLK
+		{ 0x0207, MessageKind::Mouse },			// WM_MBUTTONDOWN
+		{ 0x0208, MessageKind::Mouse },			// WM_MBUTTONUP
+		{ 0x0209, MessageKind::Mouse },			// WM_MBUTTONDBLCLK
+		{ 0x020A, MessageKind::Mouse },			// WM_MOUSEWHEEL
+		{ 0x020B, MessageKind::Mouse },			// WM_XBUTTONDOWN
+		{ 0x020C, MessageKind::Mouse },			// WM_XBUTTONUP
+		{ 0x020D, MessageKind::Mouse },			// WM_XBUTTONDBLCLK
+		{ 0x020E, MessageKind::Mouse },			// WM_MOUSEHWHEEL
+		{ 0x0215, MessageKind::Mouse },			// WM_CAPTURECHANGED
+		{ 0x02A0, MessageKind::Mouse },			// WM_NCMOUSEHOVER
+		{ 0x02A1, MessageKind::Mouse },			// WM_MOUSEHOVER
+		{ 0x02A2, MessageKind::Mouse },			// WM_NCMOUSELEAVE
+		{ 0x02A3, MessageKind::Mouse },			// WM_MOUSELEAVE
+	};
+}
+
+
+IGCS_TEST(MessageClassifier, ClassifiesTheInputMessages)
+{
+	for (const auto& expected : EXPECTED_KINDS)
+	{
+		CHECK(classifyMessage(expected.first) == expected.second);
+	}
+}
+
+
+// Everything else, e.g. WM_PAINT, WM_TIMER, WM_CHAR and the ids past the table, is let through.
+IGCS_TEST(MessageClassifier, LetsOtherMessagesThrough)
+{
+	for (unsigned int message = 0; message < 0x10000; message++)
+	{
+		if (EXPECTED_KINDS.count(message) == 0)
+		{
+			CHECK(classifyMessage(message) == MessageKind::Irrelevant);
+		}
+	}
+	CHECK(classifyMessage(0xC000) == MessageKind::Irrelevant);			// registered window messages start here
+	CHECK(classifyMessage(0xFFFFFFFFu) == MessageKind::Irrelevant);
+}
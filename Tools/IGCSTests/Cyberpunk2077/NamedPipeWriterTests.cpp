@@ -0,0 +1,396 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "NamedPipeWriter.h"
+#include "PipeMessageQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace IGCS;
+
+namespace
+{
+	const int READ_TIMEOUT_MS = 5000;
+
+	// the longest text a message can have
+	const size_t MESSAGE_TEXT_LENGTH = PIPE_MESSAGE_SLOT_SIZE - 1;
+
+	// The producer and the sequence number, followed by a letter which depends on them till the message is full, so a message which is 
+	// read while it's written would be recognizable. Returns the length, which is always MESSAGE_TEXT_LENGTH.
+	size_t createText(int producer, uint64_t sequence, char* text)
+	{
+		const int prefixLength = snprintf(text, MESSAGE_TEXT_LENGTH, "%d %llu ", producer, static_cast<unsigned long long>(sequence));
+		memset(text + prefixLength, 'a' + static_cast<int>((sequence * 7 + producer) % 26), MESSAGE_TEXT_LENGTH - prefixLength);
+		return MESSAGE_TEXT_LENGTH;
+	}
+
+
+	std::string textOf(const OutgoingPipeMessage& message)
+	{
+		return std::string(reinterpret_cast<const char*>(message.payload + 1), message.length - 1);
+	}
+
+
+	// The client end of a socket pair, which takes the place of the client of the pipe. Every message is a packet of its own, as it is
+	// on the pipe, which is in message mode.
+	class Client
+	{
+	public:
+		Client() : _pipe(-1), _client(-1)
+		{
+			int sockets[2];
+			if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) == 0)
+			{
+				_pipe = sockets[0];
+				_client = sockets[1];
+			}
+		}
+
+		~Client()
+		{
+			closePipe();
+			closeClient();
+		}
+
+		bool isValid() const { return _pipe >= 0 && _client >= 0; }
+		int pipe() const { return _pipe; }
+
+		// Fills the socket so a writer can't write to it till the client reads. Returns the number of messages written.
+		int fill()
+		{
+			int numberOfMessages = 0;
+			const char filler[] = "filler";
+			while (send(_pipe, filler, sizeof(filler), MSG_DONTWAIT | MSG_NOSIGNAL) > 0)
+			{
+				numberOfMessages++;
+			}
+			return numberOfMessages;
+		}
+
+		// Reads the next message: the type and the text. Returns false if none arrived in time.
+		bool read(uint8_t& type, std::string& text)
+		{
+			pollfd toPoll = { _client, POLLIN, 0 };
+			if (poll(&toPoll, 1, READ_TIMEOUT_MS) <= 0)
+			{
+				return false;
+			}
+			uint8_t buffer[PIPE_MESSAGE_SLOT_SIZE + 1];
+			const ssize_t length = recv(_client, buffer, sizeof(buffer), 0);
+			if (length <= 0)
+			{
+				return false;
+			}
+			type = buffer[0];
+			text.assign(reinterpret_cast<const char*>(buffer + 1), static_cast<size_t>(length - 1));
+			return true;
+		}
+
+		void closePipe()
+		{
+			if (_pipe >= 0)
+			{
+				close(_pipe);
+				_pipe = -1;
+			}
+		}
+
+		void closeClient()
+		{
+			if (_client >= 0)
+			{
+				close(_client);
+				_client = -1;
+			}
+		}
+
+	private:
+		int _pipe;
+		int _client;
+	};
+
+
+	// The number of messages a message written stands for: more than 1 if the writer coalesced repeats of it.
+	uint64_t numberOfMessagesWritten(const std::string& text)
+	{
+		const size_t suffixStart = text.rfind(" (repeated ");
+		unsigned numberOfRepeats = 0;
+		if (std::string::npos == suffixStart || sscanf(text.c_str() + suffixStart, " (repeated %u times)", &numberOfRepeats) != 1)
+		{
+			return 1;
+		}
+		return numberOfRepeats;
+	}
+}
+
+
+IGCS_TEST(PipeMessageQueue, PopsTheMessagesWithTheirTypeInOrder)
+{
+	PipeMessageQueue<8> queue;
+	OutgoingPipeMessage message;
+	CHECK(queue.isEmpty());
+	CHECK(!queue.pop(message));
+	CHECK(queue.push(MessageType::NormalTextMessage, "first", 5));
+	CHECK(queue.push(MessageType::ErrorTextMessage, "second", 6));
+	CHECK(!queue.isEmpty());
+	REQUIRE(queue.pop(message));
+	CHECK(message.payload[0] == static_cast<uint8_t>(MessageType::NormalTextMessage) && textOf(message) == "first");
+	REQUIRE(queue.pop(message));
+	CHECK(message.payload[0] == static_cast<uint8_t>(MessageType::ErrorTextMessage) && textOf(message) == "second");
+	CHECK(queue.isEmpty());
+
+	// text which doesn't fit in a cell is cut off
+	const std::string longText(PIPE_MESSAGE_SLOT_SIZE * 2, 'x');
+	CHECK(queue.push(MessageType::DebugTextMessage, longText.c_str(), longText.size()));
+	REQUIRE(queue.pop(message));
+	CHECK(message.length == PIPE_MESSAGE_SLOT_SIZE);
+	CHECK(textOf(message) == longText.substr(0, PIPE_MESSAGE_SLOT_SIZE - 1));
+	CHECK(queue.numberOfDroppedMessages() == 0);
+}
+
+
+IGCS_TEST(PipeMessageQueue, DropsTheLowerPrioritiesFirst)
+{
+	const size_t capacity = 16;
+	PipeMessageQueue<capacity> queue;
+	// many times around, so the cells are reused
+	for (int round = 0; round < 10; round++)
+	{
+		int numberQueued = 0;
+		while (queue.push(MessageType::DebugTextMessage, "debug", 5))
+		{
+			numberQueued++;
+		}
+		CHECK(numberQueued == capacity / 2);
+		while (queue.push(MessageType::NormalTextMessage, "normal", 6))
+		{
+			numberQueued++;
+		}
+		CHECK(numberQueued == capacity - capacity / 4);
+		while (queue.push(MessageType::ErrorTextMessage, "error", 5))
+		{
+			numberQueued++;
+		}
+		CHECK(numberQueued == capacity);
+		CHECK(!queue.push(MessageType::Notification, "notification", 12));
+		// once a message is popped, an error fits again but a debug message doesn't
+		OutgoingPipeMessage message;
+		REQUIRE(queue.pop(message));
+		CHECK(textOf(message) == "debug");
+		CHECK(!queue.push(MessageType::DebugTextMessage, "debug", 5));
+		CHECK(queue.push(MessageType::ErrorTextMessage, "error", 5));
+		while (queue.pop(message))
+		{
+		}
+	}
+	CHECK(queue.numberOfDroppedMessages(MessageType::DebugTextMessage) == 20);
+	CHECK(queue.numberOfDroppedMessages(MessageType::NormalTextMessage) == 10);
+	CHECK(queue.numberOfDroppedMessages(MessageType::ErrorTextMessage) == 10);
+	CHECK(queue.numberOfDroppedMessages(MessageType::Notification) == 10);
+	CHECK(queue.numberOfDroppedMessages() == 50);
+}
+
+
+IGCS_TEST(PipeMessageQueue, KeepsTheMessagesOfConcurrentProducersIntact)
+{
+	const int numberOfProducers = 3;
+	const uint64_t numberOfMessagesPerProducer = 100000;
+	PipeMessageQueue<64> queue;
+	std::atomic<bool> consumerGaveUp(false);
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < numberOfProducers; producer++)
+	{
+		producers.emplace_back([&queue, &consumerGaveUp, producer]
+		{
+			char text[PIPE_MESSAGE_SLOT_SIZE];
+			for (uint64_t sequence = 0; sequence < numberOfMessagesPerProducer && !consumerGaveUp.load(std::memory_order_relaxed); )
+			{
+				createText(producer, sequence, text);
+				if (queue.push(MessageType::ErrorTextMessage, text, MESSAGE_TEXT_LENGTH))
+				{
+					sequence++;
+				}
+				else
+				{
+					// the queue is full, so the producers spend their time in pushes which succeed, not in the ones which don't
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	uint64_t nextSequence[numberOfProducers] = {};
+	uint64_t numberOfMessagesLeft = numberOfProducers * numberOfMessagesPerProducer;
+	bool intact = true;
+	bool inOrder = true;
+	OutgoingPipeMessage message;
+	// a message which is lost would make us wait forever
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READ_TIMEOUT_MS);
+	uint64_t numberOfPops = 0;
+	while (numberOfMessagesLeft > 0 && ((++numberOfPops & 255) != 0 || std::chrono::steady_clock::now() < deadline))
+	{
+		if (!queue.pop(message))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		numberOfMessagesLeft--;
+		int producer;
+		unsigned long long sequence;
+		const std::string text = textOf(message);
+		char expectedText[PIPE_MESSAGE_SLOT_SIZE];
+		if (sscanf(text.c_str(), "%d %llu", &producer, &sequence) != 2 || producer < 0 || producer >= numberOfProducers || 
+			text != std::string(expectedText, createText(producer, sequence, expectedText)))
+		{
+			intact = false;
+			continue;
+		}
+		// a producer's messages are popped in the order it pushed them
+		inOrder = inOrder && sequence == nextSequence[producer];
+		nextSequence[producer] = sequence + 1;
+	}
+	CHECK(numberOfMessagesLeft == 0);
+	consumerGaveUp.store(true);
+	for (std::thread& producer : producers)
+	{
+		producer.join();
+	}
+	CHECK(intact);
+	CHECK(inOrder);
+	CHECK(!queue.pop(message));
+	for (int producer = 0; producer < numberOfProducers; producer++)
+	{
+		CHECK(nextSequence[producer] == numberOfMessagesPerProducer);
+	}
+}
+
+
+IGCS_TEST(NamedPipeWriter, WritesTheQueuedMessagesBeforeItStops)
+{
+	Client client;
+	REQUIRE(client.isValid());
+	NamedPipeWriter writer;
+	CHECK(!writer.isRunning());
+	writer.write(MessageType::NormalTextMessage, "ignored", 7);
+	writer.start(client.pipe());
+	CHECK(writer.isRunning());
+	writer.write(MessageType::NormalTextMessage, "one", 3);
+	writer.write(MessageType::ErrorTextMessage, "two", 3);
+	writer.write(MessageType::NormalTextMessage, "three", 5);
+	writer.stop();
+	CHECK(!writer.isRunning());
+	// not running, so not queued
+	writer.write(MessageType::NormalTextMessage, "ignored", 7);
+
+	uint8_t type;
+	std::string text;
+	REQUIRE(client.read(type, text));
+	CHECK(type == static_cast<uint8_t>(MessageType::NormalTextMessage) && text == "one");
+	REQUIRE(client.read(type, text));
+	CHECK(type == static_cast<uint8_t>(MessageType::ErrorTextMessage) && text == "two");
+	REQUIRE(client.read(type, text));
+	CHECK(type == static_cast<uint8_t>(MessageType::NormalTextMessage) && text == "three");
+	client.closePipe();
+	CHECK(!client.read(type, text));
+	CHECK(writer.numberOfDroppedMessages() == 0);
+}
+
+
+IGCS_TEST(NamedPipeWriter, CoalescesRepeatsAndReportsDropsWhenTheClientLags)
+{
+	Client client;
+	REQUIRE(client.isValid());
+	// the client doesn't read till everything is written, so the writer can't keep up
+	const int numberOfFillers = client.fill();
+	REQUIRE(numberOfFillers > 0);
+	NamedPipeWriter writer;
+	writer.start(client.pipe());
+	const uint64_t numberOfMessages = 10000;
+	for (uint64_t i = 0; i < numberOfMessages; i++)
+	{
+		writer.write(MessageType::NormalTextMessage, "same", 4);
+	}
+	const uint64_t numberOfDroppedMessages = writer.numberOfDroppedMessages();
+	CHECK(numberOfDroppedMessages > 0);
+	CHECK(numberOfDroppedMessages == writer.numberOfDroppedMessages(MessageType::NormalTextMessage));
+
+	uint8_t type;
+	std::string text;
+	for (int i = 0; i < numberOfFillers; i++)
+	{
+		REQUIRE(client.read(type, text));
+	}
+	// every message is written or dropped, and the client is told how many were dropped after it caught up
+	uint64_t numberOfMessagesRead = 0;
+	uint64_t numberOfDropsReported = 0;
+	while (numberOfMessagesRead + numberOfDropsReported < numberOfMessages && client.read(type, text))
+	{
+		if (type == static_cast<uint8_t>(MessageType::ErrorTextMessage))
+		{
+			unsigned long long numberOfDrops = 0;
+			CHECK(sscanf(text.c_str(), "%llu messages were dropped", &numberOfDrops) == 1);
+			numberOfDropsReported += numberOfDrops;
+			continue;
+		}
+		CHECK(type == static_cast<uint8_t>(MessageType::NormalTextMessage));
+		CHECK(text.compare(0, 4, "same") == 0);
+		numberOfMessagesRead += numberOfMessagesWritten(text);
+	}
+	CHECK(numberOfDropsReported == numberOfDroppedMessages);
+	CHECK(numberOfMessagesRead + numberOfDroppedMessages == numberOfMessages);
+	CHECK(writer.numberOfCoalescedMessages() > 0);
+	CHECK(numberOfMessagesRead > writer.numberOfCoalescedMessages());
+	writer.stop();
+}
+
+
+IGCS_TEST(NamedPipeWriter, StopsWhenTheClientIsGone)
+{
+	Client client;
+	REQUIRE(client.isValid());
+	NamedPipeWriter writer;
+	writer.start(client.pipe());
+	client.closeClient();
+	writer.write(MessageType::NormalTextMessage, "nobody reads this", 17);
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READ_TIMEOUT_MS);
+	while (writer.isRunning() && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(!writer.isRunning());
+	writer.stop();
+}
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "CameraMath.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+using namespace IGCS;
+
+// Compiled in Cyberpunk2077Tests, which uses the SSE2 (or NEON) conversions, and in Cyberpunk2077ScalarMathTests, which is compiled with
+// IGCS_MATH_SCALAR, so both paths give the same results.
+namespace
+{
+	// The factor Cyberpunk uses: a packed coordinate is a multiple of 1/131072 of a world unit.
+	const double GAME_FACTOR = 1.0 / 131072.0;
+
+	int32_t packedX(double worldX, double factor)
+	{
+		int32_t packed[3];
+		Math::worldToPacked(Math::Vec3d{ worldX, 0.0, 0.0 }, factor, packed);
+		return packed[0];
+	}
+
+
+	// Converts all three axes, as x and y are converted together and z on its own.
+	bool packsTo(double world, double factor, int32_t expected)
+	{
+		int32_t packed[3];
+		Math::worldToPacked(Math::Vec3d{ world, world, world }, factor, packed);
+		return packed[0] == expected && packed[1] == expected && packed[2] == expected;
+	}
+}
+
+
+// A camera moving slowly far from the origin: the position is kept in doubles and only quantized when written, so the 1000 steps end up
+// where they should, also when a step is smaller than a packed unit.
+IGCS_TEST(PackedCoordinates, SlowMovementIsntLost)
+{
+	const double factors[] = { GAME_FACTOR, 1.0 };
+	for (double factor : factors)
+	{
+		int32_t startPacked[3] = { 131072000, -131072000, 12345 };
+		Math::Vec3d position = Math::packedToWorld(startPacked, factor);
+		int32_t packed[3];
+		for (int step = 0; step < 1000; step++)
+		{
+			position.x += 0.2;
+			position.y -= 0.2;
+			Math::worldToPacked(position, factor, packed);
+		}
+		CHECK(packed[0] == startPacked[0] + static_cast<int32_t>(std::lround(200.0 / factor)));
+		CHECK(packed[1] == startPacked[1] - static_cast<int32_t>(std::lround(200.0 / factor)));
+		CHECK(packed[2] == startPacked[2]);
+	}
+	// going through the packed value every step, a step of less than half a packed unit never moves the camera
+	int32_t packed[3] = { 1000, 0, 0 };
+	for (int step = 0; step < 1000; step++)
+	{
+		Math::Vec3d position = Math::packedToWorld(packed, 1.0);
+		position.x += 0.2;
+		Math::worldToPacked(position, 1.0, packed);
+	}
+	CHECK(packed[0] == 1000);
+}
+
+
+IGCS_TEST(PackedCoordinates, RoundsToNearestWithTiesToEven)
+{
+	CHECK(packsTo(0.4, 1.0, 0));
+	CHECK(packsTo(0.6, 1.0, 1));
+	CHECK(packsTo(-0.6, 1.0, -1));
+	CHECK(packsTo(0.5, 1.0, 0));
+	CHECK(packsTo(1.5, 1.0, 2));
+	CHECK(packsTo(2.5, 1.0, 2));
+	CHECK(packsTo(-0.5, 1.0, 0));
+	CHECK(packsTo(-1.5, 1.0, -2));
+	CHECK(packsTo(-2.5, 1.0, -2));
+	CHECK(packsTo(3.5 * GAME_FACTOR, GAME_FACTOR, 4));
+	CHECK(packsTo(-3.5 * GAME_FACTOR, GAME_FACTOR, -4));
+	CHECK(packsTo(2147483646.5, 1.0, 2147483646));
+	CHECK(packsTo(-2147483647.5, 1.0, -2147483648));
+}
+
+
+IGCS_TEST(PackedCoordinates, SaturatesAtTheInt32Range)
+{
+	const int32_t minPacked = (std::numeric_limits<int32_t>::min)();
+	const int32_t maxPacked = (std::numeric_limits<int32_t>::max)();
+	CHECK(packsTo(2147483647.0, 1.0, maxPacked));
+	CHECK(packsTo(2147483647.4, 1.0, maxPacked));
+	CHECK(packsTo(2147483648.0, 1.0, maxPacked));
+	CHECK(packsTo(3.0e9, 1.0, maxPacked));
+	CHECK(packsTo(1.0e300, 1.0, maxPacked));
+	CHECK(packsTo(std::numeric_limits<double>::infinity(), 1.0, maxPacked));
+	CHECK(packsTo(-2147483648.0, 1.0, minPacked));
+	CHECK(packsTo(-2147483648.6, 1.0, minPacked));
+	CHECK(packsTo(-3.0e9, 1.0, minPacked));
+	CHECK(packsTo(-std::numeric_limits<double>::infinity(), 1.0, minPacked));
+	// 20000 world units is past the range of the game's factor
+	CHECK(packsTo(20000.0, GAME_FACTOR, maxPacked));
+	CHECK(packsTo(-20000.0, GAME_FACTOR, minPacked));
+}
+
+
+IGCS_TEST(PackedCoordinates, NaNBecomesTheMinimum)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	CHECK(packsTo(nan, 1.0, (std::numeric_limits<int32_t>::min)()));
+	CHECK(packsTo(nan, GAME_FACTOR, (std::numeric_limits<int32_t>::min)()));
+	// a NaN on one axis doesn't affect the others
+	int32_t packed[3];
+	Math::worldToPacked(Math::Vec3d{ 1.0, nan, 3.0 }, 1.0, packed);
+	CHECK(packed[0] == 1);
+	CHECK(packed[1] == (std::numeric_limits<int32_t>::min)());
+	CHECK(packed[2] == 3);
+}
+
+
+// Every packed value is exactly representable as a double multiple of the factor, so converting back gives the same value.
+IGCS_TEST(PackedCoordinates, RoundTripsPackedValues)
+{
+	std::mt19937 random(18);
+	std::uniform_int_distribution<int32_t> anyPacked((std::numeric_limits<int32_t>::min)(), (std::numeric_limits<int32_t>::max)());
+	for (int i = 0; i < 10000; i++)
+	{
+		const int32_t original[3] = { anyPacked(random), anyPacked(random), anyPacked(random) };
+		const Math::Vec3d world = Math::packedToWorld(original, GAME_FACTOR);
+		CHECK(world.x == static_cast<double>(original[0]) * GAME_FACTOR);
+		CHECK(world.y == static_cast<double>(original[1]) * GAME_FACTOR);
+		CHECK(world.z == static_cast<double>(original[2]) * GAME_FACTOR);
+		int32_t packed[3];
+		Math::worldToPacked(world, GAME_FACTOR, packed);
+		CHECK(packed[0] == original[0] && packed[1] == original[1] && packed[2] == original[2]);
+	}
+	const int32_t limits[3] = { (std::numeric_limits<int32_t>::min)(), (std::numeric_limits<int32_t>::max)(), 0 };
+	const Math::Vec3d world = Math::packedToWorld(limits, 1.0);
+	CHECK(world.x == -2147483648.0);
+	CHECK(world.y == 2147483647.0);
+	CHECK(world.z == 0.0);
+	CHECK(packedX(world.x, 1.0) == limits[0]);
+	CHECK(packedX(world.y, 1.0) == limits[1]);
+}
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "CameraPoseSeqLock.h"
+#include "SeqLockSnapshot.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace IGCS;
+
+namespace
+{
+	const int NUMBER_OF_READERS = 2;
+	// long enough for the threads to be preempted in the middle of copying many times, also when they share a core
+	const std::chrono::milliseconds TEST_DURATION(250);
+
+	// Every field is derived from value, so a pose which is half old and half new is recognizable.
+	CameraPose createPose(int32_t value)
+	{
+		return CameraPose{ { value, -value, value * 3 }, { static_cast<float>(value), 0.5f, -static_cast<float>(value), 1.0f } };
+	}
+
+
+	bool isConsistent(const CameraPose& pose)
+	{
+		int32_t value = pose.coords[0];
+		CameraPose expected = createPose(value);
+		return memcmp(&pose, &expected, sizeof(CameraPose)) == 0;
+	}
+
+
+	// 20 bytes, so the last word is only partly used.
+	struct Sample
+	{
+		uint32_t values[5];
+	};
+
+
+	Sample createSample(uint32_t value)
+	{
+		return Sample{ { value, value + 1, value * 2, ~value, value ^ 0x5A5A5A5A } };
+	}
+
+
+	bool isConsistent(const Sample& sample)
+	{
+		Sample expected = createSample(sample.values[0]);
+		return memcmp(&sample, &expected, sizeof(Sample)) == 0;
+	}
+}
+
+
+IGCS_TEST(SeqLock, ReadsThePublishedPose)
+{
+	CameraPoseSeqLock seqLock;
+	CameraPose pose;
+	CHECK(!seqLock.read(pose));
+	seqLock.publish(createPose(42));
+	REQUIRE(seqLock.read(pose));
+	CHECK(isConsistent(pose) && pose.coords[0] == 42);
+	seqLock.publish(createPose(43));
+	REQUIRE(seqLock.read(pose));
+	CHECK(pose.coords[0] == 43);
+	// after a clear the game keeps its own pose till the next publish
+	seqLock.clear();
+	CHECK(!seqLock.read(pose));
+	seqLock.publish(createPose(44));
+	REQUIRE(seqLock.read(pose));
+	CHECK(pose.coords[0] == 44);
+	CHECK(seqLock.appliedSequence() == 0);
+}
+
+
+// Readers running while the camera thread publishes never see a torn pose, and the poses they see only move forward.
+IGCS_TEST(SeqLock, ReadersNeverSeeATornPose)
+{
+	CameraPoseSeqLock seqLock;
+	seqLock.publish(createPose(0));
+	std::atomic_bool writerDone(false);
+	std::atomic<int> tornReads(0);
+	std::atomic<int> reorderedReads(0);
+	std::atomic<int> numberOfReads(0);
+	std::vector<std::thread> readers;
+	for (int i = 0; i < NUMBER_OF_READERS; i++)
+	{
+		readers.emplace_back([&]
+		{
+			int32_t lastValue = 0;
+			while (!writerDone)
+			{
+				CameraPose pose;
+				if (!seqLock.read(pose) || !isConsistent(pose))
+				{
+					tornReads++;
+					continue;
+				}
+				if (pose.coords[0] < lastValue)
+				{
+					reorderedReads++;
+				}
+				lastValue = pose.coords[0];
+				numberOfReads++;
+			}
+		});
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + TEST_DURATION;
+	int32_t value = 1;
+	// the time is only checked every 256 publishes
+	for (; (value & 0xFF) != 0 || std::chrono::steady_clock::now() < end; value++)
+	{
+		seqLock.publish(createPose(value));
+	}
+	writerDone = true;
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+	CHECK(numberOfReads > 0);
+	CHECK(tornReads == 0);
+	CHECK(reorderedReads == 0);
+	CameraPose pose;
+	REQUIRE(seqLock.read(pose));
+	CHECK(pose.coords[0] == value - 1);
+}
+
+
+IGCS_TEST(SeqLock, SnapshotReadsThePublishedValue)
+{
+	SeqLockSnapshot<Sample> snapshot;
+	Sample sample = snapshot.read();
+	for (uint32_t value : sample.values)
+	{
+		CHECK(value == 0);
+	}
+	snapshot.publish(createSample(7));
+	sample = snapshot.read();
+	CHECK(isConsistent(sample) && sample.values[0] == 7);
+}
+
+
+IGCS_TEST(SeqLock, SnapshotReadersNeverSeeATornValue)
+{
+	SeqLockSnapshot<Sample> snapshot;
+	snapshot.publish(createSample(0));
+	std::atomic_bool writerDone(false);
+	std::atomic<int> tornReads(0);
+	std::atomic<int> numberOfReads(0);
+	std::vector<std::thread> readers;
+	for (int i = 0; i < NUMBER_OF_READERS; i++)
+	{
+		readers.emplace_back([&]
+		{
+			while (!writerDone)
+			{
+				if (!isConsistent(snapshot.read()))
+				{
+					tornReads++;
+				}
+				numberOfReads++;
+			}
+		});
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + TEST_DURATION;
+	uint32_t value = 1;
+	for (; (value & 0xFF) != 0 || std::chrono::steady_clock::now() < end; value++)
+	{
+		snapshot.publish(createSample(value));
+	}
+	writerDone = true;
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+	CHECK(numberOfReads > 0);
+	CHECK(tornReads == 0);
+	CHECK(snapshot.read().values[0] == value - 1);
+}
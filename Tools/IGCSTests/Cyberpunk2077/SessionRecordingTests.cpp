@@ -0,0 +1,334 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "SessionRecording.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+using namespace IGCS;
+
+namespace
+{
+	// what a tick record takes at most, with all its messages at full length
+	const uint32_t TICK_BUFFER_SIZE = 4096;
+
+	TickInput createTick(int64_t now)
+	{
+		TickInput input;
+		memset(&input, 0, sizeof(input));
+		input.nowInMicroseconds = now;
+		input.frameTime.deltaSeconds = 0.016f;
+		input.frameTime.numberOfSteps = 2;
+		input.frameTime.stepSeconds = 0.008f;
+		input.frameTime.interpolationFactor = 0.25f;
+		input.gameHasFocus = true;
+		input.keyboard.clear();
+		return input;
+	}
+
+
+	void addMessage(TickInput& input, uint8_t length, uint8_t fill)
+	{
+		PipeMessage& message = input.messages[input.numberOfMessages++];
+		memset(message.payload, fill, length);
+		message.length = length;
+	}
+
+
+	bool ticksEqual(const TickInput& a, const TickInput& b)
+	{
+		bool equal = a.nowInMicroseconds == b.nowInMicroseconds && a.frameTime.deltaSeconds == b.frameTime.deltaSeconds &&
+					 a.frameTime.numberOfSteps == b.frameTime.numberOfSteps && a.frameTime.stepSeconds == b.frameTime.stepSeconds &&
+					 a.frameTime.interpolationFactor == b.frameTime.interpolationFactor && a.gameHasFocus == b.gameHasFocus &&
+					 0 == memcmp(a.keyboard.keysDown, b.keyboard.keysDown, sizeof(a.keyboard.keysDown)) && 0 == memcmp(&a.mouse, &b.mouse, sizeof(a.mouse)) &&
+					 0 == memcmp(&a.gamepad, &b.gamepad, sizeof(a.gamepad)) && a.gamepadConnected == b.gamepadConnected && 
+					 a.gameCameraFound == b.gameCameraFound && a.numberOfMessages == b.numberOfMessages;
+		if (equal && a.gameCameraFound)
+		{
+			equal = 0 == memcmp(a.gameCameraCoords, b.gameCameraCoords, sizeof(a.gameCameraCoords)) && a.gameCameraFoV == b.gameCameraFoV;
+		}
+		for (int i = 0; equal && i < a.numberOfMessages; i++)
+		{
+			equal = a.messages[i].length == b.messages[i].length && 0 == memcmp(a.messages[i].payload, b.messages[i].payload, a.messages[i].length);
+		}
+		return equal;
+	}
+
+
+	// A record of the size specified, which starts with its sequence number.
+	std::vector<uint8_t> createRecord(uint32_t sequence, uint32_t size)
+	{
+		std::vector<uint8_t> record(size, static_cast<uint8_t>(sequence));
+		memcpy(record.data(), &sequence, sizeof(sequence));
+		return record;
+	}
+
+
+	bool recordMatches(uint32_t sequence, const uint8_t* data, uint32_t size)
+	{
+		uint32_t storedSequence;
+		if (size < sizeof(storedSequence))
+		{
+			return false;
+		}
+		memcpy(&storedSequence, data, sizeof(storedSequence));
+		for (uint32_t i = sizeof(storedSequence); i < size; i++)
+		{
+			if (data[i] != static_cast<uint8_t>(sequence))
+			{
+				return false;
+			}
+		}
+		return storedSequence == sequence;
+	}
+}
+
+
+IGCS_TEST(SessionRecording, TicksRoundTripThroughTheEncoderAndDecoder)
+{
+	std::vector<TickInput> ticks;
+	TickInput input = createTick(1000);
+	input.keyboard.setKeyDown(0x41);
+	input.gamepadConnected = true;
+	input.gamepad.wButtons = 0x1001;
+	input.gamepad.sThumbLX = -12345;
+	input.gamepad.bRightTrigger = 200;
+	ticks.push_back(input);
+	// nothing changed but the time
+	input.nowInMicroseconds = 17000;
+	ticks.push_back(input);
+	// mouse input, a message and the camera of the game
+	input = createTick(33000);
+	input.keyboard.setKeyDown(0x41);
+	input.gamepadConnected = true;
+	input.gamepad.wButtons = 0x1001;
+	input.gamepad.sThumbLX = -12345;
+	input.gamepad.bRightTrigger = 200;
+	input.mouse.deltaX = -7;
+	input.mouse.wheelDelta = 120;
+	input.mouse.buttonsPressed = 1;
+	input.gameCameraFound = true;
+	input.gameCameraCoords[0] = 1;
+	input.gameCameraCoords[1] = -2;
+	input.gameCameraCoords[2] = 3;
+	input.gameCameraFoV = 1.2f;
+	addMessage(input, 6, 0x11);
+	ticks.push_back(input);
+	// keys and buttons released, the window lost focus, a full load of messages
+	input = createTick(49000);
+	input.gameHasFocus = false;
+	for (int i = 0; i < TICK_INPUT_MAX_MESSAGES; i++)
+	{
+		addMessage(input, static_cast<uint8_t>(i == 0 ? IGCS_MAX_QUEUED_MESSAGE_SIZE : i), static_cast<uint8_t>(i));
+	}
+	ticks.push_back(input);
+
+	SessionTickEncoder encoder;
+	SessionTickDecoder decoder;
+	uint8_t buffer[TICK_BUFFER_SIZE];
+	uint32_t sizes[4];
+	for (size_t i = 0; i < ticks.size(); i++)
+	{
+		sizes[i] = encoder.encode(ticks[i], buffer, sizeof(buffer));
+		REQUIRE(sizes[i] > 0);
+		TickInput decoded;
+		REQUIRE(decoder.decode(buffer, sizes[i], decoded));
+		CHECK(ticksEqual(ticks[i], decoded));
+	}
+	// the second tick leaves out the keyboard and the gamepad, they didn't change
+	CHECK(sizes[1] < sizes[0]);
+}
+
+
+IGCS_TEST(SessionRecording, DecoderRejectsDamagedTicks)
+{
+	TickInput input = createTick(1000);
+	addMessage(input, 10, 0x22);
+	SessionTickEncoder encoder;
+	uint8_t buffer[TICK_BUFFER_SIZE];
+	const uint32_t size = encoder.encode(input, buffer, sizeof(buffer));
+	REQUIRE(size > 0);
+	TickInput decoded;
+	// cut short, or with bytes left over
+	CHECK(!SessionTickDecoder().decode(buffer, size - 1, decoded));
+	CHECK(!SessionTickDecoder().decode(buffer, size + 1, decoded));
+	// a tick which doesn't fit in the buffer isn't written at all
+	CHECK(0 == SessionTickEncoder().encode(input, buffer, size - 1));
+	CHECK(SessionTickDecoder().decode(buffer, size, decoded));
+}
+
+
+IGCS_TEST(SessionRecording, KeyframesAndPosesRoundTrip)
+{
+	SessionKeyframe keyframe = {};
+	keyframe.cameraStructFound = true;
+	keyframe.hudVisible = true;
+	keyframe.camera.orientation = Math::Quat{ 0.1f, 0.2f, 0.3f, 0.9f };
+	keyframe.camera.lastStepOffset = Math::Vec3{ 1.0f, -2.0f, 3.0f };
+	keyframe.camera.lookDirectionInverter = -1.0f;
+	keyframe.camera.pendingMovement = Math::Vec3{ 0.0f, 0.5f, 0.0f };
+	keyframe.camera.movementPending = true;
+	keyframe.cameraManipulator.cameraPosition = Math::Vec3d{ 1000.5, -2000.25, 30.125 };
+	keyframe.cameraManipulator.publishedCoordsHistory[PUBLISHED_COORDS_HISTORY_SIZE - 1][2] = 77;
+	keyframe.cameraManipulator.publishedCoordsHistoryCount = 5;
+	keyframe.input.actionDown[static_cast<int>(ActionType::Amount) - 1] = true;
+	keyframe.input.actionNextRepeatTime[0] = 123456789;
+	keyframe.input.mouseWheelRemainder = -40;
+	keyframe.settings.init(false);
+	keyframe.settings.movementSpeed = 0.5f;
+	keyframe.keyBindings[3] = KeyBindingState{ 0x42, true, false, true };
+
+	std::vector<uint8_t> buffer(8192);
+	const uint32_t size = SessionRecords::encodeKeyframe(keyframe, buffer.data(), static_cast<uint32_t>(buffer.size()));
+	REQUIRE(size > 0);
+	// so what's not read back shows
+	SessionKeyframe decoded = {};
+	decoded.cameraEnabled = true;
+	decoded.input.actionDown[0] = true;
+	decoded.settings.cameraControlDevice = -1;
+	REQUIRE(SessionRecords::decodeKeyframe(buffer.data(), size, decoded));
+	CHECK(decoded.cameraStructFound && !decoded.cameraEnabled && decoded.hudVisible);
+	CHECK(decoded.camera.orientation.y == 0.2f && decoded.camera.orientation.w == 0.9f);
+	CHECK(decoded.camera.lastStepOffset.y == -2.0f && decoded.camera.lookDirectionInverter == -1.0f);
+	CHECK(decoded.camera.pendingMovement.y == 0.5f && decoded.camera.movementPending);
+	CHECK(decoded.cameraManipulator.cameraPosition.x == 1000.5 && decoded.cameraManipulator.cameraPosition.z == 30.125);
+	CHECK(decoded.cameraManipulator.publishedCoordsHistory[PUBLISHED_COORDS_HISTORY_SIZE - 1][2] == 77);
+	CHECK(decoded.cameraManipulator.publishedCoordsHistoryCount == 5);
+	CHECK(decoded.input.actionDown[static_cast<int>(ActionType::Amount) - 1] && !decoded.input.actionDown[0]);
+	CHECK(decoded.input.actionNextRepeatTime[0] == 123456789 && decoded.input.mouseWheelRemainder == -40);
+	CHECK(decoded.settings.movementSpeed == 0.5f && decoded.settings.cameraControlDevice == DEVICE_ID_ALL);
+	CHECK(decoded.keyBindings[3].keyCode == 0x42 && decoded.keyBindings[3].altRequired && !decoded.keyBindings[3].ctrlRequired);
+	// a recording made with another set of actions isn't read
+	buffer[0]++;
+	CHECK(!SessionRecords::decodeKeyframe(buffer.data(), size, decoded));
+	CHECK(0 == SessionRecords::encodeKeyframe(keyframe, buffer.data(), size - 1));
+
+	SessionPose pose = { true, { { 10, -20, 30 }, { 0.0f, 0.6f, 0.0f, 0.8f } }, 0.9f };
+	const uint32_t poseSize = SessionRecords::encodePose(pose, buffer.data(), static_cast<uint32_t>(buffer.size()));
+	REQUIRE(poseSize > 0);
+	SessionPose decodedPose;
+	REQUIRE(SessionRecords::decodePose(buffer.data(), poseSize, decodedPose));
+	CHECK(decodedPose.hasPose && decodedPose.fov == 0.9f);
+	CHECK(0 == memcmp(&decodedPose.pose, &pose.pose, sizeof(pose.pose)));
+	CHECK(!SessionRecords::decodePose(buffer.data(), poseSize - 1, decodedPose));
+}
+
+
+IGCS_TEST(SessionRecording, RingDropsTheOldestRecordsWhenFull)
+{
+	std::vector<uint64_t> memory(512);		// 4KB, as 64 bit words so it's aligned like a mapped file
+	uint8_t* ringMemory = reinterpret_cast<uint8_t*>(memory.data());
+	const uint64_t ringSize = memory.size() * sizeof(uint64_t);
+	SessionRing ring;
+	REQUIRE(ring.attach(ringMemory, ringSize, true));
+	// records of sizes which don't divide the capacity, so the ring is padded at its end every time around
+	const uint32_t numberOfRecords = 500;
+	for (uint32_t sequence = 0; sequence < numberOfRecords; sequence++)
+	{
+		std::vector<uint8_t> record = createRecord(sequence, 20 + (sequence * 37) % 300);
+		REQUIRE(ring.append(SessionRecordType::Tick, record.data(), static_cast<uint32_t>(record.size())));
+	}
+	// a record larger than half the ring is refused
+	std::vector<uint8_t> tooLarge(static_cast<size_t>(ringSize / 2));
+	CHECK(!ring.append(SessionRecordType::Tick, tooLarge.data(), static_cast<uint32_t>(tooLarge.size())));
+
+	// the records left are the newest ones, in order, followed by nothing
+	uint64_t position = ring.firstPosition();
+	SessionRecordType type;
+	const uint8_t* data;
+	uint32_t size;
+	uint32_t numberRead = 0;
+	uint32_t expectedSequence = static_cast<uint32_t>(ring.numberOfDroppedRecords());
+	while (ring.read(position, type, data, size))
+	{
+		CHECK(type == SessionRecordType::Tick);
+		CHECK(size == 20 + (expectedSequence * 37) % 300);
+		CHECK(recordMatches(expectedSequence, data, size));
+		expectedSequence++;
+		numberRead++;
+	}
+	CHECK(numberRead > 0);
+	CHECK(expectedSequence == numberOfRecords);
+	CHECK(ring.numberOfDroppedRecords() + numberRead == numberOfRecords);
+
+	// the memory holds the ring, so it can be attached to again, as a file is after the process ended
+	SessionRing reattached;
+	REQUIRE(reattached.attach(ringMemory, ringSize, false));
+	CHECK(reattached.firstPosition() == ring.firstPosition());
+	CHECK(reattached.numberOfDroppedRecords() == ring.numberOfDroppedRecords());
+	memset(ringMemory, 0, 8);
+	CHECK(!reattached.attach(ringMemory, ringSize, false));
+	CHECK(!reattached.isAttached());
+}
+
+
+IGCS_TEST(SessionRecording, FileKeepsTheRingAndIsOpenedCopyOnWrite)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "IGCSSessionRecordingTest.igcsr";
+	const uint64_t fileSize = 64 * 1024;
+	{
+		SessionFile file;
+		REQUIRE(file.create(path, fileSize));
+		CHECK(file.size() == fileSize);
+		SessionRing ring;
+		REQUIRE(ring.attach(file.data(), file.size(), true));
+		for (uint32_t sequence = 0; sequence < 3; sequence++)
+		{
+			std::vector<uint8_t> record = createRecord(sequence, 100);
+			CHECK(ring.append(SessionRecordType::Pose, record.data(), static_cast<uint32_t>(record.size())));
+		}
+		file.flush();
+	}
+	for (int pass = 0; pass < 2; pass++)
+	{
+		SessionFile file;
+		REQUIRE(file.open(path));
+		CHECK(file.size() == fileSize);
+		SessionRing ring;
+		REQUIRE(ring.attach(file.data(), file.size(), false));
+		uint64_t position = ring.firstPosition();
+		SessionRecordType type;
+		const uint8_t* data;
+		uint32_t size;
+		for (uint32_t sequence = 0; sequence < 3; sequence++)
+		{
+			REQUIRE(ring.read(position, type, data, size));
+			CHECK(type == SessionRecordType::Pose && recordMatches(sequence, data, size));
+		}
+		CHECK(!ring.read(position, type, data, size));
+		// written into the mapping only, the second pass reads the file as it was
+		memset(file.data(), 0, static_cast<size_t>(file.size()));
+	}
+	std::error_code ignored;
+	std::filesystem::remove(path, ignored);
+	SessionFile missing;
+	CHECK(!missing.open(path));
+	CHECK(nullptr == missing.data());
+}
@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "MouseInputAccumulator.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace IGCS;
+
+namespace
+{
+	// long enough for the threads to be preempted halfway through a push or pop many times, also when they share a core
+	const std::chrono::milliseconds TEST_DURATION(250);
+
+	// Larger than a word, so an item which is read while it's written would be recognizable.
+	struct Item
+	{
+		uint64_t sequence;
+		uint64_t check;
+	};
+
+
+	Item createItem(uint64_t sequence)
+	{
+		return Item{ sequence, ~sequence * 0x9E3779B97F4A7C15ull };
+	}
+}
+
+
+IGCS_TEST(SpscRing, PopsInTheOrderPushed)
+{
+	SpscRing<int, 4> ring;
+	int item = -1;
+	CHECK(!ring.pop(item));
+	CHECK(item == -1);
+	CHECK(ring.push(1));
+	CHECK(ring.push(2));
+	CHECK(ring.pop(item) && item == 1);
+	CHECK(ring.push(3));
+	CHECK(ring.pop(item) && item == 2);
+	CHECK(ring.pop(item) && item == 3);
+	CHECK(!ring.pop(item));
+}
+
+
+IGCS_TEST(SpscRing, DropsItemsWhenFull)
+{
+	SpscRing<int, 8> ring;
+	// many times around, so the slots are reused
+	for (int round = 0; round < 100; round++)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			CHECK(ring.push(round * 8 + i));
+		}
+		CHECK(!ring.push(-1));
+		int item;
+		CHECK(ring.pop(item) && item == round * 8);
+		// a freed slot can be used again
+		CHECK(ring.push(round * 8 + 8));
+		CHECK(!ring.push(-1));
+		for (int i = 1; i <= 8; i++)
+		{
+			CHECK(ring.pop(item) && item == round * 8 + i);
+		}
+		CHECK(!ring.pop(item));
+	}
+}
+
+
+// The consumer sees every item the producer managed to push, once, in order and complete. Items the producer couldn't push because the
+// ring was full are dropped, so their sequence numbers are reused.
+IGCS_TEST(SpscRing, HandsItemsToAnotherThread)
+{
+	SpscRing<Item, 64> ring;
+	std::atomic_bool producerDone(false);
+	std::atomic<uint64_t> numberOfDrops(0);
+	uint64_t numberOfPushes = 0;
+	std::thread producer([&]
+	{
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + TEST_DURATION;
+		uint64_t drops = 0;
+		// the time is only checked every 256 pushes
+		while ((numberOfPushes & 0xFF) != 0 || std::chrono::steady_clock::now() < end)
+		{
+			if (ring.push(createItem(numberOfPushes)))
+			{
+				numberOfPushes++;
+			}
+			else
+			{
+				drops++;
+			}
+		}
+		numberOfDrops = drops;
+		producerDone = true;
+	});
+	uint64_t expectedSequence = 0;
+	int numberOfBadItems = 0;
+	while (true)
+	{
+		bool done = producerDone;
+		Item item;
+		while (ring.pop(item))
+		{
+			Item expected = createItem(expectedSequence);
+			if (item.sequence != expected.sequence || item.check != expected.check)
+			{
+				numberOfBadItems++;
+			}
+			expectedSequence = item.sequence + 1;
+		}
+		// the producer was done before the ring was emptied, so nothing is left
+		if (done)
+		{
+			break;
+		}
+	}
+	producer.join();
+	CHECK(numberOfBadItems == 0);
+	CHECK(expectedSequence == numberOfPushes);
+	CHECK(numberOfPushes > 0);
+}
+
+
+IGCS_TEST(MouseInputAccumulator, ConsumesWhatWasAdded)
+{
+	MouseInputAccumulator accumulator;
+	accumulator.addMovement(3, -4);
+	accumulator.addMovement(-10, 7);
+	accumulator.addWheel(120);
+	accumulator.addWheel(-240);
+	MouseInput input = accumulator.consume();
+	CHECK(input.deltaX == -7 && input.deltaY == 3);
+	CHECK(input.wheelDelta == -120);
+	input = accumulator.consume();
+	CHECK(input.deltaX == 0 && input.deltaY == 0 && input.wheelDelta == 0);
+	// saturates instead of wrapping around
+	accumulator.addMovement(INT32_MAX, INT32_MIN);
+	accumulator.addMovement(1, -1);
+	input = accumulator.consume();
+	CHECK(input.deltaX == INT32_MAX && input.deltaY == INT32_MIN);
+}
+
+
+// A click shorter than a tick still gives a press and a release, a held button stays down without new edges.
+IGCS_TEST(MouseInputAccumulator, KeepsButtonEdgesTillConsumed)
+{
+	MouseInputAccumulator accumulator;
+	accumulator.setButtonState(0, true);
+	accumulator.setButtonState(0, false);
+	accumulator.setButtonState(1, true);
+	accumulator.setButtonState(32, true);
+	MouseInput input = accumulator.consume();
+	CHECK(input.buttonsPressed == 3);
+	CHECK(input.buttonsReleased == 1);
+	CHECK(input.buttonsDown == 2);
+	input = accumulator.consume();
+	CHECK(input.buttonsPressed == 0 && input.buttonsReleased == 0);
+	CHECK(input.buttonsDown == 2);
+	accumulator.clear();
+	CHECK(accumulator.consume().buttonsDown == 0);
+}
+
+
+// Movement added on one thread while another consumes is counted exactly once.
+IGCS_TEST(MouseInputAccumulator, LosesNoMovement)
+{
+	MouseInputAccumulator accumulator;
+	std::atomic_bool producerDone(false);
+	int64_t addedX = 0;
+	int64_t addedY = 0;
+	std::thread producer([&]
+	{
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + TEST_DURATION;
+		for (int i = 0; (i & 0xFF) != 0 || std::chrono::steady_clock::now() < end; i++)
+		{
+			int32_t deltaX = (i % 7) - 3;
+			int32_t deltaY = (i % 5) - 1;
+			accumulator.addMovement(deltaX, deltaY);
+			addedX += deltaX;
+			addedY += deltaY;
+		}
+		producerDone = true;
+	});
+	int64_t consumedX = 0;
+	int64_t consumedY = 0;
+	while (!producerDone)
+	{
+		MouseInput input = accumulator.consume();
+		consumedX += input.deltaX;
+		consumedY += input.deltaY;
+	}
+	producer.join();
+	MouseInput input = accumulator.consume();
+	consumedX += input.deltaX;
+	consumedY += input.deltaY;
+	CHECK(consumedX == addedX);
+	CHECK(consumedY == addedY);
+}
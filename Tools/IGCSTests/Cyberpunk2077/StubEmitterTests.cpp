@@ -0,0 +1,262 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include "StubEmitter.h"
+#include <algorithm>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace IGCS;
+
+// The stubs are executed on x64 with the System V calling convention: the fixtures take their argument in rdi and return it in rax.
+#if defined(__x86_64__) && !defined(_WIN32)
+#define IGCS_CAN_EXECUTE_STUBS
+#endif
+
+namespace
+{
+	const size_t TEST_MEMORY_SIZE = 0x20000;
+	const size_t STUB_OFFSET = 0x10000;
+
+	// Executable memory for the game's code of a fixture, at the start, and the stub emitted for it, at STUB_OFFSET: within 2GB of each
+	// other, like the stub memory GameImageHooker allocates.
+	class ExecutableMemory
+	{
+	public:
+		ExecutableMemory()
+		{
+#ifdef _WIN32
+			_memory = static_cast<uint8_t*>(VirtualAlloc(nullptr, TEST_MEMORY_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+#else
+			void* memory = mmap(nullptr, TEST_MEMORY_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			_memory = MAP_FAILED == memory ? nullptr : static_cast<uint8_t*>(memory);
+#endif
+			if (nullptr != _memory)
+			{
+				// int3, so a wrong jump traps instead of running into whatever follows.
+				memset(_memory, 0xCC, TEST_MEMORY_SIZE);
+			}
+		}
+
+		~ExecutableMemory()
+		{
+#ifdef _WIN32
+			VirtualFree(_memory, 0, MEM_RELEASE);
+#else
+			munmap(_memory, TEST_MEMORY_SIZE);
+#endif
+		}
+
+		uint8_t* gameCode(size_t offset = 0) { return _memory + offset; }
+		uint8_t* stub() { return _memory + STUB_OFFSET; }
+
+		void writeGameCode(size_t offset, std::initializer_list<uint8_t> bytes)
+		{
+			std::copy(bytes.begin(), bytes.end(), _memory + offset);
+		}
+
+		// Emits the capture stub for the displaced code at the start of the game's code and copies it to the stub location.
+		bool emitCaptureStub(const CaptureDescription& capture, int displacedLength)
+		{
+			StubEmitter emitter(stub());
+			if (!emitter.emitCaptureStub(capture, gameCode(), displacedLength))
+			{
+				return false;
+			}
+			memcpy(stub(), emitter.code().data(), emitter.length());
+			return true;
+		}
+
+		uint64_t callStub(uint64_t argument)
+		{
+			auto function = reinterpret_cast<uint64_t(*)(uint64_t)>(stub());
+			return function(argument);
+		}
+
+	private:
+		uint8_t* _memory;
+	};
+
+	// mov rax, rdi; add rax, 5
+	const std::initializer_list<uint8_t> MOV_AND_ADD = { 0x48, 0x89, 0xF8, 0x48, 0x83, 0xC0, 0x05 };
+	const uint8_t RET = 0xC3;
+}
+
+
+IGCS_TEST(StubEmitter, EmitsTheCaptureTheDisplacedCodeAndTheJumpBack)
+{
+	uint8_t gameCode[] = { 0x48, 0x89, 0xF8, 0x48, 0x83, 0xC0, 0x05, 0xC3 };
+	uint64_t slot = 0;
+	uint8_t* stubAddress = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(0x140000000));
+	StubEmitter emitter(stubAddress);
+	REQUIRE(emitter.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), gameCode, 7));
+	std::vector<uint8_t>& code = emitter.code();
+	// the displaced code is copied as is, followed by jmp qword ptr [rip+0] to the code after it.
+	const uint8_t jumpBack[] = { 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00 };
+	REQUIRE(code.size() > 7 + 14);
+	uint8_t* continueAddress = gameCode + 7;
+	CHECK(memcmp(&code[code.size() - 14], jumpBack, sizeof(jumpBack)) == 0);
+	CHECK(memcmp(&code[code.size() - 8], &continueAddress, sizeof(continueAddress)) == 0);
+	CHECK(memcmp(&code[code.size() - 21], gameCode, 7) == 0);
+	// the capture stores in the slot.
+	uint64_t* slotAddress = &slot;
+	const uint8_t* slotAddressBytes = reinterpret_cast<const uint8_t*>(&slotAddress);
+	CHECK(std::search(code.begin(), code.end(), slotAddressBytes, slotAddressBytes + sizeof(slotAddress)) != code.end());
+}
+
+
+IGCS_TEST(StubEmitter, RefusesDisplacedCodeItCantRelocate)
+{
+	uint64_t slot = 0;
+	uint8_t* stubAddress = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(0x140000000));
+	// the displaced code ends halfway through the add.
+	uint8_t movAndAdd[] = { 0x48, 0x89, 0xF8, 0x48, 0x83, 0xC0, 0x05 };
+	StubEmitter cutEmitter(stubAddress);
+	CHECK(!cutEmitter.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), movAndAdd, 5));
+	CHECK(!cutEmitter.lastError().empty());
+	// jmp short into the middle of the add.
+	uint8_t jumpIntoInstruction[] = { 0xEB, 0x02, 0x48, 0x83, 0xC0, 0x05 };
+	StubEmitter branchEmitter(stubAddress);
+	CHECK(!branchEmitter.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), jumpIntoInstruction, 6));
+	// no slot
+	StubEmitter slotEmitter(stubAddress);
+	CHECK(!slotEmitter.emitCaptureStub(CaptureDescription(X64Register::RDI, nullptr), movAndAdd, 7));
+	// a rip relative operand more than 2GB away from the stub.
+	uint8_t ripRelativeLoad[] = { 0x48, 0x8B, 0x05, 0x00, 0x00, 0x00, 0x00 };
+	StubEmitter farEmitter(reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(ripRelativeLoad) + 0x100000000ULL));
+	CHECK(!farEmitter.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), ripRelativeLoad, 7));
+}
+
+
+#ifdef IGCS_CAN_EXECUTE_STUBS
+IGCS_TEST(StubEmitter, CapturesARegisterBeforeTheDisplacedCode)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	memory.writeGameCode(0, MOV_AND_ADD);
+	memory.writeGameCode(7, { RET });
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), 7));
+	CHECK(memory.callStub(42) == 47);
+	CHECK(slot == 42);
+}
+
+
+IGCS_TEST(StubEmitter, CapturesARegisterAfterTheDisplacedCode)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	memory.writeGameCode(0, MOV_AND_ADD);
+	memory.writeGameCode(7, { RET });
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RAX, &slot, true), 7));
+	CHECK(memory.callStub(42) == 47);
+	CHECK(slot == 47);
+}
+
+
+IGCS_TEST(StubEmitter, CapturesWhatARegisterPointsTo)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	memory.writeGameCode(0, MOV_AND_ADD);
+	memory.writeGameCode(7, { RET });
+	uint64_t structure[] = { 1, 0x1234567890ULL };
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RDI, 8, &slot), 7));
+	memory.callStub(reinterpret_cast<uint64_t>(structure));
+	CHECK(slot == 0x1234567890ULL);
+}
+
+
+IGCS_TEST(StubEmitter, RelocatesRipRelativeOperands)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	// mov rax, [rip+0x100]; then ret. The qword read is at 7 + 0x100.
+	memory.writeGameCode(0, { 0x48, 0x8B, 0x05, 0x00, 0x01, 0x00, 0x00, RET });
+	const uint64_t value = 0xFEDCBA9876543210ULL;
+	memcpy(memory.gameCode(7 + 0x100), &value, sizeof(value));
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), 7));
+	CHECK(memory.callStub(3) == value);
+	CHECK(slot == 3);
+}
+
+
+IGCS_TEST(StubEmitter, RelocatesBranchesOutOfTheDisplacedCode)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	// test rdi, rdi; je 0x40; mov rax, rdi; then ret. At 0x40: mov eax, 99; ret
+	memory.writeGameCode(0, { 0x48, 0x85, 0xFF, 0x74, 0x3B, 0x48, 0x89, 0xF8, RET });
+	memory.writeGameCode(0x40, { 0xB8, 0x63, 0x00, 0x00, 0x00, RET });
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), 8));
+	CHECK(memory.callStub(7) == 7);
+	CHECK(memory.callStub(0) == 99);
+	// call 0x80; then ret. At 0x80: lea rax, [rdi+1]; ret
+	ExecutableMemory callMemory;
+	REQUIRE(nullptr != callMemory.gameCode());
+	callMemory.writeGameCode(0, { 0xE8, 0x7B, 0x00, 0x00, 0x00, RET });
+	callMemory.writeGameCode(0x80, { 0x48, 0x8D, 0x47, 0x01, RET });
+	REQUIRE(callMemory.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), 5));
+	CHECK(callMemory.callStub(5) == 6);
+}
+
+
+IGCS_TEST(StubEmitter, RelocatesBranchesWithinTheDisplacedCode)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	// mov rax, rdi; test rdi, rdi; jne +4 (over the add); add rax, 5; then ret
+	memory.writeGameCode(0, { 0x48, 0x89, 0xF8, 0x48, 0x85, 0xFF, 0x75, 0x04, 0x48, 0x83, 0xC0, 0x05, RET });
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RDI, &slot), 12));
+	CHECK(memory.callStub(10) == 10);
+	CHECK(memory.callStub(0) == 5);
+}
+
+
+IGCS_TEST(StubEmitter, BranchToTheEndOfTheDisplacedCodeRunsTheCapture)
+{
+	ExecutableMemory memory;
+	REQUIRE(nullptr != memory.gameCode());
+	// mov rax, rdi; jmp short to the end of the displaced code, over the add; add rax, 5; then ret
+	memory.writeGameCode(0, { 0x48, 0x89, 0xF8, 0xEB, 0x04, 0x48, 0x83, 0xC0, 0x05, RET });
+	uint64_t slot = 0;
+	REQUIRE(memory.emitCaptureStub(CaptureDescription(X64Register::RAX, &slot, true), 9));
+	CHECK(memory.callStub(42) == 42);
+	// the branch goes to the capture after the displaced code, not straight back to the game's code.
+	CHECK(slot == 42);
+}
+#endif
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdio>
+#include <vector>
+
+// Minimal unit test support, so the tests build without dependencies on every platform the cameras' portable sources build on. A test is
+// a function defined with IGCS_TEST(suite, name). CHECK records a failure and continues, REQUIRE records a failure and ends the test.
+namespace IGCS::Tests
+{
+	struct TestCase
+	{
+		const char* suiteName;
+		const char* testName;
+		void (*function)();
+	};
+
+	// Thrown by REQUIRE to end the current test.
+	struct TestAborted
+	{
+	};
+
+	std::vector<TestCase>& registeredTests();
+	void reportFailure(const char* file, int line, const char* expression);
+
+	struct TestRegistration
+	{
+		TestRegistration(const char* suiteName, const char* testName, void (*function)())
+		{
+			registeredTests().push_back(TestCase{ suiteName, testName, function });
+		}
+	};
+}
+
+#define IGCS_TEST(suite, name)																									\
+	static void suite##_##name();																								\
+	static IGCS::Tests::TestRegistration suite##_##name##_registration(#suite, #name, &suite##_##name);						\
+	static void suite##_##name()
+
+#define CHECK(expression)																										\
+	do { if (!(expression)) { IGCS::Tests::reportFailure(__FILE__, __LINE__, #expression); } } while (false)
+
+#define REQUIRE(expression)																										\
+	do { if (!(expression)) { IGCS::Tests::reportFailure(__FILE__, __LINE__, #expression); throw IGCS::Tests::TestAborted(); } } while (false)
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Part of Injectable Generic Camera System
+// Copyright(c) 2020, Frans Bouma
+// All rights reserved.
+// https://github.com/FransBouma/InjectableGenericCameraSystem
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestFramework.h"
+#include <cstring>
+
+namespace IGCS::Tests
+{
+	static int _numberOfFailures = 0;
+
+	std::vector<TestCase>& registeredTests()
+	{
+		static std::vector<TestCase> theTests;
+		return theTests;
+	}
+
+
+	void reportFailure(const char* file, int line, const char* expression)
+	{
+		printf("%s(%d): check failed: %s\n", file, line, expression);
+		_numberOfFailures++;
+	}
+}
+
+
+// Runs all tests, or only the ones of the suites specified on the command line. Returns 0 if all tests passed.
+int main(int argc, char* argv[])
+{
+	using namespace IGCS::Tests;
+	int numberOfTestsRun = 0;
+	int numberOfTestsFailed = 0;
+	for (const TestCase& test : registeredTests())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc && !selected; i++)
+		{
+			selected = strcmp(argv[i], test.suiteName) == 0;
+		}
+		if (!selected)
+		{
+			continue;
+		}
+		int failuresBefore = _numberOfFailures;
+		try
+		{
+			test.function();
+		}
+		catch (const TestAborted&)
+		{
+		}
+		numberOfTestsRun++;
+		bool passed = _numberOfFailures == failuresBefore;
+		if (!passed)
+		{
+			numberOfTestsFailed++;
+		}
+		printf("%s %s.%s\n", passed ? "[  OK  ]" : "[FAILED]", test.suiteName, test.testName);
+	}
+	printf("%d tests run, %d failed.\n", numberOfTestsRun, numberOfTestsFailed);
+	return (numberOfTestsRun == 0 || numberOfTestsFailed > 0) ? 1 : 0;
+}